@@ -1,6 +1,9 @@
 ﻿
+#include <algorithm>
 #include <exception>
 #include <functional>
+#include <optional>
+#include <random>
 #include <unordered_map>
 
 #include "src/core/bud.core.hpp"
@@ -9,11 +12,22 @@
 
 #include "src/runtime/bud.game.hpp"
 #include "src/runtime/bud.scene.io.hpp"
+#include "src/runtime/bud.benchmark.hpp"
 
 using namespace bud::game;
 
 class TriangleApp : public GameFramework {
 public:
+    explicit TriangleApp(const bud::benchmark::BenchmarkConfig& benchmark_config) : benchmark_config(benchmark_config) {
+        if (benchmark_config.enabled) {
+            benchmark = std::make_unique<bud::benchmark::BenchmarkRunner>(benchmark_config);
+        }
+    }
+
+    int get_exit_code() const {
+        return benchmark ? benchmark->get_exit_code() : 0;
+    }
+
     void on_init(const AppConfig& config) override {
         bud::print("[TriangleApp] Initialized. Loading scene: {}", config.scene_file);
 
@@ -32,67 +46,50 @@ public:
         renderer->set_config(render_config);
 
         // 2. Load Scene Data-Driven
-        if (!config.scene_file.empty()) {
-            asset_manager->load_json_async(config.scene_file, [this, engine, renderer, asset_manager](const nlohmann::json& j) {
+        if (startup_scene) {
+            // Parsed by the SceneParse startup job while the renderer came up
+            engine->get_scene() = std::move(*startup_scene);
+            startup_scene.reset();
+            load_scene_meshes();
+        } else if (!config.scene_file.empty()) {
+            asset_manager->load_json_async(config.scene_file, [this, engine](const nlohmann::json& j) {
                 try {
-                    auto& scene = engine->get_scene();
-                    scene = j.get<bud::scene::Scene>();
-
-                    bud::print("[TriangleApp] Scene file parsed. Entities found: {}", scene.entities.size());
-
-                    // Count pending mesh loads
-                    auto pending_mesh_loads = std::make_shared<std::atomic<int>>(0);
-                    int count = 0;
-                    for (auto& e : scene.entities) if (!e.asset_path.empty()) ++count;
-                    pending_mesh_loads->store(count);
-
-                    if (count == 0) {
-                        bud::print("[TriangleApp] init finished");
-                        return;
-                    }
-
-                    // Start async mesh loads. Capture asset path and index by value to avoid lifetime issues.
-                    for (size_t i = 0; i < scene.entities.size(); ++i) {
-                        const auto asset_path = scene.entities[i].asset_path;
-                        if (asset_path.empty()) continue;
-
-                        asset_manager->load_mesh_async(asset_path, [this, engine, renderer, pending_mesh_loads, asset_path, i](bud::io::MeshData mesh) mutable {
-                            // Upload mesh on renderer and write back to engine scene when ready
-                            auto mesh_handle = renderer->upload_mesh(mesh);
-                            if (mesh_handle.is_valid()) {
-                                auto& s = engine->get_scene();
-                                if (i < s.entities.size() && s.entities[i].asset_path == asset_path) {
-                                    s.entities[i].mesh_index = mesh_handle.mesh_id;
-                                    s.entities[i].material_index = mesh_handle.material_id;
-                                } else {
-                                    // Fallback: find by asset_path
-                                    for (auto &ent : s.entities) {
-                                        if (ent.asset_path == asset_path) {
-                                            ent.mesh_index = mesh_handle.mesh_id;
-                                            ent.material_index = mesh_handle.material_id;
-                                            break;
-                                        }
-                                    }
-                                }
-                                bud::print("[TriangleApp] Loaded mesh: {}", asset_path);
-                            }
-
-                            if (pending_mesh_loads->fetch_sub(1) == 1) {
-                                bud::print("[TriangleApp] init finished");
-                            }
-                        });
-                    }
+                    engine->get_scene() = j.get<bud::scene::Scene>();
+                    load_scene_meshes();
                 } catch(const std::exception& e) {
                     bud::eprint("[TriangleApp] CRITICAL EXCEPTION during JSON parsing: {}", e.what());
                 }
             });
         } else {
             bud::print("[TriangleApp] init finished");
+            scene_ready.store(true, std::memory_order_release);
         }
     }
 
+    void on_startup(bud::engine::StartupGraph& graph, bud::engine::BudEngine& engine, const AppConfig& config) override {
+        if (config.scene_file.empty()) return;
+
+        // Large generated scenes take a while to parse, overlap it with device and renderer creation
+        graph.add("SceneParse", { "AssetManager" }, bud::engine::StartupThread::Worker, [this, &engine, scene_file = config.scene_file]() {
+            auto j = engine.get_asset_manager()->load_json(scene_file);
+            if (!j) return;
+            try {
+                startup_scene = j->get<bud::scene::Scene>();
+            } catch (const std::exception& e) {
+                bud::eprint("[TriangleApp] CRITICAL EXCEPTION during JSON parsing: {}", e.what());
+            }
+        });
+    }
+
     void on_update(float delta_time) override {
         auto engine = get_engine();
+
+        // Scripted camera, user input is ignored so runs stay comparable
+        if (benchmark) {
+            benchmark->update(engine, delta_time, scene_ready.load(std::memory_order_acquire));
+            return;
+        }
+
         auto& input = bud::input::Input::get();
         auto& scene = engine->get_scene();
         auto& cam = scene.main_camera;
@@ -113,19 +110,347 @@ public:
             if (dy != 0.0f)
                 cam.process_mouse_drag_zoom(dy);
         }
+
+        if (!benchmark_config.record_camera_path.empty()) {
+            // 10 Hz is plenty, playback interpolates between keyframes
+            if (record_steps++ % 6 == 0) {
+                recorded_path.add_keyframe({ record_time, cam.position, cam.yaw, cam.pitch });
+            }
+            record_time += delta_time;
+        }
     }
 
     void on_shutdown() override {
         bud::print("[TriangleApp] Shutting down.");
+        if (!benchmark_config.record_camera_path.empty() && !recorded_path.empty()) {
+            if (recorded_path.save(benchmark_config.record_camera_path)) {
+                bud::print("[TriangleApp] Camera path saved: {} ({:.1f} s)", benchmark_config.record_camera_path, recorded_path.get_duration());
+            }
+        }
     }
+
+private:
+    // Main thread, once the scene is in engine->get_scene()
+    void load_scene_meshes() {
+        auto engine = get_engine();
+        auto asset_manager = engine->get_asset_manager();
+        auto renderer = engine->get_renderer();
+        auto& scene = engine->get_scene();
+
+        bud::print("[TriangleApp] Scene file parsed. Entities found: {}", scene.entities.size());
+
+        // One load per unique asset, generated stress scenes reference the same few meshes from millions of entities
+        auto entities_by_asset = std::make_shared<std::unordered_map<std::string, std::vector<size_t>>>();
+        for (size_t i = 0; i < scene.entities.size(); ++i) {
+            if (!scene.entities[i].asset_path.empty())
+                (*entities_by_asset)[scene.entities[i].asset_path].push_back(i);
+        }
+
+        // Foliage counts as one load, it is ready once all of its LOD meshes are
+        const int foliage_loads = scene.foliage.empty() ? 0 : 1;
+        auto pending_mesh_loads = std::make_shared<std::atomic<int>>(static_cast<int>(entities_by_asset->size()) + foliage_loads);
+        auto mark_loaded = [this, pending_mesh_loads]() {
+            if (pending_mesh_loads->fetch_sub(1) == 1) {
+                bud::print("[TriangleApp] init finished");
+                scene_ready.store(true, std::memory_order_release);
+            }
+        };
+
+        if (entities_by_asset->empty() && foliage_loads == 0) {
+            bud::print("[TriangleApp] init finished");
+            scene_ready.store(true, std::memory_order_release);
+            return;
+        }
+
+        if (foliage_loads > 0) {
+            load_scene_foliage(mark_loaded);
+        }
+
+        // Proxies only matter for far views, the scene does not wait for them
+        if (!scene.hlod.empty()) {
+            load_scene_hlod(scene.hlod);
+        }
+
+        bud::print("[TriangleApp] Loading {} unique meshes", entities_by_asset->size());
+
+        // Start async mesh loads. Capture asset path by value to avoid lifetime issues.
+        for (const auto& [path, indices] : *entities_by_asset) {
+            const auto asset_path = path;
+
+            asset_manager->load_mesh_async(asset_path, [engine, renderer, mark_loaded, entities_by_asset, asset_path](bud::io::MeshData mesh) mutable {
+                // Upload mesh on renderer and write back to every entity using it
+                auto mesh_handle = renderer->upload_mesh(mesh);
+                if (mesh_handle.is_valid()) {
+                    auto& s = engine->get_scene();
+                    for (size_t i : entities_by_asset->at(asset_path)) {
+                        if (i < s.entities.size() && s.entities[i].asset_path == asset_path) {
+                            s.entities[i].mesh_index = mesh_handle.mesh_id;
+                            s.entities[i].material_index = mesh_handle.material_id;
+                        }
+                    }
+                    bud::print("[TriangleApp] Loaded mesh: {}", asset_path);
+                }
+
+                mark_loaded();
+            }, mark_loaded);
+        }
+    }
+
+    // Uploads every layer's LOD meshes and impostor atlas, reads the atlas' card sidecar, then scatters the
+    // instances and hands the built FoliageSystem to the renderer. on_done runs once, after the last LOD
+    // mesh and sidecar arrived or failed.
+    void load_scene_foliage(std::function<void()> on_done) {
+        auto engine = get_engine();
+        auto asset_manager = engine->get_asset_manager();
+        auto renderer = engine->get_renderer();
+        const auto& layers = engine->get_scene().foliage;
+
+        struct FoliageLoad {
+            std::vector<bud::scene::FoliageLayer> layers;
+            std::vector<bud::graphics::FoliageType> types;
+            std::vector<std::vector<uint8_t>> lod_loaded; // [layer][lod], a failed LOD ends the layer's chain there
+            std::vector<std::string> sidecar_paths;       // [layer], empty without an impostor
+            std::atomic<int> pending{ 0 };
+        };
+        auto load = std::make_shared<FoliageLoad>();
+        load->layers = layers;
+        load->types.resize(layers.size());
+        load->lod_loaded.resize(layers.size());
+        load->sidecar_paths.resize(layers.size());
+
+        int loads = 0;
+        for (size_t l = 0; l < layers.size(); ++l) {
+            const auto& layer = layers[l];
+            auto& type = load->types[l];
+            type.lod_count = static_cast<uint32_t>(std::min<size_t>({ layer.lod_paths.size(), layer.lod_distances.size(), bud::graphics::FOLIAGE_MAX_LODS }));
+            for (uint32_t i = 0; i < type.lod_count; ++i) type.lod_distances[i] = layer.lod_distances[i];
+            type.cull_distance = layer.cull_distance;
+            type.shadow_distance = layer.shadow_distance;
+            type.cast_shadows = layer.cast_shadows;
+            if (!layer.impostor_path.empty()) {
+                type.impostor_texture = renderer->upload_texture(layer.impostor_path);
+                type.impostor_frames = layer.impostor_frames;
+                type.impostor_size = layer.impostor_size;
+                type.impostor_base = layer.impostor_base;
+
+                // --bake-impostor writes the card layout next to the atlas, the scene's values only stand in without it
+                const auto dot = layer.impostor_path.find_last_of('.');
+                const auto slash = layer.impostor_path.find_last_of("/\\");
+                const bool has_extension = dot != std::string::npos && (slash == std::string::npos || dot > slash);
+                load->sidecar_paths[l] = (has_extension ? layer.impostor_path.substr(0, dot) : layer.impostor_path) + ".json";
+                loads++;
+            }
+            load->lod_loaded[l].assign(type.lod_count, 0);
+            loads += static_cast<int>(type.lod_count);
+        }
+
+        auto finish = [renderer, load, on_done]() {
+            auto foliage = std::make_shared<bud::graphics::FoliageSystem>();
+            size_t total = 0;
+            for (const auto& layer : load->layers) total += layer.count;
+            foliage->reserve(total);
+
+            for (size_t l = 0; l < load->layers.size(); ++l) {
+                const auto& layer = load->layers[l];
+                auto type = load->types[l];
+                uint32_t loaded = 0;
+                while (loaded < type.lod_count && load->lod_loaded[l][loaded]) ++loaded;
+                type.lod_count = loaded;
+                if (type.lod_count == 0 && type.impostor_texture == 0) {
+                    bud::eprint("[TriangleApp] Foliage layer {} has nothing to draw, skipped", l);
+                    continue;
+                }
+
+                const uint32_t type_id = foliage->add_type(type);
+                std::mt19937 rng(layer.seed);
+                std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+                for (uint32_t i = 0; i < layer.count; ++i) {
+                    bud::math::vec3 position(
+                        layer.area_min.x + (layer.area_max.x - layer.area_min.x) * unit(rng),
+                        layer.area_min.y,
+                        layer.area_min.z + (layer.area_max.z - layer.area_min.z) * unit(rng));
+                    const float yaw = unit(rng) * 2.0f * bud::math::PI;
+                    const float scale = layer.scale_min + (layer.scale_max - layer.scale_min) * unit(rng);
+                    foliage->add_instance(type_id, position, yaw, scale);
+                }
+            }
+
+            foliage->build();
+            bud::print("[TriangleApp] Foliage ready: {} instances in {} cells", foliage->instance_count(), foliage->cell_count());
+            renderer->set_foliage(foliage);
+            on_done();
+        };
+
+        if (loads == 0) {
+            finish();
+            return;
+        }
+        load->pending.store(loads);
+
+        // Failed loads count down too, their LOD stays unloaded / the card keeps the scene's layout
+        auto mark_done = [load, finish]() {
+            if (load->pending.fetch_sub(1) == 1) {
+                finish();
+            }
+        };
+
+        for (size_t l = 0; l < layers.size(); ++l) {
+            if (!load->sidecar_paths[l].empty()) {
+                const auto path = load->sidecar_paths[l];
+                asset_manager->load_json_async(path, [load, mark_done, l, path](const nlohmann::json& j) {
+                    auto& type = load->types[l];
+                    try {
+                        j.at("impostor_frames").get_to(type.impostor_frames);
+                        j.at("impostor_size").get_to(type.impostor_size);
+                        j.at("impostor_base").get_to(type.impostor_base);
+                        bud::print("[TriangleApp] Impostor card from {}: {} frames, {} x {}", path, type.impostor_frames, type.impostor_size.x, type.impostor_size.y);
+                    } catch (const std::exception& e) {
+                        const auto& layer = load->layers[l];
+                        type.impostor_frames = layer.impostor_frames;
+                        type.impostor_size = layer.impostor_size;
+                        type.impostor_base = layer.impostor_base;
+                        bud::eprint("[TriangleApp] Invalid impostor sidecar {}: {}", path, e.what());
+                    }
+                    mark_done();
+                }, [l, path, mark_done]() {
+                    bud::eprint("[TriangleApp] Foliage layer {} has no impostor sidecar {}, using the scene's card layout", l, path);
+                    mark_done();
+                });
+            }
+
+            for (uint32_t i = 0; i < load->types[l].lod_count; ++i) {
+                const auto path = layers[l].lod_paths[i];
+                asset_manager->load_mesh_async(path, [renderer, load, mark_done, l, i, path](bud::io::MeshData mesh) {
+                    auto mesh_handle = renderer->upload_mesh(mesh);
+                    if (mesh_handle.is_valid()) {
+                        load->types[l].lod_meshes[i] = mesh_handle.mesh_id;
+                        load->lod_loaded[l][i] = 1;
+                        if (i == 0) {
+                            bud::math::AABB bounds;
+                            for (const auto& p : mesh.positions) bounds.merge(p);
+                            load->types[l].local_bounds = bounds;
+                        }
+                        bud::print("[TriangleApp] Loaded foliage LOD {}: {}", i, path);
+                    }
+
+                    mark_done();
+                }, mark_done);
+            }
+        }
+    }
+
+    // Reads the manifest of BudAssetTool --build-hlod, uploads every region's proxy and hands the set to the
+    // engine once the last proxy arrived. Regions whose proxy did not upload are left out.
+    void load_scene_hlod(const std::string& manifest_path) {
+        auto engine = get_engine();
+        auto asset_manager = engine->get_asset_manager();
+        auto renderer = engine->get_renderer();
+
+        asset_manager->load_json_async(manifest_path, [engine, asset_manager, renderer, manifest_path](const nlohmann::json& j) {
+            struct HLODLoad {
+                std::vector<bud::graphics::HLODRegion> regions;
+                std::vector<std::vector<uint32_t>> members;
+                std::vector<uint8_t> loaded;
+                std::atomic<int> pending{ 0 };
+            };
+            auto load = std::make_shared<HLODLoad>();
+            std::vector<std::string> proxy_paths;
+
+            try {
+                for (const auto& r : j.at("regions")) {
+                    bud::graphics::HLODRegion region;
+                    bud::math::vec3 bounds_min, bounds_max;
+                    r.at("bounds_min").get_to(bounds_min);
+                    r.at("bounds_max").get_to(bounds_max);
+                    region.bounds = bud::math::AABB(bounds_min, bounds_max);
+                    r.at("switch_distance").get_to(region.switch_distance);
+                    r.at("source_draws").get_to(region.source_draws);
+                    r.at("source_triangles").get_to(region.source_triangles);
+                    r.at("proxy_triangles").get_to(region.proxy_triangles);
+                    load->regions.push_back(region);
+                    load->members.push_back(r.at("members").get<std::vector<uint32_t>>());
+                    proxy_paths.push_back(r.at("proxy").get<std::string>());
+                }
+            } catch (const std::exception& e) {
+                bud::eprint("[TriangleApp] Invalid HLOD manifest {}: {}", manifest_path, e.what());
+                return;
+            }
+            if (load->regions.empty()) return;
+
+            load->loaded.assign(load->regions.size(), 0);
+            load->pending.store(static_cast<int>(load->regions.size()));
+
+            auto finish = [engine, load]() {
+                auto hlod = std::make_shared<bud::graphics::HLODSet>();
+                for (size_t r = 0; r < load->regions.size(); ++r) {
+                    if (load->loaded[r]) hlod->add_region(load->regions[r], load->members[r]);
+                }
+                hlod->build();
+                bud::print("[TriangleApp] HLOD ready: {} regions over {} submeshes", hlod->get_regions().size(), hlod->member_count());
+                engine->set_hlod(hlod);
+            };
+
+            for (size_t r = 0; r < proxy_paths.size(); ++r) {
+                const auto path = proxy_paths[r];
+                asset_manager->load_mesh_async(path, [renderer, load, finish, r](bud::io::MeshData mesh) {
+                    auto mesh_handle = renderer->upload_mesh(mesh);
+                    if (mesh_handle.is_valid()) {
+                        load->regions[r].proxy_mesh = mesh_handle.mesh_id;
+                        load->regions[r].proxy_material = mesh_handle.material_id;
+                        load->loaded[r] = 1;
+                    }
+
+                    if (load->pending.fetch_sub(1) == 1) {
+                        finish();
+                    }
+                }, [load, finish]() {
+                    if (load->pending.fetch_sub(1) == 1) {
+                        finish();
+                    }
+                });
+            }
+        });
+    }
+
+    bud::benchmark::BenchmarkConfig benchmark_config;
+    std::unique_ptr<bud::benchmark::BenchmarkRunner> benchmark;
+    std::atomic<bool> scene_ready = false;
+    std::optional<bud::scene::Scene> startup_scene;  // Written by the SceneParse startup job, consumed in on_init
+
+    bud::benchmark::CameraPath recorded_path;
+    float record_time = 0.0f;
+    uint32_t record_steps = 0;
 };
 
 int main(int argc, char* argv[]) {
     bud::print("[TriangleApp] Main started.");
+
+    bud::benchmark::BenchmarkConfig benchmark_config;
+    std::string arg_error;
+    if (!bud::benchmark::parse_args(argc, argv, benchmark_config, arg_error)) {
+        bud::eprint("{}\nUsage: triangle_sample [options]\n{}", arg_error, bud::benchmark::get_usage());
+        return bud::benchmark::BenchmarkExit_Failed;
+    }
+
+    int exit_code = 0;
     try {
         AppConfig config;
         config.window_title = "Bud Engine";
         config.scene_file = "data/scenes/sponza_scene.json";
+        if (!benchmark_config.scene_file.empty()) {
+            config.scene_file = benchmark_config.scene_file;
+        }
+        benchmark_config.scene_file = config.scene_file;
+
+        if (benchmark_config.enabled) {
+            config.window_title = "Bud Engine Benchmark";
+            config.hidden_window = benchmark_config.hidden_window;
+            if (benchmark_config.software_device) {
+                config.device_preference = bud::graphics::DevicePreference::Software;
+            }
+            // One logic step per frame, the camera path advances identically on every machine
+            config.fixed_frame_time = static_cast<double>(bud::graphics::RenderConfig{}.fixed_logic_timestep);
+        }
 
         const auto screen = bud::platform::get_current_screen_resolution();
         if (screen.width > 0 && screen.height > 0) {
@@ -133,14 +458,14 @@ int main(int argc, char* argv[]) {
             config.height = screen.height;
         }
 
-        TriangleApp app;
+        TriangleApp app(benchmark_config);
         app.run(config);
-
+        exit_code = app.get_exit_code();
     }
     catch (const std::exception& e) {
         bud::eprint("Fatal Error: {}", e.what());
         return -1;
     }
 
-    return 0;
+    return exit_code;
 }
@@ -7,7 +7,14 @@ namespace bud::asset {
 
     // 0x4255444D ("BUDM")
     constexpr uint32_t MESH_MAGIC = 0x4255444D;
-    constexpr uint32_t MESH_VERSION = 1;
+    constexpr uint32_t MESH_VERSION = 5;
+    constexpr uint32_t MESH_VERSION_SPLIT_STREAMS = 4;  // Positions and attributes as separate arrays, older files interleave Vertex
+    constexpr uint32_t MESH_VERSION_CLUSTER_LOD = 5;    // Header grows lod_offset, meshlets may carry a cluster LOD hierarchy
+
+    // 0x42554453 ("BUDS"), every SPIR-V blob of the engine in one file
+    constexpr uint32_t SHADER_BUNDLE_MAGIC = 0x42554453;
+    constexpr uint32_t SHADER_BUNDLE_VERSION = 1;
+    constexpr uint32_t SHADER_BUNDLE_FLAG_COMPRESSED = 1u << 0;  // At least one blob is bud::compress LZ encoded
 
 #pragma pack(push, 1)
 
@@ -23,7 +30,7 @@ namespace bud::asset {
 
     struct BudMeshHeader {
         uint32_t magic;            // 0x4255444D
-        uint32_t version;          // 3
+        uint32_t version;          // MESH_VERSION
         
         uint32_t total_vertices;
         uint32_t total_indices;
@@ -34,9 +41,9 @@ namespace bud::asset {
         float aabb_min[3];
         float aabb_max[3];
 
-        uint64_t reserved;         // Explicit 8-byte padding to ensure 8-byte alignment for uint64_t
+        uint64_t attribute_offset; // v4: VertexAttributes stream; v2/v3: padding (0) to keep the uint64_t fields 8-byte aligned
 
-        uint64_t vertex_offset;
+        uint64_t vertex_offset;    // v4: VertexPosition stream; v2/v3: interleaved Vertex
         uint64_t index_offset;
         uint64_t meshlet_offset;
         uint64_t vertex_index_offset;
@@ -44,6 +51,7 @@ namespace bud::asset {
         uint64_t cull_data_offset;
         uint64_t submesh_offset;
         uint64_t texture_offset;   // Offset to the texture path list (null-terminated strings or similar)
+        uint64_t lod_offset;       // v5: SubMeshLod[submesh_count] then MeshletLodBounds[meshlet_count], 0 = flat meshlets
     };
 
     struct MeshletDescriptor {
@@ -59,7 +67,26 @@ namespace bud::asset {
         int8_t cone_cutoff;        // cos(angle/2) for backface culling
     };
 
-    // Vertex structure for BudEngine (Must match what is written in BudAssetTool)
+    // Cluster LOD bounds of one meshlet, parallel to the meshlet table (bud.cluster_lod.hpp). "Self" is the
+    // group the meshlet was simplified from, "parent" the group it was merged into; object space.
+    struct MeshletLodBounds {
+        float center[3];
+        float radius;
+        float error;               // 0 for the source meshlets
+        float parent_center[3];
+        float parent_radius;
+        float parent_error;        // FLT_MAX when the meshlet was never simplified further
+        uint32_t group;            // INVALID_INDEX for the source meshlets
+        uint32_t parent_group;     // INVALID_INDEX when there is no parent
+    };
+
+    // SubMeshDescriptor::meshlet_count covers the source meshlets only, the coarser levels follow them
+    struct SubMeshLod {
+        uint32_t meshlet_count;    // Every level, from SubMeshDescriptor::meshlet_start
+        uint32_t level_count;      // 1 = source meshlets only
+    };
+
+    // Interleaved vertex of v2/v3 files, still used by BudAssetTool while building meshlets
     struct Vertex {
         float position[3];
         float normal[3];
@@ -67,14 +94,60 @@ namespace bud::asset {
         float tangent[4]; // Optional, but good to have
     };
 
+    // v4 streams: depth-only passes only ever fetch the positions
+    struct VertexPosition {
+        float position[3];
+    };
+
+    struct VertexAttributes {
+        float normal[3];
+        float uv[2];
+        float tangent[4];
+    };
+
+    // Layout: header | entries | blobs | string table | blob data
+    struct ShaderBundleHeader {
+        uint32_t magic;            // 0x42554453
+        uint32_t version;
+        uint32_t flags;            // SHADER_BUNDLE_FLAG_*
+        uint32_t entry_count;
+        uint32_t blob_count;       // <= entry_count, identical SPIR-V is stored once
+        uint32_t reserved;
+
+        uint64_t entry_offset;
+        uint64_t blob_offset;
+        uint64_t string_offset;
+        uint64_t data_offset;
+    };
+
+    struct ShaderBundleEntry {
+        uint32_t name_offset;        // Into the string table, the path the engine loads ("src/shaders/main.vert.spv")
+        uint32_t name_size;
+        uint32_t blob_index;
+        uint32_t reflection_offset;  // Into the string table, shader report JSON of the source, 0 size = none
+        uint32_t reflection_size;
+    };
+
+    struct ShaderBundleBlob {
+        uint64_t offset;           // Relative to data_offset
+        uint32_t stored_size;      // == size: stored raw
+        uint32_t size;             // SPIR-V bytes
+        uint64_t hash;             // FNV-1a of the raw SPIR-V
+    };
+
 #pragma pack(pop)
 
 	constexpr uint32_t INVALID_INDEX = 0xFFFFFFFFu;
 
     // Structural constants for verification
-    constexpr uint32_t MESH_HEADER_SIZE = 124;
+    constexpr uint32_t MESH_HEADER_SIZE = 132;
     constexpr uint32_t MESH_HEADER_VERTEX_OFFSET = 60;
+    constexpr uint32_t MESH_HEADER_ATTRIBUTE_OFFSET = 52;
     constexpr uint32_t MESH_HEADER_SUBMESH_COUNT_OFFSET = 20;
     constexpr uint32_t SUBMESH_DESCRIPTOR_SIZE = 44;
+    constexpr uint32_t MESHLET_LOD_BOUNDS_SIZE = 48;
+    constexpr uint32_t SHADER_BUNDLE_HEADER_SIZE = 56;
+    constexpr uint32_t SHADER_BUNDLE_ENTRY_SIZE = 20;
+    constexpr uint32_t SHADER_BUNDLE_BLOB_SIZE = 24;
 
 } // namespace bud::asset
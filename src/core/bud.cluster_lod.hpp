@@ -0,0 +1,137 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+#include "src/core/bud.asset.types.hpp"
+
+// Continuous LOD over the meshlet cluster hierarchy of v5 .budmesh files, shared by the engine and the tools.
+//
+// BudAssetTool --cluster-lod groups neighbouring meshlets, simplifies every group with its border locked and
+// splits the result into new meshlets, level by level. Each meshlet stores the bounds of the group it came
+// from (self) and of the group it was merged into (parent). A meshlet is drawn when its own projected error
+// is within the threshold and its parent's is not. Parent spheres enclose their children and parent errors
+// never shrink, so exactly one level of every group passes and neighbouring groups meet on their locked
+// borders: the selected cut is watertight. meshlet_cull.comp runs the same test per meshlet on the GPU.
+namespace bud::cluster_lod {
+
+	// Camera in the object space of the mesh
+	struct View {
+		float position[3] = {};
+		float error_scale = 1.0f; // get_error_scale(), has to be > 0
+		float z_near = 0.1f;      // Closest distance used for the projection, the camera may sit inside a sphere
+	};
+
+	// Projected error 1 == pixel_threshold pixels on screen; proj_y is proj[1][1] of the view
+	inline float get_error_scale(float proj_y, float viewport_height, float pixel_threshold) {
+		return std::abs(proj_y) * 0.5f * viewport_height / std::max(pixel_threshold, 1e-3f);
+	}
+
+	inline float get_projected_error(const float center[3], float radius, float error, const View& view) {
+		const float dx = center[0] - view.position[0];
+		const float dy = center[1] - view.position[1];
+		const float dz = center[2] - view.position[2];
+		const float distance = std::sqrt(dx * dx + dy * dy + dz * dz) - radius;
+		return error * view.error_scale / std::max(distance, view.z_near);
+	}
+
+	inline bool is_selected(const asset::MeshletLodBounds& lod, const View& view) {
+		return get_projected_error(lod.center, lod.radius, lod.error, view) <= 1.0f
+			&& get_projected_error(lod.parent_center, lod.parent_radius, lod.parent_error, view) > 1.0f;
+	}
+
+	// CPU reference of the cut meshlet_cull.comp selects: appends the indices (into lods) of every drawn meshlet
+	inline void select_cut(const asset::MeshletLodBounds* lods, uint32_t count, const View& view, std::vector<uint32_t>& out) {
+		for (uint32_t i = 0; i < count; ++i) {
+			if (is_selected(lods[i], view)) out.push_back(i);
+		}
+	}
+
+	// Hierarchy invariants the cut relies on, returns the number of meshlets breaking one of them:
+	// error <= parent error, parent sphere around the own one, and every meshlet of a group agrees on its bounds
+	inline uint32_t count_hierarchy_errors(const asset::MeshletLodBounds* lods, uint32_t count) {
+		auto same_bounds = [](const float* a_center, float a_radius, float a_error, const float* b_center, float b_radius, float b_error) {
+			return std::memcmp(a_center, b_center, sizeof(float) * 3) == 0 && a_radius == b_radius && a_error == b_error;
+		};
+
+		std::unordered_map<uint32_t, uint32_t> group_meshlet;  // First meshlet built from the group
+		for (uint32_t i = 0; i < count; ++i) {
+			if (lods[i].group != asset::INVALID_INDEX) group_meshlet.try_emplace(lods[i].group, i);
+		}
+
+		uint32_t errors = 0;
+		for (uint32_t i = 0; i < count; ++i) {
+			const auto& lod = lods[i];
+			bool valid = lod.error <= lod.parent_error;
+
+			if (lod.parent_group != asset::INVALID_INDEX) {
+				const float dx = lod.parent_center[0] - lod.center[0];
+				const float dy = lod.parent_center[1] - lod.center[1];
+				const float dz = lod.parent_center[2] - lod.center[2];
+				const float slack = 1e-4f * std::max(lod.parent_radius, 1.0f);
+				valid = valid && std::sqrt(dx * dx + dy * dy + dz * dz) + lod.radius <= lod.parent_radius + slack;
+
+				// The parent group's meshlets carry the same bounds as their own
+				auto it = group_meshlet.find(lod.parent_group);
+				valid = valid && it != group_meshlet.end()
+					&& same_bounds(lod.parent_center, lod.parent_radius, lod.parent_error, lods[it->second].center, lods[it->second].radius, lods[it->second].error);
+			}
+			if (lod.group != asset::INVALID_INDEX) {
+				const auto& first = lods[group_meshlet[lod.group]];
+				valid = valid && same_bounds(lod.center, lod.radius, lod.error, first.center, first.radius, first.error);
+			}
+			if (!valid) errors++;
+		}
+		return errors;
+	}
+
+	// Vertex -> first vertex at the same position, so UV / normal seams do not count as open edges
+	inline std::vector<uint32_t> weld_positions(const float* positions, size_t vertex_count, size_t stride_bytes) {
+		struct Key {
+			uint32_t bits[3];
+			bool operator==(const Key& other) const { return std::memcmp(bits, other.bits, sizeof(bits)) == 0; }
+		};
+		struct KeyHash {
+			size_t operator()(const Key& key) const {
+				return (size_t(key.bits[0]) * 73856093u) ^ (size_t(key.bits[1]) * 19349663u) ^ (size_t(key.bits[2]) * 83492791u);
+			}
+		};
+
+		std::vector<uint32_t> remap(vertex_count);
+		std::unordered_map<Key, uint32_t, KeyHash> first;
+		first.reserve(vertex_count);
+		const auto* bytes = reinterpret_cast<const uint8_t*>(positions);
+		for (size_t v = 0; v < vertex_count; ++v) {
+			Key key;
+			std::memcpy(key.bits, bytes + v * stride_bytes, sizeof(key.bits));
+			remap[v] = first.try_emplace(key, static_cast<uint32_t>(v)).first->second;
+		}
+		return remap;
+	}
+
+	// Edges used by exactly one triangle of the list. A watertight cut has as many as the source meshlets
+	// (the mesh's own borders), every crack between two levels adds to it.
+	inline uint32_t count_open_edges(const uint32_t* indices, size_t index_count, const std::vector<uint32_t>& remap) {
+		std::unordered_map<uint64_t, uint32_t> edges;
+		edges.reserve(index_count);
+		for (size_t t = 0; t + 2 < index_count; t += 3) {
+			const uint32_t v[3] = { remap[indices[t]], remap[indices[t + 1]], remap[indices[t + 2]] };
+			if (v[0] == v[1] || v[1] == v[2] || v[0] == v[2]) continue;
+			for (int e = 0; e < 3; ++e) {
+				const uint32_t a = std::min(v[e], v[(e + 1) % 3]);
+				const uint32_t b = std::max(v[e], v[(e + 1) % 3]);
+				edges[(uint64_t(a) << 32) | b]++;
+			}
+		}
+		uint32_t open = 0;
+		for (const auto& [edge, uses] : edges) {
+			if (uses == 1) open++;
+		}
+		return open;
+	}
+}
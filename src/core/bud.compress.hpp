@@ -0,0 +1,146 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Small LZ77 block codec (LZ4-like sequence layout) shared by the engine and the tools.
+// Meant for build-time packed data such as the shader bundle: fast to decode, no dependency.
+//
+// Block layout, repeated until the input ends:
+//   token       high nibble = literal count, low nibble = match length - MIN_MATCH (15 = extended)
+//   [ext]       extension bytes of the literal count, 255 = keep reading
+//   literals
+//   offset      uint16, little endian, distance back into the output (absent in the last sequence)
+//   [ext]       extension bytes of the match length
+namespace bud::compress {
+
+	namespace detail {
+		constexpr uint32_t MIN_MATCH = 4;
+		constexpr uint32_t MAX_OFFSET = 65535;
+		constexpr uint32_t HASH_BITS = 14;
+		constexpr uint32_t LAST_LITERALS = 5;  // The block always ends in literals
+
+		inline uint32_t read_u32(const uint8_t* p) {
+			uint32_t v;
+			std::memcpy(&v, p, sizeof(v));
+			return v;
+		}
+
+		inline uint32_t hash(uint32_t v) {
+			return (v * 2654435761u) >> (32 - HASH_BITS);
+		}
+
+		inline void write_length(std::vector<uint8_t>& out, size_t length) {
+			while (length >= 255) {
+				out.push_back(255);
+				length -= 255;
+			}
+			out.push_back(static_cast<uint8_t>(length));
+		}
+	}
+
+	// Worst case grows the input by ~1/255 plus a few bytes; callers keep the raw data when it does not shrink
+	inline std::vector<uint8_t> lz_compress(const void* data, size_t size) {
+		using namespace detail;
+		const auto* src = static_cast<const uint8_t*>(data);
+
+		std::vector<uint8_t> out;
+		out.reserve(size / 2 + 16);
+
+		std::vector<uint32_t> table(size_t(1) << HASH_BITS, UINT32_MAX);
+
+		size_t anchor = 0;
+		size_t pos = 0;
+		const size_t match_limit = size > LAST_LITERALS + MIN_MATCH ? size - LAST_LITERALS : 0;
+
+		auto emit = [&](size_t literal_end, size_t match_length, size_t offset) {
+			const size_t literal_count = literal_end - anchor;
+			out.push_back(0);
+			const size_t token_index = out.size() - 1;
+
+			uint8_t token = 0;
+			token |= static_cast<uint8_t>((literal_count >= 15 ? 15 : literal_count) << 4);
+			if (literal_count >= 15) write_length(out, literal_count - 15);
+			out.insert(out.end(), src + anchor, src + literal_end);
+
+			if (match_length > 0) {
+				out.push_back(static_cast<uint8_t>(offset & 0xFF));
+				out.push_back(static_cast<uint8_t>(offset >> 8));
+				const size_t ml = match_length - MIN_MATCH;
+				token |= static_cast<uint8_t>(ml >= 15 ? 15 : ml);
+				if (ml >= 15) write_length(out, ml - 15);
+			}
+			out[token_index] = token;
+		};
+
+		while (pos + MIN_MATCH <= match_limit) {
+			const uint32_t seq = read_u32(src + pos);
+			const uint32_t h = hash(seq);
+			const uint32_t candidate = table[h];
+			table[h] = static_cast<uint32_t>(pos);
+
+			if (candidate == UINT32_MAX || pos - candidate > MAX_OFFSET || read_u32(src + candidate) != seq) {
+				++pos;
+				continue;
+			}
+
+			size_t length = MIN_MATCH;
+			while (pos + length < match_limit && src[candidate + length] == src[pos + length]) ++length;
+
+			emit(pos, length, pos - candidate);
+			pos += length;
+			anchor = pos;
+		}
+
+		emit(size, 0, 0);
+		return out;
+	}
+
+	// False on malformed input or when the output would not be exactly raw_size bytes
+	inline bool lz_decompress(const void* data, size_t size, void* dst, size_t raw_size) {
+		using namespace detail;
+		const auto* src = static_cast<const uint8_t*>(data);
+		auto* out = static_cast<uint8_t*>(dst);
+		size_t ip = 0;
+		size_t op = 0;
+
+		auto read_length = [&](size_t& length) {
+			uint8_t b;
+			do {
+				if (ip >= size) return false;
+				b = src[ip++];
+				length += b;
+			} while (b == 255);
+			return true;
+		};
+
+		while (ip < size) {
+			const uint8_t token = src[ip++];
+
+			size_t literal_count = token >> 4;
+			if (literal_count == 15 && !read_length(literal_count)) return false;
+			if (literal_count > size - ip || literal_count > raw_size - op) return false;
+			if (literal_count > 0) std::memcpy(out + op, src + ip, literal_count);
+			ip += literal_count;
+			op += literal_count;
+
+			if (ip == size) break; // Last sequence, literals only
+
+			if (size - ip < 2) return false;
+			const size_t offset = size_t(src[ip]) | (size_t(src[ip + 1]) << 8);
+			ip += 2;
+			size_t length = (token & 0x0F);
+			if (length == 15 && !read_length(length)) return false;
+			length += MIN_MATCH;
+
+			if (offset == 0 || offset > op || length > raw_size - op) return false;
+			// Byte copy, overlapping matches repeat the pattern
+			const uint8_t* match = out + op - offset;
+			for (size_t i = 0; i < length; ++i) out[op + i] = match[i];
+			op += length;
+		}
+
+		return op == raw_size;
+	}
+}
@@ -28,16 +28,5 @@ namespace bud::core {
 }
 
 // Logging implementation moved to a dedicated header/source pair.
-#ifndef NDEBUG
+// Release builds strip messages below BUD_LOG_MIN_LEVEL (Warning by default) at compile time.
 #include "bud.logger.hpp"
-#else
-namespace bud {
-    template<typename... Args>
-    constexpr void print([[maybe_unused]] Args&&...) noexcept {}
-    template<typename... Args>
-    constexpr void eprint([[maybe_unused]] Args&&...) noexcept {}
-    inline void set_log_backend_mask([[maybe_unused]] uint32_t) noexcept {}
-    inline uint32_t get_log_backend_mask() noexcept { return 0; }
-    inline void set_log_file([[maybe_unused]] const std::string&) noexcept {}
-}
-#endif
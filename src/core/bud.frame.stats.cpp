@@ -0,0 +1,337 @@
+﻿#include "bud.frame.stats.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <mutex>
+
+#include "src/core/bud.logger.hpp"
+
+namespace bud::frame_stats {
+
+	namespace {
+		// Phase times of one in-flight frame. pending counts the two events that close it:
+		// the work finishing (complete_frame) and the main loop period ending (next begin_frame).
+		struct FrameSlot {
+			std::atomic<uint64_t> frame{ 0 };
+			std::atomic<uint64_t> phase_ns[PHASE_COUNT];
+			std::atomic<uint32_t> pending{ 0 };
+		};
+
+		struct FrameStatsState {
+			FrameSlot slots[FRAME_SLOT_COUNT];
+			std::atomic<uint64_t> next_frame{ 0 };  // Written by the main thread only
+			uint64_t open_frame = 0;
+			uint64_t open_frame_start_ns = 0;
+			std::atomic<uint64_t> dropped_frames{ 0 };
+
+			std::mutex completed_mutex;
+			std::vector<FrameSample> completed;
+
+			std::mutex window_mutex;
+			std::deque<FrameSample> window;
+			FrameStatsSettings settings;
+			FrameStatsSummary summary;
+			uint64_t last_capture_ns = 0;
+		};
+
+		FrameStatsState& get_state() {
+			static FrameStatsState state;
+			return state;
+		}
+
+		thread_local uint64_t t_current_frame = 0;
+
+		FrameSlot& slot_of(FrameStatsState& state, uint64_t frame) {
+			return state.slots[frame % FRAME_SLOT_COUNT];
+		}
+
+		void release_frame(FrameStatsState& state, uint64_t frame) {
+			auto& slot = slot_of(state, frame);
+			if (frame == 0 || slot.frame.load(std::memory_order_acquire) != frame) return;
+			if (slot.pending.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+
+			FrameSample sample;
+			sample.frame_index = frame;
+			for (uint32_t p = 0; p < PHASE_COUNT; ++p) {
+				sample.phase_ms[p] = static_cast<float>(static_cast<double>(slot.phase_ns[p].load(std::memory_order_relaxed)) * 1e-6);
+			}
+
+			std::lock_guard<std::mutex> lock(state.completed_mutex);
+			state.completed.push_back(sample);
+		}
+
+		uint32_t bucket_of(float ms) {
+			uint32_t bucket = 0;
+			while (bucket < HISTOGRAM_BUCKET_COUNT - 1 && ms > HISTOGRAM_BUCKET_LIMITS_MS[bucket]) ++bucket;
+			return bucket;
+		}
+
+		// Nearest-rank percentile: the smallest sample with at least p of the set at or below it
+		// (ceil(p * n)-th in sorted order, no interpolation). values gets partially reordered.
+		float percentile(std::vector<float>& values, float p) {
+			if (values.empty()) return 0.0f;
+			const double n = static_cast<double>(values.size());
+			const size_t rank = static_cast<size_t>(std::clamp(std::ceil(static_cast<double>(p) * n), 1.0, n)) - 1;
+			std::nth_element(values.begin(), values.begin() + rank, values.end());
+			return values[rank];
+		}
+
+		// Called with window_mutex held
+		void rebuild_stats(FrameStatsState& state) {
+			std::vector<float> values;
+			values.reserve(state.window.size());
+
+			for (uint32_t p = 0; p < PHASE_COUNT; ++p) {
+				values.clear();
+				for (const auto& sample : state.window) values.push_back(sample.phase_ms[p]);
+				state.summary.phases[p] = compute_phase_stats(values);
+			}
+			state.summary.window_frames = static_cast<uint32_t>(state.window.size());
+		}
+
+		// Called with window_mutex held
+		bool write_capture(FrameStatsState& state, const std::string& path, uint32_t frame_count) {
+			std::filesystem::path file_path(path);
+			std::error_code ec;
+			if (file_path.has_parent_path()) {
+				std::filesystem::create_directories(file_path.parent_path(), ec);
+			}
+
+			std::ofstream out(file_path, std::ios::trunc);
+			if (!out.is_open()) {
+				bud::eprint("[FrameStats] Failed to open hitch capture: {}", path);
+				return false;
+			}
+
+			out << "frame";
+			for (uint32_t p = 0; p < PHASE_COUNT; ++p) out << ',' << phase_name(static_cast<FramePhase>(p)) << "_ms";
+			out << '\n';
+
+			const size_t first = state.window.size() > frame_count ? state.window.size() - frame_count : 0;
+			for (size_t i = first; i < state.window.size(); ++i) {
+				const auto& sample = state.window[i];
+				out << sample.frame_index;
+				for (uint32_t p = 0; p < PHASE_COUNT; ++p) out << std::format(",{:.3f}", sample.phase_ms[p]);
+				out << '\n';
+			}
+			return true;
+		}
+	}
+
+	const char* phase_name(FramePhase phase) {
+		switch (phase) {
+		case FramePhase::Logic: return "Logic";
+		case FramePhase::Extraction: return "Extraction";
+		case FramePhase::Culling: return "Culling";
+		case FramePhase::Sort: return "Sort";
+		case FramePhase::Record: return "Record";
+		case FramePhase::Submit: return "Submit";
+		case FramePhase::Present: return "Present";
+		case FramePhase::Frame: return "Frame";
+		default: return "Unknown";
+		}
+	}
+
+	uint64_t begin_frame() {
+		auto& state = get_state();
+		const uint64_t now = detail::now_ns();
+
+		if (state.open_frame != 0) {
+			auto& previous = slot_of(state, state.open_frame);
+			previous.phase_ns[static_cast<uint32_t>(FramePhase::Frame)].store(now - state.open_frame_start_ns, std::memory_order_relaxed);
+			release_frame(state, state.open_frame);
+		}
+
+		const uint64_t frame = state.next_frame.load(std::memory_order_relaxed) + 1;
+		auto& slot = slot_of(state, frame);
+		if (slot.pending.load(std::memory_order_acquire) != 0) {
+			// The render task fell FRAME_SLOT_COUNT frames behind, the old frame never reports
+			state.dropped_frames.fetch_add(1, std::memory_order_relaxed);
+		}
+		for (auto& ns : slot.phase_ns) ns.store(0, std::memory_order_relaxed);
+		slot.pending.store(2, std::memory_order_relaxed);
+		slot.frame.store(frame, std::memory_order_release);
+
+		state.open_frame = frame;
+		state.open_frame_start_ns = now;
+		state.next_frame.store(frame, std::memory_order_release);
+		t_current_frame = frame;
+		return frame;
+	}
+
+	uint64_t get_open_frame() {
+		return get_state().next_frame.load(std::memory_order_acquire);
+	}
+
+	void complete_frame(uint64_t frame) {
+		release_frame(get_state(), frame);
+	}
+
+	void set_current_frame(uint64_t frame) {
+		t_current_frame = frame;
+	}
+
+	uint64_t get_current_frame() {
+		return t_current_frame;
+	}
+
+	void add_phase_time(uint64_t frame, FramePhase phase, uint64_t duration_ns) {
+		if (frame == 0 || phase >= FramePhase::Count) return;
+		auto& slot = slot_of(get_state(), frame);
+		if (slot.frame.load(std::memory_order_acquire) != frame) return;
+		slot.phase_ns[static_cast<uint32_t>(phase)].fetch_add(duration_ns, std::memory_order_relaxed);
+	}
+
+	void update() {
+		auto& state = get_state();
+
+		std::vector<FrameSample> completed;
+		{
+			std::lock_guard<std::mutex> lock(state.completed_mutex);
+			completed.swap(state.completed);
+		}
+		if (completed.empty()) return;
+
+		// Completion order depends on which side closed the frame last
+		std::sort(completed.begin(), completed.end(), [](const FrameSample& a, const FrameSample& b) { return a.frame_index < b.frame_index; });
+
+		std::lock_guard<std::mutex> lock(state.window_mutex);
+		const auto& settings = state.settings;
+		const uint64_t now = detail::now_ns();
+		const uint64_t cooldown_ns = static_cast<uint64_t>(settings.capture_cooldown_s * 1e9);
+
+		for (const auto& sample : completed) {
+			state.window.push_back(sample);
+			while (state.window.size() > STATS_WINDOW_FRAMES) state.window.pop_front();
+			state.summary.frames++;
+
+			// Median of the window before this frame, so a hitch doesn't raise its own bar
+			const float frame_ms = sample.phase_ms[static_cast<uint32_t>(FramePhase::Frame)];
+			float threshold = settings.hitch_threshold_ms;
+			if (settings.hitch_median_factor > 0.0f && state.summary.window_frames > 0) {
+				threshold = std::min(threshold, settings.hitch_median_factor * state.summary.phases[static_cast<uint32_t>(FramePhase::Frame)].p50_ms);
+			}
+			if (frame_ms <= threshold) continue;
+
+			state.summary.hitches++;
+			state.summary.last_hitch_ms = frame_ms;
+			state.summary.last_hitch_frame = sample.frame_index;
+
+			if (settings.capture_on_hitch && (state.last_capture_ns == 0 || now - state.last_capture_ns > cooldown_ns)) {
+				std::string path = (std::filesystem::path(settings.capture_dir) / std::format("bud_frame_hitch_{}.csv", sample.frame_index)).string();
+				if (write_capture(state, path, settings.capture_frames)) {
+					state.summary.captures++;
+					bud::wprint("[FrameStats] Hitch {:.2f} ms (> {:.2f} ms) at frame {}, phase timings written to {}", frame_ms, threshold, sample.frame_index, path);
+				}
+				state.last_capture_ns = now;
+			}
+		}
+
+		rebuild_stats(state);
+		state.summary.dropped_frames = state.dropped_frames.load(std::memory_order_relaxed);
+	}
+
+	void set_settings(const FrameStatsSettings& settings) {
+		auto& state = get_state();
+		std::lock_guard<std::mutex> lock(state.window_mutex);
+		state.settings = settings;
+	}
+
+	FrameStatsSettings get_settings() {
+		auto& state = get_state();
+		std::lock_guard<std::mutex> lock(state.window_mutex);
+		return state.settings;
+	}
+
+	FrameStatsSummary get_summary() {
+		auto& state = get_state();
+		std::lock_guard<std::mutex> lock(state.window_mutex);
+		return state.summary;
+	}
+
+	void get_phase_history(FramePhase phase, std::vector<float>& out_ms) {
+		auto& state = get_state();
+		std::lock_guard<std::mutex> lock(state.window_mutex);
+		out_ms.clear();
+		if (phase >= FramePhase::Count) return;
+		out_ms.reserve(state.window.size());
+		for (const auto& sample : state.window) out_ms.push_back(sample.phase_ms[static_cast<uint32_t>(phase)]);
+	}
+
+	void get_samples_after(uint64_t frame_index, std::vector<FrameSample>& out) {
+		auto& state = get_state();
+		std::lock_guard<std::mutex> lock(state.window_mutex);
+		out.clear();
+		for (const auto& sample : state.window) {
+			if (sample.frame_index > frame_index) out.push_back(sample);
+		}
+	}
+
+	PhaseStats compute_phase_stats(std::vector<float> values_ms) {
+		PhaseStats stats;
+		if (values_ms.empty()) return stats;
+
+		double sum = 0.0;
+		for (float ms : values_ms) {
+			sum += ms;
+			stats.max_ms = std::max(stats.max_ms, ms);
+			stats.histogram[bucket_of(ms)]++;
+		}
+		stats.mean_ms = static_cast<float>(sum / static_cast<double>(values_ms.size()));
+		stats.p50_ms = percentile(values_ms, 0.50f);
+		stats.p95_ms = percentile(values_ms, 0.95f);
+		stats.p99_ms = percentile(values_ms, 0.99f);
+		return stats;
+	}
+
+	void reset() {
+		auto& state = get_state();
+		std::lock_guard<std::mutex> lock(state.window_mutex);
+		state.window.clear();
+		state.summary = {};
+		state.last_capture_ns = 0;
+		state.dropped_frames.store(0, std::memory_order_relaxed);
+	}
+
+	bool write_summary(const std::string& path) {
+		auto& state = get_state();
+		std::lock_guard<std::mutex> lock(state.window_mutex);
+
+		std::filesystem::path file_path(path);
+		std::error_code ec;
+		if (file_path.has_parent_path()) {
+			std::filesystem::create_directories(file_path.parent_path(), ec);
+		}
+
+		std::ofstream out(file_path, std::ios::trunc);
+		if (!out.is_open()) {
+			bud::eprint("[FrameStats] Failed to open summary file: {}", path);
+			return false;
+		}
+
+		const auto& summary = state.summary;
+		out << "{\n";
+		out << std::format("  \"frames\": {},\n  \"window_frames\": {},\n  \"hitches\": {},\n  \"captures\": {},\n  \"dropped_frames\": {},\n",
+			summary.frames, summary.window_frames, summary.hitches, summary.captures, summary.dropped_frames);
+		out << std::format("  \"hitch_threshold_ms\": {:.3f},\n", state.settings.hitch_threshold_ms);
+
+		out << "  \"histogram_limits_ms\": [";
+		for (uint32_t b = 0; b < HISTOGRAM_BUCKET_COUNT - 1; ++b) out << (b ? ", " : "") << std::format("{:.1f}", HISTOGRAM_BUCKET_LIMITS_MS[b]);
+		out << "],\n";
+
+		out << "  \"phases\": {\n";
+		for (uint32_t p = 0; p < PHASE_COUNT; ++p) {
+			const auto& stats = summary.phases[p];
+			out << std::format("    \"{}\": {{ \"p50_ms\": {:.3f}, \"p95_ms\": {:.3f}, \"p99_ms\": {:.3f}, \"mean_ms\": {:.3f}, \"max_ms\": {:.3f}, \"histogram\": [",
+				phase_name(static_cast<FramePhase>(p)), stats.p50_ms, stats.p95_ms, stats.p99_ms, stats.mean_ms, stats.max_ms);
+			for (uint32_t b = 0; b < HISTOGRAM_BUCKET_COUNT; ++b) out << (b ? ", " : "") << stats.histogram[b];
+			out << "] }" << (p + 1 < PHASE_COUNT ? "," : "") << '\n';
+		}
+		out << "  }\n}\n";
+		return true;
+	}
+}
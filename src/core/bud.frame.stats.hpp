@@ -0,0 +1,148 @@
+﻿#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Rolling frame-time statistics per engine phase. No UI dependency, so automated/headless runs
+// get the same percentiles, histograms and hitch captures as the stats overlay.
+namespace bud::frame_stats {
+
+	enum class FramePhase : uint32_t {
+		Logic,       // Fixed-step game logic, summed over the steps of the frame
+		Extraction,  // Scene -> RenderScene copy and culling BVH build
+		Culling,     // Main view + cascade frustum culling
+		Sort,        // Draw key generation, sort and shadow draw list
+		Record,      // Render graph build, compile and command recording
+		Submit,      // Command buffer end + queue submit
+		Present,     // Fence wait / image acquire (begin_frame) + queue present
+		Frame,       // Main loop period, the number users feel
+		Count
+	};
+
+	constexpr uint32_t PHASE_COUNT = static_cast<uint32_t>(FramePhase::Count);
+	constexpr uint32_t STATS_WINDOW_FRAMES = 600;  // ~10 s at 60 Hz
+	constexpr uint32_t FRAME_SLOT_COUNT = 8;       // Frames that can be open at once (main thread ahead of the render task)
+
+	// Upper bounds in ms, the last bucket is open ended
+	constexpr uint32_t HISTOGRAM_BUCKET_COUNT = 12;
+	constexpr float HISTOGRAM_BUCKET_LIMITS_MS[HISTOGRAM_BUCKET_COUNT - 1] = {
+		0.5f, 1.0f, 2.0f, 4.0f, 8.0f, 12.0f, 16.7f, 25.0f, 33.3f, 50.0f, 100.0f
+	};
+
+	const char* phase_name(FramePhase phase);
+
+	struct FrameSample {
+		uint64_t frame_index = 0;
+		float phase_ms[PHASE_COUNT] = {};
+	};
+
+	struct PhaseStats {
+		float p50_ms = 0.0f;
+		float p95_ms = 0.0f;
+		float p99_ms = 0.0f;
+		float mean_ms = 0.0f;
+		float max_ms = 0.0f;
+		uint32_t histogram[HISTOGRAM_BUCKET_COUNT] = {};
+	};
+
+	struct FrameStatsSettings {
+		float hitch_threshold_ms = 50.0f;
+		float hitch_median_factor = 0.0f;   // > 0: frames longer than factor * p50 also count as hitches
+		bool capture_on_hitch = true;
+		uint32_t capture_frames = 120;      // Frames before (and including) the hitch written to the capture
+		float capture_cooldown_s = 5.0f;    // Writing the capture can hitch too, don't chain them
+		std::string capture_dir = "tmp";
+		std::string summary_path;           // Written when the engine shuts down, empty = off
+	};
+
+	struct FrameStatsSummary {
+		uint64_t frames = 0;                // Frames folded in since the last reset
+		uint32_t window_frames = 0;         // Frames the percentiles cover
+		uint64_t hitches = 0;
+		uint64_t captures = 0;
+		uint64_t dropped_frames = 0;        // Open frames overwritten before they completed
+		float last_hitch_ms = 0.0f;
+		uint64_t last_hitch_frame = 0;
+		PhaseStats phases[PHASE_COUNT];
+	};
+
+	namespace detail {
+		inline uint64_t now_ns() {
+			return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now().time_since_epoch()).count());
+		}
+	}
+
+	// Main thread, once per loop iteration. Closes the period of the previous frame and makes
+	// the new one current on the calling thread.
+	uint64_t begin_frame();
+
+	// Last frame opened by begin_frame, readable from any thread
+	uint64_t get_open_frame();
+
+	// A frame completes once its work is done (complete_frame) and its period has ended (next begin_frame)
+	void complete_frame(uint64_t frame);
+
+	// Threads working on behalf of a frame (the render task) attribute their phases to it
+	void set_current_frame(uint64_t frame);
+	uint64_t get_current_frame();
+
+	void add_phase_time(uint64_t frame, FramePhase phase, uint64_t duration_ns);
+
+	// Main thread: folds completed frames into the window, updates the statistics, detects hitches
+	// and writes hitch captures
+	void update();
+
+	void set_settings(const FrameStatsSettings& settings);
+	FrameStatsSettings get_settings();
+
+	FrameStatsSummary get_summary();
+	void get_phase_history(FramePhase phase, std::vector<float>& out_ms);
+
+	// Window samples newer than frame_index, in frame order. Callers that keep every frame
+	// (benchmarks) poll this more often than STATS_WINDOW_FRAMES.
+	void get_samples_after(uint64_t frame_index, std::vector<FrameSample>& out);
+	void reset();
+
+	// Nearest-rank percentiles, mean, max and histogram of an arbitrary sample set
+	PhaseStats compute_phase_stats(std::vector<float> values_ms);
+
+	// Percentiles and histograms of the current window as JSON, for automated runs
+	bool write_summary(const std::string& path);
+
+	// Times one phase for the frame current at construction
+	class ScopedPhase {
+	public:
+		explicit ScopedPhase(FramePhase phase) : phase(phase), frame(get_current_frame()), start_ns(detail::now_ns()) {}
+		~ScopedPhase() { add_phase_time(frame, phase, detail::now_ns() - start_ns); }
+
+		ScopedPhase(const ScopedPhase&) = delete;
+		ScopedPhase& operator=(const ScopedPhase&) = delete;
+
+	private:
+		FramePhase phase;
+		uint64_t frame;
+		uint64_t start_ns;
+	};
+
+	// Splits a straight-line section into consecutive phases: lap() charges the time since the previous lap
+	class PhaseTimer {
+	public:
+		PhaseTimer() : frame(get_current_frame()), last_ns(detail::now_ns()) {}
+
+		void lap(FramePhase phase) {
+			uint64_t now = detail::now_ns();
+			add_phase_time(frame, phase, now - last_ns);
+			last_ns = now;
+		}
+
+		void skip() { last_ns = detail::now_ns(); }
+
+	private:
+		uint64_t frame;
+		uint64_t last_ns;
+	};
+}
@@ -1,6 +1,9 @@
 ﻿#include "bud.logger.hpp"
-#include <iomanip>
-#include <sstream>
+#include <algorithm>
+#include <charconv>
+#include <ctime>
+#include <iterator>
+#include <unordered_map>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -9,6 +12,7 @@
 namespace bud {
 
 	static std::atomic<Logger*> g_active_logger{ nullptr };
+	static std::atomic<uint64_t> g_logger_generation{ 0 };
 
 	void set_global_logger(Logger* logger) {
 		g_active_logger.store(logger, std::memory_order_release);
@@ -18,53 +22,340 @@ namespace bud {
 		return g_active_logger.load(std::memory_order_acquire);
 	}
 
-	std::string make_log_prefix() {
-		using namespace std::chrono;
-		auto now = system_clock::now();
-		auto ms = duration_cast<milliseconds>(now.time_since_epoch()) % 1000;
-		std::time_t t = system_clock::to_time_t(now);
+	const char* get_log_level_name(LogLevel level) {
+		switch (level) {
+		case LogLevel::Verbose: return "Verbose";
+		case LogLevel::Info: return "Info";
+		case LogLevel::Warning: return "Warning";
+		case LogLevel::Error: return "Error";
+		case LogLevel::Off: return "Off";
+		}
+		return "Unknown";
+	}
+
+	const char* get_log_category_name(LogCategory category) {
+		switch (category) {
+		case LogCategory::Core: return "Core";
+		case LogCategory::Platform: return "Platform";
+		case LogCategory::Threading: return "Threading";
+		case LogCategory::IO: return "IO";
+		case LogCategory::RHI: return "RHI";
+		case LogCategory::Render: return "Render";
+		case LogCategory::UI: return "UI";
+		case LogCategory::Game: return "Game";
+		case LogCategory::Count: break;
+		}
+		return "Unknown";
+	}
+
+	void set_log_level(LogLevel level) {
+		log_detail::category_filter.store(log_detail::make_uniform_filter(level), std::memory_order_relaxed);
+	}
+
+	void set_log_category_level(LogCategory category, LogLevel level) {
+		const uint32_t shift = static_cast<uint32_t>(category) * 4;
+		uint64_t filter = log_detail::category_filter.load(std::memory_order_relaxed);
+		uint64_t updated = 0;
+		do {
+			updated = (filter & ~(0xFull << shift)) | (static_cast<uint64_t>(level) << shift);
+		} while (!log_detail::category_filter.compare_exchange_weak(filter, updated, std::memory_order_relaxed));
+	}
+
+	LogLevel get_log_category_level(LogCategory category) {
+		uint64_t filter = log_detail::category_filter.load(std::memory_order_relaxed);
+		return static_cast<LogLevel>((filter >> (static_cast<uint32_t>(category) * 4)) & 0xF);
+	}
+
+	std::string make_log_tags(LogLevel level, LogCategory category) {
+		std::string tags;
+		if (level == LogLevel::Error) tags += "[ERROR] ";
+		else if (level == LogLevel::Warning) tags += "[WARN] ";
+		else if (level == LogLevel::Verbose) tags += "[VERBOSE] ";
+
+		if (category != LogCategory::Core) {
+			tags += '[';
+			tags += get_log_category_name(category);
+			tags += "] ";
+		}
+		return tags;
+	}
+
+	static std::tm to_local_tm(std::time_t t) {
 		std::tm tm_info{};
 #ifdef _WIN32
 		localtime_s(&tm_info, &t);
 #else
 		localtime_r(&t, &tm_info);
 #endif
+		return tm_info;
+	}
 
-		std::ostringstream ss;
-		ss << std::put_time(&tm_info, "%H:%M:%S") << "." << std::setfill('0') << std::setw(3) << ms.count();
+	std::string make_log_prefix(uint64_t timestamp_ns, uint32_t thread_tag) {
+		std::time_t t = static_cast<std::time_t>(timestamp_ns / 1'000'000'000ull);
+		uint64_t ms = (timestamp_ns / 1'000'000ull) % 1000;
+		std::tm tm_info = to_local_tm(t);
 
-		// thread id as hashed value for compactness
-		auto tid = std::this_thread::get_id();
-		size_t tid_hash = std::hash<std::thread::id>{}(tid);
-		ss << " [TID=" << std::setw(6) << (tid_hash % 1000000) << "] ";
-		return ss.str();
+		return std::format("{:02}:{:02}:{:02}.{:03} [TID={:06}] ", tm_info.tm_hour, tm_info.tm_min, tm_info.tm_sec, ms, thread_tag);
+	}
+
+	namespace {
+		struct DecodedArg {
+			LogArgType type = LogArgType::Int;
+			int64_t i = 0;
+			uint64_t u = 0;
+			double f = 0.0;
+			float f32 = 0.0f;
+			std::string_view str;
+		};
+
+		template<typename T>
+		bool read_pod(const std::byte* payload, size_t payload_size, size_t& pos, T& out) {
+			if (pos + sizeof(T) > payload_size) return false;
+			std::memcpy(&out, payload + pos, sizeof(T));
+			pos += sizeof(T);
+			return true;
+		}
+
+		// Stops at the first malformed argument, the remaining fields print as "{?}"
+		void decode_args(const std::byte* payload, size_t payload_size, std::vector<DecodedArg>& args) {
+			size_t pos = 0;
+			while (pos < payload_size) {
+				DecodedArg arg;
+				if (!read_pod(payload, payload_size, pos, arg.type)) return;
+
+				bool ok = true;
+				switch (arg.type) {
+				case LogArgType::Int: ok = read_pod(payload, payload_size, pos, arg.i); break;
+				case LogArgType::UInt:
+				case LogArgType::Pointer: ok = read_pod(payload, payload_size, pos, arg.u); break;
+				case LogArgType::Float: ok = read_pod(payload, payload_size, pos, arg.f); break;
+				case LogArgType::Float32: ok = read_pod(payload, payload_size, pos, arg.f32); break;
+				case LogArgType::Bool: {
+					uint8_t v = 0;
+					ok = read_pod(payload, payload_size, pos, v);
+					arg.u = v;
+					break;
+				}
+				case LogArgType::Char: {
+					char v = 0;
+					ok = read_pod(payload, payload_size, pos, v);
+					arg.i = v;
+					break;
+				}
+				case LogArgType::String: {
+					uint32_t length = 0;
+					ok = read_pod(payload, payload_size, pos, length) && pos + length <= payload_size;
+					if (ok) {
+						arg.str = std::string_view(reinterpret_cast<const char*>(payload + pos), length);
+						pos += length;
+					}
+					break;
+				}
+				default:
+					ok = false;
+					break;
+				}
+
+				if (!ok) return;
+				args.push_back(arg);
+			}
+		}
+
+		void format_arg(std::string& out, const DecodedArg& arg, std::string_view spec) {
+			std::string field;
+			field.reserve(spec.size() + 2);
+			field += '{';
+			field += spec;
+			field += '}';
+
+			auto sink = std::back_inserter(out);
+			try {
+				switch (arg.type) {
+				case LogArgType::Int: { int64_t v = arg.i; std::vformat_to(sink, field, std::make_format_args(v)); break; }
+				case LogArgType::UInt: { uint64_t v = arg.u; std::vformat_to(sink, field, std::make_format_args(v)); break; }
+				case LogArgType::Float: { double v = arg.f; std::vformat_to(sink, field, std::make_format_args(v)); break; }
+				case LogArgType::Float32: { float v = arg.f32; std::vformat_to(sink, field, std::make_format_args(v)); break; }
+				case LogArgType::Bool: { bool v = arg.u != 0; std::vformat_to(sink, field, std::make_format_args(v)); break; }
+				case LogArgType::Char: { char v = static_cast<char>(arg.i); std::vformat_to(sink, field, std::make_format_args(v)); break; }
+				case LogArgType::Pointer: { const void* v = reinterpret_cast<const void*>(static_cast<uintptr_t>(arg.u)); std::vformat_to(sink, field, std::make_format_args(v)); break; }
+				case LogArgType::String: { std::string_view v = arg.str; std::vformat_to(sink, field, std::make_format_args(v)); break; }
+				}
+			}
+			catch (const std::format_error&) {
+				out += "{?}";
+			}
+		}
+	}
+
+	std::string format_log_record(std::string_view fmt, const std::byte* payload, size_t payload_size) {
+		thread_local std::vector<DecodedArg> args;
+		args.clear();
+		decode_args(payload, payload_size, args);
+
+		std::string out;
+		out.reserve(fmt.size() + payload_size);
+
+		size_t auto_index = 0;
+		size_t i = 0;
+		while (i < fmt.size()) {
+			size_t next = fmt.find_first_of("{}", i);
+			if (next == std::string_view::npos) {
+				out.append(fmt.substr(i));
+				break;
+			}
+			out.append(fmt.substr(i, next - i));
+			i = next;
+
+			if (fmt[i] == '}') {
+				out += '}';
+				i += (i + 1 < fmt.size() && fmt[i + 1] == '}') ? 2 : 1;
+				continue;
+			}
+
+			if (i + 1 < fmt.size() && fmt[i + 1] == '{') {
+				out += '{';
+				i += 2;
+				continue;
+			}
+
+			// Replacement field, nested braces only appear for dynamic width/precision
+			size_t close = i + 1;
+			int depth = 1;
+			int nested = 0;
+			while (close < fmt.size()) {
+				if (fmt[close] == '{') {
+					depth++;
+					nested++;
+				}
+				else if (fmt[close] == '}' && --depth == 0) {
+					break;
+				}
+				close++;
+			}
+			if (close >= fmt.size()) {
+				out.append(fmt.substr(i));
+				break;
+			}
+
+			std::string_view field = fmt.substr(i + 1, close - i - 1);
+			i = close + 1;
+
+			size_t colon = field.find(':');
+			std::string_view id_part = field.substr(0, colon);
+			std::string_view spec = colon == std::string_view::npos ? std::string_view{} : field.substr(colon);
+
+			size_t index = auto_index;
+			if (id_part.empty()) {
+				auto_index++;
+			}
+			else {
+				std::from_chars(id_part.data(), id_part.data() + id_part.size(), index);
+			}
+
+			if (nested > 0) {
+				out += "{?}";
+				auto_index += nested;
+			}
+			else if (index < args.size()) {
+				format_arg(out, args[index], spec);
+			}
+			else {
+				out += "{?}";
+			}
+		}
+
+		return out;
+	}
+
+	LogRing::LogRing(uint32_t thread_tag) : buffer(std::make_unique<std::byte[]>(LOG_RING_CAPACITY)), thread_tag(thread_tag) {
+	}
+
+	bool LogRing::try_write(const LogRecordHeader& header, const std::byte* payload) {
+		const uint64_t size = record_size(header.payload_size);
+		if (size > LOG_RING_CAPACITY / 2) {
+			dropped.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+
+		uint64_t w = write_pos.load(std::memory_order_relaxed);
+		const uint64_t r = read_pos.load(std::memory_order_acquire);
+
+		uint64_t offset = w % LOG_RING_CAPACITY;
+		const uint64_t to_end = LOG_RING_CAPACITY - offset;
+		const uint64_t needed = to_end < size ? to_end + size : size;
+
+		if (LOG_RING_CAPACITY - (w - r) < needed) {
+			// 过载时丢弃, 不阻塞调用线程; 由日志线程汇报丢弃数量
+			dropped.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+
+		if (to_end < size) {
+			if (to_end >= sizeof(LogRecordHeader)) {
+				LogRecordHeader padding;
+				padding.format_id = PADDING_FORMAT_ID;
+				std::memcpy(buffer.get() + offset, &padding, sizeof(LogRecordHeader));
+			}
+			w += to_end;
+			offset = 0;
+		}
+
+		std::memcpy(buffer.get() + offset, &header, sizeof(LogRecordHeader));
+		if (header.payload_size > 0) {
+			std::memcpy(buffer.get() + offset + sizeof(LogRecordHeader), payload, header.payload_size);
+		}
+
+		write_pos.store(w + size, std::memory_order_release);
+		return true;
+	}
+
+	bool LogRing::peek(uint64_t end, LogRecordHeader& header, const std::byte*& payload) {
+		uint64_t r = read_pos.load(std::memory_order_relaxed);
+		bool found = false;
+
+		while (r < end) {
+			const uint64_t offset = r % LOG_RING_CAPACITY;
+			const uint64_t to_end = LOG_RING_CAPACITY - offset;
+			if (to_end < sizeof(LogRecordHeader)) {
+				r += to_end;
+				continue;
+			}
+
+			std::memcpy(&header, buffer.get() + offset, sizeof(LogRecordHeader));
+			if (header.format_id == PADDING_FORMAT_ID) {
+				r += to_end;
+				continue;
+			}
+
+			payload = buffer.get() + offset + sizeof(LogRecordHeader);
+			found = true;
+			break;
+		}
+
+		// Skipped padding goes back to the producer right away
+		read_pos.store(r, std::memory_order_release);
+		return found;
+	}
+
+	void LogRing::pop(const LogRecordHeader& header) {
+		read_pos.store(read_pos.load(std::memory_order_relaxed) + record_size(header.payload_size), std::memory_order_release);
 	}
 
 	Logger::Logger(const std::filesystem::path& root_dir) {
+		generation = g_logger_generation.fetch_add(1, std::memory_order_relaxed) + 1;
 		backend_mask.store(LogBackend_Console | LogBackend_DebugOutput);
 
-		if (!root_dir.empty()) {
-			auto make_timestamp = []() -> std::string {
-				using namespace std::chrono;
-				auto now = system_clock::now();
-				std::time_t t = system_clock::to_time_t(now);
-				std::tm tm_info{};
-#ifdef _WIN32
-				localtime_s(&tm_info, &t);
-#else
-				localtime_r(&t, &tm_info);
-#endif
-				std::ostringstream ss;
-				ss << std::put_time(&tm_info, "%Y%m%d_%H%M%S");
-				return ss.str();
-				};
+		formats.push_back("{}"); // LOG_RAW_STRING_FORMAT_ID
 
-			auto ts = make_timestamp();
+		if (!root_dir.empty()) {
+			std::tm tm_info = to_local_tm(std::chrono::system_clock::to_time_t(std::chrono::system_clock::now()));
+			auto ts = std::format("{:04}{:02}{:02}_{:02}{:02}{:02}",
+				tm_info.tm_year + 1900, tm_info.tm_mon + 1, tm_info.tm_mday, tm_info.tm_hour, tm_info.tm_min, tm_info.tm_sec);
 			auto log_path = root_dir / ("bud_" + ts + ".log");
 			set_log_file(log_path.string());
 		}
 
-		is_running = true;
+		is_running.store(true, std::memory_order_release);
 		logger_thread = std::thread(&Logger::io_thread_loop, this);
 	}
 
@@ -81,7 +372,7 @@ namespace bud {
 	}
 
 	void Logger::set_log_file(const std::string& path) {
-		std::lock_guard<std::mutex> lock(log_writter_mutex);
+		std::lock_guard<std::mutex> lock(file_mutex);
 		if (file_stream.is_open()) {
 			file_stream.close();
 		}
@@ -103,17 +394,142 @@ namespace bud {
 		}
 	}
 
-	void Logger::enqueue_log(const std::string& msg, bool is_error) {
-		if (!is_running) return;
+	void Logger::set_binary_log_file(const std::string& path) {
+		std::lock_guard<std::mutex> lock(file_mutex);
+		if (binary_stream.is_open()) {
+			binary_stream.close();
+		}
+		binary_formats_written.clear();
+
+		if (!path.empty()) {
+			binary_stream.open(path, std::ios::binary | std::ios::trunc);
+			if (binary_stream) {
+				binary_stream.write(LOG_FILE_MAGIC, sizeof(LOG_FILE_MAGIC));
+				backend_mask.fetch_or(LogBackend_Binary, std::memory_order_relaxed);
+			}
+			else {
+				backend_mask.fetch_and(~LogBackend_Binary, std::memory_order_relaxed);
+				std::println(stderr, "[Logger] FATAL: Can't open : {}", path);
+			}
+		}
+		else {
+			backend_mask.fetch_and(~LogBackend_Binary, std::memory_order_relaxed);
+		}
+	}
+
+	uint32_t Logger::intern_format(std::string_view fmt) {
+		// 同一个格式串字面量地址固定, 线程本地缓存命中时不加锁
+		struct FormatCache {
+			uint64_t generation = 0;
+			std::unordered_map<const char*, uint32_t> ids;
+		};
+		thread_local FormatCache cache;
+
+		if (cache.generation != generation) {
+			cache.ids.clear();
+			cache.generation = generation;
+		}
+
+		if (auto it = cache.ids.find(fmt.data()); it != cache.ids.end()) {
+			return it->second;
+		}
+
+		uint32_t id = 0;
+		{
+			std::lock_guard<std::mutex> lock(format_mutex);
+			auto it = std::find(formats.begin(), formats.end(), fmt);
+			if (it != formats.end()) {
+				id = static_cast<uint32_t>(it - formats.begin());
+			}
+			else {
+				id = static_cast<uint32_t>(formats.size());
+				formats.emplace_back(fmt);
+			}
+		}
+
+		cache.ids.emplace(fmt.data(), id);
+		return id;
+	}
+
+	LogRing* Logger::get_thread_ring() {
+		// Thread exit retires the ring, the logger thread drops it once everything in it is written out
+		struct RingSlot {
+			uint64_t generation = 0;
+			std::shared_ptr<LogRing> ring;
+
+			~RingSlot() {
+				if (ring) ring->retire();
+			}
+		};
+		thread_local RingSlot slot;
+
+		if (slot.generation == generation) {
+			return slot.ring.get();
+		}
 
-		std::string full_msg = make_log_prefix() + msg;
+		// thread id as hashed value for compactness
+		size_t tid_hash = std::hash<std::thread::id>{}(std::this_thread::get_id());
+		auto ring = std::make_shared<LogRing>(static_cast<uint32_t>(tid_hash % 1000000));
+
+		slot.ring = ring;
+		slot.generation = generation;
+
+		std::lock_guard<std::mutex> lock(rings_mutex);
+		rings.push_back(std::move(ring));
+		return slot.ring.get();
+	}
+
+	bool Logger::write_record(uint32_t format_id, LogLevel level, LogCategory category, const std::byte* payload, uint32_t payload_size) {
+		if (!is_running.load(std::memory_order_relaxed)) return false;
+
+		LogRing* ring = get_thread_ring();
+
+		LogRecordHeader header;
+		header.timestamp_ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::system_clock::now().time_since_epoch()).count());
+		header.format_id = format_id;
+		header.thread_tag = ring->get_thread_tag();
+		header.payload_size = payload_size;
+		header.level = level;
+		header.category = category;
 
+		// A drop is reported by the logger thread, so it is woken either way
+		const bool written = ring->try_write(header, payload);
+		wake_logger_thread();
+		return written;
+	}
+
+	void Logger::wake_logger_thread() {
+		// Pairs with the fence in io_thread_loop: either this load sees the flag cleared, or the logger
+		// thread's last look at the rings saw the record just written
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (wake_pending.load(std::memory_order_relaxed) || wake_pending.exchange(true, std::memory_order_relaxed)) {
+			return;
+		}
+
+		// Empty critical section: the logger thread is either before its predicate check or already waiting
 		{
 			std::lock_guard<std::mutex> lock(log_writter_mutex);
-			log_queue.push_back({ std::move(full_msg), is_error });
 		}
+		resource_condition_guard.notify_all();
+	}
+
+	void Logger::enqueue_log(const std::string& msg, bool is_error) {
+		enqueue_log(msg, is_error ? LogLevel::Error : LogLevel::Info, LogCategory::Core);
+	}
+
+	void Logger::enqueue_log(const std::string& msg, LogLevel level, LogCategory category) {
+		thread_local std::vector<std::byte> scratch;
+
+		uint32_t length = static_cast<uint32_t>(std::min<size_t>(msg.size(), LOG_MAX_STRING_PAYLOAD));
+		LogArgType type = LogArgType::String;
 
-		resource_condition_guard.notify_one();
+		scratch.resize(sizeof(type) + sizeof(length) + length);
+		std::memcpy(scratch.data(), &type, sizeof(type));
+		std::memcpy(scratch.data() + sizeof(type), &length, sizeof(length));
+		std::memcpy(scratch.data() + sizeof(type) + sizeof(length), msg.data(), length);
+
+		write_record(LOG_RAW_STRING_FORMAT_ID, level, category, scratch.data(), static_cast<uint32_t>(scratch.size()));
 	}
 
 	void Logger::log(const std::string& msg) {
@@ -121,31 +537,27 @@ namespace bud {
 	}
 
 	void Logger::log_error(const std::string& msg) {
-		enqueue_log(std::string("[ERROR] ") + msg, true);
+		enqueue_log(msg, true);
 	}
 
 	void Logger::flush() {
-		while (true) {
-			{
-				std::lock_guard<std::mutex> lock(log_writter_mutex);
-				if (log_queue.empty()) break;
-			}
-			std::this_thread::yield();
-		}
+		std::unique_lock<std::mutex> lock(log_writter_mutex);
+		if (!is_running.load(std::memory_order_acquire)) return;
 
-		std::lock_guard<std::mutex> lock(log_writter_mutex);
-		if (file_stream.is_open()) {
-			file_stream.flush();
-		}
+		uint64_t target = ++flush_requested;
+		resource_condition_guard.notify_all();
+		resource_condition_guard.wait(lock, [this, target]() {
+			return flush_completed >= target || !is_running.load(std::memory_order_acquire);
+			});
 	}
 
 	void Logger::stop() {
 		{
 			std::lock_guard<std::mutex> lock(log_writter_mutex);
-			if (!is_running)
+			if (!is_running.load(std::memory_order_acquire))
 				return; // 防止重复 stop
 
-			is_running = false;
+			is_running.store(false, std::memory_order_release);
 		}
 
 		resource_condition_guard.notify_all();
@@ -154,59 +566,220 @@ namespace bud {
 			logger_thread.join(); // 强行按住主线程，直到所有遗留日志写完
 		}
 
+		std::lock_guard<std::mutex> lock(file_mutex);
 		if (file_stream.is_open()) {
 			file_stream.close();
 		}
+		if (binary_stream.is_open()) {
+			binary_stream.close();
+		}
 	}
 
-	void Logger::io_thread_loop() {
-		std::vector<LogMessage> local_queue;
-		local_queue.reserve(128);
+	void Logger::emit_text(const std::string& text, LogLevel level, uint32_t mask) {
+		if (mask & LogBackend_Console) {
+			if (level >= LogLevel::Warning) {
+				std::println(stderr, "{}", text);
+			}
+			else {
+				std::println("{}", text);
+			}
+		}
 
-		while (true) {
-			{
-				std::unique_lock<std::mutex> lock(log_writter_mutex);
-				resource_condition_guard.wait(lock, [this]() {
-					return !log_queue.empty() || !is_running;
-					});
+		if (mask & LogBackend_DebugOutput) {
+#ifdef _WIN32
+			OutputDebugStringA((text + "\n").c_str());
+#endif
+		}
 
-				if (log_queue.empty() && !is_running) {
-					break;
+		if (mask & LogBackend_File) {
+			std::lock_guard<std::mutex> lock(file_mutex);
+			if (file_stream.is_open()) {
+				file_stream << text << '\n';
+			}
+		}
+	}
+
+	void Logger::write_binary_format(uint32_t format_id) {
+		if (format_id >= binary_formats_written.size()) {
+			binary_formats_written.resize(format_id + 1, false);
+		}
+		if (binary_formats_written[format_id]) return;
+
+		const std::string& fmt = consumer_formats[format_id];
+		LogChunk kind = LogChunk::Format;
+		uint32_t length = static_cast<uint32_t>(fmt.size());
+		binary_stream.write(reinterpret_cast<const char*>(&kind), sizeof(kind));
+		binary_stream.write(reinterpret_cast<const char*>(&format_id), sizeof(format_id));
+		binary_stream.write(reinterpret_cast<const char*>(&length), sizeof(length));
+		binary_stream.write(fmt.data(), length);
+		binary_formats_written[format_id] = true;
+	}
+
+	size_t Logger::drain_rings() {
+		const uint32_t mask = backend_mask.load(std::memory_order_relaxed);
+		const bool text_output = (mask & (LogBackend_Console | LogBackend_DebugOutput | LogBackend_File)) != 0;
+		const bool binary_backend = (mask & LogBackend_Binary) != 0;
+
+		// Formatting runs without any lock, file_mutex only guards the stream writes against set_log_file / stop
+		auto on_record = [&](const LogRecordHeader& header, const std::byte* payload) {
+			if (header.format_id >= consumer_formats.size()) {
+				std::lock_guard<std::mutex> lock(format_mutex);
+				consumer_formats.insert(consumer_formats.end(), formats.begin() + consumer_formats.size(), formats.end());
+			}
+			if (header.format_id >= consumer_formats.size()) return;
+
+			if (binary_backend) {
+				std::lock_guard<std::mutex> file_lock(file_mutex);
+				if (binary_stream.is_open()) {
+					write_binary_format(header.format_id);
+					LogChunk kind = LogChunk::Record;
+					binary_stream.write(reinterpret_cast<const char*>(&kind), sizeof(kind));
+					binary_stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+					binary_stream.write(reinterpret_cast<const char*>(payload), header.payload_size);
 				}
+			}
+
+			if (text_output) {
+				std::string text = make_log_prefix(header.timestamp_ns, header.thread_tag);
+				text += make_log_tags(header.level, header.category);
+				text += format_log_record(consumer_formats[header.format_id], payload, header.payload_size);
+				emit_text(text, header.level, mask);
+			}
+		};
+
+		// k-way merge by timestamp over what every ring holds at this point. A record timestamped before the
+		// pass but written after the snapshot comes out in the next pass, so the order is exact within a pass.
+		struct MergeCursor {
+			LogRing* ring = nullptr;
+			uint64_t end = 0;
+			LogRecordHeader header;
+			const std::byte* payload = nullptr;
+		};
+		thread_local std::vector<MergeCursor> heap;
+		auto later = [](const MergeCursor& a, const MergeCursor& b) { return a.header.timestamp_ns > b.header.timestamp_ns; };
+
+		// Snapshot of the ring list: a thread logging for the first time only waits for this copy, not the drain.
+		// The shared_ptrs keep retired rings alive until the list is pruned below.
+		thread_local std::vector<std::shared_ptr<LogRing>> drain_list;
+		{
+			std::lock_guard<std::mutex> rings_lock(rings_mutex);
+			drain_list.assign(rings.begin(), rings.end());
+		}
 
-				local_queue.swap(log_queue);
+		size_t count = 0;
+		heap.clear();
+		for (auto& ring : drain_list) {
+			MergeCursor cursor;
+			cursor.ring = ring.get();
+			cursor.end = ring->get_write_pos();
+			if (ring->peek(cursor.end, cursor.header, cursor.payload)) {
+				heap.push_back(cursor);
 			}
+		}
+		std::make_heap(heap.begin(), heap.end(), later);
 
-			uint32_t mask = backend_mask.load(std::memory_order_relaxed);
+		while (!heap.empty()) {
+			std::pop_heap(heap.begin(), heap.end(), later);
+			auto& cursor = heap.back();
+			on_record(cursor.header, cursor.payload);
+			cursor.ring->pop(cursor.header);
+			count++;
 
-			for (const auto& msg : local_queue) {
-				if (mask & LogBackend_Console) {
-					if (msg.is_error) {
-						std::println(stderr, "{}", msg.text);
-					}
-					else {
-						std::println("{}", msg.text);
-					}
-				}
+			if (cursor.ring->peek(cursor.end, cursor.header, cursor.payload)) {
+				std::push_heap(heap.begin(), heap.end(), later);
+			}
+			else {
+				heap.pop_back();
+			}
+		}
 
-				if (mask & LogBackend_DebugOutput) {
-#ifdef _WIN32
-					OutputDebugStringA((msg.text + "\n").c_str());
-#endif
+		for (auto& ring : drain_list) {
+			uint64_t dropped = ring->take_dropped();
+			if (dropped > 0) {
+				total_dropped.fetch_add(dropped, std::memory_order_relaxed);
+
+				if (binary_backend) {
+					std::lock_guard<std::mutex> file_lock(file_mutex);
+					LogChunk kind = LogChunk::Dropped;
+					uint32_t thread_tag = ring->get_thread_tag();
+					if (binary_stream.is_open()) {
+						binary_stream.write(reinterpret_cast<const char*>(&kind), sizeof(kind));
+						binary_stream.write(reinterpret_cast<const char*>(&thread_tag), sizeof(thread_tag));
+						binary_stream.write(reinterpret_cast<const char*>(&dropped), sizeof(dropped));
+					}
 				}
 
-				if (mask & LogBackend_File) {
-					if (file_stream.is_open()) {
-						file_stream << msg.text << '\n';
-					}
+				if (text_output) {
+					emit_text(std::format("[Logger] Dropped {} messages from TID={:06} (ring buffer full)", dropped, ring->get_thread_tag()), LogLevel::Warning, mask);
 				}
 			}
+		}
 
-			if ((mask & LogBackend_File) && file_stream.is_open() && !local_queue.empty()) {
+		// 256 KB per ring: rings of exited threads go as soon as nothing is left in them
+		drain_list.clear();
+		{
+			std::lock_guard<std::mutex> rings_lock(rings_mutex);
+			std::erase_if(rings, [](const std::shared_ptr<LogRing>& ring) {
+				return ring->is_retired() && ring->empty() && !ring->has_dropped();
+				});
+		}
+
+		if (count > 0) {
+			std::lock_guard<std::mutex> file_lock(file_mutex);
+			if ((mask & LogBackend_File) && file_stream.is_open()) {
 				file_stream.flush();
 			}
+			if (binary_backend && binary_stream.is_open()) {
+				binary_stream.flush();
+			}
+		}
+
+		return count;
+	}
+
+	bool Logger::has_pending_records() {
+		std::lock_guard<std::mutex> lock(rings_mutex);
+		return std::any_of(rings.begin(), rings.end(), [](const std::shared_ptr<LogRing>& ring) {
+			return !ring->empty() || ring->has_dropped();
+			});
+	}
+
+	void Logger::io_thread_loop() {
+		while (true) {
+			uint64_t flush_target = 0;
+			{
+				std::lock_guard<std::mutex> lock(log_writter_mutex);
+				flush_target = flush_requested;
+			}
 
-			local_queue.clear();
+			// 先读运行状态再排空: stop() 之前写入的记录一定会在最后一轮被处理
+			bool running = is_running.load(std::memory_order_acquire);
+			size_t drained = drain_rings();
+
+			{
+				std::lock_guard<std::mutex> lock(log_writter_mutex);
+				flush_completed = flush_target;
+			}
+			resource_condition_guard.notify_all();
+
+			if (!running) {
+				break;
+			}
+
+			if (drained == 0) {
+				// No polling: the first record after the flag is cleared wakes the thread (wake_logger_thread).
+				// Records written before the clear saw the flag still set, one more look catches them.
+				wake_pending.store(false, std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				if (has_pending_records()) {
+					continue;
+				}
+
+				std::unique_lock<std::mutex> lock(log_writter_mutex);
+				resource_condition_guard.wait(lock, [this]() {
+					return wake_pending.load(std::memory_order_relaxed) || flush_requested != flush_completed || !is_running.load(std::memory_order_acquire);
+					});
+			}
 		}
 	}
 
@@ -1,6 +1,7 @@
 ﻿#pragma once
 
 #include <string>
+#include <string_view>
 #include <format>
 #include <print>
 #include <chrono>
@@ -8,10 +9,14 @@
 #include <mutex>
 #include <condition_variable>
 #include <vector>
+#include <memory>
 #include <atomic>
 #include <fstream>
 #include <filesystem>
+#include <type_traits>
 #include <cstdint>
+#include <cstddef>
+#include <cstring>
 
 #ifdef _WIN32
 #ifndef NOMINMAX
@@ -19,15 +24,263 @@
 #endif
 #endif
 
+// Build-time floor, 0 Verbose / 1 Info / 2 Warning / 3 Error / 4 Off.
+// Calls below it compile to nothing; release builds keep warnings and errors.
+#ifndef BUD_LOG_MIN_LEVEL
+#ifdef NDEBUG
+#define BUD_LOG_MIN_LEVEL 2
+#else
+#define BUD_LOG_MIN_LEVEL 0
+#endif
+#endif
+
 namespace bud {
 
-	std::string make_log_prefix();
+	enum class LogLevel : uint8_t {
+		Verbose = 0,
+		Info = 1,
+		Warning = 2,
+		Error = 3,
+		Off = 4
+	};
+
+	// At most 16 categories, each owns a 4-bit slot of the runtime filter word
+	enum class LogCategory : uint8_t {
+		Core = 0,
+		Platform,
+		Threading,
+		IO,
+		RHI,
+		Render,
+		UI,
+		Game,
+		Count
+	};
+	static_assert(static_cast<uint32_t>(LogCategory::Count) <= 16, "Runtime log filter packs 16 categories into 64 bits");
+
+	const char* get_log_level_name(LogLevel level);
+	const char* get_log_category_name(LogCategory category);
+
+	constexpr bool is_log_level_compiled(LogLevel level) {
+		return level != LogLevel::Off && static_cast<uint8_t>(level) >= BUD_LOG_MIN_LEVEL;
+	}
+
+	namespace log_detail {
+		constexpr uint64_t make_uniform_filter(LogLevel level) {
+			uint64_t filter = 0;
+			for (uint32_t i = 0; i < static_cast<uint32_t>(LogCategory::Count); ++i) {
+				filter |= static_cast<uint64_t>(level) << (i * 4);
+			}
+			return filter;
+		}
+
+		// Minimum runtime level per category, verbose output is opt-in
+		inline std::atomic<uint64_t> category_filter{ make_uniform_filter(LogLevel::Info) };
+	}
+
+	// One relaxed load, safe to call from any thread or fiber
+	inline bool is_log_enabled(LogLevel level, LogCategory category) {
+		uint64_t filter = log_detail::category_filter.load(std::memory_order_relaxed);
+		uint64_t min_level = (filter >> (static_cast<uint32_t>(category) * 4)) & 0xF;
+		return static_cast<uint64_t>(level) >= min_level;
+	}
+
+	void set_log_level(LogLevel level);  // All categories
+	void set_log_category_level(LogCategory category, LogLevel level);
+	LogLevel get_log_category_level(LogCategory category);
+
+	// Per call site limiter for BUD_LOG_RATE_LIMITED, constant-initialized so the static needs no guard
+	class LogRateLimiter {
+	public:
+		explicit constexpr LogRateLimiter(uint32_t interval_ms) : interval_ns(static_cast<uint64_t>(interval_ms) * 1'000'000ull) {}
+
+		// True when the site may log again, suppressed receives the calls skipped since the last message
+		bool try_acquire(uint32_t& suppressed) {
+			uint64_t now = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now().time_since_epoch()).count());
+			uint64_t next = next_allowed_ns.load(std::memory_order_relaxed);
+			if (now < next || !next_allowed_ns.compare_exchange_strong(next, now + interval_ns, std::memory_order_relaxed)) {
+				suppressed_count.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+			suppressed = suppressed_count.exchange(0, std::memory_order_relaxed);
+			return true;
+		}
+
+	private:
+		uint64_t interval_ns = 0;
+		std::atomic<uint64_t> next_allowed_ns{ 0 };
+		std::atomic<uint32_t> suppressed_count{ 0 };
+	};
+
+	// 时间戳 (system_clock, ns) + 线程标记 -> "HH:MM:SS.mmm [TID=xxxxxx] "
+	std::string make_log_prefix(uint64_t timestamp_ns, uint32_t thread_tag);
 
 	enum LogBackend : uint32_t {
 		LogBackend_Console = 1 << 0,
 		LogBackend_DebugOutput = 1 << 1, // OutputDebugString on Windows
-		LogBackend_File = 1 << 2
+		LogBackend_File = 1 << 2,
+		LogBackend_Binary = 1 << 3       // Raw records, decoded offline by BudLogTool
+	};
+
+	// Binary record layout
+	// Producer threads never format: a record is the format-site id plus the raw arguments,
+	// each tagged with its type. The logger thread (or BudLogTool, from a .budlog file) turns
+	// it back into text with format_log_record.
+	enum class LogArgType : uint8_t {
+		Int,      // int64_t
+		UInt,     // uint64_t
+		Float,    // double
+		Bool,     // uint8_t
+		Char,     // char
+		Pointer,  // uint64_t
+		String,   // uint32_t length + bytes
+		Float32   // float, printed with float precision (appended, older .budlog files still decode)
+	};
+
+	struct LogRecordHeader {
+		uint64_t timestamp_ns = 0;  // system_clock since epoch
+		uint32_t format_id = 0;
+		uint32_t thread_tag = 0;
+		uint32_t payload_size = 0;
+		LogLevel level = LogLevel::Info;
+		LogCategory category = LogCategory::Core;
+		uint16_t reserved = 0;
 	};
+	static_assert(sizeof(LogRecordHeader) % 8 == 0, "LogRecordHeader must keep ring records 8-byte aligned");
+
+	constexpr uint32_t LOG_RING_CAPACITY = 256 * 1024;       // Bytes per producer thread
+	constexpr uint32_t LOG_MAX_INLINE_PAYLOAD = 1024;        // Larger argument lists are formatted eagerly
+	constexpr uint32_t LOG_MAX_STRING_PAYLOAD = 16 * 1024;   // Longer legacy strings are truncated
+	constexpr uint32_t LOG_RAW_STRING_FORMAT_ID = 0;         // Built-in "{}" site, used for preformatted text
+
+	// .budlog file: magic, then chunks. Format chunks appear before the first record that uses them.
+	constexpr char LOG_FILE_MAGIC[8] = { 'B', 'U', 'D', 'L', 'O', 'G', '2', '\0' };
+
+	enum class LogChunk : uint8_t {
+		Format = 0,   // uint32_t id, uint32_t length, bytes
+		Record = 1,   // LogRecordHeader, payload
+		Dropped = 2   // uint32_t thread tag, uint64_t count
+	};
+
+	// "[WARN] [Render] " style tags between the prefix and the message, Core has no category tag
+	std::string make_log_tags(LogLevel level, LogCategory category);
+
+	// Decodes the payload against its format string. Supports automatic/manual indexing and
+	// standard format specs per field, nested dynamic width/precision is printed verbatim.
+	std::string format_log_record(std::string_view fmt, const std::byte* payload, size_t payload_size);
+
+	// Single producer (owning thread) / single consumer (logger thread) byte ring.
+	// Records are 8-byte aligned and never split: when one does not fit before the end,
+	// the tail is skipped (with a padding header if there is room for one).
+	class LogRing {
+	public:
+		explicit LogRing(uint32_t thread_tag);
+
+		LogRing(const LogRing&) = delete;
+		LogRing& operator=(const LogRing&) = delete;
+
+		bool try_write(const LogRecordHeader& header, const std::byte* payload);
+
+		// Consumer side, one record at a time up to `end` (a get_write_pos snapshot) so the logger thread can
+		// merge rings by timestamp. peek skips padding, the payload stays valid until pop.
+		bool peek(uint64_t end, LogRecordHeader& header, const std::byte*& payload);
+		void pop(const LogRecordHeader& header);
+		uint64_t get_write_pos() const { return write_pos.load(std::memory_order_acquire); }
+
+		bool empty() const {
+			return read_pos.load(std::memory_order_acquire) == write_pos.load(std::memory_order_acquire);
+		}
+
+		uint64_t take_dropped() { return dropped.exchange(0, std::memory_order_relaxed); }
+		bool has_dropped() const { return dropped.load(std::memory_order_relaxed) != 0; }
+		uint32_t get_thread_tag() const { return thread_tag; }
+
+		// The owning thread exited, the logger frees the ring once it is drained
+		void retire() { retired.store(true, std::memory_order_release); }
+		bool is_retired() const { return retired.load(std::memory_order_acquire); }
+
+		static constexpr uint32_t PADDING_FORMAT_ID = UINT32_MAX;
+
+		static constexpr uint64_t record_size(uint32_t payload_size) {
+			return (sizeof(LogRecordHeader) + payload_size + 7ull) & ~7ull;
+		}
+
+	private:
+		std::unique_ptr<std::byte[]> buffer;
+		uint32_t thread_tag = 0;
+
+		alignas(64) std::atomic<uint64_t> write_pos{ 0 };
+		alignas(64) std::atomic<uint64_t> read_pos{ 0 };
+		alignas(64) std::atomic<uint64_t> dropped{ 0 };
+		std::atomic<bool> retired{ false };
+	};
+
+	namespace log_detail {
+		// Fixed stack buffer for one record's arguments, no heap on the calling thread
+		struct ArgEncoder {
+			std::byte data[LOG_MAX_INLINE_PAYLOAD];
+			uint32_t size = 0;
+			bool overflow = false;
+
+			void put(const void* src, size_t bytes) {
+				if (overflow || size + bytes > LOG_MAX_INLINE_PAYLOAD) {
+					overflow = true;
+					return;
+				}
+				std::memcpy(data + size, src, bytes);
+				size += static_cast<uint32_t>(bytes);
+			}
+
+			template<typename T>
+			void put_value(LogArgType type, T value) {
+				put(&type, sizeof(type));
+				put(&value, sizeof(value));
+			}
+
+			void put_string(std::string_view str) {
+				LogArgType type = LogArgType::String;
+				uint32_t length = static_cast<uint32_t>(str.size());
+				put(&type, sizeof(type));
+				put(&length, sizeof(length));
+				put(str.data(), str.size());
+			}
+		};
+
+		template<typename T>
+		void encode_arg(ArgEncoder& enc, const T& value) {
+			using D = std::remove_cvref_t<T>;
+			if constexpr (std::is_same_v<D, bool>) {
+				enc.put_value(LogArgType::Bool, static_cast<uint8_t>(value));
+			}
+			else if constexpr (std::is_same_v<D, char>) {
+				enc.put_value(LogArgType::Char, value);
+			}
+			else if constexpr (std::is_integral_v<D> && std::is_signed_v<D>) {
+				enc.put_value(LogArgType::Int, static_cast<int64_t>(value));
+			}
+			else if constexpr (std::is_integral_v<D>) {
+				enc.put_value(LogArgType::UInt, static_cast<uint64_t>(value));
+			}
+			else if constexpr (std::is_same_v<D, float>) {
+				// Widening would print 0.1f as 0.10000000149011612
+				enc.put_value(LogArgType::Float32, value);
+			}
+			else if constexpr (std::is_floating_point_v<D>) {
+				enc.put_value(LogArgType::Float, static_cast<double>(value));
+			}
+			else if constexpr (std::is_convertible_v<const D&, std::string_view>) {
+				enc.put_string(std::string_view(value));
+			}
+			else if constexpr (std::is_pointer_v<D> || std::is_null_pointer_v<D>) {
+				enc.put_value(LogArgType::Pointer, static_cast<uint64_t>(reinterpret_cast<uintptr_t>(static_cast<const void*>(value))));
+			}
+			else {
+				// 没有对应类型标签的类型 (自定义 formatter 等) 在调用处格式化
+				enc.put_string(std::format("{}", value));
+			}
+		}
+	}
 
 	class Logger {
 	public:
@@ -42,30 +295,60 @@ namespace bud {
 		void set_backend_mask(uint32_t mask);
 		uint32_t get_backend_mask() const;
 		void set_log_file(const std::string& path);
+		void set_binary_log_file(const std::string& path);
 
 		void flush();
 		void stop();
 
+		// Preformatted text, kept for callers that already own a string (crash handler etc.)
 		void log(const std::string& msg);
 		void log_error(const std::string& msg);
 		void enqueue_log(const std::string& msg, bool is_error);
+		void enqueue_log(const std::string& msg, LogLevel level, LogCategory category);
+
+		// Interns a format site, cached per thread by the literal's address
+		uint32_t intern_format(std::string_view fmt);
+		// Copies one record into the calling thread's ring, false (and counted) when full
+		bool write_record(uint32_t format_id, LogLevel level, LogCategory category, const std::byte* payload, uint32_t payload_size);
+
+		uint64_t get_dropped_count() const { return total_dropped.load(std::memory_order_relaxed); }
 
 	private:
 		void io_thread_loop();
+		LogRing* get_thread_ring();
+		size_t drain_rings();
+		bool has_pending_records();
+		void wake_logger_thread();
+		void emit_text(const std::string& text, LogLevel level, uint32_t mask);
+		void write_binary_format(uint32_t format_id);
 
-		struct LogMessage {
-			std::string text;
-			bool is_error;
-		};
-
+		uint64_t generation = 0;  // Invalidates thread-local ring/format caches of a previous Logger
 		std::atomic<uint32_t> backend_mask{ 0 };
+
+		std::mutex file_mutex;
 		std::string log_file_path;
 		std::ofstream file_stream;
+		std::ofstream binary_stream;
+		std::vector<bool> binary_formats_written;
+
+		// Format sites, append only. Producers take the lock only on a thread-local cache miss.
+		std::mutex format_mutex;
+		std::vector<std::string> formats;
+		std::vector<std::string> consumer_formats;  // Logger thread copy, refreshed on unknown ids
 
+		// Shared with the owning thread's slot, which retires the ring on thread exit
+		std::mutex rings_mutex;
+		std::vector<std::shared_ptr<LogRing>> rings;
+		std::atomic<uint64_t> total_dropped{ 0 };
+
+		// Logger thread wake-up and flush handshake. A producer only takes the mutex when it is the first
+		// to write after the logger thread went to sleep (wake_pending false).
+		std::atomic<bool> wake_pending{ false };
 		std::mutex log_writter_mutex;
 		std::condition_variable resource_condition_guard;
-		std::vector<LogMessage> log_queue;
-		bool is_running{ false };
+		uint64_t flush_requested = 0;
+		uint64_t flush_completed = 0;
+		std::atomic<bool> is_running{ false };
 
 		std::thread logger_thread;
 	};
@@ -74,27 +357,91 @@ namespace bud {
 	void set_global_logger(Logger* logger);
 	Logger* get_global_logger();
 
+	// Unfiltered write, callers check is_log_level_compiled / is_log_enabled first
 	template<typename... Args>
-	inline void print(std::format_string<Args...> fmt, Args&&... args) {
-		std::string body = std::format(fmt, std::forward<Args>(args)...);
-		if (auto g = get_global_logger()) {
-			g->log(body);
+	inline void write_log(LogLevel level, LogCategory category, std::format_string<Args...> fmt, Args&&... args) {
+		auto g = get_global_logger();
+		if (!g) {
+			// 引擎没启动或已崩溃时，直接输出到控制台
+			std::string text = make_log_tags(level, category) + std::format(fmt, std::forward<Args>(args)...);
+			if (level >= LogLevel::Warning) {
+				std::println(stderr, "{}", text);
+			}
+			else {
+				std::println("{}", text);
+			}
+			return;
+		}
+
+		log_detail::ArgEncoder enc;
+		(log_detail::encode_arg(enc, args), ...);
+
+		if (!enc.overflow) {
+			g->write_record(g->intern_format(fmt.get()), level, category, enc.data, enc.size);
 		}
 		else {
-			// 引擎没启动或已崩溃时，直接输出到控制台
-			std::println("{}", body);
+			// 参数太大放不进一条记录, 退回到调用处格式化
+			g->enqueue_log(std::format(fmt, std::forward<Args>(args)...), level, category);
+		}
+	}
+
+	// Level is a template argument so calls below BUD_LOG_MIN_LEVEL compile to an empty body.
+	// The arguments are still evaluated, hot loops should use the BUD_LOG_* macros instead.
+	template<LogLevel Level, typename... Args>
+	inline void log_message(LogCategory category, std::format_string<Args...> fmt, Args&&... args) {
+		if constexpr (is_log_level_compiled(Level)) {
+			if (is_log_enabled(Level, category)) {
+				write_log(Level, category, fmt, std::forward<Args>(args)...);
+			}
 		}
 	}
 
+	template<typename... Args>
+	inline void print(std::format_string<Args...> fmt, Args&&... args) {
+		log_message<LogLevel::Info>(LogCategory::Core, fmt, std::forward<Args>(args)...);
+	}
+
+	template<typename... Args>
+	inline void wprint(std::format_string<Args...> fmt, Args&&... args) {
+		log_message<LogLevel::Warning>(LogCategory::Core, fmt, std::forward<Args>(args)...);
+	}
+
 	template<typename... Args>
 	inline void eprint(std::format_string<Args...> fmt, Args&&... args) {
-		std::string body = std::format(fmt, std::forward<Args>(args)...);
-		if (auto g = get_global_logger()) {
-			g->log_error(body);
-		}
-		else {
-			std::println(stderr, "[ERROR] {}", body);
-		}
+		log_message<LogLevel::Error>(LogCategory::Core, fmt, std::forward<Args>(args)...);
 	}
 
 } // namespace bud
+
+// BUD_LOG_INFO(RHI, "[Vulkan] ...", args): level and category are bare enumerator names.
+// Below the build-time level nothing is emitted, not even the argument expressions.
+#define BUD_LOG(level, category, ...) \
+	do { \
+		if constexpr (::bud::is_log_level_compiled(::bud::LogLevel::level)) { \
+			if (::bud::is_log_enabled(::bud::LogLevel::level, ::bud::LogCategory::category)) { \
+				::bud::write_log(::bud::LogLevel::level, ::bud::LogCategory::category, __VA_ARGS__); \
+			} \
+		} \
+	} while (0)
+
+#define BUD_LOG_VERBOSE(category, ...) BUD_LOG(Verbose, category, __VA_ARGS__)
+#define BUD_LOG_INFO(category, ...) BUD_LOG(Info, category, __VA_ARGS__)
+#define BUD_LOG_WARN(category, ...) BUD_LOG(Warning, category, __VA_ARGS__)
+#define BUD_LOG_ERROR(category, ...) BUD_LOG(Error, category, __VA_ARGS__)
+
+// At most one message per interval_ms from this call site, the next one reports how many were skipped
+#define BUD_LOG_RATE_LIMITED(level, category, interval_ms, ...) \
+	do { \
+		if constexpr (::bud::is_log_level_compiled(::bud::LogLevel::level)) { \
+			if (::bud::is_log_enabled(::bud::LogLevel::level, ::bud::LogCategory::category)) { \
+				static ::bud::LogRateLimiter bud_log_limiter{ interval_ms }; \
+				uint32_t bud_log_suppressed = 0; \
+				if (bud_log_limiter.try_acquire(bud_log_suppressed)) { \
+					::bud::write_log(::bud::LogLevel::level, ::bud::LogCategory::category, __VA_ARGS__); \
+					if (bud_log_suppressed > 0) { \
+						::bud::write_log(::bud::LogLevel::level, ::bud::LogCategory::category, "  ({} similar messages suppressed)", bud_log_suppressed); \
+					} \
+				} \
+			} \
+		} \
+	} while (0)
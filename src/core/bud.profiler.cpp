@@ -0,0 +1,456 @@
+﻿#include "bud.profiler.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <format>
+#include <fstream>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "src/core/bud.logger.hpp"
+
+namespace bud::profiler {
+
+	namespace {
+		// Single producer (owning thread) / single consumer (end_frame) ring of finished zones
+		struct ThreadState {
+			uint32_t index = 0;
+			std::string name;
+			std::unique_ptr<ZoneEvent[]> events = std::make_unique<ZoneEvent[]>(ZONE_RING_CAPACITY);
+
+			alignas(64) std::atomic<uint64_t> write_pos{ 0 };
+			alignas(64) std::atomic<uint64_t> read_pos{ 0 };
+			std::atomic<uint64_t> dropped{ 0 };
+
+			void push(const ZoneEvent& event) {
+				uint64_t w = write_pos.load(std::memory_order_relaxed);
+				if (w - read_pos.load(std::memory_order_acquire) >= ZONE_RING_CAPACITY) {
+					dropped.fetch_add(1, std::memory_order_relaxed);
+					return;
+				}
+				events[w % ZONE_RING_CAPACITY] = event;
+				write_pos.store(w + 1, std::memory_order_release);
+			}
+		};
+
+		struct ProfilerState {
+			std::mutex threads_mutex;
+			std::vector<std::unique_ptr<ThreadState>> threads;  // Never shrinks, threads keep raw pointers
+
+			std::mutex history_mutex;
+			std::deque<FrameProfile> history;
+			std::deque<float> frame_times_ms;
+			uint64_t frame_index = 0;
+			uint64_t last_frame_end_ns = 0;
+			uint64_t last_hitch_export_ns = 0;
+			uint64_t hitch_exports = 0;
+
+			ProfilerSettings settings;
+			ProfilerOverhead overhead;
+			bool calibrated = false;
+		};
+
+		ProfilerState& get_state() {
+			static ProfilerState state;
+			return state;
+		}
+
+		thread_local ZoneStack t_thread_zones;
+		thread_local ZoneStack* t_active_zones = nullptr;
+		thread_local ThreadState* t_thread_state = nullptr;
+
+		ZoneStack& active_zones() {
+			return t_active_zones ? *t_active_zones : t_thread_zones;
+		}
+
+		ThreadState& get_thread_state() {
+			if (!t_thread_state) [[unlikely]] {
+				auto& state = get_state();
+				std::lock_guard<std::mutex> lock(state.threads_mutex);
+				auto thread_state = std::make_unique<ThreadState>();
+				thread_state->index = static_cast<uint32_t>(state.threads.size());
+				thread_state->name = std::format("Thread {}", thread_state->index);
+				t_thread_state = thread_state.get();
+				state.threads.push_back(std::move(thread_state));
+			}
+			return *t_thread_state;
+		}
+
+		void emit(const ZoneStack& zones, uint32_t slot, uint64_t end_ns, uint16_t extra_flags) {
+			const auto& entry = zones.entries[slot];
+			ZoneEvent event;
+			event.site = entry.site;
+			event.start_ns = entry.start_ns;
+			event.end_ns = end_ns;
+			event.depth = static_cast<uint16_t>(zones.base_depth + slot);
+			event.flags = static_cast<uint16_t>(entry.flags | extra_flags);
+
+			auto& thread_state = get_thread_state();
+			event.thread_index = thread_state.index;
+			thread_state.push(event);
+		}
+
+		std::string escape_json(std::string_view text) {
+			std::string out;
+			out.reserve(text.size());
+			for (char c : text) {
+				if (c == '"' || c == '\\') {
+					out += '\\';
+					out += c;
+				}
+				else if (static_cast<unsigned char>(c) < 0x20) {
+					out += ' ';
+				}
+				else {
+					out += c;
+				}
+			}
+			return out;
+		}
+
+		// Called with history_mutex held
+		bool write_chrome_trace(ProfilerState& state, const std::string& path, uint32_t frame_count) {
+			if (state.history.empty()) return false;
+
+			std::filesystem::path file_path(path);
+			std::error_code ec;
+			if (file_path.has_parent_path()) {
+				std::filesystem::create_directories(file_path.parent_path(), ec);
+			}
+
+			std::ofstream out(file_path, std::ios::trunc);
+			if (!out.is_open()) {
+				bud::eprint("[Profiler] Failed to open trace file: {}", path);
+				return false;
+			}
+
+			const size_t first = state.history.size() > frame_count ? state.history.size() - frame_count : 0;
+			const uint64_t origin_ns = state.history[first].start_ns;
+			auto to_us = [origin_ns](uint64_t ns) { return static_cast<double>(ns - std::min(ns, origin_ns)) * 1e-3; };
+
+			constexpr uint32_t FRAME_LANE = 1000;
+			out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+			out << std::format("{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":{},\"args\":{{\"name\":\"Frames\"}}}}", FRAME_LANE);
+
+			{
+				std::lock_guard<std::mutex> lock(state.threads_mutex);
+				for (const auto& thread : state.threads) {
+					out << std::format(",\n{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":{},\"args\":{{\"name\":\"{}\"}}}}",
+						thread->index, escape_json(thread->name));
+				}
+			}
+
+			for (size_t f = first; f < state.history.size(); ++f) {
+				const auto& frame = state.history[f];
+				out << std::format(",\n{{\"name\":\"Frame {}\",\"cat\":\"frame\",\"ph\":\"X\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f}}}",
+					frame.frame_index, FRAME_LANE, to_us(frame.start_ns), static_cast<double>(frame.end_ns - frame.start_ns) * 1e-3);
+
+				for (const auto& zone : frame.zones) {
+					out << std::format(",\n{{\"name\":\"{}\",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f},\"args\":{{\"file\":\"{}\",\"line\":{}{}}}}}",
+						escape_json(zone.site->name), zone.thread_index, to_us(zone.start_ns), static_cast<double>(zone.end_ns - zone.start_ns) * 1e-3,
+						escape_json(zone.site->file), zone.site->line,
+						(zone.flags & ZoneFlag_Suspended) ? ",\"fiber\":\"suspended\"" : "");
+				}
+			}
+
+			out << "\n]}\n";
+			return static_cast<bool>(out);
+		}
+	}
+
+	namespace detail {
+		uint32_t enter_zone(const ZoneSite* site) {
+			auto& zones = active_zones();
+			if (zones.depth >= MAX_ZONE_DEPTH) [[unlikely]] {
+				return UINT32_MAX;
+			}
+
+			uint32_t slot = zones.depth++;
+			zones.entries[slot].site = site;
+			zones.entries[slot].flags = ZoneFlag_None;
+			zones.entries[slot].start_ns = now_ns();
+			return slot;
+		}
+
+		void leave_zone(uint32_t slot) {
+			const uint64_t end_ns = now_ns();
+			auto& zones = active_zones();
+			if (slot >= zones.depth) [[unlikely]] {
+				return;
+			}
+
+			emit(zones, slot, end_ns, ZoneFlag_None);
+			zones.depth = slot;
+		}
+	}
+
+	void set_enabled(bool enabled) {
+		auto& state = get_state();
+		if (enabled && !state.calibrated) {
+			// Disabled cost first, while the flag is still off
+			double disabled_ns = measure_zone_overhead();
+			detail::enabled.store(true, std::memory_order_relaxed);
+			double enabled_ns = measure_zone_overhead();
+
+			std::lock_guard<std::mutex> lock(state.history_mutex);
+			state.overhead.ns_per_zone_disabled = disabled_ns;
+			state.overhead.ns_per_zone = enabled_ns;
+			state.calibrated = true;
+			bud::print("[Profiler] Zone cost: {:.1f} ns enabled, {:.2f} ns disabled", enabled_ns, disabled_ns);
+		}
+		detail::enabled.store(enabled, std::memory_order_relaxed);
+	}
+
+	void set_thread_name(const char* name) {
+		auto& thread_state = get_thread_state();
+		std::lock_guard<std::mutex> lock(get_state().threads_mutex);
+		thread_state.name = name;
+	}
+
+	void on_fiber_enter(ZoneStack* fiber_zones) {
+		fiber_zones->base_depth = t_thread_zones.depth;
+		t_active_zones = fiber_zones;
+
+		if (fiber_zones->depth > 0) {
+			// Zones left open at the last switch continue on this thread
+			const uint64_t now = detail::now_ns();
+			for (uint32_t i = 0; i < fiber_zones->depth; ++i) {
+				fiber_zones->entries[i].start_ns = now;
+				fiber_zones->entries[i].flags = static_cast<uint16_t>(fiber_zones->entries[i].flags | ZoneFlag_Resumed);
+			}
+		}
+	}
+
+	void on_fiber_leave(ZoneStack* fiber_zones) {
+		if (fiber_zones->depth > 0) {
+			const uint64_t now = detail::now_ns();
+			for (uint32_t i = 0; i < fiber_zones->depth; ++i) {
+				emit(*fiber_zones, i, now, ZoneFlag_Suspended);
+			}
+		}
+		t_active_zones = nullptr;
+	}
+
+	void end_frame() {
+		auto& state = get_state();
+		const uint64_t now = detail::now_ns();
+
+		std::lock_guard<std::mutex> lock(state.history_mutex);
+		const uint64_t frame_start = state.last_frame_end_ns ? state.last_frame_end_ns : now;
+		state.last_frame_end_ns = now;
+		state.frame_index++;
+
+		if (!is_enabled()) {
+			return;
+		}
+
+		FrameProfile frame;
+		frame.frame_index = state.frame_index;
+		frame.start_ns = frame_start;
+		frame.end_ns = now;
+
+		{
+			std::lock_guard<std::mutex> threads_lock(state.threads_mutex);
+			for (auto& thread : state.threads) {
+				uint64_t r = thread->read_pos.load(std::memory_order_relaxed);
+				const uint64_t w = thread->write_pos.load(std::memory_order_acquire);
+				for (; r < w; ++r) {
+					frame.zones.push_back(thread->events[r % ZONE_RING_CAPACITY]);
+				}
+				thread->read_pos.store(r, std::memory_order_release);
+				frame.dropped_events += thread->dropped.exchange(0, std::memory_order_relaxed);
+			}
+		}
+
+		std::unordered_map<const ZoneSite*, SiteStats> sites;
+		for (const auto& zone : frame.zones) {
+			auto& stats = sites[zone.site];
+			double ms = static_cast<double>(zone.end_ns - zone.start_ns) * 1e-6;
+			stats.site = zone.site;
+			stats.total_ms += ms;
+			stats.max_ms = std::max(stats.max_ms, ms);
+			// A zone split by fiber switches still counts as one call
+			if (!(zone.flags & ZoneFlag_Resumed)) stats.calls++;
+		}
+		frame.sites.reserve(sites.size());
+		for (const auto& [site, stats] : sites) {
+			frame.sites.push_back(stats);
+		}
+		std::sort(frame.sites.begin(), frame.sites.end(), [](const SiteStats& a, const SiteStats& b) { return a.total_ms > b.total_ms; });
+
+		state.overhead.zones_last_frame = static_cast<uint32_t>(frame.zones.size());
+		state.overhead.estimated_ms_last_frame = static_cast<double>(frame.zones.size()) * state.overhead.ns_per_zone * 1e-6;
+
+		const double frame_ms = frame.duration_ms();
+		state.frame_times_ms.push_back(static_cast<float>(frame_ms));
+		state.history.push_back(std::move(frame));
+		while (state.history.size() > FRAME_HISTORY_SIZE) state.history.pop_front();
+		while (state.frame_times_ms.size() > FRAME_HISTORY_SIZE) state.frame_times_ms.pop_front();
+
+		const auto& settings = state.settings;
+		const uint64_t cooldown_ns = static_cast<uint64_t>(settings.hitch_cooldown_s * 1e9);
+		if (settings.export_on_hitch && frame_ms > settings.hitch_threshold_ms
+			&& (state.last_hitch_export_ns == 0 || now - state.last_hitch_export_ns > cooldown_ns)) {
+			std::string path = (std::filesystem::path(settings.export_dir) / std::format("bud_hitch_{}.json", state.frame_index)).string();
+			if (write_chrome_trace(state, path, HITCH_EXPORT_FRAMES)) {
+				state.hitch_exports++;
+				bud::wprint("[Profiler] Hitch {:.2f} ms (> {:.2f} ms), trace written to {}", frame_ms, settings.hitch_threshold_ms, path);
+			}
+			state.last_hitch_export_ns = now;
+		}
+	}
+
+	void set_settings(const ProfilerSettings& settings) {
+		auto& state = get_state();
+		std::lock_guard<std::mutex> lock(state.history_mutex);
+		state.settings = settings;
+	}
+
+	ProfilerSettings get_settings() {
+		auto& state = get_state();
+		std::lock_guard<std::mutex> lock(state.history_mutex);
+		return state.settings;
+	}
+
+	bool get_last_frame(FrameProfile& out) {
+		auto& state = get_state();
+		std::lock_guard<std::mutex> lock(state.history_mutex);
+		if (state.history.empty()) return false;
+		out = state.history.back();
+		return true;
+	}
+
+	void get_frame_times(std::vector<float>& out_ms) {
+		auto& state = get_state();
+		std::lock_guard<std::mutex> lock(state.history_mutex);
+		out_ms.assign(state.frame_times_ms.begin(), state.frame_times_ms.end());
+	}
+
+	std::vector<std::string> get_thread_names() {
+		auto& state = get_state();
+		std::lock_guard<std::mutex> lock(state.threads_mutex);
+		std::vector<std::string> names;
+		names.reserve(state.threads.size());
+		for (const auto& thread : state.threads) names.push_back(thread->name);
+		return names;
+	}
+
+	ProfilerOverhead get_overhead() {
+		auto& state = get_state();
+		std::lock_guard<std::mutex> lock(state.history_mutex);
+		return state.overhead;
+	}
+
+	uint64_t get_hitch_exports() {
+		auto& state = get_state();
+		std::lock_guard<std::mutex> lock(state.history_mutex);
+		return state.hitch_exports;
+	}
+
+	void build_flame_graph(const FrameProfile& frame, std::vector<FlameNode>& out_nodes) {
+		out_nodes.clear();
+		out_nodes.push_back({}); // Root, nodes[0]
+		std::vector<std::vector<uint32_t>> children(1);
+
+		std::vector<const ZoneEvent*> zones;
+		zones.reserve(frame.zones.size());
+		for (const auto& zone : frame.zones) zones.push_back(&zone);
+		std::sort(zones.begin(), zones.end(), [](const ZoneEvent* a, const ZoneEvent* b) {
+			if (a->thread_index != b->thread_index) return a->thread_index < b->thread_index;
+			if (a->start_ns != b->start_ns) return a->start_ns < b->start_ns;
+			return a->depth < b->depth;
+		});
+
+		// Per thread, the open ancestors of the current zone: (end_ns, node)
+		std::vector<std::pair<uint64_t, uint32_t>> stack;
+		uint32_t current_thread = UINT32_MAX;
+
+		for (const ZoneEvent* zone : zones) {
+			if (zone->thread_index != current_thread) {
+				stack.clear();
+				current_thread = zone->thread_index;
+			}
+			while (!stack.empty() && (stack.back().first <= zone->start_ns || stack.size() > zone->depth)) {
+				stack.pop_back();
+			}
+
+			uint32_t parent = stack.empty() ? 0 : stack.back().second;
+			uint32_t node = UINT32_MAX;
+			for (uint32_t child : children[parent]) {
+				if (out_nodes[child].site == zone->site) {
+					node = child;
+					break;
+				}
+			}
+			if (node == UINT32_MAX) {
+				node = static_cast<uint32_t>(out_nodes.size());
+				FlameNode flame_node;
+				flame_node.site = zone->site;
+				flame_node.parent = parent;
+				flame_node.depth = out_nodes[parent].depth + 1;
+				out_nodes.push_back(flame_node);
+				children.emplace_back();
+				children[parent].push_back(node);
+			}
+
+			double ms = static_cast<double>(zone->end_ns - zone->start_ns) * 1e-6;
+			out_nodes[node].total_ms += ms;
+			if (!(zone->flags & ZoneFlag_Resumed)) out_nodes[node].calls++;
+			if (parent == 0) out_nodes[0].total_ms += ms;
+
+			stack.emplace_back(zone->end_ns, node);
+		}
+
+		// Children are appended after their parent, so one forward pass lays out every level
+		for (uint32_t i = 0; i < out_nodes.size(); ++i) {
+			auto& siblings = children[i];
+			std::sort(siblings.begin(), siblings.end(), [&](uint32_t a, uint32_t b) {
+				return std::strcmp(out_nodes[a].site->name, out_nodes[b].site->name) < 0;
+			});
+			double offset = out_nodes[i].offset_ms;
+			for (uint32_t child : siblings) {
+				out_nodes[child].offset_ms = offset;
+				offset += out_nodes[child].total_ms;
+			}
+		}
+	}
+
+	bool export_chrome_trace(const std::string& path, uint32_t frame_count) {
+		auto& state = get_state();
+		std::lock_guard<std::mutex> lock(state.history_mutex);
+		bool ok = write_chrome_trace(state, path, frame_count);
+		if (ok) {
+			bud::print("[Profiler] Trace of {} frames written to {}", std::min<size_t>(frame_count, state.history.size()), path);
+		}
+		return ok;
+	}
+
+	// Call from the end_frame thread, it doubles as the consumer of its own ring here
+	double measure_zone_overhead(uint32_t iterations) {
+		static const ZoneSite calibration_site{ "ProfilerCalibration", __FILE__, __LINE__ };
+
+		// Batches stay below the ring size; the calling thread's events are discarded after each one
+		constexpr uint32_t BATCH = ZONE_RING_CAPACITY / 4;
+		uint64_t total_ns = 0;
+		uint32_t done = 0;
+
+		while (done < iterations) {
+			uint32_t batch = std::min(BATCH, iterations - done);
+			uint64_t start = detail::now_ns();
+			for (uint32_t i = 0; i < batch; ++i) {
+				ScopedZone zone(&calibration_site);
+			}
+			total_ns += detail::now_ns() - start;
+			done += batch;
+
+			if (t_thread_state) {
+				t_thread_state->read_pos.store(t_thread_state->write_pos.load(std::memory_order_acquire), std::memory_order_release);
+			}
+		}
+
+		return iterations > 0 ? static_cast<double>(total_ns) / iterations : 0.0;
+	}
+}
@@ -0,0 +1,189 @@
+﻿#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Built-in CPU profiler. Disabled at runtime by default: a zone then costs one relaxed load.
+// Define BUD_CPU_PROFILER=0 to compile the zones out entirely.
+#ifndef BUD_CPU_PROFILER
+#define BUD_CPU_PROFILER 1
+#endif
+
+namespace bud::profiler {
+
+	constexpr uint32_t MAX_ZONE_DEPTH = 32;
+	constexpr uint32_t ZONE_RING_CAPACITY = 16 * 1024;  // Events per thread between two end_frame calls
+	constexpr uint32_t FRAME_HISTORY_SIZE = 240;        // Frames kept for the UI and trace export
+	constexpr uint32_t HITCH_EXPORT_FRAMES = 120;       // Frames written when a hitch triggers an export
+
+	// One per annotation, static storage so its address doubles as the site id
+	struct ZoneSite {
+		const char* name = nullptr;
+		const char* file = nullptr;
+		uint32_t line = 0;
+	};
+
+	enum ZoneFlags : uint16_t {
+		ZoneFlag_None = 0,
+		ZoneFlag_Suspended = 1 << 0,  // Segment ended because the fiber was switched out, the zone continues later
+		ZoneFlag_Resumed = 1 << 1     // Segment started when the fiber was switched back in
+	};
+
+	// Open zones of one execution context. Each fiber owns one, so a zone that waits on a counter
+	// and resumes on another worker is closed and reopened as separate segments instead of
+	// corrupting the nesting of whichever thread ran in between.
+	struct ZoneStack {
+		struct Entry {
+			const ZoneSite* site = nullptr;
+			uint64_t start_ns = 0;
+			uint16_t flags = ZoneFlag_None;
+		};
+
+		Entry entries[MAX_ZONE_DEPTH];
+		uint32_t depth = 0;
+		uint32_t base_depth = 0;  // Depth of the thread zone the fiber runs under
+	};
+
+	// Begin/end pair, written once when the zone (or a fiber segment of it) closes
+	struct ZoneEvent {
+		const ZoneSite* site = nullptr;
+		uint64_t start_ns = 0;
+		uint64_t end_ns = 0;
+		uint32_t thread_index = 0;
+		uint16_t depth = 0;
+		uint16_t flags = ZoneFlag_None;
+	};
+
+	struct SiteStats {
+		const ZoneSite* site = nullptr;
+		double total_ms = 0.0;   // Inclusive, summed over all threads
+		double max_ms = 0.0;
+		uint32_t calls = 0;
+	};
+
+	struct FrameProfile {
+		uint64_t frame_index = 0;
+		uint64_t start_ns = 0;
+		uint64_t end_ns = 0;
+		std::vector<ZoneEvent> zones;
+		std::vector<SiteStats> sites;  // Sorted by total_ms, descending
+		uint64_t dropped_events = 0;
+
+		double duration_ms() const { return static_cast<double>(end_ns - start_ns) * 1e-6; }
+	};
+
+	// Call-path aggregate of one frame, laid out for an icicle-style flame graph
+	struct FlameNode {
+		const ZoneSite* site = nullptr;
+		uint32_t parent = UINT32_MAX;
+		uint32_t depth = 0;
+		double total_ms = 0.0;
+		double offset_ms = 0.0;  // Horizontal position relative to the root
+		uint32_t calls = 0;
+	};
+
+	struct ProfilerSettings {
+		float hitch_threshold_ms = 50.0f;   // Frames longer than this count as hitches
+		bool export_on_hitch = false;
+		float hitch_cooldown_s = 5.0f;      // The export itself is a hitch, don't chain them
+		std::string export_dir = "tmp";
+	};
+
+	struct ProfilerOverhead {
+		double ns_per_zone = 0.0;       // Calibrated enter + leave cost with the profiler enabled
+		double ns_per_zone_disabled = 0.0;
+		uint32_t zones_last_frame = 0;
+		double estimated_ms_last_frame = 0.0;
+	};
+
+	namespace detail {
+		inline std::atomic<bool> enabled{ false };
+
+		inline uint64_t now_ns() {
+			return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now().time_since_epoch()).count());
+		}
+
+		uint32_t enter_zone(const ZoneSite* site);
+		void leave_zone(uint32_t slot);
+	}
+
+	inline bool is_enabled() { return detail::enabled.load(std::memory_order_relaxed); }
+	void set_enabled(bool enabled);
+
+	// Names the calling thread in the timeline and exported traces
+	void set_thread_name(const char* name);
+
+	// Fiber hooks, called by the task scheduler around every context switch into a fiber
+	void on_fiber_enter(ZoneStack* fiber_zones);
+	void on_fiber_leave(ZoneStack* fiber_zones);
+
+	// Once per frame on the main thread: drains the thread rings, aggregates, checks for hitches
+	void end_frame();
+
+	void set_settings(const ProfilerSettings& settings);
+	ProfilerSettings get_settings();
+
+	// Copies of the history, safe to call from the thread that calls end_frame
+	bool get_last_frame(FrameProfile& out);
+	void get_frame_times(std::vector<float>& out_ms);
+	std::vector<std::string> get_thread_names();
+	ProfilerOverhead get_overhead();
+	uint64_t get_hitch_exports();
+
+	void build_flame_graph(const FrameProfile& frame, std::vector<FlameNode>& out_nodes);
+
+	// Chrome trace event JSON (also loads in Perfetto) of the last frame_count frames
+	bool export_chrome_trace(const std::string& path, uint32_t frame_count = FRAME_HISTORY_SIZE);
+
+	// Times n enter/leave pairs on the calling thread, result is per zone in ns
+	double measure_zone_overhead(uint32_t iterations = 100000);
+
+	class ScopedZone {
+	public:
+		explicit ScopedZone(const ZoneSite* site) {
+			if (is_enabled()) [[unlikely]] {
+				slot = detail::enter_zone(site);
+			}
+		}
+
+		~ScopedZone() {
+			if (slot != UINT32_MAX) [[unlikely]] {
+				detail::leave_zone(slot);
+			}
+		}
+
+		ScopedZone(const ScopedZone&) = delete;
+		ScopedZone& operator=(const ScopedZone&) = delete;
+
+	private:
+		uint32_t slot = UINT32_MAX;
+	};
+}
+
+#define BUD_PROFILE_CONCAT_INNER(a, b) a##b
+#define BUD_PROFILE_CONCAT(a, b) BUD_PROFILE_CONCAT_INNER(a, b)
+
+#if BUD_CPU_PROFILER
+#define BUD_PROFILE_ZONE(name) \
+	static const ::bud::profiler::ZoneSite BUD_PROFILE_CONCAT(bud_zone_site_, __LINE__){ name, __FILE__, __LINE__ }; \
+	::bud::profiler::ScopedZone BUD_PROFILE_CONCAT(bud_zone_, __LINE__)(&BUD_PROFILE_CONCAT(bud_zone_site_, __LINE__))
+#else
+#define BUD_PROFILE_ZONE(name)
+#endif
+
+// The existing Tracy annotations feed both profilers
+#ifdef TRACY_ENABLE
+#include <tracy/Tracy.hpp>
+#undef ZoneScoped
+#undef ZoneScopedN
+#define ZoneScoped ZoneNamed(___tracy_scoped_zone, true); BUD_PROFILE_ZONE(__func__)
+#define ZoneScopedN(name) ZoneNamedN(___tracy_scoped_zone, name, true); BUD_PROFILE_ZONE(name)
+#else
+#define ZoneScoped BUD_PROFILE_ZONE(__func__)
+#define ZoneScopedN(name) BUD_PROFILE_ZONE(name)
+#define FrameMark
+#endif
@@ -0,0 +1,271 @@
+﻿#include <algorithm>
+#include <cmath>
+#include <format>
+#include <stdexcept>
+
+#include "src/core/bud.logger.hpp"
+#include "src/graphics/bud.graphics.foliage.hpp"
+
+namespace bud::graphics {
+
+	namespace {
+		constexpr float TWO_PI = 6.28318530718f;
+		constexpr uint32_t MAX_GRID_DIM = 1024;   // Per axis, wider scatters get larger cells
+		constexpr uint32_t LOD_CULLED = UINT32_MAX;
+		constexpr uint32_t BUCKETS_PER_TYPE = FOLIAGE_MAX_LODS + 1;
+
+		// p-vertex test, one corner per plane instead of the eight of intersect_aabb_frustum
+		bool outside_frustum(const bud::math::AABB& box, const bud::math::Frustum& frustum) {
+			for (const auto& plane : frustum.planes) {
+				const bud::math::vec3 p(plane.x >= 0.0f ? box.max.x : box.min.x,
+					plane.y >= 0.0f ? box.max.y : box.min.y,
+					plane.z >= 0.0f ? box.max.z : box.min.z);
+				if (plane.x * p.x + plane.y * p.y + plane.z * p.z + plane.w < 0.0f)
+					return true;
+			}
+			return false;
+		}
+
+		float min_distance_sq(const bud::math::AABB& box, const bud::math::vec3& p) {
+			const bud::math::vec3 d = glm::max(glm::max(box.min - p, p - box.max), bud::math::vec3(0.0f));
+			return glm::dot(d, d);
+		}
+
+		float max_distance_sq(const bud::math::AABB& box, const bud::math::vec3& p) {
+			const bud::math::vec3 d = glm::max(glm::abs(p - box.min), glm::abs(p - box.max));
+			return glm::dot(d, d);
+		}
+	}
+
+	FoliageLodBands::FoliageLodBands(const FoliageType& type, const FoliageCullParams& params) {
+		float max_distance = std::min(params.max_distance, type.cull_distance);
+		if (params.shadow_casters) {
+			if (!type.cast_shadows) return;
+			max_distance = std::min(max_distance, type.shadow_distance);
+		}
+
+		const uint32_t lod_count = std::min(type.lod_count, FOLIAGE_MAX_LODS);
+		for (uint32_t i = 0; i < lod_count; ++i) {
+			const float limit = std::min(type.lod_distances[i], max_distance);
+			limits_sq[count] = limit * limit;
+			lods[count++] = i;
+		}
+		if (type.impostor_texture != 0 && !params.shadow_casters) {
+			limits_sq[count] = max_distance * max_distance;
+			lods[count++] = FOLIAGE_IMPOSTOR_LOD;
+		}
+	}
+
+	// Limits are ascending, so the first band that holds the distance wins
+	uint32_t FoliageLodBands::select(float distance_sq) const {
+		for (uint32_t i = 0; i < count; ++i) {
+			if (distance_sq <= limits_sq[i]) return lods[i];
+		}
+		return LOD_CULLED;
+	}
+
+	FoliageInstance pack_foliage_instance(const bud::math::vec3& position, float yaw, float scale) {
+		float turns = yaw / TWO_PI;
+		turns -= std::floor(turns);
+		const uint32_t packed_yaw = static_cast<uint32_t>(std::lround(turns * 65535.0f)) & 0xFFFFu;
+		const uint32_t packed_scale = static_cast<uint32_t>(std::lround(std::clamp(scale / FOLIAGE_MAX_SCALE, 0.0f, 1.0f) * 65535.0f));
+
+		FoliageInstance instance;
+		instance.position[0] = position.x;
+		instance.position[1] = position.y;
+		instance.position[2] = position.z;
+		instance.yaw_scale = packed_yaw | (packed_scale << 16);
+		return instance;
+	}
+
+	float get_foliage_scale(const FoliageInstance& instance) {
+		return static_cast<float>(instance.yaw_scale >> 16) / 65535.0f * FOLIAGE_MAX_SCALE;
+	}
+
+	uint32_t FoliageSystem::add_type(const FoliageType& type) {
+		types.push_back(type);
+
+		// Yaw turns the mesh around the pivot: horizontal radius over the corners, vertical range unchanged
+		bud::math::AABB swept(bud::math::vec3(-1.0f, 0.0f, -1.0f), bud::math::vec3(1.0f));
+		const auto& local = type.local_bounds;
+		if (local.min.x <= local.max.x && local.min.y <= local.max.y && local.min.z <= local.max.z) {
+			const float x = std::max(std::abs(local.min.x), std::abs(local.max.x));
+			const float z = std::max(std::abs(local.min.z), std::abs(local.max.z));
+			const float radius = std::sqrt(x * x + z * z);
+			swept = bud::math::AABB(bud::math::vec3(-radius, local.min.y, -radius), bud::math::vec3(radius, local.max.y, radius));
+		}
+		type_bounds.push_back(swept);
+		return static_cast<uint32_t>(types.size() - 1);
+	}
+
+	void FoliageSystem::reserve(size_t instance_count) {
+		instances.reserve(instance_count);
+		instance_types.reserve(instance_count);
+	}
+
+	void FoliageSystem::add_instance(uint32_t type, const bud::math::vec3& position, float yaw, float scale) {
+		if (type >= types.size()) {
+			std::string err = std::format("FoliageSystem::add_instance unknown type {} ({} registered)", type, types.size());
+			bud::eprint("{}", err);
+#if defined(_DEBUG)
+			throw std::runtime_error(err);
+#else
+			return;
+#endif
+		}
+		instances.push_back(pack_foliage_instance(position, yaw, scale));
+		instance_types.push_back(type);
+		built = false;
+	}
+
+	void FoliageSystem::build(float cell_size) {
+		cells.clear();
+		runs.clear();
+		bounds = {};
+		built = true;
+
+		const size_t count = instances.size();
+		if (count == 0) return;
+
+		bud::math::AABB extent;
+		for (const auto& instance : instances) {
+			extent.merge(bud::math::vec3(instance.position[0], instance.position[1], instance.position[2]));
+		}
+
+		cell_size = std::max(cell_size, 1.0f);
+		const float width = extent.max.x - extent.min.x;
+		const float depth = extent.max.z - extent.min.z;
+		const uint32_t grid_x = std::clamp(static_cast<uint32_t>(std::ceil(width / cell_size)), 1u, MAX_GRID_DIM);
+		const uint32_t grid_z = std::clamp(static_cast<uint32_t>(std::ceil(depth / cell_size)), 1u, MAX_GRID_DIM);
+		const float inv_x = width > 0.0f ? grid_x / width : 0.0f;
+		const float inv_z = depth > 0.0f ? grid_z / depth : 0.0f;
+
+		std::vector<uint32_t> instance_cells(count);
+		for (size_t i = 0; i < count; ++i) {
+			const uint32_t x = std::min(static_cast<uint32_t>((instances[i].position[0] - extent.min.x) * inv_x), grid_x - 1);
+			const uint32_t z = std::min(static_cast<uint32_t>((instances[i].position[2] - extent.min.z) * inv_z), grid_z - 1);
+			instance_cells[i] = z * grid_x + x;
+		}
+
+		// Two stable counting sorts (type, then cell) leave the instances cell-major with one run per type
+		auto counting_sort = [count](const std::vector<uint32_t>& keys, uint32_t key_count, const std::vector<uint32_t>& in, std::vector<uint32_t>& out) {
+			std::vector<uint32_t> offsets(static_cast<size_t>(key_count) + 1, 0);
+			for (size_t i = 0; i < count; ++i) offsets[keys[in[i]] + 1]++;
+			for (uint32_t k = 0; k < key_count; ++k) offsets[k + 1] += offsets[k];
+			for (size_t i = 0; i < count; ++i) out[offsets[keys[in[i]]]++] = in[i];
+		};
+
+		std::vector<uint32_t> identity(count);
+		for (size_t i = 0; i < count; ++i) identity[i] = static_cast<uint32_t>(i);
+		std::vector<uint32_t> by_type(count);
+		std::vector<uint32_t> order(count);
+		counting_sort(instance_types, static_cast<uint32_t>(types.size()), identity, by_type);
+		counting_sort(instance_cells, grid_x * grid_z, by_type, order);
+
+		std::vector<FoliageInstance> sorted_instances(count);
+		std::vector<uint32_t> sorted_types(count);
+		std::vector<uint32_t> sorted_cells(count);
+		for (size_t i = 0; i < count; ++i) {
+			sorted_instances[i] = instances[order[i]];
+			sorted_types[i] = instance_types[order[i]];
+			sorted_cells[i] = instance_cells[order[i]];
+		}
+		instances = std::move(sorted_instances);
+		instance_types = std::move(sorted_types);
+
+		for (size_t i = 0; i < count; ++i) {
+			const uint32_t cell = sorted_cells[i];
+			const uint32_t type = instance_types[i];
+			const bool new_cell = i == 0 || cell != sorted_cells[i - 1];
+			if (new_cell) {
+				cells.push_back({ {}, static_cast<uint32_t>(runs.size()), 0 });
+			}
+			if (new_cell || type != instance_types[i - 1]) {
+				runs.push_back({ {}, {}, static_cast<uint32_t>(i), 0, type });
+				cells.back().run_count++;
+			}
+
+			const auto& instance = instances[i];
+			const bud::math::vec3 position(instance.position[0], instance.position[1], instance.position[2]);
+			const float scale = get_foliage_scale(instance);
+			auto& run = runs.back();
+			run.count++;
+			run.position_bounds.merge(position);
+			run.bounds.merge(bud::math::AABB(position + type_bounds[type].min * scale, position + type_bounds[type].max * scale));
+		}
+
+		for (auto& cell : cells) {
+			for (uint32_t r = 0; r < cell.run_count; ++r) {
+				cell.bounds.merge(runs[cell.first_run + r].bounds);
+			}
+			bounds.merge(cell.bounds);
+		}
+	}
+
+	void FoliageSystem::cull(const FoliageCullParams& params, FoliageDrawList& out) const {
+		out.clear();
+		if (!built) {
+			bud::eprint("[FoliageSystem] cull() before build(), nothing drawn");
+			return;
+		}
+
+		const size_t bucket_count = types.size() * BUCKETS_PER_TYPE;
+		if (out.buckets.size() < bucket_count) out.buckets.resize(bucket_count);
+		for (auto& bucket : out.buckets) bucket.clear();
+
+		auto& bands = out.bands;
+		bands.clear();
+		for (const auto& type : types) bands.emplace_back(type, params);
+
+		auto& stats = out.stats;
+		const bud::math::vec3 camera = params.camera_position;
+
+		for (const auto& cell : cells) {
+			stats.cells_tested++;
+			if (outside_frustum(cell.bounds, params.frustum)) continue;
+			stats.cells_visible++;
+
+			for (uint32_t r = 0; r < cell.run_count; ++r) {
+				const Run& run = runs[cell.first_run + r];
+				const FoliageLodBands& type_bands = bands[run.type];
+				if (type_bands.count == 0) continue;
+				if (cell.run_count > 1 && outside_frustum(run.bounds, params.frustum)) continue;
+
+				const uint32_t near_lod = type_bands.select(min_distance_sq(run.position_bounds, camera));
+				if (near_lod == LOD_CULLED) continue; // Nearest pivot is past every band
+
+				auto* buckets = &out.buckets[static_cast<size_t>(run.type) * BUCKETS_PER_TYPE];
+				const uint32_t far_lod = type_bands.select(max_distance_sq(run.position_bounds, camera));
+				if (near_lod == far_lod) {
+					auto& bucket = buckets[near_lod];
+					bucket.insert(bucket.end(), instances.begin() + run.first, instances.begin() + run.first + run.count);
+					stats.runs_bulk++;
+					continue;
+				}
+
+				stats.runs_split++;
+				for (uint32_t i = run.first; i < run.first + run.count; ++i) {
+					const auto& instance = instances[i];
+					const bud::math::vec3 d = bud::math::vec3(instance.position[0], instance.position[1], instance.position[2]) - camera;
+					const uint32_t lod = type_bands.select(glm::dot(d, d));
+					if (lod != LOD_CULLED) buckets[lod].push_back(instance);
+				}
+			}
+		}
+
+		size_t total = 0;
+		for (size_t b = 0; b < bucket_count; ++b) total += out.buckets[b].size();
+		out.instances.reserve(total);
+
+		for (size_t b = 0; b < bucket_count; ++b) {
+			const auto& bucket = out.buckets[b];
+			if (bucket.empty()) continue;
+
+			const uint32_t lod = static_cast<uint32_t>(b % BUCKETS_PER_TYPE);
+			out.batches.push_back({ static_cast<uint32_t>(b / BUCKETS_PER_TYPE), lod, static_cast<uint32_t>(out.instances.size()), static_cast<uint32_t>(bucket.size()) });
+			out.instances.insert(out.instances.end(), bucket.begin(), bucket.end());
+			if (lod == FOLIAGE_IMPOSTOR_LOD) stats.impostor_instances += static_cast<uint32_t>(bucket.size());
+			else stats.mesh_instances += static_cast<uint32_t>(bucket.size());
+		}
+	}
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "src/core/bud.math.hpp"
+#include "src/graphics/bud.graphics.types.hpp"
+
+namespace bud::graphics {
+
+	constexpr uint32_t FOLIAGE_MAX_LODS = 4;                      // Mesh LODs per type, the impostor comes after them
+	constexpr uint32_t FOLIAGE_IMPOSTOR_LOD = FOLIAGE_MAX_LODS;   // FoliageBatch::lod of billboard batches
+	constexpr float FOLIAGE_MAX_SCALE = 4.0f;                     // Upper end of the packed instance scale (foliage*.vert)
+
+	// Per-instance vertex stream of the foliage pipelines (binding 2). yaw_scale holds the yaw in the
+	// low 16 bits (unorm over 2 pi) and the uniform scale in the high 16 bits (unorm over FOLIAGE_MAX_SCALE).
+	struct FoliageInstance {
+		float position[3];
+		uint32_t yaw_scale;
+	};
+	static_assert(sizeof(FoliageInstance) == FOLIAGE_INSTANCE_STRIDE, "FoliageInstance must match the instanced vertex layouts");
+
+	FoliageInstance pack_foliage_instance(const bud::math::vec3& position, float yaw, float scale);
+	float get_foliage_scale(const FoliageInstance& instance);
+
+	struct FoliageType {
+		uint32_t lod_meshes[FOLIAGE_MAX_LODS] = {};    // Renderer mesh ids (MeshAssetHandle::mesh_id)
+		float lod_distances[FOLIAGE_MAX_LODS] = {};    // Mesh LOD i is drawn up to lod_distances[i] from the camera, ascending
+		uint32_t lod_count = 0;
+
+		// Atlas baked by BudAssetTool --bake-impostor: impostor_frames azimuth views left to right, frame f seen
+		// from azimuth 2 pi f / frames around +Y. 0 = no impostor, instances past the last mesh LOD are dropped.
+		uint32_t impostor_texture = 0;
+		uint32_t impostor_frames = 8;
+		bud::math::vec2 impostor_size = { 1.0f, 1.0f }; // World width / height of the card at scale 1
+		float impostor_base = 0.0f;                     // Card bottom above the pivot at scale 1
+
+		float cull_distance = 2000.0f;
+		float shadow_distance = 150.0f; // Mesh LODs only, impostors never cast
+		bool cast_shadows = true;
+
+		bud::math::AABB local_bounds; // LOD 0 at scale 1, pivot at the instance position
+	};
+
+	struct FoliageBatch {
+		uint32_t type;
+		uint32_t lod;   // Mesh LOD below FoliageType::lod_count, FOLIAGE_IMPOSTOR_LOD for billboards
+		uint32_t first; // Into FoliageDrawList::instances
+		uint32_t count;
+	};
+
+	struct FoliageCullParams {
+		bud::math::Frustum frustum;
+		bud::math::vec3 camera_position; // LODs are always picked by camera distance, so shadow cascades draw the LOD the camera sees
+		float max_distance = std::numeric_limits<float>::max();
+		bool shadow_casters = false;     // Only casting types, mesh LODs and instances inside FoliageType::shadow_distance
+	};
+
+	// Squared upper distance of every band a type can land in one cull: its mesh LODs, then the impostor
+	struct FoliageLodBands {
+		float limits_sq[FOLIAGE_MAX_LODS + 1];
+		uint32_t lods[FOLIAGE_MAX_LODS + 1];
+		uint32_t count = 0;
+
+		FoliageLodBands(const FoliageType& type, const FoliageCullParams& params);
+
+		uint32_t select(float distance_sq) const; // LOD of a squared camera distance, culled past the last band
+	};
+
+	struct FoliageCullStats {
+		uint32_t cells_tested = 0;
+		uint32_t cells_visible = 0;
+		uint32_t runs_bulk = 0;          // Type runs copied whole, their distance range fell into one LOD band
+		uint32_t runs_split = 0;         // Type runs split per instance
+		uint32_t mesh_instances = 0;
+		uint32_t impostor_instances = 0;
+	};
+
+	struct FoliageDrawList {
+		std::vector<FoliageInstance> instances; // Grouped by batch
+		std::vector<FoliageBatch> batches;
+		FoliageCullStats stats;
+
+		// Scratch per (type, LOD), kept between frames so the instance appends stop allocating once warmed up
+		std::vector<std::vector<FoliageInstance>> buckets;
+		std::vector<FoliageLodBands> bands; // Per type, rebuilt by every cull
+
+		void clear() {
+			instances.clear();
+			batches.clear();
+			stats = {};
+		}
+	};
+
+	// Instanced scatter (trees, rocks, grass clumps) outside the entity path: no extraction, BVH or per-draw
+	// sort. Instances are 16 byte records binned into square XZ cells, sorted by type inside a cell. Culling
+	// tests the bounds of every (cell, type) run; LOD is picked per run when the run's whole distance range
+	// falls into one band, otherwise per instance. Build once, cull from any number of threads.
+	class FoliageSystem {
+	public:
+		static constexpr float DEFAULT_CELL_SIZE = 64.0f;
+
+		uint32_t add_type(const FoliageType& type);
+		void add_instance(uint32_t type, const bud::math::vec3& position, float yaw, float scale);
+		void reserve(size_t instance_count);
+
+		// Bins the instances added so far, has to run before cull()
+		void build(float cell_size = DEFAULT_CELL_SIZE);
+		void cull(const FoliageCullParams& params, FoliageDrawList& out) const;
+
+		const std::vector<FoliageType>& get_types() const { return types; }
+		const FoliageType& get_type(uint32_t type) const { return types[type]; }
+		size_t instance_count() const { return instances.size(); }
+		size_t cell_count() const { return cells.size(); }
+		size_t run_count() const { return runs.size(); }
+		const bud::math::AABB& get_bounds() const { return bounds; }
+
+	private:
+		// Instances of one type inside one cell
+		struct Run {
+			bud::math::AABB bounds;           // Instance positions grown by the scaled type radius
+			bud::math::AABB position_bounds;  // Pivots only, bounds the LOD distances of the run
+			uint32_t first;
+			uint32_t count;
+			uint32_t type;
+		};
+
+		struct Cell {
+			bud::math::AABB bounds;
+			uint32_t first_run;
+			uint32_t run_count;
+		};
+
+		std::vector<FoliageType> types;
+		std::vector<bud::math::AABB> type_bounds; // LOD 0 around the pivot under any yaw, scale 1
+		std::vector<FoliageInstance> instances;  // Cell-major, then by type, after build()
+		std::vector<uint32_t> instance_types;    // Parallel to instances
+		std::vector<Cell> cells;                 // Non-empty cells only
+		std::vector<Run> runs;
+		bud::math::AABB bounds;
+		bool built = false;
+	};
+}
@@ -2,6 +2,8 @@
 
 #include <iostream>
 
+#include "src/core/bud.profiler.hpp"
+
 namespace bud::graphics {
 	RGHandle RGBuilder::read(RGHandle handle, ResourceState state) {
 		pass_node.reads.push_back({ handle, state });
@@ -99,6 +101,8 @@ namespace bud::graphics {
 	}
 
 	void RenderGraph::compile() {
+		ZoneScoped;
+
 		// 1. Build Adjacency List (Naive O(N^2) for prototype)
 		// Better: Map<ResourceId, ProducerPassId>
 		adjacency_list.assign(passes.size(), {});
@@ -230,7 +234,8 @@ namespace bud::graphics {
 
 	
 		// 4. Resource Allocation (Phase 2)
-		auto* pool = rhi->get_resource_pool();
+		// No RHI: CPU-only compile (bud_benchmarks), dependencies and barriers only
+		auto* pool = rhi ? rhi->get_resource_pool() : nullptr;
 	if (pool) {
 		for (auto& node : resources) {
 			// Allocate only if transient and not already allocated (redundant check)
@@ -257,6 +262,8 @@ namespace bud::graphics {
 	}
 
 	void RenderGraph::execute(CommandHandle cmd) {
+		ZoneScoped;
+
 		for (int pass_idx : sorted_passes) {
 			auto& pass = passes[pass_idx];
 
@@ -287,6 +294,8 @@ namespace bud::graphics {
 	}
 
 	void RenderGraph::execute_parallel(CommandHandle cmd, bud::threading::TaskScheduler* task_scheduler) {
+		ZoneScoped;
+
 		if (!task_scheduler) {
 			execute(cmd);
 			return;
@@ -0,0 +1,49 @@
+﻿#include "src/graphics/bud.graphics.hlod.hpp"
+
+#include <algorithm>
+
+namespace bud::graphics {
+
+	void HLODSet::add_region(const HLODRegion& region, std::span<const uint32_t> entity_submesh_pairs) {
+		const uint32_t index = static_cast<uint32_t>(regions.size());
+		regions.push_back(region);
+		for (size_t i = 0; i + 1 < entity_submesh_pairs.size(); i += 2) {
+			members.push_back({ entity_submesh_pairs[i], entity_submesh_pairs[i + 1], index });
+		}
+	}
+
+	void HLODSet::build() {
+		std::sort(members.begin(), members.end(), [](const HLODMember& a, const HLODMember& b) {
+			return a.entity != b.entity ? a.entity < b.entity : a.submesh < b.submesh;
+		});
+
+		const uint32_t entity_count = members.empty() ? 0 : members.back().entity + 1;
+		entity_offsets.assign(entity_count + 1, 0);
+		for (const auto& member : members) entity_offsets[member.entity + 1]++;
+		for (uint32_t e = 0; e < entity_count; ++e) entity_offsets[e + 1] += entity_offsets[e];
+	}
+
+	void HLODSet::select(const bud::math::vec3& camera_position, float distance_scale, std::vector<uint8_t>& active, HLODStats& stats) const {
+		active.assign(regions.size(), 0);
+		stats = {};
+		stats.regions = static_cast<uint32_t>(regions.size());
+
+		for (size_t r = 0; r < regions.size(); ++r) {
+			const auto& region = regions[r];
+			// Distance to the box, 0 inside it: a camera in the region always sees the source meshes
+			const bud::math::vec3 closest = glm::clamp(camera_position, region.bounds.min, region.bounds.max);
+			const float switch_distance = region.switch_distance * distance_scale;
+			if (bud::math::distance2(camera_position, closest) <= switch_distance * switch_distance) continue;
+
+			active[r] = 1;
+			stats.regions_active++;
+			stats.draws_saved += region.source_draws > 1 ? region.source_draws - 1 : 0;
+			stats.triangles_saved += region.source_triangles > region.proxy_triangles ? region.source_triangles - region.proxy_triangles : 0;
+		}
+	}
+
+	std::span<const HLODMember> HLODSet::get_members(uint32_t entity) const {
+		if (entity + 1 >= entity_offsets.size()) return {};
+		return std::span<const HLODMember>(members.data() + entity_offsets[entity], entity_offsets[entity + 1] - entity_offsets[entity]);
+	}
+}
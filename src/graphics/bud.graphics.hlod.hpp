@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "src/core/bud.math.hpp"
+
+namespace bud::graphics {
+
+	// One merged, simplified proxy of BudAssetTool --build-hlod
+	struct HLODRegion {
+		bud::math::AABB bounds;         // World space, union of the replaced submeshes
+		float switch_distance = 0.0f;   // The proxy takes over once the camera is this far from bounds
+		uint32_t proxy_mesh = 0;        // Renderer mesh id, drawn with an identity transform
+		uint32_t proxy_material = 0;
+		uint32_t source_draws = 0;
+		uint32_t source_triangles = 0;
+		uint32_t proxy_triangles = 0;
+	};
+
+	// A submesh of a scene entity that a region's proxy replaces
+	struct HLODMember {
+		uint32_t entity;
+		uint32_t submesh;
+		uint32_t region;
+	};
+
+	struct HLODStats {
+		uint32_t regions = 0;
+		uint32_t regions_active = 0;     // Drawn as their proxy this frame
+		uint32_t draws_saved = 0;        // Source draws of the active regions minus their proxies
+		uint64_t triangles_saved = 0;
+	};
+
+	// Hierarchical LOD of the static scene. Regions swap whole sets of entity submeshes for one proxy draw
+	// beyond their switch distance; select() runs once per frame before extraction, which then skips the
+	// hidden submeshes and adds the active proxies as ordinary static instances, so culling, shadows and
+	// sorting see them like any other draw.
+	class HLODSet {
+	public:
+		void add_region(const HLODRegion& region, std::span<const uint32_t> entity_submesh_pairs);
+		// Sorts the members by entity, has to run before select() / get_members()
+		void build();
+
+		// active[r] = 1 when region r draws its proxy; distance_scale multiplies every switch distance
+		void select(const bud::math::vec3& camera_position, float distance_scale, std::vector<uint8_t>& active, HLODStats& stats) const;
+
+		// Members of one entity, sorted by submesh; empty when no region covers it
+		std::span<const HLODMember> get_members(uint32_t entity) const;
+
+		const std::vector<HLODRegion>& get_regions() const { return regions; }
+		size_t member_count() const { return members.size(); }
+		size_t entity_count() const { return entity_offsets.empty() ? 0 : entity_offsets.size() - 1; } // Highest member entity + 1
+
+	private:
+		std::vector<HLODRegion> regions;
+		std::vector<HLODMember> members;          // By entity, then submesh, after build()
+		std::vector<uint32_t> entity_offsets;     // members of entity e: [entity_offsets[e], entity_offsets[e + 1])
+	};
+}
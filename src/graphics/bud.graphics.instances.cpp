@@ -0,0 +1,127 @@
+﻿#include <cstring>
+#include <limits>
+
+#include "src/graphics/bud.graphics.instances.hpp"
+
+namespace bud::graphics {
+
+	namespace {
+		constexpr uint32_t NO_INSTANCE = std::numeric_limits<uint32_t>::max();
+
+		bool has_submesh(const RenderMesh& mesh, const SortItem& item) {
+			return item.submesh_index != UINT32_MAX && item.submesh_index < mesh.submeshes.size();
+		}
+	}
+
+	void InstanceDataBuilder::begin(size_t entity_count) {
+		// Only the entities drawn last frame are reset, a full clear per frame would cost O(scene)
+		if (entity_instance.size() != entity_count) {
+			entity_instance.assign(entity_count, NO_INSTANCE);
+		} else {
+			for (uint32_t entity : instance_entities) {
+				entity_instance[entity] = NO_INSTANCE;
+			}
+		}
+		draws.clear();
+		instance_entities.clear();
+	}
+
+	void InstanceDataBuilder::add_draws(const RenderScene& render_scene, const std::vector<RenderMesh>& meshes, const SortItem* items, size_t count) {
+		draws.reserve(draws.size() + count);
+		for (size_t i = 0; i < count; ++i) {
+			const auto& item = items[i];
+			uint32_t& instance = entity_instance[item.entity_index];
+			if (instance == NO_INSTANCE) {
+				instance = static_cast<uint32_t>(instance_entities.size());
+				instance_entities.push_back(item.entity_index);
+			}
+			draws.push_back({ instance, get_draw_material_flags(render_scene, meshes, item) });
+		}
+	}
+
+	void InstanceDataBuilder::write(const RenderScene& render_scene, void* dst) const {
+		auto* bytes = static_cast<uint8_t*>(dst);
+		const uint64_t transform_offset = instance_data_transform_offset(draws.size());
+
+		const uint32_t header[4] = {
+			static_cast<uint32_t>(transform_offset / 16),
+			static_cast<uint32_t>(draws.size()),
+			static_cast<uint32_t>(instance_entities.size()),
+			0u
+		};
+		std::memcpy(bytes, header, sizeof(header));
+
+		const uint64_t draw_bytes = draws.size() * sizeof(GPUDrawInstance);
+		std::memcpy(bytes + INSTANCE_DATA_HEADER_SIZE, draws.data(), draw_bytes);
+		// Odd slot counts leave half a word before the transforms
+		std::memset(bytes + INSTANCE_DATA_HEADER_SIZE + draw_bytes, 0, transform_offset - INSTANCE_DATA_HEADER_SIZE - draw_bytes);
+
+		auto* transforms = reinterpret_cast<GPUInstanceTransform*>(bytes + transform_offset);
+		for (size_t i = 0; i < instance_entities.size(); ++i) {
+			transforms[i] = make_instance_transform(render_scene.world_matrices[instance_entities[i]]);
+		}
+	}
+
+	GPUInstanceTransform make_instance_transform(const bud::math::mat4& model) {
+		GPUInstanceTransform out;
+		for (int r = 0; r < 3; ++r) {
+			out.rows[r] = bud::math::vec4(model[0][r], model[1][r], model[2][r], model[3][r]);
+		}
+		return out;
+	}
+
+	uint32_t get_draw_material_flags(const RenderScene& render_scene, const std::vector<RenderMesh>& meshes, const SortItem& item) {
+		const uint32_t entity = item.entity_index;
+		const auto& mesh = meshes[render_scene.mesh_indices[entity]];
+
+		uint32_t flags = (render_scene.flags[entity] & 1) ? DrawFlag_Static : 0u;
+		uint32_t material_id = render_scene.material_indices[entity];
+		if (has_submesh(mesh, item)) {
+			const auto& sub = mesh.submeshes[item.submesh_index];
+			material_id = sub.material_id;
+			if (sub.double_sided) flags |= DrawFlag_DoubleSided;
+		}
+		return pack_draw_value(material_id, flags);
+	}
+
+	bool is_cluster_lod_draw(const RenderScene& render_scene, const std::vector<RenderMesh>& meshes, const SortItem& item) {
+		const auto& mesh = meshes[render_scene.mesh_indices[item.entity_index]];
+		// meshlet_count stays 0 when the meshlet upload failed
+		return mesh.meshlet_count > 0 && has_submesh(mesh, item) && mesh.submeshes[item.submesh_index].lod_meshlet_count > 0;
+	}
+
+	void fill_draw_data(GPUDrawData& out, const RenderScene& render_scene, const std::vector<RenderMesh>& meshes, const SortItem& item, bool cluster_lod) {
+		const uint32_t entity = item.entity_index;
+		const auto& mesh = meshes[render_scene.mesh_indices[entity]];
+		const auto& world_matrix = render_scene.world_matrices[entity];
+
+		uint32_t flags = (render_scene.flags[entity] & 1) ? DrawFlag_Static : 0u;
+		uint32_t meshlet_count = 0;
+		bud::math::AABB world_aabb;
+
+		out.vertex_offset = mesh.vertex_offset;
+		out.record_base = 0;
+
+		if (has_submesh(mesh, item)) {
+			const auto& sub = mesh.submeshes[item.submesh_index];
+			out.index_count = sub.index_count;
+			out.first_index = mesh.first_index + sub.index_start;
+			out.meshlet_offset = mesh.first_meshlet + sub.meshlet_start;
+			// meshlet count stays 0 when the meshlet upload failed, the draw is then emitted whole
+			meshlet_count = mesh.meshlet_count > 0 ? sub.meshlet_count : 0;
+			if (cluster_lod && is_cluster_lod_draw(render_scene, meshes, item)) meshlet_count = sub.lod_meshlet_count;
+			world_aabb = sub.aabb.transform(world_matrix);
+			if (sub.double_sided) flags |= DrawFlag_DoubleSided;
+		} else {
+			out.index_count = mesh.index_count;
+			out.first_index = mesh.first_index;
+			out.meshlet_offset = mesh.first_meshlet;
+			meshlet_count = mesh.meshlet_count;
+			world_aabb = mesh.aabb.transform(world_matrix);
+		}
+
+		out.min = world_aabb.min;
+		out.max = world_aabb.max;
+		out.meshlet_count_flags = pack_draw_value(meshlet_count, flags);
+	}
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "src/graphics/bud.graphics.types.hpp"
+#include "src/graphics/bud.graphics.scene.hpp"
+#include "src/graphics/bud.graphics.sortkey.hpp"
+
+namespace bud::graphics {
+
+	// Builds the per-frame GlobalInstanceData (layout in bud.graphics.types.hpp). Draw slots are added in
+	// submission order, the main view list first and the shadow casters after it; an entity gets a single
+	// transform however many of its submeshes and shadow draws reference it.
+	class InstanceDataBuilder {
+	public:
+		void begin(size_t entity_count);
+
+		// One draw slot per item, in order
+		void add_draws(const RenderScene& render_scene, const std::vector<RenderMesh>& meshes, const SortItem* items, size_t count);
+
+		uint32_t get_draw_count() const { return static_cast<uint32_t>(draws.size()); }
+		uint32_t get_instance_count() const { return static_cast<uint32_t>(instance_entities.size()); }
+		uint64_t get_size() const { return instance_data_size(draws.size(), instance_entities.size()); }
+
+		// dst holds get_size() bytes, usually a staging buffer
+		void write(const RenderScene& render_scene, void* dst) const;
+
+	private:
+		std::vector<GPUDrawInstance> draws;
+		std::vector<uint32_t> instance_entities;  // Entity of every transform
+		std::vector<uint32_t> entity_instance;    // Entity -> transform, UINT32_MAX when not drawn this frame
+	};
+
+	GPUInstanceTransform make_instance_transform(const bud::math::mat4& model);
+
+	// Material and DrawFlags of a sorted draw, packed as in GPUDrawInstance::material_flags
+	uint32_t get_draw_material_flags(const RenderScene& render_scene, const std::vector<RenderMesh>& meshes, const SortItem& item);
+
+	// Submesh with a cluster LOD hierarchy that made it into the meshlet pool
+	bool is_cluster_lod_draw(const RenderScene& render_scene, const std::vector<RenderMesh>& meshes, const SortItem& item);
+
+	// Culling record of a sorted draw; record_base is left 0 for the caller. cluster_lod hands meshlet culling
+	// every level of is_cluster_lod_draw() submeshes, the shader then keeps the cut of the view.
+	void fill_draw_data(GPUDrawData& out, const RenderScene& render_scene, const std::vector<RenderMesh>& meshes, const SortItem& item, bool cluster_lod = false);
+}
@@ -0,0 +1,250 @@
+﻿#include <vector>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <format>
+
+#include "src/graphics/bud.graphics.lighting.hpp"
+#include "src/io/bud.io.hpp"
+
+namespace bud::graphics {
+
+	namespace {
+		struct ViewSpaceLight {
+			bud::math::vec3 position;
+			float range;
+			bud::math::vec3 direction;
+			float cos_outer;
+			float sin_outer;
+			float min_depth;
+			float max_depth;
+			bool is_spot;
+		};
+
+		bool intersect_sphere_aabb(const bud::math::vec3& center, float radius, const bud::math::vec3& bmin, const bud::math::vec3& bmax) {
+			bud::math::vec3 closest = glm::clamp(center, bmin, bmax);
+			bud::math::vec3 d = closest - center;
+			return bud::math::dot(d, d) <= radius * radius;
+		}
+
+		// Cone vs bounding sphere of the cluster, conservative (keeps the light when in doubt)
+		bool intersect_cone_sphere(const ViewSpaceLight& light, const bud::math::vec3& center, float radius) {
+			bud::math::vec3 v = center - light.position;
+			float len_sq = bud::math::dot(v, v);
+			float v1_len = bud::math::dot(v, light.direction);
+			float dist_closest = light.cos_outer * std::sqrt(std::max(len_sq - v1_len * v1_len, 0.0f)) - v1_len * light.sin_outer;
+			bool angle_cull = dist_closest > radius;
+			bool front_cull = v1_len > radius + light.range;
+			bool back_cull = v1_len < -radius;
+			return !(angle_cull || front_cull || back_cull);
+		}
+	}
+
+	LightClusterStats assign_lights_to_clusters(const std::vector<GPULocalLight>& lights, uint32_t light_count, const SceneView& view, void* grid) {
+		LightClusterStats stats{};
+		if (!grid) return stats;
+
+		uint32_t* counts = reinterpret_cast<uint32_t*>(static_cast<uint8_t*>(grid) + LIGHT_CLUSTER_HEADER_SIZE);
+		uint32_t* indices = counts + LIGHT_CLUSTER_COUNT;
+		std::memset(counts, 0, LIGHT_CLUSTER_COUNT * sizeof(uint32_t));
+
+		light_count = std::min({ light_count, static_cast<uint32_t>(lights.size()), MAX_LOCAL_LIGHTS });
+
+		// Lights go to view space once, their depth extent rejects whole slices below
+		std::vector<ViewSpaceLight> view_lights(light_count);
+		for (uint32_t i = 0; i < light_count; ++i) {
+			const auto& light = lights[i];
+			auto& out = view_lights[i];
+			out.position = bud::math::vec3(view.view_matrix * bud::math::vec4(light.position, 1.0f));
+			out.range = light.range;
+			out.is_spot = light.type == static_cast<uint32_t>(LocalLightType::Spot);
+			out.direction = bud::math::normalize(bud::math::mat3(view.view_matrix) * light.direction);
+			out.cos_outer = light.spot_cos_outer;
+			out.sin_outer = std::sqrt(std::max(1.0f - light.spot_cos_outer * light.spot_cos_outer, 0.0f));
+			out.min_depth = -out.position.z - light.range;
+			out.max_depth = -out.position.z + light.range;
+		}
+
+		const bud::math::vec4 depth_params = light_cluster_depth_params(view.near_plane, view.far_plane);
+		const float near_z = depth_params.x;
+		const float far_z = depth_params.y;
+		const float p00 = view.proj_matrix[0][0];
+		const float p11 = view.proj_matrix[1][1];
+
+		std::vector<uint32_t> slice_lights;
+		slice_lights.reserve(light_count);
+
+		for (uint32_t z = 0; z < LIGHT_CLUSTER_Z; ++z) {
+			float slice_near = near_z * std::pow(far_z / near_z, static_cast<float>(z) / LIGHT_CLUSTER_Z);
+			float slice_far = near_z * std::pow(far_z / near_z, static_cast<float>(z + 1) / LIGHT_CLUSTER_Z);
+
+			slice_lights.clear();
+			for (uint32_t i = 0; i < light_count; ++i) {
+				if (view_lights[i].max_depth >= slice_near && view_lights[i].min_depth <= slice_far)
+					slice_lights.push_back(i);
+			}
+
+			for (uint32_t y = 0; y < LIGHT_CLUSTER_Y; ++y) {
+				float ndc_y0 = -1.0f + 2.0f * static_cast<float>(y) / LIGHT_CLUSTER_Y;
+				float ndc_y1 = -1.0f + 2.0f * static_cast<float>(y + 1) / LIGHT_CLUSTER_Y;
+
+				for (uint32_t x = 0; x < LIGHT_CLUSTER_X; ++x) {
+					const uint32_t cluster = x + LIGHT_CLUSTER_X * (y + LIGHT_CLUSTER_Y * z);
+					if (slice_lights.empty()) continue;
+
+					float ndc_x0 = -1.0f + 2.0f * static_cast<float>(x) / LIGHT_CLUSTER_X;
+					float ndc_x1 = -1.0f + 2.0f * static_cast<float>(x + 1) / LIGHT_CLUSTER_X;
+
+					// View-space bounds of the tile frustum between both slice depths (camera looks down -Z)
+					float xs[4] = { ndc_x0 * slice_near / p00, ndc_x1 * slice_near / p00, ndc_x0 * slice_far / p00, ndc_x1 * slice_far / p00 };
+					float ys[4] = { ndc_y0 * slice_near / p11, ndc_y1 * slice_near / p11, ndc_y0 * slice_far / p11, ndc_y1 * slice_far / p11 };
+					bud::math::vec3 bmin(*std::min_element(xs, xs + 4), *std::min_element(ys, ys + 4), -slice_far);
+					bud::math::vec3 bmax(*std::max_element(xs, xs + 4), *std::max_element(ys, ys + 4), -slice_near);
+					bud::math::vec3 center = (bmin + bmax) * 0.5f;
+					float radius = bud::math::length(bmax - center);
+
+					uint32_t count = 0;
+					for (uint32_t i : slice_lights) {
+						const auto& light = view_lights[i];
+						if (!intersect_sphere_aabb(light.position, light.range, bmin, bmax)) continue;
+						if (light.is_spot && !intersect_cone_sphere(light, center, radius)) continue;
+
+						if (count < MAX_LIGHTS_PER_CLUSTER) {
+							indices[cluster * MAX_LIGHTS_PER_CLUSTER + count] = i;
+						}
+						++count;
+					}
+
+					if (count == 0) continue;
+
+					const uint32_t stored = std::min(count, MAX_LIGHTS_PER_CLUSTER);
+					counts[cluster] = stored;
+					stats.total_refs += stored;
+					stats.active_clusters += 1;
+					stats.max_lights = std::max(stats.max_lights, count);
+					if (count > MAX_LIGHTS_PER_CLUSTER) stats.overflow_clusters += 1;
+				}
+			}
+		}
+
+		std::memcpy(grid, &stats, sizeof(LightClusterStats));
+		return stats;
+	}
+
+	uint32_t count_light_cluster_mismatches(const void* reference_grid, const void* grid) {
+		if (!reference_grid || !grid) return 0;
+
+		const uint32_t* ref_counts = reinterpret_cast<const uint32_t*>(static_cast<const uint8_t*>(reference_grid) + LIGHT_CLUSTER_HEADER_SIZE);
+		const uint32_t* counts = reinterpret_cast<const uint32_t*>(static_cast<const uint8_t*>(grid) + LIGHT_CLUSTER_HEADER_SIZE);
+		const uint32_t* ref_indices = ref_counts + LIGHT_CLUSTER_COUNT;
+		const uint32_t* indices = counts + LIGHT_CLUSTER_COUNT;
+
+		uint32_t mismatches = 0;
+		uint32_t a[MAX_LIGHTS_PER_CLUSTER];
+		uint32_t b[MAX_LIGHTS_PER_CLUSTER];
+		for (uint32_t cluster = 0; cluster < LIGHT_CLUSTER_COUNT; ++cluster) {
+			const uint32_t count = ref_counts[cluster];
+			if (count != counts[cluster]) {
+				mismatches++;
+				continue;
+			}
+			if (count == 0 || count > MAX_LIGHTS_PER_CLUSTER) continue;
+
+			// A full cluster may have overflowed, the subset it kept is up to the GPU
+			if (count == MAX_LIGHTS_PER_CLUSTER) continue;
+
+			std::copy_n(ref_indices + cluster * MAX_LIGHTS_PER_CLUSTER, count, a);
+			std::copy_n(indices + cluster * MAX_LIGHTS_PER_CLUSTER, count, b);
+			std::sort(a, a + count);
+			std::sort(b, b + count);
+			if (!std::equal(a, a + count, b)) mismatches++;
+		}
+		return mismatches;
+	}
+
+	void LightClusteringPass::init(RHI* rhi, const RenderConfig& config, bud::io::AssetManager* asset_manager) {
+		if (!rhi || !asset_manager) {
+			std::string err = std::format("LightClusteringPass::init invalid args: rhi={} asset_manager={}", (void*)rhi, (void*)asset_manager);
+			bud::eprint("{}", err);
+#if defined(_DEBUG)
+			throw std::runtime_error(err);
+#else
+			return;
+#endif
+		}
+
+		load_shaders_async(asset_manager, { "src/shaders/light_cluster_assign.comp.spv" }, [this, rhi](const auto& shaders) {
+			ComputePipelineDesc desc;
+			desc.cs.code = shaders[0];
+			pipeline = rhi->create_compute_pipeline(desc);
+			if (pipeline) {
+				bud::print("[LightClusteringPass] Shader loaded and pipeline created.");
+			}
+		});
+	}
+
+	RGHandle LightClusteringPass::add_to_graph(RenderGraph& render_graph, RGHandle light_buffer, RGHandle cluster_grid, const SceneView& view, uint32_t light_count,
+		BufferHandle readback, uint64_t readback_size) {
+		if (!pipeline || light_count == 0) {
+			return {};
+		}
+
+		return render_graph.add_pass("Light Clustering Pass",
+			[=](RGBuilder& builder) {
+				builder.read(light_buffer, ResourceState::ShaderResource);
+				builder.write(cluster_grid, ResourceState::UnorderedAccess);
+				return cluster_grid;
+			},
+			[=, &render_graph, this](RHI* rhi, CommandHandle cmd) {
+				if (!pipeline) return;
+
+				bud::graphics::BufferHandle light_buf{};
+				bud::graphics::BufferHandle grid_buf{};
+				try {
+					light_buf = render_graph.get_buffer(light_buffer);
+					grid_buf = render_graph.get_buffer(cluster_grid);
+				} catch (const std::exception& e) {
+					bud::eprint("[LightClusteringPass] Resource lookup failed: {}", e.what());
+					return;
+				}
+
+				if (!light_buf.is_valid() || !grid_buf.is_valid()) {
+					std::string err = std::format("LightClusteringPass missing resources: lights={} grid={}", light_buf.is_valid(), grid_buf.is_valid());
+					bud::eprint("{}", err);
+#if defined(_DEBUG)
+					throw std::runtime_error(err);
+#else
+					return;
+#endif
+				}
+
+				rhi->cmd_begin_gpu_timer(cmd, GPUTimer::LightAssignment);
+
+				// Every cluster rewrites its count, only the stats header accumulates
+				LightClusterStats zero_header{};
+				rhi->resource_barrier(cmd, grid_buf, ResourceState::UnorderedAccess, ResourceState::TransferDst);
+				rhi->cmd_copy_to_buffer(cmd, grid_buf, 0, LIGHT_CLUSTER_HEADER_SIZE, &zero_header);
+				rhi->resource_barrier(cmd, grid_buf, ResourceState::TransferDst, ResourceState::UnorderedAccess);
+
+				rhi->update_global_uniforms(rhi->get_current_image_index(), view);
+
+				rhi->cmd_bind_pipeline(cmd, pipeline);
+				rhi->cmd_bind_storage_buffer(cmd, pipeline, 0, light_buf);
+				rhi->cmd_bind_storage_buffer(cmd, pipeline, 1, grid_buf);
+				rhi->cmd_bind_compute_ubo(cmd, pipeline, 4);
+				rhi->cmd_push_constants(cmd, pipeline, sizeof(uint32_t), &light_count);
+
+				rhi->cmd_dispatch(cmd, LIGHT_CLUSTER_COUNT, 1, 1);
+
+				// The grid is device-local, the header (and the whole grid when validating) goes back through a copy
+				if (readback.is_valid() && readback_size > 0) {
+					rhi->resource_barrier(cmd, grid_buf, ResourceState::UnorderedAccess, ResourceState::TransferSrc);
+					rhi->cmd_copy_buffer(cmd, grid_buf, readback, std::min(readback_size, readback.size));
+					rhi->resource_barrier(cmd, grid_buf, ResourceState::TransferSrc, ResourceState::UnorderedAccess);
+				}
+
+				rhi->cmd_end_gpu_timer(cmd, GPUTimer::LightAssignment);
+			}
+		);
+	}
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <vector>
+
+#include "src/core/bud.math.hpp"
+#include "src/graphics/bud.graphics.types.hpp"
+#include "src/graphics/bud.graphics.graph.hpp"
+#include "src/graphics/bud.graphics.passes.hpp"
+
+namespace bud::io { class AssetManager; }
+
+namespace bud::graphics {
+	// Header of the light cluster grid buffer, written by both assignment paths
+	struct LightClusterStats {
+		uint32_t total_refs = 0;         // Stored light indices over all clusters
+		uint32_t overflow_clusters = 0;  // Clusters with more than MAX_LIGHTS_PER_CLUSTER lights
+		uint32_t max_lights = 0;         // Largest light count of a cluster before clamping
+		uint32_t active_clusters = 0;    // Clusters with at least one light
+	};
+	static_assert(sizeof(LightClusterStats) == LIGHT_CLUSTER_HEADER_SIZE, "LightClusterStats must match the grid buffer header");
+
+	// CPU reference of light_cluster_assign.comp. Fills `grid` (LIGHT_CLUSTER_BUFFER_SIZE bytes)
+	// with the same layout and cluster bounds the compute pass produces.
+	LightClusterStats assign_lights_to_clusters(const std::vector<GPULocalLight>& lights, uint32_t light_count, const SceneView& view, void* grid);
+
+	// Clusters whose light lists differ between two grids. The compute pass stores a cluster's lights in any
+	// order, and an overflowing cluster keeps an arbitrary subset, so those two compare as sets / by count.
+	uint32_t count_light_cluster_mismatches(const void* reference_grid, const void* grid);
+
+	// One workgroup per cluster, threads stride over the light list (light_cluster_assign.comp)
+	class LightClusteringPass : public RenderPass {
+	public:
+		void init(RHI* rhi, const RenderConfig& config, bud::io::AssetManager* asset_manager) override;
+		// readback_size bytes of the finished grid (at least the LightClusterStats header) are copied into readback
+		RGHandle add_to_graph(RenderGraph& rg, RGHandle light_buffer, RGHandle cluster_grid, const SceneView& view, uint32_t light_count,
+			BufferHandle readback, uint64_t readback_size);
+	};
+}
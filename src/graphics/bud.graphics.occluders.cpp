@@ -0,0 +1,300 @@
+﻿#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+#include "src/graphics/bud.graphics.occluders.hpp"
+#include "src/threading/bud.threading.hpp"
+#include "src/core/bud.profiler.hpp"
+
+namespace bud::graphics {
+
+	namespace {
+		constexpr size_t OCCLUDER_CHUNK_SIZE = 256;
+		constexpr float OCCLUDER_TRIANGLE_REFERENCE = 1024.0f; // Triangle count at which simplicity halves the score
+		constexpr float OCCLUDER_RECT_SHRINK = 0.25f;          // A box's screen rect overstates the silhouette, splat the inner part only
+		constexpr float OCCLUDER_SUCCESS_TARGET = 4.0f;        // Occludees per frame that count as full success
+		constexpr float OCCLUDER_HISTORY_RATE = 0.2f;
+		constexpr float OCCLUDER_HISTORY_DECAY = 0.02f;        // Unselected candidates drift back to unknown
+		constexpr uint32_t NOT_OCCLUDED = std::numeric_limits<uint32_t>::max();
+		constexpr uint32_t IS_OCCLUDER = NOT_OCCLUDED - 1;
+
+		uint32_t to_tile(float ndc, uint32_t tiles) {
+			return static_cast<uint32_t>(std::clamp((ndc * 0.5f + 0.5f) * static_cast<float>(tiles), 0.0f, static_cast<float>(tiles)));
+		}
+	}
+
+	void OccluderSelector::reset() {
+		budget = 0.0f;
+		history.clear();
+		stats = {};
+	}
+
+	void OccluderSelector::adapt_budget(float prepass_ms, const RenderConfig& config) {
+		const float min_k = static_cast<float>(std::max(config.occluder_min_count, 1u));
+		const float max_k = std::max(static_cast<float>(config.occluder_max_count), min_k);
+		const float target_ms = config.occluder_prepass_budget_ms;
+
+		if (budget <= 0.0f) {
+			budget = max_k;
+		}
+
+		// Same shape as the dynamic resolution controller: drop with the overshoot, climb slowly,
+		// hold inside the band so K doesn't oscillate on the few-frames-late timestamps
+		if (prepass_ms > 0.0f && target_ms > 0.0f) {
+			if (prepass_ms > target_ms) {
+				budget *= std::max(target_ms / prepass_ms, 0.5f);
+			} else if (prepass_ms < target_ms * 0.85f) {
+				budget = budget * 1.05f + 1.0f;
+			}
+		}
+		budget = std::clamp(budget, min_k, max_k);
+	}
+
+	void OccluderSelector::select(const RenderScene& render_scene, const std::vector<RenderMesh>& meshes,
+		const std::vector<SortItem>& sort_list, size_t visible_count,
+		const SceneView& view, const RenderConfig& config,
+		bud::threading::TaskScheduler* task_scheduler, std::vector<SortItem>& occluders) {
+		ZoneScoped;
+
+		auto select_start = std::chrono::high_resolution_clock::now();
+		occluders.clear();
+		stats = {};
+
+		visible_count = std::min(visible_count, sort_list.size());
+		if (visible_count == 0) {
+			return;
+		}
+
+		if (budget <= 0.0f) {
+			adapt_budget(0.0f, config);
+		}
+
+		const size_t entity_count = render_scene.world_matrices.size();
+		if (history.size() != entity_count) {
+			history.resize(entity_count, 0.5f);
+		}
+
+		const float far_plane = std::max(view.far_plane, 1e-3f);
+		const float min_area = config.occluder_min_screen_area;
+		const auto& view_proj = view.view_proj_matrix;
+
+		// 1. Screen bounds and score of every visible draw
+		bounds.resize(visible_count);
+		auto compute_bounds = [&](size_t start, size_t end) {
+			for (size_t i = start; i < end; ++i) {
+				auto& b = bounds[i];
+				b = {};
+
+				const auto& item = sort_list[i];
+				if (item.entity_index >= entity_count) continue;
+				uint32_t mesh_id = render_scene.mesh_indices[item.entity_index];
+				if (mesh_id >= meshes.size() || !meshes[mesh_id].is_valid()) continue;
+				const auto& mesh = meshes[mesh_id];
+
+				bud::math::AABB local_aabb = mesh.aabb;
+				b.triangles = mesh.index_count / 3;
+				if (item.submesh_index != UINT32_MAX && item.submesh_index < mesh.submeshes.size()) {
+					const auto& sub = mesh.submeshes[item.submesh_index];
+					local_aabb = sub.aabb;
+					b.triangles = sub.index_count / 3;
+				}
+				auto world_aabb = local_aabb.transform(render_scene.world_matrices[item.entity_index]);
+
+				float min_x = std::numeric_limits<float>::max();
+				float min_y = std::numeric_limits<float>::max();
+				float max_x = std::numeric_limits<float>::lowest();
+				float max_y = std::numeric_limits<float>::lowest();
+				b.min_depth = std::numeric_limits<float>::max();
+				b.max_depth = 0.0f;
+				b.in_front = true;
+				for (uint32_t c = 0; c < 8; ++c) {
+					bud::math::vec4 corner(
+						(c & 1) ? world_aabb.max.x : world_aabb.min.x,
+						(c & 2) ? world_aabb.max.y : world_aabb.min.y,
+						(c & 4) ? world_aabb.max.z : world_aabb.min.z,
+						1.0f);
+					auto clip = view_proj * corner;
+					b.min_depth = std::min(b.min_depth, clip.w);
+					b.max_depth = std::max(b.max_depth, clip.w);
+					if (clip.w <= view.near_plane) {
+						b.in_front = false;
+						continue;
+					}
+					min_x = std::min(min_x, clip.x / clip.w);
+					min_y = std::min(min_y, clip.y / clip.w);
+					max_x = std::max(max_x, clip.x / clip.w);
+					max_y = std::max(max_y, clip.y / clip.w);
+				}
+
+				if (b.in_front) {
+					b.rect[0] = std::clamp(min_x, -1.0f, 1.0f);
+					b.rect[1] = std::clamp(min_y, -1.0f, 1.0f);
+					b.rect[2] = std::clamp(max_x, -1.0f, 1.0f);
+					b.rect[3] = std::clamp(max_y, -1.0f, 1.0f);
+				} else {
+					// Straddles the near plane: may cover anything, depth starts at the camera
+					b.rect[0] = -1.0f; b.rect[1] = -1.0f;
+					b.rect[2] = 1.0f; b.rect[3] = 1.0f;
+					b.min_depth = 0.0f;
+				}
+
+				const float area = std::max(b.rect[2] - b.rect[0], 0.0f) * std::max(b.rect[3] - b.rect[1], 0.0f) * 0.25f;
+				if (area <= 0.0f || area < min_area) continue;
+
+				const float closeness = 1.0f - std::clamp(b.min_depth / far_plane, 0.0f, 1.0f);
+				const float simplicity = 1.0f / (1.0f + static_cast<float>(b.triangles) / OCCLUDER_TRIANGLE_REFERENCE);
+				b.score = area
+					* (0.25f + 0.75f * closeness)
+					* (0.25f + 0.75f * simplicity)
+					* (0.5f + history[item.entity_index]);
+			}
+		};
+
+		if (task_scheduler && visible_count > OCCLUDER_CHUNK_SIZE) {
+			bud::threading::Counter bounds_counter;
+			task_scheduler->ParallelFor(visible_count, OCCLUDER_CHUNK_SIZE, compute_bounds, &bounds_counter);
+			task_scheduler->wait_for_counter(bounds_counter);
+		} else {
+			compute_bounds(0, visible_count);
+		}
+
+		// 2. Top K by score, ties broken by draw order so the pick is deterministic
+		ranked.clear();
+		uint32_t largest = NOT_OCCLUDED;
+		float largest_area = -1.0f;
+		for (uint32_t i = 0; i < static_cast<uint32_t>(visible_count); ++i) {
+			const auto& b = bounds[i];
+			if (b.score > 0.0f) {
+				ranked.push_back(i);
+			}
+			const float area = (b.rect[2] - b.rect[0]) * (b.rect[3] - b.rect[1]);
+			if (b.max_depth > 0.0f && area > largest_area) {
+				largest_area = area;
+				largest = i;
+			}
+		}
+		stats.candidates = static_cast<uint32_t>(ranked.size());
+
+		// Nothing above the area threshold: the largest draw keeps the prepass and Hi-Z meaningful
+		if (ranked.empty() && largest != NOT_OCCLUDED) {
+			ranked.push_back(largest);
+		}
+
+		const size_t k = std::min(static_cast<size_t>(budget), ranked.size());
+		auto by_score = [this](uint32_t a, uint32_t b) {
+			if (bounds[a].score != bounds[b].score) return bounds[a].score > bounds[b].score;
+			return a < b;
+		};
+		if (k < ranked.size()) {
+			std::nth_element(ranked.begin(), ranked.begin() + k, ranked.end(), by_score);
+			for (size_t r = k; r < ranked.size(); ++r) {
+				float& h = history[sort_list[ranked[r]].entity_index];
+				h += (0.5f - h) * OCCLUDER_HISTORY_DECAY;
+			}
+		}
+
+		selected_draws.assign(ranked.begin(), ranked.begin() + k);
+		// Front to back, the prepass rejects as much as it can early
+		std::sort(selected_draws.begin(), selected_draws.end(), [this](uint32_t a, uint32_t b) {
+			if (bounds[a].min_depth != bounds[b].min_depth) return bounds[a].min_depth < bounds[b].min_depth;
+			return a < b;
+		});
+
+		occluders.reserve(selected_draws.size());
+		for (uint32_t draw : selected_draws) {
+			occluders.push_back(sort_list[draw]);
+			stats.triangles += bounds[draw].triangles;
+		}
+		stats.budget = static_cast<uint32_t>(budget);
+		stats.selected = static_cast<uint32_t>(occluders.size());
+
+		// 3. Temporal success: what each occluder hid this frame feeds its score next frame
+		estimate_occlusion(visible_count, occluders, task_scheduler);
+		for (size_t s = 0; s < selected_draws.size(); ++s) {
+			const float success = std::min(static_cast<float>(credits[s]) / OCCLUDER_SUCCESS_TARGET, 1.0f);
+			float& h = history[occluders[s].entity_index];
+			h += (success - h) * OCCLUDER_HISTORY_RATE;
+		}
+
+		stats.select_ms = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - select_start).count();
+	}
+
+	void OccluderSelector::estimate_occlusion(size_t visible_count, const std::vector<SortItem>& occluders,
+		bud::threading::TaskScheduler* task_scheduler) {
+		grid.assign(GRID_WIDTH * GRID_HEIGHT, GridTile{ std::numeric_limits<float>::max(), NOT_OCCLUDED });
+		occluded_by.assign(visible_count, NOT_OCCLUDED);
+		credits.assign(occluders.size(), 0);
+
+		// Splat the tiles each occluder fully covers, nearest far depth wins
+		for (uint32_t s = 0; s < static_cast<uint32_t>(selected_draws.size()); ++s) {
+			const uint32_t draw = selected_draws[s];
+			occluded_by[draw] = IS_OCCLUDER;
+
+			const auto& b = bounds[draw];
+			if (!b.in_front) continue;
+
+			const float cx = (b.rect[0] + b.rect[2]) * 0.5f;
+			const float cy = (b.rect[1] + b.rect[3]) * 0.5f;
+			const float hx = (b.rect[2] - b.rect[0]) * 0.5f * (1.0f - OCCLUDER_RECT_SHRINK);
+			const float hy = (b.rect[3] - b.rect[1]) * 0.5f * (1.0f - OCCLUDER_RECT_SHRINK);
+
+			// Inner tiles: round the start up and the end down
+			const uint32_t x0 = std::min(to_tile(cx - hx, GRID_WIDTH) + 1, GRID_WIDTH);
+			const uint32_t y0 = std::min(to_tile(cy - hy, GRID_HEIGHT) + 1, GRID_HEIGHT);
+			const uint32_t x1 = to_tile(cx + hx, GRID_WIDTH);
+			const uint32_t y1 = to_tile(cy + hy, GRID_HEIGHT);
+			for (uint32_t y = y0; y < y1; ++y) {
+				for (uint32_t x = x0; x < x1; ++x) {
+					auto& tile = grid[y * GRID_WIDTH + x];
+					if (b.max_depth < tile.depth) {
+						tile.depth = b.max_depth;
+						tile.owner = s;
+					}
+				}
+			}
+		}
+
+		// A draw is hidden when every tile it touches has an occluder entirely in front of it
+		auto test_draws = [&](size_t start, size_t end) {
+			for (size_t i = start; i < end; ++i) {
+				if (occluded_by[i] == IS_OCCLUDER) continue;
+				const auto& b = bounds[i];
+				if (!b.in_front || b.max_depth <= 0.0f) continue;
+
+				const uint32_t x0 = std::min(to_tile(b.rect[0], GRID_WIDTH), GRID_WIDTH - 1);
+				const uint32_t y0 = std::min(to_tile(b.rect[1], GRID_HEIGHT), GRID_HEIGHT - 1);
+				const uint32_t x1 = std::clamp(to_tile(b.rect[2], GRID_WIDTH) + 1, x0 + 1, GRID_WIDTH);
+				const uint32_t y1 = std::clamp(to_tile(b.rect[3], GRID_HEIGHT) + 1, y0 + 1, GRID_HEIGHT);
+
+				bool hidden = true;
+				for (uint32_t y = y0; y < y1 && hidden; ++y) {
+					for (uint32_t x = x0; x < x1; ++x) {
+						if (grid[y * GRID_WIDTH + x].depth >= b.min_depth) {
+							hidden = false;
+							break;
+						}
+					}
+				}
+				if (hidden) {
+					occluded_by[i] = grid[((y0 + y1) / 2) * GRID_WIDTH + (x0 + x1) / 2].owner;
+				}
+			}
+		};
+
+		if (task_scheduler && visible_count > OCCLUDER_CHUNK_SIZE) {
+			bud::threading::Counter test_counter;
+			task_scheduler->ParallelFor(visible_count, OCCLUDER_CHUNK_SIZE, test_draws, &test_counter);
+			task_scheduler->wait_for_counter(test_counter);
+		} else {
+			test_draws(0, visible_count);
+		}
+
+		for (uint32_t owner : occluded_by) {
+			if (owner < credits.size()) {
+				credits[owner] += 1;
+				stats.estimated_occluded += 1;
+			}
+		}
+	}
+}
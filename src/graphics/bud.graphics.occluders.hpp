@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "src/core/bud.math.hpp"
+#include "src/graphics/bud.graphics.types.hpp"
+#include "src/graphics/bud.graphics.scene.hpp"
+#include "src/graphics/bud.graphics.sortkey.hpp"
+
+namespace bud::threading { class TaskScheduler; }
+
+namespace bud::graphics {
+	struct OccluderSelectionStats {
+		uint32_t candidates = 0;          // Visible draws above RenderConfig::occluder_min_screen_area
+		uint32_t budget = 0;              // K of this frame
+		uint32_t selected = 0;
+		uint32_t triangles = 0;           // Drawn by the Z-prepass
+		uint32_t estimated_occluded = 0;  // Visible draws behind the selection in the coarse CPU depth grid
+		float select_ms = 0.0f;
+	};
+
+	// CPU occluder selection for the Z-prepass and the Hi-Z build. Visible draws are ranked by
+	// projected area, closeness, triangle cost and how much they occluded in earlier frames;
+	// only the top K are drawn. K follows RenderConfig::occluder_prepass_budget_ms.
+	//
+	// Occlusion success is estimated on the CPU: the selection is splatted into a coarse tile
+	// grid (inner screen rect, farthest depth) and the remaining draws are tested against it.
+	// Deterministic for identical inputs, so scripted benchmark runs are comparable.
+	class OccluderSelector {
+	public:
+		// Fills `occluders` front to back. Never empty when visible_count > 0.
+		void select(const RenderScene& render_scene, const std::vector<RenderMesh>& meshes,
+			const std::vector<SortItem>& sort_list, size_t visible_count,
+			const SceneView& view, const RenderConfig& config,
+			bud::threading::TaskScheduler* task_scheduler, std::vector<SortItem>& occluders);
+
+		// Z-prepass GPU time of an earlier frame, 0 when timestamps are unavailable (K stays put)
+		void adapt_budget(float prepass_ms, const RenderConfig& config);
+
+		void reset();
+		const OccluderSelectionStats& get_stats() const { return stats; }
+
+	private:
+		static constexpr uint32_t GRID_WIDTH = 64;
+		static constexpr uint32_t GRID_HEIGHT = 36;
+
+		struct DrawBounds {
+			float rect[4];        // NDC min x, min y, max x, max y, clamped to the viewport
+			float min_depth;      // View distance (clip w) of the nearest / farthest AABB corner
+			float max_depth;
+			float score;          // 0: not a candidate
+			uint32_t triangles;
+			bool in_front;        // All corners in front of the near plane
+		};
+
+		struct GridTile {
+			float depth;          // Farthest depth of the nearest occluder covering the whole tile
+			uint32_t owner;       // Index into the selection
+		};
+
+		void estimate_occlusion(size_t visible_count, const std::vector<SortItem>& occluders,
+			bud::threading::TaskScheduler* task_scheduler);
+
+		float budget = 0.0f;                 // K, kept as float so small multiplicative steps accumulate
+		std::vector<float> history;          // Per entity, EMA of occlusion success, 0.5 = unknown
+		std::vector<DrawBounds> bounds;      // Per visible draw of the current frame
+		std::vector<uint32_t> ranked;        // Candidate draw indices
+		std::vector<uint32_t> selected_draws;
+		std::vector<uint32_t> occluded_by;   // Per visible draw, selection index or UINT32_MAX
+		std::vector<uint32_t> credits;       // Per selected occluder
+		std::vector<GridTile> grid;
+		OccluderSelectionStats stats;
+	};
+}
@@ -29,6 +29,17 @@ namespace bud::graphics {
 			return;
 		}
 
+		auto* pending = &asset_manager->get_shader_load_counter();
+		pending->fetch_add(1);
+		std::function<void(std::vector<std::vector<char>>)> finish = [pending, on_loaded = std::move(on_loaded)](std::vector<std::vector<char>> shaders) {
+			on_loaded(std::move(shaders));
+			pending->fetch_sub(1);
+		};
+
+		if (asset_manager->load_bundled_files_async(paths, finish)) {
+			return;
+		}
+
 		struct Context {
 			std::vector<std::vector<char>> results;
 			std::atomic<size_t> loaded_count{ 0 };
@@ -36,7 +47,7 @@ namespace bud::graphics {
 		};
 		auto ctx = std::make_shared<Context>();
 		ctx->results.resize(paths.size());
-		ctx->on_loaded = std::move(on_loaded);
+		ctx->on_loaded = std::move(finish);
 
 		for (size_t i = 0; i < paths.size(); ++i) {
 			asset_manager->load_file_async(paths[i], [ctx, i, count = paths.size()](std::vector<char> code) {
@@ -72,6 +83,56 @@ namespace bud::graphics {
 				&& std::abs(a.shadow_bias_constant - b.shadow_bias_constant) < 1e-6f
 				&& std::abs(a.shadow_bias_slope - b.shadow_bias_slope) < 1e-6f;
 		}
+
+		// Picks the pipeline of a depth-only draw: position-only unless the material is alpha-tested (or not
+		// classified yet), and tracks the vertex fetch of the pass. Fetch is counted per index, the split
+		// figure against what the same draws fetched from the 48-byte interleaved vertex.
+		struct DepthDrawSelector {
+			RHI* rhi;
+			CommandHandle cmd;
+			void* masked_pipeline;
+			void* opaque_pipeline;
+			const std::vector<uint8_t>& alpha_tested_materials;
+			void* bound = nullptr;
+			uint64_t fetch_bytes = 0;
+			uint64_t interleaved_bytes = 0;
+			uint32_t opaque_draws = 0;
+			uint32_t masked_draws = 0;
+
+			bool is_masked(uint32_t material_id) const {
+				return !opaque_pipeline || material_id >= alpha_tested_materials.size() || alpha_tested_materials[material_id] != 0;
+			}
+
+			// Binds the pipeline when it differs from the current one, returns it for the push constants
+			void* select(uint32_t material_id, uint32_t index_count) {
+				const bool masked = is_masked(material_id);
+				void* wanted = masked ? masked_pipeline : opaque_pipeline;
+				if (wanted != bound) {
+					rhi->cmd_bind_pipeline(cmd, wanted);
+					rhi->cmd_bind_descriptor_set(cmd, wanted, 0);
+					bound = wanted;
+				}
+
+				const uint32_t stride = masked ? bud::io::VERTEX_POSITION_STRIDE + bud::io::VERTEX_ATTRIBUTE_STRIDE : bud::io::VERTEX_POSITION_STRIDE;
+				fetch_bytes += static_cast<uint64_t>(index_count) * stride;
+				interleaved_bytes += static_cast<uint64_t>(index_count) * bud::io::VERTEX_INTERLEAVED_STRIDE;
+				if (masked) masked_draws++;
+				else opaque_draws++;
+				return wanted;
+			}
+
+			// Every cascade begins its own render pass and rebinds, as the single-pipeline loop did
+			void invalidate() { bound = nullptr; }
+
+			void flush(VertexFetchPass pass) const {
+				auto& stats = rhi->get_render_stats();
+				const auto slot = static_cast<uint32_t>(pass);
+				stats.vertex_fetch_bytes[slot] += fetch_bytes;
+				stats.vertex_fetch_interleaved_bytes[slot] += interleaved_bytes;
+				stats.depth_opaque_draws += opaque_draws;
+				stats.depth_masked_draws += masked_draws;
+			}
+		};
 	}
 
     void HiZCullingPass::init(RHI* rhi, const RenderConfig& config, bud::io::AssetManager* asset_manager) {
@@ -95,7 +156,7 @@ namespace bud::graphics {
 		});
 	}
 
-    RGHandle HiZCullingPass::add_to_graph(RenderGraph& render_graph, RGHandle instance_buffer, RGHandle indirect_draw_buffer, RGHandle stats_buffer, RGHandle hiz_pyramid, const SceneView& view, size_t instance_count) {
+    RGHandle HiZCullingPass::add_to_graph(RenderGraph& render_graph, RGHandle instance_buffer, RGHandle indirect_draw_buffer, RGHandle stats_buffer, RGHandle hiz_pyramid, const SceneView& view, const RenderConfig& config, size_t instance_count) {
         if (!pipeline) {
             std::string err = "HiZCullingPass::add_to_graph called with null pipeline";
             bud::eprint("{}", err);
@@ -134,21 +195,18 @@ namespace bud::graphics {
 			}
 
                 if (!inst_buf.is_valid() || !ind_buf.is_valid() || !stat_buf.is_valid() || !depth_tex) {
-					static bool printed = false;
-					if(!printed) {
-						bud::print("[HiZCullingPass] Warning: Missing resources! inst={} ind={} stat={} depth={}", 
-							inst_buf.is_valid(), ind_buf.is_valid(), stat_buf.is_valid(), (bool)depth_tex);
-						printed = true;
-					}
-                    std::string err = std::format("HiZCullingPass missing resources: inst={} ind={} stat={} depth={}", inst_buf.is_valid(), ind_buf.is_valid(), stat_buf.is_valid(), (bool)depth_tex);
-                    bud::eprint("{}", err);
+					// Release builds skip the pass every frame, keep the log readable
+					BUD_LOG_RATE_LIMITED(Error, Render, 1000, "[HiZCullingPass] Missing resources: inst={} ind={} stat={} depth={}",
+						inst_buf.is_valid(), ind_buf.is_valid(), stat_buf.is_valid(), (bool)depth_tex);
 #if defined(_DEBUG)
-                    throw std::runtime_error(err);
+                    throw std::runtime_error(std::format("HiZCullingPass missing resources: inst={} ind={} stat={} depth={}", inst_buf.is_valid(), ind_buf.is_valid(), stat_buf.is_valid(), (bool)depth_tex));
 #else
                     return;
 #endif
 				}
 
+				rhi->cmd_begin_gpu_timer(cmd, GPUTimer::InstanceCulling);
+
 				// Clear stats buffer (all counters = 0)
 				GPUStats zero_stats{};
 				rhi->resource_barrier(cmd, stat_buf, ResourceState::UnorderedAccess, ResourceState::TransferDst);
@@ -157,6 +215,13 @@ namespace bud::graphics {
 				// Barrier: ensure the UpdateBuffer write is visible to the compute shader
 				rhi->resource_barrier(cmd, stat_buf, ResourceState::TransferDst, ResourceState::UnorderedAccess);
 
+				// Reset the compacted draw count in the indirect buffer header
+				const bool compact = use_indirect_count(rhi, config);
+				uint32_t zero_header[INDIRECT_COUNT_HEADER_SIZE / sizeof(uint32_t)] = {};
+				rhi->resource_barrier(cmd, ind_buf, ResourceState::UnorderedAccess, ResourceState::TransferDst);
+				rhi->cmd_copy_to_buffer(cmd, ind_buf, 0, INDIRECT_COUNT_HEADER_SIZE, zero_header);
+				rhi->resource_barrier(cmd, ind_buf, ResourceState::TransferDst, ResourceState::UnorderedAccess);
+
 				rhi->cmd_bind_pipeline(cmd, pipeline);
 
 				rhi->cmd_bind_storage_buffer(cmd, pipeline, 0, inst_buf);
@@ -167,14 +232,245 @@ namespace bud::graphics {
 
 				struct PushConsts {
 					uint32_t instanceCount;
+					uint32_t compact;
 				} pc;
 				pc.instanceCount = static_cast<uint32_t>(instance_count);
+				pc.compact = compact ? 1u : 0u;
 
 				rhi->cmd_push_constants(cmd, pipeline, sizeof(PushConsts), &pc);
 
 				// Dispatch 1 thread per instance
 				uint32_t group_x = (static_cast<uint32_t>(instance_count) + 255) / 256;
 				rhi->cmd_dispatch(cmd, group_x, 1, 1);
+				rhi->cmd_end_gpu_timer(cmd, GPUTimer::InstanceCulling);
+			}
+		);
+	}
+
+    void MeshletCullingPass::init(RHI* rhi, const RenderConfig& config, bud::io::AssetManager* asset_manager) {
+        if (!rhi || !asset_manager) {
+            std::string err = std::format("MeshletCullingPass::init invalid args: rhi={} asset_manager={}", (void*)rhi, (void*)asset_manager);
+            bud::eprint("{}", err);
+#if defined(_DEBUG)
+            throw std::runtime_error(err);
+#else
+            return;
+#endif
+        }
+
+		load_shaders_async(asset_manager, { "src/shaders/meshlet_cull.comp.spv" }, [this, rhi](const auto& shaders) {
+			ComputePipelineDesc desc;
+			desc.cs.code = shaders[0];
+			pipeline = rhi->create_compute_pipeline(desc);
+			if (pipeline) {
+				bud::print("[MeshletCullingPass] Shader loaded and pipeline created.");
+			}
+		});
+	}
+
+	RGHandle MeshletCullingPass::add_to_graph(RenderGraph& render_graph, RGHandle draw_buffer, RGHandle meshlet_indirect_buffer, RGHandle meshlet_visible_buffer,
+		RGHandle stats_buffer, RGHandle hiz_pyramid, RGHandle instance_data, bud::graphics::BufferHandle meshlet_pool,
+		bud::graphics::BufferHandle meshlet_lod_pool, const RenderConfig& config, size_t draw_count, uint32_t record_capacity,
+		bool mesh_shader_path, float lod_error_scale, float lod_z_near) {
+		if (!pipeline || draw_count == 0 || record_capacity == 0 || !meshlet_pool.is_valid()) {
+			return {};
+		}
+		const bool cluster_lod = lod_error_scale > 0.0f && meshlet_lod_pool.is_valid();
+
+		return render_graph.add_pass("Meshlet Culling Pass",
+			[=](RGBuilder& builder) {
+				builder.set_side_effect();
+				builder.read(draw_buffer, ResourceState::ShaderResource);
+				builder.read(instance_data, ResourceState::ShaderResource);
+				builder.read(hiz_pyramid, ResourceState::UnorderedAccess); // GENERAL, same as HiZCullingPass
+				builder.write(meshlet_indirect_buffer, ResourceState::UnorderedAccess);
+				builder.write(meshlet_visible_buffer, ResourceState::UnorderedAccess);
+				builder.write(stats_buffer, ResourceState::UnorderedAccess);
+				return meshlet_indirect_buffer;
+			},
+			[=, &render_graph, this](RHI* rhi, CommandHandle cmd) {
+				if (!pipeline) return;
+
+				bud::graphics::BufferHandle draw_buf{};
+				bud::graphics::BufferHandle ind_buf{};
+				bud::graphics::BufferHandle vis_buf{};
+				bud::graphics::BufferHandle stat_buf{};
+				bud::graphics::BufferHandle inst_buf{};
+				Texture* hiz_tex = nullptr;
+				try {
+					draw_buf = render_graph.get_buffer(draw_buffer);
+					ind_buf = render_graph.get_buffer(meshlet_indirect_buffer);
+					vis_buf = render_graph.get_buffer(meshlet_visible_buffer);
+					stat_buf = render_graph.get_buffer(stats_buffer);
+					inst_buf = render_graph.get_buffer(instance_data);
+					hiz_tex = render_graph.get_texture(hiz_pyramid);
+				} catch (const std::exception& e) {
+					bud::eprint("[MeshletCullingPass] Resource lookup failed: {}", e.what());
+					return;
+				}
+
+				if (!draw_buf.is_valid() || !ind_buf.is_valid() || !vis_buf.is_valid() || !stat_buf.is_valid() || !inst_buf.is_valid() || !hiz_tex) {
+					std::string err = std::format("MeshletCullingPass missing resources: draw={} ind={} vis={} stat={} inst={} hiz={}",
+						draw_buf.is_valid(), ind_buf.is_valid(), vis_buf.is_valid(), stat_buf.is_valid(), inst_buf.is_valid(), (bool)hiz_tex);
+					bud::eprint("{}", err);
+#if defined(_DEBUG)
+					throw std::runtime_error(err);
+#else
+					return;
+#endif
+				}
+
+				const bool compact = use_indirect_count(rhi, config);
+				rhi->cmd_begin_gpu_timer(cmd, GPUTimer::MeshletCulling);
+
+				// Header: compacted draw count + empty task dispatch {0, 1, 1}
+				const uint32_t header[INDIRECT_COUNT_HEADER_SIZE / sizeof(uint32_t)] = { 0, 0, 1, 1 };
+				rhi->resource_barrier(cmd, ind_buf, ResourceState::UnorderedAccess, ResourceState::TransferDst);
+				rhi->cmd_copy_to_buffer(cmd, ind_buf, 0, INDIRECT_COUNT_HEADER_SIZE, header);
+				rhi->resource_barrier(cmd, ind_buf, ResourceState::TransferDst, ResourceState::UnorderedAccess);
+
+				const uint32_t zero_visible[4] = {};
+				rhi->resource_barrier(cmd, vis_buf, ResourceState::UnorderedAccess, ResourceState::TransferDst);
+				rhi->cmd_copy_to_buffer(cmd, vis_buf, 0, sizeof(zero_visible), zero_visible);
+				rhi->resource_barrier(cmd, vis_buf, ResourceState::TransferDst, ResourceState::UnorderedAccess);
+
+				rhi->cmd_bind_pipeline(cmd, pipeline);
+
+				rhi->cmd_bind_storage_buffer(cmd, pipeline, 0, draw_buf);
+				rhi->cmd_bind_storage_buffer(cmd, pipeline, 1, ind_buf);
+				rhi->cmd_bind_storage_buffer(cmd, pipeline, 2, stat_buf);
+				rhi->cmd_bind_compute_texture(cmd, pipeline, 3, hiz_tex, ALL_MIPS, false, true);
+				rhi->cmd_bind_compute_ubo(cmd, pipeline, 4);
+				rhi->cmd_bind_storage_buffer(cmd, pipeline, 6, meshlet_pool);
+				rhi->cmd_bind_storage_buffer(cmd, pipeline, 7, inst_buf);
+				rhi->cmd_bind_storage_buffer(cmd, pipeline, 8, vis_buf);
+				// Bound either way, the shader only reads it when lodErrorScale > 0
+				rhi->cmd_bind_storage_buffer(cmd, pipeline, 11, meshlet_lod_pool.is_valid() ? meshlet_lod_pool : meshlet_pool);
+
+				struct PushConsts {
+					uint32_t drawCount;
+					uint32_t compact;
+					uint32_t meshShaderPath;
+					uint32_t coneCulling;
+					uint32_t capacity;
+					float lodErrorScale;
+					float lodZNear;
+				} pc;
+				pc.drawCount = static_cast<uint32_t>(draw_count);
+				pc.compact = compact ? 1u : 0u;
+				pc.meshShaderPath = mesh_shader_path ? 1u : 0u;
+				pc.coneCulling = config.enable_meshlet_cone_culling ? 1u : 0u;
+				pc.capacity = record_capacity;
+				pc.lodErrorScale = cluster_lod ? lod_error_scale : 0.0f;
+				pc.lodZNear = std::max(lod_z_near, 1e-4f);
+
+				rhi->cmd_push_constants(cmd, pipeline, sizeof(PushConsts), &pc);
+
+				// One workgroup per draw, the shader strides over the rest past the dispatch limit
+				uint32_t group_x = std::min(static_cast<uint32_t>(draw_count), 65535u);
+				rhi->cmd_dispatch(cmd, group_x, 1, 1);
+				rhi->cmd_end_gpu_timer(cmd, GPUTimer::MeshletCulling);
+			}
+		);
+	}
+
+    void ShadowCullingPass::init(RHI* rhi, const RenderConfig& config, bud::io::AssetManager* asset_manager) {
+        if (!rhi || !asset_manager) {
+            std::string err = std::format("ShadowCullingPass::init invalid args: rhi={} asset_manager={}", (void*)rhi, (void*)asset_manager);
+            bud::eprint("{}", err);
+#if defined(_DEBUG)
+            throw std::runtime_error(err);
+#else
+            return;
+#endif
+        }
+
+		load_shaders_async(asset_manager, { "src/shaders/shadow_cull.comp.spv" }, [this, rhi](const auto& shaders) {
+			ComputePipelineDesc desc;
+			desc.cs.code = shaders[0];
+			pipeline = rhi->create_compute_pipeline(desc);
+			if (pipeline) {
+				bud::print("[ShadowCullingPass] Shader loaded and pipeline created.");
+			}
+		});
+	}
+
+	RGHandle ShadowCullingPass::add_to_graph(RenderGraph& render_graph, RGHandle shadow_draw_buffer, RGHandle shadow_indirect_buffer, RGHandle stats_buffer,
+		const RenderConfig& config, size_t draw_count, uint32_t region_capacity, uint32_t first_instance_base) {
+		if (!pipeline || draw_count == 0 || region_capacity == 0) {
+			return {};
+		}
+
+		const uint32_t cascade_count = std::min(config.cascade_count, MAX_CASCADES);
+		const bool skip_static = config.cache_shadows;
+
+		return render_graph.add_pass("Shadow Culling Pass",
+			[=](RGBuilder& builder) {
+				builder.set_side_effect();
+				builder.read(shadow_draw_buffer, ResourceState::ShaderResource);
+				builder.write(shadow_indirect_buffer, ResourceState::UnorderedAccess);
+				builder.write(stats_buffer, ResourceState::UnorderedAccess);
+				return shadow_indirect_buffer;
+			},
+			[=, &render_graph, this](RHI* rhi, CommandHandle cmd) {
+				if (!pipeline) return;
+
+				bud::graphics::BufferHandle draw_buf{};
+				bud::graphics::BufferHandle ind_buf{};
+				bud::graphics::BufferHandle stat_buf{};
+				try {
+					draw_buf = render_graph.get_buffer(shadow_draw_buffer);
+					ind_buf = render_graph.get_buffer(shadow_indirect_buffer);
+					stat_buf = render_graph.get_buffer(stats_buffer);
+				} catch (const std::exception& e) {
+					bud::eprint("[ShadowCullingPass] Resource lookup failed: {}", e.what());
+					return;
+				}
+
+				if (!draw_buf.is_valid() || !ind_buf.is_valid() || !stat_buf.is_valid()) {
+					std::string err = std::format("ShadowCullingPass missing resources: draw={} ind={} stat={}", draw_buf.is_valid(), ind_buf.is_valid(), stat_buf.is_valid());
+					bud::eprint("{}", err);
+#if defined(_DEBUG)
+					throw std::runtime_error(err);
+#else
+					return;
+#endif
+				}
+
+				rhi->cmd_begin_gpu_timer(cmd, GPUTimer::ShadowCulling);
+
+				// Reset per-cascade draw counts (header = MAX_CASCADES uints)
+				uint32_t zero_counts[INDIRECT_COUNT_HEADER_SIZE / sizeof(uint32_t)] = {};
+				static_assert(sizeof(zero_counts) >= MAX_CASCADES * sizeof(uint32_t), "indirect header too small for cascade counts");
+				rhi->resource_barrier(cmd, ind_buf, ResourceState::UnorderedAccess, ResourceState::TransferDst);
+				rhi->cmd_copy_to_buffer(cmd, ind_buf, 0, INDIRECT_COUNT_HEADER_SIZE, zero_counts);
+				rhi->resource_barrier(cmd, ind_buf, ResourceState::TransferDst, ResourceState::UnorderedAccess);
+
+				rhi->cmd_bind_pipeline(cmd, pipeline);
+				rhi->cmd_bind_storage_buffer(cmd, pipeline, 0, draw_buf);
+				rhi->cmd_bind_storage_buffer(cmd, pipeline, 1, ind_buf);
+				rhi->cmd_bind_storage_buffer(cmd, pipeline, 2, stat_buf);
+				rhi->cmd_bind_compute_ubo(cmd, pipeline, 4);
+
+				struct PushConsts {
+					uint32_t drawCount;
+					uint32_t cascadeCount;
+					uint32_t regionCapacity;
+					uint32_t firstInstanceBase;
+					uint32_t skipStatic;
+				} pc;
+				pc.drawCount = static_cast<uint32_t>(draw_count);
+				pc.cascadeCount = cascade_count;
+				pc.regionCapacity = region_capacity;
+				pc.firstInstanceBase = first_instance_base;
+				pc.skipStatic = skip_static ? 1u : 0u;
+
+				rhi->cmd_push_constants(cmd, pipeline, sizeof(PushConsts), &pc);
+
+				// X: 64 draws per group, Y: one row of groups per cascade
+				uint32_t group_x = (static_cast<uint32_t>(draw_count) + 63) / 64;
+				rhi->cmd_dispatch(cmd, group_x, cascade_count, 1);
+				rhi->cmd_end_gpu_timer(cmd, GPUTimer::ShadowCulling);
 			}
 		);
 	}
@@ -200,7 +496,7 @@ namespace bud::graphics {
 		});
 	}
 
-	RGHandle HiZMipPass::add_to_graph(RenderGraph& rg, RGHandle depth_buffer, const RenderConfig& config) {
+	RGHandle HiZMipPass::add_to_graph(RenderGraph& rg, RGHandle depth_buffer, const RenderConfig& config, float render_scale) {
 		if (!pipeline) return {};
 		
 			auto depth_desc = rg.get_texture_desc(depth_buffer);
@@ -258,10 +554,13 @@ namespace bud::graphics {
 					struct Push { 
 						bud::math::vec2 out_size;
 						uint32_t reversed_z;
-						uint32_t padding;
+						float uv_scale;
 					} push;
 					push.out_size = bud::math::vec2((float)dst_size, (float)dst_size);
 					push.reversed_z = config.reversed_z ? 1 : 0;
+					// Mip 0 stretches the rendered sub-rect of the depth buffer over the whole pyramid,
+					// so the culling shaders keep sampling with full-screen UVs
+					push.uv_scale = (i == 0) ? render_scale : 1.0f;
 					rhi->cmd_push_constants(cmd, pipeline, sizeof(push), &push);
 
 					uint32_t gx = (dst_size + 15) / 16;
@@ -353,6 +652,32 @@ namespace bud::graphics {
 				bud::print("[ZPrepass] Shaders loaded and pipeline created.");
 			}
 		});
+
+		load_shaders_async(asset_manager, { "src/shaders/zprepass_opaque.vert.spv", "src/shaders/depth_only.frag.spv" }, [this, rhi, config](const auto& shaders) {
+			GraphicsPipelineDesc desc;
+			desc.vs.code = shaders[0];
+			desc.fs.code = shaders[1];
+			desc.depth_test = true;
+			desc.depth_write = true;
+			desc.cull_mode = CullMode::None;
+			desc.color_attachment_format = bud::graphics::TextureFormat::Undefined;
+			desc.depth_compare_op = config.reversed_z ? CompareOp::Greater : CompareOp::Less;
+			desc.enable_depth_bias = false;
+			desc.vertex_layout = VertexLayoutType::PositionOnly;
+
+			opaque_pipeline = rhi->create_graphics_pipeline(desc);
+			if (opaque_pipeline) {
+				bud::print("[ZPrepass] Position-only pipeline created.");
+			}
+		});
+	}
+
+	void ZPrepass::shutdown(RHI* rhi) {
+		RenderPass::shutdown(rhi);
+		if (opaque_pipeline && rhi) {
+			rhi->destroy_pipeline(opaque_pipeline);
+			opaque_pipeline = nullptr;
+		}
 	}
 
 	RGHandle ZPrepass::add_to_graph(RenderGraph& render_graph, RGHandle backbuffer,
@@ -362,8 +687,9 @@ namespace bud::graphics {
 		const std::vector<RenderMesh>& meshes,
 		const std::vector<SortItem>& sort_list,
 		size_t instance_count,
-		bud::graphics::BufferHandle mega_vertex_buffer,
-		bud::graphics::BufferHandle mega_index_buffer) {
+		const VertexStreams& vertex_streams,
+		bud::graphics::BufferHandle mega_index_buffer,
+		const std::vector<uint8_t>& alpha_tested_materials) {
         if (!pipeline) {
             std::string err = "ZPrepass::add_to_graph pipeline is null";
             bud::eprint("{}", err);
@@ -416,12 +742,13 @@ namespace bud::graphics {
 		// max_scene_count guards accessing render_scene arrays, but entity_index in
 		// sort_list items are already validated — do NOT clamp draw_count by it.
 		const size_t draw_count = std::min(instance_count, sort_list.size());
-		uint32_t target_width = backbuffer_tex->width;
-		uint32_t target_height = backbuffer_tex->height;
+		// Depth is allocated at the output size, only the scaled viewport is rasterized
+		uint32_t target_width = scaled_extent(backbuffer_tex->width, view.render_scale);
+		uint32_t target_height = scaled_extent(backbuffer_tex->height, view.render_scale);
 
 		TextureDesc depth_desc;
-		depth_desc.width = target_width;
-		depth_desc.height = target_height;
+		depth_desc.width = backbuffer_tex->width;
+		depth_desc.height = backbuffer_tex->height;
 		depth_desc.format = bud::graphics::TextureFormat::D32_FLOAT;
 
 		auto depth_h = std::make_shared<RGHandle>();
@@ -432,7 +759,7 @@ namespace bud::graphics {
 				builder.write(*depth_h, ResourceState::DepthWrite);
 				return *depth_h;
 			},
-			[=, &render_graph, &render_scene, &meshes, &sort_list, this](RHI* rhi, CommandHandle cmd) {
+			[=, &render_graph, &render_scene, &meshes, &sort_list, &alpha_tested_materials, this](RHI* rhi, CommandHandle cmd) {
 				if (!pipeline) {
 					bud::eprint("[ZPrepass] ERROR: Pipeline is null.");
 					return;
@@ -444,18 +771,19 @@ namespace bud::graphics {
 				info.clear_depth = true;
 				info.clear_depth_value = config.reversed_z ? 0.0f : 1.0f;
 
+				rhi->cmd_begin_gpu_timer(cmd, GPUTimer::ZPrepass);
 				rhi->cmd_begin_render_pass(cmd, info);
-				rhi->cmd_bind_pipeline(cmd, pipeline);
 				rhi->cmd_set_viewport(cmd, (float)target_width, (float)target_height);
 				rhi->cmd_set_scissor(cmd, target_width, target_height);
 
 				rhi->update_global_uniforms(rhi->get_current_image_index(), view);
-				rhi->cmd_bind_descriptor_set(cmd, pipeline, 0);
 
 				// Bind global Mega-Buffer once for the entire pass
-				rhi->cmd_bind_vertex_buffer(cmd, mega_vertex_buffer);
+				bind_vertex_streams(rhi, cmd, vertex_streams);
 				rhi->cmd_bind_index_buffer(cmd, mega_index_buffer);
 
+				DepthDrawSelector selector{ rhi, cmd, pipeline, opaque_pipeline, alpha_tested_materials };
+
 				for (size_t i = 0; i < draw_count; ++i) {
 					const auto& item = sort_list[i];
 					uint32_t idx = item.entity_index;
@@ -479,16 +807,20 @@ namespace bud::graphics {
 					if (item.submesh_index != UINT32_MAX && item.submesh_index < mesh.submeshes.size()) {
 						const auto& sub = mesh.submeshes[item.submesh_index];
 						push_vars.material_id = sub.material_id;
-						rhi->cmd_push_constants(cmd, pipeline, sizeof(PushVars), &push_vars);
+						void* draw_pipeline = selector.select(sub.material_id, sub.index_count);
+						rhi->cmd_push_constants(cmd, draw_pipeline, sizeof(PushVars), &push_vars);
 						rhi->cmd_draw_indexed(cmd, sub.index_count, 1, mesh.first_index + sub.index_start, mesh.vertex_offset, 0);
 					} else {
 						push_vars.material_id = material_id;
-						rhi->cmd_push_constants(cmd, pipeline, sizeof(PushVars), &push_vars);
+						void* draw_pipeline = selector.select(material_id, mesh.index_count);
+						rhi->cmd_push_constants(cmd, draw_pipeline, sizeof(PushVars), &push_vars);
 						rhi->cmd_draw_indexed(cmd, mesh.index_count, 1, mesh.first_index, mesh.vertex_offset, 0);
 					}
 				}
 
 				rhi->cmd_end_render_pass(cmd);
+				rhi->cmd_end_gpu_timer(cmd, GPUTimer::ZPrepass);
+				selector.flush(VertexFetchPass::ZPrepass);
 			}
 		);
 	}
@@ -498,6 +830,14 @@ namespace bud::graphics {
 
 	void CSMShadowPass::shutdown(RHI* rhi) {
 		RenderPass::shutdown(rhi);
+		if (indirect_pipeline && rhi) {
+			rhi->destroy_pipeline(indirect_pipeline);
+			indirect_pipeline = nullptr;
+		}
+		if (opaque_pipeline && rhi) {
+			rhi->destroy_pipeline(opaque_pipeline);
+			opaque_pipeline = nullptr;
+		}
 		if (rhi) {
 			auto* pool = rhi->get_resource_pool();
 			if (pool && static_cache_texture) {
@@ -538,14 +878,51 @@ namespace bud::graphics {
 				bud::print("[CSMShadowPass] Shaders loaded and pipeline created: {}", (void*)pipeline);
 			}
 		});
+
+		load_shaders_async(asset_manager, { "src/shaders/shadow_opaque.vert.spv", "src/shaders/depth_only.frag.spv" }, [this, rhi, config](const auto& shaders) {
+			GraphicsPipelineDesc desc;
+			desc.vs.code = shaders[0];
+			desc.fs.code = shaders[1];
+			desc.cull_mode = CullMode::Back;
+			desc.color_attachment_format = TextureFormat::Undefined;
+			desc.depth_compare_op = config.reversed_z ? CompareOp::Greater : CompareOp::Less;
+			desc.enable_depth_bias = true;
+			desc.vertex_layout = VertexLayoutType::PositionOnly;
+
+			opaque_pipeline = rhi->create_graphics_pipeline(desc);
+			if (opaque_pipeline) {
+				bud::print("[CSMShadowPass] Position-only shadow pipeline created: {}", (void*)opaque_pipeline);
+			}
+		});
+
+		if (!rhi->supports_draw_indirect_count()) return;
+
+		load_shaders_async(asset_manager, { "src/shaders/shadow_indirect.vert.spv", "src/shaders/shadow_indirect.frag.spv" }, [this, rhi, config](const auto& shaders) {
+			GraphicsPipelineDesc desc;
+			desc.vs.code = shaders[0];
+			desc.fs.code = shaders[1];
+			desc.cull_mode = CullMode::Back;
+			desc.color_attachment_format = TextureFormat::Undefined;
+			desc.depth_compare_op = config.reversed_z ? CompareOp::Greater : CompareOp::Less;
+			desc.enable_depth_bias = true;
+			desc.vertex_layout = VertexLayoutType::PositionUV;
+
+			indirect_pipeline = rhi->create_graphics_pipeline(desc);
+			if (indirect_pipeline) {
+				bud::print("[CSMShadowPass] Indirect-count shadow pipeline created: {}", (void*)indirect_pipeline);
+			}
+		});
 	}
 
 	RGHandle CSMShadowPass::add_to_graph(RenderGraph& render_graph, const SceneView& view, const RenderConfig& config,
 		const RenderScene& render_scene,
 		const std::vector<RenderMesh>& meshes,
 		std::vector<std::vector<uint32_t>> csm_visible_instances,
-		bud::graphics::BufferHandle mega_vertex_buffer,
-		bud::graphics::BufferHandle mega_index_buffer)
+		const VertexStreams& vertex_streams,
+		bud::graphics::BufferHandle mega_index_buffer,
+		const std::vector<uint8_t>& alpha_tested_materials,
+		RGHandle shadow_indirect_buffer,
+		uint32_t shadow_region_capacity)
 	{
 		if (config.shadow_map_size == 0 || config.cascade_count == 0) {
 			bud::eprint("[CSMShadowPass] ERROR: Invalid shadow config (size={}, cascades={}).",
@@ -631,9 +1008,11 @@ namespace bud::graphics {
                                 builder.write(static_cache_h, ResourceState::DepthWrite);
                                 return static_cache_h;
                             },
-                            [=, csm_vis = csm_visible_instances, &render_graph, &render_scene, &meshes, &view](RHI* rhi, CommandHandle cmd) {
+                            [=, csm_vis = csm_visible_instances, &render_graph, &render_scene, &meshes, &view, &alpha_tested_materials](RHI* rhi, CommandHandle cmd) {
                                 if (!pipeline) return;
 
+                                DepthDrawSelector selector{ rhi, cmd, pipeline, opaque_pipeline, alpha_tested_materials };
+
                                 for (uint32_t i = 0; i < cascade_count; ++i) {
                                     auto cascade_light_view_proj = view.cascade_view_proj_matrices[i];
                                     bud::math::Frustum cascade_view_frustum_dbg;
@@ -654,20 +1033,15 @@ namespace bud::graphics {
                                     info.layer_count = 1;
 
                                     rhi->cmd_begin_render_pass(cmd, info);
-							rhi->cmd_bind_pipeline(cmd, pipeline);
+							selector.invalidate();
 							rhi->cmd_set_viewport(cmd, (float)config.shadow_map_size, (float)config.shadow_map_size);
 							rhi->cmd_set_scissor(cmd, config.shadow_map_size, config.shadow_map_size);
 
 							rhi->cmd_set_depth_bias(cmd, config.shadow_bias_constant, 0.0f, config.shadow_bias_slope);
-							rhi->cmd_bind_descriptor_set(cmd, pipeline, 0);
 
 							// Bind global Mega-Buffer once per cascade
-							// NOTE: For diagnostics we support an alternative binding scheme where we bind
-							// the vertex buffer with a byte-offset per-mesh and issue draw calls with
-							// vertexOffset=0. This helps detect whether vertexOffset is being
-							// interpreted in vertices vs bytes by the driver/pipeline.
+							bind_vertex_streams(rhi, cmd, vertex_streams);
 							rhi->cmd_bind_index_buffer(cmd, mega_index_buffer);
-							static constexpr bool kUseBindVertexByteOffset = true; // A/B test toggle
 
 							struct PushConsts {
 								bud::math::mat4 light_view_proj;
@@ -711,32 +1085,29 @@ namespace bud::graphics {
 								if (sub_idx != bud::asset::INVALID_INDEX && sub_idx < mesh.submeshes.size()) {
 									const auto& sub = mesh.submeshes[sub_idx];
 									push_consts.material_id = sub.material_id;
-									rhi->cmd_push_constants(cmd, pipeline, sizeof(PushConsts), &push_consts);
+									void* draw_pipeline = selector.select(sub.material_id, sub.index_count);
+									rhi->cmd_push_constants(cmd, draw_pipeline, sizeof(PushConsts), &push_consts);
 									rhi->cmd_draw_indexed(cmd, sub.index_count, 1, mesh.first_index + sub.index_start, mesh.vertex_offset, 0);
 								}
 								else {
 									push_consts.material_id = render_scene.material_indices[idx];
-									rhi->cmd_push_constants(cmd, pipeline, sizeof(PushConsts), &push_consts);
-									if (kUseBindVertexByteOffset) {
-										auto vb = mega_vertex_buffer;
-										vb.offset = static_cast<uint64_t>(mesh.vertex_offset) * sizeof(bud::io::MeshData::Vertex);
-										rhi->cmd_bind_vertex_buffer(cmd, vb);
-										rhi->cmd_draw_indexed(cmd, mesh.index_count, 1, mesh.first_index, 0, 0);
-									}
-									else {
-										rhi->cmd_bind_vertex_buffer(cmd, mega_vertex_buffer);
-										rhi->cmd_draw_indexed(cmd, mesh.index_count, 1, mesh.first_index, mesh.vertex_offset, 0);
-									}
+									void* draw_pipeline = selector.select(push_consts.material_id, mesh.index_count);
+									rhi->cmd_push_constants(cmd, draw_pipeline, sizeof(PushConsts), &push_consts);
+									rhi->cmd_draw_indexed(cmd, mesh.index_count, 1, mesh.first_index, mesh.vertex_offset, 0);
 								}
 							}
 							rhi->cmd_end_render_pass(cmd);
 						}
+						selector.flush(VertexFetchPass::ShadowStatic);
 					}
 				);
 				cache_initialized = true;
 			}
 		}
 
+		// GPU-compacted cascade lists (ShadowCullingPass): one indirect-count draw per cascade
+		const bool use_gpu_lists = shadow_indirect_buffer.is_valid() && shadow_region_capacity > 0 && indirect_pipeline != nullptr;
+
 		// Main Shadow Pass (Dynamic + Copy) TODO: dynamic shadows cover everything
 		return render_graph.add_pass("CSM Shadow",
 			[&, shadow_map_h](RGBuilder& builder) {
@@ -744,14 +1115,17 @@ namespace bud::graphics {
 				builder.write(*shadow_map_h, ResourceState::DepthWrite);
 				if (valid_cache)
 					builder.read(static_cache_h, ResourceState::DepthRead);
+				if (use_gpu_lists)
+					builder.read(shadow_indirect_buffer, ResourceState::IndirectArgument);
 
 				return *shadow_map_h;
 			},
-			[=, csm_vis = std::move(csm_visible_instances), &render_graph, &render_scene, &meshes, &view](RHI* rhi, CommandHandle cmd) {
+			[=, csm_vis = std::move(csm_visible_instances), &render_graph, &render_scene, &meshes, &view, &alpha_tested_materials](RHI* rhi, CommandHandle cmd) {
 				if (!pipeline) return;
 
 				auto active_map = render_graph.get_texture(*shadow_map_h);
 				bool did_copy = false;
+				rhi->cmd_begin_gpu_timer(cmd, GPUTimer::ShadowDraw);
 
                 if (valid_cache && cache_initialized) {
                     Texture* static_map = nullptr;
@@ -771,6 +1145,49 @@ namespace bud::graphics {
                     }
                 }
 
+				if (use_gpu_lists) {
+					auto ind_buf = render_graph.get_buffer(shadow_indirect_buffer);
+
+					struct PushConsts {
+						bud::math::mat4 light_view_proj;
+						bud::math::mat4 model;
+						bud::math::vec4 light_dir;
+						uint32_t material_id;
+						uint32_t padding[3];
+					} push_consts{};
+					push_consts.model = bud::math::mat4(1.0f);
+					push_consts.light_dir = bud::math::vec4(bud::math::normalize(view.light_dir), 0.0f);
+
+					for (uint32_t i = 0; i < cascade_count; ++i) {
+						RenderPassBeginInfo info;
+						info.depth_attachment = active_map;
+						info.clear_depth = !did_copy;
+						info.clear_depth_value = config.reversed_z ? 0.0f : 1.0f;
+						info.base_array_layer = i;
+						info.layer_count = 1;
+
+						rhi->cmd_begin_render_pass(cmd, info);
+						rhi->cmd_bind_pipeline(cmd, indirect_pipeline);
+						rhi->cmd_set_viewport(cmd, (float)config.shadow_map_size, (float)config.shadow_map_size);
+						rhi->cmd_set_scissor(cmd, config.shadow_map_size, config.shadow_map_size);
+						rhi->cmd_set_depth_bias(cmd, config.shadow_bias_constant, 0.0f, config.shadow_bias_slope);
+						rhi->cmd_bind_descriptor_set(cmd, indirect_pipeline, 0);
+						bind_vertex_streams(rhi, cmd, vertex_streams);
+						rhi->cmd_bind_index_buffer(cmd, mega_index_buffer);
+
+						push_consts.light_view_proj = view.cascade_view_proj_matrices[i];
+						rhi->cmd_push_constants(cmd, indirect_pipeline, sizeof(PushConsts), &push_consts);
+
+						const uint64_t region_offset = INDIRECT_COUNT_HEADER_SIZE + static_cast<uint64_t>(i) * shadow_region_capacity * sizeof(IndirectCommand);
+						rhi->cmd_draw_indexed_indirect_count(cmd, ind_buf, region_offset, ind_buf, i * sizeof(uint32_t), shadow_region_capacity, sizeof(IndirectCommand));
+						rhi->cmd_end_render_pass(cmd);
+					}
+					rhi->cmd_end_gpu_timer(cmd, GPUTimer::ShadowDraw);
+					return;
+				}
+
+				DepthDrawSelector selector{ rhi, cmd, pipeline, opaque_pipeline, alpha_tested_materials };
+
 				for (uint32_t i = 0; i < config.cascade_count; ++i) {
 					auto cascade_light_view_proj = view.cascade_view_proj_matrices[i];
 					bud::math::Frustum cascade_view_frustum_dbg;
@@ -784,16 +1201,15 @@ namespace bud::graphics {
 					info.layer_count = 1;
 
 					rhi->cmd_begin_render_pass(cmd, info);
-					rhi->cmd_bind_pipeline(cmd, pipeline);
+					selector.invalidate();
 					rhi->cmd_set_viewport(cmd, (float)config.shadow_map_size, (float)config.shadow_map_size);
 					rhi->cmd_set_scissor(cmd, config.shadow_map_size, config.shadow_map_size);
 
 					rhi->cmd_set_depth_bias(cmd, config.shadow_bias_constant, 0.0f, config.shadow_bias_slope);
-					rhi->cmd_bind_descriptor_set(cmd, pipeline, 0);
 
 					// Bind global Mega-Buffer once per cascade
-					rhi->cmd_bind_vertex_buffer(cmd, mega_vertex_buffer);
-				rhi->cmd_bind_index_buffer(cmd, mega_index_buffer);
+					bind_vertex_streams(rhi, cmd, vertex_streams);
+					rhi->cmd_bind_index_buffer(cmd, mega_index_buffer);
 
 					struct PushConsts {
 						bud::math::mat4 light_view_proj;
@@ -833,17 +1249,21 @@ namespace bud::graphics {
 						if (sub_idx != bud::asset::INVALID_INDEX && sub_idx < mesh.submeshes.size()) {
 							const auto& sub = mesh.submeshes[sub_idx];
 							push_consts.material_id = sub.material_id;
-							rhi->cmd_push_constants(cmd, pipeline, sizeof(PushConsts), &push_consts);
+							void* draw_pipeline = selector.select(sub.material_id, sub.index_count);
+							rhi->cmd_push_constants(cmd, draw_pipeline, sizeof(PushConsts), &push_consts);
 							rhi->cmd_draw_indexed(cmd, sub.index_count, 1, mesh.first_index + sub.index_start, mesh.vertex_offset, 0);
 						}
 						else {
 							push_consts.material_id = render_scene.material_indices[idx];
-							rhi->cmd_push_constants(cmd, pipeline, sizeof(PushConsts), &push_consts);
+							void* draw_pipeline = selector.select(push_consts.material_id, mesh.index_count);
+							rhi->cmd_push_constants(cmd, draw_pipeline, sizeof(PushConsts), &push_consts);
 							rhi->cmd_draw_indexed(cmd, mesh.index_count, 1, mesh.first_index, mesh.vertex_offset, 0);
 						}
 					}
 					rhi->cmd_end_render_pass(cmd);
 				}
+				selector.flush(VertexFetchPass::Shadow);
+				rhi->cmd_end_gpu_timer(cmd, GPUTimer::ShadowDraw);
 			}
 		);
 	}
@@ -868,6 +1288,35 @@ namespace bud::graphics {
 				bud::print("[MainPass] Shaders loaded and pipeline created.");
 			}
 		});
+
+		if (!rhi->supports_mesh_shaders())
+			return;
+
+		load_shaders_async(asset_manager, { "src/shaders/meshlet.task.spv", "src/shaders/meshlet.mesh.spv", "src/shaders/main.frag.spv" }, [this, rhi, config](const auto& shaders) {
+			GraphicsPipelineDesc desc;
+			desc.ts.code = shaders[0];
+			desc.ms.code = shaders[1];
+			desc.fs.code = shaders[2];
+			desc.depth_test = true;
+			desc.depth_write = true;
+			desc.cull_mode = CullMode::None;
+			desc.color_attachment_format = bud::graphics::TextureFormat::BGRA8_SRGB;
+			desc.depth_compare_op = config.reversed_z ? CompareOp::GreaterEqual : CompareOp::LessEqual;
+			desc.enable_depth_bias = false;
+
+			mesh_pipeline = rhi->create_graphics_pipeline(desc);
+			if (mesh_pipeline) {
+				bud::print("[MainPass] Mesh shader pipeline created.");
+			}
+		});
+	}
+
+	void MainPass::shutdown(RHI* rhi) {
+		RenderPass::shutdown(rhi);
+		if (mesh_pipeline && rhi) {
+			rhi->destroy_pipeline(mesh_pipeline);
+			mesh_pipeline = nullptr;
+		}
 	}
 
 	void MainPass::add_to_graph(RenderGraph& render_graph, RGHandle shadow_map, RGHandle backbuffer, RGHandle depth_buffer,
@@ -879,8 +1328,11 @@ namespace bud::graphics {
 		size_t instance_count,
 		RGHandle indirect_draw_buffer,
 		RGHandle instance_data,
-		bud::graphics::BufferHandle mega_vertex_buffer,
-		bud::graphics::BufferHandle mega_index_buffer)
+		const VertexStreams& vertex_streams,
+		bud::graphics::BufferHandle mega_index_buffer,
+		const MeshletDrawInputs& meshlet_inputs,
+		RGHandle light_cluster_grid,
+		const std::vector<uint32_t>* draw_slots)
 	{
 		const size_t max_scene_count = std::min({
 			render_scene.world_matrices.size(),
@@ -905,8 +1357,12 @@ namespace bud::graphics {
 		// sort_list items are already validated — do NOT clamp draw_count by it.
 		const size_t draw_count = std::min(instance_count, sort_list.size());
 
-		uint32_t target_width = backbuffer_tex->width;
-		uint32_t target_height = backbuffer_tex->height;
+		uint32_t target_width = scaled_extent(backbuffer_tex->width, view.render_scale);
+		uint32_t target_height = scaled_extent(backbuffer_tex->height, view.render_scale);
+
+		const bool use_meshlets = config.enable_gpu_driven && meshlet_inputs.draw_buffer.is_valid() && meshlet_inputs.record_capacity > 0;
+		const bool use_mesh_path = use_meshlets && meshlet_inputs.mesh_shader_path && meshlet_inputs.visible_buffer.is_valid() && mesh_pipeline != nullptr;
+		const uint32_t meshlet_capacity = meshlet_inputs.record_capacity;
 
 		render_graph.add_pass("Main Lighting Pass",
 			[=](RGBuilder& builder) {
@@ -914,7 +1370,13 @@ namespace bud::graphics {
 				builder.read(shadow_map, ResourceState::DepthRead);
 				builder.write(depth_buffer, ResourceState::DepthWrite);
 				if (config.enable_gpu_driven) {
-					builder.read(indirect_draw_buffer, ResourceState::IndirectArgument);
+					builder.read(use_meshlets ? meshlet_inputs.draw_buffer : indirect_draw_buffer, ResourceState::IndirectArgument);
+				}
+				if (use_mesh_path) {
+					builder.read(meshlet_inputs.visible_buffer, ResourceState::ShaderResource);
+				}
+				if (light_cluster_grid.is_valid()) {
+					builder.read(light_cluster_grid, ResourceState::ShaderResource);
 				}
 				builder.read(instance_data, ResourceState::ShaderResource);
 				return depth_buffer;
@@ -928,9 +1390,11 @@ namespace bud::graphics {
 
 				bud::graphics::BufferHandle ind_buf_handle;
 				if (config.enable_gpu_driven) {
-					ind_buf_handle = render_graph.get_buffer(indirect_draw_buffer);
+					ind_buf_handle = render_graph.get_buffer(use_meshlets ? meshlet_inputs.draw_buffer : indirect_draw_buffer);
 				}
 
+				rhi->cmd_begin_gpu_timer(cmd, GPUTimer::MainView);
+
 				RenderPassBeginInfo info;
 				info.color_attachments.push_back(render_graph.get_texture(backbuffer));
 				info.depth_attachment = render_graph.get_texture(depth_buffer);
@@ -950,11 +1414,31 @@ namespace bud::graphics {
 				rhi->cmd_bind_descriptor_set(cmd, pipeline, 0);
 
 				// Bind global Mega-Buffer once for the entire pass
-				rhi->cmd_bind_vertex_buffer(cmd, mega_vertex_buffer);
+				bind_vertex_streams(rhi, cmd, vertex_streams);
 				rhi->cmd_bind_index_buffer(cmd, mega_index_buffer);
 
-				if (config.enable_gpu_driven) {
-					rhi->cmd_draw_indexed_indirect(cmd, ind_buf_handle, 0, (uint32_t)draw_count, sizeof(IndirectCommand));
+				if (use_meshlets) {
+					// Records are per visible meshlet (or per meshlet-less draw), capacity bounds the list
+					if (use_indirect_count(rhi, config)) {
+						rhi->cmd_draw_indexed_indirect_count(cmd, ind_buf_handle, INDIRECT_COUNT_HEADER_SIZE, ind_buf_handle, 0, meshlet_capacity, sizeof(IndirectCommand));
+					} else {
+						rhi->cmd_draw_indexed_indirect(cmd, ind_buf_handle, INDIRECT_COUNT_HEADER_SIZE, meshlet_capacity, sizeof(IndirectCommand));
+					}
+
+					if (use_mesh_path) {
+						// Meshlets were culled into the visible list, the task shader only expands it
+						rhi->cmd_bind_pipeline(cmd, mesh_pipeline);
+						rhi->cmd_bind_descriptor_set(cmd, mesh_pipeline, 0);
+						rhi->cmd_push_constants(cmd, mesh_pipeline, sizeof(uint32_t), &meshlet_capacity);
+						rhi->cmd_draw_mesh_tasks_indirect(cmd, ind_buf_handle, MESH_TASKS_COMMAND_OFFSET, 1, 3 * sizeof(uint32_t));
+					}
+				}
+				else if (config.enable_gpu_driven) {
+					if (use_indirect_count(rhi, config)) {
+						rhi->cmd_draw_indexed_indirect_count(cmd, ind_buf_handle, INDIRECT_COUNT_HEADER_SIZE, ind_buf_handle, 0, (uint32_t)draw_count, sizeof(IndirectCommand));
+					} else {
+						rhi->cmd_draw_indexed_indirect(cmd, ind_buf_handle, INDIRECT_COUNT_HEADER_SIZE, (uint32_t)draw_count, sizeof(IndirectCommand));
+					}
 				}
 				else {
 					for (size_t i = 0; i < draw_count; ++i) {
@@ -967,17 +1451,531 @@ namespace bud::graphics {
 						const auto& mesh = meshes[mesh_id];
 						if (!mesh.is_valid()) continue;
 
+						const uint32_t slot = draw_slots ? (*draw_slots)[i] : (uint32_t)i;
 						if (item.submesh_index != UINT32_MAX && item.submesh_index < mesh.submeshes.size()) {
 							const auto& sub = mesh.submeshes[item.submesh_index];
-							rhi->cmd_draw_indexed(cmd, sub.index_count, 1, mesh.first_index + sub.index_start, mesh.vertex_offset, (uint32_t)i);
+							rhi->cmd_draw_indexed(cmd, sub.index_count, 1, mesh.first_index + sub.index_start, mesh.vertex_offset, slot);
 						}
 						else {
-							rhi->cmd_draw_indexed(cmd, mesh.index_count, 1, mesh.first_index, mesh.vertex_offset, (uint32_t)i);
+							rhi->cmd_draw_indexed(cmd, mesh.index_count, 1, mesh.first_index, mesh.vertex_offset, slot);
 						}
 					}
 				}
 
 				rhi->cmd_end_render_pass(cmd);
+				rhi->cmd_end_gpu_timer(cmd, GPUTimer::MainView);
+			}
+		);
+	}
+
+	namespace {
+		// Mesh LOD batches of a foliage draw list, push(material_id) runs before every submesh draw. Returns the draw count.
+		template <typename PushMaterial>
+		uint32_t draw_foliage_mesh_batches(RHI* rhi, CommandHandle cmd, const std::vector<RenderMesh>& meshes, const FoliageSystem& foliage,
+			const FoliageDrawList& draws, uint32_t first_instance, PushMaterial&& push) {
+			uint32_t draw_count = 0;
+			for (const auto& batch : draws.batches) {
+				if (batch.lod == FOLIAGE_IMPOSTOR_LOD) continue;
+
+				const auto& type = foliage.get_type(batch.type);
+				const uint32_t mesh_id = type.lod_meshes[batch.lod];
+				if (mesh_id >= meshes.size() || !meshes[mesh_id].is_valid()) continue;
+				const auto& mesh = meshes[mesh_id];
+
+				// Bark and leaves are separate submeshes with their own material, every one is drawn for the whole batch
+				if (mesh.submeshes.empty()) {
+					push(0u);
+					rhi->cmd_draw_indexed(cmd, mesh.index_count, batch.count, mesh.first_index, mesh.vertex_offset, first_instance + batch.first);
+					draw_count++;
+					continue;
+				}
+				for (const auto& sub : mesh.submeshes) {
+					push(sub.material_id);
+					rhi->cmd_draw_indexed(cmd, sub.index_count, batch.count, mesh.first_index + sub.index_start, mesh.vertex_offset, first_instance + batch.first);
+					draw_count++;
+				}
+			}
+			return draw_count;
+		}
+	}
+
+	void FoliagePass::init(RHI* rhi, const RenderConfig& config, bud::io::AssetManager* asset_manager) {
+		if (!rhi || !asset_manager) return;
+
+		load_shaders_async(asset_manager, { "src/shaders/foliage.vert.spv", "src/shaders/main.frag.spv" }, [this, rhi, config](const auto& shaders) {
+			GraphicsPipelineDesc desc;
+			desc.vs.code = shaders[0];
+			desc.fs.code = shaders[1];
+			desc.depth_test = true;
+			desc.depth_write = true; // Nothing after the forward pass reads the prepass depth
+			desc.cull_mode = CullMode::None;
+			desc.color_attachment_format = bud::graphics::TextureFormat::BGRA8_SRGB;
+			desc.depth_compare_op = config.reversed_z ? CompareOp::GreaterEqual : CompareOp::LessEqual;
+			desc.enable_depth_bias = false;
+			desc.vertex_layout = VertexLayoutType::Instanced;
+
+			pipeline = rhi->create_graphics_pipeline(desc);
+			if (pipeline) {
+				bud::print("[FoliagePass] Instanced mesh pipeline created.");
+			}
+		});
+
+		load_shaders_async(asset_manager, { "src/shaders/impostor.vert.spv", "src/shaders/impostor.frag.spv" }, [this, rhi, config](const auto& shaders) {
+			GraphicsPipelineDesc desc;
+			desc.vs.code = shaders[0];
+			desc.fs.code = shaders[1];
+			desc.depth_test = true;
+			desc.depth_write = true;
+			desc.cull_mode = CullMode::None;
+			desc.color_attachment_format = bud::graphics::TextureFormat::BGRA8_SRGB;
+			desc.depth_compare_op = config.reversed_z ? CompareOp::GreaterEqual : CompareOp::LessEqual;
+			desc.enable_depth_bias = false;
+			desc.vertex_layout = VertexLayoutType::InstanceOnly;
+
+			impostor_pipeline = rhi->create_graphics_pipeline(desc);
+			if (impostor_pipeline) {
+				bud::print("[FoliagePass] Impostor pipeline created.");
+			}
+		});
+
+		load_shaders_async(asset_manager, { "src/shaders/foliage_shadow.vert.spv", "src/shaders/shadow.frag.spv" }, [this, rhi, config](const auto& shaders) {
+			GraphicsPipelineDesc desc;
+			desc.vs.code = shaders[0];
+			desc.fs.code = shaders[1];
+			desc.cull_mode = CullMode::None; // Leaf cards are single sided
+			desc.color_attachment_format = TextureFormat::Undefined;
+			desc.depth_compare_op = config.reversed_z ? CompareOp::Greater : CompareOp::Less;
+			desc.enable_depth_bias = true;
+			desc.vertex_layout = VertexLayoutType::InstancedPositionUV;
+
+			shadow_pipeline = rhi->create_graphics_pipeline(desc);
+			if (shadow_pipeline) {
+				bud::print("[FoliagePass] Instanced shadow pipeline created.");
+			}
+		});
+	}
+
+	void FoliagePass::shutdown(RHI* rhi) {
+		RenderPass::shutdown(rhi);
+		if (!rhi) return;
+		if (impostor_pipeline) {
+			rhi->destroy_pipeline(impostor_pipeline);
+			impostor_pipeline = nullptr;
+		}
+		if (shadow_pipeline) {
+			rhi->destroy_pipeline(shadow_pipeline);
+			shadow_pipeline = nullptr;
+		}
+	}
+
+	void FoliagePass::add_to_graph(RenderGraph& render_graph, RGHandle shadow_map, RGHandle backbuffer, RGHandle depth_buffer,
+		const SceneView& view,
+		const std::vector<RenderMesh>& meshes,
+		const FoliageSystem& foliage,
+		const FoliageDrawList& draws,
+		bud::graphics::BufferHandle instance_buffer,
+		uint32_t first_instance,
+		const VertexStreams& vertex_streams,
+		bud::graphics::BufferHandle mega_index_buffer,
+		RGHandle light_cluster_grid)
+	{
+		if (draws.batches.empty() || !instance_buffer.is_valid()) return;
+
+		const auto* backbuffer_tex = render_graph.get_texture(backbuffer);
+		if (!backbuffer_tex || backbuffer_tex->width == 0 || backbuffer_tex->height == 0) return;
+
+		const uint32_t target_width = scaled_extent(backbuffer_tex->width, view.render_scale);
+		const uint32_t target_height = scaled_extent(backbuffer_tex->height, view.render_scale);
+
+		render_graph.add_pass("Foliage",
+			[=](RGBuilder& builder) {
+				builder.write(backbuffer, ResourceState::RenderTarget);
+				builder.write(depth_buffer, ResourceState::DepthWrite);
+				builder.read(shadow_map, ResourceState::DepthRead);
+				if (light_cluster_grid.is_valid()) {
+					builder.read(light_cluster_grid, ResourceState::ShaderResource);
+				}
+				return depth_buffer;
+			},
+			[=, &render_graph, &meshes, &foliage, &draws, this](RHI* rhi, CommandHandle cmd) {
+				if (!pipeline) return;
+
+				RenderPassBeginInfo info;
+				info.color_attachments.push_back(render_graph.get_texture(backbuffer));
+				info.depth_attachment = render_graph.get_texture(depth_buffer);
+				info.clear_color = false;
+				info.clear_depth = false;
+
+				rhi->cmd_begin_render_pass(cmd, info);
+				rhi->cmd_bind_pipeline(cmd, pipeline);
+				rhi->cmd_set_viewport(cmd, (float)target_width, (float)target_height);
+				rhi->cmd_set_scissor(cmd, target_width, target_height);
+
+				rhi->update_global_shadow_map(render_graph.get_texture(shadow_map));
+				rhi->update_global_uniforms(rhi->get_current_image_index(), view);
+				rhi->cmd_bind_descriptor_set(cmd, pipeline, 0);
+
+				bind_vertex_streams(rhi, cmd, vertex_streams);
+				rhi->cmd_bind_vertex_buffer(cmd, instance_buffer, 2);
+				rhi->cmd_bind_index_buffer(cmd, mega_index_buffer);
+
+				uint32_t draw_count = draw_foliage_mesh_batches(rhi, cmd, meshes, foliage, draws, first_instance, [&](uint32_t material_id) {
+					rhi->cmd_push_constants(cmd, pipeline, sizeof(uint32_t), &material_id);
+				});
+
+				if (impostor_pipeline && draws.stats.impostor_instances > 0) {
+					rhi->cmd_bind_pipeline(cmd, impostor_pipeline);
+					rhi->cmd_bind_descriptor_set(cmd, impostor_pipeline, 0);
+
+					struct PushConsts {
+						uint32_t texture_id;
+						uint32_t frames;
+						uint32_t padding[2];
+						bud::math::vec4 card; // width, height, base
+					} push_consts{};
+
+					for (const auto& batch : draws.batches) {
+						if (batch.lod != FOLIAGE_IMPOSTOR_LOD) continue;
+						const auto& type = foliage.get_type(batch.type);
+						push_consts.texture_id = type.impostor_texture;
+						push_consts.frames = type.impostor_frames;
+						push_consts.card = bud::math::vec4(type.impostor_size.x, type.impostor_size.y, type.impostor_base, 0.0f);
+						rhi->cmd_push_constants(cmd, impostor_pipeline, sizeof(PushConsts), &push_consts);
+						rhi->cmd_draw(cmd, 6, batch.count, 0, first_instance + batch.first);
+						draw_count++;
+					}
+				}
+
+				rhi->cmd_end_render_pass(cmd);
+				rhi->get_render_stats().foliage_draws += draw_count;
+			}
+		);
+	}
+
+	RGHandle FoliagePass::add_shadow_to_graph(RenderGraph& render_graph, RGHandle shadow_map,
+		const SceneView& view,
+		const RenderConfig& config,
+		const std::vector<RenderMesh>& meshes,
+		const FoliageSystem& foliage,
+		const std::vector<FoliageDrawList>& cascade_draws,
+		const std::vector<uint32_t>& cascade_first_instances,
+		bud::graphics::BufferHandle instance_buffer,
+		const VertexStreams& vertex_streams,
+		bud::graphics::BufferHandle mega_index_buffer)
+	{
+		const uint32_t cascade_count = std::min({ config.cascade_count, static_cast<uint32_t>(cascade_draws.size()), static_cast<uint32_t>(cascade_first_instances.size()) });
+		if (!shadow_pipeline || cascade_count == 0 || !instance_buffer.is_valid()) return shadow_map;
+
+		return render_graph.add_pass("Foliage Shadow",
+			[=](RGBuilder& builder) {
+				builder.write(shadow_map, ResourceState::DepthWrite);
+				return shadow_map;
+			},
+			[=, &render_graph, &meshes, &foliage, &cascade_draws, &cascade_first_instances, &view, this](RHI* rhi, CommandHandle cmd) {
+				auto* map = render_graph.get_texture(shadow_map);
+				uint32_t draw_count = 0;
+
+				struct PushConsts {
+					bud::math::mat4 light_view_proj;
+					bud::math::mat4 model;
+					bud::math::vec4 light_dir;
+					uint32_t material_id;
+					uint32_t padding[3];
+				} push_consts{};
+				push_consts.model = bud::math::mat4(1.0f);
+				push_consts.light_dir = bud::math::vec4(bud::math::normalize(view.light_dir), 0.0f);
+
+				for (uint32_t i = 0; i < cascade_count; ++i) {
+					if (cascade_draws[i].batches.empty()) continue;
+
+					// Loads the layer the CSM pass wrote
+					RenderPassBeginInfo info;
+					info.depth_attachment = map;
+					info.clear_depth = false;
+					info.base_array_layer = i;
+					info.layer_count = 1;
+
+					rhi->cmd_begin_render_pass(cmd, info);
+					rhi->cmd_bind_pipeline(cmd, shadow_pipeline);
+					rhi->cmd_set_viewport(cmd, (float)config.shadow_map_size, (float)config.shadow_map_size);
+					rhi->cmd_set_scissor(cmd, config.shadow_map_size, config.shadow_map_size);
+					rhi->cmd_set_depth_bias(cmd, config.shadow_bias_constant, 0.0f, config.shadow_bias_slope);
+					rhi->cmd_bind_descriptor_set(cmd, shadow_pipeline, 0);
+
+					bind_vertex_streams(rhi, cmd, vertex_streams);
+					rhi->cmd_bind_vertex_buffer(cmd, instance_buffer, 2);
+					rhi->cmd_bind_index_buffer(cmd, mega_index_buffer);
+
+					push_consts.light_view_proj = view.cascade_view_proj_matrices[i];
+					draw_count += draw_foliage_mesh_batches(rhi, cmd, meshes, foliage, cascade_draws[i], cascade_first_instances[i], [&](uint32_t material_id) {
+						push_consts.material_id = material_id;
+						rhi->cmd_push_constants(cmd, shadow_pipeline, sizeof(PushConsts), &push_consts);
+					});
+					rhi->cmd_end_render_pass(cmd);
+				}
+
+				rhi->get_render_stats().foliage_draws += draw_count;
+			}
+		);
+	}
+
+	void VisibilityBufferPass::init(RHI* rhi, const RenderConfig& config, bud::io::AssetManager* asset_manager) {
+		if (!rhi || !asset_manager) return;
+
+		if (!rhi->supports_visibility_buffer()) {
+			bud::print("[VisibilityBufferPass] Not supported by the device, forward main view only.");
+			return;
+		}
+
+		load_shaders_async(asset_manager, { "src/shaders/vis_buffer.vert.spv", "src/shaders/vis_buffer.frag.spv" }, [this, rhi, config](const auto& shaders) {
+			GraphicsPipelineDesc desc;
+			desc.vs.code = shaders[0];
+			desc.fs.code = shaders[1];
+			desc.depth_test = true;
+			desc.depth_write = false; // Z-prepass depth is final, ids only land on the surviving fragments
+			desc.cull_mode = CullMode::None;
+			desc.color_attachment_format = bud::graphics::TextureFormat::R32G32_UINT;
+			desc.depth_compare_op = config.reversed_z ? CompareOp::GreaterEqual : CompareOp::LessEqual;
+			desc.enable_depth_bias = false;
+			desc.vertex_layout = VertexLayoutType::PositionUV;
+
+			pipeline = rhi->create_graphics_pipeline(desc);
+			if (pipeline) {
+				bud::print("[VisibilityBufferPass] Raster pipeline created.");
+			}
+		});
+
+		load_shaders_async(asset_manager, {
+			"src/shaders/vis_classify.comp.spv",
+			"src/shaders/vis_prefix.comp.spv",
+			"src/shaders/vis_bin.comp.spv",
+			"src/shaders/vis_resolve.comp.spv" }, [this, rhi](const auto& shaders) {
+			void** targets[] = { &classify_pipeline, &prefix_pipeline, &bin_pipeline, &resolve_pipeline };
+			for (size_t i = 0; i < std::size(targets); ++i) {
+				ComputePipelineDesc desc;
+				desc.cs.code = shaders[i];
+				*targets[i] = rhi->create_compute_pipeline(desc);
+			}
+			if (classify_pipeline && prefix_pipeline && bin_pipeline && resolve_pipeline) {
+				bud::print("[VisibilityBufferPass] Resolve pipelines created.");
+			}
+		});
+	}
+
+	void VisibilityBufferPass::shutdown(RHI* rhi) {
+		RenderPass::shutdown(rhi);
+		if (!rhi) return;
+		for (void** compute : { &classify_pipeline, &prefix_pipeline, &bin_pipeline, &resolve_pipeline }) {
+			if (*compute) {
+				rhi->destroy_pipeline(*compute);
+				*compute = nullptr;
+			}
+		}
+	}
+
+	void VisibilityBufferPass::add_to_graph(RenderGraph& render_graph, RGHandle shadow_map, RGHandle backbuffer, RGHandle depth_buffer,
+		const SceneView& view,
+		const RenderConfig& config,
+		size_t draw_count,
+		RGHandle indirect_draw_buffer,
+		RGHandle draw_data,
+		RGHandle instance_data,
+		RGHandle resolve_buffer,
+		const VertexStreams& vertex_streams,
+		bud::graphics::BufferHandle mega_index_buffer,
+		RGHandle light_cluster_grid)
+	{
+		if (!is_ready() || draw_count == 0) {
+			bud::eprint("[VisibilityBufferPass] ERROR: add_to_graph called before the pipelines are ready.");
+			return;
+		}
+
+		const auto* backbuffer_tex = render_graph.get_texture(backbuffer);
+		if (!backbuffer_tex || backbuffer_tex->width == 0 || backbuffer_tex->height == 0) {
+			return;
+		}
+
+		// Targets match the backbuffer so the blit stays 1:1, raster and resolve cover the scaled extent
+		const uint32_t target_width = scaled_extent(backbuffer_tex->width, view.render_scale);
+		const uint32_t target_height = scaled_extent(backbuffer_tex->height, view.render_scale);
+
+		TextureDesc vis_desc;
+		vis_desc.width = backbuffer_tex->width;
+		vis_desc.height = backbuffer_tex->height;
+		vis_desc.format = bud::graphics::TextureFormat::R32G32_UINT;
+
+		TextureDesc resolved_desc;
+		resolved_desc.width = backbuffer_tex->width;
+		resolved_desc.height = backbuffer_tex->height;
+		resolved_desc.format = bud::graphics::TextureFormat::R16G16B16A16_FLOAT;
+		resolved_desc.is_storage = true;
+
+		auto vis_h = std::make_shared<RGHandle>();
+		auto resolved_h = std::make_shared<RGHandle>();
+
+		render_graph.add_pass("Visibility Buffer Pass",
+			[=](RGBuilder& builder) {
+				*vis_h = builder.create("VisibilityBuffer", vis_desc);
+				builder.write(*vis_h, ResourceState::RenderTarget);
+				builder.write(depth_buffer, ResourceState::DepthWrite);
+				builder.read(indirect_draw_buffer, ResourceState::IndirectArgument);
+				builder.read(instance_data, ResourceState::ShaderResource);
+				return *vis_h;
+			},
+			[=, &render_graph, this](RHI* rhi, CommandHandle cmd) {
+				if (!pipeline) return;
+
+				rhi->cmd_begin_gpu_timer(cmd, GPUTimer::MainView);
+				rhi->cmd_begin_gpu_timer(cmd, GPUTimer::VisibilityRaster);
+
+				auto ind_buf_handle = render_graph.get_buffer(indirect_draw_buffer);
+
+				RenderPassBeginInfo info;
+				info.color_attachments.push_back(render_graph.get_texture(*vis_h));
+				info.depth_attachment = render_graph.get_texture(depth_buffer);
+				info.clear_color = true;
+				info.clear_color_value = { 0.0f, 0.0f, 0.0f, 0.0f }; // id 0 = background
+				info.clear_depth = false;
+
+				rhi->cmd_begin_render_pass(cmd, info);
+				rhi->cmd_bind_pipeline(cmd, pipeline);
+				rhi->cmd_set_viewport(cmd, (float)target_width, (float)target_height);
+				rhi->cmd_set_scissor(cmd, target_width, target_height);
+
+				rhi->update_global_uniforms(rhi->get_current_image_index(), view);
+				rhi->cmd_bind_descriptor_set(cmd, pipeline, 0);
+
+				bind_vertex_streams(rhi, cmd, vertex_streams);
+				rhi->cmd_bind_index_buffer(cmd, mega_index_buffer);
+
+				// Instance-level Hi-Z list: gl_PrimitiveID stays relative to DrawData::firstIndex
+				if (use_indirect_count(rhi, config)) {
+					rhi->cmd_draw_indexed_indirect_count(cmd, ind_buf_handle, INDIRECT_COUNT_HEADER_SIZE, ind_buf_handle, 0, (uint32_t)draw_count, sizeof(IndirectCommand));
+				} else {
+					rhi->cmd_draw_indexed_indirect(cmd, ind_buf_handle, INDIRECT_COUNT_HEADER_SIZE, (uint32_t)draw_count, sizeof(IndirectCommand));
+				}
+
+				rhi->cmd_end_render_pass(cmd);
+				rhi->cmd_end_gpu_timer(cmd, GPUTimer::VisibilityRaster);
+			}
+		);
+
+		render_graph.add_pass("Visibility Material Resolve",
+			[=](RGBuilder& builder) {
+				*resolved_h = builder.create("VisibilityResolved", resolved_desc);
+				builder.read(*vis_h, ResourceState::ShaderResource);
+				builder.read(shadow_map, ResourceState::DepthRead);
+				builder.read(draw_data, ResourceState::ShaderResource);
+				builder.read(instance_data, ResourceState::ShaderResource);
+				if (light_cluster_grid.is_valid()) {
+					builder.read(light_cluster_grid, ResourceState::ShaderResource);
+				}
+				builder.write(resolve_buffer, ResourceState::UnorderedAccess);
+				builder.write(*resolved_h, ResourceState::UnorderedAccess);
+				return *resolved_h;
+			},
+			[=, &render_graph, this](RHI* rhi, CommandHandle cmd) {
+				bud::graphics::BufferHandle draw_buf{};
+				bud::graphics::BufferHandle inst_buf{};
+				bud::graphics::BufferHandle resolve_buf{};
+				Texture* vis_tex = nullptr;
+				Texture* resolved_tex = nullptr;
+				Texture* shadow_tex = nullptr;
+				try {
+					draw_buf = render_graph.get_buffer(draw_data);
+					inst_buf = render_graph.get_buffer(instance_data);
+					resolve_buf = render_graph.get_buffer(resolve_buffer);
+					vis_tex = render_graph.get_texture(*vis_h);
+					resolved_tex = render_graph.get_texture(*resolved_h);
+					shadow_tex = render_graph.get_texture(shadow_map);
+				} catch (const std::exception& e) {
+					bud::eprint("[VisibilityBufferPass] Resource lookup failed: {}", e.what());
+					return;
+				}
+
+				if (!draw_buf.is_valid() || !inst_buf.is_valid() || !resolve_buf.is_valid() || !vis_tex || !resolved_tex || !shadow_tex) {
+					std::string err = std::format("VisibilityBufferPass missing resources: draw={} inst={} resolve={} vis={} out={} shadow={}",
+						draw_buf.is_valid(), inst_buf.is_valid(), resolve_buf.is_valid(), (bool)vis_tex, (bool)resolved_tex, (bool)shadow_tex);
+					bud::eprint("{}", err);
+#if defined(_DEBUG)
+					throw std::runtime_error(err);
+#else
+					return;
+#endif
+				}
+
+				rhi->cmd_begin_gpu_timer(cmd, GPUTimer::MaterialResolve);
+
+				// Bin counts / offsets / cursors start from zero every frame
+				static const std::vector<uint8_t> zero_header(VISIBILITY_RESOLVE_HEADER_SIZE, 0);
+				rhi->resource_barrier(cmd, resolve_buf, ResourceState::UnorderedAccess, ResourceState::TransferDst);
+				rhi->cmd_copy_to_buffer(cmd, resolve_buf, 0, VISIBILITY_RESOLVE_HEADER_SIZE, zero_header.data());
+				rhi->resource_barrier(cmd, resolve_buf, ResourceState::TransferDst, ResourceState::UnorderedAccess);
+
+				struct PushConsts {
+					uint32_t width;
+					uint32_t height;
+				} pc{ target_width, target_height };
+
+				const uint32_t group_x = (target_width + 15) / 16;
+				const uint32_t group_y = (target_height + 15) / 16;
+
+				// 1. Per-material pixel counts
+				rhi->cmd_bind_pipeline(cmd, classify_pipeline);
+				rhi->cmd_bind_compute_texture(cmd, classify_pipeline, 3, vis_tex);
+				rhi->cmd_bind_storage_buffer(cmd, classify_pipeline, 7, inst_buf);
+				rhi->cmd_bind_storage_buffer(cmd, classify_pipeline, 8, resolve_buf);
+				rhi->cmd_push_constants(cmd, classify_pipeline, sizeof(PushConsts), &pc);
+				rhi->cmd_dispatch(cmd, group_x, group_y, 1);
+				rhi->resource_barrier(cmd, resolve_buf, ResourceState::UnorderedAccess, ResourceState::UnorderedAccess);
+
+				// 2. Bin offsets
+				rhi->cmd_bind_pipeline(cmd, prefix_pipeline);
+				rhi->cmd_bind_storage_buffer(cmd, prefix_pipeline, 8, resolve_buf);
+				rhi->cmd_dispatch(cmd, 1, 1, 1);
+				rhi->resource_barrier(cmd, resolve_buf, ResourceState::UnorderedAccess, ResourceState::UnorderedAccess);
+
+				// 3. Material-sorted pixel list (+ background fill)
+				rhi->cmd_bind_pipeline(cmd, bin_pipeline);
+				rhi->cmd_bind_compute_texture(cmd, bin_pipeline, 3, vis_tex);
+				rhi->cmd_bind_compute_texture(cmd, bin_pipeline, 5, resolved_tex, 0, true);
+				rhi->cmd_bind_storage_buffer(cmd, bin_pipeline, 7, inst_buf);
+				rhi->cmd_bind_storage_buffer(cmd, bin_pipeline, 8, resolve_buf);
+				rhi->cmd_push_constants(cmd, bin_pipeline, sizeof(PushConsts), &pc);
+				rhi->cmd_dispatch(cmd, group_x, group_y, 1);
+				rhi->resource_barrier(cmd, resolve_buf, ResourceState::UnorderedAccess, ResourceState::UnorderedAccess);
+
+				// 4. Shade, consecutive threads share a material. Global set 1 carries bindless textures + CSM
+				rhi->update_global_shadow_map(shadow_tex);
+				rhi->update_global_uniforms(rhi->get_current_image_index(), view);
+
+				rhi->cmd_bind_pipeline(cmd, resolve_pipeline);
+				rhi->cmd_bind_descriptor_set(cmd, resolve_pipeline, 1);
+				rhi->cmd_bind_storage_buffer(cmd, resolve_pipeline, 0, draw_buf);
+				rhi->cmd_bind_compute_texture(cmd, resolve_pipeline, 3, vis_tex);
+				rhi->cmd_bind_compute_ubo(cmd, resolve_pipeline, 4);
+				rhi->cmd_bind_compute_texture(cmd, resolve_pipeline, 5, resolved_tex, 0, true);
+				rhi->cmd_bind_storage_buffer(cmd, resolve_pipeline, 7, inst_buf);
+				rhi->cmd_bind_storage_buffer(cmd, resolve_pipeline, 8, resolve_buf);
+				rhi->cmd_bind_storage_buffer(cmd, resolve_pipeline, 9, mega_index_buffer);
+				rhi->cmd_bind_storage_buffer(cmd, resolve_pipeline, 10, vertex_streams.pool);
+				rhi->cmd_push_constants(cmd, resolve_pipeline, sizeof(PushConsts), &pc);
+				// The covered pixel count lives on the GPU, the shader exits past it
+				rhi->cmd_dispatch(cmd, (target_width * target_height + 63) / 64, 1, 1);
+
+				rhi->cmd_end_gpu_timer(cmd, GPUTimer::MaterialResolve);
+			}
+		);
+
+		render_graph.add_pass("Visibility Resolve Blit",
+			[=](RGBuilder& builder) {
+				builder.read(*resolved_h, ResourceState::TransferSrc);
+				builder.write(backbuffer, ResourceState::TransferDst);
+				return backbuffer;
+			},
+			[=, &render_graph](RHI* rhi, CommandHandle cmd) {
+				rhi->cmd_blit_image(cmd, render_graph.get_texture(*resolved_h), render_graph.get_texture(backbuffer));
+				rhi->cmd_end_gpu_timer(cmd, GPUTimer::MainView);
 			}
 		);
 	}
@@ -1230,8 +2228,9 @@ namespace bud::graphics {
 		const std::vector<RenderMesh>& meshes, const std::vector<SortItem>& sort_list,
 		size_t instance_count, bud::graphics::RGHandle indirect_draw_buffer,
 		bud::graphics::RGHandle instance_data,
-		bud::graphics::BufferHandle mega_vertex_buffer,
-		bud::graphics::BufferHandle mega_index_buffer)
+		const VertexStreams& vertex_streams,
+		bud::graphics::BufferHandle mega_index_buffer,
+		bud::graphics::RGHandle light_cluster_grid)
 	{
 		const size_t draw_count = std::min(instance_count, sort_list.size());
 		if (draw_count == 0 || !pipeline) return;
@@ -1239,8 +2238,8 @@ namespace bud::graphics {
 		const auto* backbuffer_tex = render_graph.get_texture(backbuffer);
 		if (!backbuffer_tex || backbuffer_tex->width == 0 || backbuffer_tex->height == 0) return;
 
-		uint32_t target_width = backbuffer_tex->width;
-		uint32_t target_height = backbuffer_tex->height;
+		uint32_t target_width = scaled_extent(backbuffer_tex->width, view.render_scale);
+		uint32_t target_height = scaled_extent(backbuffer_tex->height, view.render_scale);
 
 		render_graph.add_pass("Cluster Visualization Pass",
 			[=](RGBuilder& builder) {
@@ -1249,6 +2248,9 @@ namespace bud::graphics {
 				if (config.enable_gpu_driven) {
 					builder.read(indirect_draw_buffer, ResourceState::IndirectArgument);
 				}
+				if (light_cluster_grid.is_valid()) {
+					builder.read(light_cluster_grid, ResourceState::ShaderResource);
+				}
 				builder.read(instance_data, ResourceState::ShaderResource);
 				return backbuffer;
 			},
@@ -1274,11 +2276,15 @@ namespace bud::graphics {
 				rhi->cmd_bind_descriptor_set(cmd, pipeline, 0);
 
 				// Bind global Mega-Buffer once for the entire pass
-				rhi->cmd_bind_vertex_buffer(cmd, mega_vertex_buffer);
+				bind_vertex_streams(rhi, cmd, vertex_streams);
 				rhi->cmd_bind_index_buffer(cmd, mega_index_buffer);
 
 				if (config.enable_gpu_driven && ind_buf_handle.is_valid()) {
-					rhi->cmd_draw_indexed_indirect(cmd, ind_buf_handle, 0, (uint32_t)draw_count, sizeof(IndirectCommand));
+					if (use_indirect_count(rhi, config)) {
+						rhi->cmd_draw_indexed_indirect_count(cmd, ind_buf_handle, INDIRECT_COUNT_HEADER_SIZE, ind_buf_handle, 0, (uint32_t)draw_count, sizeof(IndirectCommand));
+					} else {
+						rhi->cmd_draw_indexed_indirect(cmd, ind_buf_handle, INDIRECT_COUNT_HEADER_SIZE, (uint32_t)draw_count, sizeof(IndirectCommand));
+					}
 				}
 				else {
 					for (size_t i = 0; i < draw_count; ++i) {
@@ -1303,4 +2309,94 @@ namespace bud::graphics {
 			}
 		);
 	}
+
+	void UpscalePass::init(RHI* rhi, const RenderConfig& config, bud::io::AssetManager* asset_manager) {
+		if (!rhi || !asset_manager) {
+			std::string err = std::format("UpscalePass::init invalid args: rhi={} asset_manager={}", (void*)rhi, (void*)asset_manager);
+			bud::eprint("{}", err);
+#if defined(_DEBUG)
+			throw std::runtime_error(err);
+#else
+			return;
+#endif
+		}
+
+		load_shaders_async(asset_manager, { "src/shaders/fullscreen.vert.spv", "src/shaders/upscale.frag.spv" }, [this, rhi](const auto& shaders) {
+			GraphicsPipelineDesc desc;
+			desc.vs.code = shaders[0];
+			desc.fs.code = shaders[1];
+			desc.depth_test = false;
+			desc.depth_write = false;
+			desc.cull_mode = CullMode::None;
+			desc.color_attachment_format = bud::graphics::TextureFormat::BGRA8_SRGB;
+			desc.vertex_layout = VertexLayoutType::NoVertexInput;
+			pipeline = rhi->create_graphics_pipeline(desc);
+			if (pipeline) {
+				bud::print("[UpscalePass] Shaders loaded and pipeline created.");
+			}
+		});
+	}
+
+	void UpscalePass::add_to_graph(RenderGraph& render_graph, RGHandle scene_color, RGHandle backbuffer, const SceneView& view, const RenderConfig& config) {
+		if (!pipeline || first_source_slot == 0) return;
+
+		const auto& color_desc = render_graph.get_texture_desc(scene_color);
+		if (color_desc.width == 0 || color_desc.height == 0) return;
+
+		const uint32_t src_width = scaled_extent(color_desc.width, view.render_scale);
+		const uint32_t src_height = scaled_extent(color_desc.height, view.render_scale);
+
+		struct PushConsts {
+			bud::math::vec2 uv_scale;   // Rendered extent / allocated extent
+			bud::math::vec2 uv_max;     // Centre of the last rendered texel, bilinear taps stay inside the sub-rect
+			bud::math::vec2 texel_size; // 1 / allocated extent
+			float sharpness;
+			uint32_t texture_id;
+		} pc{};
+		pc.uv_scale = bud::math::vec2((float)src_width / color_desc.width, (float)src_height / color_desc.height);
+		pc.uv_max = bud::math::vec2((src_width - 0.5f) / color_desc.width, (src_height - 0.5f) / color_desc.height);
+		pc.texel_size = bud::math::vec2(1.0f / color_desc.width, 1.0f / color_desc.height);
+		pc.sharpness = std::clamp(config.upscale_sharpness, 0.0f, 1.0f);
+
+		render_graph.add_pass("Upscale Pass",
+			[=](RGBuilder& builder) {
+				builder.read(scene_color, ResourceState::ShaderResource);
+				builder.write(backbuffer, ResourceState::RenderTarget);
+				return backbuffer;
+			},
+			[=, &render_graph, this](RHI* rhi, CommandHandle cmd) {
+				Texture* color_tex = nullptr;
+				Texture* target_tex = nullptr;
+				try {
+					color_tex = render_graph.get_texture(scene_color);
+					target_tex = render_graph.get_texture(backbuffer);
+				} catch (const std::exception& e) {
+					bud::eprint("[UpscalePass] Resource lookup failed: {}", e.what());
+					return;
+				}
+				if (!color_tex || !target_tex) return;
+
+				PushConsts push = pc;
+				push.texture_id = first_source_slot + rhi->get_current_image_index() % source_bindless_slot_count;
+				rhi->update_bindless_texture(push.texture_id, color_tex);
+
+				rhi->cmd_begin_debug_label(cmd, "Upscale", 0, 1, 1);
+
+				RenderPassBeginInfo info;
+				info.color_attachments.push_back(target_tex);
+				info.clear_color = false; // The fullscreen triangle covers every pixel
+
+				rhi->cmd_begin_render_pass(cmd, info);
+				rhi->cmd_bind_pipeline(cmd, pipeline);
+				rhi->cmd_set_viewport(cmd, (float)target_tex->width, (float)target_tex->height);
+				rhi->cmd_set_scissor(cmd, target_tex->width, target_tex->height);
+				rhi->cmd_bind_descriptor_set(cmd, pipeline, 0);
+				rhi->cmd_push_constants(cmd, pipeline, sizeof(PushConsts), &push);
+				rhi->cmd_draw(cmd, 3, 1, 0, 0);
+				rhi->cmd_end_render_pass(cmd);
+
+				rhi->cmd_end_debug_label(cmd);
+			}
+		);
+	}
 }
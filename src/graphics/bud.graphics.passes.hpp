@@ -16,8 +16,36 @@
 
 #include "src/graphics/bud.graphics.scene.hpp"
 #include "src/graphics/bud.graphics.sortkey.hpp"
+#include "src/graphics/bud.graphics.foliage.hpp"
 
 namespace bud::graphics {
+	// GPU-driven passes compact their draw lists only when the device can consume a GPU-side count
+	inline bool use_indirect_count(const RHI* rhi, const RenderConfig& config) {
+		return rhi && config.enable_gpu_driven && config.enable_indirect_count && rhi->supports_draw_indirect_count();
+	}
+
+	// Main view draws are split into per-meshlet records by MeshletCullingPass
+	inline bool use_meshlet_culling(const RHI* rhi, const RenderConfig& config) {
+		return rhi && config.enable_gpu_driven && config.enable_meshlet_culling;
+	}
+
+	// Task/mesh shaders consume the visible meshlet list directly; needs the GPU-side count as well
+	inline bool use_mesh_shader_path(const RHI* rhi, const RenderConfig& config) {
+		return use_meshlet_culling(rhi, config) && use_indirect_count(rhi, config) && config.prefer_mesh_shaders && rhi->supports_mesh_shaders();
+	}
+
+	// Visibility buffer resolve reads DrawData (firstIndex / vertexOffset) of the Hi-Z culled draw list
+	inline bool use_visibility_buffer(const RHI* rhi, const RenderConfig& config) {
+		return rhi && config.enable_gpu_driven && config.enable_visibility_buffer && rhi->supports_visibility_buffer();
+	}
+
+	// Mesh vertex layouts: positions on binding 0, attributes on binding 1. PositionOnly pipelines
+	// ignore binding 1, binding it anyway keeps pipeline switches inside a pass cheap.
+	inline void bind_vertex_streams(RHI* rhi, CommandHandle cmd, const VertexStreams& streams) {
+		rhi->cmd_bind_vertex_buffer(cmd, streams.positions, 0);
+		rhi->cmd_bind_vertex_buffer(cmd, streams.attributes, 1);
+	}
+
 	class RenderPassBase {
 	public:
 		virtual ~RenderPassBase() = default;
@@ -29,7 +57,9 @@ namespace bud::graphics {
 	protected:
 		void* pipeline = nullptr;
 
-		// Helper for asynchronous multi-shader loading
+		// Helper for asynchronous multi-shader loading. With a mounted shader bundle on_loaded runs on a
+		// worker (pipelines of different passes compile in parallel), otherwise on the main thread.
+		// Either way it completes before the first frame, see AssetManager::wait_for_shader_loads.
 		void load_shaders_async(bud::io::AssetManager* asset_manager, 
 							   const std::vector<std::string>& paths, 
 							   std::function<void(std::vector<std::vector<char>>)> on_loaded);
@@ -47,13 +77,34 @@ namespace bud::graphics {
 	class HiZCullingPass : public RenderPass {
 	public:
 		void init(RHI* rhi, const RenderConfig& config, bud::io::AssetManager* asset_manager) override;
-		RGHandle add_to_graph(RenderGraph& rg, RGHandle instance_buffer, RGHandle indirect_draw_buffer, RGHandle stats_buffer, RGHandle hiz_pyramid, const SceneView& view, size_t instance_count);
+		RGHandle add_to_graph(RenderGraph& rg, RGHandle instance_buffer, RGHandle indirect_draw_buffer, RGHandle stats_buffer, RGHandle hiz_pyramid, const SceneView& view, const RenderConfig& config, size_t instance_count);
+	};
+
+	// Frustum / normal cone / Hi-Z test per meshlet of every main view draw.
+	// Output goes to meshlet_indirect_buffer (indexed commands over the expanded meshlet triangles)
+	// or, on the mesh shader path, to meshlet_visible_buffer + the task dispatch in the header.
+	class MeshletCullingPass : public RenderPass {
+	public:
+		void init(RHI* rhi, const RenderConfig& config, bud::io::AssetManager* asset_manager) override;
+		// lod_error_scale: bud::cluster_lod::get_error_scale() of the main view, 0 skips the cluster LOD test
+		RGHandle add_to_graph(RenderGraph& rg, RGHandle draw_buffer, RGHandle meshlet_indirect_buffer, RGHandle meshlet_visible_buffer,
+			RGHandle stats_buffer, RGHandle hiz_pyramid, RGHandle instance_data, bud::graphics::BufferHandle meshlet_pool,
+			bud::graphics::BufferHandle meshlet_lod_pool, const RenderConfig& config, size_t draw_count, uint32_t record_capacity,
+			bool mesh_shader_path, float lod_error_scale, float lod_z_near);
+	};
+
+	// Compacts shadow caster draws into one indirect-count region per cascade
+	class ShadowCullingPass : public RenderPass {
+	public:
+		void init(RHI* rhi, const RenderConfig& config, bud::io::AssetManager* asset_manager) override;
+		RGHandle add_to_graph(RenderGraph& rg, RGHandle shadow_draw_buffer, RGHandle shadow_indirect_buffer, RGHandle stats_buffer,
+			const RenderConfig& config, size_t draw_count, uint32_t region_capacity, uint32_t first_instance_base);
 	};
 
 	class HiZMipPass : public RenderPass {
 	public:
 		void init(RHI* rhi, const RenderConfig& config, bud::io::AssetManager* asset_manager) override;
-		RGHandle add_to_graph(RenderGraph& rg, RGHandle depth_buffer, const RenderConfig& config);
+		RGHandle add_to_graph(RenderGraph& rg, RGHandle depth_buffer, const RenderConfig& config, float render_scale = 1.0f);
 	};
 
 	class HiZDebugPass : public RenderPass {
@@ -62,9 +113,14 @@ namespace bud::graphics {
 		void add_to_graph(RenderGraph& rg, RGHandle backbuffer, RGHandle hiz_pyramid, uint32_t mip_level);
 	};
 
+	// Depth-only draws of materials without alpha testing use opaque_pipeline, which reads the position
+	// stream only; alpha-tested materials (alpha_tested_materials[material_id] != 0) keep the UV pipeline.
 	class ZPrepass : public RenderPass {
+		void* opaque_pipeline = nullptr; // zprepass_opaque.vert + depth_only.frag, VertexLayoutType::PositionOnly
+
 	public:
 		void init(RHI* rhi, const RenderConfig& config, bud::io::AssetManager* asset_manager) override;
+		void shutdown(RHI* rhi) override;
 		RGHandle add_to_graph(RenderGraph& rg, RGHandle backbuffer,
 			const RenderScene& render_scene,
 			const SceneView& view,
@@ -72,12 +128,15 @@ namespace bud::graphics {
 			const std::vector<RenderMesh>& meshes,
 			const std::vector<SortItem>& sort_list,
 			size_t instance_count,
-			bud::graphics::BufferHandle mega_vertex_buffer,
-			bud::graphics::BufferHandle mega_index_buffer);
+			const VertexStreams& vertex_streams,
+			bud::graphics::BufferHandle mega_index_buffer,
+			const std::vector<uint8_t>& alpha_tested_materials);
 	};
 
 
 	class CSMShadowPass : public RenderPass {
+		void* indirect_pipeline = nullptr; // shadow_indirect.vert/frag, used with ShadowCullingPass output
+		void* opaque_pipeline = nullptr;   // shadow_opaque.vert + depth_only.frag, same selection as ZPrepass
 		Texture* static_cache_texture = nullptr;
 		bud::math::vec3 last_light_dir = bud::math::vec3(0.0f);
 		bud::math::mat4 last_view_proj = bud::math::mat4(1.0f);
@@ -97,13 +156,25 @@ namespace bud::graphics {
 		};
 
 		void init(RHI* rhi, const RenderConfig& config, bud::io::AssetManager* asset_manager) override;
-		RGHandle add_to_graph(RenderGraph& rg, const SceneView& view, const RenderConfig& config, const RenderScene& render_scene, const std::vector<RenderMesh>& meshes, std::vector<std::vector<uint32_t>> csm_visible_instances, bud::graphics::BufferHandle mega_vertex_buffer, bud::graphics::BufferHandle mega_index_buffer);
+		RGHandle add_to_graph(RenderGraph& rg, const SceneView& view, const RenderConfig& config, const RenderScene& render_scene, const std::vector<RenderMesh>& meshes, std::vector<std::vector<uint32_t>> csm_visible_instances, const VertexStreams& vertex_streams, bud::graphics::BufferHandle mega_index_buffer,
+			const std::vector<uint8_t>& alpha_tested_materials, RGHandle shadow_indirect_buffer = {}, uint32_t shadow_region_capacity = 0);
+	};
+
+	// Output of MeshletCullingPass; when draw_buffer is invalid MainPass draws the per-instance list
+	struct MeshletDrawInputs {
+		RGHandle draw_buffer;
+		RGHandle visible_buffer;
+		uint32_t record_capacity = 0;
+		bool mesh_shader_path = false;
 	};
 
-	
 	class MainPass : public RenderPass {
+		void* mesh_pipeline = nullptr; // meshlet.task/mesh + main.frag, only when the device supports mesh shaders
+
 	public:
 		void init(RHI* rhi, const RenderConfig& config, bud::io::AssetManager* asset_manager) override;
+		void shutdown(RHI* rhi) override;
+		bool has_mesh_pipeline() const { return mesh_pipeline != nullptr; }
 		void add_to_graph(RenderGraph& rg, RGHandle shadow_map, RGHandle backbuffer, RGHandle depth_buffer,
 			const RenderScene& render_scene,
 			const SceneView& view,
@@ -113,10 +184,75 @@ namespace bud::graphics {
 			size_t instance_count,
 			bud::graphics::RGHandle indirect_draw_buffer,
 			bud::graphics::RGHandle instance_data,
-			bud::graphics::BufferHandle mega_vertex_buffer,
+			const VertexStreams& vertex_streams,
+			bud::graphics::BufferHandle mega_index_buffer,
+			const MeshletDrawInputs& meshlet_inputs = {},
+			RGHandle light_cluster_grid = {},
+			const std::vector<uint32_t>* draw_slots = nullptr); // CPU path: instance slot per sort_list item, default = its index
+	};
+
+	// FoliageSystem batches, one instanced draw per (batch, submesh). Mesh LODs use foliage.vert + main.frag over
+	// the forward pass output (same depth, shadows and lights), impostor batches are camera-facing cards cut from
+	// the baked atlas. Instances come from one per-frame vertex buffer on binding 2, first_instance + batch.first
+	// selects a batch's records.
+	class FoliagePass : public RenderPass {
+		void* impostor_pipeline = nullptr; // impostor.vert/frag, VertexLayoutType::InstanceOnly
+		void* shadow_pipeline = nullptr;   // foliage_shadow.vert + shadow.frag, alpha tested like the CSM UV pipeline
+
+	public:
+		void init(RHI* rhi, const RenderConfig& config, bud::io::AssetManager* asset_manager) override;
+		void shutdown(RHI* rhi) override;
+		void add_to_graph(RenderGraph& rg, RGHandle shadow_map, RGHandle backbuffer, RGHandle depth_buffer,
+			const SceneView& view,
+			const std::vector<RenderMesh>& meshes,
+			const FoliageSystem& foliage,
+			const FoliageDrawList& draws,
+			bud::graphics::BufferHandle instance_buffer,
+			uint32_t first_instance,
+			const VertexStreams& vertex_streams,
+			bud::graphics::BufferHandle mega_index_buffer,
+			RGHandle light_cluster_grid = {});
+		// Caster batches of cascade i (cascade_draws[i], at cascade_first_instances[i]) on top of the CSM map
+		RGHandle add_shadow_to_graph(RenderGraph& rg, RGHandle shadow_map,
+			const SceneView& view,
+			const RenderConfig& config,
+			const std::vector<RenderMesh>& meshes,
+			const FoliageSystem& foliage,
+			const std::vector<FoliageDrawList>& cascade_draws,
+			const std::vector<uint32_t>& cascade_first_instances,
+			bud::graphics::BufferHandle instance_buffer,
+			const VertexStreams& vertex_streams,
 			bud::graphics::BufferHandle mega_index_buffer);
 	};
 
+	// Alternative main view: rasterize {draw slot, triangle} IDs into an R32G32_UINT target over the
+	// Z-prepass depth, then bin covered pixels by material and shade them in compute (vis_*.comp).
+	// The resolved RGBA16F image is blitted into the backbuffer.
+	class VisibilityBufferPass : public RenderPass {
+		void* classify_pipeline = nullptr;
+		void* prefix_pipeline = nullptr;
+		void* bin_pipeline = nullptr;
+		void* resolve_pipeline = nullptr;
+
+	public:
+		void init(RHI* rhi, const RenderConfig& config, bud::io::AssetManager* asset_manager) override;
+		void shutdown(RHI* rhi) override;
+		bool is_ready() const {
+			return pipeline && classify_pipeline && prefix_pipeline && bin_pipeline && resolve_pipeline;
+		}
+		void add_to_graph(RenderGraph& rg, RGHandle shadow_map, RGHandle backbuffer, RGHandle depth_buffer,
+			const SceneView& view,
+			const RenderConfig& config,
+			size_t draw_count,
+			RGHandle indirect_draw_buffer,
+			RGHandle draw_data,
+			RGHandle instance_data,
+			RGHandle resolve_buffer,
+			const VertexStreams& vertex_streams,
+			bud::graphics::BufferHandle mega_index_buffer,
+			RGHandle light_cluster_grid = {});
+	};
+
 	class ClusterVisualizationPass : public RenderPass {
 	public:
 		void init(RHI* rhi, const RenderConfig& config, bud::io::AssetManager* asset_manager) override;
@@ -129,8 +265,25 @@ namespace bud::graphics {
 			size_t instance_count,
 			bud::graphics::RGHandle indirect_draw_buffer,
 			bud::graphics::RGHandle instance_data,
-			bud::graphics::BufferHandle mega_vertex_buffer,
-			bud::graphics::BufferHandle mega_index_buffer);
+			const VertexStreams& vertex_streams,
+			bud::graphics::BufferHandle mega_index_buffer,
+			bud::graphics::RGHandle light_cluster_grid = {});
+	};
+
+	// Dynamic resolution composite: samples the scaled sub-rect of scene_color (bilinear + contrast-adaptive
+	// sharpening, upscale.frag) and writes the full backbuffer
+	class UpscalePass : public RenderPass {
+	public:
+		// Source slots, one per swapchain image so the descriptor of a pending frame is never rewritten
+		static constexpr uint32_t source_bindless_slot_count = 8;
+
+		void init(RHI* rhi, const RenderConfig& config, bud::io::AssetManager* asset_manager) override;
+		// First of source_bindless_slot_count slots taken from the renderer's bindless allocator
+		void set_bindless_slots(uint32_t first_slot) { first_source_slot = first_slot; }
+		void add_to_graph(RenderGraph& rg, RGHandle scene_color, RGHandle backbuffer, const SceneView& view, const RenderConfig& config);
+
+	private:
+		uint32_t first_source_slot = 0; // 0 = not assigned, the pass is skipped
 	};
 
 	struct UIDrawCmdSnapshot {
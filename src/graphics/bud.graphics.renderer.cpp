@@ -4,6 +4,8 @@
 #include <algorithm>
 #include <print>
 #include <cstring>
+#include <chrono>
+#include <limits>
 
 #include "src/graphics/bud.graphics.renderer.hpp"
 
@@ -13,13 +15,27 @@
 #include "src/graphics/bud.graphics.types.hpp"
 #include "src/io/bud.io.hpp"
 #include "src/core/bud.asset.types.hpp"
+#include "src/core/bud.cluster_lod.hpp"
 #include "src/runtime/bud.scene.hpp"
 #include "src/core/bud.math.hpp"
 #include "src/graphics/bud.graphics.sortkey.hpp"
 #include "src/graphics/vulkan/bud.vulkan.memory.hpp"
+#include "src/core/bud.profiler.hpp"
+#include "src/core/bud.frame.stats.hpp"
 
 namespace bud::graphics {
 
+	VertexStreams Renderer::GeometryPool::get_vertex_streams() const {
+		VertexStreams streams;
+		streams.pool = vertex_buffer;
+		streams.positions = vertex_buffer;
+		streams.positions.size = kPositionStreamSize;
+		streams.attributes = vertex_buffer;
+		streams.attributes.offset += kPositionStreamSize;
+		streams.attributes.size = kAttributeStreamSize;
+		return streams;
+	}
+
 	Renderer::Renderer(RHI* rhi, bud::io::AssetManager* asset_manager, bud::threading::TaskScheduler* task_scheduler)
 		: rhi(rhi), render_graph(rhi), asset_manager(asset_manager), task_scheduler(task_scheduler) {
 		upload_queue = std::make_shared<UploadQueue>();
@@ -27,25 +43,48 @@ namespace bud::graphics {
 		z_prepass = std::make_unique<ZPrepass>();
 		hiz_mip_pass = std::make_unique<HiZMipPass>();
 		hiz_pass = std::make_unique<HiZCullingPass>();
+		shadow_cull_pass = std::make_unique<ShadowCullingPass>();
+		meshlet_cull_pass = std::make_unique<MeshletCullingPass>();
 		hiz_debug_pass = std::make_unique<HiZDebugPass>();
 		main_pass = std::make_unique<MainPass>();
+		visibility_pass = std::make_unique<VisibilityBufferPass>();
 		cluster_viz_pass = std::make_unique<ClusterVisualizationPass>();
+		light_cluster_pass = std::make_unique<LightClusteringPass>();
+		upscale_pass = std::make_unique<UpscalePass>();
+		foliage_pass = std::make_unique<FoliagePass>();
 		ui_pass = std::make_unique<UIPass>();
 
 		csm_pass->init(rhi, render_config, asset_manager);
 		z_prepass->init(rhi, render_config, asset_manager);
 		hiz_mip_pass->init(rhi, render_config, asset_manager);
 		hiz_pass->init(rhi, render_config, asset_manager);
+		shadow_cull_pass->init(rhi, render_config, asset_manager);
+		meshlet_cull_pass->init(rhi, render_config, asset_manager);
 		hiz_debug_pass->init(rhi, render_config, asset_manager);
 		main_pass->init(rhi, render_config, asset_manager);
+		visibility_pass->init(rhi, render_config, asset_manager);
 		cluster_viz_pass->init(rhi, render_config, asset_manager);
+		light_cluster_pass->init(rhi, render_config, asset_manager);
+		upscale_pass->init(rhi, render_config, asset_manager);
+		upscale_pass->set_bindless_slots(next_bindless_slot.fetch_add(UpscalePass::source_bindless_slot_count, std::memory_order_relaxed));
+		foliage_pass->init(rhi, render_config, asset_manager);
 		ui_pass->init(rhi, render_config, asset_manager);
 
 		uint32_t max_frames = rhi->get_inflight_frame_count();
 		indirect_instance_buffers.resize(max_frames);
 		indirect_draw_buffers.resize(max_frames);
 		stats_readback_buffers.resize(max_frames);
+		shadow_draw_buffers.resize(max_frames);
+		shadow_indirect_buffers.resize(max_frames);
+		meshlet_indirect_buffers.resize(max_frames);
+		meshlet_visible_buffers.resize(max_frames);
+		visibility_resolve_buffers.resize(max_frames);
+		local_light_buffers.resize(max_frames);
+		light_cluster_buffers.resize(max_frames);
+		light_cluster_readback_buffers.resize(max_frames);
+		light_cluster_validations.resize(max_frames);
 		instance_data_ssbos.resize(max_frames);
+		foliage_instance_buffers.resize(max_frames);
 	}
 
 	Renderer::~Renderer() {
@@ -56,21 +95,23 @@ namespace bud::graphics {
 		if (z_prepass) z_prepass->shutdown(rhi);
 		if (hiz_mip_pass) hiz_mip_pass->shutdown(rhi);
 		if (hiz_pass) hiz_pass->shutdown(rhi);
+		if (shadow_cull_pass) shadow_cull_pass->shutdown(rhi);
+		if (meshlet_cull_pass) meshlet_cull_pass->shutdown(rhi);
 		if (hiz_debug_pass) hiz_debug_pass->shutdown(rhi);
 		if (main_pass) main_pass->shutdown(rhi);
+		if (visibility_pass) visibility_pass->shutdown(rhi);
 		if (cluster_viz_pass) cluster_viz_pass->shutdown(rhi);
+		if (light_cluster_pass) light_cluster_pass->shutdown(rhi);
+		if (upscale_pass) upscale_pass->shutdown(rhi);
+		if (foliage_pass) foliage_pass->shutdown(rhi);
 		if (ui_pass) ui_pass->shutdown(rhi);
 
-		for (auto& mesh : meshes) {
-			// vertex_buffer and index_buffer are now pool offsets, no individual destroy needed
-			if (mesh.meshlet_buffer.is_valid()) rhi->destroy_buffer(mesh.meshlet_buffer);
-			if (mesh.vertex_index_buffer.is_valid()) rhi->destroy_buffer(mesh.vertex_index_buffer);
-			if (mesh.meshlet_index_buffer.is_valid()) rhi->destroy_buffer(mesh.meshlet_index_buffer);
-			if (mesh.cull_data_buffer.is_valid()) rhi->destroy_buffer(mesh.cull_data_buffer);
-		}
-
+		// Mesh vertices, indices and meshlets are pool offsets, no per-mesh destroy needed
 		if (geometry_pool.vertex_buffer.is_valid()) rhi->destroy_buffer(geometry_pool.vertex_buffer);
 		if (geometry_pool.index_buffer.is_valid())  rhi->destroy_buffer(geometry_pool.index_buffer);
+		if (geometry_pool.meshlet_buffer.is_valid()) rhi->destroy_buffer(geometry_pool.meshlet_buffer);
+		if (geometry_pool.meshlet_data_buffer.is_valid()) rhi->destroy_buffer(geometry_pool.meshlet_data_buffer);
+		if (geometry_pool.meshlet_lod_buffer.is_valid()) rhi->destroy_buffer(geometry_pool.meshlet_lod_buffer);
 		
 		for (auto& buf : indirect_instance_buffers) {
 			if (buf.is_valid()) rhi->destroy_buffer(buf);
@@ -88,10 +129,66 @@ namespace bud::graphics {
 		}
 		stats_readback_buffers.clear();
 
+		for (auto& buf : shadow_draw_buffers) {
+			if (buf.is_valid()) rhi->destroy_buffer(buf);
+		}
+		shadow_draw_buffers.clear();
+
+		for (auto& buf : shadow_indirect_buffers) {
+			if (buf.is_valid()) rhi->destroy_buffer(buf);
+		}
+		shadow_indirect_buffers.clear();
+
+		for (auto& buf : meshlet_indirect_buffers) {
+			if (buf.is_valid()) rhi->destroy_buffer(buf);
+		}
+		meshlet_indirect_buffers.clear();
+
+		for (auto& buf : meshlet_visible_buffers) {
+			if (buf.is_valid()) rhi->destroy_buffer(buf);
+		}
+		meshlet_visible_buffers.clear();
+
+		for (auto& buf : visibility_resolve_buffers) {
+			if (buf.is_valid()) rhi->destroy_buffer(buf);
+		}
+		visibility_resolve_buffers.clear();
+
+		for (auto& buf : local_light_buffers) {
+			if (buf.is_valid()) rhi->destroy_buffer(buf);
+		}
+		local_light_buffers.clear();
+
+		for (auto& buf : light_cluster_buffers) {
+			if (buf.is_valid()) rhi->destroy_buffer(buf);
+		}
+		light_cluster_buffers.clear();
+
+		for (auto& buf : light_cluster_readback_buffers) {
+			if (buf.is_valid()) rhi->destroy_buffer(buf);
+		}
+		light_cluster_readback_buffers.clear();
+
+		if (auto* pool = rhi->get_resource_pool()) {
+			for (auto* tex : scene_color_targets) {
+				if (tex) pool->release_texture(tex);
+			}
+			for (auto* tex : view_color_targets) {
+				if (tex) pool->release_texture(tex);
+			}
+		}
+		scene_color_targets.clear();
+		view_color_targets.clear();
+
 		for (auto& buf : instance_data_ssbos) {
 			if (buf.is_valid()) rhi->destroy_buffer(buf);
 		}
 		instance_data_ssbos.clear();
+
+		for (auto& buf : foliage_instance_buffers) {
+			if (buf.is_valid()) rhi->destroy_buffer(buf);
+		}
+		foliage_instance_buffers.clear();
 	}
 
 	std::vector<bud::math::AABB> Renderer::get_mesh_bounds_snapshot() const {
@@ -114,9 +211,86 @@ namespace bud::graphics {
 		return result;
 	}
 
+	void Renderer::load_bindless_texture(uint32_t current_slot, const std::string& path) {
+		auto queue = upload_queue;
+		auto queue_weak = std::weak_ptr<UploadQueue>(upload_queue);
+		auto rhi_ptr = rhi;
+
+		{
+			std::lock_guard lock(queue->mutex);
+			queue->commands.push_back([rhi_ptr, current_slot]() {
+				rhi_ptr->update_bindless_texture(current_slot, rhi_ptr->get_fallback_texture());
+			});
+		}
+
+		auto tex_path = path;
+
+		// 发起异步加载
+		asset_manager->load_image_async(tex_path,
+			[this, queue_weak, rhi_ptr, current_slot, tex_path](bud::io::Image img) {
+				auto img_ptr = std::make_shared<bud::io::Image>(std::move(img));
+
+				// Scanned here on the worker: only textures with an alpha below 0.5 need the alpha-tested
+				// depth pipelines, everything else draws from the position stream alone
+				bool alpha_tested = false;
+				if (img_ptr->pixels) {
+					const size_t pixel_count = (size_t)img_ptr->width * img_ptr->height;
+					for (size_t p = 0; p < pixel_count && !alpha_tested; ++p) {
+						alpha_tested = img_ptr->pixels[p * 4 + 3] < 128;
+					}
+				}
+
+				auto queue_locked = queue_weak.lock();
+                        if (!queue_locked) {
+                            std::string err = "Renderer::load_bindless_texture upload queue was destroyed before callback";
+                            bud::eprint("{}", err);
+#if defined(_DEBUG)
+                            throw std::runtime_error(err);
+#else
+                            return;
+#endif
+                        }
+
+				std::lock_guard lock(queue_locked->mutex);
+				queue_locked->commands.push_back([this, rhi_ptr, current_slot, tex_path, img_ptr, alpha_tested]() {
+					bud::graphics::TextureDesc desc{};
+					desc.width = (uint32_t)img_ptr->width;
+					desc.height = (uint32_t)img_ptr->height;
+					desc.format = bud::graphics::TextureFormat::RGBA8_UNORM;
+					desc.mips = static_cast<uint32_t>(std::floor(std::log2(std::max(desc.width, desc.height)))) + 1;
+
+					auto tex = rhi_ptr->create_texture(desc, (const void*)img_ptr->pixels,
+						(uint64_t)img_ptr->width * img_ptr->height * 4);
+					rhi_ptr->set_debug_name(tex, ObjectType::Texture, tex_path);
+					rhi_ptr->update_bindless_texture(current_slot, tex);
+
+					if (alpha_tested_materials.size() <= current_slot)
+						alpha_tested_materials.resize(current_slot + 1, 1);
+					alpha_tested_materials[current_slot] = alpha_tested ? 1 : 0;
+
+					//bud::print("[Renderer] ✓ Texture BOUND: {} -> Slot {}", tex_path, current_slot);
+				});
+			}
+		);
+	}
+
+	uint32_t Renderer::upload_texture(const std::string& path) {
+		const uint32_t slot = next_bindless_slot.fetch_add(1, std::memory_order_relaxed);
+		load_bindless_texture(slot, path);
+		return slot;
+	}
+
+	void Renderer::set_foliage(std::shared_ptr<const FoliageSystem> foliage_system) {
+		std::lock_guard lock(upload_queue->mutex);
+		upload_queue->commands.push_back([this, foliage_system]() {
+			foliage = foliage_system;
+		});
+	}
+
 	MeshAssetHandle Renderer::upload_mesh(const bud::io::MeshData& mesh_data) {
-		if (mesh_data.vertices.empty()) {
-			std::string err = "Renderer::upload_mesh called with empty vertex list";
+		if (mesh_data.positions.empty() || mesh_data.attributes.size() != mesh_data.positions.size()) {
+			std::string err = std::format("Renderer::upload_mesh called with empty or mismatched vertex streams: positions={} attributes={}",
+				mesh_data.positions.size(), mesh_data.attributes.size());
 			bud::eprint("{}", err);
 #if defined(_DEBUG)
 			throw std::runtime_error(err);
@@ -134,8 +308,8 @@ namespace bud::graphics {
 		uint32_t base_material_id = 0;
 
 		bud::math::AABB cpu_aabb;
-		for (const auto& v : mesh_data.vertices) {
-			cpu_aabb.merge(bud::math::vec3(v.pos[0], v.pos[1], v.pos[2]));
+		for (const auto& p : mesh_data.positions) {
+			cpu_aabb.merge(bud::math::vec3(p[0], p[1], p[2]));
 		}
 
 		auto queue = upload_queue;
@@ -156,48 +330,7 @@ namespace bud::graphics {
 
 				//bud::print("  Texture[{}] '{}' -> Slot {}", i, mesh_data.texture_paths[i], current_slot);
 
-				{
-					std::lock_guard lock(queue->mutex);
-					queue->commands.push_back([rhi_ptr, current_slot]() {
-						rhi_ptr->update_bindless_texture(current_slot, rhi_ptr->get_fallback_texture());
-					});
-				}
-
-				auto tex_path = mesh_data.texture_paths[i];
-
-				// 发起异步加载
-				asset_manager->load_image_async(tex_path,
-					[queue_weak, rhi_ptr, current_slot, tex_path](bud::io::Image img) {
-						auto img_ptr = std::make_shared<bud::io::Image>(std::move(img));
-
-						auto queue_locked = queue_weak.lock();
-                        if (!queue_locked) {
-                            std::string err = "Renderer::upload_mesh upload queue was destroyed before callback";
-                            bud::eprint("{}", err);
-#if defined(_DEBUG)
-                            throw std::runtime_error(err);
-#else
-                            return;
-#endif
-                        }
-
-						std::lock_guard lock(queue_locked->mutex);
-						queue_locked->commands.push_back([rhi_ptr, current_slot, tex_path, img_ptr]() {
-							bud::graphics::TextureDesc desc{};
-							desc.width = (uint32_t)img_ptr->width;
-							desc.height = (uint32_t)img_ptr->height;
-							desc.format = bud::graphics::TextureFormat::RGBA8_UNORM;
-							desc.mips = static_cast<uint32_t>(std::floor(std::log2(std::max(desc.width, desc.height)))) + 1;
-
-							auto tex = rhi_ptr->create_texture(desc, (const void*)img_ptr->pixels,
-								(uint64_t)img_ptr->width * img_ptr->height * 4);
-							rhi_ptr->set_debug_name(tex, ObjectType::Texture, tex_path);
-							rhi_ptr->update_bindless_texture(current_slot, tex);
-
-							//bud::print("[Renderer] ✓ Texture BOUND: {} -> Slot {}", tex_path, current_slot);
-						});
-					}
-				);
+				load_bindless_texture(current_slot, mesh_data.texture_paths[i]);
 			}
 		}
 
@@ -225,9 +358,10 @@ namespace bud::graphics {
 				new_mesh.sphere.radius = bud::math::distance(cpu_aabb.max, new_mesh.sphere.center);
 				new_mesh.index_count = (uint32_t)mesh_data_copy->indices.size();
 
-				const uint32_t vertex_count = (uint32_t)mesh_data_copy->vertices.size();
+				const uint32_t vertex_count = (uint32_t)mesh_data_copy->vertex_count();
 				const uint32_t index_count  = (uint32_t)mesh_data_copy->indices.size();
-				const uint64_t v_size = vertex_count * sizeof(bud::io::MeshData::Vertex);
+				const uint64_t p_size = (uint64_t)vertex_count * bud::io::VERTEX_POSITION_STRIDE;
+				const uint64_t a_size = (uint64_t)vertex_count * bud::io::VERTEX_ATTRIBUTE_STRIDE;
 				const uint64_t i_size = index_count  * sizeof(uint32_t);
 
 				// Initialize Geometry Pool Mega-Buffers on first use
@@ -236,79 +370,196 @@ namespace bud::graphics {
 					geometry_pool.index_buffer  = rhi->create_gpu_buffer(GeometryPool::kIndexPoolSize,  ResourceState::IndexBuffer);
 					rhi->set_debug_name(geometry_pool.vertex_buffer, ObjectType::Buffer, "GeometryPool_Vertices");
 					rhi->set_debug_name(geometry_pool.index_buffer,  ObjectType::Buffer, "GeometryPool_Indices");
+					geometry_pool.meshlet_buffer      = rhi->create_gpu_buffer(GeometryPool::kMeshletPoolSize,     ResourceState::ShaderResource);
+					geometry_pool.meshlet_data_buffer = rhi->create_gpu_buffer(GeometryPool::kMeshletDataPoolSize, ResourceState::ShaderResource);
+					rhi->set_debug_name(geometry_pool.meshlet_buffer,      ObjectType::Buffer, "GeometryPool_Meshlets");
+					rhi->set_debug_name(geometry_pool.meshlet_data_buffer, ObjectType::Buffer, "GeometryPool_MeshletData");
+					geometry_pool.meshlet_lod_buffer  = rhi->create_gpu_buffer(GeometryPool::kMeshletLodPoolSize,  ResourceState::ShaderResource);
+					rhi->set_debug_name(geometry_pool.meshlet_lod_buffer,  ObjectType::Buffer, "GeometryPool_MeshletLod");
 					geometry_pool.initialized = true;
-					bud::print("[GeometryPool] Initialized: vertex={}MB index={}MB",
-						GeometryPool::kVertexPoolSize / (1024 * 1024),
-						GeometryPool::kIndexPoolSize  / (1024 * 1024));
+					bud::print("[GeometryPool] Initialized: position={}MB attribute={}MB index={}MB meshlet={}MB meshlet_data={}MB",
+						GeometryPool::kPositionStreamSize / (1024 * 1024),
+						GeometryPool::kAttributeStreamSize / (1024 * 1024),
+						GeometryPool::kIndexPoolSize  / (1024 * 1024),
+						GeometryPool::kMeshletPoolSize / (1024 * 1024),
+						GeometryPool::kMeshletDataPoolSize / (1024 * 1024));
 				}
 
-				// Atomically reserve contiguous region inside the pool
-				const uint32_t vertex_base = geometry_pool.next_vertex.fetch_add(vertex_count, std::memory_order_relaxed);
-				const uint32_t index_base  = geometry_pool.next_index .fetch_add(index_count,  std::memory_order_relaxed);
+				// Atomically reserve contiguous region inside the pool, a mesh that does not fit takes no space
+				uint32_t vertex_base = 0;
+				uint32_t index_base = 0;
+				if (!GeometryPool::try_reserve(geometry_pool.next_vertex, vertex_count, GeometryPool::kMaxVertices, vertex_base)) {
+					bud::eprint("[GeometryPool] Vertex streams full: mesh={} needs {} vertices at {}, capacity {}", assigned_mesh_id, vertex_count,
+						geometry_pool.next_vertex.load(std::memory_order_relaxed), GeometryPool::kMaxVertices);
+					return;
+				}
+				if (!GeometryPool::try_reserve(geometry_pool.next_index, index_count, GeometryPool::kMaxIndices, index_base)) {
+					bud::eprint("[GeometryPool] Index pool full: mesh={} needs {} indices at {}, capacity {}", assigned_mesh_id, index_count,
+						geometry_pool.next_index.load(std::memory_order_relaxed), GeometryPool::kMaxIndices);
+					// Hand the vertices back unless another mesh reserved behind them meanwhile
+					uint32_t vertex_end = vertex_base + vertex_count;
+					geometry_pool.next_vertex.compare_exchange_strong(vertex_end, vertex_base, std::memory_order_relaxed);
+					return;
+				}
 
-				const uint64_t vertex_pool_byte_offset = (uint64_t)vertex_base * sizeof(bud::io::MeshData::Vertex);
+				// Same vertex index into both streams, so vertex_offset works for either binding
+				const auto streams = geometry_pool.get_vertex_streams();
+				const uint64_t position_byte_offset  = (uint64_t)vertex_base * bud::io::VERTEX_POSITION_STRIDE;
+				const uint64_t attribute_byte_offset = (uint64_t)vertex_base * bud::io::VERTEX_ATTRIBUTE_STRIDE;
 				const uint64_t index_pool_byte_offset  = (uint64_t)index_base  * sizeof(uint32_t);
 
 				new_mesh.first_index   = index_base;
 				new_mesh.vertex_offset = (int32_t)vertex_base;
 
-				//bud::print("[GeometryPool] mesh={} vertex_offset={} first_index={} v_size={}B i_size={}B",
-				//	assigned_mesh_id, vertex_base, index_base, v_size, i_size);
+				//bud::print("[GeometryPool] mesh={} vertex_offset={} first_index={} p_size={}B a_size={}B i_size={}B",
+				//	assigned_mesh_id, vertex_base, index_base, p_size, a_size, i_size);
 
 				// Stage upload: CPU -> staging -> GPU pool
-                auto v_stage = rhi->get_allocator()->alloc_staging(v_size);
+                auto p_stage = rhi->get_allocator()->alloc_staging(p_size);
+                auto a_stage = rhi->get_allocator()->alloc_staging(a_size);
                 auto i_stage = rhi->get_allocator()->alloc_staging(i_size);
 
-				std::memcpy(v_stage.mapped_ptr, mesh_data_copy->vertices.data(), v_size);
-				std::memcpy(i_stage.mapped_ptr, mesh_data_copy->indices.data(),  i_size);
+				std::memcpy(p_stage.mapped_ptr, mesh_data_copy->positions.data(),  p_size);
+				std::memcpy(a_stage.mapped_ptr, mesh_data_copy->attributes.data(), a_size);
+				std::memcpy(i_stage.mapped_ptr, mesh_data_copy->indices.data(),    i_size);
 
-				rhi->copy_buffer_immediate_offset(v_stage, geometry_pool.vertex_buffer, v_size, 0, vertex_pool_byte_offset);
-				rhi->copy_buffer_immediate_offset(i_stage, geometry_pool.index_buffer,  i_size, 0, index_pool_byte_offset);
+				rhi->copy_buffer_immediate_offset(p_stage, streams.positions,  p_size, 0, position_byte_offset);
+				rhi->copy_buffer_immediate_offset(a_stage, streams.attributes, a_size, 0, attribute_byte_offset);
+				rhi->copy_buffer_immediate_offset(i_stage, geometry_pool.index_buffer, i_size, 0, index_pool_byte_offset);
 
-				rhi->destroy_buffer(v_stage);
+				rhi->destroy_buffer(p_stage);
+				rhi->destroy_buffer(a_stage);
 				rhi->destroy_buffer(i_stage);
 
 				// GPU-Driven Meshlet data upload
+				// Everything goes into the shared pools so one culling dispatch sees every meshlet:
+				//  - expanded triangle list per meshlet, appended to the index pool (mesh-relative, drawn with vertex_offset)
+				//  - GPUMeshlet bounds/cone + offsets in meshlet_buffer
+				//  - pool vertex indices + local triangle indices in meshlet_data_buffer (mesh shader path)
+				//  - cluster LOD bounds in meshlet_lod_buffer, flat meshlets get bounds that always pass the LOD test
 				if (!mesh_data_copy->meshlets.empty()) {
-					new_mesh.meshlet_count = (uint32_t)mesh_data_copy->meshlets.size();
-					uint64_t m_size = mesh_data_copy->meshlets.size() * sizeof(asset::MeshletDescriptor);
-					uint64_t mv_size = mesh_data_copy->meshlet_vertices.size() * sizeof(uint32_t);
-					uint64_t mt_size = mesh_data_copy->meshlet_triangles.size() * sizeof(uint32_t); // triangles are packed uint32
-					uint64_t mc_size = mesh_data_copy->meshlet_cull_data.size() * sizeof(asset::MeshletCullData);
-
-					new_mesh.meshlet_buffer = rhi->create_gpu_buffer(m_size, ResourceState::ShaderResource); // Read in compute
-					new_mesh.vertex_index_buffer = rhi->create_gpu_buffer(mv_size, ResourceState::ShaderResource);
-					new_mesh.meshlet_index_buffer = rhi->create_gpu_buffer(mt_size, ResourceState::ShaderResource);
-					new_mesh.cull_data_buffer = rhi->create_gpu_buffer(mc_size, ResourceState::ShaderResource);
-
-                    auto m_stage = rhi->get_allocator()->alloc_staging(m_size);
-                    auto mv_stage = rhi->get_allocator()->alloc_staging(mv_size);
-                    auto mt_stage = rhi->get_allocator()->alloc_staging(mt_size);
-                    auto mc_stage = rhi->get_allocator()->alloc_staging(mc_size);
-
-                    if (!m_stage.is_valid() || !m_stage.mapped_ptr || !mv_stage.is_valid() || !mv_stage.mapped_ptr ||
-                        !mt_stage.is_valid() || !mt_stage.mapped_ptr || !mc_stage.is_valid() || !mc_stage.mapped_ptr) {
-                        bud::eprint("[upload_mesh] ERROR: alloc_staging failed for meshlet data of mesh {}", assigned_mesh_id);
-                        if (m_stage.is_valid()) rhi->destroy_buffer(m_stage);
-                        if (mv_stage.is_valid()) rhi->destroy_buffer(mv_stage);
-                        if (mt_stage.is_valid()) rhi->destroy_buffer(mt_stage);
-                        if (mc_stage.is_valid()) rhi->destroy_buffer(mc_stage);
-                    } else {
-                        std::memcpy(m_stage.mapped_ptr, mesh_data_copy->meshlets.data(), m_size);
-                        std::memcpy(mv_stage.mapped_ptr, mesh_data_copy->meshlet_vertices.data(), mv_size);
-                        std::memcpy(mt_stage.mapped_ptr, mesh_data_copy->meshlet_triangles.data(), mt_size);
-                        std::memcpy(mc_stage.mapped_ptr, mesh_data_copy->meshlet_cull_data.data(), mc_size);
-
-                        rhi->copy_buffer_immediate(m_stage, new_mesh.meshlet_buffer, m_size);
-                        rhi->copy_buffer_immediate(mv_stage, new_mesh.vertex_index_buffer, mv_size);
-                        rhi->copy_buffer_immediate(mt_stage, new_mesh.meshlet_index_buffer, mt_size);
-                        rhi->copy_buffer_immediate(mc_stage, new_mesh.cull_data_buffer, mc_size);
-
-                        rhi->destroy_buffer(m_stage);
-                        rhi->destroy_buffer(mv_stage);
-                        rhi->destroy_buffer(mt_stage);
-                        rhi->destroy_buffer(mc_stage);
-                    }
+					const auto& src_meshlets = mesh_data_copy->meshlets;
+					const auto& src_cull = mesh_data_copy->meshlet_cull_data;
+					const auto& src_vertices = mesh_data_copy->meshlet_vertices;
+					const auto& src_triangles = mesh_data_copy->meshlet_triangles;
+
+					const uint32_t meshlet_count = (uint32_t)src_meshlets.size();
+					uint32_t expanded_count = 0;
+					uint32_t data_count = 0;
+					for (const auto& m : src_meshlets) {
+						expanded_count += m.triangle_count * 3;
+						data_count += m.vertex_count + m.triangle_count * 3;
+					}
+
+					// Meshlet and meshlet data counters only move under the lock, so both are checked before either is taken.
+					// The index pool is shared with the plain mesh uploads and reserved last, its failure leaves all three untouched.
+					uint32_t meshlet_base = 0;
+					uint32_t data_base = 0;
+					uint32_t expanded_base = 0;
+					bool fits = src_cull.size() >= src_meshlets.size();
+					if (fits) {
+						std::lock_guard lock(geometry_pool.meshlet_mutex);
+						meshlet_base = geometry_pool.next_meshlet.load(std::memory_order_relaxed);
+						data_base = geometry_pool.next_meshlet_data.load(std::memory_order_relaxed);
+						fits = (uint64_t)meshlet_base + meshlet_count <= GeometryPool::kMaxMeshlets
+							&& (uint64_t)data_base + data_count <= GeometryPool::kMaxMeshletData
+							&& GeometryPool::try_reserve(geometry_pool.next_index, expanded_count, GeometryPool::kMaxIndices, expanded_base);
+						if (fits) {
+							geometry_pool.next_meshlet.store(meshlet_base + meshlet_count, std::memory_order_relaxed);
+							geometry_pool.next_meshlet_data.store(data_base + data_count, std::memory_order_relaxed);
+						}
+					}
+
+					if (!fits) {
+						bud::eprint("[upload_mesh] Meshlet pools exhausted or cull data missing, mesh {} is drawn without meshlet culling", assigned_mesh_id);
+					}
+					else {
+						std::vector<GPUMeshlet> gpu_meshlets(meshlet_count);
+						std::vector<GPUMeshletLod> gpu_lods(meshlet_count);
+						const bool has_lods = mesh_data_copy->meshlet_lods.size() == meshlet_count;
+						std::vector<uint32_t> expanded_indices;
+						std::vector<uint32_t> meshlet_data;
+						expanded_indices.reserve(expanded_count);
+						meshlet_data.reserve(data_count);
+
+						for (uint32_t i = 0; i < meshlet_count; ++i) {
+							const auto& m = src_meshlets[i];
+							const auto& cull = src_cull[i];
+							auto& out = gpu_meshlets[i];
+
+							std::memcpy(out.sphere, cull.bounding_sphere, sizeof(out.sphere));
+							out.cone = (uint32_t)(uint8_t)cull.cone_axis[0]
+								| ((uint32_t)(uint8_t)cull.cone_axis[1] << 8)
+								| ((uint32_t)(uint8_t)cull.cone_axis[2] << 16)
+								| ((uint32_t)(uint8_t)cull.cone_cutoff << 24);
+							out.first_index = expanded_base + (uint32_t)expanded_indices.size();
+							out.index_count = m.triangle_count * 3;
+							out.data_offset = data_base + (uint32_t)meshlet_data.size();
+							out.vertex_count = m.vertex_count;
+							out.triangle_count = m.triangle_count;
+
+							auto& lod = gpu_lods[i];
+							if (has_lods) {
+								const auto& src_lod = mesh_data_copy->meshlet_lods[i];
+								lod.sphere[0] = src_lod.center[0]; lod.sphere[1] = src_lod.center[1]; lod.sphere[2] = src_lod.center[2];
+								lod.sphere[3] = src_lod.radius;
+								lod.parent_sphere[0] = src_lod.parent_center[0]; lod.parent_sphere[1] = src_lod.parent_center[1]; lod.parent_sphere[2] = src_lod.parent_center[2];
+								lod.parent_sphere[3] = src_lod.parent_radius;
+								lod.error = src_lod.error;
+								lod.parent_error = src_lod.parent_error;
+							}
+							else {
+								std::memcpy(lod.sphere, cull.bounding_sphere, sizeof(lod.sphere));
+								std::memcpy(lod.parent_sphere, cull.bounding_sphere, sizeof(lod.parent_sphere));
+								lod.error = 0.0f;
+								lod.parent_error = std::numeric_limits<float>::max();
+							}
+
+							for (uint32_t v = 0; v < m.vertex_count; ++v) {
+								meshlet_data.push_back(vertex_base + src_vertices[m.vertex_offset + v]);
+							}
+							for (uint32_t t = 0; t < m.triangle_count * 3; ++t) {
+								const uint32_t local = src_triangles[m.triangle_offset + t];
+								meshlet_data.push_back(local);
+								expanded_indices.push_back(src_vertices[m.vertex_offset + local]);
+							}
+						}
+
+						const uint64_t m_size = gpu_meshlets.size() * sizeof(GPUMeshlet);
+						const uint64_t l_size = gpu_lods.size() * sizeof(GPUMeshletLod);
+						const uint64_t d_size = meshlet_data.size() * sizeof(uint32_t);
+						const uint64_t e_size = expanded_indices.size() * sizeof(uint32_t);
+
+						auto m_stage = rhi->get_allocator()->alloc_staging(m_size);
+						auto d_stage = rhi->get_allocator()->alloc_staging(d_size);
+						auto e_stage = rhi->get_allocator()->alloc_staging(e_size);
+						auto l_stage = rhi->get_allocator()->alloc_staging(l_size);
+
+						if (!m_stage.is_valid() || !m_stage.mapped_ptr || !d_stage.is_valid() || !d_stage.mapped_ptr ||
+							!e_stage.is_valid() || !e_stage.mapped_ptr || !l_stage.is_valid() || !l_stage.mapped_ptr) {
+							bud::eprint("[upload_mesh] ERROR: alloc_staging failed for meshlet data of mesh {}", assigned_mesh_id);
+						}
+						else {
+							std::memcpy(m_stage.mapped_ptr, gpu_meshlets.data(), m_size);
+							std::memcpy(d_stage.mapped_ptr, meshlet_data.data(), d_size);
+							std::memcpy(e_stage.mapped_ptr, expanded_indices.data(), e_size);
+							std::memcpy(l_stage.mapped_ptr, gpu_lods.data(), l_size);
+
+							rhi->copy_buffer_immediate_offset(m_stage, geometry_pool.meshlet_buffer, m_size, 0, (uint64_t)meshlet_base * sizeof(GPUMeshlet));
+							rhi->copy_buffer_immediate_offset(d_stage, geometry_pool.meshlet_data_buffer, d_size, 0, (uint64_t)data_base * sizeof(uint32_t));
+							rhi->copy_buffer_immediate_offset(e_stage, geometry_pool.index_buffer, e_size, 0, (uint64_t)expanded_base * sizeof(uint32_t));
+							rhi->copy_buffer_immediate_offset(l_stage, geometry_pool.meshlet_lod_buffer, l_size, 0, (uint64_t)meshlet_base * sizeof(GPUMeshletLod));
+
+							new_mesh.first_meshlet = meshlet_base;
+							new_mesh.meshlet_count = meshlet_count;
+							if (has_lods) cluster_lod_mesh_count++;
+						}
+
+						if (m_stage.is_valid()) rhi->destroy_buffer(m_stage);
+						if (d_stage.is_valid()) rhi->destroy_buffer(d_stage);
+						if (e_stage.is_valid()) rhi->destroy_buffer(e_stage);
+						if (l_stage.is_valid()) rhi->destroy_buffer(l_stage);
+					}
 				}
 
 				if (!mesh_data_copy->subsets.empty()) {
@@ -321,6 +572,7 @@ namespace bud::graphics {
 						sub.index_count = subset.index_count;
 						sub.meshlet_start = subset.meshlet_start;
 						sub.meshlet_count = subset.meshlet_count;
+						sub.lod_meshlet_count = subset.lod_meshlet_count;
 
 						if (subset.material_index < texture_slot_map.size()) {
 							sub.material_id = texture_slot_map[subset.material_index];
@@ -397,22 +649,45 @@ namespace bud::graphics {
 
 
 
-	void Renderer::render(const bud::graphics::RenderScene& render_scene, SceneView& scene_view) {
+	void Renderer::render(const bud::graphics::RenderScene& render_scene, SceneView& scene_view, const std::vector<SecondaryView>& secondary_views) {
+		ZoneScoped;
+
 		// 先处理所有挂起的上传任务
 		flush_upload_queue();
 
+		// Meshes are only ever appended, a new count means new rows
+		if (submesh_table.mesh_count() != meshes.size()) {
+			submesh_table.rebuild(meshes);
+		}
+
 		// 重置当前帧统计数据
 		rhi->get_render_stats() = {};
 
+		// HLOD regions were picked during extraction, the scene only carries their counts
+		{
+			auto& stats = rhi->get_render_stats();
+			stats.hlod_regions = render_scene.hlod_stats.regions;
+			stats.hlod_regions_active = render_scene.hlod_stats.regions_active;
+			stats.hlod_draws_saved = render_scene.hlod_stats.draws_saved;
+			stats.hlod_triangles_saved = render_scene.hlod_stats.triangles_saved;
+		}
+
+		bud::frame_stats::PhaseTimer phase_timer;
+
 		size_t instance_count = render_scene.instance_count.load(std::memory_order_relaxed);
 		const uint32_t cascade_count = std::min(render_config.cascade_count, (uint32_t)MAX_CASCADES);
 		uint32_t total_shadow_casters = 0;
 		uint32_t total_shadow_caster_submeshes = 0;
-		size_t visible_count = 0;
+		size_t visible_count = 0;       // Main view draws, the prefix of sort_list
+		size_t shared_draw_count = 0;   // Main view draws + draws only secondary views see
 		size_t visible_instance_count = 0;
 		size_t total_draw_count = 0;
 		std::vector<std::vector<uint32_t>> culled_results(1 + cascade_count);
 
+		scene_view.view_index = 0;
+		const uint32_t secondary_count = std::min(static_cast<uint32_t>(secondary_views.size()), MAX_VIEWS - 1);
+		bud::math::Frustum multi_view_frustums[MAX_VIEWS]; // [0] = main view, [v] = secondary_views[v - 1]
+
 		if (instance_count > 0) {
 			update_cascades(scene_view, render_config, render_scene.scene_bounds);
 
@@ -421,7 +696,17 @@ namespace bud::graphics {
 
 			auto& main_visible_instances = culled_results[0];
 			main_visible_instances.clear();
-			render_scene.cull_frustum(view_frustums[0], main_visible_instances);
+			if (secondary_count > 0) {
+				// One traversal for every view: culled_results[0] becomes the union, view_masks says who sees what
+				multi_view_frustums[0] = view_frustums[0];
+				for (uint32_t v = 0; v < secondary_count; ++v) {
+					multi_view_frustums[v + 1].update(secondary_views[v].view.view_proj_matrix);
+				}
+				view_masks.clear();
+				render_scene.cull_frustums(multi_view_frustums, 1 + secondary_count, main_visible_instances, view_masks);
+			} else {
+				render_scene.cull_frustum(view_frustums[0], main_visible_instances);
+			}
 
 			if (cascade_count == 0) {
 				total_shadow_casters = static_cast<uint32_t>(main_visible_instances.size());
@@ -443,10 +728,16 @@ namespace bud::graphics {
 							render_scene.cull_frustum(view_frustums[result_index], visible_instances);
 							
 							// Count submesh-level shadow casters
+							uint32_t caster_submeshes = 0;
 							for (uint32_t instance : visible_instances) {
 								uint32_t mesh_id = render_scene.mesh_indices[instance];
-								const auto& mesh = meshes[mesh_id];
-								total_shadow_caster_submeshes += static_cast<uint32_t>(mesh.submeshes.size());
+								if (mesh_id < submesh_table.mesh_count())
+									caster_submeshes += submesh_table.mesh_row_count[mesh_id];
+							}
+							std::atomic_ref(total_shadow_caster_submeshes).fetch_add(caster_submeshes, std::memory_order_relaxed);
+
+							if (render_config.enable_pass_sort_keys) {
+								sort_shadow_casters(render_scene, visible_instances, shadow_sort_lists[cascade_idx]);
 							}
 						}
 					},
@@ -459,117 +750,131 @@ namespace bud::graphics {
 					total_shadow_casters += (uint32_t)culled_results[v].size();
 				}
 			}
+			phase_timer.lap(bud::frame_stats::FramePhase::Culling);
 
 			const bud::math::Frustum& main_camera_frustum = view_frustums[0];
 
 			const auto& visible_instances = culled_results[0];
 			visible_instance_count = visible_instances.size();
 			total_draw_count = 0;
-			std::vector<uint32_t> draw_offsets(visible_instance_count + 1);
+			// Per visible instance: its row range in the flat submesh table and its first slot in sort_list
+			visible_submesh_ranges.resize(visible_instance_count);
+			draw_offsets.resize(visible_instance_count + 1);
 			for (size_t k = 0; k < visible_instance_count; ++k) {
-				uint32_t i = visible_instances[k];
-				uint32_t mesh_id = render_scene.mesh_indices[i];
-				const auto& mesh = meshes[mesh_id];
-				uint32_t sub_idx = render_scene.submesh_indices[i];
-
+				visible_submesh_ranges[k] = get_submesh_range(render_scene, submesh_table, visible_instances[k]);
 				draw_offsets[k] = (uint32_t)total_draw_count;
-				if (sub_idx == bud::asset::INVALID_INDEX) {
-					total_draw_count += (uint32_t)mesh.submeshes.size();
-				} else {
-					total_draw_count += 1;
-				}
+				total_draw_count += visible_submesh_ranges[k].count;
 			}
 			draw_offsets[visible_instance_count] = (uint32_t)total_draw_count;
 
+			// Every slot below total_draw_count is written by the key generation, culled rows as UINT64_MAX
 			if (sort_list.size() < total_draw_count)
 				sort_list.resize(total_draw_count);
 
-			if (total_draw_count > 0) {
-				SortItem invalid_item{};
-				invalid_item.key = UINT64_MAX;
-				invalid_item.entity_index = UINT32_MAX;
-				invalid_item.submesh_index = UINT32_MAX;
-				std::fill(sort_list.begin(), sort_list.begin() + total_draw_count, invalid_item);
-			}
-
 			bud::threading::Counter key_gen_signal;
 			constexpr size_t KEY_GEN_CHUNK_SIZE = 256;
 
+			KeyGenView key_view;
+			key_view.frustum = main_camera_frustum;
+			key_view.camera_position = scene_view.camera_position;
+			key_view.far_plane = scene_view.far_plane;
+			if (secondary_count > 0) {
+				key_view.secondary_frustums = multi_view_frustums + 1;
+				key_view.view_masks = view_masks.data();
+			}
+
 			task_scheduler->ParallelFor(visible_instance_count, KEY_GEN_CHUNK_SIZE,
 				[&](size_t start_exclusive, size_t end_exclusive) {
-					for (size_t k = start_exclusive; k < end_exclusive; ++k) {
-						uint32_t i = visible_instances[k];
-						uint32_t draw_start = draw_offsets[k];
-						uint32_t draw_end = draw_offsets[k + 1];
-						uint32_t draw_count = draw_end - draw_start;
-
-						if (draw_count == 0)
-							continue;
-
-						const auto& world_matrix = render_scene.world_matrices[i];
-						uint32_t mesh_id = render_scene.mesh_indices[i];
-						const auto& mesh = meshes[mesh_id];
-						uint32_t sub_idx_original = render_scene.submesh_indices[i];
-
-						auto mesh_pos = bud::math::vec3(world_matrix[3]);
-						auto distance = bud::math::distance2(mesh_pos, scene_view.camera_position);
-
-						uint32_t depth_key = 0;
-						auto depth_normalized = std::clamp(distance / (scene_view.far_plane * scene_view.far_plane), 0.0f, 1.0f);
-						depth_key = static_cast<uint32_t>(depth_normalized * 0x3FFFF);
-
-						if (sub_idx_original != bud::asset::INVALID_INDEX) {
-							auto& item = sort_list[draw_start];
-							item.entity_index = (uint32_t)i;
-							item.submesh_index = sub_idx_original;
-							
-							if (sub_idx_original < mesh.submeshes.size()) {
-								const auto& sub = mesh.submeshes[sub_idx_original];
-								auto world_sub_aabb = sub.aabb.transform(world_matrix);
-								if (!bud::math::intersect_aabb_frustum(world_sub_aabb, main_camera_frustum)) {
-									item.key = UINT64_MAX;
-									continue;
-								}
-								item.key = DrawKey::generate_opaque(0, 0, sub.material_id, mesh_id, depth_key);
-							} else {
-								uint32_t material_id = render_scene.material_indices[i];
-								item.key = DrawKey::generate_opaque(0, 0, material_id, mesh_id, depth_key);
-							}
-						} else {
-							// Explode!
-							for (uint32_t s = 0; s < (uint32_t)mesh.submeshes.size(); ++s) {
-								auto& item = sort_list[draw_start + s];
-								const auto& sub = mesh.submeshes[s];
-								auto world_sub_aabb = sub.aabb.transform(world_matrix);
-								if (!bud::math::intersect_aabb_frustum(world_sub_aabb, main_camera_frustum)) {
-									item.key = UINT64_MAX;
-									item.entity_index = (uint32_t)i;
-									item.submesh_index = s;
-									continue;
-								}
-
-								item.entity_index = (uint32_t)i;
-								item.submesh_index = s;
-								item.key = DrawKey::generate_opaque(0, 0, sub.material_id, mesh_id, depth_key);
-							}
-						}
-					}
+					generate_submesh_keys(render_scene, submesh_table, key_view, visible_instances.data(), visible_submesh_ranges.data(),
+						draw_offsets.data(), start_exclusive, end_exclusive, sort_list.data());
 				},
 				&key_gen_signal
 			);
 
 			task_scheduler->wait_for_counter(key_gen_signal);
 
-			std::sort(sort_list.begin(), sort_list.begin() + total_draw_count,
+			// remove_if keeps the survivors in culling order, the baseline below counts exactly the draws that get sorted
+			auto end_it = std::remove_if(sort_list.begin(), sort_list.begin() + total_draw_count, [](const SortItem& a) { return a.key == UINT64_MAX; });
+			sort_list.erase(end_it, sort_list.end()); // REMOVES INVALID ITEMS!
+
+			// The sorted count only covers the main view, secondary-only draws (layer 1) stay out of the baseline too
+			auto& sort_stats = rhi->get_render_stats();
+			constexpr uint32_t opaque_slot = static_cast<uint32_t>(SortKeyPass::Opaque);
+			sort_stats.sort_state_changes_unsorted[opaque_slot] = count_state_changes<OpaqueKeySchema>(sort_list.data(), sort_list.size(),
+				[](const SortItem& a) { return OpaqueKeySchema::extract<KeyField::Layer>(a.key) == 0; });
+
+			std::sort(sort_list.begin(), sort_list.end(),
 				[](const SortItem& a, const SortItem& b) { return a.key < b.key; }
 			);
 
-			auto end_it = std::remove_if(sort_list.begin(), sort_list.begin() + total_draw_count, [](const SortItem& a) { return a.key == UINT64_MAX; });
-			sort_list.erase(end_it, sort_list.end()); // REMOVES INVALID ITEMS!
-			visible_count = sort_list.size();
+			shared_draw_count = sort_list.size();
+			visible_count = shared_draw_count;
+			if (secondary_count > 0) {
+				// Layer is the most significant field, the main view's draws sort ahead of the secondary-only ones
+				auto main_end = std::partition_point(sort_list.begin(), sort_list.end(),
+					[](const SortItem& a) { return OpaqueKeySchema::extract<KeyField::Layer>(a.key) == 0; });
+				visible_count = static_cast<size_t>(main_end - sort_list.begin());
+
+				instance_view_masks.assign(render_scene.size(), 0);
+				for (size_t k = 0; k < visible_instance_count; ++k) {
+					instance_view_masks[visible_instances[k]] = view_masks[k];
+				}
+
+				if (view_draw_lists.size() < secondary_count) view_draw_lists.resize(secondary_count);
+				bud::threading::Counter view_filter_counter;
+				task_scheduler->ParallelFor(secondary_count, 1,
+					[&](size_t start, size_t end) {
+						for (size_t v = start; v < end; ++v) {
+							filter_view_draws(render_scene, submesh_table, multi_view_frustums[v + 1], static_cast<uint32_t>(v + 1),
+								instance_view_masks, sort_list, shared_draw_count, view_draw_lists[v]);
+						}
+					},
+					&view_filter_counter
+				);
+				task_scheduler->wait_for_counter(view_filter_counter);
+			}
+			sort_stats.sort_state_changes[opaque_slot] = count_state_changes<OpaqueKeySchema>(sort_list.data(), visible_count);
+
+			sort_stats.view_count = 1 + secondary_count;
+			sort_stats.shared_draws = static_cast<uint32_t>(shared_draw_count);
+			sort_stats.view_draws[0] = static_cast<uint32_t>(visible_count);
+			for (uint32_t v = 0; v < secondary_count; ++v) {
+				sort_stats.view_draws[v + 1] = static_cast<uint32_t>(view_draw_lists[v].items.size());
+			}
+
+			// Indirect-count shadow path: explode the union of cascade casters once, the GPU
+			// then compacts it into one draw list per cascade (see ShadowCullingPass).
+			shadow_draw_list.clear();
+			if (use_indirect_count(rhi, render_config) && cascade_count > 0 && visible_count > 0) {
+				shadow_caster_mask.assign(render_scene.size(), 0);
+				for (uint32_t c = 1; c <= cascade_count; ++c) {
+					for (uint32_t instance : culled_results[c]) {
+						if (instance >= shadow_caster_mask.size() || shadow_caster_mask[instance]) continue;
+						shadow_caster_mask[instance] = 1;
+
+						uint32_t mesh_id = render_scene.mesh_indices[instance];
+						if (mesh_id >= meshes.size() || !meshes[mesh_id].is_valid()) continue;
+						uint32_t sub_idx = render_scene.submesh_indices[instance];
+
+						if (sub_idx != bud::asset::INVALID_INDEX) {
+							shadow_draw_list.push_back({ 0, instance, sub_idx });
+						} else if (submesh_table.mesh_row_count[mesh_id] == 0) {
+							shadow_draw_list.push_back({ 0, instance, UINT32_MAX });
+						} else {
+							for (uint32_t sub = 0; sub < submesh_table.mesh_row_count[mesh_id]; ++sub) {
+								shadow_draw_list.push_back({ 0, instance, sub });
+							}
+						}
+					}
+				}
+			}
 		}
 
+		phase_timer.lap(bud::frame_stats::FramePhase::Sort);
+
+		// Fence wait + image acquire, throttled by the swapchain like present
 		auto cmd = rhi->begin_frame();
+		phase_timer.lap(bud::frame_stats::FramePhase::Present);
 		if (!cmd) {
 			render_graph.reset(); // Release any transient textures acquired during this frame's setup
 			return;
@@ -581,33 +886,196 @@ namespace bud::graphics {
 		auto back_buffer = render_graph.import_texture("Backbuffer", swapchain_tex, ResourceState::RenderTarget);
 		
 		uint32_t current_idx = rhi->get_current_image_index();
+
+		// Dynamic resolution: the main view draws into an output-sized target (no reallocation when the scale moves)
+		// and UpscalePass composites it. The scale has to be final before the first pass captures the view.
+		RGHandle scene_color = back_buffer;
+		scene_view.render_scale = 1.0f;
+		if (render_config.enable_dynamic_resolution && upscale_pass->is_ready() && swapchain_tex) {
+			if (scene_color_targets.size() <= current_idx) {
+				scene_color_targets.resize(current_idx + 1, nullptr);
+			}
+
+			auto& target = scene_color_targets[current_idx];
+			if (target && (target->width != swapchain_tex->width || target->height != swapchain_tex->height)) {
+				if (auto* pool = rhi->get_resource_pool()) pool->release_texture(target);
+				target = nullptr;
+			}
+			if (!target) {
+				TextureDesc desc;
+				desc.width = swapchain_tex->width;
+				desc.height = swapchain_tex->height;
+				desc.format = bud::graphics::TextureFormat::BGRA8_SRGB;
+				target = rhi->create_texture(desc, nullptr, 0);
+			}
+
+			if (target) {
+				scene_color = render_graph.import_texture("SceneColor", target, ResourceState::Undefined);
+				// GPU time of the frame that last used this slot, the CPU frame time only without timestamp queries
+				const float gpu_frame_ms = rhi->get_render_stats().gpu_timer_ms[static_cast<uint32_t>(GPUTimer::Frame)];
+				const bool gpu_timed = gpu_frame_ms > 0.0f;
+				scene_view.render_scale = update_render_scale(gpu_timed ? gpu_frame_ms : scene_view.delta_time * 1000.0f);
+
+				const auto& state = dynamic_resolution;
+				auto& stats = rhi->get_render_stats();
+				stats.dynamic_resolution = true;
+				stats.render_scale = scene_view.render_scale;
+				stats.render_width = scaled_extent(swapchain_tex->width, scene_view.render_scale);
+				stats.render_height = scaled_extent(swapchain_tex->height, scene_view.render_scale);
+				stats.dynres_target_ms = render_config.dynamic_resolution_target_ms;
+				stats.dynres_frame_ms = state.smoothed_ms;
+				stats.dynres_gpu_timed = gpu_timed;
+				stats.dynres_adherence = state.frames > 0 ? 100.0f * static_cast<float>(state.frames_in_budget) / static_cast<float>(state.frames) : 0.0f;
+				stats.dynres_frames_over_budget = static_cast<uint32_t>(state.frames - state.frames_in_budget);
+				std::copy(std::begin(state.history), std::end(state.history), std::begin(stats.render_scale_history));
+				stats.render_scale_history_offset = state.history_head;
+			}
+		} else {
+			dynamic_resolution = {};
+		}
 		RGHandle rg_draw;
 		RGHandle rg_inst;
 		RGHandle rg_stats;
 		RGHandle rg_instance_data;
+		RGHandle rg_shadow_draws;
+		RGHandle rg_shadow_indirect;
+
+		RGHandle rg_meshlet_indirect;
+		RGHandle rg_meshlet_visible;
+		uint32_t meshlet_record_count = 0;
+		// The visibility buffer rasterizes the instance-level list, meshlet records are not needed then
+		const bool visibility_path = use_visibility_buffer(rhi, render_config) && visibility_pass->is_ready();
+		const bool meshlet_culling = !visibility_path && use_meshlet_culling(rhi, render_config) && geometry_pool.meshlet_buffer.is_valid();
+		const bool mesh_shader_path = meshlet_culling && use_mesh_shader_path(rhi, render_config) && main_pass->has_mesh_pipeline();
+
+		// Pixel error against the render resolution, so dynamic resolution coarsens the cut along with it
+		float cluster_lod_error_scale = 0.0f;
+		if (meshlet_culling && render_config.enable_cluster_lod && cluster_lod_mesh_count > 0 && swapchain_tex) {
+			const float view_height = static_cast<float>(scaled_extent(swapchain_tex->height, scene_view.render_scale));
+			cluster_lod_error_scale = bud::cluster_lod::get_error_scale(scene_view.proj_matrix[1][1], view_height, render_config.cluster_lod_pixel_error);
+		}
+		const bool cluster_lod = cluster_lod_error_scale > 0.0f;
 
-		struct DrawData {
-			uint32_t indexCount;
-			uint32_t firstIndex;
-			int32_t vertexOffset;
-			uint32_t materialId;
-			bud::math::vec3 min;
-			uint32_t meshId;
-			bud::math::vec3 max;
-			uint32_t padding1;
-			uint32_t meshletCount;
-			uint32_t padding2[3];
+		const size_t shadow_draw_count = shadow_draw_list.size();
+		// Shadow caster draw slots are appended after the main view slots
+		const size_t required_capacity = total_draw_count + shadow_draw_count;
+		auto indirect_buffer_size = [](uint32_t capacity, uint32_t lists) {
+			return INDIRECT_COUNT_HEADER_SIZE + static_cast<uint64_t>(capacity) * lists * sizeof(IndirectCommand);
 		};
 
+		// Clustered lighting: lights are uploaded every frame, the assignment either runs in LightClusteringPass
+		// or as the CPU reference, uploaded into the device-local grid buffer of this frame slot
+		RGHandle rg_light_clusters;
+		scene_view.local_light_count = 0;
+		const uint32_t local_light_count = render_config.enable_clustered_lighting
+			? static_cast<uint32_t>(std::min<size_t>(render_scene.local_lights.size(), MAX_LOCAL_LIGHTS)) : 0u;
+		if (local_light_count > 0) {
+			if (local_light_buffers.size() <= current_idx) {
+				local_light_buffers.resize(current_idx + 1);
+				light_cluster_buffers.resize(current_idx + 1);
+				light_cluster_readback_buffers.resize(current_idx + 1);
+				light_cluster_validations.resize(current_idx + 1);
+			}
+
+			auto& current_light_buf = local_light_buffers[current_idx];
+			auto& current_cluster_buf = light_cluster_buffers[current_idx];
+			if (!current_light_buf.is_valid()) {
+				current_light_buf = rhi->create_gpu_buffer(MAX_LOCAL_LIGHTS * sizeof(GPULocalLight), ResourceState::ShaderResource);
+				rhi->set_debug_name(current_light_buf, ObjectType::Buffer, "LocalLights_Frame" + std::to_string(current_idx));
+			}
+			if (!current_cluster_buf.is_valid()) {
+				current_cluster_buf = rhi->create_gpu_buffer(LIGHT_CLUSTER_BUFFER_SIZE, ResourceState::UnorderedAccess);
+				rhi->set_debug_name(current_cluster_buf, ObjectType::Buffer, "LightClusterGrid_Frame" + std::to_string(current_idx));
+			}
+
+			// Only the stats header comes back, unless the whole grid is checked against the CPU reference
+			const uint64_t readback_size = render_config.validate_light_clusters ? LIGHT_CLUSTER_BUFFER_SIZE : LIGHT_CLUSTER_HEADER_SIZE;
+			if (readback_size > current_light_cluster_readback_size) {
+				rhi->wait_idle();
+				for (auto& buf : light_cluster_readback_buffers)
+					if (buf.is_valid())
+						rhi->destroy_buffer(buf);
+				light_cluster_readback_buffers.assign(light_cluster_readback_buffers.size(), {});
+				for (auto& validation : light_cluster_validations)
+					validation.pending = false;
+				current_light_cluster_readback_size = readback_size;
+			}
+			auto& current_readback_buf = light_cluster_readback_buffers[current_idx];
+			if (!current_readback_buf.is_valid()) {
+				current_readback_buf = rhi->create_gpu_buffer(current_light_cluster_readback_size, ResourceState::TransferDst, MemoryUsage::Readback);
+				rhi->set_debug_name(current_readback_buf, ObjectType::Buffer, "LightClusterReadback_Frame" + std::to_string(current_idx));
+			}
+
+			if (current_light_buf.is_valid() && current_cluster_buf.is_valid() && current_readback_buf.is_valid() && current_readback_buf.mapped_ptr) {
+				auto light_staging = rhi->get_allocator()->alloc_staging(local_light_count * sizeof(GPULocalLight));
+				std::memcpy(light_staging.mapped_ptr, render_scene.local_lights.data(), local_light_count * sizeof(GPULocalLight));
+				rhi->copy_buffer_immediate(light_staging, current_light_buf, local_light_count * sizeof(GPULocalLight));
+				rhi->destroy_buffer(light_staging);
+
+				auto& stats = rhi->get_render_stats();
+				LightClusterStats cluster_stats{};
+				const bool gpu_assignment = render_config.cluster_lights_on_gpu && light_cluster_pass->is_ready();
+				auto& validation = light_cluster_validations[current_idx];
+				if (gpu_assignment) {
+					// Readback of the last time this frame slot ran (guaranteed finished), same latency as GPUStats
+					std::memcpy(&cluster_stats, current_readback_buf.mapped_ptr, sizeof(LightClusterStats));
+					stats.light_assign_path = 2;
+
+					if (validation.pending && render_config.validate_light_clusters) {
+						light_cluster_reference.assign(LIGHT_CLUSTER_BUFFER_SIZE, 0);
+						assign_lights_to_clusters(validation.lights, validation.light_count, validation.view, light_cluster_reference.data());
+						stats.light_cluster_mismatches = count_light_cluster_mismatches(light_cluster_reference.data(), current_readback_buf.mapped_ptr);
+						stats.light_cluster_validated = 1;
+					}
+					validation.pending = render_config.validate_light_clusters;
+					if (validation.pending) {
+						validation.view = scene_view;
+						validation.lights.assign(render_scene.local_lights.begin(), render_scene.local_lights.begin() + local_light_count);
+						validation.light_count = local_light_count;
+					}
+				} else {
+					validation.pending = false;
+					auto assign_start = std::chrono::high_resolution_clock::now();
+					auto grid_staging = rhi->get_allocator()->alloc_staging(LIGHT_CLUSTER_BUFFER_SIZE);
+					cluster_stats = assign_lights_to_clusters(render_scene.local_lights, local_light_count, scene_view, grid_staging.mapped_ptr);
+					rhi->copy_buffer_immediate(grid_staging, current_cluster_buf, LIGHT_CLUSTER_BUFFER_SIZE);
+					rhi->destroy_buffer(grid_staging);
+					stats.light_assign_cpu_ms = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - assign_start).count();
+					stats.light_assign_path = 1;
+				}
+
+				stats.local_lights = local_light_count;
+				stats.light_cluster_refs = cluster_stats.total_refs;
+				stats.light_clusters_active = cluster_stats.active_clusters;
+				stats.light_cluster_max = cluster_stats.max_lights;
+				stats.light_cluster_overflow = cluster_stats.overflow_clusters;
+
+				// Every pass captures the view by value, the count has to be in place before the first add_to_graph
+				scene_view.local_light_count = local_light_count;
+				rhi->update_global_light_data(current_light_buf, current_cluster_buf);
+
+				if (gpu_assignment) {
+					auto rg_local_lights = render_graph.import_buffer("LocalLights", current_light_buf, ResourceState::ShaderResource);
+					auto rg_grid = render_graph.import_buffer("LightClusterGrid", current_cluster_buf, ResourceState::UnorderedAccess);
+					rg_light_clusters = light_cluster_pass->add_to_graph(render_graph, rg_local_lights, rg_grid, scene_view, local_light_count,
+						current_readback_buf, current_light_cluster_readback_size);
+				} else {
+					rg_light_clusters = render_graph.import_buffer("LightClusterGrid", current_cluster_buf, ResourceState::ShaderResource);
+				}
+			}
+		}
+
 		if (instance_count > 0) {
 			if (instance_data_ssbos.size() <= current_idx) {
 				instance_data_ssbos.resize(current_idx + 1);
 				indirect_instance_buffers.resize(current_idx + 1);
 				indirect_draw_buffers.resize(current_idx + 1);
 				stats_readback_buffers.resize(current_idx + 1);
+				shadow_draw_buffers.resize(current_idx + 1);
+				shadow_indirect_buffers.resize(current_idx + 1);
 			}
 
-			if (total_draw_count > current_indirect_capacity) {
+			if (required_capacity > current_indirect_capacity) {
 				rhi->wait_idle();
 				for (auto& buf : indirect_instance_buffers)
 					if (buf.is_valid())
@@ -618,56 +1086,78 @@ namespace bud::graphics {
 				for (auto& buf : stats_readback_buffers)
 					if (buf.is_valid())
 						rhi->destroy_buffer(buf);
+				for (auto& buf : shadow_draw_buffers)
+					if (buf.is_valid())
+						rhi->destroy_buffer(buf);
+				for (auto& buf : shadow_indirect_buffers)
+					if (buf.is_valid())
+						rhi->destroy_buffer(buf);
 				for (auto& buf : instance_data_ssbos)
 					if (buf.is_valid())
 						rhi->destroy_buffer(buf);
 
 				constexpr uint32_t kCapacityHeadroom = 1024;
-				current_indirect_capacity = std::max(current_indirect_capacity * 2, static_cast<uint32_t>(total_draw_count) + kCapacityHeadroom);
+				current_indirect_capacity = std::max(current_indirect_capacity * 2, static_cast<uint32_t>(required_capacity) + kCapacityHeadroom);
 
 				for (size_t i = 0; i < instance_data_ssbos.size(); ++i) {
-					instance_data_ssbos[i] = rhi->create_gpu_buffer(current_indirect_capacity * sizeof(InstanceData), ResourceState::ShaderResource);
+					instance_data_ssbos[i] = rhi->create_gpu_buffer(instance_data_size(current_indirect_capacity, current_indirect_capacity), ResourceState::ShaderResource);
 					rhi->set_debug_name(instance_data_ssbos[i], ObjectType::Buffer, "GlobalInstanceData_Frame" + std::to_string(i));
 					
 					if (render_config.enable_gpu_driven) {
-						indirect_instance_buffers[i] = rhi->create_gpu_buffer(current_indirect_capacity * sizeof(DrawData), ResourceState::UnorderedAccess);
-						indirect_draw_buffers[i] = rhi->create_gpu_buffer(current_indirect_capacity * sizeof(IndirectCommand), ResourceState::IndirectArgument);
-						stats_readback_buffers[i] = rhi->create_gpu_buffer(1024, ResourceState::UnorderedAccess);
+						indirect_instance_buffers[i] = rhi->create_gpu_buffer(current_indirect_capacity * sizeof(GPUDrawData), ResourceState::UnorderedAccess);
+						indirect_draw_buffers[i] = rhi->create_gpu_buffer(indirect_buffer_size(current_indirect_capacity, 1), ResourceState::IndirectArgument);
+						stats_readback_buffers[i] = rhi->create_gpu_buffer(1024, ResourceState::UnorderedAccess, MemoryUsage::Readback);
 						
 						rhi->set_debug_name(indirect_instance_buffers[i], ObjectType::Buffer, "IndirectInstanceData_Frame" + std::to_string(i));
 						rhi->set_debug_name(indirect_draw_buffers[i], ObjectType::Buffer, "IndirectDrawCommands_Frame" + std::to_string(i));
 						rhi->set_debug_name(stats_readback_buffers[i], ObjectType::Buffer, "GPUStatsReadback_Frame" + std::to_string(i));
+
+						if (use_indirect_count(rhi, render_config)) {
+							shadow_draw_buffers[i] = rhi->create_gpu_buffer(current_indirect_capacity * sizeof(GPUDrawData), ResourceState::UnorderedAccess);
+							shadow_indirect_buffers[i] = rhi->create_gpu_buffer(indirect_buffer_size(current_indirect_capacity, MAX_CASCADES), ResourceState::IndirectArgument);
+							rhi->set_debug_name(shadow_draw_buffers[i], ObjectType::Buffer, "ShadowDrawData_Frame" + std::to_string(i));
+							rhi->set_debug_name(shadow_indirect_buffers[i], ObjectType::Buffer, "ShadowIndirectCommands_Frame" + std::to_string(i));
+						}
 					}
 				}
 			}
 
 			// Ensure current frame buffer is valid even if capacity didn't change (e.g. first frame if capacity > total_draw_count)
 			if (!instance_data_ssbos[current_idx].is_valid()) {
-				if (current_indirect_capacity == 0) current_indirect_capacity = std::max<uint32_t>(static_cast<uint32_t>(total_draw_count) + 1024u, 1024u);
-				instance_data_ssbos[current_idx] = rhi->create_gpu_buffer(current_indirect_capacity * sizeof(InstanceData), ResourceState::ShaderResource);
+				if (current_indirect_capacity == 0) current_indirect_capacity = std::max<uint32_t>(static_cast<uint32_t>(required_capacity) + 1024u, 1024u);
+				instance_data_ssbos[current_idx] = rhi->create_gpu_buffer(instance_data_size(current_indirect_capacity, current_indirect_capacity), ResourceState::ShaderResource);
 				rhi->set_debug_name(instance_data_ssbos[current_idx], ObjectType::Buffer, "GlobalInstanceData_Frame" + std::to_string(current_idx));
 			}
 
-			// Common Instance Data Upload
-			if (visible_count > 0) {
-                auto instance_staging = rhi->get_allocator()->alloc_staging(visible_count * sizeof(InstanceData));
-				InstanceData* inst_mapped = static_cast<InstanceData*>(instance_staging.mapped_ptr);
-				for (size_t i = 0; i < visible_count; ++i) {
-					const auto& item = sort_list[i];
-					uint32_t entity_idx = item.entity_index;
-					const auto& mesh = meshes[render_scene.mesh_indices[entity_idx]];
-
-					inst_mapped[i].model = render_scene.world_matrices[entity_idx];
-					if (item.submesh_index != UINT32_MAX && item.submesh_index < mesh.submeshes.size()) {
-						inst_mapped[i].material_id = mesh.submeshes[item.submesh_index].material_id;
-					}
-					else {
-						inst_mapped[i].material_id = render_scene.material_indices[entity_idx];
-					}
-				}
-				rhi->copy_buffer_immediate(instance_staging, instance_data_ssbos[current_idx], visible_count * sizeof(InstanceData));
+			// Common Instance Data Upload: one draw slot per draw (main view, secondary-only draws, then shadow casters), one 3x4
+			// transform per entity however many submesh and shadow draws reference it. Secondary views read it too, so it
+			// is uploaded whenever any view has draws, the main view may see none of them
+			if (shared_draw_count > 0) {
+				instance_builder.begin(render_scene.world_matrices.size());
+				instance_builder.add_draws(render_scene, meshes, sort_list.data(), shared_draw_count);
+				instance_builder.add_draws(render_scene, meshes, shadow_draw_list.data(), shadow_draw_count);
+
+				const uint64_t instance_data_bytes = instance_builder.get_size();
+				auto instance_staging = rhi->get_allocator()->alloc_staging(instance_data_bytes);
+				instance_builder.write(render_scene, instance_staging.mapped_ptr);
+				rhi->copy_buffer_immediate(instance_staging, instance_data_ssbos[current_idx], instance_data_bytes);
 				rhi->destroy_buffer(instance_staging);
 				rg_instance_data = render_graph.import_buffer("GlobalInstanceData", instance_data_ssbos[current_idx], ResourceState::ShaderResource);
+
+				const uint64_t draw_slots = instance_builder.get_draw_count();
+				const uint64_t draw_record_slots = render_config.enable_gpu_driven ? draw_slots : 0;
+				const uint64_t draw_buffer_count = render_config.enable_gpu_driven ? (use_indirect_count(rhi, render_config) ? 2 : 1) : 0;
+				const uint64_t frame_slots = instance_data_ssbos.size();
+
+				auto& stats = rhi->get_render_stats();
+				stats.gpu_draw_slots = instance_builder.get_draw_count();
+				stats.gpu_instances = instance_builder.get_instance_count();
+				stats.instance_upload_bytes = instance_data_bytes + draw_record_slots * sizeof(GPUDrawData);
+				stats.instance_upload_legacy_bytes = draw_slots * LEGACY_INSTANCE_RECORD_SIZE + draw_record_slots * LEGACY_DRAW_RECORD_SIZE;
+				stats.instance_memory_bytes = frame_slots * (instance_data_size(current_indirect_capacity, current_indirect_capacity)
+					+ draw_buffer_count * current_indirect_capacity * sizeof(GPUDrawData));
+				stats.instance_memory_legacy_bytes = frame_slots * current_indirect_capacity
+					* (LEGACY_INSTANCE_RECORD_SIZE + draw_buffer_count * LEGACY_DRAW_RECORD_SIZE);
 			}
 
 			if (render_config.enable_gpu_driven) {
@@ -677,61 +1167,98 @@ namespace bud::graphics {
 					auto& current_stats_buf = stats_readback_buffers[current_idx];
 
 					if ((!current_inst_buf.is_valid() || !current_draw_buf.is_valid()) && current_indirect_capacity == 0) {
-						current_indirect_capacity = std::max<uint32_t>(static_cast<uint32_t>(total_draw_count) + 1024u, 1024u);
+						current_indirect_capacity = std::max<uint32_t>(static_cast<uint32_t>(required_capacity) + 1024u, 1024u);
 					}
 
 					if (!current_inst_buf.is_valid()) {
-						current_inst_buf = rhi->create_gpu_buffer(current_indirect_capacity * sizeof(DrawData), ResourceState::UnorderedAccess);
+						current_inst_buf = rhi->create_gpu_buffer(current_indirect_capacity * sizeof(GPUDrawData), ResourceState::UnorderedAccess);
 						rhi->set_debug_name(current_inst_buf, ObjectType::Buffer, "IndirectInstanceData_Frame" + std::to_string(current_idx));
 					}
 					if (!current_draw_buf.is_valid()) {
-						current_draw_buf = rhi->create_gpu_buffer(current_indirect_capacity * sizeof(IndirectCommand), ResourceState::IndirectArgument);
+						current_draw_buf = rhi->create_gpu_buffer(indirect_buffer_size(current_indirect_capacity, 1), ResourceState::IndirectArgument);
 						rhi->set_debug_name(current_draw_buf, ObjectType::Buffer, "IndirectDrawCommands_Frame" + std::to_string(current_idx));
 					}
 					if (!current_stats_buf.is_valid()) {
-						current_stats_buf = rhi->create_gpu_buffer(1024, ResourceState::UnorderedAccess);
+						current_stats_buf = rhi->create_gpu_buffer(1024, ResourceState::UnorderedAccess, MemoryUsage::Readback);
 						rhi->set_debug_name(current_stats_buf, ObjectType::Buffer, "GPUStatsReadback_Frame" + std::to_string(current_idx));
 					}
 
-                    auto staging = rhi->get_allocator()->alloc_staging(visible_count * sizeof(DrawData));
-					DrawData* mapped = static_cast<DrawData*>(staging.mapped_ptr);
+                    auto staging = rhi->get_allocator()->alloc_staging(visible_count * sizeof(GPUDrawData));
+					GPUDrawData* mapped = static_cast<GPUDrawData*>(staging.mapped_ptr);
+					// Cluster LOD meshes hand the culling pass every level, it keeps the cut of the main view
 					for (size_t i = 0; i < visible_count; ++i) {
-						const auto& item = sort_list[i];
-						uint32_t entity_idx = item.entity_index;
-						uint32_t mesh_id = render_scene.mesh_indices[entity_idx];
-						const auto& mesh = meshes[mesh_id];
-
-						if (item.submesh_index != UINT32_MAX && item.submesh_index < mesh.submeshes.size()) {
-							const auto& sub = mesh.submeshes[item.submesh_index];
-							mapped[i].indexCount = sub.index_count;
-							mapped[i].firstIndex = mesh.first_index + sub.index_start;
-							mapped[i].vertexOffset = mesh.vertex_offset;
-							mapped[i].materialId = sub.material_id;
-							mapped[i].meshId = mesh_id;
-							
-							auto world_aabb = sub.aabb.transform(render_scene.world_matrices[entity_idx]);
-							mapped[i].min = world_aabb.min;
-							mapped[i].max = world_aabb.max;
-							mapped[i].meshletCount = sub.meshlet_count;
-						} else {
-							mapped[i].indexCount = mesh.index_count;
-							mapped[i].firstIndex = mesh.first_index;
-							mapped[i].vertexOffset = mesh.vertex_offset;
-							mapped[i].materialId = render_scene.material_indices[entity_idx];
-							mapped[i].meshId = mesh_id;
-
-							auto world_aabb = mesh.aabb.transform(render_scene.world_matrices[entity_idx]);
-							mapped[i].min = world_aabb.min;
-							mapped[i].max = world_aabb.max;
-							mapped[i].meshletCount = mesh.meshlet_count;
-						}
+						fill_draw_data(mapped[i], render_scene, meshes, sort_list[i], cluster_lod);
+						// One record per meshlet, meshlet-less draws take a single record
+						mapped[i].record_base = meshlet_record_count;
+						meshlet_record_count += std::max(mapped[i].meshlet_count_flags & DRAW_PACKED_VALUE_MASK, 1u);
 					}
-					rhi->copy_buffer_immediate(staging, current_inst_buf, visible_count * sizeof(DrawData));
+					rhi->copy_buffer_immediate(staging, current_inst_buf, visible_count * sizeof(GPUDrawData));
 					rhi->destroy_buffer(staging);
 
 					rg_inst = render_graph.import_buffer("IndirectInstanceData", current_inst_buf, ResourceState::UnorderedAccess);
 					rg_draw = render_graph.import_buffer("IndirectDrawCommands", current_draw_buf, ResourceState::IndirectArgument);
 					rg_stats = render_graph.import_buffer("GPUStatsReadback", current_stats_buf, ResourceState::UnorderedAccess);
+
+					if (meshlet_culling && meshlet_record_count > 0) {
+						if (meshlet_indirect_buffers.size() <= current_idx) {
+							meshlet_indirect_buffers.resize(current_idx + 1);
+							meshlet_visible_buffers.resize(current_idx + 1);
+						}
+
+						if (meshlet_record_count > current_meshlet_capacity) {
+							rhi->wait_idle();
+							for (auto& buf : meshlet_indirect_buffers)
+								if (buf.is_valid())
+									rhi->destroy_buffer(buf);
+							for (auto& buf : meshlet_visible_buffers)
+								if (buf.is_valid())
+									rhi->destroy_buffer(buf);
+							meshlet_indirect_buffers.assign(meshlet_indirect_buffers.size(), {});
+							meshlet_visible_buffers.assign(meshlet_visible_buffers.size(), {});
+
+							constexpr uint32_t kMeshletCapacityHeadroom = 4096;
+							current_meshlet_capacity = std::max(current_meshlet_capacity * 2, meshlet_record_count + kMeshletCapacityHeadroom);
+						}
+
+						auto& current_meshlet_ind_buf = meshlet_indirect_buffers[current_idx];
+						auto& current_meshlet_vis_buf = meshlet_visible_buffers[current_idx];
+						if (!current_meshlet_ind_buf.is_valid()) {
+							current_meshlet_ind_buf = rhi->create_gpu_buffer(indirect_buffer_size(current_meshlet_capacity, 1), ResourceState::IndirectArgument);
+							rhi->set_debug_name(current_meshlet_ind_buf, ObjectType::Buffer, "MeshletIndirectCommands_Frame" + std::to_string(current_idx));
+						}
+						if (!current_meshlet_vis_buf.is_valid()) {
+							// 16 byte header (visible count) + uvec2 {meshlet, instance} per entry
+							current_meshlet_vis_buf = rhi->create_gpu_buffer(16 + static_cast<uint64_t>(current_meshlet_capacity) * 2 * sizeof(uint32_t), ResourceState::UnorderedAccess, MemoryUsage::GpuOnly);
+							rhi->set_debug_name(current_meshlet_vis_buf, ObjectType::Buffer, "MeshletVisibleList_Frame" + std::to_string(current_idx));
+						}
+
+						rg_meshlet_indirect = render_graph.import_buffer("MeshletIndirectCommands", current_meshlet_ind_buf, ResourceState::IndirectArgument);
+						rg_meshlet_visible = render_graph.import_buffer("MeshletVisibleList", current_meshlet_vis_buf, ResourceState::UnorderedAccess);
+					}
+
+					if (shadow_draw_count > 0) {
+						auto& current_shadow_draw_buf = shadow_draw_buffers[current_idx];
+						auto& current_shadow_ind_buf = shadow_indirect_buffers[current_idx];
+						if (!current_shadow_draw_buf.is_valid()) {
+							current_shadow_draw_buf = rhi->create_gpu_buffer(current_indirect_capacity * sizeof(GPUDrawData), ResourceState::UnorderedAccess);
+							rhi->set_debug_name(current_shadow_draw_buf, ObjectType::Buffer, "ShadowDrawData_Frame" + std::to_string(current_idx));
+						}
+						if (!current_shadow_ind_buf.is_valid()) {
+							current_shadow_ind_buf = rhi->create_gpu_buffer(indirect_buffer_size(current_indirect_capacity, MAX_CASCADES), ResourceState::IndirectArgument);
+							rhi->set_debug_name(current_shadow_ind_buf, ObjectType::Buffer, "ShadowIndirectCommands_Frame" + std::to_string(current_idx));
+						}
+
+						auto shadow_staging = rhi->get_allocator()->alloc_staging(shadow_draw_count * sizeof(GPUDrawData));
+						GPUDrawData* shadow_mapped = static_cast<GPUDrawData*>(shadow_staging.mapped_ptr);
+						for (size_t i = 0; i < shadow_draw_count; ++i) {
+							fill_draw_data(shadow_mapped[i], render_scene, meshes, shadow_draw_list[i]);
+						}
+						rhi->copy_buffer_immediate(shadow_staging, current_shadow_draw_buf, shadow_draw_count * sizeof(GPUDrawData));
+						rhi->destroy_buffer(shadow_staging);
+
+						rg_shadow_draws = render_graph.import_buffer("ShadowDrawData", current_shadow_draw_buf, ResourceState::UnorderedAccess);
+						rg_shadow_indirect = render_graph.import_buffer("ShadowIndirectCommands", current_shadow_ind_buf, ResourceState::IndirectArgument);
+					}
 				}
 
 				// Read back previous frame stats (delayed latency) from this exact buffer which is guaranteed finished
@@ -807,6 +1334,28 @@ namespace bud::graphics {
 					rhi->get_render_stats().gpu_visible_triangles = last_gpu_stats.visibleTriangles;
 					rhi->get_render_stats().gpu_total_meshlets = last_gpu_stats.totalMeshlets;
 					rhi->get_render_stats().gpu_visible_meshlets = last_gpu_stats.visibleMeshlets;
+					rhi->get_render_stats().gpu_compacted_draws = use_indirect_count(rhi, render_config) ? last_gpu_stats.visibleInstances : 0;
+					rhi->get_render_stats().gpu_shadow_total_draws = last_gpu_stats.shadowTotalDraws;
+					rhi->get_render_stats().gpu_shadow_visible_draws = last_gpu_stats.shadowVisibleDraws;
+
+					auto& stats = rhi->get_render_stats();
+					stats.occlusion_tested = last_gpu_stats.totalInstances;
+					stats.occlusion_culled = last_gpu_stats.totalInstances > last_gpu_stats.visibleInstances
+						? last_gpu_stats.totalInstances - last_gpu_stats.visibleInstances : 0;
+					if (rg_meshlet_indirect.is_valid()) {
+						stats.meshlet_cull_path = mesh_shader_path ? 2u : 1u;
+						stats.gpu_meshlets_tested = last_gpu_stats.meshletsTested;
+						stats.gpu_meshlets_culled_frustum = last_gpu_stats.meshletsCulledFrustum;
+						stats.gpu_meshlets_culled_cone = last_gpu_stats.meshletsCulledCone;
+						stats.gpu_meshlets_culled_occlusion = last_gpu_stats.meshletsCulledOcclusion;
+						stats.gpu_meshlets_culled_lod = last_gpu_stats.meshletsCulledLod;
+						stats.cluster_lod_meshes = render_config.enable_cluster_lod ? cluster_lod_mesh_count : 0;
+						stats.gpu_triangles_culled = last_gpu_stats.totalTriangles > last_gpu_stats.meshletTrianglesVisible
+							? last_gpu_stats.totalTriangles - last_gpu_stats.meshletTrianglesVisible : 0;
+					} else {
+						stats.gpu_triangles_culled = last_gpu_stats.totalTriangles > last_gpu_stats.visibleTriangles
+							? last_gpu_stats.totalTriangles - last_gpu_stats.visibleTriangles : 0;
+					}
 				} else {
 					last_gpu_stats = {};
 					rhi->get_render_stats().gpu_total_instances = 0;
@@ -841,18 +1390,78 @@ namespace bud::graphics {
 			rhi->get_render_stats().shadow_caster_submeshes = total_shadow_caster_submeshes;
 
 			bool has_main_pass = false;
+			RGHandle shadow_map;
+			std::vector<RGHandle> view_targets; // Per secondary view, filled by add_secondary_views
 			if (rg_instance_data.is_valid()) {
 				rhi->update_global_instance_data(instance_data_ssbos[current_idx]);
 			}
 			if (visible_count > 0) {
 				// Z-Prepass ALWAYS uses CPU frustum-culling (visible_count) regardless of GPU-driven settings,
 				// as it must generate the depth buffer for Hi-Z culling itself.
-				auto depth_prepass = z_prepass->add_to_graph(render_graph, back_buffer, render_scene, scene_view, render_config, meshes, sort_list, visible_count, geometry_pool.vertex_buffer, geometry_pool.index_buffer);
+				// With occluder selection only the top-K occluders are drawn; the forward main pass
+				// writes depth itself, the visibility raster doesn't and keeps the full prepass.
+				const std::vector<SortItem>* prepass_list = &sort_list;
+				size_t prepass_count = visible_count;
+				if (render_config.enable_occluder_selection && !visibility_path) {
+					auto& stats = rhi->get_render_stats();
+					occluder_selector.adapt_budget(stats.gpu_timer_ms[static_cast<uint32_t>(GPUTimer::ZPrepass)], render_config);
+					occluder_selector.select(render_scene, meshes, sort_list, visible_count, scene_view, render_config, task_scheduler, occluder_list);
+					if (!occluder_list.empty()) {
+						prepass_list = &occluder_list;
+						prepass_count = occluder_list.size();
+					}
+
+					const auto& selection = occluder_selector.get_stats();
+					stats.occluder_count = selection.selected;
+					stats.occluder_triangles = selection.triangles;
+					stats.occluder_candidates = selection.candidates;
+					stats.occluder_budget = selection.budget;
+					stats.occluder_estimated_occluded = selection.estimated_occluded;
+					stats.occluder_select_ms = selection.select_ms;
+				} else {
+					occluder_selector.reset();
+				}
+
+				// Cluster LOD draws stay out of the prepass: its depth of the source meshlets would reject the coarser
+				// cut in the main pass and Hi-Z cull it, since a simplified surface may sit slightly behind the source
+				if (cluster_lod) {
+					cluster_lod_prepass_list.clear();
+					for (size_t i = 0; i < prepass_count; ++i) {
+						if (!is_cluster_lod_draw(render_scene, meshes, (*prepass_list)[i])) cluster_lod_prepass_list.push_back((*prepass_list)[i]);
+					}
+					prepass_list = &cluster_lod_prepass_list;
+					prepass_count = cluster_lod_prepass_list.size();
+				}
+
+				if (render_config.enable_pass_sort_keys) {
+					// The occluder list is already front to back by nearest depth, its rank is a finer depth than the opaque key's
+					const bool ranked = prepass_list == &occluder_list;
+					build_prepass_list(*prepass_list, prepass_count, ranked);
+					prepass_list = &prepass_sort_list;
+				}
+
+				MeshletDrawInputs meshlet_inputs;
+				auto depth_prepass = z_prepass->add_to_graph(render_graph, scene_color, render_scene, scene_view, render_config, meshes, *prepass_list, prepass_count, geometry_pool.get_vertex_streams(), geometry_pool.index_buffer, alpha_tested_materials);
 				
 				if (depth_prepass.is_valid()) {
 					if (render_config.enable_gpu_driven) {
-						auto rg_hiz = hiz_mip_pass->add_to_graph(render_graph, depth_prepass, render_config);
-						hiz_pass->add_to_graph(render_graph, rg_inst, rg_draw, rg_stats, rg_hiz, scene_view, (uint32_t)visible_count);
+						auto rg_hiz = hiz_mip_pass->add_to_graph(render_graph, depth_prepass, render_config, scene_view.render_scale);
+						hiz_pass->add_to_graph(render_graph, rg_inst, rg_draw, rg_stats, rg_hiz, scene_view, render_config, (uint32_t)visible_count);
+
+						if (rg_meshlet_indirect.is_valid() && rg_meshlet_visible.is_valid() && rg_instance_data.is_valid()) {
+							auto meshlet_cmds = meshlet_cull_pass->add_to_graph(render_graph, rg_inst, rg_meshlet_indirect, rg_meshlet_visible, rg_stats, rg_hiz, rg_instance_data,
+								geometry_pool.meshlet_buffer, geometry_pool.meshlet_lod_buffer, render_config, visible_count, current_meshlet_capacity, mesh_shader_path,
+								cluster_lod_error_scale, scene_view.near_plane);
+							if (meshlet_cmds.is_valid()) {
+								meshlet_inputs.draw_buffer = meshlet_cmds;
+								meshlet_inputs.visible_buffer = rg_meshlet_visible;
+								meshlet_inputs.record_capacity = current_meshlet_capacity;
+								meshlet_inputs.mesh_shader_path = mesh_shader_path;
+								if (mesh_shader_path) {
+									rhi->update_global_meshlet_data(geometry_pool.meshlet_buffer, geometry_pool.meshlet_data_buffer, geometry_pool.vertex_buffer, meshlet_visible_buffers[current_idx]);
+								}
+							}
+						}
 
 						if (render_config.debug_hiz) {
 							hiz_debug_pass->add_to_graph(render_graph, back_buffer, rg_hiz, render_config.debug_hiz_mip);
@@ -862,18 +1471,87 @@ namespace bud::graphics {
 					std::vector<std::vector<uint32_t>> csm_visible_instances(cascade_count);
 					for (uint32_t i = 0; i < cascade_count; ++i) csm_visible_instances[i] = std::move(culled_results[i + 1]);
 
-					auto shadow_map = csm_pass->add_to_graph(render_graph, scene_view, render_config, render_scene, meshes, std::move(csm_visible_instances), geometry_pool.vertex_buffer, geometry_pool.index_buffer);
+					RGHandle shadow_cmds;
+					if (rg_shadow_draws.is_valid() && rg_shadow_indirect.is_valid() && rg_stats.is_valid()) {
+						shadow_cmds = shadow_cull_pass->add_to_graph(render_graph, rg_shadow_draws, rg_shadow_indirect, rg_stats, render_config,
+							shadow_draw_count, current_indirect_capacity, static_cast<uint32_t>(shared_draw_count));
+					}
+
+					shadow_map = csm_pass->add_to_graph(render_graph, scene_view, render_config, render_scene, meshes, std::move(csm_visible_instances), geometry_pool.get_vertex_streams(), geometry_pool.index_buffer,
+						alpha_tested_materials, shadow_cmds, shadow_cmds.is_valid() ? current_indirect_capacity : 0);
+
+					// Foliage rides on the entity passes: its casters go on top of the CSM map (drawn every frame, so the
+					// static cascade cache never holds them) and its instances after the main view's opaque draws
+					const bool has_foliage = shadow_map.is_valid() && prepare_foliage(scene_view, cascade_count, current_idx);
+					if (has_foliage && !foliage_shadow_draws.empty()) {
+						shadow_map = foliage_pass->add_shadow_to_graph(render_graph, shadow_map, scene_view, render_config, meshes, *foliage,
+							foliage_shadow_draws, foliage_shadow_first_instances, foliage_instance_buffers[current_idx], geometry_pool.get_vertex_streams(), geometry_pool.index_buffer);
+					}
 					if (shadow_map.is_valid()) {
 						if (render_config.enable_cluster_visualization) {
-							cluster_viz_pass->add_to_graph(render_graph, back_buffer, depth_prepass, render_scene, scene_view, render_config, meshes, sort_list, visible_count, rg_draw, rg_instance_data, geometry_pool.vertex_buffer, geometry_pool.index_buffer);
+							cluster_viz_pass->add_to_graph(render_graph, scene_color, depth_prepass, render_scene, scene_view, render_config, meshes, sort_list, visible_count, rg_draw, rg_instance_data, geometry_pool.get_vertex_streams(), geometry_pool.index_buffer,
+								rg_light_clusters);
+						} else if (visibility_path && rg_draw.is_valid() && rg_inst.is_valid() && rg_instance_data.is_valid()) {
+							// 12 KB of bin counters + one packed pixel per backbuffer texel
+							const uint64_t resolve_size = VISIBILITY_RESOLVE_HEADER_SIZE + static_cast<uint64_t>(swapchain_tex->width) * swapchain_tex->height * sizeof(uint32_t);
+							if (visibility_resolve_buffers.size() <= current_idx) {
+								visibility_resolve_buffers.resize(current_idx + 1);
+							}
+							if (resolve_size > current_visibility_resolve_size) {
+								rhi->wait_idle();
+								for (auto& buf : visibility_resolve_buffers)
+									if (buf.is_valid())
+										rhi->destroy_buffer(buf);
+								visibility_resolve_buffers.assign(visibility_resolve_buffers.size(), {});
+								current_visibility_resolve_size = resolve_size;
+							}
+
+							auto& current_resolve_buf = visibility_resolve_buffers[current_idx];
+							if (!current_resolve_buf.is_valid()) {
+								current_resolve_buf = rhi->create_gpu_buffer(current_visibility_resolve_size, ResourceState::UnorderedAccess);
+								rhi->set_debug_name(current_resolve_buf, ObjectType::Buffer, "VisibilityResolve_Frame" + std::to_string(current_idx));
+							}
+							auto rg_resolve = render_graph.import_buffer("VisibilityResolve", current_resolve_buf, ResourceState::UnorderedAccess);
+
+							visibility_pass->add_to_graph(render_graph, shadow_map, scene_color, depth_prepass, scene_view, render_config, visible_count,
+								rg_draw, rg_inst, rg_instance_data, rg_resolve, geometry_pool.get_vertex_streams(), geometry_pool.index_buffer, rg_light_clusters);
+							rhi->get_render_stats().main_view_path = 1;
 						} else {
-							main_pass->add_to_graph(render_graph, shadow_map, back_buffer, depth_prepass, render_scene, scene_view, render_config, meshes, sort_list, visible_count, rg_draw, rg_instance_data, geometry_pool.vertex_buffer, geometry_pool.index_buffer);
+							main_pass->add_to_graph(render_graph, shadow_map, scene_color, depth_prepass, render_scene, scene_view, render_config, meshes, sort_list, visible_count, rg_draw, rg_instance_data, geometry_pool.get_vertex_streams(), geometry_pool.index_buffer, meshlet_inputs,
+								rg_light_clusters);
+						}
+
+						if (has_foliage) {
+							foliage_pass->add_to_graph(render_graph, shadow_map, scene_color, depth_prepass, scene_view, meshes, *foliage, foliage_draws,
+								foliage_instance_buffers[current_idx], 0, geometry_pool.get_vertex_streams(), geometry_pool.index_buffer, rg_light_clusters);
 						}
 						has_main_pass = true;
 					}
 				}
 			}
 
+			// Secondary views only depend on their own draw lists. When the main view sees nothing the cascades are
+			// still drawn for them, on the CPU lists since the GPU shadow lists are only built with main view draws.
+			if (secondary_count > 0 && rg_instance_data.is_valid()) {
+				if (visible_count == 0) {
+					std::vector<std::vector<uint32_t>> csm_visible_instances(cascade_count);
+					for (uint32_t i = 0; i < cascade_count; ++i) csm_visible_instances[i] = std::move(culled_results[i + 1]);
+					shadow_map = csm_pass->add_to_graph(render_graph, scene_view, render_config, render_scene, meshes, std::move(csm_visible_instances), geometry_pool.get_vertex_streams(), geometry_pool.index_buffer,
+						alpha_tested_materials, {}, 0);
+				}
+				if (shadow_map.is_valid()) {
+					add_secondary_views(render_graph, shadow_map, render_scene, scene_view, secondary_views, secondary_count, rg_instance_data, current_idx, view_targets);
+				}
+			}
+
+			// Every pass has generated its keys by now
+			rhi->get_render_stats().sort_key_overflows = DrawKey::take_overflows();
+
+			if (has_main_pass && scene_color != back_buffer) {
+				upscale_pass->add_to_graph(render_graph, scene_color, back_buffer, scene_view, render_config);
+			}
+
+			// Cleared before the overlays, which may be all there is to see
 			if (!has_main_pass) {
 				render_graph.add_pass("UI Clear Pass",
 					[=](RGBuilder& builder) { builder.write(back_buffer, ResourceState::RenderTarget); },
@@ -887,6 +1565,25 @@ namespace bud::graphics {
 					}
 				);
 			}
+
+			// Overlays go on top of the composited main view
+			for (size_t v = 0; v < view_targets.size(); ++v) {
+				const auto& secondary = secondary_views[v];
+				if (!view_targets[v].is_valid() || secondary.overlay_width == 0 || secondary.overlay_height == 0) continue;
+
+				const RGHandle view_color = view_targets[v];
+				render_graph.add_pass("Secondary View Overlay",
+					[=](RGBuilder& builder) {
+						builder.read(view_color, ResourceState::TransferSrc);
+						builder.write(back_buffer, ResourceState::TransferDst);
+						return back_buffer;
+					},
+					[this, view_color, back_buffer, secondary](RHI* rhi, CommandHandle cmd) {
+						rhi->cmd_blit_image(cmd, render_graph.get_texture(view_color), render_graph.get_texture(back_buffer),
+							secondary.overlay_x, secondary.overlay_y, secondary.overlay_width, secondary.overlay_height);
+					}
+				);
+			}
 		} else {
 			render_graph.add_pass("Empty Scene Clear",
 				[=](RGBuilder& builder) { builder.write(back_buffer, ResourceState::RenderTarget); },
@@ -901,14 +1598,65 @@ namespace bud::graphics {
 			);
 		}
 
+		// Frame capture: the scene without the overlay. Declared as a write so the UI pass, which only orders
+		// after the last writer, cannot run before the copy
+		BufferHandle capture_buffer;
+		const uint32_t capture_main_view_path = rhi->get_render_stats().main_view_path;
+		if (capture_requested.exchange(false)) {
+			capture_buffer = rhi->create_gpu_buffer(static_cast<uint64_t>(swapchain_tex->width) * swapchain_tex->height * 4, ResourceState::TransferDst, MemoryUsage::Readback);
+			if (capture_buffer.is_valid()) {
+				render_graph.add_pass("Frame Capture",
+					[&](RGBuilder& builder) {
+						builder.write(back_buffer, ResourceState::TransferSrc);
+						builder.set_side_effect();
+					},
+					[this, back_buffer, capture_buffer](RHI* rhi, CommandHandle cmd) {
+						rhi->cmd_copy_texture_to_buffer(cmd, render_graph.get_texture(back_buffer), capture_buffer);
+					}
+				);
+			}
+		}
+
 		ui_pass->add_to_graph(render_graph, back_buffer);
 		render_graph.compile();
 
 		rhi->resource_barrier(cmd, swapchain_tex, ResourceState::Undefined, ResourceState::RenderTarget);
+		rhi->cmd_begin_gpu_timer(cmd, GPUTimer::Frame);
 		render_graph.execute(cmd);
+		rhi->cmd_end_gpu_timer(cmd, GPUTimer::Frame);
 		rhi->resource_barrier(cmd, swapchain_tex, ResourceState::RenderTarget, ResourceState::Present);
-		rhi->end_frame(cmd);
+		phase_timer.lap(bud::frame_stats::FramePhase::Record);
+		rhi->end_frame(cmd); // Submit and Present are charged inside the RHI
 		render_graph.reset();
+
+		if (capture_buffer.is_valid()) {
+			// Captures are rare (tests, benchmark comparisons), a full stall keeps the buffer out of the frame slots
+			rhi->wait_idle();
+			FrameCapture capture;
+			capture.width = swapchain_tex->width;
+			capture.height = swapchain_tex->height;
+			capture.format = swapchain_tex->format;
+			capture.main_view_path = capture_main_view_path;
+			capture.pixels.resize(capture_buffer.size);
+			std::memcpy(capture.pixels.data(), capture_buffer.mapped_ptr, capture.pixels.size());
+			rhi->destroy_buffer(capture_buffer);
+
+			std::lock_guard lock(capture_mutex);
+			pending_capture = std::move(capture);
+		}
+	}
+
+	void Renderer::request_capture() {
+		capture_requested.store(true);
+	}
+
+	bool Renderer::take_capture(FrameCapture& out) {
+		std::lock_guard lock(capture_mutex);
+		if (!pending_capture)
+			return false;
+		out = std::move(*pending_capture);
+		pending_capture.reset();
+		return true;
 	}
 
 
@@ -921,6 +1669,226 @@ namespace bud::graphics {
 		return render_config;
 	}
 
+	float Renderer::update_render_scale(float frame_ms) {
+		auto& state = dynamic_resolution;
+		const float min_scale = std::clamp(render_config.dynamic_resolution_min_scale, 0.25f, 1.0f);
+		const float max_scale = std::clamp(render_config.dynamic_resolution_max_scale, min_scale, 1.0f);
+		const float target_ms = std::max(render_config.dynamic_resolution_target_ms, 1.0f);
+
+		if (frame_ms > 0.0f) {
+			state.smoothed_ms = state.smoothed_ms > 0.0f ? state.smoothed_ms + (frame_ms - state.smoothed_ms) * 0.1f : frame_ms;
+			state.frames += 1;
+			if (frame_ms <= target_ms) state.frames_in_budget += 1;
+
+			// Cost follows the pixel count (scale^2); hold inside the band so the scale does not oscillate
+			if (state.smoothed_ms > target_ms || state.smoothed_ms < target_ms * 0.85f) {
+				float desired = state.scale * std::sqrt(target_ms / state.smoothed_ms);
+				// Drop fast to get back under budget, climb slowly
+				state.scale += std::clamp(desired - state.scale, -0.05f, 0.02f);
+			}
+		}
+		state.scale = std::clamp(state.scale, min_scale, max_scale);
+
+		state.history[state.history_head] = state.scale;
+		state.history_head = (state.history_head + 1) % RENDER_SCALE_HISTORY_SIZE;
+		return state.scale;
+	}
+
+	bool Renderer::is_alpha_tested_material(uint32_t material_id) const {
+		// Unclassified slots count as masked, as in the depth passes' pipeline selection
+		return material_id >= alpha_tested_materials.size() || alpha_tested_materials[material_id] != 0;
+	}
+
+	void Renderer::sort_shadow_casters(const RenderScene& render_scene, std::vector<uint32_t>& instances, std::vector<SortItem>& items) {
+		// Called per cascade from the culling jobs, alpha_tested_materials only changes in flush_upload_queue
+		items.resize(instances.size());
+		for (size_t k = 0; k < instances.size(); ++k) {
+			const uint32_t instance = instances[k];
+			const uint32_t mesh_id = render_scene.mesh_indices[instance];
+			const uint32_t sub_idx = render_scene.submesh_indices[instance];
+
+			// The CPU cascade loop draws a pinned submesh or the whole mesh with the instance material
+			uint32_t material_id = render_scene.material_indices[instance];
+			if (sub_idx != bud::asset::INVALID_INDEX && mesh_id < submesh_table.mesh_count() && sub_idx < submesh_table.mesh_row_count[mesh_id]) {
+				material_id = submesh_table.material_ids[submesh_table.mesh_first_row[mesh_id] + sub_idx];
+			}
+			items[k] = { DrawKey::generate_shadow(is_alpha_tested_material(material_id), mesh_id, material_id), instance, 0 };
+		}
+
+		const uint32_t unsorted = count_state_changes<ShadowKeySchema>(items.data(), items.size());
+		std::sort(items.begin(), items.end(), [](const SortItem& a, const SortItem& b) {
+			return a.key != b.key ? a.key < b.key : a.entity_index < b.entity_index;
+		});
+		const uint32_t sorted = count_state_changes<ShadowKeySchema>(items.data(), items.size());
+
+		for (size_t k = 0; k < items.size(); ++k) {
+			instances[k] = items[k].entity_index;
+		}
+
+		auto& stats = rhi->get_render_stats();
+		constexpr uint32_t slot = static_cast<uint32_t>(SortKeyPass::Shadow);
+		std::atomic_ref(stats.sort_state_changes_unsorted[slot]).fetch_add(unsorted, std::memory_order_relaxed);
+		std::atomic_ref(stats.sort_state_changes[slot]).fetch_add(sorted, std::memory_order_relaxed);
+	}
+
+	void Renderer::build_prepass_list(const std::vector<SortItem>& list, size_t count, bool ranked) {
+		// Material, mesh and depth come back out of the opaque key, no second pass over the scene
+		constexpr uint32_t max_depth = (1u << PrepassKeySchema::width<KeyField::Depth>()) - 1u;
+		prepass_sort_list.resize(count);
+		for (size_t i = 0; i < count; ++i) {
+			const auto& item = list[i];
+			const uint32_t material_id = OpaqueKeySchema::extract<KeyField::Material>(item.key);
+			const uint32_t mesh_id = OpaqueKeySchema::extract<KeyField::Mesh>(item.key);
+			const uint32_t depth = ranked ? static_cast<uint32_t>(std::min<size_t>(i, max_depth)) : OpaqueKeySchema::extract<KeyField::Depth>(item.key);
+			prepass_sort_list[i] = { DrawKey::generate_prepass(is_alpha_tested_material(material_id), depth, mesh_id), item.entity_index, item.submesh_index };
+		}
+
+		auto& stats = rhi->get_render_stats();
+		constexpr uint32_t slot = static_cast<uint32_t>(SortKeyPass::Prepass);
+		stats.sort_state_changes_unsorted[slot] = count_state_changes<PrepassKeySchema>(prepass_sort_list.data(), count);
+		std::stable_sort(prepass_sort_list.begin(), prepass_sort_list.end(), [](const SortItem& a, const SortItem& b) { return a.key < b.key; });
+		stats.sort_state_changes[slot] = count_state_changes<PrepassKeySchema>(prepass_sort_list.data(), count);
+	}
+
+	bool Renderer::prepare_foliage(const SceneView& view, uint32_t cascade_count, uint32_t frame_slot) {
+		ZoneScopedN("FoliageCull");
+
+		auto& stats = rhi->get_render_stats();
+		if (!foliage || !render_config.enable_foliage || foliage->instance_count() == 0) {
+			foliage_draws.clear();
+			return false;
+		}
+
+		auto cull_start = std::chrono::high_resolution_clock::now();
+
+		const uint32_t shadow_count = render_config.enable_foliage_shadows ? cascade_count : 0;
+		foliage_shadow_draws.resize(shadow_count);
+		foliage_shadow_first_instances.resize(shadow_count);
+
+		// Job 0 is the main view, job 1 + i cascade i; each writes its own list
+		bud::threading::Counter cull_counter;
+		task_scheduler->ParallelFor(1 + shadow_count, 1,
+			[&](size_t start, size_t end) {
+				for (size_t job = start; job < end; ++job) {
+					FoliageCullParams params;
+					params.camera_position = view.camera_position;
+					if (job == 0) {
+						params.frustum.update(view.view_proj_matrix);
+						params.max_distance = view.far_plane;
+						foliage->cull(params, foliage_draws);
+					} else {
+						params.frustum.update(view.cascade_view_proj_matrices[job - 1]);
+						params.shadow_casters = true;
+						foliage->cull(params, foliage_shadow_draws[job - 1]);
+					}
+				}
+			}, &cull_counter);
+		task_scheduler->wait_for_counter(cull_counter);
+
+		uint64_t total = foliage_draws.instances.size();
+		for (uint32_t i = 0; i < shadow_count; ++i) {
+			foliage_shadow_first_instances[i] = static_cast<uint32_t>(total);
+			total += foliage_shadow_draws[i].instances.size();
+		}
+
+		stats.foliage_cells_total = static_cast<uint32_t>(foliage->cell_count());
+		stats.foliage_cells_visible = foliage_draws.stats.cells_visible;
+		stats.foliage_mesh_instances = foliage_draws.stats.mesh_instances;
+		stats.foliage_impostor_instances = foliage_draws.stats.impostor_instances;
+		stats.foliage_shadow_instances = static_cast<uint32_t>(total - foliage_draws.instances.size());
+		stats.foliage_cull_ms = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - cull_start).count();
+
+		if (total == 0) return false;
+
+		if (total > foliage_instance_capacity) {
+			rhi->wait_idle();
+			for (auto& buf : foliage_instance_buffers) {
+				if (buf.is_valid()) rhi->destroy_buffer(buf);
+				buf = {};
+			}
+			foliage_instance_capacity = std::max<uint64_t>(total * 2, 4096);
+		}
+
+		auto& instance_buf = foliage_instance_buffers[frame_slot];
+		if (!instance_buf.is_valid()) {
+			instance_buf = rhi->create_gpu_buffer(foliage_instance_capacity * sizeof(FoliageInstance), ResourceState::VertexBuffer);
+			rhi->set_debug_name(instance_buf, ObjectType::Buffer, "FoliageInstances_Frame" + std::to_string(frame_slot));
+		}
+
+		const uint64_t bytes = total * sizeof(FoliageInstance);
+		auto staging = rhi->get_allocator()->alloc_staging(bytes);
+		auto* dst = static_cast<FoliageInstance*>(staging.mapped_ptr);
+		std::memcpy(dst, foliage_draws.instances.data(), foliage_draws.instances.size() * sizeof(FoliageInstance));
+		for (uint32_t i = 0; i < shadow_count; ++i) {
+			const auto& list = foliage_shadow_draws[i].instances;
+			if (!list.empty()) std::memcpy(dst + foliage_shadow_first_instances[i], list.data(), list.size() * sizeof(FoliageInstance));
+		}
+		rhi->copy_buffer_immediate(staging, instance_buf, bytes);
+		rhi->destroy_buffer(staging);
+		return true;
+	}
+
+	void Renderer::add_secondary_views(RenderGraph& graph, RGHandle shadow_map, const RenderScene& render_scene, const SceneView& main_view,
+		const std::vector<SecondaryView>& secondary_views, uint32_t view_count, RGHandle instance_data, uint32_t frame_slot, std::vector<RGHandle>& out_targets) {
+		ZoneScopedN("SecondaryViews");
+		constexpr uint32_t slots_per_frame = MAX_VIEWS - 1;
+		if (view_color_targets.size() < (frame_slot + 1) * slots_per_frame) {
+			view_color_targets.resize((frame_slot + 1) * slots_per_frame, nullptr);
+		}
+
+		// The GPU-driven cull lists and the light grid only cover the main view, secondary views draw on the CPU path
+		RenderConfig view_config = render_config;
+		view_config.enable_gpu_driven = false;
+
+		out_targets.assign(view_count, {});
+		for (uint32_t v = 0; v < view_count; ++v) {
+			const auto& draws = view_draw_lists[v];
+			const auto& secondary = secondary_views[v];
+			const uint32_t width = static_cast<uint32_t>(secondary.view.viewport_width);
+			const uint32_t height = static_cast<uint32_t>(secondary.view.viewport_height);
+			if (draws.items.empty() || width == 0 || height == 0) continue;
+
+			auto& target = view_color_targets[frame_slot * slots_per_frame + v];
+			if (target && (target->width != width || target->height != height)) {
+				if (auto* pool = rhi->get_resource_pool()) pool->release_texture(target);
+				target = nullptr;
+			}
+			if (!target) {
+				TextureDesc desc;
+				desc.width = width;
+				desc.height = height;
+				desc.format = bud::graphics::TextureFormat::BGRA8_SRGB;
+				target = rhi->create_texture(desc, nullptr, 0);
+			}
+			if (!target) continue;
+
+			// Camera from the caller, lighting and cascades from the main view so the shadow map matches
+			SceneView view = secondary.view;
+			view.view_index = v + 1;
+			view.render_scale = 1.0f;
+			view.local_light_count = 0;
+			view.time = main_view.time;
+			view.delta_time = main_view.delta_time;
+			view.light_dir = main_view.light_dir;
+			view.light_color = main_view.light_color;
+			view.light_intensity = main_view.light_intensity;
+			view.ambient_strength = main_view.ambient_strength;
+			for (uint32_t c = 0; c < MAX_CASCADES; ++c) {
+				view.cascade_view_proj_matrices[c] = main_view.cascade_view_proj_matrices[c];
+				view.cascade_split_depths[c] = main_view.cascade_split_depths[c];
+			}
+
+			RGHandle color = graph.import_texture("SecondaryViewColor", target, ResourceState::Undefined);
+			RGHandle depth = z_prepass->add_to_graph(graph, color, render_scene, view, render_config, meshes, draws.items, draws.items.size(),
+				geometry_pool.get_vertex_streams(), geometry_pool.index_buffer, alpha_tested_materials);
+			if (!depth.is_valid()) continue;
+
+			main_pass->add_to_graph(graph, shadow_map, color, depth, render_scene, view, view_config, meshes, draws.items, draws.items.size(), {}, instance_data,
+				geometry_pool.get_vertex_streams(), geometry_pool.index_buffer, {}, {}, &draws.slots);
+			out_targets[v] = color;
+		}
+	}
+
 	void Renderer::update_cascades(SceneView& view, const RenderConfig& config, const bud::math::AABB& scene_aabb) {
 		auto cam_near = view.near_plane;
 		auto cam_far = view.far_plane;
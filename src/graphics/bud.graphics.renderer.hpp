@@ -3,6 +3,8 @@
 #include <memory>
 #include <vector>
 #include <mutex>
+#include <atomic>
+#include <optional>
 #include <limits>
 
 #include "src/io/bud.io.hpp"
@@ -14,6 +16,11 @@
 #include "src/graphics/bud.graphics.rhi.hpp"
 #include "src/graphics/bud.graphics.graph.hpp"
 #include "src/graphics/bud.graphics.passes.hpp"
+#include "src/graphics/bud.graphics.lighting.hpp"
+#include "src/graphics/bud.graphics.occluders.hpp"
+#include "src/graphics/bud.graphics.instances.hpp"
+#include "src/graphics/bud.graphics.submeshes.hpp"
+#include "src/graphics/bud.graphics.views.hpp"
 namespace bud::graphics {
 	struct MeshAssetHandle {
 		static constexpr uint32_t invalid_id = std::numeric_limits<uint32_t>::max();
@@ -31,22 +38,42 @@ namespace bud::graphics {
         }
 	};
 
+	// Backbuffer contents of one frame before the UI overlay, rows tightly packed in the swapchain format
+	struct FrameCapture {
+		uint32_t width = 0;
+		uint32_t height = 0;
+		TextureFormat format = TextureFormat::Undefined;
+		uint32_t main_view_path = 0; // RenderStats::main_view_path of the captured frame
+		std::vector<uint8_t> pixels;
+	};
+
 	class Renderer {
 	public:
 		Renderer(RHI* rhi, bud::io::AssetManager* asset_manager, bud::threading::TaskScheduler* task_scheduler);
 		~Renderer();
 
 		MeshAssetHandle upload_mesh(const bud::io::MeshData& mesh_data);
+		// Bindless slot of a standalone texture (impostor atlases), the fallback texture until the load finishes
+		uint32_t upload_texture(const std::string& path);
+		// Queued behind the uploads issued before it, so the mesh ids the foliage types reference exist when it lands
+		void set_foliage(std::shared_ptr<const FoliageSystem> foliage_system);
 
 		// Only work on Rendering Thread
 		void flush_upload_queue();
 		void update_ui_draw_data(ImDrawData* draw_data);
 
-		void render(const bud::graphics::RenderScene& render_scene, SceneView& scene_view);
+		// Secondary views (at most MAX_VIEWS - 1) share the main view's culling traversal, key generation and
+		// instance upload, each gets its own Z-prepass and forward pass into a view-sized target
+		void render(const bud::graphics::RenderScene& render_scene, SceneView& scene_view, const std::vector<SecondaryView>& secondary_views = {});
 
 		void set_config(const RenderConfig& config);
 		const RenderConfig& get_config() const;
 
+		// Any thread: the next rendered frame copies its backbuffer out (waits for the GPU once), take_capture
+		// hands it over when it has landed
+		void request_capture();
+		bool take_capture(FrameCapture& out);
+
 		// Game-thread safe snapshot (CPU-side bounds only)
 		std::vector<bud::math::AABB> get_mesh_bounds_snapshot() const;
 		std::vector<std::vector<bud::math::AABB>> get_submesh_bounds_snapshot() const;
@@ -57,22 +84,74 @@ namespace bud::graphics {
 			std::vector<std::function<void()>> commands;
 		};
 
-		// Global Geometry Pool (Mega-Buffer) that all meshes are packed into
+		// Global Geometry Pool (Mega-Buffer) that all meshes are packed into.
+		// The vertex buffer holds two streams indexed by the same vertex: positions first, attributes after them.
 		struct GeometryPool {
-			static constexpr uint64_t kVertexPoolSize = 256ull * 1024 * 1024; // 256 MB
-			static constexpr uint64_t kIndexPoolSize  = 128ull * 1024 * 1024; // 128 MB
+			// meshlet.mesh / vis_resolve.comp read the pool as floats, ATTRIBUTE_STREAM_BASE there = kPositionStreamSize / 4
+			static constexpr uint64_t kPositionStreamSize  = 64ull * 1024 * 1024;  // 64 MB, vec3 per vertex
+			static constexpr uint64_t kAttributeStreamSize = 192ull * 1024 * 1024; // 192 MB, MeshData::VertexAttributes per vertex
+			static constexpr uint64_t kVertexPoolSize = kPositionStreamSize + kAttributeStreamSize;
+			static constexpr uint32_t kMaxVertices = static_cast<uint32_t>(kPositionStreamSize / bud::io::VERTEX_POSITION_STRIDE);
+			static_assert(kAttributeStreamSize / bud::io::VERTEX_ATTRIBUTE_STRIDE >= kMaxVertices, "Attribute stream holds fewer vertices than the position stream");
+			static constexpr uint64_t kIndexPoolSize  = 128ull * 1024 * 1024; // 128 MB (mesh indices + expanded meshlet triangles)
+			static constexpr uint64_t kMeshletPoolSize     = 32ull * 1024 * 1024; // 32 MB of GPUMeshlet
+			static constexpr uint64_t kMeshletDataPoolSize = 64ull * 1024 * 1024; // 64 MB, mesh shader vertex/triangle indices
+			static constexpr uint64_t kMeshletLodPoolSize  = kMeshletPoolSize / sizeof(GPUMeshlet) * sizeof(GPUMeshletLod); // Parallel to the meshlet pool
+			static constexpr uint32_t kMaxIndices     = static_cast<uint32_t>(kIndexPoolSize / sizeof(uint32_t));
+			static constexpr uint32_t kMaxMeshlets    = static_cast<uint32_t>(kMeshletPoolSize / sizeof(GPUMeshlet));
+			static constexpr uint32_t kMaxMeshletData = static_cast<uint32_t>(kMeshletDataPoolSize / sizeof(uint32_t));
 
 			bud::graphics::BufferHandle vertex_buffer;
 			bud::graphics::BufferHandle index_buffer;
+			bud::graphics::BufferHandle meshlet_buffer;
+			bud::graphics::BufferHandle meshlet_data_buffer;
+			bud::graphics::BufferHandle meshlet_lod_buffer;
 
 			std::atomic<uint32_t> next_vertex{ 0 }; // in vertices
 			std::atomic<uint32_t> next_index{ 0 };  // in indices
+			std::atomic<uint32_t> next_meshlet{ 0 };      // in GPUMeshlet
+			std::atomic<uint32_t> next_meshlet_data{ 0 }; // in uint32
+			std::mutex meshlet_mutex; // next_meshlet and next_meshlet_data are reserved together
 
 			bool initialized = false;
+
+			// Takes count elements below capacity or nothing at all, checked in 64 bits so base + count cannot wrap past it
+			static bool try_reserve(std::atomic<uint32_t>& next, uint32_t count, uint64_t capacity, uint32_t& out_base) {
+				uint32_t base = next.load(std::memory_order_relaxed);
+				do {
+					if ((uint64_t)base + count > capacity) return false;
+				} while (!next.compare_exchange_weak(base, base + count, std::memory_order_relaxed));
+				out_base = base;
+				return true;
+			}
+
+			VertexStreams get_vertex_streams() const;
+		};
+
+		// Dynamic resolution controller, see RenderConfig::dynamic_resolution_*
+		struct DynamicResolutionState {
+			float scale = 1.0f;
+			float smoothed_ms = 0.0f;
+			uint64_t frames = 0;
+			uint64_t frames_in_budget = 0;
+			float history[RENDER_SCALE_HISTORY_SIZE] = {};
+			uint32_t history_head = 0;
 		};
 
 		void update_cascades(SceneView& view, const RenderConfig& config, const bud::math::AABB& scene_aabb);
 
+		// Per-pass sort keys over the shared culling results (bud.graphics.sortkey.hpp)
+		bool is_alpha_tested_material(uint32_t material_id) const;
+		void sort_shadow_casters(const RenderScene& render_scene, std::vector<uint32_t>& instances, std::vector<SortItem>& items);
+		void build_prepass_list(const std::vector<SortItem>& list, size_t count, bool ranked);
+		// Z-prepass + forward pass per secondary view into its own target, out_targets[v] stays invalid for a skipped view
+		void add_secondary_views(RenderGraph& graph, RGHandle shadow_map, const RenderScene& render_scene, const SceneView& main_view,
+			const std::vector<SecondaryView>& secondary_views, uint32_t view_count, RGHandle instance_data, uint32_t frame_slot, std::vector<RGHandle>& out_targets);
+		float update_render_scale(float frame_ms);
+		void load_bindless_texture(uint32_t slot, const std::string& path);
+		// Culls the main view and every cascade into foliage_draws / foliage_shadow_draws and uploads them, false = nothing to draw
+		bool prepare_foliage(const SceneView& view, uint32_t cascade_count, uint32_t frame_slot);
+
 		RHI* rhi;
 		RenderGraph render_graph;
 		RenderConfig render_config;
@@ -83,9 +162,15 @@ namespace bud::graphics {
 		std::unique_ptr<ZPrepass> z_prepass;
 		std::unique_ptr<HiZMipPass> hiz_mip_pass;
 		std::unique_ptr<HiZCullingPass> hiz_pass;
+		std::unique_ptr<ShadowCullingPass> shadow_cull_pass;
+		std::unique_ptr<MeshletCullingPass> meshlet_cull_pass;
 		std::unique_ptr<HiZDebugPass> hiz_debug_pass;
 		std::unique_ptr<MainPass> main_pass;
+		std::unique_ptr<VisibilityBufferPass> visibility_pass;
 		std::unique_ptr<ClusterVisualizationPass> cluster_viz_pass;
+		std::unique_ptr<LightClusteringPass> light_cluster_pass;
+		std::unique_ptr<UpscalePass> upscale_pass;
+		std::unique_ptr<FoliagePass> foliage_pass;
 		std::unique_ptr<UIPass> ui_pass;
 
 		// GPU-Driven specific (Per-frame)
@@ -93,28 +178,73 @@ namespace bud::graphics {
 		std::vector<bud::graphics::BufferHandle> indirect_instance_buffers;
 		std::vector<bud::graphics::BufferHandle> indirect_draw_buffers;
 		std::vector<bud::graphics::BufferHandle> stats_readback_buffers;
+		std::vector<bud::graphics::BufferHandle> shadow_draw_buffers;     // DrawData of shadow casters (union of cascades)
+		std::vector<bud::graphics::BufferHandle> shadow_indirect_buffers;  // Per-cascade compacted commands + counts
+		std::vector<bud::graphics::BufferHandle> meshlet_indirect_buffers; // Per-meshlet commands + count + task dispatch header
+		std::vector<bud::graphics::BufferHandle> meshlet_visible_buffers;  // Visible {meshlet, instance} list for the mesh shader path
+		uint32_t current_meshlet_capacity = 0;
+		std::vector<bud::graphics::BufferHandle> visibility_resolve_buffers; // Material bins + sorted pixel list of the visibility resolve
+		uint64_t current_visibility_resolve_size = 0;
+		std::atomic<bool> capture_requested{ false };
+		std::mutex capture_mutex;
+		std::optional<FrameCapture> pending_capture;
+		std::vector<bud::graphics::BufferHandle> local_light_buffers;   // GPULocalLight[MAX_LOCAL_LIGHTS]
+		std::vector<bud::graphics::BufferHandle> light_cluster_buffers; // Cluster counts + light indices, device local
+		std::vector<bud::graphics::BufferHandle> light_cluster_readback_buffers; // Compute grid header, the whole grid when validating
+		uint64_t current_light_cluster_readback_size = 0;
+		struct LightClusterValidation {
+			bool pending = false;
+			SceneView view;
+			std::vector<GPULocalLight> lights;
+			uint32_t light_count = 0;
+		};
+		std::vector<LightClusterValidation> light_cluster_validations; // Per frame slot, inputs of the grid being read back
+		std::vector<uint8_t> light_cluster_reference; // CPU reference grid to compare the readback with
+		std::vector<Texture*> scene_color_targets; // Output-sized, the main view renders a scaled sub-rect under dynamic resolution
+		std::vector<Texture*> view_color_targets;  // [frame slot * (MAX_VIEWS - 1) + view - 1], sized to the secondary view
+
+		DynamicResolutionState dynamic_resolution;
+
+		std::shared_ptr<const FoliageSystem> foliage;
+		FoliageDrawList foliage_draws;                         // Main view, first in the frame's instance buffer
+		std::vector<FoliageDrawList> foliage_shadow_draws;      // Per cascade, after the main view's instances
+		std::vector<uint32_t> foliage_shadow_first_instances;
+		std::vector<bud::graphics::BufferHandle> foliage_instance_buffers; // Per frame slot, FoliageInstance
+		uint64_t foliage_instance_capacity = 0;                // In instances
+
+		OccluderSelector occluder_selector;
+		std::vector<SortItem> occluder_list; // Z-prepass draws when occluder selection is on, referenced until the graph executes
 
 		GPUStats last_gpu_stats{};
 
 		GeometryPool geometry_pool;
 
 		std::vector<RenderMesh> meshes;
+		uint32_t cluster_lod_mesh_count = 0; // Uploaded meshes with a cluster LOD hierarchy in the meshlet pool
 		std::vector<bud::math::AABB> mesh_bounds;
 		mutable std::mutex mesh_bounds_mutex;
 
-		std::vector<SortItem> sort_list;
+		SubmeshTable submesh_table;                        // Flat SoA copy of meshes[*].submeshes for culling and key generation
+		std::vector<SubmeshRange> visible_submesh_ranges;  // Per main view visible instance
+		std::vector<uint32_t> draw_offsets;                // First sort_list slot per visible instance
+
+		std::vector<ViewMask> view_masks;          // Parallel to the main view's visible instances, bit v = view v sees it
+		std::vector<ViewMask> instance_view_masks; // Same masks by entity, 0 outside every view
+		std::vector<ViewDrawList> view_draw_lists; // Per secondary view, referenced until the graph executes
+
+		std::vector<SortItem> sort_list; // Main view draws (layer 0) first, then the ones only secondary views see
+		std::vector<SortItem> prepass_sort_list; // Z-prepass draws re-keyed with PrepassKeySchema
+		std::vector<SortItem> cluster_lod_prepass_list; // Z-prepass draws without the cluster LOD ones, referenced until the graph executes
+		std::vector<SortItem> shadow_draw_list; // Exploded shadow caster draws for the indirect-count shadow path
+		std::vector<SortItem> shadow_sort_lists[MAX_CASCADES]; // sort_shadow_casters scratch, one per cascade since they sort in parallel
+		std::vector<uint8_t> shadow_caster_mask;
+		std::vector<uint8_t> alpha_tested_materials; // By bindless slot, 1 = texture alpha below the depth passes' cutoff
 
 		std::atomic<uint32_t> next_bindless_slot{ 1 };
 		std::atomic<uint32_t> next_mesh_id{ 0 };
 
-		struct InstanceData {
-			bud::math::mat4 model;
-			uint32_t material_id;
-			uint32_t padding[3];
-		};
-
 		std::vector<bud::graphics::BufferHandle> instance_data_ssbos;
-		uint32_t instance_data_capacity = 0;
+		InstanceDataBuilder instance_builder;
 
 		std::shared_ptr<UploadQueue> upload_queue;
 	};
@@ -29,9 +29,16 @@ namespace bud::graphics {
 	public:
 		virtual ~RHI() = default;
 		virtual void init(bud::platform::Window* window, bud::threading::TaskScheduler* task_scheduler, bool enable_validation, uint32_t inflight_frame_count) = 0;
+		// Before init
+		virtual void set_device_preference(DevicePreference preference) {}
+		virtual std::string get_device_name() const { return {}; }
 
 		virtual void resize_swapchain(uint32_t width, uint32_t height) = 0;
 		virtual bool is_swapchain_out_of_date() const { return false; }
+		virtual bool supports_draw_indirect_count() const { return false; }
+		virtual bool supports_mesh_shaders() const { return false; }
+		// Visibility buffer raster reads gl_PrimitiveID in the fragment stage (geometryShader feature)
+		virtual bool supports_visibility_buffer() const { return false; }
 
 		virtual CommandHandle begin_frame() = 0;
 		virtual void end_frame(CommandHandle cmd) = 0;
@@ -43,11 +50,13 @@ namespace bud::graphics {
 		virtual bud::graphics::Allocator* get_allocator() = 0;
 
 		// 资源管理 (逐步废弃)
-		virtual BufferHandle create_gpu_buffer(uint64_t size, ResourceState usage_state) = 0;
+		// GpuOnly stays device local; Readback / PersistentMapped / StagingRing are host coherent and mapped (mapped_ptr)
+		virtual BufferHandle create_gpu_buffer(uint64_t size, ResourceState usage_state, MemoryUsage memory_usage = MemoryUsage::GpuOnly) = 0;
 		virtual BufferHandle create_upload_buffer(uint64_t size) = 0;
 		virtual void copy_buffer_immediate(BufferHandle src, BufferHandle dst, uint64_t size) = 0;
 		virtual void copy_buffer_immediate_offset(BufferHandle src, BufferHandle dst, uint64_t size, uint64_t src_offset, uint64_t dst_offset) = 0;
 		virtual void destroy_buffer(BufferHandle block) = 0;
+		// Pipeline creation is thread-safe, passes call it from worker tasks when the shader bundle is mounted
 		virtual void* create_graphics_pipeline(const GraphicsPipelineDesc& desc) = 0;
 		virtual void* create_compute_pipeline(const ComputePipelineDesc& desc) = 0;
 		virtual void destroy_pipeline(void* pipeline) = 0;
@@ -63,9 +72,17 @@ namespace bud::graphics {
 		virtual void cmd_bind_compute_ubo(CommandHandle cmd, void* pipeline, uint32_t binding) = 0;
 		virtual void cmd_draw(CommandHandle cmd, uint32_t vertex_count, uint32_t instance_count, uint32_t first_vertex, uint32_t first_instance) = 0;
 		virtual void cmd_draw_indexed_indirect(CommandHandle cmd, BufferHandle buffer, uint64_t offset, uint32_t draw_count, uint32_t stride) = 0;
+		// Draw count is read from count_buffer on the GPU; only valid when supports_draw_indirect_count() is true
+		virtual void cmd_draw_indexed_indirect_count(CommandHandle cmd, BufferHandle buffer, uint64_t offset, BufferHandle count_buffer, uint64_t count_offset, uint32_t max_draw_count, uint32_t stride) = 0;
+		// Task/mesh workgroup counts {x, y, z} are read from buffer; only valid when supports_mesh_shaders() is true
+		virtual void cmd_draw_mesh_tasks_indirect(CommandHandle cmd, BufferHandle buffer, uint64_t offset, uint32_t draw_count, uint32_t stride) = 0;
 		virtual void cmd_dispatch(CommandHandle cmd, uint32_t group_x, uint32_t group_y, uint32_t group_z) = 0;
+		// GPU timestamps around a scope, each timer at most once per frame; no-ops without timestamp support
+		virtual void cmd_begin_gpu_timer(CommandHandle cmd, GPUTimer timer) {}
+		virtual void cmd_end_gpu_timer(CommandHandle cmd, GPUTimer timer) {}
 		virtual Texture* get_current_swapchain_texture() = 0;
 		virtual uint32_t get_current_image_index() = 0;
+		// Writes uniform slot scene_view.view_index; set 0 binds that slot until the render pass ends
 		virtual void update_global_uniforms(uint32_t image_index, const SceneView& scene_view) = 0;
 		virtual void cmd_push_constants(CommandHandle cmd, void* pipeline_layout, uint32_t size, const void* data) = 0;
 
@@ -73,7 +90,7 @@ namespace bud::graphics {
 		virtual void cmd_begin_render_pass(CommandHandle cmd, const RenderPassBeginInfo& info) = 0;
 		virtual void cmd_end_render_pass(CommandHandle cmd) = 0;
 
-		virtual void cmd_bind_vertex_buffer(CommandHandle cmd, bud::graphics::BufferHandle buffer) = 0;
+		virtual void cmd_bind_vertex_buffer(CommandHandle cmd, bud::graphics::BufferHandle buffer, uint32_t binding = 0) = 0;
 		virtual void cmd_bind_index_buffer(CommandHandle cmd, bud::graphics::BufferHandle buffer) = 0;
 		virtual void cmd_draw_indexed(CommandHandle cmd, uint32_t index_count, uint32_t instance_count, uint32_t first_index, int32_t vertex_offset, uint32_t first_instance) = 0;
 		virtual void cmd_set_viewport(CommandHandle cmd, float width, float height) = 0;
@@ -86,8 +103,15 @@ namespace bud::graphics {
 		virtual Texture* get_fallback_texture() = 0;
 		virtual void update_global_shadow_map(Texture* texture) = 0;
 		virtual void update_global_instance_data(bud::graphics::BufferHandle buffer) = 0;
+		// Storage buffers read by the task/mesh pipeline (Set 0, Binding 4..7); no-op without mesh shader support
+		virtual void update_global_meshlet_data(BufferHandle meshlets, BufferHandle meshlet_data, BufferHandle vertices, BufferHandle visible_meshlets) = 0;
+		// Local lights + light cluster grid of the frame being recorded (Set 0, Binding 8..9)
+		virtual void update_global_light_data(BufferHandle lights, BufferHandle cluster_grid) = 0;
 		virtual void cmd_copy_image(CommandHandle cmd, Texture* src, Texture* dst) = 0; // Shadow Caching
+		// Mip 0 / layer 0 of a color texture in TransferSrc, tightly packed rows into dst (frame captures)
+		virtual void cmd_copy_texture_to_buffer(CommandHandle cmd, Texture* src, BufferHandle dst) = 0;
 		virtual void cmd_blit_image(CommandHandle cmd, Texture* src, Texture* dst) = 0;
+		virtual void cmd_blit_image(CommandHandle cmd, Texture* src, Texture* dst, int32_t dst_x, int32_t dst_y, uint32_t dst_width, uint32_t dst_height) = 0;
 		virtual void cmd_set_scissor(CommandHandle cmd, uint32_t width, uint32_t height) = 0;
 
 		virtual void set_render_config(const RenderConfig& new_render_config) = 0;
@@ -17,6 +17,8 @@ namespace bud::graphics {
 			submesh_indices = std::move(other.submesh_indices);
 			material_indices = std::move(other.material_indices);
 			flags = std::move(other.flags);
+			local_lights = std::move(other.local_lights);
+			hlod_stats = other.hlod_stats;
 			lbvh_nodes = std::move(other.lbvh_nodes);
 			bvh_nodes = std::move(other.bvh_nodes);
 			scene_bounds = std::move(other.scene_bounds);
@@ -224,6 +226,56 @@ namespace bud::graphics {
 		}
 	}
 
+	void RenderScene::cull_frustums(const bud::math::Frustum* frustums, uint32_t frustum_count, std::vector<uint32_t>& out_indices, std::vector<ViewMask>& out_masks) const {
+		frustum_count = std::min(frustum_count, MAX_VIEWS);
+		const ViewMask all_views = static_cast<ViewMask>((1u << frustum_count) - 1u);
+
+		auto test = [&](const bud::math::AABB& aabb, ViewMask views) {
+			ViewMask inside = 0;
+			for (uint32_t v = 0; v < frustum_count; ++v) {
+				if ((views & (1u << v)) && bud::math::intersect_aabb_frustum(aabb, frustums[v]))
+					inside |= static_cast<ViewMask>(1u << v);
+			}
+			return inside;
+		};
+
+		if (bvh_root == ~0u) {
+			size_t count = size();
+			for (size_t i = 0; i < count; ++i) {
+				if (ViewMask mask = test(world_aabbs[i], all_views)) {
+					out_indices.push_back(static_cast<uint32_t>(i));
+					out_masks.push_back(mask);
+				}
+			}
+			return;
+		}
+
+		struct Entry {
+			uint32_t node;
+			ViewMask views;
+		};
+		std::vector<Entry> stack;
+		stack.reserve(64);
+		stack.push_back({ bvh_root, all_views });
+
+		while (!stack.empty()) {
+			Entry entry = stack.back();
+			stack.pop_back();
+
+			const auto& node = bvh_nodes[entry.node];
+			ViewMask views = test(node.aabb, entry.views);
+			if (views == 0) continue;
+
+			if (node.is_leaf) {
+				out_indices.push_back(node.instance_index);
+				out_masks.push_back(views);
+			} else {
+				stack.push_back({ node.left_child, views });
+				stack.push_back({ node.right_child, views });
+			}
+		}
+	}
+
 	bool RenderScene::intersect_scene(const bud::math::AABB& aabb) const {
 		if (bvh_root == ~0u) {
 			size_t count = size();
@@ -6,6 +6,8 @@
 #include <algorithm>
 
 #include "src/core/bud.math.hpp"
+#include "src/graphics/bud.graphics.types.hpp"
+#include "src/graphics/bud.graphics.hlod.hpp"
 
 namespace bud::threading {
 	class TaskScheduler;
@@ -25,6 +27,12 @@ namespace bud::graphics {
 		// 标志位 (Bit 0 = IsStatic, Bit 1 = CastShadow ...)
 		std::vector<uint8_t> flags;
 
+		// Point / spot lights, uploaded as-is to the clustered light buffer
+		std::vector<GPULocalLight> local_lights;
+
+		// Region selection of the frame, written by the extraction that added the proxies
+		HLODStats hlod_stats;
+
 		struct LBVHNode {
 			uint32_t instance_index;
 			uint32_t morton_code;
@@ -66,6 +74,7 @@ namespace bud::graphics {
 			submesh_indices.assign(estimated_capacity, 0);
 			material_indices.assign(estimated_capacity, 0);
 			flags.assign(estimated_capacity, 0);
+			local_lights.clear();
 			instance_count.store(0);
 			dropped_instances.store(0);
 		}
@@ -73,6 +82,9 @@ namespace bud::graphics {
 		void build_culling_lbvh_parallel(bud::threading::TaskScheduler* task_scheduler);
 
 		void cull_frustum(const bud::math::Frustum& frustum, std::vector<uint32_t>& out_indices) const;
+		// One traversal for up to MAX_VIEWS frustums: every instance inside at least one of them, with bit v
+		// of its mask set when frustums[v] sees it. A node only tests the views its parent was visible in.
+		void cull_frustums(const bud::math::Frustum* frustums, uint32_t frustum_count, std::vector<uint32_t>& out_indices, std::vector<ViewMask>& out_masks) const;
 		bool intersect_scene(const bud::math::AABB& aabb) const;
 
 		inline void add_instance(const bud::math::mat4& transform, const bud::math::AABB& aabb, uint32_t mesh_index, uint32_t submesh_index, uint32_t material_index, bool is_static) {
@@ -1,60 +1,269 @@
 #pragma once
 #include <cstdint>
+#include <cstddef>
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cassert>
 
 namespace bud::graphics {
 
-	// 布局: [ Layer(4) | Pipeline(10) | Material(18) | Mesh(14) | Depth(18) ]
-	// 总计 64 bits
-	struct DrawKey {
-		uint64_t value = 0;
+	struct SortItem {
+		uint64_t key;
+		uint32_t entity_index;
+		uint32_t submesh_index;
+	};
+
+	// Sort-key schemas: a pass declares which fields its key holds and how wide each one is, the
+	// packing is resolved at compile time. Fields are listed most significant first, so sorting by
+	// the packed key orders by the first field, then the next one, and so on.
 
-		// 编码器 (Encoder)
+	enum class KeyField : uint8_t {
+		Layer,
+		Pipeline,  // Pipeline variant the draw binds, e.g. position-only vs alpha-tested depth
+		Material,
+		Mesh,
+		Depth      // Quantized, or raw float bits for translucent
+	};
 
-		// Opaque Key: 
-		// 优先级: Layer > Pipeline > Material > Mesh > Depth
-		// 这样排序后：
-		// 1. 相同材质的物体聚在一起 (减少 State 切换 - SetPass Calls)
-		// 2. 在材质内部，相同 Mesh 的物体聚在一起 (允许 Instancing 合批)
-		// 3. 最后才是深度 (减少 Overdraw，但被迫为合批让路，牺牲一点点深度排序精度)
+	// Values a schema may pack, fields the schema doesn't declare are ignored
+	struct KeyFields {
+		uint32_t layer = 0;
+		uint32_t pipeline = 0;
+		uint32_t material = 0;
+		uint32_t mesh = 0;
+		uint32_t depth = 0;
 
-		static inline uint64_t generate_opaque(uint8_t layer, uint16_t pipeline_id, uint32_t material_id, uint32_t mesh_id, uint32_t depth_18bit) {
-			uint64_t key = 0;
+		constexpr uint32_t get(KeyField field) const {
+			switch (field) {
+			case KeyField::Layer: return layer;
+			case KeyField::Pipeline: return pipeline;
+			case KeyField::Material: return material;
+			case KeyField::Mesh: return mesh;
+			case KeyField::Depth: return depth;
+			}
+			return 0;
+		}
+	};
 
-			// 1. Layer (4 bits) [60-63]
-			key |= (uint64_t)(layer & 0xF) << 60;
+	namespace detail {
+		template <size_t N>
+		constexpr bool unique_key_fields(const std::array<KeyField, N>& fields) {
+			for (size_t i = 0; i < N; ++i)
+				for (size_t j = i + 1; j < N; ++j)
+					if (fields[i] == fields[j]) return false;
+			return true;
+		}
+	}
 
-			// 2. Pipeline (10 bits) [50-59] - 支持 1024 种 Shader
-			key |= (uint64_t)(pipeline_id & 0x3FF) << 50;
+	// State fields are the ones whose change between neighbouring draws costs a state change
+	template <KeyField Field, uint32_t Bits, bool State = Field != KeyField::Depth>
+	struct KeyBits {
+		static constexpr KeyField field = Field;
+		static constexpr uint32_t bits = Bits;
+		static constexpr bool state = State;
+	};
 
-			// 3. Material (18 bits) [32-49] - 支持 26万 种材质
-			key |= (uint64_t)(material_id & 0x3FFFF) << 32;
+	template <typename... Fields>
+	struct SortKeySchema {
+		static constexpr size_t field_count = sizeof...(Fields);
+		static constexpr uint32_t total_bits = (0u + ... + Fields::bits);
 
-			// 4. Mesh (14 bits) [18-31] - 支持 1.6万 种 Mesh 用于 Instancing
-			key |= (uint64_t)(mesh_id & 0x3FFF) << 18;
+	private:
+		static constexpr KeyField fields[] = { Fields::field... };
+		static constexpr uint32_t widths[] = { Fields::bits... };
+		static constexpr bool states[] = { Fields::state... };
 
-			// 5. Depth (18 bits) [0-17] - 归一化深度 (0~26万)
-			key |= (uint64_t)(depth_18bit & 0x3FFFF);
+		static constexpr uint64_t mask_of(uint32_t bits) { return bits >= 64 ? ~0ull : (1ull << bits) - 1ull; }
 
-			return key;
+		static constexpr uint32_t shift_of(size_t index) {
+			uint32_t used = 0;
+			for (size_t i = 0; i <= index; ++i) used += widths[i];
+			return 64u - used;
 		}
 
-		// Translucent Key: Back-to-Front (Layer | Depth)
-		// 透明物体通常无法 Instancing，因为必须严格按深度排序以保证混合正确
-		static inline uint64_t generate_translucent(uint8_t layer, float depth_from_camera) {
-			uint32_t depth_int = *reinterpret_cast<uint32_t*>(&depth_from_camera);
-			uint32_t inv_depth = ~depth_int; // 翻转浮点位，实现从大到小排序
+		static constexpr size_t index_of(KeyField field) {
+			for (size_t i = 0; i < field_count; ++i)
+				if (fields[i] == field) return i;
+			return field_count;
+		}
+
+	public:
+		static_assert(field_count > 0, "A sort key schema needs at least one field");
+		static_assert(total_bits <= 64, "Sort key schema does not fit in 64 bits");
+		static_assert(((Fields::bits > 0 && Fields::bits <= 32) && ...), "Sort key fields are 1 to 32 bits wide");
+		static_assert(detail::unique_key_fields(std::array<KeyField, sizeof...(Fields)>{ Fields::field... }), "Sort key schema declares a field twice");
+
+		template <KeyField Field>
+		static constexpr bool has() { return index_of(Field) < field_count; }
 
+		template <KeyField Field>
+		static constexpr uint32_t width() { return has<Field>() ? widths[index_of(Field)] : 0u; }
+
+		template <KeyField Field>
+		static constexpr uint32_t shift() {
+			static_assert(has<Field>(), "Field is not part of this sort key schema");
+			return shift_of(index_of(Field));
+		}
+
+		// Values wider than their field are truncated, fits() tells whether anything would be lost
+		static constexpr uint64_t encode(const KeyFields& values) {
 			uint64_t key = 0;
-			key |= (uint64_t)(layer & 0xF) << 60;
-			key |= (uint64_t)inv_depth << 28; // 使用高位 32bits 存深度
+			for (size_t i = 0; i < field_count; ++i) {
+				key |= (static_cast<uint64_t>(values.get(fields[i])) & mask_of(widths[i])) << shift_of(i);
+			}
 			return key;
 		}
+
+		// Values wider than their field saturate to its largest value, so they still sort after the ones that fit
+		static constexpr uint64_t encode_clamped(const KeyFields& values) {
+			uint64_t key = 0;
+			for (size_t i = 0; i < field_count; ++i) {
+				key |= std::min<uint64_t>(values.get(fields[i]), mask_of(widths[i])) << shift_of(i);
+			}
+			return key;
+		}
+
+		static constexpr bool fits(const KeyFields& values) {
+			for (size_t i = 0; i < field_count; ++i) {
+				if (static_cast<uint64_t>(values.get(fields[i])) > mask_of(widths[i])) return false;
+			}
+			return true;
+		}
+
+		template <KeyField Field>
+		static constexpr uint32_t extract(uint64_t key) {
+			if constexpr (!has<Field>()) {
+				return 0u;
+			} else {
+				return static_cast<uint32_t>((key >> shift<Field>()) & mask_of(width<Field>()));
+			}
+		}
+
+		// Bits of the state fields, two keys with equal masked bits draw without a state change
+		static constexpr uint64_t state_mask() {
+			uint64_t mask = 0;
+			for (size_t i = 0; i < field_count; ++i) {
+				if (states[i]) mask |= mask_of(widths[i]) << shift_of(i);
+			}
+			return mask;
+		}
 	};
 
-	struct SortItem {
-		uint64_t key;
-		uint32_t entity_index;
-		uint32_t submesh_index;
+	// 不透明: [ Layer(4) | Pipeline(10) | Material(18) | Mesh(14) | Depth(18) ]
+	// 优先级: Layer > Pipeline > Material > Mesh > Depth
+	// 这样排序后：
+	// 1. 相同材质的物体聚在一起 (减少 State 切换 - SetPass Calls)
+	// 2. 在材质内部，相同 Mesh 的物体聚在一起 (允许 Instancing 合批)
+	// 3. 最后才是深度 (减少 Overdraw，但被迫为合批让路，牺牲一点点深度排序精度)
+	using OpaqueKeySchema = SortKeySchema<
+		KeyBits<KeyField::Layer, 4>,
+		KeyBits<KeyField::Pipeline, 10>,
+		KeyBits<KeyField::Material, 18>,
+		KeyBits<KeyField::Mesh, 14>,
+		KeyBits<KeyField::Depth, 18>>;
+
+	// 透明: Back-to-Front, blending order beats state changes; material only breaks depth ties
+	using TranslucentKeySchema = SortKeySchema<
+		KeyBits<KeyField::Layer, 4>,
+		KeyBits<KeyField::Depth, 32>,
+		KeyBits<KeyField::Material, 18>,
+		KeyBits<KeyField::Mesh, 10, false>>;
+
+	// Z-prepass: one pipeline switch between position-only and alpha-tested draws, front to back
+	// inside each for early-z. Materials are push constants there, not state; a mesh change still
+	// breaks the instanced batch, so it counts like in the opaque key.
+	using PrepassKeySchema = SortKeySchema<
+		KeyBits<KeyField::Pipeline, 1>,
+		KeyBits<KeyField::Depth, 18>,
+		KeyBits<KeyField::Mesh, 14>>;
+
+	// Shadow cascades: pipeline variant, then mesh so consecutive draws reuse the same vertices;
+	// depth order buys nothing in a depth-only light view
+	using ShadowKeySchema = SortKeySchema<
+		KeyBits<KeyField::Pipeline, 1>,
+		KeyBits<KeyField::Mesh, 14>,
+		KeyBits<KeyField::Material, 18, false>>;
+
+	static_assert(OpaqueKeySchema::shift<KeyField::Layer>() == 60 && OpaqueKeySchema::shift<KeyField::Material>() == 32 && OpaqueKeySchema::shift<KeyField::Depth>() == 0);
+	static_assert(TranslucentKeySchema::shift<KeyField::Depth>() == 28);
+
+	// State changes when drawing items in the given order, culled items (key UINT64_MAX) and the
+	// ones the filter rejects are skipped
+	template <typename Schema, typename Filter>
+	uint32_t count_state_changes(const SortItem* items, size_t count, Filter&& filter) {
+		constexpr uint64_t mask = Schema::state_mask();
+		uint32_t changes = 0;
+		uint64_t previous = 0;
+		bool first = true;
+		for (size_t i = 0; i < count; ++i) {
+			if (items[i].key == UINT64_MAX || !filter(items[i])) continue;
+			const uint64_t state = items[i].key & mask;
+			if (first || state != previous) changes++;
+			previous = state;
+			first = false;
+		}
+		return changes;
+	}
+
+	template <typename Schema>
+	uint32_t count_state_changes(const SortItem* items, size_t count) {
+		return count_state_changes<Schema>(items, count, [](const SortItem&) { return true; });
+	}
+
+	struct DrawKey {
+		uint64_t value = 0;
+
+		// Keys clamped since the last take_overflows(), filled from any thread generating keys
+		static inline std::atomic<uint32_t> overflows{ 0 };
+
+		static uint32_t take_overflows() { return overflows.exchange(0, std::memory_order_relaxed); }
+
+		// A value wider than its field would alias another material / mesh. Debug builds stop on it,
+		// release builds clamp it and count the key.
+		template <typename Schema>
+		static inline uint64_t encode_checked(const KeyFields& fields) {
+			if (Schema::fits(fields)) [[likely]] return Schema::encode(fields);
+			assert(!"Sort key value does not fit its schema field");
+			overflows.fetch_add(1, std::memory_order_relaxed);
+			return Schema::encode_clamped(fields);
+		}
+
+		static inline uint64_t generate_opaque(uint8_t layer, uint16_t pipeline_id, uint32_t material_id, uint32_t mesh_id, uint32_t depth_18bit) {
+			KeyFields fields;
+			fields.layer = layer;
+			fields.pipeline = pipeline_id;
+			fields.material = material_id;
+			fields.mesh = mesh_id;
+			fields.depth = depth_18bit;
+			return encode_checked<OpaqueKeySchema>(fields);
+		}
+
+		// 透明物体通常无法 Instancing，因为必须严格按深度排序以保证混合正确
+		static inline uint64_t generate_translucent(uint8_t layer, float depth_from_camera, uint32_t material_id = 0, uint32_t mesh_id = 0) {
+			KeyFields fields;
+			fields.layer = layer;
+			fields.depth = ~std::bit_cast<uint32_t>(depth_from_camera); // 翻转浮点位，实现从大到小排序
+			fields.material = material_id;
+			fields.mesh = mesh_id;
+			return encode_checked<TranslucentKeySchema>(fields);
+		}
+
+		static inline uint64_t generate_prepass(bool alpha_tested, uint32_t depth_18bit, uint32_t mesh_id) {
+			KeyFields fields;
+			fields.pipeline = alpha_tested ? 1u : 0u;
+			fields.depth = depth_18bit;
+			fields.mesh = mesh_id;
+			return encode_checked<PrepassKeySchema>(fields);
+		}
+
+		static inline uint64_t generate_shadow(bool alpha_tested, uint32_t mesh_id, uint32_t material_id) {
+			KeyFields fields;
+			fields.pipeline = alpha_tested ? 1u : 0u;
+			fields.mesh = mesh_id;
+			fields.material = material_id;
+			return encode_checked<ShadowKeySchema>(fields);
+		}
 	};
 }
@@ -0,0 +1,141 @@
+﻿#include <algorithm>
+
+#include "src/graphics/bud.graphics.submeshes.hpp"
+#include "src/core/bud.asset.types.hpp"
+
+namespace bud::graphics {
+
+	void SubmeshTable::rebuild(const std::vector<RenderMesh>& meshes) {
+		size_t rows = 0;
+		for (const auto& mesh : meshes) rows += mesh.submeshes.size();
+
+		centers.clear();
+		extents.clear();
+		material_ids.clear();
+		centers.reserve(rows);
+		extents.reserve(rows);
+		material_ids.reserve(rows);
+
+		mesh_first_row.resize(meshes.size());
+		mesh_row_count.resize(meshes.size());
+
+		for (size_t m = 0; m < meshes.size(); ++m) {
+			const auto& mesh = meshes[m];
+			mesh_first_row[m] = static_cast<uint32_t>(material_ids.size());
+			mesh_row_count[m] = static_cast<uint32_t>(mesh.submeshes.size());
+
+			for (const auto& sub : mesh.submeshes) {
+				const bool bounded = sub.aabb.min.x <= sub.aabb.max.x && sub.aabb.min.y <= sub.aabb.max.y && sub.aabb.min.z <= sub.aabb.max.z;
+				centers.push_back(bounded ? sub.aabb.center() : bud::math::vec3(0.0f));
+				extents.push_back(bounded ? sub.aabb.size() * 0.5f : bud::math::vec3(-1.0f));
+				material_ids.push_back(sub.material_id);
+			}
+		}
+	}
+
+	SubmeshRange get_submesh_range(const RenderScene& render_scene, const SubmeshTable& table, uint32_t instance) {
+		SubmeshRange range;
+		const uint32_t mesh_id = render_scene.mesh_indices[instance];
+		if (mesh_id >= table.mesh_count()) return range; // Not uploaded yet
+
+		const uint32_t sub_idx = render_scene.submesh_indices[instance];
+		if (sub_idx == bud::asset::INVALID_INDEX) {
+			range.first_row = table.mesh_first_row[mesh_id];
+			range.count = table.mesh_row_count[mesh_id];
+			range.first_submesh = 0;
+		} else {
+			range.first_row = sub_idx < table.mesh_row_count[mesh_id] ? table.mesh_first_row[mesh_id] + sub_idx : SubmeshRange::NO_ROW;
+			range.count = 1;
+			range.first_submesh = sub_idx;
+		}
+		return range;
+	}
+
+	SubmeshFrustumTest::SubmeshFrustumTest(const bud::math::Frustum& frustum) {
+		for (int p = 0; p < 6; ++p) {
+			normals[p] = bud::math::vec3(frustum.planes[p]);
+			abs_normals[p] = glm::abs(normals[p]);
+			distances[p] = frustum.planes[p].w;
+		}
+	}
+
+	bool SubmeshFrustumTest::contains(const SubmeshTable& table, uint32_t row, const bud::math::mat3& linear, const bud::math::mat3& abs_linear, const bud::math::vec3& position) const {
+		const bud::math::vec3& local_extent = table.extents[row];
+		if (local_extent.x < 0.0f) return true;
+
+		const bud::math::vec3 center = linear * table.centers[row] + position;
+		const bud::math::vec3 extent = abs_linear * local_extent;
+		for (int p = 0; p < 6; ++p) {
+			if (bud::math::dot(normals[p], center) + distances[p] + bud::math::dot(abs_normals[p], extent) < 0.0f) return false;
+		}
+		return true;
+	}
+
+	void generate_submesh_keys(const RenderScene& render_scene, const SubmeshTable& table, const KeyGenView& view,
+		const uint32_t* visible, const SubmeshRange* ranges, const uint32_t* draw_offsets, size_t begin, size_t end, SortItem* out) {
+		const SubmeshFrustumTest main_test(view.frustum);
+
+		// Only built when a mask references the view
+		std::vector<SubmeshFrustumTest> secondary_tests;
+		if (view.view_masks && view.secondary_frustums) {
+			ViewMask used = 0;
+			for (size_t k = begin; k < end; ++k) used |= view.view_masks[k];
+			uint32_t count = 0;
+			for (uint32_t v = 1; v < MAX_VIEWS; ++v) {
+				if (used & (1u << v)) count = v;
+			}
+			secondary_tests.reserve(count);
+			for (uint32_t v = 0; v < count; ++v) secondary_tests.emplace_back(view.secondary_frustums[v]);
+		}
+
+		const float far_sq = view.far_plane * view.far_plane;
+
+		for (size_t k = begin; k < end; ++k) {
+			const SubmeshRange& range = ranges[k];
+			if (range.count == 0) continue;
+
+			const uint32_t i = visible[k];
+			const auto& world_matrix = render_scene.world_matrices[i];
+			const uint32_t mesh_id = render_scene.mesh_indices[i];
+			SortItem* items = out + draw_offsets[k];
+
+			auto mesh_pos = bud::math::vec3(world_matrix[3]);
+			auto depth_normalized = std::clamp(bud::math::distance2(mesh_pos, view.camera_position) / far_sq, 0.0f, 1.0f);
+			const uint32_t depth_key = static_cast<uint32_t>(depth_normalized * 0x3FFFF);
+			const ViewMask mask = view.view_masks ? view.view_masks[k] : ViewMask(1);
+
+			if (range.first_row == SubmeshRange::NO_ROW) {
+				items[0].entity_index = i;
+				items[0].submesh_index = range.first_submesh;
+				const uint8_t layer = (mask & 1u) ? 0 : static_cast<uint8_t>(SECONDARY_VIEW_LAYER);
+				items[0].key = DrawKey::generate_opaque(layer, 0, render_scene.material_indices[i], mesh_id, depth_key);
+				continue;
+			}
+
+			// |M| of the upper 3x3 maps a local half extent to the world AABB half extent
+			const bud::math::mat3 linear(world_matrix);
+			bud::math::mat3 abs_linear;
+			for (int c = 0; c < 3; ++c) abs_linear[c] = glm::abs(linear[c]);
+
+			for (uint32_t r = 0; r < range.count; ++r) {
+				const uint32_t row = range.first_row + r;
+				SortItem& item = items[r];
+				item.entity_index = i;
+				item.submesh_index = range.first_submesh + r;
+
+				if ((mask & 1u) && main_test.contains(table, row, linear, abs_linear, mesh_pos)) {
+					item.key = DrawKey::generate_opaque(0, 0, table.material_ids[row], mesh_id, depth_key);
+					continue;
+				}
+
+				item.key = UINT64_MAX;
+				for (uint32_t v = 1; v <= secondary_tests.size(); ++v) {
+					if ((mask & (1u << v)) && secondary_tests[v - 1].contains(table, row, linear, abs_linear, mesh_pos)) {
+						item.key = DrawKey::generate_opaque(static_cast<uint8_t>(SECONDARY_VIEW_LAYER), 0, table.material_ids[row], mesh_id, depth_key);
+						break;
+					}
+				}
+			}
+		}
+	}
+}
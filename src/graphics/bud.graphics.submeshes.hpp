@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "src/core/bud.math.hpp"
+#include "src/graphics/bud.graphics.types.hpp"
+#include "src/graphics/bud.graphics.scene.hpp"
+#include "src/graphics/bud.graphics.sortkey.hpp"
+
+namespace bud::graphics {
+
+	// Every submesh of every uploaded mesh in one flat SoA table, so culling and key generation stream
+	// through contiguous arrays instead of chasing RenderMesh -> submeshes. The rows of a mesh are
+	// contiguous: [mesh_first_row[mesh], mesh_first_row[mesh] + mesh_row_count[mesh]).
+	struct SubmeshTable {
+		// Per row. Local AABB as center / half extent, a negative extent marks a submesh without bounds
+		std::vector<bud::math::vec3> centers;
+		std::vector<bud::math::vec3> extents;
+		std::vector<uint32_t> material_ids;
+
+		// Per mesh
+		std::vector<uint32_t> mesh_first_row;
+		std::vector<uint32_t> mesh_row_count;
+
+		void rebuild(const std::vector<RenderMesh>& meshes);
+
+		size_t size() const { return material_ids.size(); }
+		size_t mesh_count() const { return mesh_first_row.size(); }
+	};
+
+	// Table rows drawn by one instance: every submesh of its mesh, or only the one pinned by
+	// RenderScene::submesh_indices. A pinned index past the mesh's submeshes draws the whole mesh
+	// once with the instance material (first_row = NO_ROW), as fill_draw_data does.
+	struct SubmeshRange {
+		static constexpr uint32_t NO_ROW = UINT32_MAX;
+
+		uint32_t first_row = 0;
+		uint32_t count = 0;
+		uint32_t first_submesh = 0;  // Submesh index of first_row within its mesh
+	};
+
+	SubmeshRange get_submesh_range(const RenderScene& render_scene, const SubmeshTable& table, uint32_t instance);
+
+	// Frustum test of one table row, the local center / extent is transformed (Arvo) instead of eight corners.
+	// linear / abs_linear are the upper 3x3 of the world matrix and its element-wise absolute value.
+	struct SubmeshFrustumTest {
+		bud::math::vec3 normals[6];
+		bud::math::vec3 abs_normals[6];
+		float distances[6];
+
+		explicit SubmeshFrustumTest(const bud::math::Frustum& frustum);
+
+		bool contains(const SubmeshTable& table, uint32_t row, const bud::math::mat3& linear, const bud::math::mat3& abs_linear, const bud::math::vec3& position) const;
+	};
+
+	struct KeyGenView {
+		bud::math::Frustum frustum;
+		bud::math::vec3 camera_position;
+		float far_plane = 1.0f;
+
+		// Multi-view: view_masks runs parallel to visible (RenderScene::cull_frustums), secondary_frustums[v - 1]
+		// belongs to mask bit v. A row only a secondary view sees is keyed on SECONDARY_VIEW_LAYER.
+		const bud::math::Frustum* secondary_frustums = nullptr;
+		const ViewMask* view_masks = nullptr;
+	};
+
+	// Sort items of visible[begin, end): instance k writes ranges[k].count items starting at out[draw_offsets[k]].
+	// Rows outside every frustum get key UINT64_MAX. Same keys and depth quantization as the per-RenderMesh loop
+	// it replaces, so after sorting the main view's draws are the layer 0 prefix.
+	void generate_submesh_keys(const RenderScene& render_scene, const SubmeshTable& table, const KeyGenView& view,
+		const uint32_t* visible, const SubmeshRange* ranges, const uint32_t* draw_offsets, size_t begin, size_t end, SortItem* out);
+}
@@ -3,6 +3,7 @@
 #include <cstdint>
 #include <vector>
 #include <string>
+#include <algorithm>
 
 #include "src/core/bud.core.hpp"
 #include "src/core/bud.math.hpp"
@@ -20,6 +21,11 @@ namespace bud::graphics {
 		Metal
 	};
 
+	enum class DevicePreference {
+		Discrete,  // Discrete GPU first, then whatever the driver lists first
+		Software   // CPU implementation (lavapipe, SwiftShader, WARP) for machines without a GPU
+	};
+
 	enum class ResourceState {
 		Undefined,
 		Common,            // D3D12_RESOURCE_STATE_COMMON / VK_IMAGE_LAYOUT_GENERAL
@@ -64,6 +70,8 @@ namespace bud::graphics {
 		D32_FLOAT,
 		D24_UNORM_S8_UINT,
 		R32_FLOAT,
+		R32G32_UINT,         // Visibility buffer: instance id + triangle id
+		R16G16B16A16_FLOAT,  // HDR color / compute shading output
 	};
 
 	enum class TextureType {
@@ -95,6 +103,95 @@ namespace bud::graphics {
 	};
 
 	constexpr uint32_t MAX_CASCADES = 4;
+
+	// Views rendered in one frame: the main view + secondary views (SecondaryView), one bit each in a ViewMask.
+	// View i writes uniform slot i (SceneView::view_index).
+	constexpr uint32_t MAX_VIEWS = 8;
+	using ViewMask = uint8_t;
+	static_assert(MAX_VIEWS <= sizeof(ViewMask) * 8, "ViewMask has a bit per view");
+
+	// Opaque key layer of draws only secondary views see, they sort after the main view's draws
+	constexpr uint32_t SECONDARY_VIEW_LAYER = 1;
+
+	// Indirect-count buffers start with a small header holding the GPU-written draw count(s),
+	// followed by tightly packed IndirectCommand records.
+	constexpr uint64_t INDIRECT_COUNT_HEADER_SIZE = 16;
+
+	// Byte offset of the VkDrawMeshTasksIndirectCommandEXT-style record {x, y, z} that the meshlet
+	// culling pass keeps in header words 1..3 of its indirect buffer (word 0 is the draw count).
+	constexpr uint64_t MESH_TASKS_COMMAND_OFFSET = 4;
+	// Meshlets forwarded by one task shader workgroup (see meshlet.task)
+	constexpr uint32_t MESHLETS_PER_TASK = 32;
+
+	// Material bins of the visibility buffer resolve, material ids beyond are folded in (see vis_classify.comp)
+	constexpr uint32_t VISIBILITY_MATERIAL_BINS = 1024;
+	// Resolve buffer header: count / offset / cursor per bin + {pixelCount, pad[3]}, packed pixel list follows
+	constexpr uint64_t VISIBILITY_RESOLVE_HEADER_SIZE = VISIBILITY_MATERIAL_BINS * 3 * sizeof(uint32_t) + 16;
+
+	// Clustered lighting: screen tiles x exponential depth slices between the camera near and far plane
+	constexpr uint32_t LIGHT_CLUSTER_X = 16;
+	constexpr uint32_t LIGHT_CLUSTER_Y = 9;
+	constexpr uint32_t LIGHT_CLUSTER_Z = 24;
+	constexpr uint32_t LIGHT_CLUSTER_COUNT = LIGHT_CLUSTER_X * LIGHT_CLUSTER_Y * LIGHT_CLUSTER_Z;
+	constexpr uint32_t MAX_LIGHTS_PER_CLUSTER = 64; // Further lights of a cluster are dropped and counted as overflow
+	constexpr uint32_t MAX_LOCAL_LIGHTS = 4096;
+	// Grid buffer: header {totalRefs, overflowClusters, maxLightsInCluster, activeClusters},
+	// then one count per cluster, then MAX_LIGHTS_PER_CLUSTER light indices per cluster
+	constexpr uint64_t LIGHT_CLUSTER_HEADER_SIZE = 16;
+	constexpr uint64_t LIGHT_CLUSTER_BUFFER_SIZE = LIGHT_CLUSTER_HEADER_SIZE
+		+ static_cast<uint64_t>(LIGHT_CLUSTER_COUNT) * (1 + MAX_LIGHTS_PER_CLUSTER) * sizeof(uint32_t);
+
+	// Exponential depth slicing: slice = floor(log(view_depth) * scale + bias)
+	// Returns {near, far, scale, bias}, uploaded as UniformBufferObject::cluster_depth
+	inline bud::math::vec4 light_cluster_depth_params(float near_plane, float far_plane) {
+		float near_z = std::max(near_plane, 1e-3f);
+		float far_z = std::max(far_plane, near_z * 1.01f);
+		float log_range = std::log(far_z / near_z);
+		float scale = static_cast<float>(LIGHT_CLUSTER_Z) / log_range;
+		float bias = -static_cast<float>(LIGHT_CLUSTER_Z) * std::log(near_z) / log_range;
+		return { near_z, far_z, scale, bias };
+	}
+
+	// Dynamic resolution: targets stay output-sized, the main view only renders the top-left scaled extent
+	constexpr uint32_t RENDER_SCALE_HISTORY_SIZE = 120;
+
+	inline uint32_t scaled_extent(uint32_t extent, float scale) {
+		return std::clamp(static_cast<uint32_t>(static_cast<float>(extent) * scale + 0.5f), 1u, std::max(extent, 1u));
+	}
+
+	// GPU timestamp scopes; results show up in RenderStats::gpu_timer_ms once the frame slot comes around again
+	enum class GPUTimer : uint32_t {
+		MainView,         // Forward main pass, or visibility raster + material resolve
+		VisibilityRaster,
+		MaterialResolve,
+		LightAssignment,  // Light to cluster compute pass
+		ZPrepass,
+		InstanceCulling,  // Hi-Z instance culling + indirect-count compaction
+		MeshletCulling,
+		ShadowCulling,    // Per-cascade compaction of the shadow draw list
+		ShadowDraw,       // CSM cascades, cache copy included
+		Frame,            // Whole render graph, drives dynamic resolution
+		Count
+	};
+	constexpr uint32_t GPU_TIMER_COUNT = static_cast<uint32_t>(GPUTimer::Count);
+
+	// Depth-only passes with CPU-recorded draws, RenderStats::vertex_fetch_*
+	enum class VertexFetchPass : uint32_t {
+		ZPrepass,
+		ShadowStatic,  // Static shadow cache update, only on frames that rebuild it
+		Shadow,        // CPU cascade loop, the GPU-compacted lists are not counted
+		Count
+	};
+	constexpr uint32_t VERTEX_FETCH_PASS_COUNT = static_cast<uint32_t>(VertexFetchPass::Count);
+
+	// Passes sorted with their own key schema (bud.graphics.sortkey.hpp), RenderStats::sort_state_changes*
+	enum class SortKeyPass : uint32_t {
+		Opaque,   // Main view sort_list
+		Prepass,  // Z-prepass list, occluders or the full sort_list
+		Shadow,   // CPU cascade lists, summed over cascades
+		Count
+	};
+	constexpr uint32_t SORT_KEY_PASS_COUNT = static_cast<uint32_t>(SortKeyPass::Count);
 	// Enum, end
 
 	// POD, begin
@@ -118,6 +215,10 @@ namespace bud::graphics {
 		uint32_t inflight_frame_count = 3;
 		bool enable_validation = true;
 		bool vsync = false;
+		bool hidden_window = false;       // Never shown, for automated runs
+		DevicePreference device_preference = DevicePreference::Discrete;
+		double fixed_frame_time = 0.0;    // > 0: every frame advances by this many seconds instead of wall time
+		std::string shader_bundle = "src/shaders/shaders.budshaders";  // Empty: load SPIR-V files individually
 	};
 
 	struct RenderConfig {
@@ -140,9 +241,42 @@ namespace bud::graphics {
 		bool cache_shadows = false; // Disabled: feature has rendering bugs, enable when fixed
 
 		bool enable_gpu_driven = true;
+		bool enable_indirect_count = true; // Compact culled draws on GPU, falls back to full indirect list when unsupported
+		bool enable_meshlet_culling = true; // Per-meshlet frustum / cone / Hi-Z culling for the main view
+		bool enable_meshlet_cone_culling = true; // Backface cone test, skipped for double-sided submeshes
+		bool enable_cluster_lod = true; // Meshes cooked with --cluster-lod draw the meshlet cut matching cluster_lod_pixel_error
+		float cluster_lod_pixel_error = 1.0f; // Screen-space simplification error allowed, in pixels of the render resolution
+		bool prefer_mesh_shaders = true; // Draw surviving meshlets with task/mesh shaders when VK_EXT_mesh_shader is available
 		bool debug_hiz = false;
 		uint32_t debug_hiz_mip = 0;
+		// Z-prepass / Hi-Z only draw the top-K ranked occluders (OccluderSelector), K adapts to the prepass GPU time.
+		// Ignored on the visibility buffer path, its raster doesn't write depth and needs the full prepass.
+		bool enable_occluder_selection = true;
+		// Z-prepass and CPU shadow cascades re-sort with their own key schema (pipeline variant first),
+		// false keeps the opaque order for the prepass and the culling order for the cascades
+		bool enable_pass_sort_keys = true;
+		float occluder_prepass_budget_ms = 0.5f;
+		uint32_t occluder_min_count = 64;
+		uint32_t occluder_max_count = 4096;
+		float occluder_min_screen_area = 0.0005f; // Fraction of the viewport, smaller draws never become occluders
 		bool enable_cluster_visualization = false;
+		bool enable_visibility_buffer = false; // Main view: rasterize instance/triangle ids, shade in a compute resolve (needs enable_gpu_driven)
+		bool enable_clustered_lighting = true; // Point / spot lights of the RenderScene, culled into a froxel grid
+		bool cluster_lights_on_gpu = true; // Compute light assignment, false runs the CPU reference
+		bool debug_light_clusters = false; // Cluster visualization shows lights per cluster instead of meshlet colors
+		bool validate_light_clusters = false; // Read the compute grid back and compare it with the CPU reference (slow, tests)
+
+		bool enable_foliage = true; // Instanced FoliageSystem of the renderer (Renderer::set_foliage), main view and cascades
+		bool enable_foliage_shadows = true;
+
+		bool enable_hlod = true; // Region proxies of BudEngine::set_hlod replace their members beyond the switch distance
+		float hlod_distance_scale = 1.0f; // Multiplies every region's switch distance
+
+		bool enable_dynamic_resolution = false; // Main view renders at a scale picked from the frame time, then upscaled to the backbuffer
+		float dynamic_resolution_target_ms = 16.6f;
+		float dynamic_resolution_min_scale = 0.5f;
+		float dynamic_resolution_max_scale = 1.0f;
+		float upscale_sharpness = 0.25f; // 0: plain bilinear
 	};
 
 	struct SceneView {
@@ -170,6 +304,10 @@ namespace bud::graphics {
 		float light_intensity = 5.0f;
 		float ambient_strength = 0.05f;
 
+		uint32_t local_light_count = 0; // Lights in the clustered light buffer, 0 skips the local light loop
+		float render_scale = 1.0f;      // Fraction of the output extent the main view renders into (set by the renderer)
+		uint32_t view_index = 0;        // Uniform slot, 0 = main view (set by the renderer)
+
 		bool show_debug_stats = false;
 
 		void update_matrices() {
@@ -177,6 +315,18 @@ namespace bud::graphics {
 		}
 	};
 
+	// An extra view of the frame: a probe face, a split-screen player, an editor viewport. The caller sets the
+	// camera (matrices, position, planes, viewport size), lighting and shadow cascades follow the main view.
+	// It is drawn from the main view's culling traversal and instance upload into a viewport_width x
+	// viewport_height target; a non-empty overlay rect also blits it into that part of the backbuffer.
+	struct SecondaryView {
+		SceneView view;
+		int32_t overlay_x = 0;
+		int32_t overlay_y = 0;
+		uint32_t overlay_width = 0;
+		uint32_t overlay_height = 0;
+	};
+
 	struct VertexAttribute {
 		uint32_t location;
 		uint32_t binding = 0;
@@ -194,18 +344,29 @@ namespace bud::graphics {
 		std::string entry_point = "main";
 	};
 
+	// FoliageInstance (bud.graphics.foliage.hpp): vec3 position + packed yaw / scale
+	constexpr uint32_t FOLIAGE_INSTANCE_STRIDE = 16;
+
+	// Mesh layouts read VertexStreams: Pos from binding 0, everything else from binding 1.
+	// Instanced layouts add a per-instance FoliageInstance stream on binding 2: Position(5), YawScale(6).
 	enum class VertexLayoutType {
-		Default,      // Pos(0), Color(1), Normal(2), UV(3)
-		PositionOnly, // Pos(0) only
+		Default,      // Pos(0), Color(1), Normal(2), UV(3), TexIndex(4)
+		PositionOnly, // Pos(0) only, the attribute stream is never fetched
 		PositionUV,   // Pos(0) and UV(3)
 		PositionNormal, // Pos(0) and Normal(2)
 		NoVertexInput,// For self-generating vertices (Fullscreen)
-		ImGui         // Special ImGui layout (0,1,2)
+		ImGui,        // Special ImGui layout (0,1,2)
+		Instanced,           // Default + instance stream
+		InstancedPositionUV, // PositionUV + instance stream
+		InstanceOnly         // Instance stream only, corners come from gl_VertexIndex (impostor cards)
 	};
 
 	struct GraphicsPipelineDesc {
 		ShaderStage vs;
 		ShaderStage fs;
+		// Mesh shader pipeline when ms.code is non-empty: vs and vertex_layout are ignored, ts is optional
+		ShaderStage ts;
+		ShaderStage ms;
 		bool depth_test = true;
 		bool depth_write = true;
 		CompareOp depth_compare_op = CompareOp::Less;
@@ -231,6 +392,16 @@ namespace bud::graphics {
 		bool is_valid() const { return internal_state != nullptr; }
 	};
 
+	// Split vertex streams of the geometry pool, both ranges of the same buffer.
+	// Mesh vertex layouts read positions from binding 0 and attributes from binding 1.
+	struct VertexStreams {
+		BufferHandle positions;
+		BufferHandle attributes;
+		BufferHandle pool;        // Whole buffer, bound as storage by the mesh shader and the visibility resolve
+
+		bool is_valid() const { return positions.is_valid() && attributes.is_valid(); }
+	};
+
 	class Texture;
 
 	using CommandHandle = void*;
@@ -273,22 +444,119 @@ namespace bud::graphics {
 		uint32_t meshlet_count;
 		uint32_t material_id;
 		bool double_sided = false;
+		uint32_t lod_meshlet_count = 0; // Cluster LOD: meshlets of every level from meshlet_start, 0 = flat
 
 		bud::math::AABB aabb;
 		bud::math::BoundingSphere sphere;
 	};
 
+	// Meshlet record in the global meshlet pool (std430, matches `Meshlet` in meshlet_cull.comp / meshlet.mesh)
+	struct GPUMeshlet {
+		float sphere[4];          // Object-space bounding sphere (xyz, radius)
+		uint32_t cone;            // Packed int8 cone axis xyz + cutoff (meshopt s8 encoding)
+		uint32_t first_index;     // Expanded triangle list in the geometry pool index buffer (mesh-relative indices)
+		uint32_t index_count;
+		uint32_t data_offset;     // Meshlet data pool: vertex_count pool vertex indices, then triangle_count * 3 local indices
+		uint32_t vertex_count;
+		uint32_t triangle_count;
+		uint32_t padding[2];
+	};
+	static_assert(sizeof(GPUMeshlet) == 48, "GPUMeshlet must match the std430 layout used by the meshlet shaders");
+
+	// Cluster LOD bounds parallel to the meshlet pool (std430, `MeshletLod` in meshlet_cull.comp), see bud.cluster_lod.hpp
+	struct GPUMeshletLod {
+		float sphere[4];          // Self group: object-space center, radius
+		float parent_sphere[4];
+		float error;              // Object space, 0 for source meshlets
+		float parent_error;       // FLT_MAX without a parent
+		uint32_t padding[2];
+	};
+	static_assert(sizeof(GPUMeshletLod) == 48, "GPUMeshletLod must match the std430 layout of meshlet_cull.comp");
+
+	enum class LocalLightType : uint32_t {
+		Point = 0,
+		Spot = 1
+	};
+
+	// World-space point / spot light (std430, matches `LocalLight` in main.frag / light_cluster_assign.comp)
+	struct GPULocalLight {
+		bud::math::vec3 position;
+		float range;
+		bud::math::vec3 color;
+		float intensity;
+		bud::math::vec3 direction;  // Spot only, normalized
+		float spot_cos_outer;
+		float spot_cos_inner;
+		uint32_t type;              // LocalLightType
+		uint32_t padding[2];
+	};
+	static_assert(sizeof(GPULocalLight) == 64, "GPULocalLight must match the std430 layout used by the lighting shaders");
+
+	// Draw flags, stored in the top bits of the packed material / meshlet count words below
+	enum DrawFlags : uint32_t {
+		DrawFlag_Static = 1u << 0,
+		DrawFlag_DoubleSided = 1u << 1   // No meshlet cone culling
+	};
+	constexpr uint32_t DRAW_PACKED_VALUE_BITS = 24;
+	constexpr uint32_t DRAW_PACKED_VALUE_MASK = (1u << DRAW_PACKED_VALUE_BITS) - 1u;
+
+	inline uint32_t pack_draw_value(uint32_t value, uint32_t flags) {
+		return (value & DRAW_PACKED_VALUE_MASK) | (flags << DRAW_PACKED_VALUE_BITS);
+	}
+
+	// Per draw slot record of GlobalInstanceData, indexed by gl_InstanceIndex (= firstInstance)
+	struct GPUDrawInstance {
+		uint32_t instance_index;  // GPUInstanceTransform of the entity, shared by all of its draws this frame
+		uint32_t material_flags;  // pack_draw_value(material_id, DrawFlags)
+	};
+	static_assert(sizeof(GPUDrawInstance) == 8, "GPUDrawInstance must match load_draw_instance in instance_data.glsl");
+
+	// 3x4 affine world transform: the first three rows of the model matrix, translation in w
+	struct GPUInstanceTransform {
+		bud::math::vec4 rows[3];
+	};
+	static_assert(sizeof(GPUInstanceTransform) == 48, "GPUInstanceTransform must match load_instance_transform in instance_data.glsl");
+
+	// GlobalInstanceData (set 0 binding 3, compute binding 7), read by the shaders as uvec4 words:
+	//   header      uvec4 {first transform word, draw slot count, instance count, 0}
+	//   draw slots  GPUDrawInstance[draw_count], two per word
+	//   instances   GPUInstanceTransform[instance_count], starting on a word boundary
+	constexpr uint64_t INSTANCE_DATA_HEADER_SIZE = 16;
+
+	inline uint64_t instance_data_transform_offset(uint64_t draw_count) {
+		return INSTANCE_DATA_HEADER_SIZE + ((draw_count * sizeof(GPUDrawInstance) + 15) & ~uint64_t(15));
+	}
+
+	inline uint64_t instance_data_size(uint64_t draw_count, uint64_t instance_count) {
+		return instance_data_transform_offset(draw_count) + instance_count * sizeof(GPUInstanceTransform);
+	}
+
+	// Culling input of the GPU-driven passes (std430, matches `DrawData` in hiz_cull.comp / shadow_cull.comp /
+	// meshlet_cull.comp / vis_resolve.comp). Indexed by draw slot like GPUDrawInstance.
+	struct GPUDrawData {
+		uint32_t index_count;
+		uint32_t first_index;
+		int32_t vertex_offset;
+		uint32_t meshlet_offset;       // First GPUMeshlet in the geometry pool
+		bud::math::vec3 min;           // World AABB
+		uint32_t meshlet_count_flags;  // pack_draw_value(meshlet count, DrawFlags), count 0 = drawn whole
+		bud::math::vec3 max;
+		uint32_t record_base;          // Fixed command slot when the meshlet list cannot be compacted
+	};
+	static_assert(sizeof(GPUDrawData) == 48, "GPUDrawData must match the std430 layout used by the culling shaders");
+
+	// Record sizes before the compact layout (mat4 + material per draw slot, 64-byte DrawData), kept for the upload report
+	constexpr uint64_t LEGACY_INSTANCE_RECORD_SIZE = 80;
+	constexpr uint64_t LEGACY_DRAW_RECORD_SIZE = 64;
+
 	struct RenderMesh {
 		// Offsets into the global Geometry Pool Mega-Buffers
 		uint32_t first_index = 0;
 		int32_t  vertex_offset = 0;
 		uint32_t index_count = 0;
 
-		// GPU-Driven Meshlet data
-		BufferHandle meshlet_buffer;
-		BufferHandle vertex_index_buffer;
-		BufferHandle meshlet_index_buffer;
-		BufferHandle cull_data_buffer;
+		// GPU-Driven Meshlet data: SubMesh::meshlet_start is relative to first_meshlet in the meshlet pool
+		uint32_t first_meshlet = 0;
 		uint32_t meshlet_count = 0;
 
 		bud::math::AABB aabb;
@@ -305,6 +573,15 @@ namespace bud::graphics {
 		uint32_t visibleTriangles = 0;
 		uint32_t totalMeshlets = 0;
 		uint32_t visibleMeshlets = 0;
+		uint32_t shadowTotalDraws = 0;   // Shadow draw records tested (summed over cascades)
+		uint32_t shadowVisibleDraws = 0; // Shadow draw records emitted into compacted cascade lists
+		uint32_t meshletsTested = 0;          // Meshlets of Hi-Z visible draws
+		uint32_t meshletsCulledFrustum = 0;
+		uint32_t meshletsCulledCone = 0;
+		uint32_t meshletsCulledOcclusion = 0;
+		uint32_t meshletTrianglesTested = 0;
+		uint32_t meshletTrianglesVisible = 0; // Includes whole draws of meshes without meshlets
+		uint32_t meshletsCulledLod = 0;       // Cluster LOD: not in the cut of this view
 	};
 
 
@@ -320,6 +597,51 @@ namespace bud::graphics {
 		uint32_t drawn_triangles = 0; // Total accumulated across ALL render passes (Shadows, etc)
 		uint32_t pipeline_binds = 0;
 
+		// Indirect 指标: 命令处理器需要遍历的 indirect 记录数 (compacted vs full list)
+		uint32_t indirect_records_submitted = 0;
+		uint32_t indirect_count_draws = 0;
+		uint32_t gpu_compacted_draws = 0;
+		uint32_t gpu_shadow_total_draws = 0;
+		uint32_t gpu_shadow_visible_draws = 0;
+
+		// Meshlet 剔除指标 (0: off, 1: compute + indirect, 2: task/mesh shader)
+		uint32_t meshlet_cull_path = 0;
+		uint32_t gpu_meshlets_tested = 0;
+		uint32_t gpu_meshlets_culled_frustum = 0;
+		uint32_t gpu_meshlets_culled_cone = 0;
+		uint32_t gpu_meshlets_culled_occlusion = 0;
+		uint32_t gpu_meshlets_culled_lod = 0; // Cluster LOD levels outside the cut
+		uint32_t gpu_triangles_culled = 0; // Instance + meshlet level, main view
+		uint32_t cluster_lod_meshes = 0;   // Uploaded meshes carrying a cluster LOD hierarchy
+
+		// Main view 路径 (0: forward, 1: visibility buffer) 与 GPU timestamp 耗时 (ms)
+		uint32_t main_view_path = 0;
+		float gpu_timer_ms[GPU_TIMER_COUNT] = {};
+
+		// Clustered lighting (0: off, 1: CPU reference, 2: compute), lights per cluster over non-empty clusters
+		uint32_t light_assign_path = 0;
+		uint32_t local_lights = 0;
+		uint32_t light_cluster_refs = 0;
+		uint32_t light_clusters_active = 0;
+		uint32_t light_cluster_max = 0;
+		uint32_t light_cluster_overflow = 0;
+		float light_assign_cpu_ms = 0.0f;
+		uint32_t light_cluster_validated = 0;   // 1 when a compute grid was checked against the CPU reference this frame
+		uint32_t light_cluster_mismatches = 0;  // Clusters of that grid whose lights differ from the reference
+
+		// Dynamic resolution: controller input vs budget, adherence = frames within budget since it was enabled
+		bool dynamic_resolution = false;
+		float render_scale = 1.0f;
+		uint32_t render_width = 0;
+		uint32_t render_height = 0;
+		float dynres_target_ms = 0.0f;
+		float dynres_frame_ms = 0.0f;
+		bool dynres_gpu_timed = false; // false: no timestamp queries, the CPU frame time drives the scale
+		float dynres_adherence = 0.0f; // %
+		uint32_t dynres_frames_over_budget = 0;
+		float render_scale_history[RENDER_SCALE_HISTORY_SIZE] = {};
+		uint32_t render_scale_history_offset = 0; // Oldest entry, ImGui::PlotLines values_offset
+
 		// 剔除指标 (GPU Occlusion Culling)
 		uint32_t gpu_total_objects = 0;
 		uint32_t gpu_visible_objects = 0;
@@ -340,17 +662,88 @@ namespace bud::graphics {
 		uint32_t cpu_total_meshlets = 0;
 		uint32_t cpu_visible_meshlets = 0;
 
-		// ML Occluder Stats
+		// Occluder selection (Z-prepass / Hi-Z input), estimated = hidden in the CPU tile grid
 		uint32_t occluder_count = 0;
 		uint32_t occluder_triangles = 0;
+		uint32_t occluder_candidates = 0;
+		uint32_t occluder_budget = 0;
+		uint32_t occluder_estimated_occluded = 0;
+		float occluder_select_ms = 0.0f;
+		// Hi-Z instance culling, GPU readback of an earlier frame
+		uint32_t occlusion_tested = 0;
+		uint32_t occlusion_culled = 0;
 
 		uint32_t shadow_casters = 0;
 		uint32_t shadow_caster_submeshes = 0;
 
+		// Vertex fetch of the depth-only passes in bytes, one fetch per index (no post-transform reuse):
+		// split streams as drawn vs the same draws on the former 48-byte interleaved vertex
+		uint64_t vertex_fetch_bytes[VERTEX_FETCH_PASS_COUNT] = {};
+		uint64_t vertex_fetch_interleaved_bytes[VERTEX_FETCH_PASS_COUNT] = {};
+		uint32_t depth_opaque_draws = 0;   // Position-only pipeline
+		uint32_t depth_masked_draws = 0;   // Alpha-tested, position + UV
+
+		// GlobalInstanceData + GPUDrawData written this frame, and what the same draws cost with the legacy records
+		uint64_t instance_upload_bytes = 0;
+		uint64_t instance_upload_legacy_bytes = 0;
+		uint64_t instance_memory_bytes = 0;  // Instance / draw buffers of every frame slot
+		uint64_t instance_memory_legacy_bytes = 0;
+		uint32_t gpu_draw_slots = 0;
+		uint32_t gpu_instances = 0;          // Transforms, one per entity with at least one draw
+
+		// State changes (count_state_changes of the pass schema) in the order drawn vs the order before the pass sort
+		uint32_t sort_state_changes[SORT_KEY_PASS_COUNT] = {};
+		uint32_t sort_state_changes_unsorted[SORT_KEY_PASS_COUNT] = {};
+		uint32_t sort_key_overflows = 0;  // Keys with a value clamped to its field width (DrawKey::take_overflows)
+
+		// Multi-view: views drawn this frame, draws per view (0 = main) and the shared draw list they index
+		uint32_t view_count = 0;
+		uint32_t view_draws[MAX_VIEWS] = {};
+		uint32_t shared_draws = 0;
+
+		// Foliage: cells / instances of the main view cull, draw calls summed over the main view and the cascades
+		uint32_t foliage_cells_total = 0;
+		uint32_t foliage_cells_visible = 0;
+		uint32_t foliage_mesh_instances = 0;
+		uint32_t foliage_impostor_instances = 0;
+		uint32_t foliage_shadow_instances = 0; // Summed over the cascades
+		uint32_t foliage_draws = 0;
+		float foliage_cull_ms = 0.0f;
+
+		// HLOD: regions drawn as their proxy and what the proxies saved over the member submeshes
+		uint32_t hlod_regions = 0;
+		uint32_t hlod_regions_active = 0;
+		uint32_t hlod_draws_saved = 0;
+		uint64_t hlod_triangles_saved = 0;
+
 		void reset() {
 			draw_calls = 0;
 			drawn_triangles = 0;
 			pipeline_binds = 0;
+			indirect_records_submitted = 0;
+			indirect_count_draws = 0;
+			gpu_compacted_draws = 0;
+			gpu_shadow_total_draws = 0;
+			gpu_shadow_visible_draws = 0;
+			meshlet_cull_path = 0;
+			gpu_meshlets_tested = 0;
+			gpu_meshlets_culled_frustum = 0;
+			gpu_meshlets_culled_cone = 0;
+			gpu_meshlets_culled_occlusion = 0;
+			gpu_meshlets_culled_lod = 0;
+			gpu_triangles_culled = 0;
+			cluster_lod_meshes = 0;
+			main_view_path = 0;
+			for (auto& ms : gpu_timer_ms) ms = 0.0f;
+			light_assign_path = 0;
+			local_lights = 0;
+			light_cluster_refs = 0;
+			light_clusters_active = 0;
+			light_cluster_max = 0;
+			light_cluster_overflow = 0;
+			light_assign_cpu_ms = 0.0f;
+			light_cluster_validated = 0;
+			light_cluster_mismatches = 0;
 			gpu_total_objects = 0;
 			gpu_visible_objects = 0;
 			gpu_total_instances = 0;
@@ -369,8 +762,41 @@ namespace bud::graphics {
 			cpu_visible_meshlets = 0;
 			occluder_count = 0;
 			occluder_triangles = 0;
+			occluder_candidates = 0;
+			occluder_budget = 0;
+			occluder_estimated_occluded = 0;
+			occluder_select_ms = 0.0f;
+			occlusion_tested = 0;
+			occlusion_culled = 0;
 			shadow_casters = 0;
 			shadow_caster_submeshes = 0;
+			for (auto& bytes : vertex_fetch_bytes) bytes = 0;
+			for (auto& bytes : vertex_fetch_interleaved_bytes) bytes = 0;
+			depth_opaque_draws = 0;
+			depth_masked_draws = 0;
+			instance_upload_bytes = 0;
+			instance_upload_legacy_bytes = 0;
+			instance_memory_bytes = 0;
+			instance_memory_legacy_bytes = 0;
+			gpu_draw_slots = 0;
+			gpu_instances = 0;
+			for (auto& changes : sort_state_changes) changes = 0;
+			for (auto& changes : sort_state_changes_unsorted) changes = 0;
+			sort_key_overflows = 0;
+			view_count = 0;
+			for (auto& draws : view_draws) draws = 0;
+			shared_draws = 0;
+			foliage_cells_total = 0;
+			foliage_cells_visible = 0;
+			foliage_mesh_instances = 0;
+			foliage_impostor_instances = 0;
+			foliage_shadow_instances = 0;
+			foliage_draws = 0;
+			foliage_cull_ms = 0.0f;
+			hlod_regions = 0;
+			hlod_regions_active = 0;
+			hlod_draws_saved = 0;
+			hlod_triangles_saved = 0;
 		}
 
 
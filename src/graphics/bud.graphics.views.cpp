@@ -0,0 +1,34 @@
+﻿#include <algorithm>
+
+#include "src/graphics/bud.graphics.views.hpp"
+
+namespace bud::graphics {
+
+	void filter_view_draws(const RenderScene& render_scene, const SubmeshTable& table, const bud::math::Frustum& frustum,
+		uint32_t view, const std::vector<ViewMask>& masks, const std::vector<SortItem>& sort_list, size_t count, ViewDrawList& out) {
+		out.clear();
+		const ViewMask bit = static_cast<ViewMask>(1u << view);
+		const SubmeshFrustumTest test(frustum);
+
+		count = std::min(count, sort_list.size());
+		for (size_t i = 0; i < count; ++i) {
+			const SortItem& item = sort_list[i];
+			const uint32_t entity = item.entity_index;
+			if (entity >= masks.size() || !(masks[entity] & bit)) continue;
+
+			// The instance AABB already passed the traversal; a draw without a table row (NO_ROW) keeps that result
+			const uint32_t mesh_id = render_scene.mesh_indices[entity];
+			if (mesh_id < table.mesh_count() && item.submesh_index < table.mesh_row_count[mesh_id]) {
+				const auto& world_matrix = render_scene.world_matrices[entity];
+				const bud::math::mat3 linear(world_matrix);
+				bud::math::mat3 abs_linear;
+				for (int c = 0; c < 3; ++c) abs_linear[c] = glm::abs(linear[c]);
+				if (!test.contains(table, table.mesh_first_row[mesh_id] + item.submesh_index, linear, abs_linear, bud::math::vec3(world_matrix[3])))
+					continue;
+			}
+
+			out.items.push_back(item);
+			out.slots.push_back(static_cast<uint32_t>(i));
+		}
+	}
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "src/core/bud.math.hpp"
+#include "src/graphics/bud.graphics.types.hpp"
+#include "src/graphics/bud.graphics.scene.hpp"
+#include "src/graphics/bud.graphics.sortkey.hpp"
+#include "src/graphics/bud.graphics.submeshes.hpp"
+
+namespace bud::graphics {
+
+	// Draws of one secondary view, taken from the shared sorted list. slots[i] is the instance slot of
+	// items[i] in the shared upload, so every view draws the same instance data the main view uploaded.
+	struct ViewDrawList {
+		std::vector<SortItem> items;
+		std::vector<uint32_t> slots;
+
+		void clear() {
+			items.clear();
+			slots.clear();
+		}
+	};
+
+	// Keeps the draws of sort_list[0, count) that view bit `view` sees: the instance must carry the bit in
+	// masks (indexed by entity) and its submesh row must pass the view's frustum. Shared order is kept,
+	// so the view inherits the state sort of the main list.
+	void filter_view_draws(const RenderScene& render_scene, const SubmeshTable& table, const bud::math::Frustum& frustum,
+		uint32_t view, const std::vector<ViewMask>& masks, const std::vector<SortItem>& sort_list, size_t count, ViewDrawList& out);
+}
@@ -10,6 +10,7 @@
 #include <fstream>
 #include <chrono>
 #include <format>
+#include <cstring>
 
 #include <vulkan/vulkan.h>
 #include <SDL3/SDL.h>
@@ -24,6 +25,7 @@
 #include "src/core/bud.math.hpp"
 #include "src/platform/bud.platform.hpp"
 #include "src/core/bud.logger.hpp"
+#include "src/core/bud.frame.stats.hpp"
 #include "src/threading/bud.threading.hpp"
 #include "src/graphics/bud.graphics.types.hpp"
 #include "src/graphics/vulkan/bud.vulkan.types.hpp"
@@ -48,6 +50,7 @@ struct VulkanPipelineObject {
 	VkPipeline pipeline;
 	VkPipelineLayout layout;
 	VkPipelineBindPoint bind_point;
+	VkShaderStageFlags push_stages = 0; // 0: derive from bind_point (VS|FS or CS)
 };
 
 #ifdef BUD_ENABLE_AFTERMATH
@@ -148,13 +151,29 @@ void VulkanRHI::init(bud::platform::Window* plat_window, bud::threading::TaskSch
 	// Binding 0: UBO (std140)
 	// Binding 1: Sampler2D[] (Bindless, Variable Count / Partial Bound)
 	// Binding 2: ShadowMap (Sampler2DShadow)
+	// Binding 3: InstanceData SSBO
+	// Binding 4..7: Meshlet pool / meshlet data / vertex pool / visible meshlet list (mesh shader path only)
+	// Binding 8..9: Local lights / light cluster grid (clustered lighting, partially bound)
+	// Bindings 1 and 2 are also visible to compute, the visibility buffer resolve binds this set as set 1
+
+	const VkShaderStageFlags mesh_stages = mesh_shader_supported ? (VK_SHADER_STAGE_TASK_BIT_EXT | VK_SHADER_STAGE_MESH_BIT_EXT) : 0;
 
 	DescriptorLayoutBuilder layout_builder;
-	layout_builder.add_binding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT);
-	layout_builder.add_binding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT, 1000,
+	layout_builder.add_binding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT | mesh_stages);
+	layout_builder.add_binding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT, 1000,
 		VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT);
-	layout_builder.add_binding(2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT, 1, VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT);
-	layout_builder.add_binding(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_VERTEX_BIT, 1, VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT);
+	layout_builder.add_binding(2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT, 1, VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT);
+	layout_builder.add_binding(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_VERTEX_BIT | mesh_stages, 1, VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT);
+	if (mesh_shader_supported) {
+		for (uint32_t binding = 4; binding <= 7; ++binding) {
+			layout_builder.add_binding(binding, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, mesh_stages, 1,
+				VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT);
+		}
+	}
+	for (uint32_t binding = 8; binding <= 9; ++binding) {
+		layout_builder.add_binding(binding, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT, 1,
+			VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT);
+	}
 
 	global_set_layout = layout_builder.build(device, 0, nullptr, VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT);
 
@@ -166,14 +185,27 @@ void VulkanRHI::init(bud::platform::Window* plat_window, bud::threading::TaskSch
 	compute_builder.add_binding(3, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT); // HiZ / Mip In
 	compute_builder.add_binding(4, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT); // UBO
 	compute_builder.add_binding(5, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT); // HiZ Out
+	compute_builder.add_binding(6, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT); // Meshlet Pool
+	compute_builder.add_binding(7, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT); // InstanceData
+	compute_builder.add_binding(8, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT); // Visible Meshlet List / Pixel List
+	compute_builder.add_binding(9, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT); // Index Pool
+	compute_builder.add_binding(10, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT); // Vertex Pool
+	compute_builder.add_binding(11, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT); // Meshlet LOD Pool
 	compute_set_layout = compute_builder.build(device, 0, nullptr, VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR);
 
-	// 创建 Per-Frame UBO Buffers (Binding 0)
+	// 创建 Per-Frame UBO Buffers (Binding 0), one slot per view of the frame
 	VkDeviceSize ubo_size = sizeof(UniformBufferObject);
+	{
+		VkPhysicalDeviceProperties props;
+		vkGetPhysicalDeviceProperties(physical_device, &props);
+		const VkDeviceSize alignment = std::max<VkDeviceSize>(props.limits.minUniformBufferOffsetAlignment, 1);
+		uniform_stride = (ubo_size + alignment - 1) / alignment * alignment;
+	}
+	const VkDeviceSize uniform_buffer_size = uniform_stride * MAX_VIEWS;
 	for (auto& frame : frames) {
 		VkBufferCreateInfo buffer_info{};
 		buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-		buffer_info.size = ubo_size;
+		buffer_info.size = uniform_buffer_size;
 		buffer_info.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
 		buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
@@ -206,20 +238,22 @@ void VulkanRHI::init(bud::platform::Window* plat_window, bud::threading::TaskSch
 		}
 
 		vkBindBufferMemory(device, frame.uniform_buffer, frame.uniform_memory, 0);
-		vkMapMemory(device, frame.uniform_memory, 0, ubo_size, 0, &frame.uniform_mapped);
+		vkMapMemory(device, frame.uniform_memory, 0, uniform_buffer_size, 0, &frame.uniform_mapped);
 	}
 
 	// 创建全局 Descriptor Pool (支持 Bindless + UPDATE_AFTER_BIND)
 	{
+		// The global set and its secondary view copies
+		const uint32_t set_count = (uint32_t)frames.size() * MAX_VIEWS;
 		std::vector<VkDescriptorPoolSize> pool_sizes = {
-			{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, (uint32_t)frames.size() },
-			{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, (uint32_t)frames.size() * 1001 }, // 1000 bindless + 1 shadow
-			{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, (uint32_t)frames.size() }
+			{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, set_count },
+			{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, set_count * 1001 }, // 1000 bindless + 1 shadow
+			{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, set_count * 7 } // Instance data + 4 meshlet buffers + lights + light clusters
 		};
 
 		VkDescriptorPoolCreateInfo pool_info{ VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
 		pool_info.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
-		pool_info.maxSets = (uint32_t)frames.size();
+		pool_info.maxSets = set_count;
 		pool_info.poolSizeCount = (uint32_t)pool_sizes.size();
 		pool_info.pPoolSizes = pool_sizes.data();
 
@@ -318,6 +352,16 @@ void VulkanRHI::init(bud::platform::Window* plat_window, bud::threading::TaskSch
 		writer.write_image(2, 0, dummy_depth_texture.view, shadow_sampler, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
 
 		writer.update_set(device, frame.global_descriptor_set);
+
+		for (uint32_t v = 0; v < MAX_VIEWS - 1; ++v) {
+			if (vkAllocateDescriptorSets(device, &alloc_info, &frame.view_descriptor_sets[v]) != VK_SUCCESS) {
+				throw std::runtime_error("failed to allocate view descriptor set!");
+			}
+
+			DescriptorWriter view_writer;
+			view_writer.write_buffer(0, frame.uniform_buffer, ubo_size, (v + 1) * uniform_stride, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+			view_writer.update_set(device, frame.view_descriptor_sets[v]);
+		}
 	}
 
 	// 创建 Fallback 纹理 (Index 0)
@@ -387,6 +431,8 @@ void VulkanRHI::cleanup() {
 			vkDestroySemaphore(device, frames[i].image_available_semaphore, nullptr);
 		if (frames[i].in_flight_fence)
 			vkDestroyFence(device, frames[i].in_flight_fence, nullptr);
+		if (frames[i].timestamp_pool)
+			vkDestroyQueryPool(device, frames[i].timestamp_pool, nullptr);
 		if (frames[i].main_command_pool)
 			vkDestroyCommandPool(device, frames[i].main_command_pool, nullptr);
 	}
@@ -423,7 +469,7 @@ void VulkanRHI::wait_idle() {
 }
 
 
-bud::graphics::BufferHandle VulkanRHI::create_gpu_buffer(uint64_t size, bud::graphics::ResourceState usage_state) {
+bud::graphics::BufferHandle VulkanRHI::create_gpu_buffer(uint64_t size, bud::graphics::ResourceState usage_state, bud::graphics::MemoryUsage memory_usage) {
 	VkBufferCreateInfo buffer_info{ VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
 	buffer_info.size = size;
 	buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
@@ -431,11 +477,12 @@ bud::graphics::BufferHandle VulkanRHI::create_gpu_buffer(uint64_t size, bud::gra
 	buffer_info.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
 
 	// Always set the correct usage flags for vertex and index buffers
+	// Geometry is also fetched as storage buffers by the mesh shader path
 	if (usage_state == bud::graphics::ResourceState::VertexBuffer) {
-		buffer_info.usage |= VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+		buffer_info.usage |= VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
 	}
 	if (usage_state == bud::graphics::ResourceState::IndexBuffer) {
-		buffer_info.usage |= VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+		buffer_info.usage |= VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
 	}
 	if (usage_state == bud::graphics::ResourceState::IndirectArgument) {
 		buffer_info.usage |= VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT; 
@@ -450,11 +497,16 @@ bud::graphics::BufferHandle VulkanRHI::create_gpu_buffer(uint64_t size, bud::gra
 	VmaAllocationCreateInfo alloc_info = {};
 	alloc_info.usage = VMA_MEMORY_USAGE_AUTO;
 	
-	// For UAV/TransferSrc buffers (like our stats counter), ensure host access so we can map it for readback.
-	if (usage_state == bud::graphics::ResourceState::UnorderedAccess || (buffer_info.usage & VK_BUFFER_USAGE_TRANSFER_SRC_BIT)) {
+	// GPU scratch (culling lists, resolve bins ...) stays device local, the UAV state alone no longer maps it.
+	// Readback buffers (the stats counter) are read at random by the CPU, the other host placements are only written.
+	if (memory_usage == bud::graphics::MemoryUsage::Readback) {
 		alloc_info.flags |= VMA_ALLOCATION_CREATE_MAPPED_BIT | VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT;
 		alloc_info.requiredFlags |= VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
 	}
+	else if (memory_usage != bud::graphics::MemoryUsage::GpuOnly) {
+		alloc_info.flags |= VMA_ALLOCATION_CREATE_MAPPED_BIT | VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT;
+		alloc_info.requiredFlags |= VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+	}
 
     auto* vk_buf = new bud::graphics::vulkan::VulkanBuffer();
     auto vma_allocator = get_memory_allocator()->get_vma_allocator();
@@ -527,10 +579,20 @@ VkShaderModule create_shader_module(VkDevice device, const std::vector<char>& co
 }
 
 void* VulkanRHI::create_graphics_pipeline(const GraphicsPipelineDesc& desc) {
+	const bool is_mesh_pipeline = !desc.ms.code.empty();
+	if (is_mesh_pipeline && !mesh_shader_supported) {
+		bud::eprint("[Vulkan] create_graphics_pipeline: mesh shader pipeline requested but VK_EXT_mesh_shader is not enabled");
+		return nullptr;
+	}
+
+	const VkShaderStageFlags push_stages = is_mesh_pipeline
+		? (VK_SHADER_STAGE_TASK_BIT_EXT | VK_SHADER_STAGE_MESH_BIT_EXT | VK_SHADER_STAGE_FRAGMENT_BIT)
+		: (VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT);
+
 	VkPushConstantRange push_constant;
 	push_constant.offset = 0;
 	push_constant.size = 256; // Enough for standard matrices
-	push_constant.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+	push_constant.stageFlags = push_stages;
 
 	VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
 	pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
@@ -549,17 +611,39 @@ void* VulkanRHI::create_graphics_pipeline(const GraphicsPipelineDesc& desc) {
 		throw std::runtime_error("failed to create pipeline layout!");
 	}
 
-    VkShaderModule vertModule = create_shader_module(device, desc.vs.code);
-    if (vertModule == VK_NULL_HANDLE) {
-        // failed to create vertex module, cleanup and return
-        vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
-        return nullptr;
+    VkShaderModule vertModule = VK_NULL_HANDLE;
+    VkShaderModule taskModule = VK_NULL_HANDLE;
+    VkShaderModule meshModule = VK_NULL_HANDLE;
+    auto destroy_geometry_modules = [&]() {
+        if (vertModule) vkDestroyShaderModule(device, vertModule, nullptr);
+        if (taskModule) vkDestroyShaderModule(device, taskModule, nullptr);
+        if (meshModule) vkDestroyShaderModule(device, meshModule, nullptr);
+    };
+
+    if (is_mesh_pipeline) {
+        meshModule = create_shader_module(device, desc.ms.code);
+        if (!desc.ts.code.empty()) {
+            taskModule = create_shader_module(device, desc.ts.code);
+        }
+        if (meshModule == VK_NULL_HANDLE || (!desc.ts.code.empty() && taskModule == VK_NULL_HANDLE)) {
+            // failed to create task/mesh module, cleanup and return
+            destroy_geometry_modules();
+            vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+            return nullptr;
+        }
+    } else {
+        vertModule = create_shader_module(device, desc.vs.code);
+        if (vertModule == VK_NULL_HANDLE) {
+            // failed to create vertex module, cleanup and return
+            vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+            return nullptr;
+        }
     }
 
     VkShaderModule fragModule = create_shader_module(device, desc.fs.code);
     if (fragModule == VK_NULL_HANDLE) {
         // failed to create fragment module, cleanup and return
-        vkDestroyShaderModule(device, vertModule, nullptr);
+        destroy_geometry_modules();
         vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
         return nullptr;
     }
@@ -651,13 +735,20 @@ void* VulkanRHI::create_graphics_pipeline(const GraphicsPipelineDesc& desc) {
     };
 
     if (enable_validation_layers) {
-        validate_spv_strict(desc.vs.code, "vertex");
+        if (is_mesh_pipeline) {
+            if (!desc.ts.code.empty()) validate_spv_strict(desc.ts.code, "task");
+            validate_spv_strict(desc.ms.code, "mesh");
+        } else {
+            validate_spv_strict(desc.vs.code, "vertex");
+        }
         validate_spv_strict(desc.fs.code, "fragment");
     }
 #endif
 
 	PipelineKey key{};
 	key.vert_shader = vertModule;
+	key.task_shader = taskModule;
+	key.mesh_shader = meshModule;
 	key.frag_shader = fragModule;
 	key.render_pass = VK_NULL_HANDLE;
 	key.depth_test = desc.depth_test;
@@ -689,12 +780,15 @@ void* VulkanRHI::create_graphics_pipeline(const GraphicsPipelineDesc& desc) {
 
 	VkPipeline pipeline = pipeline_cache->get_pipeline(key, pipelineLayout, is_depth_only);
 
-	vkDestroyShaderModule(device, vertModule, nullptr);
+	destroy_geometry_modules();
 	vkDestroyShaderModule(device, fragModule, nullptr);
 
-	VulkanPipelineObject* pipeObj = new VulkanPipelineObject{ pipeline, pipelineLayout, VK_PIPELINE_BIND_POINT_GRAPHICS };
+	VulkanPipelineObject* pipeObj = new VulkanPipelineObject{ pipeline, pipelineLayout, VK_PIPELINE_BIND_POINT_GRAPHICS, push_stages };
 
-	created_layouts.push_back(pipelineLayout);
+	{
+		std::lock_guard lock(created_layouts_mutex);
+		created_layouts.push_back(pipelineLayout);
+	}
 
 	return pipeObj;
 }
@@ -719,7 +813,8 @@ void* VulkanRHI::create_compute_pipeline(const ComputePipelineDesc& desc) {
 	VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
 	pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
 
-	std::vector<VkDescriptorSetLayout> setLayouts = { compute_set_layout };
+	// Set 0: push descriptors, set 1: global set (bindless textures + shadow map)
+	std::vector<VkDescriptorSetLayout> setLayouts = { compute_set_layout, global_set_layout };
 	pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
 	pipelineLayoutInfo.pSetLayouts = setLayouts.data();
 	pipelineLayoutInfo.pushConstantRangeCount = 1;
@@ -741,7 +836,10 @@ void* VulkanRHI::create_compute_pipeline(const ComputePipelineDesc& desc) {
     vkDestroyShaderModule(device, computeModule, nullptr);
 
 	VulkanPipelineObject* pipeObj = new VulkanPipelineObject{ pipeline, pipelineLayout, VK_PIPELINE_BIND_POINT_COMPUTE };
-	created_layouts.push_back(pipelineLayout);
+	{
+		std::lock_guard lock(created_layouts_mutex);
+		created_layouts.push_back(pipelineLayout);
+	}
 
 	return pipeObj;
 }
@@ -810,8 +908,8 @@ void VulkanRHI::cmd_dispatch(CommandHandle cmd, uint32_t group_x, uint32_t group
 					
 					VkDescriptorBufferInfo info{};
 					info.buffer = frame.uniform_buffer;
-					info.offset = 0;
-					info.range = VK_WHOLE_SIZE;
+					info.offset = current_view_slot * uniform_stride;
+					info.range = sizeof(UniformBufferObject);
 					buffer_infos.push_back(info);
 
 					write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
@@ -848,6 +946,21 @@ CommandHandle VulkanRHI::begin_frame() {
 
 	current_stats.reset();
 
+	// The fence above guarantees this slot's queries from inflight_frame_count frames ago are done
+	auto& frame = frames[current_frame];
+	if (frame.timestamp_pool) {
+		const uint32_t finished = frame.timers_begun & frame.timers_ended;
+		for (uint32_t t = 0; t < GPU_TIMER_COUNT; ++t) {
+			if (!(finished & (1u << t))) continue;
+			uint64_t ticks[2] = {};
+			if (vkGetQueryPoolResults(device, frame.timestamp_pool, t * 2, 2, sizeof(ticks), ticks, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) == VK_SUCCESS && ticks[1] >= ticks[0]) {
+				current_stats.gpu_timer_ms[t] = static_cast<float>(static_cast<double>(ticks[1] - ticks[0]) * timestamp_period_ns * 1e-6);
+			}
+		}
+		frame.timers_begun = 0;
+		frame.timers_ended = 0;
+	}
+
 	// 通知分配器新的一帧开始了 (重置 Linear Allocator)
 	memory_allocator->on_frame_begin(current_frame);
 	descriptor_allocators[current_frame].reset_frame();
@@ -857,8 +970,10 @@ CommandHandle VulkanRHI::begin_frame() {
 
 	// 更新 Descriptor Set 指向当前帧的 UBO
 	DescriptorWriter writer;
-	writer.write_buffer(0, frames[current_frame].uniform_buffer, VK_WHOLE_SIZE, 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
+	writer.write_buffer(0, frames[current_frame].uniform_buffer, sizeof(UniformBufferObject), 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER);
 	writer.update_set(device, frames[current_frame].global_descriptor_set);
+	frames[current_frame].view_sets_synced = 0;
+	current_view_slot = 0;
 
 	vkResetCommandBuffer(frames[current_frame].main_command_buffer, 0);
 
@@ -867,11 +982,16 @@ CommandHandle VulkanRHI::begin_frame() {
 		throw std::runtime_error("failed to begin recording command buffer!");
 	}
 
+	if (frame.timestamp_pool) {
+		vkCmdResetQueryPool(frames[current_frame].main_command_buffer, frame.timestamp_pool, 0, GPU_TIMER_COUNT * 2);
+	}
+
 	return frames[current_frame].main_command_buffer;
 }
 
 void VulkanRHI::end_frame(CommandHandle cmd) {
 	VkCommandBuffer command_buffer = static_cast<VkCommandBuffer>(cmd);
+	bud::frame_stats::PhaseTimer phase_timer;
 
 	if (vkEndCommandBuffer(command_buffer) != VK_SUCCESS)
 		throw std::runtime_error("failed to record command buffer!");
@@ -900,6 +1020,7 @@ void VulkanRHI::end_frame(CommandHandle cmd) {
         return;
 #endif
     }
+	phase_timer.lap(bud::frame_stats::FramePhase::Submit);
 
 	VkPresentInfoKHR present_info{ VK_STRUCTURE_TYPE_PRESENT_INFO_KHR };
 	present_info.waitSemaphoreCount = 1;
@@ -910,6 +1031,7 @@ void VulkanRHI::end_frame(CommandHandle cmd) {
 	present_info.pImageIndices = &current_image_index;
 
     VkResult present_result = vkQueuePresentKHR(present_queue, &present_info);
+	phase_timer.lap(bud::frame_stats::FramePhase::Present);
     if (present_result == VK_ERROR_OUT_OF_DATE_KHR || present_result == VK_SUBOPTIMAL_KHR) {
         swapchain_out_of_date.store(true, std::memory_order_release);
     } else if (present_result != VK_SUCCESS) {
@@ -1027,6 +1149,7 @@ void VulkanRHI::cmd_begin_render_pass(CommandHandle cmd, const RenderPassBeginIn
 
 void VulkanRHI::cmd_end_render_pass(CommandHandle cmd) {
 	vkCmdEndRendering(static_cast<VkCommandBuffer>(cmd));
+	current_view_slot = 0; // Passes that never update the uniforms (upscale, UI) bind the main view's set
 }
 
 void VulkanRHI::cmd_copy_buffer(CommandHandle cmd, bud::graphics::BufferHandle src, bud::graphics::BufferHandle dst, uint64_t size) {
@@ -1132,7 +1255,7 @@ void VulkanRHI::cmd_bind_pipeline(CommandHandle cmd, void* pipeline) {
 	current_stats.pipeline_binds++;
 }
 
-void VulkanRHI::cmd_bind_vertex_buffer(CommandHandle cmd, bud::graphics::BufferHandle buffer) {
+void VulkanRHI::cmd_bind_vertex_buffer(CommandHandle cmd, bud::graphics::BufferHandle buffer, uint32_t binding) {
     if (!buffer.is_valid()) {
         std::string err = std::format("cmd_bind_vertex_buffer invalid BufferHandle: valid={} offset={} size={}", buffer.is_valid(), buffer.offset, buffer.size);
         bud::eprint("{}", err);
@@ -1157,7 +1280,7 @@ void VulkanRHI::cmd_bind_vertex_buffer(CommandHandle cmd, bud::graphics::BufferH
     // Diagnostic: log vertex bind info
     //bud::print("[Vulkan][bind_vertex] VkBuffer={} byteOffset={} mapped_ptr={}", (void*)vk_buf->buffer, (uint64_t)buffer.offset, vk_buf->mapped_ptr);
 
-    vkCmdBindVertexBuffers(static_cast<VkCommandBuffer>(cmd), 0, 1, &vk_buf->buffer, offsets);
+    vkCmdBindVertexBuffers(static_cast<VkCommandBuffer>(cmd), binding, 1, &vk_buf->buffer, offsets);
 }
 
 void VulkanRHI::cmd_bind_index_buffer(CommandHandle cmd, bud::graphics::BufferHandle buffer) {
@@ -1216,11 +1339,69 @@ void VulkanRHI::cmd_draw_indexed_indirect(CommandHandle cmd, bud::graphics::Buff
     auto* vk_buf = static_cast<bud::graphics::vulkan::VulkanBuffer*>(buffer.internal_state);
 	vkCmdDrawIndexedIndirect(static_cast<VkCommandBuffer>(cmd), vk_buf->buffer, offset, draw_count, stride);
 	current_stats.draw_calls += draw_count; 
+	current_stats.indirect_records_submitted += draw_count;
+}
+
+void VulkanRHI::cmd_draw_indexed_indirect_count(CommandHandle cmd, bud::graphics::BufferHandle buffer, uint64_t offset, bud::graphics::BufferHandle count_buffer, uint64_t count_offset, uint32_t max_draw_count, uint32_t stride) {
+    if (!buffer.is_valid() || !count_buffer.is_valid() || !draw_indirect_count_supported) {
+        std::string err = std::format("cmd_draw_indexed_indirect_count invalid call: buffer_valid={} count_valid={} supported={} offset={} count_offset={}",
+            buffer.is_valid(), count_buffer.is_valid(), draw_indirect_count_supported, offset, count_offset);
+        bud::eprint("{}", err);
+#if defined(_DEBUG)
+        throw std::runtime_error(err);
+#else
+        return;
+#endif
+    }
+    auto* vk_buf = static_cast<bud::graphics::vulkan::VulkanBuffer*>(buffer.internal_state);
+    auto* vk_count_buf = static_cast<bud::graphics::vulkan::VulkanBuffer*>(count_buffer.internal_state);
+	vkCmdDrawIndexedIndirectCount(static_cast<VkCommandBuffer>(cmd), vk_buf->buffer, buffer.offset + offset, vk_count_buf->buffer, count_buffer.offset + count_offset, max_draw_count, stride);
+	// The real draw count lives on the GPU, it is read back through GPUStats one frame later
+	current_stats.draw_calls++;
+	current_stats.indirect_count_draws++;
+}
+
+void VulkanRHI::cmd_draw_mesh_tasks_indirect(CommandHandle cmd, bud::graphics::BufferHandle buffer, uint64_t offset, uint32_t draw_count, uint32_t stride) {
+    if (!buffer.is_valid() || !mesh_shader_supported || !fpCmdDrawMeshTasksIndirectEXT) {
+        std::string err = std::format("cmd_draw_mesh_tasks_indirect invalid call: buffer_valid={} supported={} offset={}",
+            buffer.is_valid(), mesh_shader_supported, offset);
+        bud::eprint("{}", err);
+#if defined(_DEBUG)
+        throw std::runtime_error(err);
+#else
+        return;
+#endif
+    }
+    auto* vk_buf = static_cast<bud::graphics::vulkan::VulkanBuffer*>(buffer.internal_state);
+	fpCmdDrawMeshTasksIndirectEXT(static_cast<VkCommandBuffer>(cmd), vk_buf->buffer, buffer.offset + offset, draw_count, stride);
+	current_stats.draw_calls++;
+	current_stats.indirect_records_submitted += draw_count;
+}
+
+void VulkanRHI::cmd_begin_gpu_timer(CommandHandle cmd, bud::graphics::GPUTimer timer) {
+	auto& frame = frames[current_frame];
+	const uint32_t t = static_cast<uint32_t>(timer);
+	if (!frame.timestamp_pool || t >= GPU_TIMER_COUNT || (frame.timers_begun & (1u << t)))
+		return;
+
+	vkCmdWriteTimestamp2(static_cast<VkCommandBuffer>(cmd), VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT, frame.timestamp_pool, t * 2);
+	frame.timers_begun |= 1u << t;
+}
+
+void VulkanRHI::cmd_end_gpu_timer(CommandHandle cmd, bud::graphics::GPUTimer timer) {
+	auto& frame = frames[current_frame];
+	const uint32_t t = static_cast<uint32_t>(timer);
+	if (!frame.timestamp_pool || t >= GPU_TIMER_COUNT || !(frame.timers_begun & (1u << t)) || (frame.timers_ended & (1u << t)))
+		return;
+
+	vkCmdWriteTimestamp2(static_cast<VkCommandBuffer>(cmd), VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, frame.timestamp_pool, t * 2 + 1);
+	frame.timers_ended |= 1u << t;
 }
 
 void VulkanRHI::cmd_push_constants(CommandHandle cmd, void* pipeline_layout, uint32_t size, const void* data) {
 	auto pipeObj = static_cast<VulkanPipelineObject*>(pipeline_layout);
-	VkShaderStageFlags stage = (pipeObj->bind_point == VK_PIPELINE_BIND_POINT_COMPUTE) 
+	VkShaderStageFlags stage = pipeObj->push_stages ? pipeObj->push_stages
+		: (pipeObj->bind_point == VK_PIPELINE_BIND_POINT_COMPUTE) 
 		? VK_SHADER_STAGE_COMPUTE_BIT 
 		: (VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT);
 	vkCmdPushConstants(static_cast<VkCommandBuffer>(cmd), pipeObj->layout, stage, 0, size, data);
@@ -1244,9 +1425,41 @@ void VulkanRHI::cmd_set_depth_bias(CommandHandle cmd, float constant, float clam
 	vkCmdSetDepthBias(static_cast<VkCommandBuffer>(cmd), constant, clamp, slope);
 }
 
+VkDescriptorSet VulkanRHI::get_global_descriptor_set(uint32_t view_slot) {
+	auto& frame = frames[current_frame];
+	if (view_slot == 0 || view_slot >= MAX_VIEWS) return frame.global_descriptor_set;
+
+	VkDescriptorSet view_set = frame.view_descriptor_sets[view_slot - 1];
+	if (!(frame.view_sets_synced & (1u << view_slot))) {
+		// Everything but the UBO, as the global set holds it now. Bindings written later in the frame
+		// (shadow map, instance data) are done before the first secondary view pass is recorded.
+		std::vector<VkCopyDescriptorSet> copies;
+		auto copy_binding = [&](uint32_t binding, uint32_t count) {
+			VkCopyDescriptorSet copy{ VK_STRUCTURE_TYPE_COPY_DESCRIPTOR_SET };
+			copy.srcSet = frame.global_descriptor_set;
+			copy.srcBinding = binding;
+			copy.dstSet = view_set;
+			copy.dstBinding = binding;
+			copy.descriptorCount = count;
+			copies.push_back(copy);
+		};
+		copy_binding(1, 1000);
+		copy_binding(2, 1);
+		copy_binding(3, 1);
+		if (mesh_shader_supported) {
+			for (uint32_t binding = 4; binding <= 7; ++binding) copy_binding(binding, 1);
+		}
+		copy_binding(8, 1);
+		copy_binding(9, 1);
+		vkUpdateDescriptorSets(device, 0, nullptr, static_cast<uint32_t>(copies.size()), copies.data());
+		frame.view_sets_synced |= 1u << view_slot;
+	}
+	return view_set;
+}
+
 void VulkanRHI::cmd_bind_descriptor_set(CommandHandle cmd, void* pipeline, uint32_t set_index) {
 	auto pipeObj = static_cast<VulkanPipelineObject*>(pipeline);
-	auto& frame = frames[current_frame];
+	VkDescriptorSet global_set = get_global_descriptor_set(current_view_slot);
 
 	vkCmdBindDescriptorSets(
 		static_cast<VkCommandBuffer>(cmd),
@@ -1254,7 +1467,7 @@ void VulkanRHI::cmd_bind_descriptor_set(CommandHandle cmd, void* pipeline, uint3
 		pipeObj->layout,
 		set_index,  // first set
 		1,          // descriptor set count
-		&frame.global_descriptor_set,
+		&global_set,
 		0,
 		nullptr  // dynamic offsets
 	);
@@ -1363,10 +1576,16 @@ void VulkanRHI::pick_physical_device() {
 	std::vector<VkPhysicalDevice> devices(device_count);
 	vkEnumeratePhysicalDevices(instance, &device_count, devices.data());
 
+	const bool want_software = device_preference == bud::graphics::DevicePreference::Software;
 	for (const auto& dev : devices) {
 		VkPhysicalDeviceProperties props;
 		vkGetPhysicalDeviceProperties(dev, &props);
-		if (props.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU) {
+		if (want_software && props.deviceType == VK_PHYSICAL_DEVICE_TYPE_CPU) {
+			physical_device = dev;
+			bud::print("[Vulkan] Selected software device: {}", props.deviceName);
+			break;
+		}
+		if (!want_software && props.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU) {
 			physical_device = dev;
 			bud::print("[Vulkan] Selected Discrete GPU: {}", props.deviceName);
 			break;
@@ -1374,8 +1593,16 @@ void VulkanRHI::pick_physical_device() {
 	}
 	if (physical_device == nullptr) {
 		physical_device = devices[0];
-		bud::print("[Vulkan] Warning: Using Integrated/Fallback GPU.");
+		if (want_software) {
+			bud::wprint("[Vulkan] No software device found, using the first device.");
+		} else {
+			bud::wprint("[Vulkan] Using Integrated/Fallback GPU.");
+		}
 	}
+
+	VkPhysicalDeviceProperties selected_props;
+	vkGetPhysicalDeviceProperties(physical_device, &selected_props);
+	device_name = selected_props.deviceName;
 }
 
 void VulkanRHI::create_logical_device(bool enable_validation) {
@@ -1391,8 +1618,40 @@ void VulkanRHI::create_logical_device(bool enable_validation) {
 		queue_infos.push_back(info);
 	}
 
+	// VK_EXT_mesh_shader is optional: meshlet culling falls back to compute + indirect draws without it
+	VkPhysicalDeviceMeshShaderFeaturesEXT mesh_features{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MESH_SHADER_FEATURES_EXT };
+	{
+		uint32_t ext_count = 0;
+		vkEnumerateDeviceExtensionProperties(physical_device, nullptr, &ext_count, nullptr);
+		std::vector<VkExtensionProperties> available_exts(ext_count);
+		vkEnumerateDeviceExtensionProperties(physical_device, nullptr, &ext_count, available_exts.data());
+
+		bool has_mesh_ext = false;
+		for (const auto& ext : available_exts) {
+			if (std::strcmp(ext.extensionName, VK_EXT_MESH_SHADER_EXTENSION_NAME) == 0) {
+				has_mesh_ext = true;
+				break;
+			}
+		}
+
+		if (has_mesh_ext) {
+			VkPhysicalDeviceMeshShaderFeaturesEXT supported_mesh{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MESH_SHADER_FEATURES_EXT };
+			VkPhysicalDeviceFeatures2 query{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2 };
+			query.pNext = &supported_mesh;
+			vkGetPhysicalDeviceFeatures2(physical_device, &query);
+			mesh_shader_supported = supported_mesh.taskShader == VK_TRUE && supported_mesh.meshShader == VK_TRUE;
+		}
+
+		if (mesh_shader_supported) {
+			mesh_features.taskShader = VK_TRUE;
+			mesh_features.meshShader = VK_TRUE;
+			device_extensions.push_back(VK_EXT_MESH_SHADER_EXTENSION_NAME);
+		}
+		bud::print("[Vulkan] Mesh shaders: {}", mesh_shader_supported ? "supported" : "not supported (meshlets drawn via compute + indirect)");
+	}
+
 	VkPhysicalDeviceVulkan13Features features13{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES };
-	features13.pNext = nullptr;
+	features13.pNext = mesh_shader_supported ? &mesh_features : nullptr;
 	features13.dynamicRendering = VK_TRUE;
 	features13.synchronization2 = VK_TRUE;
 
@@ -1405,6 +1664,15 @@ void VulkanRHI::create_logical_device(bool enable_validation) {
 	features12.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
 	features12.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
 
+	// drawIndirectCount is optional: GPU-driven passes fall back to the full indirect list without it
+	VkPhysicalDeviceVulkan12Features supported12{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES };
+	VkPhysicalDeviceFeatures2 supported_features2{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2 };
+	supported_features2.pNext = &supported12;
+	vkGetPhysicalDeviceFeatures2(physical_device, &supported_features2);
+	draw_indirect_count_supported = supported12.drawIndirectCount == VK_TRUE;
+	features12.drawIndirectCount = draw_indirect_count_supported ? VK_TRUE : VK_FALSE;
+	bud::print("[Vulkan] drawIndirectCount: {}", draw_indirect_count_supported ? "supported" : "not supported (using full indirect lists)");
+
 	VkPhysicalDeviceVulkan11Features features11{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES };
 	features11.pNext = &features12;
 
@@ -1414,6 +1682,11 @@ void VulkanRHI::create_logical_device(bool enable_validation) {
 	device_features2.features.samplerAnisotropy = VK_TRUE;
 	device_features2.features.multiDrawIndirect = VK_TRUE;
 
+	// geometryShader is optional: only the visibility buffer path needs gl_PrimitiveID in fragment shaders
+	visibility_buffer_supported = supported_features2.features.geometryShader == VK_TRUE;
+	device_features2.features.geometryShader = visibility_buffer_supported ? VK_TRUE : VK_FALSE;
+	bud::print("[Vulkan] Visibility buffer: {}", visibility_buffer_supported ? "supported" : "not supported (geometryShader missing, forward path only)");
+
 #ifdef BUD_ENABLE_AFTERMATH
 	// Enable NV_device_diagnostic_checkpoints extension to be able to
 	// use Aftermath event markers.
@@ -1470,6 +1743,14 @@ void VulkanRHI::create_logical_device(bool enable_validation) {
 	if (!fpCmdPushDescriptorSetKHR) {
 		bud::eprint("[Vulkan] Warning: vkCmdPushDescriptorSetKHR not found, compute bindings may fail!");
 	}
+
+	if (mesh_shader_supported) {
+		fpCmdDrawMeshTasksIndirectEXT = (PFN_vkCmdDrawMeshTasksIndirectEXT)vkGetDeviceProcAddr(device, "vkCmdDrawMeshTasksIndirectEXT");
+		if (!fpCmdDrawMeshTasksIndirectEXT) {
+			bud::eprint("[Vulkan] Warning: vkCmdDrawMeshTasksIndirectEXT not found, disabling mesh shader path");
+			mesh_shader_supported = false;
+		}
+	}
 }
 
 void VulkanRHI::create_swapchain(bud::platform::Window* window) {
@@ -1493,6 +1774,10 @@ void VulkanRHI::create_swapchain(bud::platform::Window* window) {
 	create_info.imageExtent = extent;
 	create_info.imageArrayLayers = 1;
 	create_info.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT; // 允许作为 Blit 目标
+	// Frame captures read the backbuffer back (Renderer::request_capture)
+	if (swapchain_support.capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT) {
+		create_info.imageUsage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+	}
 
 	QueueFamilyIndices indices = find_queue_families(physical_device);
 	uint32_t queue_family_indices[] = { indices.graphics_family.value(), indices.present_family.value() };
@@ -1594,6 +1879,35 @@ void VulkanRHI::create_sync_objects() {
 		}
 	}
 
+	// Per-frame timestamp pools for GPUTimer scopes
+	QueueFamilyIndices indices = find_queue_families(physical_device);
+	uint32_t family_count = 0;
+	vkGetPhysicalDeviceQueueFamilyProperties(physical_device, &family_count, nullptr);
+	std::vector<VkQueueFamilyProperties> families(family_count);
+	vkGetPhysicalDeviceQueueFamilyProperties(physical_device, &family_count, families.data());
+
+	VkPhysicalDeviceProperties props;
+	vkGetPhysicalDeviceProperties(physical_device, &props);
+	timestamp_period_ns = props.limits.timestampPeriod;
+	timestamps_supported = indices.graphics_family.has_value()
+		&& indices.graphics_family.value() < family_count
+		&& families[indices.graphics_family.value()].timestampValidBits > 0
+		&& timestamp_period_ns > 0.0f;
+
+	if (timestamps_supported) {
+		VkQueryPoolCreateInfo query_info{ VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO };
+		query_info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+		query_info.queryCount = GPU_TIMER_COUNT * 2;
+		for (int i = 0; i < max_frames_in_flight; i++) {
+			if (vkCreateQueryPool(device, &query_info, nullptr, &frames[i].timestamp_pool) != VK_SUCCESS) {
+				bud::eprint("[Vulkan] Failed to create timestamp query pool, GPU timers disabled.");
+				timestamps_supported = false;
+				break;
+			}
+		}
+	}
+	bud::print("[Vulkan] GPU timestamps: {}", timestamps_supported ? "supported" : "unsupported");
+
 	render_finished_semaphores.resize(swapchain_images.size());
 	for (size_t i = 0; i < swapchain_images.size(); ++i) {
 		if (vkCreateSemaphore(device, &semaphore_info, nullptr, &render_finished_semaphores[i]) != VK_SUCCESS) {
@@ -1997,7 +2311,37 @@ void VulkanRHI::cmd_copy_image(CommandHandle cmd, Texture* src, Texture* dst) {
 		1, &region);
 }
 
+void VulkanRHI::cmd_copy_texture_to_buffer(CommandHandle cmd, Texture* src, bud::graphics::BufferHandle dst) {
+	auto* vk_src = static_cast<VulkanTexture*>(src);
+	auto* vk_dst = static_cast<bud::graphics::vulkan::VulkanBuffer*>(dst.internal_state);
+	if (!vk_src || !vk_src->image || !vk_dst || !vk_dst->buffer) {
+		std::string err = std::format("cmd_copy_texture_to_buffer invalid resources: src={} dst={}", (void*)vk_src, (void*)vk_dst);
+		bud::eprint("{}", err);
+#if defined(_DEBUG)
+		throw std::runtime_error(err);
+#else
+		return;
+#endif
+	}
+
+	VkBufferImageCopy region{};
+	region.bufferOffset = 0;
+	region.bufferRowLength = 0;   // Tightly packed
+	region.bufferImageHeight = 0;
+	region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	region.imageSubresource.mipLevel = 0;
+	region.imageSubresource.baseArrayLayer = 0;
+	region.imageSubresource.layerCount = 1;
+	region.imageExtent = { src->width, src->height, 1 };
+
+	vkCmdCopyImageToBuffer(static_cast<VkCommandBuffer>(cmd), vk_src->image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, vk_dst->buffer, 1, &region);
+}
+
 void VulkanRHI::cmd_blit_image(CommandHandle cmd, Texture* src, Texture* dst) {
+	cmd_blit_image(cmd, src, dst, 0, 0, dst->width, dst->height);
+}
+
+void VulkanRHI::cmd_blit_image(CommandHandle cmd, Texture* src, Texture* dst, int32_t dst_x, int32_t dst_y, uint32_t dst_width, uint32_t dst_height) {
 	VulkanTexture* vk_src = static_cast<VulkanTexture*>(src);
 	VulkanTexture* vk_dst = static_cast<VulkanTexture*>(dst);
 
@@ -2009,8 +2353,8 @@ void VulkanRHI::cmd_blit_image(CommandHandle cmd, Texture* src, Texture* dst) {
 	blit.srcSubresource.baseArrayLayer = 0;
 	blit.srcSubresource.layerCount = 1;
 
-	blit.dstOffsets[0] = { 0, 0, 0 };
-	blit.dstOffsets[1] = { (int32_t)dst->width, (int32_t)dst->height, 1 };
+	blit.dstOffsets[0] = { dst_x, dst_y, 0 };
+	blit.dstOffsets[1] = { dst_x + (int32_t)dst_width, dst_y + (int32_t)dst_height, 1 };
 	blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
 	blit.dstSubresource.mipLevel = 0;
 	blit.dstSubresource.baseArrayLayer = 0;
@@ -2289,8 +2633,22 @@ void VulkanRHI::update_global_uniforms(uint32_t image_index, const SceneView& sc
 	ubo.shadow_bias_constant = render_config.shadow_bias_constant;
 	ubo.shadow_bias_slope = render_config.shadow_bias_slope;
 
+	ubo.local_light_count = scene_view.local_light_count;
+	ubo.debug_light_clusters = render_config.debug_light_clusters ? 1 : 0;
+	ubo.cluster_dims[0] = LIGHT_CLUSTER_X;
+	ubo.cluster_dims[1] = LIGHT_CLUSTER_Y;
+	ubo.cluster_dims[2] = LIGHT_CLUSTER_Z;
+	ubo.cluster_dims[3] = MAX_LIGHTS_PER_CLUSTER;
+	ubo.cluster_depth = light_cluster_depth_params(scene_view.near_plane, scene_view.far_plane);
+	// Fragment coordinates only span the scaled extent under dynamic resolution
+	float viewport_width = std::max(scene_view.viewport_width * scene_view.render_scale, 1.0f);
+	float viewport_height = std::max(scene_view.viewport_height * scene_view.render_scale, 1.0f);
+	ubo.cluster_screen = bud::math::vec4(viewport_width, viewport_height, 1.0f / viewport_width, 1.0f / viewport_height);
+
+	current_view_slot = std::min(scene_view.view_index, MAX_VIEWS - 1);
 	if (frames[current_frame].uniform_mapped) {
-		std::memcpy(frames[current_frame].uniform_mapped, &ubo, sizeof(UniformBufferObject));
+		auto* slot = static_cast<uint8_t*>(frames[current_frame].uniform_mapped) + current_view_slot * uniform_stride;
+		std::memcpy(slot, &ubo, sizeof(UniformBufferObject));
 	}
 }
 
@@ -2316,6 +2674,29 @@ void VulkanRHI::update_global_instance_data(bud::graphics::BufferHandle buffer)
 	}
 }
 
+void VulkanRHI::update_global_meshlet_data(bud::graphics::BufferHandle meshlets, bud::graphics::BufferHandle meshlet_data, bud::graphics::BufferHandle vertices, bud::graphics::BufferHandle visible_meshlets) {
+	if (!mesh_shader_supported) return;
+	if (!meshlets.is_valid() || !meshlet_data.is_valid() || !vertices.is_valid() || !visible_meshlets.is_valid()) return;
+
+	// The visible list is per-frame, so only the set of the frame being recorded is touched
+	DescriptorWriter writer;
+	writer.write_buffer(4, static_cast<VulkanBuffer*>(meshlets.internal_state)->buffer, meshlets.size, meshlets.offset, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	writer.write_buffer(5, static_cast<VulkanBuffer*>(meshlet_data.internal_state)->buffer, meshlet_data.size, meshlet_data.offset, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	writer.write_buffer(6, static_cast<VulkanBuffer*>(vertices.internal_state)->buffer, vertices.size, vertices.offset, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	writer.write_buffer(7, static_cast<VulkanBuffer*>(visible_meshlets.internal_state)->buffer, visible_meshlets.size, visible_meshlets.offset, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	writer.update_set(device, frames[current_frame].global_descriptor_set);
+}
+
+void VulkanRHI::update_global_light_data(bud::graphics::BufferHandle lights, bud::graphics::BufferHandle cluster_grid) {
+	if (!lights.is_valid() || !cluster_grid.is_valid()) return;
+
+	// Both buffers are per-frame, same as the visible meshlet list
+	DescriptorWriter writer;
+	writer.write_buffer(8, static_cast<VulkanBuffer*>(lights.internal_state)->buffer, lights.size, lights.offset, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	writer.write_buffer(9, static_cast<VulkanBuffer*>(cluster_grid.internal_state)->buffer, cluster_grid.size, cluster_grid.offset, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
+	writer.update_set(device, frames[current_frame].global_descriptor_set);
+}
+
 bud::graphics::Texture* VulkanRHI::get_fallback_texture() {
 	return fallback_texture_ptr;
 }
@@ -58,8 +58,13 @@ namespace bud::graphics::vulkan {
 
 		void resize_swapchain(uint32_t width, uint32_t height) override;
 		bool is_swapchain_out_of_date() const override { return swapchain_out_of_date.load(std::memory_order_acquire); }
+		bool supports_draw_indirect_count() const override { return draw_indirect_count_supported; }
+		bool supports_mesh_shaders() const override { return mesh_shader_supported; }
+		bool supports_visibility_buffer() const override { return visibility_buffer_supported; }
+		void set_device_preference(bud::graphics::DevicePreference preference) override { device_preference = preference; }
+		std::string get_device_name() const override { return device_name; }
 
-		bud::graphics::BufferHandle create_gpu_buffer(uint64_t size, bud::graphics::ResourceState usage_state) override;
+		bud::graphics::BufferHandle create_gpu_buffer(uint64_t size, bud::graphics::ResourceState usage_state, bud::graphics::MemoryUsage memory_usage = bud::graphics::MemoryUsage::GpuOnly) override;
 		bud::graphics::BufferHandle create_upload_buffer(uint64_t size) override;
 		void copy_buffer_immediate(bud::graphics::BufferHandle src, bud::graphics::BufferHandle dst, uint64_t size) override;
 		void copy_buffer_immediate_offset(bud::graphics::BufferHandle src, bud::graphics::BufferHandle dst, uint64_t size, uint64_t src_offset, uint64_t dst_offset) override;
@@ -81,11 +86,15 @@ namespace bud::graphics::vulkan {
 		void cmd_begin_render_pass(CommandHandle cmd, const bud::graphics::RenderPassBeginInfo& info) override;
 		void cmd_end_render_pass(CommandHandle cmd) override;
 
-		void cmd_bind_vertex_buffer(CommandHandle cmd, bud::graphics::BufferHandle buffer) override;
+		void cmd_bind_vertex_buffer(CommandHandle cmd, bud::graphics::BufferHandle buffer, uint32_t binding = 0) override;
 		void cmd_bind_index_buffer(CommandHandle cmd, bud::graphics::BufferHandle buffer) override;
 		void cmd_draw(CommandHandle cmd, uint32_t vertex_count, uint32_t instance_count, uint32_t first_vertex, uint32_t first_instance) override;
 		void cmd_draw_indexed(CommandHandle cmd, uint32_t index_count, uint32_t instance_count, uint32_t first_index, int32_t vertex_offset, uint32_t first_instance) override;
 		void cmd_draw_indexed_indirect(CommandHandle cmd, bud::graphics::BufferHandle buffer, uint64_t offset, uint32_t draw_count, uint32_t stride) override;
+		void cmd_draw_indexed_indirect_count(CommandHandle cmd, bud::graphics::BufferHandle buffer, uint64_t offset, bud::graphics::BufferHandle count_buffer, uint64_t count_offset, uint32_t max_draw_count, uint32_t stride) override;
+		void cmd_draw_mesh_tasks_indirect(CommandHandle cmd, bud::graphics::BufferHandle buffer, uint64_t offset, uint32_t draw_count, uint32_t stride) override;
+		void cmd_begin_gpu_timer(CommandHandle cmd, bud::graphics::GPUTimer timer) override;
+		void cmd_end_gpu_timer(CommandHandle cmd, bud::graphics::GPUTimer timer) override;
 
 		void cmd_set_viewport(CommandHandle cmd, float width, float height) override;
 		void cmd_set_scissor(CommandHandle cmd, int32_t x, int32_t y, uint32_t width, uint32_t height) override;
@@ -93,8 +102,12 @@ namespace bud::graphics::vulkan {
 		void cmd_set_depth_bias(CommandHandle cmd, float constant, float clamp, float slope) override;
 		void update_global_shadow_map(Texture* texture) override;
 		void update_global_instance_data(bud::graphics::BufferHandle buffer) override;
+		void update_global_meshlet_data(bud::graphics::BufferHandle meshlets, bud::graphics::BufferHandle meshlet_data, bud::graphics::BufferHandle vertices, bud::graphics::BufferHandle visible_meshlets) override;
+		void update_global_light_data(bud::graphics::BufferHandle lights, bud::graphics::BufferHandle cluster_grid) override;
 		void cmd_copy_image(CommandHandle cmd, Texture* src, Texture* dst) override;
+		void cmd_copy_texture_to_buffer(CommandHandle cmd, Texture* src, bud::graphics::BufferHandle dst) override;
 		void cmd_blit_image(CommandHandle cmd, Texture* src, Texture* dst) override;
+		void cmd_blit_image(CommandHandle cmd, Texture* src, Texture* dst, int32_t dst_x, int32_t dst_y, uint32_t dst_width, uint32_t dst_height) override;
 
 		bud::graphics::Texture* create_texture(const bud::graphics::TextureDesc& desc, const void* initial_data, uint64_t size) override;
 		void update_bindless_texture(uint32_t index, bud::graphics::Texture* texture) override;
@@ -188,8 +201,18 @@ namespace bud::graphics::vulkan {
 			VkDeviceMemory uniform_memory = nullptr;
 			void* uniform_mapped = nullptr;          // Persistently mapped
 			VkDescriptorSet global_descriptor_set = VK_NULL_HANDLE;
+			// Copies of the global set for secondary views, binding 0 at uniform slot i + 1. Refreshed from
+			// the global set the first time a frame uses them.
+			VkDescriptorSet view_descriptor_sets[bud::graphics::MAX_VIEWS - 1] = {};
+			uint32_t view_sets_synced = 0;
+			VkQueryPool timestamp_pool = VK_NULL_HANDLE; // 2 queries (begin/end) per GPUTimer
+			uint32_t timers_begun = 0;                   // GPUTimer bits written this frame
+			uint32_t timers_ended = 0;
 		};
 
+		// Global set of the current frame bound for a uniform slot, secondary view copies are synced on first use
+		VkDescriptorSet get_global_descriptor_set(uint32_t view_slot);
+
 		
 		bud::platform::Window* platform_window = nullptr;
 
@@ -202,6 +225,13 @@ namespace bud::graphics::vulkan {
 		VkDebugUtilsMessengerEXT debug_messenger = nullptr;
 		bool enable_validation_layers = false;
 		bool aftermath_initialized = false;
+		bud::graphics::DevicePreference device_preference = bud::graphics::DevicePreference::Discrete;
+		std::string device_name;
+		bool draw_indirect_count_supported = false; // VkPhysicalDeviceVulkan12Features::drawIndirectCount
+		bool mesh_shader_supported = false;         // VK_EXT_mesh_shader with taskShader + meshShader
+		bool visibility_buffer_supported = false;   // VkPhysicalDeviceFeatures::geometryShader (fragment gl_PrimitiveID)
+		bool timestamps_supported = false;          // Graphics queue timestampValidBits > 0
+		float timestamp_period_ns = 1.0f;
 
 		const std::vector<const char*> validation_layers = { "VK_LAYER_KHRONOS_validation" };
 		std::vector<const char*> device_extensions = {
@@ -241,6 +271,8 @@ namespace bud::graphics::vulkan {
 		VkDescriptorSetLayout global_set_layout = VK_NULL_HANDLE;
 		VkDescriptorSetLayout compute_set_layout = VK_NULL_HANDLE; // Used for per-dispatch storage buffer binding
 		VkDescriptorPool global_descriptor_pool = VK_NULL_HANDLE;
+		VkDeviceSize uniform_stride = 0;  // UniformBufferObject rounded up to minUniformBufferOffsetAlignment
+		uint32_t current_view_slot = 0;   // Uniform slot set 0 binds, see update_global_uniforms
 		VkSampler default_sampler = VK_NULL_HANDLE;
 		VkSampler shadow_sampler = VK_NULL_HANDLE;
 		VulkanTexture dummy_depth_texture; // Placeholder for shadow map binding
@@ -259,7 +291,9 @@ namespace bud::graphics::vulkan {
 		RenderStats current_stats;
 		
 		PFN_vkCmdPushDescriptorSetKHR fpCmdPushDescriptorSetKHR = nullptr;
+		PFN_vkCmdDrawMeshTasksIndirectEXT fpCmdDrawMeshTasksIndirectEXT = nullptr;
 
 		std::vector<VkPipelineLayout> created_layouts;
+		std::mutex created_layouts_mutex;  // Pipelines are created from worker tasks at startup
 	};
 }
@@ -283,7 +283,7 @@ namespace bud::graphics::vulkan {
         vk_buf->size = size;
         vk_buf->owns_allocation = true;
 
-        bud::print("[VulkanMemoryAllocator][alloc_gpu] VkBuffer={} size={} usage={} (ResourceState={})", (void*)vk_buf->buffer, size, (uint32_t)buffer_info.usage, (int)usage);
+        BUD_LOG_VERBOSE(RHI, "[VulkanMemoryAllocator][alloc_gpu] VkBuffer={} size={} usage={} (ResourceState={})", (void*)vk_buf->buffer, size, (uint32_t)buffer_info.usage, (int)usage);
 
         bud::graphics::BufferHandle handle;
         handle.internal_state = vk_buf;
@@ -320,7 +320,7 @@ namespace bud::graphics::vulkan {
         vk_buf->size = size;
         vk_buf->owns_allocation = true;
 
-        bud::print("[VulkanMemoryAllocator][alloc_persistent] VkBuffer={} size={} usage={} (ResourceState={})", (void*)vk_buf->buffer, size, (uint32_t)buffer_info.usage, (int)usage);
+        BUD_LOG_VERBOSE(RHI, "[VulkanMemoryAllocator][alloc_persistent] VkBuffer={} size={} usage={} (ResourceState={})", (void*)vk_buf->buffer, size, (uint32_t)buffer_info.usage, (int)usage);
 
         bud::graphics::BufferHandle handle;
         handle.internal_state = vk_buf;
@@ -1,6 +1,7 @@
 ﻿#include <vulkan/vulkan.h>
 #include <unordered_map>
 #include <vector>
+#include <mutex>
 #include <stdexcept>
 
 #include "src/graphics/vulkan/bud.vulkan.pipeline.hpp"
@@ -17,6 +18,7 @@ namespace bud::graphics::vulkan {
     }
 
     void VulkanPipelineCache::cleanup() {
+        std::lock_guard lock(mutex);
         for (auto& [key, entry] : cache) {
             if (device && entry.pipeline) vkDestroyPipeline(device, entry.pipeline, nullptr);
         }
@@ -31,14 +33,27 @@ namespace bud::graphics::vulkan {
     }
 
     VkPipeline VulkanPipelineCache::get_pipeline(const PipelineKey& key, VkPipelineLayout layout, bool is_depth_only) {
+        {
+            std::lock_guard lock(mutex);
+            auto it = cache.find(key);
+            if (it != cache.end()) {
+                // Increment refcount and return existing pipeline
+                it->second.refcount++;
+                return it->second.pipeline;
+            }
+        }
+
+        // Compiled outside the lock so different pipelines build in parallel
+        VkPipeline new_pipe = create_pipeline_internal(key, layout, is_depth_only);
+
+        std::lock_guard lock(mutex);
         auto it = cache.find(key);
         if (it != cache.end()) {
-            // Increment refcount and return existing pipeline
+            // Another thread built the same key meanwhile, keep theirs
+            if (new_pipe) vkDestroyPipeline(device, new_pipe, nullptr);
             it->second.refcount++;
             return it->second.pipeline;
         }
-
-        VkPipeline new_pipe = create_pipeline_internal(key, layout, is_depth_only);
         PipelineEntry entry{ new_pipe, 1 };
         cache[key] = entry;
         // Record reverse mapping for O(1) lookup on release
@@ -48,57 +63,97 @@ namespace bud::graphics::vulkan {
 
     VkPipeline VulkanPipelineCache::create_pipeline_internal(const PipelineKey& key, VkPipelineLayout layout, bool is_depth_only) {
         
-        VkPipelineShaderStageCreateInfo shaderStages[] = {
-            { VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_VERTEX_BIT, key.vert_shader, "main", nullptr },
-            { VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_FRAGMENT_BIT, key.frag_shader, "main", nullptr }
-        };
+        // Mesh shader pipelines replace the vertex stage (and all fixed-function vertex input) with task/mesh stages
+        const bool is_mesh_pipeline = key.mesh_shader != VK_NULL_HANDLE;
 
-        // Vertex Input (Hardcoded for Sponza sample based on MeshData::Vertex)
-        // in Vulkan 1.3 Dynamic Rendering, we often use generic layouts.
-        // But input state is needed.
-        VkVertexInputBindingDescription bindingDescription{};
-        bindingDescription.binding = 0;
-        bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+        std::vector<VkPipelineShaderStageCreateInfo> shaderStages;
+        if (is_mesh_pipeline) {
+            if (key.task_shader != VK_NULL_HANDLE) {
+                shaderStages.push_back({ VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_TASK_BIT_EXT, key.task_shader, "main", nullptr });
+            }
+            shaderStages.push_back({ VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_MESH_BIT_EXT, key.mesh_shader, "main", nullptr });
+        } else {
+            shaderStages.push_back({ VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_VERTEX_BIT, key.vert_shader, "main", nullptr });
+        }
+        shaderStages.push_back({ VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_FRAGMENT_BIT, key.frag_shader, "main", nullptr });
+
+        // Vertex Input: mesh layouts read the geometry pool's split streams,
+        // binding 0 = positions (vec3), binding 1 = MeshData::VertexAttributes
+        using Attributes = bud::io::MeshData::VertexAttributes;
+        const VkVertexInputBindingDescription position_binding{ 0, bud::io::VERTEX_POSITION_STRIDE, VK_VERTEX_INPUT_RATE_VERTEX };
+        const VkVertexInputBindingDescription attribute_binding{ 1, bud::io::VERTEX_ATTRIBUTE_STRIDE, VK_VERTEX_INPUT_RATE_VERTEX };
+        // Instanced layouts: FoliageInstance per instance, {vec3 position, uint yaw_scale}
+        const VkVertexInputBindingDescription instance_binding{ 2, FOLIAGE_INSTANCE_STRIDE, VK_VERTEX_INPUT_RATE_INSTANCE };
+        const VkVertexInputAttributeDescription instance_attributes[] = {
+            {5, 2, VK_FORMAT_R32G32B32_SFLOAT, 0},
+            {6, 2, VK_FORMAT_R32_UINT, 12}
+        };
 
+        std::vector<VkVertexInputBindingDescription> bindingDescriptions;
         std::vector<VkVertexInputAttributeDescription> attributeDescriptions;
 
         switch (key.vertex_layout) {
         case VertexLayoutType::Default:
-            bindingDescription.stride = sizeof(bud::io::MeshData::Vertex);
+            bindingDescriptions = { position_binding, attribute_binding };
             attributeDescriptions = {
-                {0, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(bud::io::MeshData::Vertex, pos)},
-                {1, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(bud::io::MeshData::Vertex, color)},
-                {2, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(bud::io::MeshData::Vertex, normal)},
-                {3, 0, VK_FORMAT_R32G32_SFLOAT,    offsetof(bud::io::MeshData::Vertex, texture_uv)},
-                {4, 0, VK_FORMAT_R32_SFLOAT,       offsetof(bud::io::MeshData::Vertex, texture_index)}
+                {0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0},
+                {1, 1, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Attributes, color)},
+                {2, 1, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Attributes, normal)},
+                {3, 1, VK_FORMAT_R32G32_SFLOAT,    offsetof(Attributes, texture_uv)},
+                {4, 1, VK_FORMAT_R32_SFLOAT,       offsetof(Attributes, texture_index)}
             };
             break;
         case VertexLayoutType::PositionOnly:
-            bindingDescription.stride = sizeof(bud::io::MeshData::Vertex);
+            bindingDescriptions = { position_binding };
             attributeDescriptions = {
-                {0, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(bud::io::MeshData::Vertex, pos)}
+                {0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0}
             };
             break;
         case VertexLayoutType::PositionUV:
-            bindingDescription.stride = sizeof(bud::io::MeshData::Vertex);
+            bindingDescriptions = { position_binding, attribute_binding };
             attributeDescriptions = {
-                {0, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(bud::io::MeshData::Vertex, pos)},
-                {3, 0, VK_FORMAT_R32G32_SFLOAT,    offsetof(bud::io::MeshData::Vertex, texture_uv)}
+                {0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0},
+                {3, 1, VK_FORMAT_R32G32_SFLOAT,    offsetof(Attributes, texture_uv)}
             };
             break;
         case VertexLayoutType::PositionNormal:
-            bindingDescription.stride = sizeof(bud::io::MeshData::Vertex);
+            bindingDescriptions = { position_binding, attribute_binding };
+            attributeDescriptions = {
+                {0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0},
+                {2, 1, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Attributes, normal)}
+            };
+            break;
+        case VertexLayoutType::Instanced:
+            bindingDescriptions = { position_binding, attribute_binding, instance_binding };
             attributeDescriptions = {
-                {0, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(bud::io::MeshData::Vertex, pos)},
-                {2, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(bud::io::MeshData::Vertex, normal)}
+                {0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0},
+                {1, 1, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Attributes, color)},
+                {2, 1, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Attributes, normal)},
+                {3, 1, VK_FORMAT_R32G32_SFLOAT,    offsetof(Attributes, texture_uv)},
+                {4, 1, VK_FORMAT_R32_SFLOAT,       offsetof(Attributes, texture_index)},
+                instance_attributes[0],
+                instance_attributes[1]
             };
             break;
+        case VertexLayoutType::InstancedPositionUV:
+            bindingDescriptions = { position_binding, attribute_binding, instance_binding };
+            attributeDescriptions = {
+                {0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0},
+                {3, 1, VK_FORMAT_R32G32_SFLOAT,    offsetof(Attributes, texture_uv)},
+                instance_attributes[0],
+                instance_attributes[1]
+            };
+            break;
+        case VertexLayoutType::InstanceOnly:
+            bindingDescriptions = { instance_binding };
+            attributeDescriptions = { instance_attributes[0], instance_attributes[1] };
+            break;
         case VertexLayoutType::NoVertexInput:
-            bindingDescription.stride = 0;
+            bindingDescriptions = {};
             attributeDescriptions = {};
             break;
         case VertexLayoutType::ImGui:
-            bindingDescription.stride = sizeof(ImDrawVert);
+            bindingDescriptions = { { 0, sizeof(ImDrawVert), VK_VERTEX_INPUT_RATE_VERTEX } };
             attributeDescriptions = {
                 {0, 0, VK_FORMAT_R32G32_SFLOAT,  offsetof(ImDrawVert, pos)},
                 {1, 0, VK_FORMAT_R32G32_SFLOAT,  offsetof(ImDrawVert, uv)},
@@ -110,8 +165,8 @@ namespace bud::graphics::vulkan {
 
         VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
         vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-        vertexInputInfo.vertexBindingDescriptionCount = 1;
-        vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
+        vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(bindingDescriptions.size());
+        vertexInputInfo.pVertexBindingDescriptions = bindingDescriptions.data();
         vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
         vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
 
@@ -209,10 +264,10 @@ namespace bud::graphics::vulkan {
         VkGraphicsPipelineCreateInfo pipelineInfo{};
         pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
         pipelineInfo.pNext = &renderingInfo;
-        pipelineInfo.stageCount = 2; 
-        pipelineInfo.pStages = shaderStages;
-        pipelineInfo.pVertexInputState = &vertexInputInfo;
-        pipelineInfo.pInputAssemblyState = &inputAssembly;
+        pipelineInfo.stageCount = static_cast<uint32_t>(shaderStages.size());
+        pipelineInfo.pStages = shaderStages.data();
+        pipelineInfo.pVertexInputState = is_mesh_pipeline ? nullptr : &vertexInputInfo;
+        pipelineInfo.pInputAssemblyState = is_mesh_pipeline ? nullptr : &inputAssembly;
         pipelineInfo.pViewportState = &viewportState;
         pipelineInfo.pRasterizationState = &rasterizer;
         pipelineInfo.pMultisampleState = &multisampling;
@@ -233,8 +288,8 @@ namespace bud::graphics::vulkan {
         VkPipeline graphicsPipeline = VK_NULL_HANDLE;
         // Diagnostic: record that we are about to create a graphics pipeline
         {
-            std::string msg = std::format("[Vulkan][Worker] vkCreateGraphicsPipelines: vert_module={} frag_module={} color_fmt={} depth_fmt={}\n",
-                (void*)shaderStages[0].module, (void*)shaderStages[1].module, (int)colorFormat, (int)depthFormat);
+            std::string msg = std::format("[Vulkan][Worker] vkCreateGraphicsPipelines: {}_module={} frag_module={} color_fmt={} depth_fmt={}\n",
+                is_mesh_pipeline ? "mesh" : "vert", is_mesh_pipeline ? (void*)key.mesh_shader : (void*)key.vert_shader, (void*)key.frag_shader, (int)colorFormat, (int)depthFormat);
             bud::print("{}", msg);
         }
 
@@ -276,6 +331,7 @@ namespace bud::graphics::vulkan {
 #endif
         }
 
+        std::lock_guard lock(mutex);
         compute_pipelines.push_back(computePipeline);
         compute_pipeline_set.insert(computePipeline);
         return computePipeline;
@@ -291,6 +347,7 @@ namespace bud::graphics::vulkan {
             return;
 #endif
         }
+        std::lock_guard lock(mutex);
         // O(1) lookup using reverse map
         auto rit = pipeline_to_key.find(pipeline);
         if (rit != pipeline_to_key.end()) {
@@ -299,10 +356,10 @@ namespace bud::graphics::vulkan {
             if (cit != cache.end()) {
                 if (cit->second.refcount > 1) {
                     cit->second.refcount--;
-                    bud::print("[VulkanPipelineCache] release_pipeline: decremented refcount for pipeline {} to {}", (void*)pipeline, cit->second.refcount);
+                    BUD_LOG_VERBOSE(RHI, "[VulkanPipelineCache] release_pipeline: decremented refcount for pipeline {} to {}", (void*)pipeline, cit->second.refcount);
                 } else {
                     if (device && cit->second.pipeline) {
-                        bud::print("[VulkanPipelineCache] release_pipeline: destroying pipeline {}", (void*)pipeline);
+                        BUD_LOG_VERBOSE(RHI, "[VulkanPipelineCache] release_pipeline: destroying pipeline {}", (void*)pipeline);
                         vkDestroyPipeline(device, cit->second.pipeline, nullptr);
                     }
                     cache.erase(cit);
@@ -324,7 +381,7 @@ namespace bud::graphics::vulkan {
             // Also remove from vector
             auto vit = std::find(compute_pipelines.begin(), compute_pipelines.end(), pipeline);
             if (vit != compute_pipelines.end()) compute_pipelines.erase(vit);
-            bud::print("[VulkanPipelineCache] release_pipeline: destroyed compute pipeline {}", (void*)pipeline);
+            BUD_LOG_VERBOSE(RHI, "[VulkanPipelineCache] release_pipeline: destroyed compute pipeline {}", (void*)pipeline);
             return;
         }
 
@@ -4,6 +4,7 @@
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
+#include <mutex>
 #include <functional> // for std::hash
 #include <stdexcept>
 
@@ -14,6 +15,8 @@ namespace bud::graphics::vulkan {
 	// 创建管线所需的所有状态
 	 struct PipelineKey {
 		VkShaderModule vert_shader;
+		VkShaderModule task_shader; // Mesh shader pipelines: vert_shader is null, task_shader optional
+		VkShaderModule mesh_shader;
 		VkShaderModule frag_shader;
 		VkRenderPass render_pass;
 		VkBool32 depth_test;
@@ -28,6 +31,8 @@ namespace bud::graphics::vulkan {
 
 		bool operator==(const PipelineKey& other) const {
 			return vert_shader == other.vert_shader &&
+				task_shader == other.task_shader &&
+				mesh_shader == other.mesh_shader &&
 				frag_shader == other.frag_shader &&
 				render_pass == other.render_pass &&
 				depth_test == other.depth_test &&
@@ -53,11 +58,14 @@ namespace bud::graphics::vulkan {
 				(std::hash<uint32_t>()(k.blending_enable) << 6) ^
 				(std::hash<uint32_t>()((uint32_t)k.vertex_layout) << 7) ^
 				(std::hash<uint32_t>()(k.depth_bias_enable) << 8) ^
-				(std::hash<uint32_t>()(k.depth_format) << 9);
+				(std::hash<uint32_t>()(k.depth_format) << 9) ^
+				(std::hash<void*>()(k.mesh_shader) << 10) ^
+				(std::hash<void*>()(k.task_shader) << 11);
 		}
 	};
 
 
+	 // Thread-safe: passes create their pipelines from worker tasks while the shader bundle loads
 	 class VulkanPipelineCache {
 	public:
 		void init(VkDevice device);
@@ -78,6 +86,8 @@ namespace bud::graphics::vulkan {
     // Compute pipelines tracking
     std::vector<VkPipeline> compute_pipelines;
     std::unordered_set<VkPipeline> compute_pipeline_set;
+    // Guards the maps above, never held across vkCreate*Pipelines
+    std::mutex mutex;
 
 
 		VkPipeline create_pipeline_internal(const PipelineKey& key, VkPipelineLayout layout, bool is_depth_only);
@@ -46,7 +46,13 @@ namespace bud::graphics::vulkan {
 		uint32_t reversed_z;
 		float shadow_bias_constant;
 		float shadow_bias_slope;
-		uint32_t padding[1];
+		uint32_t local_light_count;
+		uint32_t debug_light_clusters;
+
+		// Clustered lighting
+		alignas(16) uint32_t cluster_dims[4];               // x, y, z, max lights per cluster
+		alignas(16) bud::math::vec4 cluster_depth;          // near, far, log scale, log bias
+		alignas(16) bud::math::vec4 cluster_screen;         // width, height, 1 / width, 1 / height
 	};
 
 	struct Vertex {
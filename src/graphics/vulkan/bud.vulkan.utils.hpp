@@ -39,6 +39,8 @@ namespace bud::graphics::vulkan {
 		case TextureFormat::D32_FLOAT:         return VK_FORMAT_D32_SFLOAT;
 		case TextureFormat::D24_UNORM_S8_UINT: return VK_FORMAT_D24_UNORM_S8_UINT;
 		case TextureFormat::R32_FLOAT:         return VK_FORMAT_R32_SFLOAT;
+		case TextureFormat::R32G32_UINT:       return VK_FORMAT_R32G32_UINT;
+		case TextureFormat::R16G16B16A16_FLOAT: return VK_FORMAT_R16G16B16A16_SFLOAT;
 		default: throw std::runtime_error("Unsupported TextureFormat");
 		}
 	}
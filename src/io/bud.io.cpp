@@ -1,6 +1,7 @@
 ﻿#include "bud.io.hpp"
 #include "src/core/bud.core.hpp"
 #include "src/core/bud.asset.types.hpp"
+#include "src/core/bud.compress.hpp"
 #include <fstream>
 #include <filesystem>
 #include <optional>
@@ -279,7 +280,7 @@ namespace bud::io {
 			resolved_path.string().c_str(), base_dir.c_str());
 
 		if (!warn.empty() && warn.find("Both") == std::string::npos)
-			bud::print("[IO] [TinyOBJ Warn]: {}", warn);
+			bud::wprint("[IO] [TinyOBJ]: {}", warn);
 		if (!err.empty())
 			bud::print("[IO] [TinyOBJ Error]: {}", err);
 		if (!ret)
@@ -384,8 +385,8 @@ namespace bud::io {
 					}
 
 					if (unique_vertices.count(vertex) == 0) {
-						unique_vertices[vertex] = static_cast<uint32_t>(mesh_data.vertices.size());
-						mesh_data.vertices.push_back(vertex);
+						unique_vertices[vertex] = static_cast<uint32_t>(mesh_data.vertex_count());
+						mesh_data.add_vertex(vertex);
 					}
 
 					mesh_data.indices.push_back(unique_vertices[vertex]);
@@ -431,7 +432,7 @@ namespace bud::io {
 			ret = loader.LoadASCIIFromFile(&model, &err, &warn, path_str);
 
 		if (!warn.empty())
-			bud::print("[IO] [glTF Warn]: {}", warn);
+			bud::wprint("[IO] [glTF]: {}", warn);
 
 		if (!err.empty())
 			bud::print("[IO] [glTF Error]: {}", err);
@@ -499,7 +500,7 @@ namespace bud::io {
 			if (texCoordBuffer)
 				vertex.texture_uv = glm::vec2(texCoordBuffer[i * 2 + 0], texCoordBuffer[i * 2 + 1]);
 
-			meshData.vertices.push_back(vertex);
+			meshData.add_vertex(vertex);
 		}
 
 		if (primitive.indices >= 0) {
@@ -569,12 +570,17 @@ namespace bud::io {
 
 		static_assert(sizeof(asset::BudMeshHeader) == asset::MESH_HEADER_SIZE, "BudMeshHeader size mismatch!");
 		static_assert(offsetof(asset::BudMeshHeader, vertex_offset) == asset::MESH_HEADER_VERTEX_OFFSET, "BudMeshHeader alignment mismatch!");
+		static_assert(offsetof(asset::BudMeshHeader, attribute_offset) == asset::MESH_HEADER_ATTRIBUTE_OFFSET, "BudMeshHeader attribute_offset offset mismatch!");
 		static_assert(offsetof(asset::BudMeshHeader, submesh_count) == asset::MESH_HEADER_SUBMESH_COUNT_OFFSET, "BudMeshHeader submesh_count offset mismatch!");
 
-		bud::print("[IO] sizeof(Header)={}, sizeof(Vertex)={}", sizeof(asset::BudMeshHeader), sizeof(asset::Vertex));
+		const bool split_streams = header->version >= asset::MESH_VERSION_SPLIT_STREAMS;
+		bud::print("[IO] sizeof(Header)={}, version={}, vertex streams={}", sizeof(asset::BudMeshHeader), header->version, split_streams ? "split" : "interleaved");
 		bud::print("[IO] .budmesh: {}, size={}, v_count={}, i_count={}, m_count={}, s_count=",
 			display_path, data_size, header->total_vertices, header->total_indices, header->meshlet_count, header->submesh_count);
 
+		// Older headers end before lod_offset
+		const bool cluster_lod = header->version >= asset::MESH_VERSION_CLUSTER_LOD && header->lod_offset != 0;
+
 		auto check_offset = [&](uint64_t offset, size_t section_size, const char* name) {
 			if (offset + section_size > data_size) {
 				bud::eprint("[IO] Offset out of bounds: {} (offset={}, section_size={}, total={})", name, offset, section_size, data_size);
@@ -583,22 +589,30 @@ namespace bud::io {
 			return true;
 			};
 
-		if (!check_offset(header->vertex_offset, header->total_vertices * sizeof(asset::Vertex), "Vertices") ||
+		const bool vertices_valid = split_streams
+			? check_offset(header->vertex_offset, header->total_vertices * sizeof(asset::VertexPosition), "Positions")
+				&& check_offset(header->attribute_offset, header->total_vertices * sizeof(asset::VertexAttributes), "Attributes")
+			: check_offset(header->vertex_offset, header->total_vertices * sizeof(asset::Vertex), "Vertices");
+
+		if (!vertices_valid ||
 			!check_offset(header->index_offset, header->total_indices * sizeof(uint32_t), "Indices") ||
 			!check_offset(header->meshlet_offset, header->meshlet_count * sizeof(asset::MeshletDescriptor), "Meshlets") ||
 			!check_offset(header->vertex_index_offset, header->meshlet_index_offset - header->vertex_index_offset, "MeshletVertices") ||
 			!check_offset(header->meshlet_index_offset, header->cull_data_offset - header->meshlet_index_offset, "MeshletTriangles") ||
 			!check_offset(header->cull_data_offset, header->meshlet_count * sizeof(asset::MeshletCullData), "CullData") ||
 			(header->version >= 2 && !check_offset(header->submesh_offset, header->submesh_count * sizeof(asset::SubMeshDescriptor), "Submeshes")) ||
-			(header->version >= 3 && !check_offset(header->texture_offset, 0, "Textures"))) { // check_offset 0 just for existence of start
+			(header->version >= 3 && !check_offset(header->texture_offset, 0, "Textures")) || // check_offset 0 just for existence of start
+			(cluster_lod && !check_offset(header->lod_offset, header->submesh_count * sizeof(asset::SubMeshLod) + header->meshlet_count * sizeof(asset::MeshletLodBounds), "ClusterLod"))) {
 			bud::eprint("[IO] .budmesh validation failed for: {}", display_path);
 			return std::nullopt;
 		}
 
 		MeshData mesh;
 
-		// 1. Map Source Vertices
+		// 1. Map Source Vertices, v4 files already store the streams separately
 		const asset::Vertex* src_vertices = reinterpret_cast<const asset::Vertex*>(ptr + header->vertex_offset);
+		const asset::VertexPosition* src_positions = reinterpret_cast<const asset::VertexPosition*>(ptr + header->vertex_offset);
+		const asset::VertexAttributes* src_attributes = reinterpret_cast<const asset::VertexAttributes*>(ptr + header->attribute_offset);
 
 		// 2. Map Meshlet and Submesh Data
 		bud::print("[IO] Offsets: v={}, i={}, m={}, s={}", header->vertex_offset, header->index_offset, header->meshlet_offset, header->submesh_offset);
@@ -607,16 +621,20 @@ namespace bud::io {
 		const uint32_t* meshlet_triangles = reinterpret_cast<const uint32_t*>(ptr + header->meshlet_index_offset);
 		const asset::SubMeshDescriptor* submesh_descs = reinterpret_cast<const asset::SubMeshDescriptor*>(ptr + header->submesh_offset);
 
-		// 3. Fast load buffers (Convert back to engine-friendly Vertex structure)
-		mesh.vertices.resize(header->total_vertices);
+		// 3. Fast load buffers (Convert to the engine's position / attribute streams)
+		mesh.positions.resize(header->total_vertices);
+		mesh.attributes.resize(header->total_vertices);
 		for (uint32_t i = 0; i < header->total_vertices; ++i) {
-			MeshData::Vertex v;
-			v.pos = { src_vertices[i].position[0], src_vertices[i].position[1], src_vertices[i].position[2] };
-			v.normal = { src_vertices[i].normal[0], src_vertices[i].normal[1], src_vertices[i].normal[2] };
-			v.texture_uv = { src_vertices[i].uv[0], src_vertices[i].uv[1] };
-			v.color = { 1.0f, 1.0f, 1.0f };
-			v.texture_index = 0.0f;
-			mesh.vertices[i] = v;
+			const float* position = split_streams ? src_positions[i].position : src_vertices[i].position;
+			const float* normal = split_streams ? src_attributes[i].normal : src_vertices[i].normal;
+			const float* uv = split_streams ? src_attributes[i].uv : src_vertices[i].uv;
+
+			mesh.positions[i] = { position[0], position[1], position[2] };
+			auto& a = mesh.attributes[i];
+			a.normal = { normal[0], normal[1], normal[2] };
+			a.texture_uv = { uv[0], uv[1] };
+			a.color = { 1.0f, 1.0f, 1.0f };
+			a.texture_index = 0.0f;
 		}
 
 		const uint32_t* src_indices = reinterpret_cast<const uint32_t*>(ptr + header->index_offset);
@@ -637,6 +655,12 @@ namespace bud::io {
 		mesh.meshlet_vertices.assign(mv_ptr, mv_ptr + mv_count);
 		mesh.meshlet_triangles.assign(mt_ptr, mt_ptr + mt_count);
 
+		const asset::SubMeshLod* lod_ptr = cluster_lod ? reinterpret_cast<const asset::SubMeshLod*>(ptr + header->lod_offset) : nullptr;
+		if (cluster_lod) {
+			const asset::MeshletLodBounds* bounds_ptr = reinterpret_cast<const asset::MeshletLodBounds*>(lod_ptr + header->submesh_count);
+			mesh.meshlet_lods.assign(bounds_ptr, bounds_ptr + header->meshlet_count);
+		}
+
 		for (uint32_t s = 0; s < header->submesh_count; ++s) {
 			const auto& sub = sm_ptr[s];
 			MeshSubset subset;
@@ -649,10 +673,19 @@ namespace bud::io {
 				bud::math::vec3(sub.aabb_min[0], sub.aabb_min[1], sub.aabb_min[2]),
 				bud::math::vec3(sub.aabb_max[0], sub.aabb_max[1], sub.aabb_max[2])
 			);
+			if (lod_ptr && lod_ptr[s].meshlet_count >= sub.meshlet_count && (uint64_t)sub.meshlet_start + lod_ptr[s].meshlet_count <= header->meshlet_count) {
+				subset.lod_meshlet_count = lod_ptr[s].meshlet_count;
+				subset.lod_level_count = lod_ptr[s].level_count;
+			}
 			mesh.subsets.push_back(subset);
 		}
 
-		bud::print("[IO] Loaded mesh: {} (v={}, i={}, m={}, s={})", display_path, (uint32_t)mesh.vertices.size(), (uint32_t)mesh.indices.size(), (uint32_t)mesh.meshlets.size(), (uint32_t)mesh.subsets.size());
+		bud::print("[IO] Loaded mesh: {} (v={}, i={}, m={}, s={})", display_path, (uint32_t)mesh.vertex_count(), (uint32_t)mesh.indices.size(), (uint32_t)mesh.meshlets.size(), (uint32_t)mesh.subsets.size());
+		if (cluster_lod) {
+			uint32_t levels = 0;
+			for (const auto& subset : mesh.subsets) levels = std::max(levels, subset.lod_level_count);
+			bud::print("[IO] Cluster LOD hierarchy: up to {} levels", levels);
+		}
 
 		// Texture paths
 		if (header->version >= 3 && header->texture_count > 0) {
@@ -681,8 +714,8 @@ namespace bud::io {
 		: virtual_file_system(virtual_file_system), task_scheduler(scheduler), image_loader(virtual_file_system), model_loader(virtual_file_system) {
 	}
 
-	void AssetManager::load_mesh_async(const std::string& path, std::function<void(MeshData)> on_loaded) {
-		task_scheduler->spawn("AsyncMeshLoad", [this, path, on_loaded]() {
+	void AssetManager::load_mesh_async(const std::string& path, std::function<void(MeshData)> on_loaded, std::function<void()> on_failed) {
+		task_scheduler->spawn("AsyncMeshLoad", [this, path, on_loaded, on_failed]() {
 			std::optional<MeshData> mesh_opt;
 
 			std::string path_lower = path;
@@ -720,6 +753,12 @@ namespace bud::io {
 				else {
 					bud::eprint("[Asset] Failed to load mesh: {} (could not resolve)", path);
 				}
+
+				if (on_failed) {
+					task_scheduler->submit_main_thread_task([on_failed]() {
+						on_failed();
+						});
+				}
 			}
 			});
 	}
@@ -757,6 +796,17 @@ namespace bud::io {
 
 
 	void AssetManager::load_file_async(const std::string& path, std::function<void(std::vector<char>)> on_loaded) {
+		if (auto it = bundled_files.find(path); it != bundled_files.end()) {
+			task_scheduler->spawn("BundledFileLoad", [this, file = it->second, on_loaded]() {
+				std::vector<char> data;
+				decode_bundled_file(file, data); // Empty on failure, like a failed read
+				task_scheduler->submit_main_thread_task([on_loaded, data = std::move(data)]() mutable {
+					on_loaded(std::move(data));
+					});
+				});
+			return;
+		}
+
 		task_scheduler->spawn("AsyncFileLoad", [this, path, on_loaded]() {
 			auto data_opt = this->virtual_file_system->read_binary(path);
 			if (data_opt) {
@@ -792,38 +842,176 @@ namespace bud::io {
 			});
 	}
 
-	void AssetManager::load_json_async(const std::string& path, std::function<void(nlohmann::json)> on_loaded) {
-		task_scheduler->spawn("AsyncJSONLoad", [this, path, on_loaded]() {
-			auto data_opt = this->virtual_file_system->read_binary(path);
-			if (data_opt) {
-				try {
-					nlohmann::json j = nlohmann::json::parse(data_opt->begin(), data_opt->end());
-					// Log resolved path for successful JSON loads
-					auto resolved = this->virtual_file_system->resolve_path(path);
-					if (resolved) {
-						bud::print("[IO] Loaded JSON (resolved): {}", resolved->string());
-					}
-					else {
-						bud::print("[IO] Loaded JSON: {}", path);
-					}
+	bool AssetManager::mount_shader_bundle(const std::string& path) {
+		const auto start = std::chrono::steady_clock::now();
 
-					task_scheduler->submit_main_thread_task([on_loaded, json = std::move(j)]() mutable {
-						on_loaded(std::move(json));
-						});
-				}
-				catch (const std::exception& e) {
-					bud::eprint("[Asset] Failed to parse JSON: {} - {}", path, e.what());
-				}
+		auto data_opt = virtual_file_system->read_binary(path);
+		if (!data_opt) {
+			bud::print("[IO] No shader bundle at {}, loading SPIR-V files individually", path);
+			return false;
+		}
+
+		auto& data = *data_opt;
+		asset::ShaderBundleHeader header{};
+		if (data.size() >= sizeof(header))
+			std::memcpy(&header, data.data(), sizeof(header));
+		if (header.magic != asset::SHADER_BUNDLE_MAGIC || header.version != asset::SHADER_BUNDLE_VERSION) {
+			bud::eprint("[IO] {} is not a version {} shader bundle, loading SPIR-V files individually", path, asset::SHADER_BUNDLE_VERSION);
+			return false;
+		}
+
+		const uint64_t file_size = data.size();
+		auto in_bounds = [file_size](uint64_t offset, uint64_t size) {
+			return offset <= file_size && size <= file_size - offset;
+		};
+		bool valid = in_bounds(header.entry_offset, uint64_t(header.entry_count) * sizeof(asset::ShaderBundleEntry))
+			&& in_bounds(header.blob_offset, uint64_t(header.blob_count) * sizeof(asset::ShaderBundleBlob))
+			&& header.string_offset <= header.data_offset && in_bounds(header.data_offset, 0);
+
+		uint64_t raw_bytes = 0;
+		for (uint32_t i = 0; valid && i < header.blob_count; ++i) {
+			asset::ShaderBundleBlob blob;
+			std::memcpy(&blob, data.data() + header.blob_offset + i * sizeof(blob), sizeof(blob));
+			valid = in_bounds(header.data_offset + blob.offset, blob.stored_size);
+			raw_bytes += blob.size;
+		}
+
+		shader_bundle = std::move(data);
+		bundled_files.clear();
+
+		// Names and reflection stay in shader_bundle, the map only holds views into it
+		const char* strings = shader_bundle.data() + header.string_offset;
+		const uint64_t string_size = header.data_offset - header.string_offset;
+		for (uint32_t i = 0; valid && i < header.entry_count; ++i) {
+			asset::ShaderBundleEntry entry;
+			std::memcpy(&entry, shader_bundle.data() + header.entry_offset + i * sizeof(entry), sizeof(entry));
+			valid = entry.blob_index < header.blob_count
+				&& uint64_t(entry.name_offset) + entry.name_size <= string_size
+				&& uint64_t(entry.reflection_offset) + entry.reflection_size <= string_size;
+			if (valid) {
+				bundled_files[std::string(strings + entry.name_offset, entry.name_size)] =
+					BundledFile{ entry.blob_index, std::string_view(strings + entry.reflection_offset, entry.reflection_size) };
+			}
+		}
+
+		if (!valid) {
+			bud::eprint("[IO] Shader bundle {} is corrupt, loading SPIR-V files individually", path);
+			bundled_files.clear();
+			shader_bundle = {};
+			return false;
+		}
+
+		const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		bud::print("[IO] Mounted shader bundle {}: {} shaders, {} unique, {} KB -> {} KB{} in {:.2f} ms",
+			path, header.entry_count, header.blob_count, raw_bytes / 1024, file_size / 1024,
+			(header.flags & asset::SHADER_BUNDLE_FLAG_COMPRESSED) ? " (compressed)" : "", ms);
+		return true;
+	}
+
+	bool AssetManager::is_bundled(const std::string& path) const {
+		return bundled_files.contains(path);
+	}
+
+	std::string_view AssetManager::get_shader_reflection(const std::string& path) const {
+		auto it = bundled_files.find(path);
+		return it != bundled_files.end() ? it->second.reflection : std::string_view();
+	}
+
+	bool AssetManager::decode_bundled_file(const BundledFile& file, std::vector<char>& out) const {
+		asset::ShaderBundleHeader header;
+		std::memcpy(&header, shader_bundle.data(), sizeof(header));
+		asset::ShaderBundleBlob blob;
+		std::memcpy(&blob, shader_bundle.data() + header.blob_offset + file.blob_index * sizeof(blob), sizeof(blob));
+
+		const char* stored = shader_bundle.data() + header.data_offset + blob.offset;
+		out.resize(blob.size);
+		if (blob.stored_size == blob.size) {
+			std::memcpy(out.data(), stored, blob.size);
+			return true;
+		}
+		if (!bud::compress::lz_decompress(stored, blob.stored_size, out.data(), out.size())) {
+			bud::eprint("[IO] Shader bundle blob {} failed to decompress", file.blob_index);
+			out.clear();
+			return false;
+		}
+		return true;
+	}
+
+	bool AssetManager::load_bundled_files_async(const std::vector<std::string>& paths, const std::function<void(std::vector<std::vector<char>>)>& on_loaded) {
+		if (bundled_files.empty())
+			return false;
+
+		std::vector<BundledFile> files;
+		files.reserve(paths.size());
+		for (const auto& path : paths) {
+			auto it = bundled_files.find(path);
+			if (it == bundled_files.end())
+				return false;
+			files.push_back(it->second);
+		}
+
+		task_scheduler->spawn("BundledShaderLoad", [this, files = std::move(files), on_loaded]() {
+			std::vector<std::vector<char>> results(files.size());
+			for (size_t i = 0; i < files.size(); ++i)
+				decode_bundled_file(files[i], results[i]);
+			on_loaded(std::move(results));
+			});
+		return true;
+	}
+
+	void AssetManager::wait_for_shader_loads() {
+		// Per-file loads deliver through main-thread tasks, keep pumping them while waiting
+		task_scheduler->wait_for_counter(shader_load_counter, [this]() {
+			task_scheduler->pump_main_thread_tasks();
+			});
+	}
+
+	std::optional<nlohmann::json> AssetManager::load_json(const std::string& path) {
+		auto data_opt = virtual_file_system->read_binary(path);
+		if (!data_opt) {
+			auto resolved = virtual_file_system->resolve_path(path);
+			if (resolved) {
+				bud::eprint("[Asset] Failed to read JSON file: {} (resolved: {})", path, resolved->string());
 			}
 			else {
-				auto resolved = this->virtual_file_system->resolve_path(path);
-				if (resolved) {
-					bud::eprint("[Asset] Failed to read JSON file: {} (resolved: {})", path, resolved->string());
-				}
-				else {
-					bud::eprint("[Asset] Failed to read JSON file: {} (could not resolve)", path);
+				bud::eprint("[Asset] Failed to read JSON file: {} (could not resolve)", path);
+			}
+			return std::nullopt;
+		}
+
+		try {
+			nlohmann::json j = nlohmann::json::parse(data_opt->begin(), data_opt->end());
+			// Log resolved path for successful JSON loads
+			auto resolved = virtual_file_system->resolve_path(path);
+			if (resolved) {
+				bud::print("[IO] Loaded JSON (resolved): {}", resolved->string());
+			}
+			else {
+				bud::print("[IO] Loaded JSON: {}", path);
+			}
+			return j;
+		}
+		catch (const std::exception& e) {
+			bud::eprint("[Asset] Failed to parse JSON: {} - {}", path, e.what());
+			return std::nullopt;
+		}
+	}
+
+	void AssetManager::load_json_async(const std::string& path, std::function<void(nlohmann::json)> on_loaded, std::function<void()> on_failed) {
+		task_scheduler->spawn("AsyncJSONLoad", [this, path, on_loaded, on_failed]() {
+			auto json = this->load_json(path);
+			if (!json) {
+				if (on_failed) {
+					task_scheduler->submit_main_thread_task([on_failed]() {
+						on_failed();
+						});
 				}
+				return;
 			}
+
+			task_scheduler->submit_main_thread_task([on_loaded, json = std::move(*json)]() mutable {
+				on_loaded(std::move(json));
+				});
 			});
 	}
 
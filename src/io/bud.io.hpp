@@ -5,6 +5,9 @@
 #include <filesystem>
 #include <optional>
 #include <functional>
+#include <chrono>
+#include <string_view>
+#include <unordered_map>
 
 // 保持第三方库的 include
 #include <tiny_gltf.h> 
@@ -30,9 +33,12 @@ namespace bud::io {
 		uint32_t meshlet_count;
 		uint32_t material_index;
 		bud::math::AABB aabb;
+		uint32_t lod_meshlet_count = 0; // Cluster LOD: meshlets of every level from meshlet_start, 0 = flat
+		uint32_t lod_level_count = 1;
 	};
 
 	struct MeshData {
+		// Full vertex, loaders deduplicate with it before splitting into the streams below
 		struct Vertex {
 			glm::vec3 pos;
 			glm::vec3 color;
@@ -43,7 +49,17 @@ namespace bud::io {
 			bool operator==(const Vertex& other) const;
 		};
 
-		std::vector<Vertex> vertices;
+		// Everything but the position, GeometryPool attribute stream (vertex input binding 1)
+		struct VertexAttributes {
+			glm::vec3 color;
+			glm::vec3 normal;
+			glm::vec2 texture_uv;
+			float texture_index;
+		};
+
+		// Split vertex streams, same length; depth-only passes fetch just the positions
+		std::vector<glm::vec3> positions;
+		std::vector<VertexAttributes> attributes;
 		std::vector<uint32_t> indices;
 		std::vector<std::string> texture_paths;
 		std::vector<MeshSubset> subsets;
@@ -53,7 +69,19 @@ namespace bud::io {
 		std::vector<bud::asset::MeshletCullData> meshlet_cull_data;
 		std::vector<uint32_t> meshlet_vertices;
 		std::vector<uint32_t> meshlet_triangles;
+		std::vector<bud::asset::MeshletLodBounds> meshlet_lods; // Parallel to meshlets, empty without a cluster LOD hierarchy
+
+		size_t vertex_count() const { return positions.size(); }
+		void add_vertex(const Vertex& v) {
+			positions.push_back(v.pos);
+			attributes.push_back({ v.color, v.normal, v.texture_uv, v.texture_index });
+		}
 	};
+
+	// Interleaved MeshData::Vertex before the stream split, kept to report the vertex fetch saving
+	constexpr uint32_t VERTEX_INTERLEAVED_STRIDE = sizeof(MeshData::Vertex);
+	constexpr uint32_t VERTEX_POSITION_STRIDE = sizeof(glm::vec3);
+	constexpr uint32_t VERTEX_ATTRIBUTE_STRIDE = sizeof(MeshData::VertexAttributes);
 }
 
 // 特化 glm::vec3 和 glm::vec2 的哈希函数
@@ -142,17 +170,49 @@ private:
 	public:
     AssetManager(VirtualFileSystem* virtual_file_system, bud::threading::TaskScheduler* scheduler);
 
-		void load_mesh_async(const std::string& path, std::function<void(MeshData)> on_loaded);
+		// on_failed runs on the main thread instead of on_loaded when the mesh / JSON can't be read,
+		// so callers counting outstanding loads still finish
+		void load_mesh_async(const std::string& path, std::function<void(MeshData)> on_loaded, std::function<void()> on_failed = nullptr);
 		void load_image_async(const std::string& path, std::function<void(Image)> on_loaded);
 		void load_file_async(const std::string& path, std::function<void(std::vector<char>)> on_loaded);
-		void load_json_async(const std::string& path, std::function<void(nlohmann::json)> on_loaded);
+		void load_json_async(const std::string& path, std::function<void(nlohmann::json)> on_loaded, std::function<void()> on_failed = nullptr);
+		// Blocking read + parse on the calling thread, for startup jobs that already run on a worker
+		std::optional<nlohmann::json> load_json(const std::string& path);
 		void save_json_async(const std::string& path, const nlohmann::json& json, std::function<void(bool)> on_finished = nullptr);
 		void save_file_async(const std::string& path, std::vector<char> data, std::function<void(bool)> on_finished = nullptr);
 
+		// Shader bundle (BudAssetTool --bundle-shaders): read once, bundled paths are then served from memory.
+		// Call before any shader load; a missing or stale bundle leaves the per-file loads in place.
+		bool mount_shader_bundle(const std::string& path);
+		bool has_shader_bundle() const { return !bundled_files.empty(); }
+		bool is_bundled(const std::string& path) const;
+		// Reflection JSON of the shader source from the build-time report, empty when not bundled
+		std::string_view get_shader_reflection(const std::string& path) const;
+
+		// All paths bundled: decodes them in one task and calls on_loaded on that worker, so callers may only
+		// touch thread-safe state (RHI pipeline creation is). Returns false, without calling, otherwise.
+		bool load_bundled_files_async(const std::vector<std::string>& paths, const std::function<void(std::vector<std::vector<char>>)>& on_loaded);
+
+		// Outstanding RenderPass::load_shaders_async groups
+		bud::threading::Counter& get_shader_load_counter() { return shader_load_counter; }
+		// Main thread, before the first frame: runs main-thread tasks until every shader group has its pipelines
+		void wait_for_shader_loads();
+
 	private:
+		struct BundledFile {
+			uint32_t blob_index;
+			std::string_view reflection;
+		};
+
+		bool decode_bundled_file(const BundledFile& file, std::vector<char>& out) const;
+
     VirtualFileSystem* virtual_file_system;
     bud::threading::TaskScheduler* task_scheduler;
 
+		std::vector<char> shader_bundle;                              // Whole file, entries point into it
+		std::unordered_map<std::string, BundledFile> bundled_files;
+		bud::threading::Counter shader_load_counter;
+
     ImageLoader image_loader;
     ModelLoader model_loader;
 	};
@@ -0,0 +1,508 @@
+﻿#include "src/ml/bud.ml.onnx.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+
+#include <onnxruntime_cxx_api.h>
+
+#include "src/core/bud.logger.hpp"
+#include "src/core/bud.profiler.hpp"
+
+namespace bud::ml {
+
+	namespace {
+		// One ORT environment per process, sessions share its logging and global state
+		Ort::Env& get_env() {
+			static Ort::Env env(ORT_LOGGING_LEVEL_WARNING, "BudEngine");
+			return env;
+		}
+
+		ONNXTensorElementDataType to_onnx_type(DataType type) {
+			switch (type) {
+			case DataType::Float32: return ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT;
+			case DataType::Float16: return ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16;
+			case DataType::Int8: return ONNX_TENSOR_ELEMENT_DATA_TYPE_INT8;
+			case DataType::Uint32: return ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT32;
+			}
+			return ONNX_TENSOR_ELEMENT_DATA_TYPE_UNDEFINED;
+		}
+
+		size_t element_size(ONNXTensorElementDataType type) {
+			switch (type) {
+			case ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT:
+			case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT32:
+			case ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT32:
+				return 4;
+			case ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16:
+			case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT16:
+			case ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT16:
+				return 2;
+			case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT8:
+			case ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT8:
+			case ONNX_TENSOR_ELEMENT_DATA_TYPE_BOOL:
+				return 1;
+			case ONNX_TENSOR_ELEMENT_DATA_TYPE_DOUBLE:
+			case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT64:
+			case ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT64:
+				return 8;
+			default:
+				return 0;
+			}
+		}
+
+		float elapsed_ms(std::chrono::steady_clock::time_point start) {
+			return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+		}
+	}
+
+	struct OnnxCpuBackend::Impl {
+		struct Binding {
+			std::string name;
+			void* data = nullptr;
+			size_t byte_size = 0;
+			std::vector<int64_t> shape;
+			ONNXTensorElementDataType type = ONNX_TENSOR_ELEMENT_DATA_TYPE_UNDEFINED;
+			bool is_output = false;
+		};
+
+		// Async runs never touch caller memory: each slot owns a copy of every input and output.
+		// One slot runs while the other holds the last finished results.
+		struct Slot {
+			std::unique_ptr<Ort::IoBinding> io_binding;
+			std::vector<std::vector<std::byte>> storage;  // Inputs then outputs
+			std::vector<Ort::Value> values;
+			uint64_t binding_version = 0;                  // Bindings the storage was laid out for, 0 = none
+		};
+
+		Ort::MemoryInfo memory_info = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+		std::unique_ptr<Ort::Session> session;
+		std::unique_ptr<Ort::IoBinding> io_binding;      // Synchronous runs, zero-copy on the caller tensors
+
+		std::vector<Binding> bindings;                   // Caller tensors
+		std::vector<std::vector<std::byte>> owned;       // Inputs then outputs, used when not bound
+		std::vector<Ort::Value> values;                  // Keep the bound views alive
+		bool bindings_dirty = true;
+		uint64_t binding_version = 1;
+
+		Slot slots[2];
+		uint32_t next_slot = 0;
+		std::atomic<uint32_t> published{ 0 };            // Slot + 1 of a finished run not yet copied out, 0 = none
+
+		mutable std::mutex stats_mutex;
+		OnnxCpuStats stats;
+
+		const Binding* find_binding(const std::string& name, bool output) const {
+			auto it = std::find_if(bindings.begin(), bindings.end(), [&](const Binding& b) { return b.is_output == output && b.name == name; });
+			return it != bindings.end() ? &*it : nullptr;
+		}
+
+		// Caller tensor when bound, backend-owned storage otherwise
+		std::span<std::byte> tensor_memory(const std::string& name, bool output, size_t owned_index) {
+			if (const Binding* binding = find_binding(name, output))
+				return { static_cast<std::byte*>(binding->data), binding->byte_size };
+			return owned[owned_index];
+		}
+
+		bool run(Ort::IoBinding& io) {
+			ZoneScopedN("OnnxInference");
+
+			auto start = std::chrono::steady_clock::now();
+			bool ok = true;
+			try {
+				session->Run(Ort::RunOptions{ nullptr }, io);
+			}
+			catch (const Ort::Exception& e) {
+				bud::eprint("[ML] ONNX inference failed: {}", e.what());
+				ok = false;
+			}
+
+			float ms = elapsed_ms(start);
+			std::lock_guard lock(stats_mutex);
+			if (ok) {
+				stats.last_latency_ms = ms;
+				stats.completed++;
+			}
+			else {
+				stats.failed++;
+			}
+			return ok;
+		}
+	};
+
+	OnnxCpuBackend::OnnxCpuBackend(bud::threading::TaskScheduler* task_scheduler, const OnnxCpuConfig& config)
+		: task_scheduler(task_scheduler), config(config), impl(std::make_unique<Impl>()) {
+	}
+
+	OnnxCpuBackend::~OnnxCpuBackend() {
+		unload();
+	}
+
+	bool OnnxCpuBackend::is_loaded() const {
+		return impl->session != nullptr;
+	}
+
+	static Ort::SessionOptions make_session_options(const OnnxCpuConfig& config, bud::threading::TaskScheduler* task_scheduler) {
+		// Only a cap at the scheduler's worker count. Workers are not reserved or parked while ORT's pool
+		// runs, so keep intra_op_threads low and spinning off when the frame has other work.
+		uint32_t threads = std::max(1u, config.intra_op_threads);
+		if (task_scheduler)
+			threads = std::min<uint32_t>(threads, static_cast<uint32_t>(std::max<size_t>(1, task_scheduler->get_thread_count())));
+
+		Ort::SessionOptions options;
+		options.SetIntraOpNumThreads(static_cast<int>(threads));
+		options.SetInterOpNumThreads(1);
+		options.SetExecutionMode(ExecutionMode::ORT_SEQUENTIAL);
+		options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
+		options.AddConfigEntry("session.intra_op.allow_spinning", config.allow_spinning ? "1" : "0");
+		options.AddConfigEntry("session.inter_op.allow_spinning", "0");
+		return options;
+	}
+
+	void OnnxCpuBackend::unload() {
+		// No copy into the caller's outputs here, they may already be gone
+		if (task_scheduler && run_counter.load(std::memory_order_acquire) > 0)
+			task_scheduler->wait_for_counter(run_counter);
+		impl->published.store(0, std::memory_order_relaxed);
+		for (auto& slot : impl->slots) slot = {};
+		impl->next_slot = 0;
+		impl->values.clear();
+		impl->io_binding.reset();
+		impl->session.reset();
+		inputs.clear();
+		outputs.clear();
+	}
+
+	bool OnnxCpuBackend::load_model(const std::string& path) {
+		unload();
+
+		std::error_code ec;
+		if (!std::filesystem::exists(path, ec)) {
+			bud::eprint("[ML] ONNX model not found: {}", path);
+			return false;
+		}
+
+		try {
+			auto options = make_session_options(config, task_scheduler);
+			// ORTCHAR_T is wchar_t on Windows, path::c_str() matches it on every platform
+			impl->session = std::make_unique<Ort::Session>(get_env(), std::filesystem::path(path).c_str(), options);
+		}
+		catch (const Ort::Exception& e) {
+			bud::eprint("[ML] Failed to load ONNX model {}: {}", path, e.what());
+			impl->session.reset();
+			return false;
+		}
+
+		return finish_load(path);
+	}
+
+	bool OnnxCpuBackend::load_model_from_memory(const void* data, size_t size, const std::string& debug_name) {
+		unload();
+
+		try {
+			auto options = make_session_options(config, task_scheduler);
+			impl->session = std::make_unique<Ort::Session>(get_env(), data, size, options);
+		}
+		catch (const Ort::Exception& e) {
+			bud::eprint("[ML] Failed to load ONNX model {}: {}", debug_name, e.what());
+			impl->session.reset();
+			return false;
+		}
+
+		return finish_load(debug_name);
+	}
+
+	bool OnnxCpuBackend::finish_load(const std::string& debug_name) {
+		auto& session = *impl->session;
+		Ort::AllocatorWithDefaultOptions allocator;
+
+		auto describe = [&](bool output, size_t index) {
+			TensorInfo info;
+			info.name = output ? session.GetOutputNameAllocated(index, allocator).get() : session.GetInputNameAllocated(index, allocator).get();
+			auto type_info = output ? session.GetOutputTypeInfo(index) : session.GetInputTypeInfo(index);
+			auto tensor_info = type_info.GetTensorTypeAndShapeInfo();
+			info.shape = tensor_info.GetShape();
+			info.element_type = static_cast<int32_t>(tensor_info.GetElementType());
+
+			size_t count = 1;
+			for (auto& d : info.shape) {
+				if (d <= 0) d = 1;  // Dynamic batch etc., callers binding their own tensors set the real size
+				count *= static_cast<size_t>(d);
+			}
+			info.byte_size = count * element_size(static_cast<ONNXTensorElementDataType>(info.element_type));
+			return info;
+		};
+
+		try {
+			inputs.clear();
+			outputs.clear();
+			for (size_t i = 0; i < session.GetInputCount(); ++i) inputs.push_back(describe(false, i));
+			for (size_t i = 0; i < session.GetOutputCount(); ++i) outputs.push_back(describe(true, i));
+			impl->io_binding = std::make_unique<Ort::IoBinding>(session);
+		}
+		catch (const Ort::Exception& e) {
+			bud::eprint("[ML] Failed to query ONNX model {}: {}", debug_name, e.what());
+			unload();
+			return false;
+		}
+
+		impl->owned.clear();
+		for (const auto& t : inputs) impl->owned.emplace_back(t.byte_size);
+		for (const auto& t : outputs) impl->owned.emplace_back(t.byte_size);
+		impl->bindings_dirty = true;
+		impl->binding_version++;
+
+		// First runs pay for allocations and kernel selection, keep them out of frame time
+		auto start = std::chrono::steady_clock::now();
+		for (uint32_t i = 0; i < config.warmup_runs; ++i) {
+			if (!apply_bindings() || !execute()) {
+				bud::eprint("[ML] Warm-up run failed for {}", debug_name);
+				unload();
+				return false;
+			}
+		}
+
+		{
+			std::lock_guard lock(impl->stats_mutex);
+			impl->stats = {};
+			impl->stats.warmup_ms = elapsed_ms(start);
+		}
+
+		bud::print("[ML] Loaded ONNX model {}: {} inputs, {} outputs, warm-up {:.2f} ms", debug_name, inputs.size(), outputs.size(), get_stats().warmup_ms);
+		return true;
+	}
+
+	void OnnxCpuBackend::bind(std::string_view tensor_name, const GpuTensor& tensor, bool output) {
+		const char* kind = output ? "output" : "input";
+
+		if (!tensor.is_buffer() || !tensor.as_buffer().mapped_ptr) {
+			std::string err = std::format("[ML] ONNX {} '{}' must be a host-visible buffer for the CPU backend", kind, tensor_name);
+			bud::eprint("{}", err);
+#if defined(_DEBUG)
+			throw std::runtime_error(err);
+#else
+			return;
+#endif
+		}
+
+		auto type = to_onnx_type(tensor.data_type());
+		auto buffer = tensor.as_buffer();
+		size_t byte_size = tensor.element_count() * element_size(type);
+		if (buffer.size != 0 && tensor.offset() + byte_size > buffer.size) {
+			std::string err = std::format("[ML] ONNX {} '{}' needs {} bytes at offset {}, buffer has {}", kind, tensor_name, byte_size, tensor.offset(), buffer.size);
+			bud::eprint("{}", err);
+#if defined(_DEBUG)
+			throw std::runtime_error(err);
+#else
+			return;
+#endif
+		}
+
+		if (is_loaded()) {
+			const auto& infos = output ? outputs : inputs;
+			auto info = std::find_if(infos.begin(), infos.end(), [&](const TensorInfo& t) { return t.name == tensor_name; });
+			if (info == infos.end() || info->element_type != static_cast<int32_t>(type)) {
+				bud::eprint("[ML] ONNX model has no {} '{}' of the bound element type", kind, tensor_name);
+				return;
+			}
+		}
+
+		Impl::Binding binding;
+		binding.name = std::string(tensor_name);
+		binding.data = static_cast<std::byte*>(buffer.mapped_ptr) + tensor.offset();
+		binding.byte_size = byte_size;
+		binding.shape.assign(tensor.shape().begin(), tensor.shape().end());
+		binding.type = type;
+		binding.is_output = output;
+
+		auto it = std::find_if(impl->bindings.begin(), impl->bindings.end(), [&](const Impl::Binding& b) {
+			return b.is_output == output && b.name == tensor_name;
+		});
+		if (it != impl->bindings.end()) *it = std::move(binding);
+		else impl->bindings.push_back(std::move(binding));
+
+		// Picked up by the next dispatch, a run in flight keeps its own binding
+		impl->bindings_dirty = true;
+		impl->binding_version++;
+	}
+
+	void OnnxCpuBackend::bind_input(std::string_view tensor_name, const GpuTensor& tensor) {
+		bind(tensor_name, tensor, false);
+	}
+
+	void OnnxCpuBackend::bind_output(std::string_view tensor_name, const GpuTensor& tensor) {
+		bind(tensor_name, tensor, true);
+	}
+
+	void OnnxCpuBackend::record_dispatch(graphics::RHI* rhi, graphics::CommandHandle cmd) {
+		if (!is_loaded())
+			return;
+
+		if (!config.async || !task_scheduler) {
+			if (apply_bindings())
+				execute();
+			return;
+		}
+
+		// The published slot is never the one running, copying it out is safe while a run is in flight
+		deliver_results();
+
+		// Previous run still busy: skip rather than queue, the bound outputs keep the last published results
+		if (in_flight.load(std::memory_order_acquire)) {
+			std::lock_guard lock(impl->stats_mutex);
+			impl->stats.skipped++;
+			return;
+		}
+
+		const uint32_t slot = impl->next_slot;
+		if (!prepare_slot(slot))
+			return;
+		impl->next_slot ^= 1u;
+
+		in_flight.store(true, std::memory_order_release);
+		task_scheduler->spawn("OnnxInference", [this, slot]() {
+			if (impl->run(*impl->slots[slot].io_binding))
+				impl->published.store(slot + 1, std::memory_order_release);
+			in_flight.store(false, std::memory_order_release);
+		}, &run_counter);
+	}
+
+	void OnnxCpuBackend::wait() {
+		if (task_scheduler && run_counter.load(std::memory_order_acquire) > 0)
+			task_scheduler->wait_for_counter(run_counter);
+		deliver_results();
+	}
+
+	bool OnnxCpuBackend::prepare_slot(uint32_t slot_index) {
+		auto& slot = impl->slots[slot_index];
+		const size_t tensor_count = inputs.size() + outputs.size();
+
+		if (slot.binding_version != impl->binding_version) {
+			try {
+				if (!slot.io_binding) slot.io_binding = std::make_unique<Ort::IoBinding>(*impl->session);
+				slot.io_binding->ClearBoundInputs();
+				slot.io_binding->ClearBoundOutputs();
+				slot.values.clear();
+				slot.storage.resize(tensor_count);
+
+				for (size_t t = 0; t < tensor_count; ++t) {
+					const bool output = t >= inputs.size();
+					const auto& info = output ? outputs[t - inputs.size()] : inputs[t];
+					const Impl::Binding* binding = impl->find_binding(info.name, output);
+					const auto& shape = binding ? binding->shape : info.shape;
+					const auto type = binding ? binding->type : static_cast<ONNXTensorElementDataType>(info.element_type);
+
+					auto& storage = slot.storage[t];
+					storage.assign(binding ? binding->byte_size : info.byte_size, std::byte{ 0 });
+					auto value = Ort::Value::CreateTensor(impl->memory_info, storage.data(), storage.size(), shape.data(), shape.size(), type);
+					if (output) slot.io_binding->BindOutput(info.name.c_str(), value);
+					else slot.io_binding->BindInput(info.name.c_str(), value);
+					slot.values.push_back(std::move(value));
+				}
+			}
+			catch (const Ort::Exception& e) {
+				bud::eprint("[ML] Failed to bind ONNX tensors: {}", e.what());
+				slot.binding_version = 0;
+				return false;
+			}
+			slot.binding_version = impl->binding_version;
+		}
+
+		// Snapshot of the inputs, the caller may refill its buffers as soon as this returns
+		for (size_t i = 0; i < inputs.size(); ++i) {
+			auto source = impl->tensor_memory(inputs[i].name, false, i);
+			auto& storage = slot.storage[i];
+			std::memcpy(storage.data(), source.data(), std::min(storage.size(), source.size()));
+		}
+		return true;
+	}
+
+	void OnnxCpuBackend::deliver_results() {
+		const uint32_t ready = impl->published.exchange(0, std::memory_order_acq_rel);
+		if (ready == 0)
+			return;
+
+		const auto& slot = impl->slots[ready - 1];
+		for (size_t i = 0; i < outputs.size(); ++i) {
+			auto target = impl->tensor_memory(outputs[i].name, true, inputs.size() + i);
+			const auto& storage = slot.storage[inputs.size() + i];
+			std::memcpy(target.data(), storage.data(), std::min(storage.size(), target.size()));
+		}
+	}
+
+	bool OnnxCpuBackend::run_now() {
+		if (!is_loaded())
+			return false;
+
+		wait();
+		return apply_bindings() && execute();
+	}
+
+	OnnxCpuStats OnnxCpuBackend::get_stats() const {
+		std::lock_guard lock(impl->stats_mutex);
+		return impl->stats;
+	}
+
+	void* OnnxCpuBackend::get_owned_data(std::string_view tensor_name) {
+		for (size_t i = 0; i < inputs.size(); ++i) {
+			if (inputs[i].name == tensor_name) return impl->owned[i].data();
+		}
+		for (size_t i = 0; i < outputs.size(); ++i) {
+			if (outputs[i].name == tensor_name) return impl->owned[inputs.size() + i].data();
+		}
+		return nullptr;
+	}
+
+	bool OnnxCpuBackend::apply_bindings() {
+		if (!impl->bindings_dirty)
+			return true;
+
+		auto& io = *impl->io_binding;
+		try {
+			io.ClearBoundInputs();
+			io.ClearBoundOutputs();
+			impl->values.clear();
+
+			auto bind_all = [&](const std::vector<TensorInfo>& infos, bool output, size_t owned_base) {
+				for (size_t i = 0; i < infos.size(); ++i) {
+					const auto& info = infos[i];
+					auto it = std::find_if(impl->bindings.begin(), impl->bindings.end(), [&](const Impl::Binding& b) {
+						return b.is_output == output && b.name == info.name;
+					});
+
+					Ort::Value value{ nullptr };
+					if (it != impl->bindings.end()) {
+						value = Ort::Value::CreateTensor(impl->memory_info, it->data, it->byte_size, it->shape.data(), it->shape.size(), it->type);
+					}
+					else {
+						auto& storage = impl->owned[owned_base + i];
+						value = Ort::Value::CreateTensor(impl->memory_info, storage.data(), storage.size(), info.shape.data(), info.shape.size(),
+							static_cast<ONNXTensorElementDataType>(info.element_type));
+					}
+
+					if (output) io.BindOutput(info.name.c_str(), value);
+					else io.BindInput(info.name.c_str(), value);
+					impl->values.push_back(std::move(value));
+				}
+			};
+
+			bind_all(inputs, false, 0);
+			bind_all(outputs, true, inputs.size());
+		}
+		catch (const Ort::Exception& e) {
+			bud::eprint("[ML] Failed to bind ONNX tensors: {}", e.what());
+			return false;
+		}
+
+		impl->bindings_dirty = false;
+		return true;
+	}
+
+	bool OnnxCpuBackend::execute() {
+		return impl->run(*impl->io_binding);
+	}
+}
@@ -0,0 +1,109 @@
+﻿#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "bud.ml.backend.hpp"
+#include "src/threading/bud.threading.hpp"
+
+namespace bud::ml {
+
+	struct OnnxCpuConfig {
+		// ORT intra-op threads, capped at the scheduler's worker count. 0: one, inference runs as a single
+		// scheduler task next to the engine's fibers. More threads are a second pool beside the workers,
+		// nothing reserves or parks workers for them.
+		uint32_t intra_op_threads = 0;
+		// Extra ORT threads park instead of spinning, so idle ones don't starve the fiber workers
+		bool allow_spinning = false;
+		uint32_t warmup_runs = 2;
+		// false: record_dispatch runs inference inline on the calling thread
+		bool async = true;
+	};
+
+	struct OnnxCpuStats {
+		float last_latency_ms = 0.0f;  // Session::Run of the last completed dispatch
+		float warmup_ms = 0.0f;
+		uint64_t completed = 0;
+		uint64_t skipped = 0;          // Dispatches dropped because the previous run was still busy
+		uint64_t failed = 0;
+	};
+
+	// CPU inference through ONNX Runtime. GpuTensors must live in host-visible buffers
+	// (BufferHandle::mapped_ptr). Synchronous runs (run_now, async off) bind them zero-copy and
+	// ORT reads and writes them in place. Inputs and outputs the caller doesn't bind get
+	// backend-owned tensors sized from the model.
+	//
+	// record_dispatch doesn't record GPU work, it starts a run on the task scheduler. Async runs use
+	// one of two backend-owned tensor sets: the inputs are copied in at dispatch, so the caller may
+	// refill them right away, and a finished set is published with an atomic index. The published
+	// outputs are copied into the bound outputs on the calling thread by the next record_dispatch
+	// or wait(), so the bound outputs only change there, never while a run is in flight.
+	// Rebinding in between is safe, it takes effect on the next dispatch.
+	class OnnxCpuBackend final : public InferBackendBase {
+	public:
+		OnnxCpuBackend(bud::threading::TaskScheduler* task_scheduler, const OnnxCpuConfig& config = {});
+		~OnnxCpuBackend() override;
+
+		OnnxCpuBackend(const OnnxCpuBackend&) = delete;
+		OnnxCpuBackend& operator=(const OnnxCpuBackend&) = delete;
+
+		bool load_model(const std::string& path) override;
+		// Serialized ModelProto, e.g. embedded or generated models
+		bool load_model_from_memory(const void* data, size_t size, const std::string& debug_name);
+
+		void bind_input(std::string_view name, const GpuTensor& tensor) override;
+		void bind_output(std::string_view name, const GpuTensor& tensor) override;
+
+		void record_dispatch(graphics::RHI* rhi, graphics::CommandHandle cmd) override;
+
+		const std::string& backend_name() const override { return name; }
+
+		bool is_loaded() const;
+		bool is_busy() const { return in_flight.load(std::memory_order_acquire); }
+		// Blocks (pumping scheduler work) until the run in flight is done, then copies its results out
+		void wait();
+
+		// Synchronous run with the current bindings, for warm-up and benchmarks
+		bool run_now();
+
+		OnnxCpuStats get_stats() const;
+
+		// Model signature, available after load_model
+		struct TensorInfo {
+			std::string name;
+			std::vector<int64_t> shape;  // Dynamic dimensions resolved to 1
+			int32_t element_type = 0;    // ONNXTensorElementDataType
+			size_t byte_size = 0;
+		};
+		const std::vector<TensorInfo>& get_inputs() const { return inputs; }
+		const std::vector<TensorInfo>& get_outputs() const { return outputs; }
+
+		// Backend-owned tensor memory of an unbound input/output (fill inputs before dispatch)
+		void* get_owned_data(std::string_view name);
+
+	private:
+		struct Impl;
+
+		void unload();
+		void bind(std::string_view tensor_name, const GpuTensor& tensor, bool output);
+		bool finish_load(const std::string& debug_name);
+		bool apply_bindings();
+		bool execute();
+		bool prepare_slot(uint32_t slot);
+		void deliver_results();
+
+		bud::threading::TaskScheduler* task_scheduler;
+		OnnxCpuConfig config;
+		std::string name = "ONNX Runtime (CPU)";
+
+		std::unique_ptr<Impl> impl;
+		std::vector<TensorInfo> inputs;
+		std::vector<TensorInfo> outputs;
+
+		std::atomic<bool> in_flight{ false };
+		bud::threading::Counter run_counter;
+	};
+}
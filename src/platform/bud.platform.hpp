@@ -52,5 +52,5 @@ namespace bud::platform {
 	ScreenResolution get_current_screen_resolution();
 	ScreenResolution get_window_screen_resolution(const Window& window);
 
-    std::unique_ptr<Window> create_window(const std::string& title, int width, int height);
+    std::unique_ptr<Window> create_window(const std::string& title, int width, int height, bool visible = true);
 }
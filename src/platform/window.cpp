@@ -27,6 +27,9 @@ namespace bud::platform {
 		case SDLK_R:      return bud::input::Key::R;
 		case SDLK_F3:     return bud::input::Key::F3;
 		case SDLK_F4:     return bud::input::Key::F4;
+		case SDLK_F5:     return bud::input::Key::F5;
+		case SDLK_F6:     return bud::input::Key::F6;
+		case SDLK_F7:     return bud::input::Key::F7;
 
 		default:          return bud::input::Key::Unknown;
 		}
@@ -71,7 +74,7 @@ namespace bud::platform {
 
 	class WindowWin : public Window {
 	public:
-		WindowWin(const std::string& title, int width, int height)
+		WindowWin(const std::string& title, int width, int height, bool visible)
 			: width(width), height(height)
 		{
 			if (!SDL_Init(SDL_INIT_VIDEO | SDL_INIT_EVENTS)) {
@@ -94,7 +97,9 @@ namespace bud::platform {
 				throw std::runtime_error("Failed to create SDL window");
 			}
 
-			SDL_ShowWindow(window);
+			if (visible) {
+				SDL_ShowWindow(window);
+			}
 			update_window_size();
 			bud::print("Created window: {} ({}x{})", title, width, height);
 		}
@@ -268,9 +273,9 @@ namespace bud::platform {
 		return get_display_resolution(display);
 	}
 
-	std::unique_ptr<Window> create_window(const std::string& title, int width, int height) {
+	std::unique_ptr<Window> create_window(const std::string& title, int width, int height, bool visible) {
 #ifdef _WIN32
-		return std::make_unique<WindowWin>(title, width, height);
+		return std::make_unique<WindowWin>(title, width, height, visible);
 #else
 		throw std::runtime_error("Platform not supported");
 #endif
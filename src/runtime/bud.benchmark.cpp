@@ -0,0 +1,750 @@
+#include "src/runtime/bud.benchmark.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#include "src/core/bud.logger.hpp"
+#include "src/runtime/bud.engine.hpp"
+#include "src/runtime/bud.scene.io.hpp"
+
+namespace bud::benchmark {
+
+	namespace {
+		constexpr const char* gpu_timer_names[] = { "MainView", "VisibilityRaster", "MaterialResolve", "LightAssignment", "ZPrepass",
+			"InstanceCulling", "MeshletCulling", "ShadowCulling", "ShadowDraw", "Frame" };
+		static_assert(std::size(gpu_timer_names) == bud::graphics::GPU_TIMER_COUNT, "Name every GPU timer");
+
+		constexpr uint32_t MAX_DRAIN_STEPS = 240;  // Frames to wait for the render task before giving up on the tail
+		constexpr uint32_t COMPARE_SETTLE_STEPS = 8; // Frames in flight plus the shadow cache refresh after a switch
+
+		nlohmann::json stats_to_json(const bud::frame_stats::PhaseStats& stats) {
+			return nlohmann::json{
+				{ "p50_ms", stats.p50_ms },
+				{ "p95_ms", stats.p95_ms },
+				{ "p99_ms", stats.p99_ms },
+				{ "mean_ms", stats.mean_ms },
+				{ "max_ms", stats.max_ms }
+			};
+		}
+
+		bool read_json(const std::string& path, nlohmann::json& out) {
+			std::ifstream in(path);
+			if (!in.is_open()) return false;
+			try {
+				out = nlohmann::json::parse(in);
+			} catch (const std::exception& e) {
+				bud::eprint("[Benchmark] Failed to parse {}: {}", path, e.what());
+				return false;
+			}
+			return true;
+		}
+
+		bool ensure_parent_dir(const std::filesystem::path& file_path) {
+			std::error_code ec;
+			if (file_path.has_parent_path()) {
+				std::filesystem::create_directories(file_path.parent_path(), ec);
+			}
+			return !ec;
+		}
+
+		bool is_bgra(bud::graphics::TextureFormat format) {
+			return format == bud::graphics::TextureFormat::BGRA8_UNORM || format == bud::graphics::TextureFormat::BGRA8_SRGB;
+		}
+
+		// Binary PPM of a 4-byte-per-pixel capture, alpha dropped
+		bool write_ppm(const std::filesystem::path& file_path, const bud::graphics::FrameCapture& capture) {
+			ensure_parent_dir(file_path);
+			std::ofstream out(file_path, std::ios::binary | std::ios::trunc);
+			if (!out.is_open()) return false;
+
+			out << std::format("P6\n{} {}\n255\n", capture.width, capture.height);
+			const bool bgra = is_bgra(capture.format);
+			std::vector<uint8_t> row(static_cast<size_t>(capture.width) * 3);
+			for (uint32_t y = 0; y < capture.height; ++y) {
+				const uint8_t* src = capture.pixels.data() + static_cast<size_t>(y) * capture.width * 4;
+				for (uint32_t x = 0; x < capture.width; ++x) {
+					row[x * 3 + 0] = src[x * 4 + (bgra ? 2 : 0)];
+					row[x * 3 + 1] = src[x * 4 + 1];
+					row[x * 3 + 2] = src[x * 4 + (bgra ? 0 : 2)];
+				}
+				out.write(reinterpret_cast<const char*>(row.data()), static_cast<std::streamsize>(row.size()));
+			}
+			return out.good();
+		}
+	}
+
+	bool CameraPath::load(const std::string& path) {
+		nlohmann::json j;
+		if (!read_json(path, j)) {
+			bud::eprint("[Benchmark] Failed to read camera path: {}", path);
+			return false;
+		}
+
+		keyframes.clear();
+		try {
+			for (const auto& k : j.at("keyframes")) {
+				CameraKeyframe keyframe;
+				k.at("time").get_to(keyframe.time);
+				k.at("position").get_to(keyframe.position);
+				k.at("yaw").get_to(keyframe.yaw);
+				k.at("pitch").get_to(keyframe.pitch);
+				keyframes.push_back(keyframe);
+			}
+		} catch (const std::exception& e) {
+			bud::eprint("[Benchmark] Invalid camera path {}: {}", path, e.what());
+			keyframes.clear();
+			return false;
+		}
+
+		std::stable_sort(keyframes.begin(), keyframes.end(), [](const CameraKeyframe& a, const CameraKeyframe& b) { return a.time < b.time; });
+		return !keyframes.empty();
+	}
+
+	bool CameraPath::save(const std::string& path) const {
+		nlohmann::json j;
+		j["keyframes"] = nlohmann::json::array();
+		for (const auto& keyframe : keyframes) {
+			j["keyframes"].push_back({
+				{ "time", keyframe.time },
+				{ "position", keyframe.position },
+				{ "yaw", keyframe.yaw },
+				{ "pitch", keyframe.pitch }
+			});
+		}
+
+		std::filesystem::path file_path(path);
+		ensure_parent_dir(file_path);
+		std::ofstream out(file_path, std::ios::trunc);
+		if (!out.is_open()) {
+			bud::eprint("[Benchmark] Failed to write camera path: {}", path);
+			return false;
+		}
+		out << j.dump(2);
+		return true;
+	}
+
+	CameraPath CameraPath::make_procedural(const bud::scene::Camera& start, float duration_s, float orbit_radius) {
+		CameraPath path;
+		constexpr float keyframe_interval_s = 0.5f;
+		const uint32_t count = duration_s > 0.0f ? static_cast<uint32_t>(std::ceil(duration_s / keyframe_interval_s)) : 0;
+
+		for (uint32_t i = 0; i <= count; ++i) {
+			float t = count > 0 ? std::min(static_cast<float>(i) * keyframe_interval_s, duration_s) : 0.0f;
+			float u = duration_s > 0.0f ? t / duration_s : 0.0f;
+			float angle = u * 2.0f * 3.14159265f;
+
+			CameraKeyframe keyframe;
+			keyframe.time = t;
+			// Circle through the start position rather than around it
+			keyframe.position = start.position + bud::math::vec3(orbit_radius * (std::cos(angle) - 1.0f), 0.0f, orbit_radius * std::sin(angle));
+			keyframe.yaw = start.yaw + 360.0f * u;
+			keyframe.pitch = std::clamp(start.pitch + 15.0f * std::sin(2.0f * angle), -89.0f, 89.0f);
+			path.add_keyframe(keyframe);
+		}
+		return path;
+	}
+
+	void CameraPath::sample(float time, bud::scene::Camera& camera) const {
+		if (keyframes.empty()) return;
+
+		auto next = std::upper_bound(keyframes.begin(), keyframes.end(), time, [](float t, const CameraKeyframe& k) { return t < k.time; });
+		if (next == keyframes.begin()) {
+			camera.set_pose(next->position, next->yaw, next->pitch);
+			return;
+		}
+		if (next == keyframes.end()) {
+			const auto& last = keyframes.back();
+			camera.set_pose(last.position, last.yaw, last.pitch);
+			return;
+		}
+
+		const auto& a = *(next - 1);
+		const auto& b = *next;
+		float span = b.time - a.time;
+		float f = span > 0.0f ? (time - a.time) / span : 0.0f;
+		camera.set_pose(a.position + (b.position - a.position) * f, a.yaw + (b.yaw - a.yaw) * f, a.pitch + (b.pitch - a.pitch) * f);
+	}
+
+	const char* get_usage() {
+		return
+			"  --benchmark                  Run the scripted camera benchmark and exit\n"
+			"  --scene <file.json>          Scene to load\n"
+			"  --camera-path <file.json>    Recorded camera path (default: procedural sweep)\n"
+			"  --orbit-radius <units>       Procedural path: circle radius through the start position\n"
+			"  --warmup <frames>            Frames played before measuring (default 120)\n"
+			"  --frames <frames>            Measured frames (default 1200)\n"
+			"  --output <dir>               Results directory (default tmp/benchmark)\n"
+			"  --baseline <results.json>    Compare against an earlier run, exit 1 on regression\n"
+			"  --threshold-p50|p95|p99 <%>  Allowed slowdown per percentile (default 10/15/25)\n"
+			"  --min-delta-ms <ms>          Ignore slowdowns below this (default 0.05)\n"
+			"  --threshold-startup <%>      Allowed startup slowdown (default 20, ignoring < 25 ms)\n"
+			"  --headless                   Never show the window\n"
+			"  --software                   Prefer a CPU Vulkan device (lavapipe, SwiftShader)\n"
+			"  --load-timeout <s>           Give up if the scene is not resident by then (default 300)\n"
+			"  --validate-light-clusters    Check the compute light grid against the CPU reference, exit 2 on a difference\n"
+			"  --record-camera-path <file>  Interactive runs: save the flown camera path on exit\n"
+			"  --compare-main-view          Capture forward and visibility buffer frames along the path and\n"
+			"                               compare them, exit 2 on a mismatch (no timing)\n"
+			"  --compare-poses <n>          Poses to compare (default 4)\n"
+			"  --compare-tolerance <0-255>  Per-channel difference still counted as equal (default 8)\n"
+			"  --compare-max-mismatch <%>   Allowed mismatching pixels per pose (default 1)\n";
+	}
+
+	bool parse_args(int argc, char** argv, BenchmarkConfig& out, std::string& error) {
+		for (int i = 1; i < argc; ++i) {
+			std::string a = argv[i];
+			auto next = [&]() -> std::string {
+				if (i + 1 >= argc) throw std::invalid_argument(std::format("Missing value for {}", a));
+				return argv[++i];
+			};
+
+			try {
+				if (a == "--benchmark") { out.enabled = true; }
+				else if (a == "--scene") { out.scene_file = next(); }
+				else if (a == "--camera-path") { out.camera_path_file = next(); }
+				else if (a == "--orbit-radius") { out.orbit_radius = std::stof(next()); }
+				else if (a == "--warmup") { out.warmup_frames = static_cast<uint32_t>(std::stoul(next())); }
+				else if (a == "--frames") { out.frame_count = std::max(1u, static_cast<uint32_t>(std::stoul(next()))); }
+				else if (a == "--output") { out.output_dir = next(); }
+				else if (a == "--baseline") { out.baseline_file = next(); }
+				else if (a == "--threshold-p50") { out.thresholds.p50_percent = std::stof(next()); }
+				else if (a == "--threshold-p95") { out.thresholds.p95_percent = std::stof(next()); }
+				else if (a == "--threshold-p99") { out.thresholds.p99_percent = std::stof(next()); }
+				else if (a == "--min-delta-ms") { out.thresholds.min_delta_ms = std::stof(next()); }
+				else if (a == "--threshold-startup") { out.thresholds.startup_percent = std::stof(next()); }
+				else if (a == "--headless") { out.hidden_window = true; }
+				else if (a == "--software") { out.software_device = true; }
+				else if (a == "--load-timeout") { out.load_timeout_s = std::stof(next()); }
+				else if (a == "--validate-light-clusters") { out.validate_light_clusters = true; }
+				else if (a == "--record-camera-path") { out.record_camera_path = next(); }
+				else if (a == "--compare-main-view") { out.enabled = true; out.compare_main_view = true; }
+				else if (a == "--compare-poses") { out.compare_poses = std::max(1u, static_cast<uint32_t>(std::stoul(next()))); }
+				else if (a == "--compare-tolerance") { out.compare_channel_tolerance = std::min(255u, static_cast<uint32_t>(std::stoul(next()))); }
+				else if (a == "--compare-max-mismatch") { out.compare_max_mismatch_percent = std::stof(next()); }
+				else {
+					error = std::format("Unknown argument: {}", a);
+					return false;
+				}
+			} catch (const std::exception& e) {
+				error = std::format("Invalid value for {}: {}", a, e.what());
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void BenchmarkRunner::update(bud::engine::BudEngine* engine, float delta_time, bool scene_ready) {
+		if (state == State::Done) return;
+
+		if (state == State::WaitingForScene) {
+			if (!scene_ready) {
+				float waited = std::chrono::duration<float>(std::chrono::steady_clock::now() - wait_start).count();
+				if (waited > config.load_timeout_s) {
+					bud::eprint("[Benchmark] Scene not ready after {:.0f} s, aborting", waited);
+					finish(engine, BenchmarkExit_Failed);
+				}
+				return;
+			}
+
+			scene_ready_ms = engine->get_uptime_ms();
+			step_time = delta_time;
+			if (config.validate_light_clusters) {
+				auto render_config = engine->get_renderer()->get_config();
+				render_config.validate_light_clusters = true;
+				engine->get_renderer()->set_config(render_config);
+			}
+			const float duration = static_cast<float>(config.warmup_frames + config.frame_count) * step_time;
+			if (!config.camera_path_file.empty()) {
+				if (!path.load(config.camera_path_file)) {
+					finish(engine, BenchmarkExit_Failed);
+					return;
+				}
+				if (path.get_duration() < duration) {
+					bud::wprint("[Benchmark] Camera path is {:.1f} s, the run needs {:.1f} s; the camera holds the last pose", path.get_duration(), duration);
+				}
+			} else {
+				path = CameraPath::make_procedural(engine->get_scene().main_camera, duration, config.orbit_radius);
+			}
+
+			if (config.compare_main_view) {
+				bud::print("[Benchmark] Scene ready, comparing forward and visibility buffer output at {} poses", config.compare_poses);
+				state = State::Comparing;
+				return;
+			}
+
+			bud::print("[Benchmark] Scene ready, {} warm-up + {} measured frames at {:.3f} ms", config.warmup_frames, config.frame_count, step_time * 1000.0f);
+			state = config.warmup_frames > 0 ? State::Warmup : State::Measuring;
+			if (state == State::Measuring) {
+				first_frame = bud::frame_stats::get_open_frame();
+				last_collected = first_frame - 1;
+				frames.assign(config.frame_count, {});
+			}
+		}
+
+		if (state == State::Comparing) {
+			update_comparison(engine);
+			return;
+		}
+
+		if (state == State::Warmup || state == State::Measuring) {
+			path.sample(sim_time, engine->get_scene().main_camera);
+			sim_time = static_cast<float>(steps + 1) * step_time; // Multiply, don't accumulate: no drift over long runs
+			steps++;
+		}
+
+		if (state == State::Warmup) {
+			if (steps >= config.warmup_frames) {
+				// Measuring starts with the next frame, the first one whose camera step is past the warm-up
+				first_frame = bud::frame_stats::get_open_frame() + 1;
+				last_collected = first_frame - 1;
+				frames.assign(config.frame_count, {});
+				state = State::Measuring;
+			}
+			return;
+		}
+
+		if (state == State::Measuring) {
+			collect(engine, true);
+			if (steps >= config.warmup_frames + config.frame_count) {
+				state = State::Draining;
+			}
+			return;
+		}
+
+		if (state == State::Draining) {
+			collect(engine, false);
+			bool complete = std::all_of(frames.begin(), frames.end(), [](const BenchmarkFrame& f) { return f.has_cpu; });
+			if (complete || ++drain_steps > MAX_DRAIN_STEPS) {
+				finish(engine, BenchmarkExit_Passed);
+			}
+		}
+	}
+
+	void BenchmarkRunner::collect(bud::engine::BudEngine* engine, bool record_gpu) {
+		if (record_gpu) {
+			// GPU timestamps resolve a few frames late, attribute the latest ones to the open frame
+			uint64_t open = bud::frame_stats::get_open_frame();
+			if (open >= first_frame && open - first_frame < frames.size()) {
+				auto stats = engine->get_rhi()->get_stats();
+				auto& frame = frames[open - first_frame];
+				std::copy(std::begin(stats.gpu_timer_ms), std::end(stats.gpu_timer_ms), frame.gpu_ms);
+				frame.occluders = stats.occluder_count;
+				frame.occlusion_culled = stats.occlusion_culled;
+				std::copy(std::begin(stats.vertex_fetch_bytes), std::end(stats.vertex_fetch_bytes), frame.vertex_fetch_bytes);
+				std::copy(std::begin(stats.vertex_fetch_interleaved_bytes), std::end(stats.vertex_fetch_interleaved_bytes), frame.vertex_fetch_interleaved_bytes);
+				frame.instance_upload_bytes = stats.instance_upload_bytes;
+				frame.instance_upload_legacy_bytes = stats.instance_upload_legacy_bytes;
+				frame.instance_memory_bytes = stats.instance_memory_bytes;
+				frame.instance_memory_legacy_bytes = stats.instance_memory_legacy_bytes;
+				std::copy(std::begin(stats.sort_state_changes), std::end(stats.sort_state_changes), frame.sort_state_changes);
+				std::copy(std::begin(stats.sort_state_changes_unsorted), std::end(stats.sort_state_changes_unsorted), frame.sort_state_changes_unsorted);
+			}
+
+			if (config.validate_light_clusters) {
+				auto stats = engine->get_rhi()->get_stats();
+				if (stats.light_cluster_validated) {
+					light_cluster_checks++;
+					light_cluster_max_mismatches = std::max(light_cluster_max_mismatches, stats.light_cluster_mismatches);
+				}
+			}
+		}
+
+		bud::frame_stats::get_samples_after(last_collected, scratch);
+		for (const auto& sample : scratch) {
+			last_collected = std::max(last_collected, sample.frame_index);
+			if (sample.frame_index < first_frame || sample.frame_index - first_frame >= frames.size()) continue;
+			auto& frame = frames[sample.frame_index - first_frame];
+			frame.cpu = sample;
+			frame.has_cpu = true;
+		}
+	}
+
+	void BenchmarkRunner::finish(bud::engine::BudEngine* engine, int code) {
+		if (code != BenchmarkExit_Failed) {
+			const auto output_dir = std::filesystem::path(config.output_dir);
+			const std::string json_path = (output_dir / "benchmark_results.json").string();
+			const std::string csv_path = (output_dir / "benchmark_frames.csv").string();
+
+			if (!write_results(engine->get_rhi()->get_device_name(), engine->get_startup_report(), json_path, csv_path)) {
+				code = BenchmarkExit_Failed;
+			} else {
+				bud::print("[Benchmark] Results written to {} and {}", json_path, csv_path);
+				if (!config.baseline_file.empty()) {
+					code = compare_with_baseline(json_path);
+				}
+			}
+
+			// A grid that was never checked (no lights, CPU assignment) fails too, the run proved nothing
+			if (config.validate_light_clusters) {
+				if (light_cluster_checks == 0) {
+					bud::eprint("[Benchmark] --validate-light-clusters: no compute light grid was checked");
+					code = BenchmarkExit_Failed;
+				} else if (light_cluster_max_mismatches > 0) {
+					bud::eprint("[Benchmark] Compute light grid differs from the CPU reference in up to {} clusters", light_cluster_max_mismatches);
+					code = BenchmarkExit_Failed;
+				} else {
+					bud::print("[Benchmark] Compute light grid matches the CPU reference ({} checks)", light_cluster_checks);
+				}
+			}
+		}
+
+		exit_code = code;
+		state = State::Done;
+		engine->request_exit();
+	}
+
+	bool BenchmarkRunner::write_results(const std::string& device_name, const bud::engine::StartupReport& startup, const std::string& json_path, const std::string& csv_path) const {
+		uint32_t measured = 0;
+		for (const auto& frame : frames) measured += frame.has_cpu ? 1u : 0u;
+		if (measured == 0) {
+			bud::eprint("[Benchmark] No frames were measured");
+			return false;
+		}
+		if (measured < frames.size()) {
+			bud::wprint("[Benchmark] {} of {} frames never reported, excluded from the statistics", frames.size() - measured, frames.size());
+		}
+
+		nlohmann::json results;
+		results["scene"] = config.scene_file;
+		results["device"] = device_name;
+		results["camera_path"] = config.camera_path_file.empty() ? std::string("procedural") : config.camera_path_file;
+		results["warmup_frames"] = config.warmup_frames;
+		results["frames"] = measured;
+		results["step_ms"] = step_time * 1000.0f;
+		// Milliseconds since engine creation; compare runs with and without a mounted shader bundle
+		results["startup"]["time_to_first_frame_ms"] = startup.time_to_first_frame_ms;
+		results["startup"]["pipelines_ready_ms"] = startup.pipelines_ready_ms;
+		results["startup"]["scene_ready_ms"] = scene_ready_ms;
+		results["startup"]["shader_bundle"] = startup.shader_bundle;
+		results["startup"]["jobs"] = nlohmann::json::object();
+		for (const auto& job : startup.jobs) {
+			results["startup"]["jobs"][job.name] = {
+				{ "start_ms", job.start_ms },
+				{ "duration_ms", job.duration_ms() },
+				{ "thread", job.main_thread ? "main" : "worker" }
+			};
+		}
+
+		std::vector<float> values;
+		values.reserve(frames.size());
+		for (uint32_t p = 0; p < bud::frame_stats::PHASE_COUNT; ++p) {
+			values.clear();
+			for (const auto& frame : frames) {
+				if (frame.has_cpu) values.push_back(frame.cpu.phase_ms[p]);
+			}
+			results["cpu"][bud::frame_stats::phase_name(static_cast<bud::frame_stats::FramePhase>(p))] = stats_to_json(bud::frame_stats::compute_phase_stats(values));
+		}
+		for (uint32_t t = 0; t < bud::graphics::GPU_TIMER_COUNT; ++t) {
+			values.clear();
+			for (const auto& frame : frames) {
+				if (frame.has_cpu) values.push_back(frame.gpu_ms[t]);
+			}
+			results["gpu"][gpu_timer_names[t]] = stats_to_json(bud::frame_stats::compute_phase_stats(values));
+		}
+
+		// Occluder selection effectiveness next to the ZPrepass cost above
+		double occluder_sum = 0.0;
+		double culled_sum = 0.0;
+		for (const auto& frame : frames) {
+			if (!frame.has_cpu) continue;
+			occluder_sum += frame.occluders;
+			culled_sum += frame.occlusion_culled;
+		}
+		results["occlusion"]["mean_occluders"] = occluder_sum / measured;
+		results["occlusion"]["mean_culled"] = culled_sum / measured;
+
+		if (config.validate_light_clusters) {
+			results["light_cluster_validation"]["checks"] = light_cluster_checks;
+			results["light_cluster_validation"]["max_mismatched_clusters"] = light_cluster_max_mismatches;
+		}
+
+		// Depth-only vertex fetch per frame: position/attribute streams as drawn vs the former interleaved vertex
+		static constexpr const char* fetch_pass_names[bud::graphics::VERTEX_FETCH_PASS_COUNT] = { "ZPrepass", "ShadowStatic", "Shadow" };
+		for (uint32_t p = 0; p < bud::graphics::VERTEX_FETCH_PASS_COUNT; ++p) {
+			double split_sum = 0.0;
+			double interleaved_sum = 0.0;
+			for (const auto& frame : frames) {
+				if (!frame.has_cpu) continue;
+				split_sum += static_cast<double>(frame.vertex_fetch_bytes[p]);
+				interleaved_sum += static_cast<double>(frame.vertex_fetch_interleaved_bytes[p]);
+			}
+			auto& entry = results["vertex_fetch"][fetch_pass_names[p]];
+			entry["mean_bytes"] = split_sum / measured;
+			entry["mean_interleaved_bytes"] = interleaved_sum / measured;
+			entry["saving_percent"] = interleaved_sum > 0.0 ? 100.0 * (1.0 - split_sum / interleaved_sum) : 0.0;
+		}
+
+		// Instance / draw record upload per frame and the resident buffers, compact records vs the former mat4 layout
+		double upload_sum = 0.0;
+		double upload_legacy_sum = 0.0;
+		uint64_t memory_peak = 0;
+		uint64_t memory_legacy_peak = 0;
+		for (const auto& frame : frames) {
+			if (!frame.has_cpu) continue;
+			upload_sum += static_cast<double>(frame.instance_upload_bytes);
+			upload_legacy_sum += static_cast<double>(frame.instance_upload_legacy_bytes);
+			memory_peak = std::max(memory_peak, frame.instance_memory_bytes);
+			memory_legacy_peak = std::max(memory_legacy_peak, frame.instance_memory_legacy_bytes);
+		}
+		results["instance_upload"]["mean_bytes"] = upload_sum / measured;
+		results["instance_upload"]["mean_legacy_bytes"] = upload_legacy_sum / measured;
+		results["instance_upload"]["saving_percent"] = upload_legacy_sum > 0.0 ? 100.0 * (1.0 - upload_sum / upload_legacy_sum) : 0.0;
+		results["instance_upload"]["peak_memory_bytes"] = memory_peak;
+		results["instance_upload"]["peak_memory_legacy_bytes"] = memory_legacy_peak;
+
+		// State changes per pass with its own sort-key schema, vs the same draws left in culling order
+		static constexpr const char* sort_pass_names[bud::graphics::SORT_KEY_PASS_COUNT] = { "Opaque", "Prepass", "Shadow" };
+		for (uint32_t p = 0; p < bud::graphics::SORT_KEY_PASS_COUNT; ++p) {
+			double sorted_sum = 0.0;
+			double unsorted_sum = 0.0;
+			for (const auto& frame : frames) {
+				if (!frame.has_cpu) continue;
+				sorted_sum += static_cast<double>(frame.sort_state_changes[p]);
+				unsorted_sum += static_cast<double>(frame.sort_state_changes_unsorted[p]);
+			}
+			auto& entry = results["sort_state_changes"][sort_pass_names[p]];
+			entry["mean_sorted"] = sorted_sum / measured;
+			entry["mean_unsorted"] = unsorted_sum / measured;
+			entry["saved_percent"] = unsorted_sum > 0.0 ? 100.0 * (1.0 - sorted_sum / unsorted_sum) : 0.0;
+		}
+
+		std::filesystem::path json_file(json_path);
+		ensure_parent_dir(json_file);
+		std::ofstream json_out(json_file, std::ios::trunc);
+		if (!json_out.is_open()) {
+			bud::eprint("[Benchmark] Failed to write {}", json_path);
+			return false;
+		}
+		json_out << results.dump(2);
+
+		std::ofstream csv_out(csv_path, std::ios::trunc);
+		if (!csv_out.is_open()) {
+			bud::eprint("[Benchmark] Failed to write {}", csv_path);
+			return false;
+		}
+		csv_out << "frame";
+		for (uint32_t p = 0; p < bud::frame_stats::PHASE_COUNT; ++p) csv_out << ",cpu_" << bud::frame_stats::phase_name(static_cast<bud::frame_stats::FramePhase>(p)) << "_ms";
+		for (uint32_t t = 0; t < bud::graphics::GPU_TIMER_COUNT; ++t) csv_out << ",gpu_" << gpu_timer_names[t] << "_ms";
+		csv_out << ",occluders,occlusion_culled";
+		csv_out << '\n';
+		for (uint32_t i = 0; i < frames.size(); ++i) {
+			const auto& frame = frames[i];
+			if (!frame.has_cpu) continue;
+			csv_out << i;
+			for (uint32_t p = 0; p < bud::frame_stats::PHASE_COUNT; ++p) csv_out << std::format(",{:.3f}", frame.cpu.phase_ms[p]);
+			for (uint32_t t = 0; t < bud::graphics::GPU_TIMER_COUNT; ++t) csv_out << std::format(",{:.3f}", frame.gpu_ms[t]);
+			csv_out << std::format(",{},{}", frame.occluders, frame.occlusion_culled);
+			csv_out << '\n';
+		}
+		return true;
+	}
+
+	int BenchmarkRunner::compare_with_baseline(const std::string& results_path) const {
+		nlohmann::json baseline;
+		nlohmann::json current;
+		if (!read_json(config.baseline_file, baseline)) {
+			bud::eprint("[Benchmark] Failed to read baseline: {}", config.baseline_file);
+			return BenchmarkExit_Failed;
+		}
+		if (!read_json(results_path, current)) {
+			return BenchmarkExit_Failed;
+		}
+
+		if (baseline.value("scene", std::string()) != current.value("scene", std::string())
+			|| baseline.value("device", std::string()) != current.value("device", std::string())) {
+			bud::wprint("[Benchmark] Baseline was recorded on {} / {}, this run is {} / {}",
+				baseline.value("scene", std::string("?")), baseline.value("device", std::string("?")),
+				current.value("scene", std::string("?")), current.value("device", std::string("?")));
+		}
+
+		const std::pair<const char*, float> percentiles[] = {
+			{ "p50_ms", config.thresholds.p50_percent },
+			{ "p95_ms", config.thresholds.p95_percent },
+			{ "p99_ms", config.thresholds.p99_percent }
+		};
+
+		uint32_t regressions = 0;
+		for (const char* section : { "cpu", "gpu" }) {
+			if (!baseline.contains(section) || !current.contains(section)) continue;
+
+			for (const auto& [name, base_stats] : baseline[section].items()) {
+				if (!current[section].contains(name)) continue;
+				const auto& cur_stats = current[section][name];
+
+				for (const auto& [key, threshold] : percentiles) {
+					float base = base_stats.value(key, 0.0f);
+					float cur = cur_stats.value(key, 0.0f);
+					if (base <= 0.0f) continue;
+
+					float delta = cur - base;
+					float percent = delta / base * 100.0f;
+					if (delta > config.thresholds.min_delta_ms && percent > threshold) {
+						regressions++;
+						bud::eprint("[Benchmark] REGRESSION {}.{} {}: {:.3f} -> {:.3f} ms ({:+.1f}%, limit {:.1f}%)", section, name, key, base, cur, percent, threshold);
+					} else {
+						bud::print("[Benchmark] {}.{} {}: {:.3f} -> {:.3f} ms ({:+.1f}%)", section, name, key, base, cur, percent);
+					}
+				}
+			}
+		}
+
+		// Startup milestones; per-job durations stay informational, the overlap makes them move around
+		if (baseline.contains("startup") && current.contains("startup")) {
+			for (const char* key : { "time_to_first_frame_ms", "pipelines_ready_ms", "scene_ready_ms" }) {
+				double base = baseline["startup"].value(key, 0.0);
+				double cur = current["startup"].value(key, 0.0);
+				if (base <= 0.0 || cur <= 0.0) continue;
+
+				double delta = cur - base;
+				double percent = delta / base * 100.0;
+				if (delta > config.thresholds.min_startup_delta_ms && percent > config.thresholds.startup_percent) {
+					regressions++;
+					bud::eprint("[Benchmark] REGRESSION startup.{}: {:.1f} -> {:.1f} ms ({:+.1f}%, limit {:.1f}%)", key, base, cur, percent, config.thresholds.startup_percent);
+				} else {
+					bud::print("[Benchmark] startup.{}: {:.1f} -> {:.1f} ms ({:+.1f}%)", key, base, cur, percent);
+				}
+			}
+			if (baseline["startup"].value("shader_bundle", false) != current["startup"].value("shader_bundle", false)) {
+				bud::wprint("[Benchmark] Shader bundle use differs from the baseline, startup times are not comparable");
+			}
+		}
+
+		if (regressions > 0) {
+			bud::eprint("[Benchmark] {} regression(s) against {}", regressions, config.baseline_file);
+			return BenchmarkExit_Regressed;
+		}
+		bud::print("[Benchmark] No regressions against {}", config.baseline_file);
+		return BenchmarkExit_Passed;
+	}
+
+	void BenchmarkRunner::update_comparison(bud::engine::BudEngine* engine) {
+		auto* renderer = engine->get_renderer();
+		if (compare_step == 0) {
+			if (compare_pose >= config.compare_poses) {
+				finish_comparison(engine);
+				return;
+			}
+
+			// Same pose for both halves; dynamic resolution off so both render at the output size
+			const float time = path.get_duration() * (static_cast<float>(compare_pose) + 0.5f) / static_cast<float>(config.compare_poses);
+			path.sample(time, engine->get_scene().main_camera);
+			auto render_config = renderer->get_config();
+			render_config.enable_visibility_buffer = compare_visibility;
+			render_config.enable_dynamic_resolution = false;
+			renderer->set_config(render_config);
+		}
+
+		compare_step++;
+		if (compare_step < COMPARE_SETTLE_STEPS) return;
+		if (compare_step == COMPARE_SETTLE_STEPS) {
+			renderer->request_capture();
+			return;
+		}
+
+		bud::graphics::FrameCapture capture;
+		if (!renderer->take_capture(capture)) {
+			if (compare_step > COMPARE_SETTLE_STEPS + MAX_DRAIN_STEPS) {
+				bud::eprint("[Benchmark] Frame capture of pose {} never arrived", compare_pose);
+				finish(engine, BenchmarkExit_Failed);
+			}
+			return;
+		}
+
+		compare_step = 0;
+		if (!compare_visibility) {
+			forward_capture = std::move(capture);
+			compare_visibility = true;
+			return;
+		}
+
+		compare_captures(forward_capture, capture);
+		compare_visibility = false;
+		compare_pose++;
+	}
+
+	void BenchmarkRunner::compare_captures(const bud::graphics::FrameCapture& forward, const bud::graphics::FrameCapture& visibility) {
+		PoseComparison result;
+		result.pose = compare_pose;
+		result.visibility_ran = visibility.main_view_path == 1 && forward.main_view_path == 0;
+		result.size_match = forward.width == visibility.width && forward.height == visibility.height
+			&& forward.format == visibility.format && forward.pixels.size() == visibility.pixels.size();
+
+		if (result.size_match) {
+			// Color channels only, the swapchain alpha is undefined after composition
+			const size_t pixel_count = forward.pixels.size() / 4;
+			uint64_t mismatched = 0;
+			uint64_t diff_sum = 0;
+			for (size_t i = 0; i < pixel_count; ++i) {
+				uint32_t pixel_max = 0;
+				for (size_t c = 0; c < 3; ++c) {
+					const uint32_t d = static_cast<uint32_t>(std::abs(static_cast<int>(forward.pixels[i * 4 + c]) - static_cast<int>(visibility.pixels[i * 4 + c])));
+					pixel_max = std::max(pixel_max, d);
+					diff_sum += d;
+				}
+				result.max_abs_diff = std::max(result.max_abs_diff, pixel_max);
+				mismatched += pixel_max > config.compare_channel_tolerance ? 1u : 0u;
+			}
+			if (pixel_count > 0) {
+				result.mismatch_percent = 100.0 * static_cast<double>(mismatched) / static_cast<double>(pixel_count);
+				result.mean_abs_diff = static_cast<double>(diff_sum) / static_cast<double>(pixel_count * 3);
+			}
+		}
+
+		const auto output_dir = std::filesystem::path(config.output_dir);
+		write_ppm(output_dir / std::format("compare_pose{}_forward.ppm", compare_pose), forward);
+		write_ppm(output_dir / std::format("compare_pose{}_visibility.ppm", compare_pose), visibility);
+
+		bud::print("[Benchmark] Pose {}: {:.3f}% pixels differ (mean {:.2f}, max {}){}", compare_pose, result.mismatch_percent, result.mean_abs_diff, result.max_abs_diff,
+			result.visibility_ran ? "" : ", visibility buffer path did not run");
+		comparisons.push_back(result);
+	}
+
+	void BenchmarkRunner::finish_comparison(bud::engine::BudEngine* engine) {
+		uint32_t failures = 0;
+		nlohmann::json results;
+		results["scene"] = config.scene_file;
+		results["device"] = engine->get_rhi()->get_device_name();
+		results["channel_tolerance"] = config.compare_channel_tolerance;
+		results["max_mismatch_percent"] = config.compare_max_mismatch_percent;
+		results["poses"] = nlohmann::json::array();
+		for (const auto& c : comparisons) {
+			const bool passed = c.visibility_ran && c.size_match && c.mismatch_percent <= config.compare_max_mismatch_percent;
+			failures += passed ? 0u : 1u;
+			results["poses"].push_back({
+				{ "pose", c.pose },
+				{ "visibility_ran", c.visibility_ran },
+				{ "size_match", c.size_match },
+				{ "mismatch_percent", c.mismatch_percent },
+				{ "mean_abs_diff", c.mean_abs_diff },
+				{ "max_abs_diff", c.max_abs_diff },
+				{ "passed", passed }
+			});
+		}
+
+		const std::filesystem::path json_file = std::filesystem::path(config.output_dir) / "main_view_comparison.json";
+		ensure_parent_dir(json_file);
+		std::ofstream json_out(json_file, std::ios::trunc);
+		if (!json_out.is_open()) {
+			bud::eprint("[Benchmark] Failed to write {}", json_file.string());
+			finish(engine, BenchmarkExit_Failed);
+			return;
+		}
+		json_out << results.dump(2);
+
+		if (failures > 0 || comparisons.empty()) {
+			bud::eprint("[Benchmark] Forward and visibility buffer output differ at {} of {} poses", failures, comparisons.size());
+			finish(engine, BenchmarkExit_Failed);
+			return;
+		}
+		bud::print("[Benchmark] Forward and visibility buffer output match at {} poses, written to {}", comparisons.size(), json_file.string());
+		exit_code = BenchmarkExit_Passed;
+		state = State::Done;
+		engine->request_exit();
+	}
+}
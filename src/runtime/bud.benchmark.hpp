@@ -0,0 +1,171 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "src/core/bud.math.hpp"
+#include "src/core/bud.frame.stats.hpp"
+#include "src/graphics/bud.graphics.types.hpp"
+#include "src/graphics/bud.graphics.renderer.hpp"
+#include "src/runtime/bud.scene.hpp"
+#include "src/runtime/bud.startup.hpp"
+
+namespace bud::engine {
+	class BudEngine;
+}
+
+namespace bud::benchmark {
+
+	struct CameraKeyframe {
+		float time = 0.0f;  // Simulation seconds since the path started
+		bud::math::vec3 position = { 0.0f, 0.0f, 0.0f };
+		float yaw = -90.0f;
+		float pitch = 0.0f;
+	};
+
+	// Keyframed camera sampled by simulation time, so playback doesn't depend on frame rate
+	class CameraPath {
+	public:
+		bool load(const std::string& path);
+		bool save(const std::string& path) const;
+
+		// One yaw turn over duration_s with a slow pitch wave, optionally circling the start
+		// position. Stays inside whatever the scene camera starts in.
+		static CameraPath make_procedural(const bud::scene::Camera& start, float duration_s, float orbit_radius);
+
+		void add_keyframe(const CameraKeyframe& keyframe) { keyframes.push_back(keyframe); }
+		void sample(float time, bud::scene::Camera& camera) const;
+
+		float get_duration() const { return keyframes.empty() ? 0.0f : keyframes.back().time; }
+		bool empty() const { return keyframes.empty(); }
+
+	private:
+		std::vector<CameraKeyframe> keyframes;
+	};
+
+	struct RegressionThresholds {
+		float p50_percent = 10.0f;
+		float p95_percent = 15.0f;
+		float p99_percent = 25.0f;
+		float min_delta_ms = 0.05f;  // Below this a slowdown is timer noise on fast phases
+		float startup_percent = 20.0f;      // time to first frame, pipelines and scene ready
+		float min_startup_delta_ms = 25.0f; // Startup varies with disk cache and driver state
+	};
+
+	struct BenchmarkConfig {
+		bool enabled = false;
+		std::string scene_file;
+		std::string camera_path_file;     // Empty: procedural path
+		float orbit_radius = 0.0f;
+		uint32_t warmup_frames = 120;
+		uint32_t frame_count = 1200;
+		std::string output_dir = "tmp/benchmark";
+		std::string baseline_file;        // Results JSON of an earlier run, empty = no comparison
+		RegressionThresholds thresholds;
+		bool hidden_window = false;
+		bool software_device = false;
+		float load_timeout_s = 300.0f;
+		bool validate_light_clusters = false; // Compute light grid vs CPU reference every frame, exit 2 on a difference
+
+		// Forward vs visibility buffer image comparison at poses along the camera path, instead of timing
+		bool compare_main_view = false;
+		uint32_t compare_poses = 4;
+		uint32_t compare_channel_tolerance = 8;    // Per 8-bit channel, larger differences count as a mismatch
+		float compare_max_mismatch_percent = 1.0f; // Of the pixels, per pose
+
+		std::string record_camera_path;   // Interactive runs: write the user's camera path here on exit
+	};
+
+	enum BenchmarkExitCode : int {
+		BenchmarkExit_Passed = 0,
+		BenchmarkExit_Regressed = 1,
+		BenchmarkExit_Failed = 2
+	};
+
+	// --benchmark and its options. Returns false with error set on bad input.
+	bool parse_args(int argc, char** argv, BenchmarkConfig& out, std::string& error);
+	const char* get_usage();
+
+	struct BenchmarkFrame {
+		bud::frame_stats::FrameSample cpu;
+		float gpu_ms[bud::graphics::GPU_TIMER_COUNT] = {};
+		uint32_t occluders = 0;          // Z-prepass draws picked by the occluder selection
+		uint32_t occlusion_culled = 0;   // Hi-Z culled instances
+		uint64_t vertex_fetch_bytes[bud::graphics::VERTEX_FETCH_PASS_COUNT] = {};              // Depth passes, split streams
+		uint64_t vertex_fetch_interleaved_bytes[bud::graphics::VERTEX_FETCH_PASS_COUNT] = {};  // Same draws, 48-byte vertex
+		uint64_t instance_upload_bytes = 0;         // GlobalInstanceData + draw records
+		uint64_t instance_upload_legacy_bytes = 0;  // Same draws, mat4 instance and 64-byte draw records
+		uint64_t instance_memory_bytes = 0;
+		uint64_t instance_memory_legacy_bytes = 0;
+		uint32_t sort_state_changes[bud::graphics::SORT_KEY_PASS_COUNT] = {};           // Pipeline/material/mesh switches after sorting
+		uint32_t sort_state_changes_unsorted[bud::graphics::SORT_KEY_PASS_COUNT] = {};  // Same draws in culling order
+		bool has_cpu = false;
+	};
+
+	// Drives the camera from the game update at fixed steps, collects per-frame CPU phase and
+	// GPU pass timings, writes them out and compares against a baseline when done.
+	class BenchmarkRunner {
+	public:
+		explicit BenchmarkRunner(const BenchmarkConfig& config) : config(config) {}
+
+		// Once per logic step. scene_ready gates the warm-up until all assets are resident.
+		void update(bud::engine::BudEngine* engine, float delta_time, bool scene_ready);
+
+		bool is_finished() const { return state == State::Done; }
+		int get_exit_code() const { return exit_code; }
+
+	private:
+		enum class State {
+			WaitingForScene,
+			Warmup,
+			Measuring,
+			Draining,  // Camera path done, waiting for the render task to report the last frames
+			Comparing, // --compare-main-view: one forward and one visibility buffer capture per pose
+			Done
+		};
+
+		void collect(bud::engine::BudEngine* engine, bool record_gpu);
+		void finish(bud::engine::BudEngine* engine, int code);
+		bool write_results(const std::string& device_name, const bud::engine::StartupReport& startup, const std::string& json_path, const std::string& csv_path) const;
+		int compare_with_baseline(const std::string& results_path) const;
+		void update_comparison(bud::engine::BudEngine* engine);
+		void compare_captures(const bud::graphics::FrameCapture& forward, const bud::graphics::FrameCapture& visibility);
+		void finish_comparison(bud::engine::BudEngine* engine);
+
+		struct PoseComparison {
+			uint32_t pose = 0;
+			bool visibility_ran = false;  // The visibility capture really took the visibility path
+			bool size_match = false;
+			double mismatch_percent = 0.0;
+			double mean_abs_diff = 0.0;   // Per channel, 0..255
+			uint32_t max_abs_diff = 0;
+		};
+
+		BenchmarkConfig config;
+		State state = State::WaitingForScene;
+		int exit_code = BenchmarkExit_Failed;
+
+		CameraPath path;
+		float sim_time = 0.0f;
+		float step_time = 0.0f;
+		uint32_t steps = 0;
+		uint32_t drain_steps = 0;
+		std::chrono::steady_clock::time_point wait_start = std::chrono::steady_clock::now();
+		double scene_ready_ms = 0.0;  // Engine uptime when every scene asset was resident
+
+		uint64_t first_frame = 0;  // frame_stats index of the first measured frame
+		uint64_t last_collected = 0;
+		std::vector<BenchmarkFrame> frames;
+		std::vector<bud::frame_stats::FrameSample> scratch;
+		uint32_t light_cluster_checks = 0;
+		uint32_t light_cluster_max_mismatches = 0;
+
+		uint32_t compare_pose = 0;
+		uint32_t compare_step = 0;        // Steps since the pose / path switch
+		bool compare_visibility = false;  // Capturing the visibility buffer half of the pose
+		bud::graphics::FrameCapture forward_capture;
+		std::vector<PoseComparison> comparisons;
+	};
+}
@@ -3,18 +3,16 @@
 #include <thread>
 #include <chrono>
 #include <cmath>
+#include <algorithm>
 #include <print>
 
-#ifdef TRACY_ENABLE
-#include <tracy/Tracy.hpp>
-#else
-#define ZoneScoped
-#define FrameMark
-#endif
+#include "src/core/bud.profiler.hpp"
+#include "src/core/bud.frame.stats.hpp"
 
 #include "src/io/bud.io.hpp"
 #include "src/core/bud.asset.types.hpp"
 #include "src/ui/bud.stats.ui.hpp"
+#include "src/ui/bud.profiler.ui.hpp"
 #include "src/core/bud.logger.hpp"
 #include "src/platform/crash_handler.hpp"
 
@@ -27,7 +25,8 @@
 
 namespace bud::engine {
 
-	BudEngine::BudEngine(const bud::graphics::EngineConfig config) : engine_config(config) {
+	BudEngine::BudEngine(const bud::graphics::EngineConfig config, StartupHook add_startup_jobs) : engine_config(config) {
+		startup_origin = std::chrono::steady_clock::now();
 
 		// Initialize VirtualFileSystem as early as possible and anchor root path
 		virtual_file_system = std::make_unique<bud::io::VirtualFileSystem>();
@@ -36,51 +35,83 @@ namespace bud::engine {
 
 		bud::platform::install_crash_handler();
 
-		window = bud::platform::create_window(engine_config.name, engine_config.width, engine_config.height);
-
+		// The startup jobs below run on it
 		task_scheduler = std::make_unique<bud::threading::TaskScheduler>();
 
+		// 启动图: 依赖满足即执行, worker 任务与主线程任务并行
+		StartupGraph startup(task_scheduler.get(), startup_origin);
 
+		startup.add("Window", {}, StartupThread::Main, [this]() {
+			window = bud::platform::create_window(engine_config.name, engine_config.width, engine_config.height, !engine_config.hidden_window);
 
-		int initial_width = 0;
-		int initial_height = 0;
-		window->get_size(initial_width, initial_height);
-		last_width = initial_width;
-		last_height = initial_height;
-
-		asset_manager = std::make_unique<bud::io::AssetManager>(virtual_file_system.get(), task_scheduler.get());
+			int initial_width = 0;
+			int initial_height = 0;
+			window->get_size(initial_width, initial_height);
+			last_width = initial_width;
+			last_height = initial_height;
+		});
 
-		// TaskScheduler already injected via logger constructor above.
+		// Shader bundle read overlaps window and device creation
+		startup.add("AssetManager", {}, StartupThread::Worker, [this]() {
+			asset_manager = std::make_unique<bud::io::AssetManager>(virtual_file_system.get(), task_scheduler.get());
+			if (!engine_config.shader_bundle.empty())
+				asset_manager->mount_shader_bundle(engine_config.shader_bundle);
+		});
 
-		rhi = bud::graphics::create_rhi(engine_config.backend);
+		startup.add("RHI", { "Window" }, StartupThread::Main, [this]() {
+			rhi = bud::graphics::create_rhi(engine_config.backend);
+			rhi->set_device_preference(engine_config.device_preference);
 
-		auto enable_validation = engine_config.enable_validation;
+			auto enable_validation = engine_config.enable_validation;
 #if not defined(BUD_BUILD_DEBUG)
-		enable_validation = false;
+			enable_validation = false;
 #endif
-		rhi->init(window.get(), task_scheduler.get(), enable_validation, engine_config.inflight_frame_count);
+			rhi->init(window.get(), task_scheduler.get(), enable_validation, engine_config.inflight_frame_count);
+		});
+
+		startup.add("ImGui", { "Window" }, StartupThread::Main, [this]() {
+			IMGUI_CHECKVERSION();
+			ImGui::CreateContext();
+			ImGuiIO& imgui_io = ImGui::GetIO();
+
+			auto resolved_imgui_path = virtual_file_system->resolve_path("src/ui/config/imgui.ini");
+			if (resolved_imgui_path) {
+				imgui_ini_path = resolved_imgui_path->string();
+				imgui_io.IniFilename = imgui_ini_path.c_str();
+			} else {
+				imgui_io.IniFilename = nullptr; // Don't save if path is invalid
+			}
 
-		IMGUI_CHECKVERSION();
-		ImGui::CreateContext();
-		ImGuiIO& imgui_io = ImGui::GetIO();
-		
-		auto resolved_imgui_path = virtual_file_system->resolve_path("src/ui/config/imgui.ini");
-		if (resolved_imgui_path) {
-			imgui_ini_path = resolved_imgui_path->string();
-			imgui_io.IniFilename = imgui_ini_path.c_str();
-		} else {
-			imgui_io.IniFilename = nullptr; // Don't save if path is invalid
-		}
+			imgui_io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;
+			ImGui::StyleColorsDark();
+			ImGui_ImplSDL3_InitForOther(window->get_sdl_window());
+		});
+
+		// Passes start their shader loads here, pipelines are built in the background until run()
+		startup.add("Renderer", { "RHI", "AssetManager", "ImGui" }, StartupThread::Main, [this]() {
+			renderer = std::make_unique<bud::graphics::Renderer>(rhi.get(), asset_manager.get(), task_scheduler.get());
+		});
 
-		imgui_io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;
-		ImGui::StyleColorsDark();
-		ImGui_ImplSDL3_InitForOther(window->get_sdl_window());
+		if (add_startup_jobs)
+			add_startup_jobs(startup, *this);
 
-		renderer = std::make_unique<bud::graphics::Renderer>(rhi.get(), asset_manager.get(), task_scheduler.get());
+		startup.run();
+		startup_report.jobs = startup.get_timeline();
+		startup.print_timeline();
 
 		render_scenes.resize(engine_config.inflight_frame_count);
 	}
 
+	StartupReport BudEngine::get_startup_report() const {
+		StartupReport report = startup_report;
+		report.time_to_first_frame_ms = time_to_first_frame_ms.load(std::memory_order_acquire);
+		return report;
+	}
+
+	double BudEngine::get_uptime_ms() const {
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startup_origin).count();
+	}
+
 	BudEngine::~BudEngine() {
 		asset_manager.reset();
 		renderer.reset();
@@ -98,20 +129,33 @@ namespace bud::engine {
 		// Initialize the main thread as a worker
 		task_scheduler->init_main_thread_worker();
 
+		// Pipelines are created while the RHI and passes initialize, the first frame needs all of them
+		asset_manager->wait_for_shader_loads();
+		startup_report.pipelines_ready_ms = get_uptime_ms();
+		startup_report.shader_bundle = asset_manager->has_shader_bundle();
+		bud::print("[Startup] Shader pipelines ready after {:.1f} ms ({})", startup_report.pipelines_ready_ms,
+			startup_report.shader_bundle ? "shader bundle" : "individual SPIR-V files");
+
 		const double fixed_dt = renderer->get_config().fixed_logic_timestep;
 
 		using Clock = std::chrono::high_resolution_clock;
 		auto last_time = Clock::now();
 
-		while (!window->should_close()) {
+		while (!window->should_close() && !exit_requested.load(std::memory_order_acquire)) {
 			task_scheduler->pump_main_thread_tasks();
 			handle_events();
 
+			bud::frame_stats::begin_frame();
+
 
 			auto now = Clock::now();
 			double frame_time = std::chrono::duration<double>(now - last_time).count();
 			last_time = now;
 
+			// Deterministic runs: simulation and camera advance by the same step every frame
+			if (engine_config.fixed_frame_time > 0.0)
+				frame_time = engine_config.fixed_frame_time;
+
 			// 防止螺旋死亡
 			if (frame_time > 0.25)
 				frame_time = 0.25;
@@ -122,8 +166,10 @@ namespace bud::engine {
 			bool logic_updated = false;
 			while (accumulator >= fixed_dt) {
 				if (perform_game_logic) {
+					bud::frame_stats::ScopedPhase logic_phase(bud::frame_stats::FramePhase::Logic);
 					bud::threading::Counter logic_counter;
 					task_scheduler->spawn("GameLogic", [&]() {
+						ZoneScopedN("GameLogic");
 						perform_game_logic((float)fixed_dt);
 					}, &logic_counter);
 					task_scheduler->wait_for_counter(logic_counter);
@@ -140,7 +186,10 @@ namespace bud::engine {
 				}
 
 				current_write_index = next_write_index;
-				prepare_render_scene(current_write_index);
+				{
+					bud::frame_stats::ScopedPhase extraction_phase(bud::frame_stats::FramePhase::Extraction);
+					prepare_render_scene(current_write_index);
+				}
 				last_committed_index.store(current_write_index, std::memory_order_release);
 			}
 
@@ -150,11 +199,19 @@ namespace bud::engine {
 			perform_rendering((float)frame_time, render_idx);
 
 			FrameMark;
+			bud::profiler::end_frame();
+			bud::frame_stats::update();
 		}
 
 		// 等待所有渲染任务完成
 		task_scheduler->wait_for_counter(render_task_counter);
 		rhi->wait_idle();
+
+		bud::frame_stats::update();
+		auto frame_stats_settings = bud::frame_stats::get_settings();
+		if (!frame_stats_settings.summary_path.empty()) {
+			bud::frame_stats::write_summary(frame_stats_settings.summary_path);
+		}
 	}
 
 	void BudEngine::handle_events() {
@@ -170,12 +227,50 @@ namespace bud::engine {
 		static bool was_f4_down = false;
 		bool is_f4_down = bud::input::Input::get().is_key_down(bud::input::Key::F4);
 		if (is_f4_down && !was_f4_down) {
+			// Off -> meshlet clusters -> lights per cluster -> off
 			auto config = renderer->get_config();
-			config.enable_cluster_visualization = !config.enable_cluster_visualization;
+			if (!config.enable_cluster_visualization) {
+				config.enable_cluster_visualization = true;
+				config.debug_light_clusters = false;
+			} else if (!config.debug_light_clusters) {
+				config.debug_light_clusters = true;
+			} else {
+				config.enable_cluster_visualization = false;
+				config.debug_light_clusters = false;
+			}
 			renderer->set_config(config);
 		}
 		was_f4_down = is_f4_down;
 
+		static bool was_f5_down = false;
+		bool is_f5_down = bud::input::Input::get().is_key_down(bud::input::Key::F5);
+		if (is_f5_down && !was_f5_down) {
+			auto config = renderer->get_config();
+			config.enable_visibility_buffer = !config.enable_visibility_buffer;
+			renderer->set_config(config);
+		}
+		was_f5_down = is_f5_down;
+
+		static bool was_f6_down = false;
+		bool is_f6_down = bud::input::Input::get().is_key_down(bud::input::Key::F6);
+		if (is_f6_down && !was_f6_down) {
+			auto config = renderer->get_config();
+			config.enable_dynamic_resolution = !config.enable_dynamic_resolution;
+			renderer->set_config(config);
+		}
+		was_f6_down = is_f6_down;
+
+		static bool was_f7_down = false;
+		bool is_f7_down = bud::input::Input::get().is_key_down(bud::input::Key::F7);
+		if (is_f7_down && !was_f7_down) {
+			// Opening the window starts capturing, closing it leaves capture as set in the window
+			show_profiler = !show_profiler;
+			if (show_profiler) {
+				bud::profiler::set_enabled(true);
+			}
+		}
+		was_f7_down = is_f7_down;
+
 		int width = 0;
 		int height = 0;
 		window->get_size_in_pixels(width, height);
@@ -196,11 +291,29 @@ namespace bud::engine {
 		auto& logic_entities = scene.entities;
 		auto submesh_bounds_all = renderer->get_submesh_bounds_snapshot();
 
-		// Calculate total submesh count for capacity reservation
+		// Regions far enough away draw their proxy instead of the member submeshes
+		const bool use_hlod = hlod && renderer->get_config().enable_hlod;
+		bud::graphics::HLODStats hlod_stats;
+		if (use_hlod) {
+			hlod->select(scene.main_camera.position, renderer->get_config().hlod_distance_scale, hlod_active, hlod_stats);
+		}
+
+		// Calculate total submesh count for capacity reservation. An entity partly replaced by a proxy is
+		// split into its visible submeshes, so HLOD entities count with their submesh count, plus the proxies.
 		size_t total_submesh_count = logic_entities.size();
+		if (use_hlod) {
+			total_submesh_count += hlod->get_regions().size();
+			const size_t hlod_entities = std::min(hlod->entity_count(), logic_entities.size());
+			for (size_t i = 0; i < hlod_entities; ++i) {
+				const uint32_t mesh = logic_entities[i].mesh_index;
+				if (mesh < submesh_bounds_all.size() && !hlod->get_members(static_cast<uint32_t>(i)).empty())
+					total_submesh_count += submesh_bounds_all[mesh].size();
+			}
+		}
 
 		constexpr size_t buffering_size = 256;
 		render_scene.reset(total_submesh_count + buffering_size);
+		render_scene.hlod_stats = hlod_stats;
 
 		auto mesh_bounds = renderer->get_mesh_bounds_snapshot();
 
@@ -225,6 +338,27 @@ namespace bud::engine {
 						continue; 
 
 					const auto& world_matrix = entity.transform;
+
+					if (use_hlod) {
+						auto members = hlod->get_members(static_cast<uint32_t>(i));
+						size_t hidden = 0;
+						for (const auto& member : members) hidden += hlod_active[member.region];
+
+						if (hidden > 0 && entity.mesh_index < submesh_bounds_all.size()) {
+							const auto& submesh_bounds = submesh_bounds_all[entity.mesh_index];
+							if (hidden >= submesh_bounds.size()) continue; // Whole entity inside active proxies
+
+							// Members are sorted by submesh, walk both in step
+							size_t m = 0;
+							for (uint32_t s = 0; s < submesh_bounds.size(); ++s) {
+								while (m < members.size() && members[m].submesh < s) ++m;
+								if (m < members.size() && members[m].submesh == s && hlod_active[members[m].region]) continue;
+								render_scene.add_instance(world_matrix, submesh_bounds[s].transform(world_matrix), entity.mesh_index, s, entity.material_index, entity.is_static);
+							}
+							continue;
+						}
+					}
+
 					const auto& local_aabb = mesh_bounds[entity.mesh_index];
 					auto world_aabb = local_aabb.transform(world_matrix);
 
@@ -243,6 +377,45 @@ namespace bud::engine {
 
 		task_scheduler->wait_for_counter(extract_scene_counter);
 
+		if (use_hlod) {
+			const auto& regions = hlod->get_regions();
+			for (size_t r = 0; r < regions.size(); ++r) {
+				if (!hlod_active[r] || regions[r].proxy_mesh >= mesh_bounds.size()) continue;
+				// Proxies are baked in world space
+				render_scene.add_instance(bud::math::mat4(1.0f), regions[r].bounds, regions[r].proxy_mesh, bud::asset::INVALID_INDEX, regions[r].proxy_material, true);
+			}
+		}
+
+		// Local lights are few compared to entities, copied on the calling thread
+		const size_t light_count = std::min(scene.point_lights.size() + scene.spot_lights.size(), (size_t)bud::graphics::MAX_LOCAL_LIGHTS);
+		render_scene.local_lights.reserve(light_count);
+		for (const auto& light : scene.point_lights) {
+			if (render_scene.local_lights.size() >= light_count) break;
+			bud::graphics::GPULocalLight& out = render_scene.local_lights.emplace_back();
+			out.position = light.position;
+			out.range = light.range;
+			out.color = light.color;
+			out.intensity = light.intensity;
+			out.direction = bud::math::vec3(0.0f, -1.0f, 0.0f);
+			out.spot_cos_outer = -1.0f;
+			out.spot_cos_inner = -1.0f;
+			out.type = static_cast<uint32_t>(bud::graphics::LocalLightType::Point);
+		}
+		for (const auto& light : scene.spot_lights) {
+			if (render_scene.local_lights.size() >= light_count) break;
+			bud::graphics::GPULocalLight& out = render_scene.local_lights.emplace_back();
+			out.position = light.position;
+			out.range = light.range;
+			out.color = light.color;
+			out.intensity = light.intensity;
+			out.direction = bud::math::normalize(light.direction);
+			float outer = std::clamp(light.outer_angle, 0.5f, 89.0f);
+			float inner = std::clamp(light.inner_angle, 0.0f, outer * 0.95f); // Keep a non-empty falloff band for smoothstep
+			out.spot_cos_outer = std::cos(bud::math::radians(outer));
+			out.spot_cos_inner = std::cos(bud::math::radians(inner));
+			out.type = static_cast<uint32_t>(bud::graphics::LocalLightType::Spot);
+		}
+
 		FrameMark;
 	}
 
@@ -256,6 +429,8 @@ namespace bud::engine {
 	}
 
 	void BudEngine::perform_rendering(float delta_time, uint32_t render_scene_index) {
+		ZoneScoped;
+
 		// Wait for previous frame's render task to complete
 		task_scheduler->wait_for_counter(render_task_counter);
 
@@ -266,6 +441,7 @@ namespace bud::engine {
 		// Hammering vkAcquireNextImageKHR on a 0x0 un-resized window causes AMD/NVIDIA driver TDRs (Hang/BSOD).
 		if (width == 0 || height == 0) {
 			render_inflight_index.store(BudEngine::invalid_render_index, std::memory_order_release);
+			bud::frame_stats::complete_frame(bud::frame_stats::get_current_frame());
 			std::this_thread::sleep_for(std::chrono::nanoseconds(1)); // prevent 100% CPU spin
 			return;
 		}
@@ -317,12 +493,26 @@ namespace bud::engine {
 			ImGui::End();
 		}
 
+		if (show_profiler) {
+			bud::ui::ProfilerUI::render(&show_profiler);
+		}
+
 		ImGui::Render();
 		renderer->update_ui_draw_data(ImGui::GetDrawData());
 
 		// 发射渲染任务 (Fire and Forget), Pin to Worker 1 for Vulkan WSI safety
-		task_scheduler->spawn_on_thread(1, "RenderTask", [this, render_scene_index, view_snapshot]() mutable {
-			renderer->render(render_scenes[render_scene_index], view_snapshot);
+		const uint64_t stats_frame = bud::frame_stats::get_current_frame();
+		task_scheduler->spawn_on_thread(1, "RenderTask", [this, render_scene_index, view_snapshot, views = secondary_views, stats_frame]() mutable {
+			ZoneScopedN("RenderTask");
+			bud::frame_stats::set_current_frame(stats_frame);
+			renderer->render(render_scenes[render_scene_index], view_snapshot, views);
+			if (time_to_first_frame_ms.load(std::memory_order_relaxed) == 0.0) {
+				const double ms = get_uptime_ms();
+				time_to_first_frame_ms.store(ms, std::memory_order_release);
+				bud::print("[Startup] Time to first frame: {:.1f} ms", ms);
+			}
+			bud::frame_stats::set_current_frame(0);
+			bud::frame_stats::complete_frame(stats_frame);
 			render_inflight_index.store(BudEngine::invalid_render_index, std::memory_order_release);
 		}, &render_task_counter);
 	}
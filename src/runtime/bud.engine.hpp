@@ -4,6 +4,7 @@
 #include <memory>
 #include <functional>
 #include <atomic>
+#include <chrono>
 #include <limits>
 
 #include "src/io/bud.io.hpp"
@@ -12,11 +13,13 @@
 #include "src/core/bud.math.hpp"
 #include "src/runtime/bud.input.hpp"
 #include "src/runtime/bud.scene.hpp"
+#include "src/runtime/bud.startup.hpp"
 #include "src/threading/bud.threading.hpp"
 #include "src/platform/bud.platform.hpp"
 
 #include "src/graphics/bud.graphics.hpp"
 #include "src/graphics/bud.graphics.scene.hpp"
+#include "src/graphics/bud.graphics.hlod.hpp"
 #include "src/graphics/bud.graphics.renderer.hpp"
 
 
@@ -32,20 +35,39 @@ namespace bud::engine {
 	public:
 
 		using GameLogic = std::function<void(float)>;
+		// Adds application jobs (scene parsing, asset preloads) to the engine's startup graph. Engine jobs:
+		// "Window", "AssetManager", "RHI", "ImGui", "Renderer"; depend on them by name.
+		using StartupHook = std::function<void(StartupGraph& graph, BudEngine& engine)>;
 
-		BudEngine(const bud::graphics::EngineConfig config);
+		BudEngine(const bud::graphics::EngineConfig config, StartupHook add_startup_jobs = nullptr);
 		~BudEngine();
 
 		void run(GameLogic perform_game_logic);
 
+		// Leaves run() after the current frame, safe from any thread
+		void request_exit() { exit_requested.store(true, std::memory_order_release); }
+
 		auto* get_asset_manager() { return asset_manager.get(); }
 		auto* get_renderer() { return renderer.get(); }
+		auto* get_rhi() { return rhi.get(); }
 		auto& get_scene() { return scene; }
 
 		auto* get_task_scheduler() { return task_scheduler.get(); }
 
 		auto& get_engine_config() const { return engine_config; }
 
+		// Extra views drawn every frame next to the main camera (game thread). Matrices come from the caller,
+		// lighting and shadows follow the main view; an empty list turns multi-view off.
+		void set_secondary_views(std::vector<bud::graphics::SecondaryView> views) { secondary_views = std::move(views); }
+
+		// Region proxies of BudAssetTool --build-hlod (game thread). Member entities index get_scene().entities,
+		// proxy meshes must be uploaded already; nullptr turns HLOD off.
+		void set_hlod(std::shared_ptr<const bud::graphics::HLODSet> hlod_set) { hlod = std::move(hlod_set); }
+
+		// Startup timeline and time to first frame, all relative to the start of the constructor
+		StartupReport get_startup_report() const;
+		double get_uptime_ms() const;
+
 	private:
 		void handle_events();
 
@@ -59,6 +81,10 @@ namespace bud::engine {
 
 		double accumulator = 0.0;
 
+		std::chrono::steady_clock::time_point startup_origin;
+		StartupReport startup_report;
+		std::atomic<double> time_to_first_frame_ms = 0.0;  // Written by the first render task
+
 		uint32_t current_write_index = 0;
 
 		std::atomic<uint32_t> last_committed_index = 0;
@@ -68,6 +94,8 @@ namespace bud::engine {
 
 		bud::threading::Counter render_task_counter;
 
+		std::atomic<bool> exit_requested = false;
+
 		std::unique_ptr<bud::platform::Window> window;
 
 		int last_width = 0;
@@ -89,7 +117,13 @@ namespace bud::engine {
 		float far_plane{ 5000.0f };
 		float near_plane{ 1.0f };
 
+		std::vector<bud::graphics::SecondaryView> secondary_views; // Copied into each render task
+
+		std::shared_ptr<const bud::graphics::HLODSet> hlod;
+		std::vector<uint8_t> hlod_active; // Per region, select() output of the frame being extracted
+
 		bool show_debug_stats = true;
+		bool show_profiler = false;
 		std::string imgui_ini_path;
 	};
 }
@@ -8,7 +8,10 @@ namespace bud::game {
             bud::print("[Framework] Starting Application: {}", config.window_title);
             
             // 1. Initialize Engine
-            engine = std::make_unique<bud::engine::BudEngine>(config.to_engine_config());
+            engine = std::make_unique<bud::engine::BudEngine>(config.to_engine_config(),
+                [this, &config](bud::engine::StartupGraph& graph, bud::engine::BudEngine& starting_engine) {
+                    on_startup(graph, starting_engine, config);
+                });
 
             // 2. Lifecycle: on_init
             on_init(config);
@@ -14,12 +14,18 @@ namespace bud::game {
 		std::string window_title = "Bud Engine Application";
 		uint32_t width = 1280;
 		uint32_t height = 720;
+		bool hidden_window = false;
+		bud::graphics::DevicePreference device_preference = bud::graphics::DevicePreference::Discrete;
+		double fixed_frame_time = 0.0;
 
 		bud::graphics::EngineConfig to_engine_config() const {
 			bud::graphics::EngineConfig config;
 			config.name = window_title;
 			config.width = width;
 			config.height = height;
+			config.hidden_window = hidden_window;
+			config.device_preference = device_preference;
+			config.fixed_frame_time = fixed_frame_time;
 			return config;
 		}
 	};
@@ -32,6 +38,9 @@ namespace bud::game {
 		void run(const AppConfig& config);
 
 		// Lifecycle hooks
+		// Runs inside the engine constructor: add jobs to the startup graph (e.g. scene parsing on a worker,
+		// after "AssetManager"). The engine's subsystems only exist inside jobs depending on them.
+		virtual void on_startup(bud::engine::StartupGraph& graph, bud::engine::BudEngine& engine, const AppConfig& config) {}
 		virtual void on_init(const AppConfig& config) = 0;
 		virtual void on_update(float dt) = 0;
 		virtual void on_shutdown() = 0;
@@ -22,6 +22,9 @@ namespace bud::input {
 		E,
 		F3, // Enable debug overlay
 		F4, // Enable cluster visualization
+		F5, // Toggle visibility buffer main view
+		F6, // Toggle dynamic resolution
+		F7, // Toggle CPU profiler
 	};
 
 	 enum class MouseButton {
@@ -54,6 +54,13 @@ namespace bud::scene {
         if (zoom > 45.0f) zoom = 45.0f;
     }
 
+    void Camera::set_pose(const bud::math::vec3& new_position, float new_yaw, float new_pitch) {
+        position = new_position;
+        yaw = new_yaw;
+        pitch = new_pitch;
+        update_camera_vectors();
+    }
+
     void Camera::update_camera_vectors() {
         bud::math::vec3 f;
         f.x = cos(bud::math::radians(yaw)) * cos(bud::math::radians(pitch));
@@ -29,6 +29,7 @@ namespace bud::scene {
 		void process_mouse_movement(float x_offset, float y_offset, bool constrain_pitch = true);
 		void process_mouse_scroll(float y_offset);
 		void process_mouse_drag_zoom(float yoffset);
+		void set_pose(const bud::math::vec3& new_position, float new_yaw, float new_pitch);
 		
 		inline bud::math::AABB get_collision_aabb(float radius = 0.2f) const {
 			return { position - bud::math::vec3(radius), position + bud::math::vec3(radius) };
@@ -53,10 +54,53 @@ namespace bud::scene {
 		float intensity = 5.0f;
 	};
 
+	struct PointLight {
+		bud::math::vec3 position = { 0.0f, 0.0f, 0.0f };
+		bud::math::vec3 color = { 1.0f, 1.0f, 1.0f };
+		float intensity = 10.0f;
+		float range = 10.0f; // Influence radius, attenuation reaches zero here
+	};
+
+	struct SpotLight {
+		bud::math::vec3 position = { 0.0f, 0.0f, 0.0f };
+		bud::math::vec3 direction = { 0.0f, -1.0f, 0.0f };
+		bud::math::vec3 color = { 1.0f, 1.0f, 1.0f };
+		float intensity = 20.0f;
+		float range = 20.0f;
+		float inner_angle = 20.0f; // Half angles in degrees
+		float outer_angle = 30.0f;
+	};
+
+	// Instanced scatter drawn by the renderer's FoliageSystem, not entities. Instances are placed on the
+	// area_min.y plane with a seeded random position, yaw and scale, so a million of them stay one line of JSON.
+	struct FoliageLayer {
+		std::vector<std::string> lod_paths;   // Mesh per LOD, most detailed first
+		std::vector<float> lod_distances;     // Same length, LOD i is drawn up to lod_distances[i]
+		std::string impostor_path;            // Atlas from BudAssetTool --bake-impostor, empty = none
+		uint32_t impostor_frames = 8;         // Card layout, the atlas' .json sidecar overrides it when present
+		bud::math::vec2 impostor_size = { 1.0f, 1.0f };
+		float impostor_base = 0.0f;
+
+		uint32_t count = 0;
+		bud::math::vec3 area_min = { -100.0f, 0.0f, -100.0f };
+		bud::math::vec3 area_max = { 100.0f, 0.0f, 100.0f };
+		float scale_min = 0.8f;
+		float scale_max = 1.2f;
+		uint32_t seed = 1;
+
+		float cull_distance = 2000.0f;
+		float shadow_distance = 150.0f;
+		bool cast_shadows = true;
+	};
+
 	 struct Scene {
 		Camera main_camera;
 		DirectionalLight directional_light;
 		float ambient_strength = 0.05f;
+		std::vector<PointLight> point_lights;
+		std::vector<SpotLight> spot_lights;
 		std::vector<Entity> entities;
+		std::vector<FoliageLayer> foliage;
+		std::string hlod; // hlod.json of BudAssetTool --build-hlod, built from this scene's entity order; empty = none
 	};
 }
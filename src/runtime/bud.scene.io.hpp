@@ -91,19 +91,106 @@ namespace bud::scene {
         j.at("intensity").get_to(l.intensity);
     }
 
+    // PointLight
+    inline void to_json(nlohmann::json& j, const PointLight& l) {
+        j = nlohmann::json{
+            {"position", l.position},
+            {"color", l.color},
+            {"intensity", l.intensity},
+            {"range", l.range}
+        };
+    }
+    inline void from_json(const nlohmann::json& j, PointLight& l) {
+        j.at("position").get_to(l.position);
+        j.at("color").get_to(l.color);
+        j.at("intensity").get_to(l.intensity);
+        j.at("range").get_to(l.range);
+    }
+
+    // SpotLight
+    inline void to_json(nlohmann::json& j, const SpotLight& l) {
+        j = nlohmann::json{
+            {"position", l.position},
+            {"direction", l.direction},
+            {"color", l.color},
+            {"intensity", l.intensity},
+            {"range", l.range},
+            {"inner_angle", l.inner_angle},
+            {"outer_angle", l.outer_angle}
+        };
+    }
+    inline void from_json(const nlohmann::json& j, SpotLight& l) {
+        j.at("position").get_to(l.position);
+        j.at("direction").get_to(l.direction);
+        j.at("color").get_to(l.color);
+        j.at("intensity").get_to(l.intensity);
+        j.at("range").get_to(l.range);
+        if (j.contains("inner_angle")) j.at("inner_angle").get_to(l.inner_angle);
+        if (j.contains("outer_angle")) j.at("outer_angle").get_to(l.outer_angle);
+    }
+
+    // FoliageLayer
+    inline void to_json(nlohmann::json& j, const FoliageLayer& f) {
+        j = nlohmann::json{
+            {"lod_paths", f.lod_paths},
+            {"lod_distances", f.lod_distances},
+            {"count", f.count},
+            {"area_min", f.area_min},
+            {"area_max", f.area_max},
+            {"scale_min", f.scale_min},
+            {"scale_max", f.scale_max},
+            {"seed", f.seed},
+            {"cull_distance", f.cull_distance},
+            {"shadow_distance", f.shadow_distance},
+            {"cast_shadows", f.cast_shadows}
+        };
+        if (!f.impostor_path.empty()) {
+            j["impostor_path"] = f.impostor_path;
+            j["impostor_frames"] = f.impostor_frames;
+            j["impostor_size"] = f.impostor_size;
+            j["impostor_base"] = f.impostor_base;
+        }
+    }
+    inline void from_json(const nlohmann::json& j, FoliageLayer& f) {
+        j.at("lod_paths").get_to(f.lod_paths);
+        j.at("lod_distances").get_to(f.lod_distances);
+        j.at("count").get_to(f.count);
+        j.at("area_min").get_to(f.area_min);
+        j.at("area_max").get_to(f.area_max);
+        if (j.contains("impostor_path")) j.at("impostor_path").get_to(f.impostor_path);
+        if (j.contains("impostor_frames")) j.at("impostor_frames").get_to(f.impostor_frames);
+        if (j.contains("impostor_size")) j.at("impostor_size").get_to(f.impostor_size);
+        if (j.contains("impostor_base")) j.at("impostor_base").get_to(f.impostor_base);
+        if (j.contains("scale_min")) j.at("scale_min").get_to(f.scale_min);
+        if (j.contains("scale_max")) j.at("scale_max").get_to(f.scale_max);
+        if (j.contains("seed")) j.at("seed").get_to(f.seed);
+        if (j.contains("cull_distance")) j.at("cull_distance").get_to(f.cull_distance);
+        if (j.contains("shadow_distance")) j.at("shadow_distance").get_to(f.shadow_distance);
+        if (j.contains("cast_shadows")) j.at("cast_shadows").get_to(f.cast_shadows);
+    }
+
     // Scene
     inline void to_json(nlohmann::json& j, const Scene& s) {
         j = nlohmann::json{
             {"main_camera", s.main_camera},
             {"directional_light", s.directional_light},
             {"ambient_strength", s.ambient_strength},
+            {"point_lights", s.point_lights},
+            {"spot_lights", s.spot_lights},
             {"entities", s.entities}
         };
+        if (!s.foliage.empty()) j["foliage"] = s.foliage;
+        if (!s.hlod.empty()) j["hlod"] = s.hlod;
     }
     inline void from_json(const nlohmann::json& j, Scene& s) {
         j.at("main_camera").get_to(s.main_camera);
         j.at("directional_light").get_to(s.directional_light);
         j.at("ambient_strength").get_to(s.ambient_strength);
+        // Local lights are optional, older scene files only have the directional light
+        if (j.contains("point_lights")) j.at("point_lights").get_to(s.point_lights);
+        if (j.contains("spot_lights")) j.at("spot_lights").get_to(s.spot_lights);
         j.at("entities").get_to(s.entities);
+        if (j.contains("foliage")) j.at("foliage").get_to(s.foliage);
+        if (j.contains("hlod")) j.at("hlod").get_to(s.hlod);
     }
 }
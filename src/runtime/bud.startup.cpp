@@ -0,0 +1,171 @@
+﻿#include "src/runtime/bud.startup.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <format>
+#include <mutex>
+#include <stdexcept>
+
+#include "src/core/bud.logger.hpp"
+#include "src/core/bud.profiler.hpp"
+#include "src/threading/bud.threading.hpp"
+
+namespace bud::engine {
+
+	StartupGraph::StartupGraph(bud::threading::TaskScheduler* task_scheduler, Clock::time_point origin)
+		: task_scheduler(task_scheduler), origin(origin) {
+	}
+
+	void StartupGraph::add(std::string name, std::vector<std::string> dependencies, StartupThread thread, std::function<void()> job) {
+		if (contains(name)) {
+			std::string err = std::format("StartupGraph::add duplicate job '{}'", name);
+			bud::eprint("{}", err);
+#if defined(_DEBUG)
+			throw std::runtime_error(err);
+#else
+			return;
+#endif
+		}
+
+		Job entry{ std::move(name), {}, thread, std::move(job) };
+		for (const auto& dependency : dependencies) {
+			auto it = std::find_if(jobs.begin(), jobs.end(), [&](const Job& j) { return j.name == dependency; });
+			if (it == jobs.end()) {
+				std::string err = std::format("StartupGraph::add job '{}' depends on unknown job '{}'", entry.name, dependency);
+				bud::eprint("{}", err);
+#if defined(_DEBUG)
+				throw std::runtime_error(err);
+#else
+				continue;
+#endif
+			}
+			entry.dependencies.push_back(static_cast<size_t>(it - jobs.begin()));
+		}
+		jobs.push_back(std::move(entry));
+	}
+
+	bool StartupGraph::contains(const std::string& name) const {
+		return std::any_of(jobs.begin(), jobs.end(), [&](const Job& j) { return j.name == name; });
+	}
+
+	double StartupGraph::elapsed_ms() const {
+		return std::chrono::duration<double, std::milli>(Clock::now() - origin).count();
+	}
+
+	void StartupGraph::run() {
+		ZoneScopedN("StartupGraph");
+
+		enum class State { Pending, Running, Done };
+		std::vector<State> states(jobs.size(), State::Pending);
+		std::vector<StartupJobTiming> timings(jobs.size());
+		size_t done_count = 0;
+		size_t running_workers = 0;
+		std::exception_ptr failure;
+
+		// Worker jobs report back through this; the main thread sleeps on it when nothing is runnable
+		std::mutex mutex;
+		std::condition_variable finished;
+
+		auto is_ready = [&](size_t i) {
+			return std::all_of(jobs[i].dependencies.begin(), jobs[i].dependencies.end(), [&](size_t d) { return states[d] == State::Done; });
+		};
+
+		auto execute = [&](size_t i) {
+			timings[i].name = jobs[i].name;
+			timings[i].main_thread = jobs[i].thread == StartupThread::Main;
+			timings[i].start_ms = elapsed_ms();
+			std::exception_ptr error;
+			try {
+				jobs[i].work();
+			}
+			catch (...) {
+				error = std::current_exception();
+			}
+			timings[i].end_ms = elapsed_ms();
+			return error;
+		};
+
+		// Called with the lock held, by the main loop and by every finishing worker job, so a worker job
+		// starts as soon as its dependencies are done even while the main thread is busy
+		std::function<void()> dispatch_workers = [&]() {
+			if (failure) return; // Once a job failed nothing new starts, only the ones in flight are drained
+			for (size_t i = 0; i < jobs.size(); ++i) {
+				if (jobs[i].thread != StartupThread::Worker || states[i] != State::Pending || !is_ready(i)) continue;
+
+				states[i] = State::Running;
+				running_workers++;
+				task_scheduler->spawn("StartupJob", [&, i]() {
+					auto error = execute(i);
+					std::lock_guard guard(mutex);
+					if (error && !failure) failure = error;
+					states[i] = State::Done;
+					done_count++;
+					running_workers--;
+					dispatch_workers();
+					finished.notify_one();
+				});
+			}
+		};
+
+		std::unique_lock lock(mutex);
+		while (done_count < jobs.size()) {
+			dispatch_workers();
+
+			size_t main_job = jobs.size();
+			for (size_t i = 0; i < jobs.size() && !failure; ++i) {
+				if (jobs[i].thread == StartupThread::Main && states[i] == State::Pending && is_ready(i)) {
+					main_job = i;
+					break;
+				}
+			}
+
+			if (main_job < jobs.size()) {
+				states[main_job] = State::Running;
+				lock.unlock();
+				auto error = execute(main_job);
+				lock.lock();
+				if (error && !failure) failure = error;
+				states[main_job] = State::Done;
+				done_count++;
+				continue;
+			}
+
+			if (running_workers == 0) {
+				// Nothing runnable and nothing in flight: a job failed, or its dependencies can never finish
+				break;
+			}
+			finished.wait(lock);
+		}
+
+		timeline.clear();
+		for (size_t i = 0; i < jobs.size(); ++i) {
+			if (states[i] == State::Done) timeline.push_back(timings[i]);
+		}
+		std::sort(timeline.begin(), timeline.end(), [](const auto& a, const auto& b) { return a.start_ms < b.start_ms; });
+
+		if (failure) {
+			lock.unlock();
+			std::rethrow_exception(failure);
+		}
+	}
+
+	void StartupGraph::print_timeline() const {
+		if (timeline.empty()) return;
+
+		const double total = std::max_element(timeline.begin(), timeline.end(), [](const auto& a, const auto& b) { return a.end_ms < b.end_ms; })->end_ms;
+		constexpr int BAR_WIDTH = 40;
+
+		bud::print("[Startup] Timeline ({:.1f} ms):", total);
+		for (const auto& t : timeline) {
+			// Text gantt bar, one column per total / BAR_WIDTH ms
+			std::string bar(BAR_WIDTH, ' ');
+			int begin = total > 0.0 ? static_cast<int>(t.start_ms / total * BAR_WIDTH) : 0;
+			int end = total > 0.0 ? static_cast<int>(t.end_ms / total * BAR_WIDTH) : 0;
+			begin = std::clamp(begin, 0, BAR_WIDTH - 1);
+			end = std::clamp(end, begin + 1, BAR_WIDTH);
+			std::fill(bar.begin() + begin, bar.begin() + end, t.main_thread ? '#' : '=');
+			bud::print("[Startup]   {:<18} {:>8.1f} ms  +{:>8.1f}  |{}| {}", t.name, t.duration_ms(), t.start_ms, bar, t.main_thread ? "main" : "worker");
+		}
+	}
+}
@@ -0,0 +1,68 @@
+﻿#pragma once
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <chrono>
+
+namespace bud::threading { class TaskScheduler; }
+
+namespace bud::engine {
+
+	enum class StartupThread {
+		Main,    // SDL, ImGui and the Vulkan surface stay on the thread that created the window
+		Worker   // Runs on the task scheduler next to the main-thread jobs
+	};
+
+	struct StartupJobTiming {
+		std::string name;
+		double start_ms = 0.0;  // Relative to the engine's startup origin
+		double end_ms = 0.0;
+		bool main_thread = false;
+
+		double duration_ms() const { return end_ms - start_ms; }
+	};
+
+	struct StartupReport {
+		std::vector<StartupJobTiming> jobs;
+		double pipelines_ready_ms = 0.0;      // Every RenderPass pipeline exists
+		double time_to_first_frame_ms = 0.0;  // First frame recorded and submitted, 0 until then
+		bool shader_bundle = false;
+	};
+
+	// Engine bring-up as named jobs with dependencies. A job starts once all of its dependencies have
+	// finished; worker jobs overlap with the main-thread ones. Dependencies must be added first, which
+	// keeps the graph acyclic. An exception thrown by any job is rethrown from run() after the jobs
+	// already in flight have finished.
+	class StartupGraph {
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		StartupGraph(bud::threading::TaskScheduler* task_scheduler, Clock::time_point origin);
+
+		void add(std::string name, std::vector<std::string> dependencies, StartupThread thread, std::function<void()> job);
+		bool contains(const std::string& name) const;
+
+		// Blocks the calling (main) thread until every job has run
+		void run();
+
+		// In start order, valid after run()
+		const std::vector<StartupJobTiming>& get_timeline() const { return timeline; }
+		void print_timeline() const;
+
+	private:
+		struct Job {
+			std::string name;
+			std::vector<size_t> dependencies;
+			StartupThread thread;
+			std::function<void()> work;
+		};
+
+		double elapsed_ms() const;
+
+		bud::threading::TaskScheduler* task_scheduler;
+		Clock::time_point origin;
+		std::vector<Job> jobs;
+		std::vector<StartupJobTiming> timeline;
+	};
+}
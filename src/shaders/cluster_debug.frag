@@ -7,6 +7,34 @@ layout(location = 3) flat in uint cluster_seed;
 
 layout(location = 0) out vec4 out_color;
 
+layout(binding = 0) uniform UniformBufferObject {
+    mat4 view;
+    mat4 proj;
+	mat4 cascade_view_proj[4];
+	vec4 cascade_split_depths;
+    vec3 cam_pos;
+    vec3 light_dir;
+	vec3 light_color;
+    float light_intensity;
+    float ambient_strength;
+	uint cascade_count;
+    uint debug_cascades;
+	uint reversed_z;
+	float shadow_bias_constant;
+	float shadow_bias_slope;
+	uint local_light_count;
+	uint debug_light_clusters;
+	uvec4 cluster_dims;  // x, y, z, max lights per cluster
+	vec4 cluster_depth;  // near, far, log scale, log bias
+	vec4 cluster_screen; // width, height, 1 / width, 1 / height
+} ubo;
+
+// Header, one count per cluster, then light indices (see light_cluster_assign.comp)
+layout(std430, binding = 9) readonly buffer LightClusterGrid {
+    uvec4 cluster_header;
+    uint cluster_data[];
+};
+
 // Simple PCG hash to generate pseudo-random numbers
 uint pcg_hash(uint seed) {
     uint state = seed * 747796405u + 2891336453u;
@@ -19,7 +47,32 @@ vec3 get_random_color(uint seed) {
     return vec3(float(h & 255u), float((h >> 8u) & 255u), float((h >> 16u) & 255u)) / 255.0;
 }
 
+// Blue (empty) -> green -> red (cluster list full)
+vec3 heatmap(float t) {
+    t = clamp(t, 0.0, 1.0);
+    return t < 0.5 ? mix(vec3(0.0, 0.0, 0.4), vec3(0.0, 1.0, 0.0), t * 2.0)
+                   : mix(vec3(0.0, 1.0, 0.0), vec3(1.0, 0.0, 0.0), t * 2.0 - 1.0);
+}
+
 void main() {
+    if (ubo.debug_light_clusters != 0u) {
+        uint light_count = 0u;
+        if (ubo.local_light_count > 0u) {
+            uvec3 dims = ubo.cluster_dims.xyz;
+            float view_depth = -(ubo.view * vec4(frag_world_pos, 1.0)).z;
+            float slice = floor(log(max(view_depth, ubo.cluster_depth.x)) * ubo.cluster_depth.z + ubo.cluster_depth.w);
+            uint z = uint(clamp(slice, 0.0, float(dims.z - 1u)));
+            uvec2 tile = min(uvec2(gl_FragCoord.xy * ubo.cluster_screen.zw * vec2(dims.xy)), dims.xy - 1u);
+            light_count = cluster_data[tile.x + dims.x * (tile.y + dims.y * z)];
+        }
+
+        // Tile borders help reading the grid
+        vec2 tile_uv = fract(gl_FragCoord.xy * ubo.cluster_screen.zw * vec2(ubo.cluster_dims.xy));
+        float border = (tile_uv.x < 0.02 || tile_uv.y < 0.02) ? 0.6 : 1.0;
+        out_color = vec4(heatmap(float(light_count) / float(max(ubo.cluster_dims.w, 1u))) * border, 1.0);
+        return;
+    }
+
     // Mix instance_seed and cluster_seed for stable color
     uint seed = instance_seed * 1337u + cluster_seed;
     
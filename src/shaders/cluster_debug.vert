@@ -1,4 +1,5 @@
 #version 450
+#extension GL_GOOGLE_include_directive : require
 
 layout(location = 0) in vec3 in_position;
 layout(location = 2) in vec3 in_normal;
@@ -26,23 +27,17 @@ layout(binding = 0) uniform UniformBufferObject {
 	uint padding[3];
 } ubo;
 
-struct InstanceData {
-    mat4 model;
-    uint material_id;
-    uint padding[3];
-};
-
-layout(std430, binding = 3) readonly buffer InstanceBuffer {
-    InstanceData data[];
-} instance_buffer;
+#define INSTANCE_DATA_BINDING 3
+#include "instance_data.glsl"
 
 void main() {
-    InstanceData instance = instance_buffer.data[gl_InstanceIndex];
-    vec4 world_pos = instance.model * vec4(in_position, 1.0);
+    uvec2 draw_instance = load_draw_instance(uint(gl_InstanceIndex));
+    mat4 model = load_instance_transform(draw_instance.x);
+    vec4 world_pos = model * vec4(in_position, 1.0);
     frag_world_pos = world_pos.xyz;
     frag_normal = in_normal;
     // Create stable instance seed based on world position
-    instance_seed = floatBitsToUint(instance.model[3].x) ^ floatBitsToUint(instance.model[3].y) ^ floatBitsToUint(instance.model[3].z);
+    instance_seed = floatBitsToUint(model[3].x) ^ floatBitsToUint(model[3].y) ^ floatBitsToUint(model[3].z);
     cluster_seed = uint(gl_VertexIndex) / 64u; // Stable seed for cluster coloration
 
     gl_Position = ubo.proj * ubo.view * world_pos;
@@ -0,0 +1,5 @@
+#version 450
+
+// Depth-only pipelines of opaque materials, depth comes from the rasterizer
+void main() {
+}
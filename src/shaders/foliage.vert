@@ -0,0 +1,65 @@
+#version 450
+
+layout(location = 0) in vec3 in_position;
+layout(location = 1) in vec3 in_color;
+layout(location = 2) in vec3 in_normal;
+layout(location = 3) in vec2 in_tex_coord;
+layout(location = 4) in float in_tex_index;
+
+// FoliageInstance, per instance: pivot position, yaw (low 16 bits) and scale (high 16 bits) as unorm
+layout(location = 5) in vec3 instance_position;
+layout(location = 6) in uint instance_yaw_scale;
+
+// Same interface as main.vert, shaded by main.frag
+layout(location = 0) out vec3 frag_world_pos;
+layout(location = 1) out vec3 frag_normal;
+layout(location = 2) out vec2 frag_tex_coord;
+layout(location = 3) out vec3 frag_color;
+layout(location = 4) flat out uint frag_material_id;
+
+layout(binding = 0) uniform UniformBufferObject {
+    mat4 view;
+    mat4 proj;
+	// [CSM]
+	mat4 cascade_view_proj[4];
+	vec4 cascade_split_depths;
+
+    vec3 cam_pos;
+    vec3 light_dir;
+	vec3 light_color;
+    float light_intensity;
+    float ambient_strength;
+	uint cascade_count;
+    uint debug_cascades;
+	uint reversed_z;
+	uint padding[3];
+} ubo;
+
+layout(push_constant) uniform PushConsts {
+    uint material_id;
+} push;
+
+const float TWO_PI = 6.28318530718;
+const float FOLIAGE_MAX_SCALE = 4.0; // bud::graphics::FOLIAGE_MAX_SCALE
+
+// Rotation about +Y, same as glm::rotate(yaw, {0, 1, 0})
+vec3 rotate_yaw(vec3 v, float s, float c) {
+    return vec3(c * v.x + s * v.z, v.y, -s * v.x + c * v.z);
+}
+
+void main() {
+    vec2 yaw_scale = unpackUnorm2x16(instance_yaw_scale);
+    float yaw = yaw_scale.x * TWO_PI;
+    float scale = yaw_scale.y * FOLIAGE_MAX_SCALE;
+    float s = sin(yaw);
+    float c = cos(yaw);
+
+    vec3 world_pos = instance_position + rotate_yaw(in_position * scale, s, c);
+    frag_world_pos = world_pos;
+    frag_normal = rotate_yaw(in_normal, s, c);
+    frag_color = in_color;
+    frag_material_id = push.material_id;
+    frag_tex_coord = in_tex_coord;
+
+    gl_Position = ubo.proj * ubo.view * vec4(world_pos, 1.0);
+}
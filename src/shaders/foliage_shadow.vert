@@ -0,0 +1,33 @@
+#version 450
+
+layout(location = 0) in vec3 in_position;
+layout(location = 3) in vec2 in_tex_coord;
+
+// FoliageInstance, per instance: pivot position, yaw (low 16 bits) and scale (high 16 bits) as unorm
+layout(location = 5) in vec3 instance_position;
+layout(location = 6) in uint instance_yaw_scale;
+
+layout(location = 0) out vec2 frag_tex_coord;
+
+// Same block as shadow.frag, model is unused
+layout(push_constant) uniform PushConsts {
+    mat4 light_view_proj;
+	mat4 model;
+	vec4 light_dir;
+	uint material_id;
+} push_consts;
+
+const float TWO_PI = 6.28318530718;
+const float FOLIAGE_MAX_SCALE = 4.0; // bud::graphics::FOLIAGE_MAX_SCALE
+
+void main() {
+    vec2 yaw_scale = unpackUnorm2x16(instance_yaw_scale);
+    float yaw = yaw_scale.x * TWO_PI;
+    float s = sin(yaw);
+    float c = cos(yaw);
+
+    vec3 p = in_position * (yaw_scale.y * FOLIAGE_MAX_SCALE);
+    vec3 world_pos = instance_position + vec3(c * p.x + s * p.z, p.y, -s * p.x + c * p.z);
+    gl_Position = push_consts.light_view_proj * vec4(world_pos, 1.0);
+	frag_tex_coord = in_tex_coord;
+}
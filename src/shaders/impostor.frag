@@ -0,0 +1,59 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : enable
+
+layout(location = 0) in vec2 frag_tex_coord;
+layout(location = 1) in vec3 frag_world_pos;
+
+layout(location = 0) out vec4 out_color;
+
+layout(binding = 0) uniform UniformBufferObject {
+    mat4 view;
+    mat4 proj;
+	// [CSM]
+	mat4 cascade_view_proj[4];
+	vec4 cascade_split_depths;
+
+    vec3 cam_pos;
+    vec3 light_dir;
+    vec3 light_color;
+    float light_intensity;
+    float ambient_strength;
+} ubo;
+
+layout(binding = 1) uniform sampler2D tex_samplers[];
+
+layout(push_constant) uniform PushConsts {
+    uint texture_id;
+    uint frames;
+    uint padding[2];
+    vec4 card;
+} push;
+
+const float PI = 3.14159265359;
+
+// Same curve as main.frag, so distant cards blend with the meshes they replace
+vec3 ACESFilm(vec3 x) {
+    float a = 2.51;
+    float b = 0.03;
+    float c = 2.43;
+    float d = 0.59;
+    float e = 0.14;
+    return clamp((x*(a*x+b))/(x*(c*x+d)+e), 0.0, 1.0);
+}
+
+void main() {
+    // The atlas holds unlit albedo with coverage in alpha
+    vec4 albedo_sample = texture(tex_samplers[nonuniformEXT(push.texture_id)], frag_tex_coord);
+    if (albedo_sample.a < 0.5)
+        discard;
+
+    // No normals in the atlas: a canopy is lit like a rough sphere, wrapped diffuse against the sky
+    vec3 L = normalize(ubo.light_dir);
+    float wrap = clamp((L.y + 0.5) / 1.5, 0.0, 1.0);
+    vec3 albedo = albedo_sample.rgb;
+    vec3 color = vec3(ubo.ambient_strength) * albedo + albedo / PI * ubo.light_color * ubo.light_intensity * wrap;
+
+    color = ACESFilm(color);
+    color = pow(color, vec3(1.0/2.2));
+    out_color = vec4(color, 1.0);
+}
@@ -0,0 +1,62 @@
+#version 450
+
+// FoliageInstance, per instance: pivot position, yaw (low 16 bits) and scale (high 16 bits) as unorm
+layout(location = 5) in vec3 instance_position;
+layout(location = 6) in uint instance_yaw_scale;
+
+layout(location = 0) out vec2 frag_tex_coord;
+layout(location = 1) out vec3 frag_world_pos;
+
+layout(binding = 0) uniform UniformBufferObject {
+    mat4 view;
+    mat4 proj;
+	// [CSM]
+	mat4 cascade_view_proj[4];
+	vec4 cascade_split_depths;
+
+    vec3 cam_pos;
+} ubo;
+
+// texture: bindless slot of the atlas, frames: azimuth views in it, card: width, height, base at scale 1
+layout(push_constant) uniform PushConsts {
+    uint texture_id;
+    uint frames;
+    uint padding[2];
+    vec4 card;
+} push;
+
+const float TWO_PI = 6.28318530718;
+const float FOLIAGE_MAX_SCALE = 4.0; // bud::graphics::FOLIAGE_MAX_SCALE
+
+// Two triangles, x across the card, y from its base up
+const vec2 CORNERS[6] = vec2[](
+    vec2(-0.5, 0.0), vec2(0.5, 0.0), vec2(0.5, 1.0),
+    vec2(-0.5, 0.0), vec2(0.5, 1.0), vec2(-0.5, 1.0)
+);
+
+void main() {
+    vec2 yaw_scale = unpackUnorm2x16(instance_yaw_scale);
+    float yaw = yaw_scale.x * TWO_PI;
+    float scale = yaw_scale.y * FOLIAGE_MAX_SCALE;
+    vec2 corner = CORNERS[gl_VertexIndex % 6];
+
+    // Cylindrical billboard: turns around +Y only, so trunks stay upright
+    vec3 to_camera = ubo.cam_pos - instance_position;
+    to_camera.y = 0.0;
+    float len = length(to_camera);
+    to_camera = len > 1e-4 ? to_camera / len : vec3(0.0, 0.0, 1.0);
+    vec3 right = vec3(to_camera.z, 0.0, -to_camera.x);
+
+    vec3 world_pos = instance_position
+        + right * (corner.x * push.card.x * scale)
+        + vec3(0.0, (push.card.z + corner.y * push.card.y) * scale, 0.0);
+
+    // Frame f was baked from azimuth 2 pi f / frames in the mesh's own space, yaw turns the instance away from it
+    float azimuth = atan(to_camera.x, to_camera.z) - yaw;
+    float frames = float(max(push.frames, 1u));
+    float frame = mod(floor(fract(azimuth / TWO_PI) * frames + 0.5), frames);
+
+    frag_tex_coord = vec2((frame + corner.x + 0.5) / frames, 1.0 - corner.y);
+    frag_world_pos = world_pos;
+    gl_Position = ubo.proj * ubo.view * vec4(world_pos, 1.0);
+}
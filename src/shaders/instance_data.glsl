@@ -0,0 +1,32 @@
+// GlobalInstanceData (bud.graphics.types.hpp): header {first transform word, draw slots, instances, 0},
+// then a uvec2 {instance, material | flags << 24} per draw slot (GPUDrawInstance), then a 3x4 row-major
+// transform per instance (GPUInstanceTransform). Included by every shader that reads it, define
+// INSTANCE_DATA_BINDING to the InstanceBuffer binding first.
+
+#ifndef INSTANCE_DATA_GLSL
+#define INSTANCE_DATA_GLSL
+
+#ifndef INSTANCE_DATA_BINDING
+#error "Define INSTANCE_DATA_BINDING before including instance_data.glsl"
+#endif
+
+layout(std430, set = 0, binding = INSTANCE_DATA_BINDING) readonly buffer InstanceBuffer {
+    uvec4 instance_words[];
+};
+
+const uint DRAW_VALUE_MASK = 0xFFFFFFu; // Low 24 bits of a packed draw word, DrawFlags above
+
+uvec2 load_draw_instance(uint slot) {
+    uvec4 w = instance_words[1 + (slot >> 1)];
+    return (slot & 1u) == 0u ? w.xy : w.zw;
+}
+
+mat4 load_instance_transform(uint instance) {
+    uint base = instance_words[0].x + instance * 3;
+    vec4 r0 = uintBitsToFloat(instance_words[base]);
+    vec4 r1 = uintBitsToFloat(instance_words[base + 1]);
+    vec4 r2 = uintBitsToFloat(instance_words[base + 2]);
+    return mat4(vec4(r0.x, r1.x, r2.x, 0.0), vec4(r0.y, r1.y, r2.y, 0.0), vec4(r0.z, r1.z, r2.z, 0.0), vec4(r0.w, r1.w, r2.w, 1.0));
+}
+
+#endif
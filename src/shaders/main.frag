@@ -26,12 +26,38 @@ layout(binding = 0) uniform UniformBufferObject {
 	uint reversed_z;
 	float shadow_bias_constant;
 	float shadow_bias_slope;
-	uint padding[1];
+	uint local_light_count;
+	uint debug_light_clusters;
+	uvec4 cluster_dims;  // x, y, z, max lights per cluster
+	vec4 cluster_depth;  // near, far, log scale, log bias
+	vec4 cluster_screen; // width, height, 1 / width, 1 / height
 } ubo;
 
 layout(binding = 1) uniform sampler2D tex_samplers[];
 layout(binding = 2) uniform sampler2DArrayShadow shadow_map;
 
+struct LocalLight {
+    vec3 position;
+    float range;
+    vec3 color;
+    float intensity;
+    vec3 direction;
+    float spot_cos_outer;
+    float spot_cos_inner;
+    uint type; // 0: point, 1: spot
+    uint padding[2];
+};
+
+layout(std430, binding = 8) readonly buffer LocalLightBuffer {
+    LocalLight local_lights[];
+};
+
+// Header {totalRefs, overflowClusters, maxLightsInCluster, activeClusters}, one count per cluster, then light indices
+layout(std430, binding = 9) readonly buffer LightClusterGrid {
+    uvec4 cluster_header;
+    uint cluster_data[];
+};
+
 const float PI = 3.14159265359;
 
 // ACES 电影级色调映射
@@ -75,6 +101,45 @@ vec3 FresnelSchlick(float cosTheta, vec3 F0) {
     return F0 + (1.0 - F0) * pow(clamp(1.0 - cosTheta, 0.0, 1.0), 5.0);
 }
 
+// Screen tile x exponential depth slice, see light_cluster_assign.comp
+uint LightClusterIndex(vec2 pixel, float view_depth) {
+    uvec3 dims = ubo.cluster_dims.xyz;
+    float slice = floor(log(max(view_depth, ubo.cluster_depth.x)) * ubo.cluster_depth.z + ubo.cluster_depth.w);
+    uint z = uint(clamp(slice, 0.0, float(dims.z - 1u)));
+    uvec2 tile = min(uvec2(pixel * ubo.cluster_screen.zw * vec2(dims.xy)), dims.xy - 1u);
+    return tile.x + dims.x * (tile.y + dims.y * z);
+}
+
+// Point / spot light, windowed inverse square falloff reaching zero at range
+vec3 EvaluateLocalLight(LocalLight light, vec3 world_pos, vec3 N, vec3 V, vec3 albedo, vec3 F0, float metallic, float roughness) {
+    vec3 to_light = light.position - world_pos;
+    float dist_sq = dot(to_light, to_light);
+    float range_sq = light.range * light.range;
+    if (dist_sq >= range_sq)
+        return vec3(0.0);
+
+    vec3 L = to_light * inversesqrt(max(dist_sq, 1e-8));
+    float ratio = dist_sq / range_sq;
+    float window = clamp(1.0 - ratio * ratio, 0.0, 1.0);
+    float attenuation = window * window / max(dist_sq, 0.01);
+    if (light.type == 1u) {
+        attenuation *= smoothstep(light.spot_cos_outer, light.spot_cos_inner, dot(-L, light.direction));
+    }
+
+    float NdotL = max(dot(N, L), 0.0);
+    if (attenuation * NdotL <= 0.0)
+        return vec3(0.0);
+
+    vec3 H = normalize(V + L);
+    float NDF = DistributionGGX(N, H, roughness);
+    float G   = GeometrySmith(N, V, L, roughness);
+    vec3 F    = FresnelSchlick(max(dot(H, V), 0.0), F0);
+    vec3 specular = (NDF * G * F) / (4.0 * max(dot(N, V), 0.0) * NdotL + 0.0001);
+    vec3 kD = (vec3(1.0) - F) * (1.0 - metallic);
+
+    return (kD * albedo / PI + specular) * light.color * light.intensity * attenuation * NdotL;
+}
+
 
 vec2 poissonDisk[16] = vec2[]( 
    vec2( -0.94201624, -0.39906216 ), 
@@ -241,6 +306,18 @@ void main() {
     vec3 ambient = vec3(ubo.ambient_strength) * albedo * ao;
     vec3 color = ambient + Lo;
 
+    // Clustered point / spot lights
+    if (ubo.local_light_count > 0u) {
+        float view_depth = -(ubo.view * vec4(frag_world_pos, 1.0)).z;
+        uint cluster = LightClusterIndex(gl_FragCoord.xy, view_depth);
+        uint cluster_count = ubo.cluster_dims.x * ubo.cluster_dims.y * ubo.cluster_dims.z;
+        uint cluster_lights = cluster_data[cluster];
+        uint list_base = cluster_count + cluster * ubo.cluster_dims.w;
+        for (uint i = 0u; i < cluster_lights; ++i) {
+            color += EvaluateLocalLight(local_lights[cluster_data[list_base + i]], frag_world_pos, N, V, albedo, F0, metallic, roughness);
+        }
+    }
+
     // [DEBUG] Toggle this to visualize cascades
     if (ubo.debug_cascades > 0) {
         int debugLayer = -1;
@@ -0,0 +1,15 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : enable
+
+layout(location = 0) in vec2 frag_tex_coord;
+layout(location = 1) flat in uint frag_material_id;
+
+layout(binding = 1) uniform sampler2D tex_samplers[];
+
+void main() {
+    float alpha = texture(tex_samplers[nonuniformEXT(frag_material_id)], frag_tex_coord).a;
+
+    if (alpha < 0.5) {
+        discard;
+    }
+}
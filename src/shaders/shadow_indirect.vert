@@ -0,0 +1,29 @@
+#version 450
+#extension GL_GOOGLE_include_directive : require
+
+// Shadow vertex shader for the indirect-count path: model matrix and material come from
+// the GlobalInstanceData buffer (firstInstance written by shadow_cull.comp).
+
+layout(location = 0) in vec3 in_position;
+layout(location = 3) in vec2 in_tex_coord;
+
+layout(location = 0) out vec2 frag_tex_coord;
+layout(location = 1) flat out uint frag_material_id;
+
+layout(push_constant) uniform PushConsts {
+    mat4 light_view_proj;
+    mat4 model; // unused, kept for layout compatibility with shadow.vert
+    vec4 light_dir;
+    uint material_id;
+} push_consts;
+
+#define INSTANCE_DATA_BINDING 3
+#include "instance_data.glsl"
+
+void main() {
+    uvec2 draw_instance = load_draw_instance(uint(gl_InstanceIndex));
+    mat4 model = load_instance_transform(draw_instance.x);
+    gl_Position = push_consts.light_view_proj * model * vec4(in_position, 1.0);
+    frag_tex_coord = in_tex_coord;
+    frag_material_id = draw_instance.y & DRAW_VALUE_MASK;
+}
@@ -0,0 +1,15 @@
+#version 450
+
+// shadow.vert for materials without alpha testing: reads only the position stream (binding 0)
+layout(location = 0) in vec3 in_position;
+
+layout(push_constant) uniform PushConsts {
+    mat4 light_view_proj;
+	mat4 model;
+	vec4 light_dir;
+	uint material_id;
+} push_consts;
+
+void main() {
+    gl_Position = push_consts.light_view_proj * push_consts.model * vec4(in_position, 1.0);
+}
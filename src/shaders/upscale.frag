@@ -0,0 +1,47 @@
+#version 460
+
+// Dynamic resolution composite. The main view only covers the top-left uv_scale part of the
+// scene color target; it is stretched over the backbuffer with bilinear filtering, then sharpened
+// with a contrast-adaptive cross filter (less sharpening where the neighbourhood already has contrast).
+
+layout (location = 0) in vec2 in_uv;
+layout (location = 0) out vec4 out_color;
+
+layout (set = 0, binding = 1) uniform sampler2D tex_samplers[];
+
+layout (push_constant) uniform PushConstants {
+    vec2 uv_scale;
+    vec2 uv_max;
+    vec2 texel_size;
+    float sharpness;
+    uint texture_id;
+} pc;
+
+vec3 sample_source(vec2 uv) {
+    return textureLod(tex_samplers[pc.texture_id], clamp(uv, pc.texel_size * 0.5, pc.uv_max), 0.0).rgb;
+}
+
+void main() {
+    vec2 uv = in_uv * pc.uv_scale;
+    vec3 center = sample_source(uv);
+
+    if (pc.sharpness <= 0.0) {
+        out_color = vec4(center, 1.0);
+        return;
+    }
+
+    vec3 north = sample_source(uv + vec2(0.0, -pc.texel_size.y));
+    vec3 south = sample_source(uv + vec2(0.0, pc.texel_size.y));
+    vec3 west = sample_source(uv + vec2(-pc.texel_size.x, 0.0));
+    vec3 east = sample_source(uv + vec2(pc.texel_size.x, 0.0));
+
+    vec3 min_rgb = min(center, min(min(north, south), min(west, east)));
+    vec3 max_rgb = max(center, max(max(north, south), max(west, east)));
+
+    // Headroom to the [0, 1] range relative to the local maximum drives the amount
+    vec3 amount = sqrt(clamp(min(min_rgb, 1.0 - max_rgb) / max(max_rgb, vec3(1e-4)), 0.0, 1.0));
+    vec3 weight = -amount * mix(0.125, 0.2, pc.sharpness);
+
+    vec3 color = (center + (north + south + west + east) * weight) / (1.0 + 4.0 * weight);
+    out_color = vec4(clamp(color, 0.0, 1.0), 1.0);
+}
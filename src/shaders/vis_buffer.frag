@@ -0,0 +1,22 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : enable
+
+layout(location = 0) in vec2 frag_tex_coord;
+layout(location = 1) flat in uint frag_material_id;
+layout(location = 2) flat in uint frag_draw_id;
+
+// x: draw slot + 1 (0 = background), y: triangle index inside the draw
+layout(location = 0) out uvec2 out_visibility;
+
+layout(binding = 1) uniform sampler2D tex_samplers[];
+
+void main() {
+    // Same alpha test as main.frag, material 0 is drawn opaque
+    if (frag_material_id > 0) {
+        float alpha = texture(tex_samplers[nonuniformEXT(frag_material_id)], frag_tex_coord).a;
+        if (alpha < 0.5)
+            discard;
+    }
+
+    out_visibility = uvec2(frag_draw_id + 1, uint(gl_PrimitiveID));
+}
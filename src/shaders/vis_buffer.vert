@@ -0,0 +1,45 @@
+#version 450
+#extension GL_GOOGLE_include_directive : require
+
+// Visibility buffer raster: same transform as main.vert, only the UV survives for the alpha test.
+// gl_InstanceIndex is the sorted draw slot (firstInstance written by hiz_cull.comp).
+
+layout(location = 0) in vec3 in_position;
+layout(location = 3) in vec2 in_tex_coord;
+
+layout(location = 0) out vec2 frag_tex_coord;
+layout(location = 1) flat out uint frag_material_id;
+layout(location = 2) flat out uint frag_draw_id;
+
+layout(binding = 0) uniform UniformBufferObject {
+    mat4 view;
+    mat4 proj;
+	// [CSM]
+	mat4 cascade_view_proj[4];
+	vec4 cascade_split_depths;
+
+    vec3 cam_pos;
+    vec3 light_dir;
+	vec3 light_color;
+    float light_intensity;
+    float ambient_strength;
+	uint cascade_count;
+    uint debug_cascades;
+	uint reversed_z;
+	uint padding[3];
+} ubo;
+
+#define INSTANCE_DATA_BINDING 3
+#include "instance_data.glsl"
+
+void main() {
+    uvec2 draw_instance = load_draw_instance(uint(gl_InstanceIndex));
+    mat4 model = load_instance_transform(draw_instance.x);
+    vec4 world_pos = model * vec4(in_position, 1.0);
+
+    frag_tex_coord = in_tex_coord;
+    frag_material_id = draw_instance.y & DRAW_VALUE_MASK;
+    frag_draw_id = gl_InstanceIndex;
+
+    gl_Position = ubo.proj * ubo.view * world_pos;
+}
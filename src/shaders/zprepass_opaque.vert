@@ -0,0 +1,32 @@
+#version 450
+
+// zprepass.vert for materials without alpha testing: reads only the position stream (binding 0)
+layout(location = 0) in vec3 in_position;
+
+layout(binding = 0) uniform UniformBufferObject {
+    mat4 view;
+    mat4 proj;
+    mat4 cascade_view_proj[4];
+    vec4 cascade_split_depths;
+
+    vec3 cam_pos;
+    vec3 light_dir;
+    vec3 light_color;
+    float light_intensity;
+    float ambient_strength;
+    uint cascade_count;
+    uint debug_cascades;
+    uint reversed_z;
+    uint padding[3];
+} ubo;
+
+layout(push_constant) uniform PushConsts {
+    mat4 model;
+    uint material_id;
+    uint padding[3];
+} push_consts;
+
+void main() {
+    vec4 world_pos = push_consts.model * vec4(in_position, 1.0);
+    gl_Position = ubo.proj * ubo.view * world_pos;
+}
@@ -16,15 +16,10 @@
 #include <stacktrace>
 #endif
 
-#ifdef TRACY_ENABLE
-#include <tracy/Tracy.hpp>
 #include <stdio.h>
-#else
-	// Define empty macros to avoid Tracy calls when disabled
-#define ZoneScoped
-#define ZoneScopedN(x)
-#define FrameMark
-#endif
+
+// ZoneScoped feeds the built-in profiler, and Tracy when TRACY_ENABLE is defined
+#include "src/core/bud.profiler.hpp"
 
 #include "src/threading/bud.threading.hpp"
 
@@ -70,6 +65,7 @@ void Fiber::reset(std::move_only_function<void()>&& w, Counter* c, void (*entry_
 	next_pool = nullptr;
 	pending_wait_counter = nullptr;
 	target_thread_index = -1;
+	profile_zones.depth = 0;
 
 #if defined(_DEBUG)
 	debug_name = nullptr;
@@ -214,6 +210,7 @@ size_t TaskScheduler::get_thread_count() const {
 void TaskScheduler::init_main_thread_worker() {
 	t_worker_index = 0;
 	t_scheduler = this;
+	bud::profiler::set_thread_name("Main Worker");
 }
 
 
@@ -390,7 +387,9 @@ void TaskScheduler::execute_task(Fiber* f) {
 	ZoneScoped;
 
 	t_current_fiber = f;
+	bud::profiler::on_fiber_enter(&f->profile_zones);
 	bud_switch_context(&t_worker_rsp, f->rsp);
+	bud::profiler::on_fiber_leave(&f->profile_zones);
 
 	t_current_fiber = nullptr;
 
@@ -449,12 +448,13 @@ void TaskScheduler::worker_loop(size_t index, std::stop_token st) {
     t_worker_index = static_cast<int>(index);
 	t_scheduler = this;
 
-#ifdef TRACY_ENABLE
 	char thread_name[32];
 	if (index == 0)
 		std::snprintf(thread_name, sizeof(thread_name), "Main Worker");
 	else
 		std::snprintf(thread_name, sizeof(thread_name), "Worker %zu", index);
+	bud::profiler::set_thread_name(thread_name);
+#ifdef TRACY_ENABLE
 	tracy::SetThreadName(thread_name);
 #endif
 
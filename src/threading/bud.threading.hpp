@@ -11,6 +11,8 @@
 #include <mutex>
 #include <deque>
 
+#include "src/core/bud.profiler.hpp"
+
 namespace bud::threading {
 	struct Fiber;
 	class TaskScheduler;
@@ -57,6 +59,9 @@ namespace bud::threading {
 		// Solved: "Double Run" Issue
 		Counter* pending_wait_counter = nullptr;
 
+		// Zones opened on this fiber, carried across worker threads when it suspends
+		bud::profiler::ZoneStack profile_zones;
+
 		// Lightweight debug Info 
 #if defined(_DEBUG)
 		const char* debug_name = nullptr;
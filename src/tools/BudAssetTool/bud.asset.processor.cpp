@@ -12,6 +12,8 @@
 #include <optional>
 
 #include "../bud_tool_support/bud_tool_support.hpp"
+#include "bud.shader.cache.hpp"
+#include "bud.budmesh.writer.hpp"
 #if defined(__has_include)
 # if __has_include(<spirv_reflect.h>)
 #  ifndef SPIRV_REFLECT_USE_SYSTEM_SPIRV_H
@@ -31,24 +33,9 @@
 // note: avoid depending on bud::io; use local helpers above
 
 #if defined(BUD_HAVE_SPIRV_REFLECT)
-static bool compile_shader_with_glslc(const std::filesystem::path& src, const std::filesystem::path& out_spv);
 static bool reflect_and_validate_spv(const std::filesystem::path& spv_path);
 #include <sstream>
 
-static bool compile_shader_with_glslc(const std::filesystem::path& src, const std::filesystem::path& out_spv) {
-    // Use process runner to capture output instead of manual redirection
-    std::ostringstream cmd;
-    cmd << "glslc " << '"' << src.string() << '"' << " -o " << '"' << out_spv.string() << '"';
-    auto res = bud::tool_support::run_process_capture(cmd.str());
-    if (!res.stderr_str.empty()) {
-        // write compiler log next to spv
-        std::filesystem::path log_path = out_spv;
-        log_path += ".log";
-        bud::tool_support::write_text_file_atomic(log_path, res.stderr_str);
-    }
-    return res.exit_code == 0;
-}
-
 static bool reflect_and_validate_spv(const std::filesystem::path& spv_path) {
     // Minimal reflection validation: attempt to create and destroy a module
     std::ifstream in(spv_path, std::ios::binary | std::ios::ate);
@@ -67,7 +54,7 @@ static bool reflect_and_validate_spv(const std::filesystem::path& spv_path) {
 
 namespace bud::tool {
 
-    bool AssetProcessor::process_gltf_to_budmesh(const std::string& input_path, const std::string& output_path) {
+    bool AssetProcessor::process_gltf_to_budmesh(const std::string& input_path, const std::string& output_path, bool cluster_lod) {
         Assimp::Importer importer;
         const aiScene* scene = importer.ReadFile(input_path, 
             aiProcess_Triangulate | 
@@ -89,17 +76,8 @@ namespace bud::tool {
         std::cout << "[BudAssetTool] Original Assimp Submesh Count: " << scene->mNumMeshes << std::endl;
 
         // 1. Process all meshes and generate meshlets per submesh
-        std::vector<asset::Vertex> all_vertices;
-        std::vector<uint32_t> all_indices;
-        std::vector<asset::MeshletDescriptor> all_meshlets;
-        std::vector<asset::MeshletCullData> all_cull_data;
-        std::vector<uint32_t> all_meshlet_vertices;
-        std::vector<uint32_t> all_meshlet_triangles;
-        std::vector<asset::SubMeshDescriptor> submeshes;
-
-        const size_t max_vertices = 64;
-        const size_t max_triangles = 128;
-        const float cone_weight = 0.5f;
+        BudMeshWriter writer;
+        writer.set_cluster_lod(cluster_lod);
 
         std::string input_path_str = std::string(input_path);
         std::string base_dir = "";
@@ -192,378 +170,385 @@ namespace bud::tool {
 
             if (group_indices.empty()) continue;
 
-            // Global stats for this group relative to file
-            uint32_t group_base_vertex = (uint32_t)all_vertices.size();
-            uint32_t group_base_index = (uint32_t)all_indices.size();
-            uint32_t group_base_meshlet = (uint32_t)all_meshlets.size();
-
-            // Meshoptimizer processing
-            std::vector<uint32_t> optimized_indices(group_indices.size());
-            meshopt_optimizeVertexCache(optimized_indices.data(), group_indices.data(), group_indices.size(), group_vertices.size());
-
-            // Append to global buffers MUST BE AFTER OPTIMIZATION AND USE OPTIMIZED_INDICES
-            for (const auto& v : group_vertices) all_vertices.push_back(v);
-            for (auto idx : optimized_indices) all_indices.push_back(group_base_vertex + idx);
-
-            size_t max_meshlets = meshopt_buildMeshletsBound(optimized_indices.size(), max_vertices, max_triangles);
-            std::vector<meshopt_Meshlet> local_meshlets(max_meshlets);
-            std::vector<unsigned int> local_meshlet_vertices(max_meshlets * max_vertices);
-            std::vector<unsigned char> local_meshlet_triangles(max_meshlets * max_triangles * 3);
-
-            size_t meshlet_count = meshopt_buildMeshlets(local_meshlets.data(), local_meshlet_vertices.data(), local_meshlet_triangles.data(),
-                                                         optimized_indices.data(), optimized_indices.size(), &group_vertices[0].position[0], group_vertices.size(), sizeof(asset::Vertex),
-                                                         max_vertices, max_triangles, cone_weight);
-
-            local_meshlets.resize(meshlet_count);
-
-            asset::SubMeshDescriptor sub_desc = {};
-            sub_desc.index_start = group_base_index;
-            sub_desc.index_count = (uint32_t)group_indices.size();
-            sub_desc.meshlet_start = group_base_meshlet;
-            sub_desc.meshlet_count = (uint32_t)meshlet_count;
-            sub_desc.material_id = mapped_tex_idx;
-            
-            // Compute SubMesh AABB
-            sub_desc.aabb_min[0] = sub_desc.aabb_min[1] = sub_desc.aabb_min[2] = std::numeric_limits<float>::max();
-            sub_desc.aabb_max[0] = sub_desc.aabb_max[1] = sub_desc.aabb_max[2] = -std::numeric_limits<float>::max();
-            for (const auto& v : group_vertices) {
-                sub_desc.aabb_min[0] = std::min(sub_desc.aabb_min[0], v.position[0]);
-                sub_desc.aabb_min[1] = std::min(sub_desc.aabb_min[1], v.position[1]);
-                sub_desc.aabb_min[2] = std::min(sub_desc.aabb_min[2], v.position[2]);
-                sub_desc.aabb_max[0] = std::max(sub_desc.aabb_max[0], v.position[0]);
-                sub_desc.aabb_max[1] = std::max(sub_desc.aabb_max[1], v.position[1]);
-                sub_desc.aabb_max[2] = std::max(sub_desc.aabb_max[2], v.position[2]);
-            }
-            submeshes.push_back(sub_desc);
+            writer.add_submesh(group_vertices, group_indices, mapped_tex_idx);
+        }
+
+        return writer.write(output_path, texture_paths);
+    }
 
-            for (size_t i = 0; i < meshlet_count; ++i) {
-                meshopt_Meshlet& m = local_meshlets[i];
-                meshopt_optimizeMeshlet(&local_meshlet_vertices[m.vertex_offset], &local_meshlet_triangles[m.triangle_offset], m.triangle_count, m.vertex_count);
+} // namespace bud::tool
 
-                asset::MeshletDescriptor desc = {};
-                desc.vertex_offset = (uint32_t)all_meshlet_vertices.size();
-                desc.vertex_count = m.vertex_count;
-                desc.triangle_offset = (uint32_t)all_meshlet_triangles.size();
-                desc.triangle_count = m.triangle_count;
-                all_meshlets.push_back(desc);
+#include <string>
 
-                for (uint32_t v_idx = 0; v_idx < m.vertex_count; ++v_idx) {
-                    all_meshlet_vertices.push_back(group_base_vertex + local_meshlet_vertices[m.vertex_offset + v_idx]);
-                }
-                for (uint32_t t_idx = 0; t_idx < m.triangle_count * 3; ++t_idx) {
-                    all_meshlet_triangles.push_back(local_meshlet_triangles[m.triangle_offset + t_idx]);
-                }
+bool bud::tool::AssetProcessor::compile_shaders_in_directory(const std::string& shader_dir, const ShaderCacheOptions& options) {
+    return compile_shader_directory(shader_dir, options);
+}
 
-                meshopt_Bounds mbounds = meshopt_computeMeshletBounds(&local_meshlet_vertices[m.vertex_offset], &local_meshlet_triangles[m.triangle_offset],
-                                                                    m.triangle_count, &group_vertices[0].position[0], group_vertices.size(), sizeof(asset::Vertex));
-                asset::MeshletCullData cull = {};
-                cull.bounding_sphere[0] = mbounds.center[0];
-                cull.bounding_sphere[1] = mbounds.center[1];
-                cull.bounding_sphere[2] = mbounds.center[2];
-                cull.bounding_sphere[3] = mbounds.radius;
-                cull.cone_axis[0] = mbounds.cone_axis_s8[0];
-                cull.cone_axis[1] = mbounds.cone_axis_s8[1];
-                cull.cone_axis[2] = mbounds.cone_axis_s8[2];
-                cull.cone_cutoff = mbounds.cone_cutoff_s8;
-                all_cull_data.push_back(cull);
+#if !defined(BUD_HAVE_SPIRV_REFLECT)
+bool bud::tool::AssetProcessor::validate_shaders_in_directory(const std::string& shader_dir, const std::string& report_path, unsigned int /*max_workers*/, const std::string& /*cache_dir*/) {
+    (void)shader_dir; (void)report_path;
+    std::cerr << "[BudAssetTool] SPIRV-Reflect not available in this build. Install spirv-reflect via vcpkg to enable validation." << std::endl;
+    return false;
+}
+#else
+// Report entry fields of one compiled shader (everything except path / compiled)
+static nlohmann::json reflect_shader(const std::filesystem::path& spv_path) {
+    nlohmann::json entry;
+    entry["warnings"] = nlohmann::json::array();
+    entry["errors"] = nlohmann::json::array();
+    entry["bindings"] = nlohmann::json::array();
+    entry["inputs"] = nlohmann::json::array();
+    entry["outputs"] = nlohmann::json::array();
+    entry["push_constants"] = nlohmann::json::array();
+
+    auto spv_data_opt = bud::tool_support::read_binary_file(spv_path);
+    if (!spv_data_opt) {
+        std::string msg = std::string("Failed to read compiled SPV: ") + spv_path.string();
+        std::cerr << "[BudAssetTool] " << msg << std::endl;
+        entry["errors"].push_back(msg);
+        return entry;
+    }
+    std::vector<char> data = *spv_data_opt;
+
+    SpvReflectShaderModule module;
+    SpvReflectResult res = spvReflectCreateShaderModule(data.size(), data.data(), &module);
+    if (res != SPV_REFLECT_RESULT_SUCCESS) {
+        std::string msg = std::string("SPIRV-Reflect: failed to create module for ") + spv_path.string();
+        std::cerr << "[BudAssetTool] " << msg << std::endl;
+        entry["errors"].push_back(msg);
+        return entry;
+    }
+
+    entry["stage"] = module.shader_stage;
+
+    uint32_t set_count = 0;
+    res = spvReflectEnumerateDescriptorSets(&module, &set_count, nullptr);
+    if (res == SPV_REFLECT_RESULT_SUCCESS && set_count > 0) {
+        std::vector<SpvReflectDescriptorSet*> sets(set_count);
+        res = spvReflectEnumerateDescriptorSets(&module, &set_count, sets.data());
+        if (res == SPV_REFLECT_RESULT_SUCCESS) {
+            for (uint32_t si = 0; si < set_count; ++si) {
+                SpvReflectDescriptorSet* set = sets[si];
+                nlohmann::json set_json;
+                set_json["set"] = set->set;
+                set_json["bindings"] = nlohmann::json::array();
+                for (uint32_t bi = 0; bi < set->binding_count; ++bi) {
+                    const SpvReflectDescriptorBinding* binding = set->bindings[bi];
+                    nlohmann::json b;
+                    b["set"] = set->set;
+                    b["binding"] = binding->binding;
+                    b["descriptor_type"] = binding->descriptor_type;
+                    b["array_dims"] = binding->array.dims_count > 0 ? binding->array.dims[0] : 0;
+                    b["name"] = binding->name ? binding->name : "";
+                    set_json["bindings"].push_back(b);
+                }
+                entry["bindings"].push_back(set_json);
             }
         }
+    }
 
-        // 2. Serialize to .budmesh
-        std::ofstream out(output_path, std::ios::binary);
-        if (!out.is_open()) return false;
-
-        static_assert(sizeof(asset::BudMeshHeader) == asset::MESH_HEADER_SIZE, "BudMeshHeader size mismatch!");
-        static_assert(offsetof(asset::BudMeshHeader, vertex_offset) == asset::MESH_HEADER_VERTEX_OFFSET, "BudMeshHeader alignment mismatch!");
-        static_assert(offsetof(asset::BudMeshHeader, submesh_count) == asset::MESH_HEADER_SUBMESH_COUNT_OFFSET, "BudMeshHeader submesh_count offset mismatch!");
-        static_assert(sizeof(asset::SubMeshDescriptor) == asset::SUBMESH_DESCRIPTOR_SIZE, "SubMeshDescriptor size mismatch!");
-
-        asset::BudMeshHeader header = {};
-        header.magic = asset::MESH_MAGIC;
-        header.version = 3;
-        header.total_vertices = (uint32_t)all_vertices.size();
-        header.total_indices = (uint32_t)all_indices.size();
-        header.meshlet_count = (uint32_t)all_meshlets.size();
-        header.submesh_count = (uint32_t)submeshes.size();
-
-        // Textures already processed at the start
-        header.texture_count = (uint32_t)texture_paths.size();
-
-        header.aabb_min[0] = header.aabb_min[1] = header.aabb_min[2] = std::numeric_limits<float>::max();
-        header.aabb_max[0] = header.aabb_max[1] = header.aabb_max[2] = -std::numeric_limits<float>::max();
-        for (const auto& v : all_vertices) {
-            header.aabb_min[0] = std::min(header.aabb_min[0], v.position[0]);
-            header.aabb_min[1] = std::min(header.aabb_min[1], v.position[1]);
-            header.aabb_min[2] = std::min(header.aabb_min[2], v.position[2]);
-            header.aabb_max[0] = std::max(header.aabb_max[0], v.position[0]);
-            header.aabb_max[1] = std::max(header.aabb_max[1], v.position[1]);
-            header.aabb_max[2] = std::max(header.aabb_max[2], v.position[2]);
+    uint32_t input_count = 0;
+    if (spvReflectEnumerateInputVariables(&module, &input_count, nullptr) == SPV_REFLECT_RESULT_SUCCESS && input_count > 0) {
+        std::vector<SpvReflectInterfaceVariable*> inputs(input_count);
+        if (spvReflectEnumerateInputVariables(&module, &input_count, inputs.data()) == SPV_REFLECT_RESULT_SUCCESS) {
+            for (uint32_t ii = 0; ii < input_count; ++ii) {
+                SpvReflectInterfaceVariable* v = inputs[ii];
+                nlohmann::json iv;
+                iv["location"] = v->location;
+                iv["name"] = v->name ? v->name : "";
+                iv["built_in"] = v->built_in;
+                iv["format"] = v->format;
+                entry["inputs"].push_back(iv);
+            }
         }
+    }
 
-        size_t current_offset = sizeof(header);
-        header.vertex_offset = current_offset;
-        current_offset += all_vertices.size() * sizeof(asset::Vertex);
-        header.index_offset = current_offset;
-        current_offset += all_indices.size() * sizeof(uint32_t);
-        header.meshlet_offset = current_offset;
-        current_offset += all_meshlets.size() * sizeof(asset::MeshletDescriptor);
-        header.vertex_index_offset = current_offset;
-        current_offset += all_meshlet_vertices.size() * sizeof(uint32_t);
-        header.meshlet_index_offset = current_offset;
-        current_offset += all_meshlet_triangles.size() * sizeof(uint32_t);
-        header.cull_data_offset = current_offset;
-        current_offset += all_cull_data.size() * sizeof(asset::MeshletCullData);
-        header.submesh_offset = current_offset;
-        current_offset += submeshes.size() * sizeof(asset::SubMeshDescriptor);
-        header.texture_offset = current_offset;
-        // Total size of all strings including null terminators
-        for (const auto& path : texture_paths) {
-            current_offset += path.length() + 1;
+    uint32_t output_count = 0;
+    if (spvReflectEnumerateOutputVariables(&module, &output_count, nullptr) == SPV_REFLECT_RESULT_SUCCESS && output_count > 0) {
+        std::vector<SpvReflectInterfaceVariable*> outputs(output_count);
+        if (spvReflectEnumerateOutputVariables(&module, &output_count, outputs.data()) == SPV_REFLECT_RESULT_SUCCESS) {
+            for (uint32_t oi = 0; oi < output_count; ++oi) {
+                SpvReflectInterfaceVariable* v = outputs[oi];
+                nlohmann::json ov;
+                ov["location"] = v->location;
+                ov["name"] = v->name ? v->name : "";
+                ov["built_in"] = v->built_in;
+                ov["format"] = v->format;
+                entry["outputs"].push_back(ov);
+            }
         }
+    }
 
-        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
-        out.write(reinterpret_cast<const char*>(all_vertices.data()), all_vertices.size() * sizeof(asset::Vertex));
-        out.write(reinterpret_cast<const char*>(all_indices.data()), all_indices.size() * sizeof(uint32_t));
-        out.write(reinterpret_cast<const char*>(all_meshlets.data()), all_meshlets.size() * sizeof(asset::MeshletDescriptor));
-        out.write(reinterpret_cast<const char*>(all_meshlet_vertices.data()), all_meshlet_vertices.size() * sizeof(uint32_t));
-        out.write(reinterpret_cast<const char*>(all_meshlet_triangles.data()), all_meshlet_triangles.size() * sizeof(uint32_t));
-        out.write(reinterpret_cast<const char*>(all_cull_data.data()), all_cull_data.size() * sizeof(asset::MeshletCullData));
-        out.write(reinterpret_cast<const char*>(submeshes.data()), submeshes.size() * sizeof(asset::SubMeshDescriptor));
-        
-        for (const auto& path : texture_paths) {
-            out.write(path.c_str(), path.length() + 1);
+    uint32_t pcb_count = 0;
+    if (spvReflectEnumeratePushConstantBlocks(&module, &pcb_count, nullptr) == SPV_REFLECT_RESULT_SUCCESS && pcb_count > 0) {
+        std::vector<SpvReflectBlockVariable*> pcbs(pcb_count);
+        if (spvReflectEnumeratePushConstantBlocks(&module, &pcb_count, pcbs.data()) == SPV_REFLECT_RESULT_SUCCESS) {
+            for (uint32_t pi = 0; pi < pcb_count; ++pi) {
+                SpvReflectBlockVariable* b = pcbs[pi];
+                nlohmann::json pjson;
+                pjson["size"] = b->size;
+                pjson["name"] = b->name ? b->name : "";
+                entry["push_constants"].push_back(pjson);
+            }
         }
-
-        std::cout << "[BudAssetTool] Successfully exported " << header.submesh_count << " submeshes, " << header.meshlet_count << " meshlets, and " << header.texture_count << " textures to " << output_path << std::endl;
-        return true;
     }
 
-} // namespace bud::tool
-
-#include <string>
-
-#if !defined(BUD_HAVE_SPIRV_REFLECT)
-bool bud::tool::AssetProcessor::validate_shaders_in_directory(const std::string& shader_dir, const std::string& report_path, unsigned int /*max_workers*/) {
-    (void)shader_dir; (void)report_path;
-    std::cerr << "[BudAssetTool] SPIRV-Reflect not available in this build. Install spirv-reflect via vcpkg to enable validation." << std::endl;
-    return false;
+    spvReflectDestroyShaderModule(&module);
+    return entry;
 }
-#else
-bool bud::tool::AssetProcessor::validate_shaders_in_directory(const std::string& shader_dir, const std::string& report_path, unsigned int max_workers) {
+
+bool bud::tool::AssetProcessor::validate_shaders_in_directory(const std::string& shader_dir, const std::string& report_path, unsigned int max_workers, const std::string& cache_dir) {
     namespace fs = std::filesystem;
     fs::path dir(shader_dir);
-    // Ensure tmp dir exists under repo for temporary compiler outputs
-    fs::path tmp_dir = std::filesystem::current_path() / "tmp";
-    std::error_code tmp_ec;
-    fs::create_directories(tmp_dir, tmp_ec);
     if (!fs::exists(dir) || !fs::is_directory(dir)) {
         std::cerr << "[BudAssetTool] Shader directory does not exist: " << shader_dir << std::endl;
         return false;
     }
 
+    // Compiled SPIR-V and reflection results persist in the cache, only changed shaders are redone
+    ShaderCacheOptions options;
+    options.cache_dir = cache_dir.empty() ? std::filesystem::current_path() / "tmp" / "shader_cache" : fs::path(cache_dir);
+    options.workers = max_workers;
+    ShaderCache cache(options);
+    cache.load();
+
     std::vector<std::string> exts = { ".vert", ".frag", ".comp", ".geom", ".tesc", ".tese" };
+    std::vector<ShaderJob> jobs;
+    for (const auto& path : ShaderCache::collect_sources(dir, exts)) {
+        jobs.push_back({ path, options.cache_dir / "spv" / (fs::relative(path, dir).generic_string() + ".spv") });
+    }
+
+    auto reflect = [](const ShaderJob& job, const fs::path& spv, const std::string& log) -> std::string {
+        std::cout << "[BudAssetTool] Validating shader: " << job.source << std::endl;
+        nlohmann::json entry;
+        try {
+            entry = reflect_shader(spv);
+        }
+        catch (const std::exception& e) {
+            entry["errors"] = nlohmann::json::array({ std::string("Exception: ") + e.what() });
+        }
+        if (!log.empty()) entry["compiler_output"] = log;
+        return entry.dump();
+    };
+
+    ShaderCacheStats stats;
+    auto results = cache.build(jobs, reflect, stats);
+    cache.save();
+    ShaderCache::print_stats(stats);
+
     nlohmann::json report_json;
     report_json["shaders"] = nlohmann::json::array();
 
-    // Collect shader files
-    std::vector<fs::path> shader_files;
-    for (auto& p : fs::recursive_directory_iterator(dir)) {
-        if (!p.is_regular_file()) continue;
-        fs::path path = p.path();
-        std::string ext = path.extension().string();
-        std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
-        if (std::find(exts.begin(), exts.end(), ext) == exts.end()) continue;
-        shader_files.push_back(path);
+    bool all_ok = true;
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        const auto& result = results[i];
+        nlohmann::json entry;
+        if (result.ok) {
+            entry = nlohmann::json::parse(result.payload, nullptr, false);
+            if (entry.is_discarded()) entry = nlohmann::json::object();
+        } else {
+            entry["errors"] = nlohmann::json::array({ std::string("Failed to compile shader with glslc: ") + jobs[i].source.string() });
+            if (!result.log.empty()) entry["compiler_output"] = result.log;
+            all_ok = false;
+        }
+        entry["path"] = jobs[i].source.string();
+        entry["compiled"] = result.ok;
+        report_json["shaders"].push_back(entry);
     }
 
-    std::atomic<bool> all_ok{true};
-    // Determine worker count: prefer explicit parameter, then env var, then hardware concurrency
-    unsigned int workers = max_workers;
-    if (workers == 0) {
-        // check env var BUD_SHADER_WORKERS or BUD_ASSET_TOOL_WORKERS
-        const char* env = std::getenv("BUD_SHADER_WORKERS");
-        if (!env) env = std::getenv("BUD_ASSET_TOOL_WORKERS");
-        if (env) {
-            try { workers = std::stoul(env); }
-            catch (...) { workers = 0; }
+    report_json["cache"] = {
+        { "shaders", stats.total },
+        { "hits", stats.hits },
+        { "compiled", stats.compiled },
+        { "failed", stats.failed },
+        { "hit_rate", stats.hit_rate() },
+        { "seconds", stats.seconds }
+    };
+
+    if (!report_path.empty()) {
+        std::ofstream out(report_path);
+        if (out.is_open()) {
+            out << report_json.dump(2);
+            out.close();
+        } else {
+            std::cerr << "[BudAssetTool] Failed to write report to " << report_path << std::endl;
         }
     }
-    if (workers == 0) {
-        unsigned int hw = std::thread::hardware_concurrency();
-        workers = hw == 0 ? 1u : hw;
-    }
-    unsigned int max_workers_final = workers;
-    std::cout << "[BudAssetTool] Using " << max_workers_final << " parallel workers for shader validation." << std::endl;
-
-    // Launch tasks in parallel using a simple batch/future approach
-    std::vector<std::future<nlohmann::json>> futures;
-    futures.reserve(shader_files.size());
-
-    for (const auto& path : shader_files) {
-        futures.push_back(std::async(std::launch::async, [path, tmp_dir]() -> nlohmann::json {
-            nlohmann::json entry;
-            entry["path"] = path.string();
-            entry["compiled"] = false;
-            entry["warnings"] = nlohmann::json::array();
-            entry["errors"] = nlohmann::json::array();
-            entry["bindings"] = nlohmann::json::array();
-            entry["inputs"] = nlohmann::json::array();
-            entry["outputs"] = nlohmann::json::array();
-            entry["push_constants"] = nlohmann::json::array();
-
-            try {
-                std::cout << "[BudAssetTool] Validating shader: " << path << std::endl;
-                fs::path out_spv = tmp_dir / (path.filename().string() + std::string(".spv"));
-                bool compiled = compile_shader_with_glslc(path, out_spv);
-                entry["compiled"] = compiled;
-
-                fs::path log_path = tmp_dir / (path.filename().string() + std::string(".spv.log"));
-                if (auto log_data = bud::tool_support::read_binary_file(log_path)) {
-                    std::string compiler_output(log_data->begin(), log_data->end());
-                    entry["compiler_output"] = compiler_output;
-                }
 
-                if (!compiled) {
-                    std::string msg = std::string("Failed to compile shader with glslc: ") + path.string();
-                    std::cerr << "[BudAssetTool] " << msg << std::endl;
-                    entry["errors"].push_back(msg);
-                    // cleanup
-                    std::error_code ec; fs::remove(out_spv, ec); fs::remove(log_path, ec);
-                    return entry;
-                }
+    return all_ok;
+}
+#endif
 
-                auto spv_data_opt = bud::tool_support::read_binary_file(out_spv);
-                if (!spv_data_opt) {
-                    std::string msg = std::string("Failed to read compiled SPV: ") + out_spv.string();
-                    std::cerr << "[BudAssetTool] " << msg << std::endl;
-                    entry["errors"].push_back(msg);
-                    return entry;
-                }
-                std::vector<char> data = *spv_data_opt;
-
-                SpvReflectShaderModule module;
-                SpvReflectResult res = spvReflectCreateShaderModule(data.size(), data.data(), &module);
-                if (res != SPV_REFLECT_RESULT_SUCCESS) {
-                    std::string msg = std::string("SPIRV-Reflect: failed to create module for ") + path.string();
-                    std::cerr << "[BudAssetTool] " << msg << std::endl;
-                    entry["errors"].push_back(msg);
-                    return entry;
-                }
+#include "src/core/bud.compress.hpp"
 
-                entry["stage"] = module.shader_stage;
-
-                uint32_t set_count = 0;
-                res = spvReflectEnumerateDescriptorSets(&module, &set_count, nullptr);
-                if (res == SPV_REFLECT_RESULT_SUCCESS && set_count > 0) {
-                    std::vector<SpvReflectDescriptorSet*> sets(set_count);
-                    res = spvReflectEnumerateDescriptorSets(&module, &set_count, sets.data());
-                    if (res == SPV_REFLECT_RESULT_SUCCESS) {
-                        for (uint32_t si = 0; si < set_count; ++si) {
-                            SpvReflectDescriptorSet* set = sets[si];
-                            nlohmann::json set_json;
-                            set_json["set"] = set->set;
-                            set_json["bindings"] = nlohmann::json::array();
-                            for (uint32_t bi = 0; bi < set->binding_count; ++bi) {
-                                const SpvReflectDescriptorBinding* binding = set->bindings[bi];
-                                nlohmann::json b;
-                                b["set"] = set->set;
-                                b["binding"] = binding->binding;
-                                b["descriptor_type"] = binding->descriptor_type;
-                                b["array_dims"] = binding->array.dims_count > 0 ? binding->array.dims[0] : 0;
-                                b["name"] = binding->name ? binding->name : "";
-                                set_json["bindings"].push_back(b);
-                            }
-                            entry["bindings"].push_back(set_json);
-                        }
-                    }
-                }
+bool bud::tool::AssetProcessor::bundle_shaders(const std::string& shader_dir, const std::string& output_path, const ShaderBundleOptions& options) {
+    namespace fs = std::filesystem;
+    fs::path dir(shader_dir);
+    if (!fs::exists(dir) || !fs::is_directory(dir)) {
+        std::cerr << "[BudAssetTool] Shader directory does not exist: " << shader_dir << std::endl;
+        return false;
+    }
 
-                uint32_t input_count = 0;
-                if (spvReflectEnumerateInputVariables(&module, &input_count, nullptr) == SPV_REFLECT_RESULT_SUCCESS && input_count > 0) {
-                    std::vector<SpvReflectInterfaceVariable*> inputs(input_count);
-                    if (spvReflectEnumerateInputVariables(&module, &input_count, inputs.data()) == SPV_REFLECT_RESULT_SUCCESS) {
-                        for (uint32_t ii = 0; ii < input_count; ++ii) {
-                            SpvReflectInterfaceVariable* v = inputs[ii];
-                            nlohmann::json iv;
-                            iv["location"] = v->location;
-                            iv["name"] = v->name ? v->name : "";
-                            iv["built_in"] = v->built_in;
-                            iv["format"] = v->format;
-                            entry["inputs"].push_back(iv);
-                        }
-                    }
-                }
+    auto normalized = [](const fs::path& p) {
+        std::error_code ec;
+        auto abs = fs::weakly_canonical(p, ec);
+        return (ec ? p : abs).generic_string();
+    };
+
+    // Reflection of each source, keyed by its normalized path (the report lists sources, the bundle SPIR-V)
+    std::unordered_map<std::string, std::string> reflections;
+    if (!options.report_path.empty()) {
+        auto data = bud::tool_support::read_binary_file(options.report_path);
+        auto report = data ? nlohmann::json::parse(data->begin(), data->end(), nullptr, false) : nlohmann::json();
+        if (!data) {
+            std::cout << "[BudAssetTool] No shader report at " << options.report_path << ", bundling without reflection." << std::endl;
+        } else if (!report.is_object() || !report.contains("shaders")) {
+            std::cerr << "[BudAssetTool] Ignoring unreadable shader report " << options.report_path << std::endl;
+        } else {
+            for (auto entry : report["shaders"]) {
+                std::string path = entry.value("path", std::string());
+                if (path.empty() || !entry.value("compiled", false)) continue;
+                entry.erase("path");
+                entry.erase("compiled");
+                entry.erase("compiler_output");
+                reflections[normalized(path)] = entry.dump();
+            }
+        }
+    }
 
-                uint32_t output_count = 0;
-                if (spvReflectEnumerateOutputVariables(&module, &output_count, nullptr) == SPV_REFLECT_RESULT_SUCCESS && output_count > 0) {
-                    std::vector<SpvReflectInterfaceVariable*> outputs(output_count);
-                    if (spvReflectEnumerateOutputVariables(&module, &output_count, outputs.data()) == SPV_REFLECT_RESULT_SUCCESS) {
-                        for (uint32_t oi = 0; oi < output_count; ++oi) {
-                            SpvReflectInterfaceVariable* v = outputs[oi];
-                            nlohmann::json ov;
-                            ov["location"] = v->location;
-                            ov["name"] = v->name ? v->name : "";
-                            ov["built_in"] = v->built_in;
-                            ov["format"] = v->format;
-                            entry["outputs"].push_back(ov);
-                        }
-                    }
-                }
+    const fs::path root = options.root.empty() ? fs::current_path() : fs::path(options.root);
+    auto spv_files = ShaderCache::collect_sources(dir, { ".spv" });
+    if (spv_files.empty()) {
+        std::cerr << "[BudAssetTool] No SPIR-V found under " << shader_dir << ", compile the shaders first." << std::endl;
+        return false;
+    }
 
-                uint32_t pcb_count = 0;
-                if (spvReflectEnumeratePushConstantBlocks(&module, &pcb_count, nullptr) == SPV_REFLECT_RESULT_SUCCESS && pcb_count > 0) {
-                    std::vector<SpvReflectBlockVariable*> pcbs(pcb_count);
-                    if (spvReflectEnumeratePushConstantBlocks(&module, &pcb_count, pcbs.data()) == SPV_REFLECT_RESULT_SUCCESS) {
-                        for (uint32_t pi = 0; pi < pcb_count; ++pi) {
-                            SpvReflectBlockVariable* b = pcbs[pi];
-                            nlohmann::json pjson;
-                            pjson["size"] = b->size;
-                            pjson["name"] = b->name ? b->name : "";
-                            entry["push_constants"].push_back(pjson);
-                        }
-                    }
-                }
+    struct PendingBlob {
+        std::vector<char> raw;
+        std::vector<uint8_t> packed;  // Empty: stored raw
+        uint64_t hash;
+    };
+    std::vector<asset::ShaderBundleEntry> entries;
+    std::vector<PendingBlob> blobs;
+    std::unordered_map<uint64_t, std::vector<uint32_t>> blobs_by_hash;
+    std::string strings(1, '\0'); // Offset 0 = no string
+    size_t raw_bytes = 0;
+    uint32_t reflected = 0;
+
+    for (const auto& spv : spv_files) {
+        auto data = bud::tool_support::read_binary_file(spv);
+        if (!data || data->empty()) {
+            std::cerr << "[BudAssetTool] Failed to read " << spv << std::endl;
+            return false;
+        }
+        raw_bytes += data->size();
 
-                spvReflectDestroyShaderModule(&module);
-                // remove temp spv
-                std::error_code ec; fs::remove(out_spv, ec);
-            }
-            catch (const std::exception& e) {
-                entry["errors"].push_back(std::string("Exception: ") + e.what());
-            }
-            return entry;
-        }));
-        // If too many outstanding futures, wait for some
-        while (futures.size() > max_workers) {
-            auto f = std::move(futures.front());
-            futures.erase(futures.begin());
-            nlohmann::json e = f.get();
-            if (e.contains("compiled") && !e["compiled"].get<bool>()) all_ok.store(false);
-            report_json["shaders"].push_back(e);
+        // FNV-1a, collisions are resolved by comparing the bytes
+        uint64_t hash = 14695981039346656037ull;
+        for (char c : *data) {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 1099511628211ull;
         }
+
+        uint32_t blob_index = asset::INVALID_INDEX;
+        for (uint32_t candidate : blobs_by_hash[hash]) {
+            if (blobs[candidate].raw == *data) { blob_index = candidate; break; }
+        }
+        if (blob_index == asset::INVALID_INDEX) {
+            blob_index = static_cast<uint32_t>(blobs.size());
+            blobs_by_hash[hash].push_back(blob_index);
+            blobs.push_back({ std::move(*data), {}, hash });
+        }
+
+        asset::ShaderBundleEntry entry{};
+        std::error_code ec;
+        auto name = fs::relative(spv, root, ec).generic_string();
+        if (ec || name.empty() || name.starts_with("..")) name = spv.generic_string();
+        entry.name_offset = static_cast<uint32_t>(strings.size());
+        entry.name_size = static_cast<uint32_t>(name.size());
+        strings += name;
+        strings.push_back('\0');
+
+        entry.blob_index = blob_index;
+        fs::path source = spv;
+        source.replace_extension();
+        auto reflection = reflections.find(normalized(source));
+        if (reflection != reflections.end()) {
+            entry.reflection_offset = static_cast<uint32_t>(strings.size());
+            entry.reflection_size = static_cast<uint32_t>(reflection->second.size());
+            strings += reflection->second;
+            strings.push_back('\0');
+            ++reflected;
+        }
+        entries.push_back(entry);
     }
 
-    // Collect remaining futures
-    for (auto& fut : futures) {
-        nlohmann::json e = fut.get();
-        if (e.contains("compiled") && !e["compiled"].get<bool>()) all_ok.store(false);
-        report_json["shaders"].push_back(e);
+    uint32_t flags = 0;
+    if (options.compress) {
+        for (auto& blob : blobs) {
+            auto packed = bud::compress::lz_compress(blob.raw.data(), blob.raw.size());
+            if (packed.size() < blob.raw.size()) {
+                blob.packed = std::move(packed);
+                flags |= asset::SHADER_BUNDLE_FLAG_COMPRESSED;
+            }
+        }
     }
 
-    if (!report_path.empty()) {
-        std::ofstream out(report_path);
-        if (out.is_open()) {
-            out << report_json.dump(2);
-            out.close();
+    static_assert(sizeof(asset::ShaderBundleHeader) == asset::SHADER_BUNDLE_HEADER_SIZE, "ShaderBundleHeader size mismatch!");
+    static_assert(sizeof(asset::ShaderBundleEntry) == asset::SHADER_BUNDLE_ENTRY_SIZE, "ShaderBundleEntry size mismatch!");
+    static_assert(sizeof(asset::ShaderBundleBlob) == asset::SHADER_BUNDLE_BLOB_SIZE, "ShaderBundleBlob size mismatch!");
+
+    asset::ShaderBundleHeader header{};
+    header.magic = asset::SHADER_BUNDLE_MAGIC;
+    header.version = asset::SHADER_BUNDLE_VERSION;
+    header.flags = flags;
+    header.entry_count = static_cast<uint32_t>(entries.size());
+    header.blob_count = static_cast<uint32_t>(blobs.size());
+    header.entry_offset = sizeof(header);
+    header.blob_offset = header.entry_offset + entries.size() * sizeof(asset::ShaderBundleEntry);
+    header.string_offset = header.blob_offset + blobs.size() * sizeof(asset::ShaderBundleBlob);
+    // SPIR-V is a uint32 stream, keep the data section 8-byte aligned
+    header.data_offset = (header.string_offset + strings.size() + 7) & ~uint64_t(7);
+
+    std::vector<asset::ShaderBundleBlob> blob_table;
+    std::string payload;
+    for (const auto& blob : blobs) {
+        asset::ShaderBundleBlob b{};
+        b.offset = payload.size();
+        b.size = static_cast<uint32_t>(blob.raw.size());
+        b.hash = blob.hash;
+        if (!blob.packed.empty()) {
+            b.stored_size = static_cast<uint32_t>(blob.packed.size());
+            payload.append(reinterpret_cast<const char*>(blob.packed.data()), blob.packed.size());
         } else {
-            std::cerr << "[BudAssetTool] Failed to write report to " << report_path << std::endl;
+            b.stored_size = b.size;
+            payload.append(blob.raw.data(), blob.raw.size());
         }
+        payload.resize((payload.size() + 7) & ~size_t(7), '\0');
+        blob_table.push_back(b);
     }
 
-    return all_ok.load();
+    std::string file;
+    file.reserve(header.data_offset + payload.size());
+    file.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.append(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(asset::ShaderBundleEntry));
+    file.append(reinterpret_cast<const char*>(blob_table.data()), blob_table.size() * sizeof(asset::ShaderBundleBlob));
+    file += strings;
+    file.resize(header.data_offset, '\0');
+    file += payload;
+
+    fs::path out_path(output_path);
+    std::error_code ec;
+    if (out_path.has_parent_path()) fs::create_directories(out_path.parent_path(), ec);
+    if (!bud::tool_support::write_text_file_atomic(out_path, file)) {
+        std::cerr << "[BudAssetTool] Failed to write shader bundle " << output_path << std::endl;
+        return false;
+    }
+
+    std::cout << "[BudAssetTool] Bundled " << entries.size() << " shaders (" << blobs.size() << " unique, "
+        << reflected << " reflected) into " << output_path << ": " << raw_bytes << " -> " << file.size() << " bytes" << std::endl;
+    return true;
 }
-#endif
 
 
 // end of file
-
@@ -3,15 +3,29 @@
 #include <vector>
 #include <filesystem>
 #include "src/core/bud.asset.types.hpp"
+#include "bud.shader.cache.hpp"
 
 namespace bud::tool {
+    struct ShaderBundleOptions {
+        std::string report_path;  // --validate-shaders report, its reflection is stored with each shader
+        std::string root;         // Entry names are relative to this (the engine's VFS root), empty = working directory
+        bool compress = false;
+    };
+
     class AssetProcessor {
     public:
         // Processes a glTF file and exports it to the .budmesh format
-        static bool process_gltf_to_budmesh(const std::string& input_path, const std::string& output_path);
+        // cluster_lod: also build the meshlet cluster hierarchy (v5 LOD section, bud.cluster_lod.hpp)
+        static bool process_gltf_to_budmesh(const std::string& input_path, const std::string& output_path, bool cluster_lod = false);
         // Validate shaders under a directory (compile with glslc if needed and run SPIR-V reflection)
         // If report_path is non-empty, writes a JSON report to that file
         // max_workers: if >0, limit parallel workers; if 0, tool will use env var or hardware_concurrency
-        static bool validate_shaders_in_directory(const std::string& shader_dir, const std::string& report_path = "", unsigned int max_workers = 0);
+        // cache_dir: persistent ShaderCache, empty = tmp/shader_cache; unchanged shaders reuse their cached reflection
+        static bool validate_shaders_in_directory(const std::string& shader_dir, const std::string& report_path = "", unsigned int max_workers = 0, const std::string& cache_dir = "");
+        // Compile every shader under a directory to <source>.spv, skipping the ones the cache reports up to date
+        static bool compile_shaders_in_directory(const std::string& shader_dir, const ShaderCacheOptions& options);
+        // Pack every compiled .spv under a directory into one shader bundle (bud::asset::ShaderBundleHeader),
+        // identical SPIR-V is stored once
+        static bool bundle_shaders(const std::string& shader_dir, const std::string& output_path, const ShaderBundleOptions& options);
     };
 }
@@ -0,0 +1,420 @@
+﻿#include "bud.budmesh.writer.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+
+#include <meshoptimizer.h>
+
+#include "src/core/bud.cluster_lod.hpp"
+
+namespace bud::tool {
+
+    namespace {
+        struct Sphere {
+            float center[3];
+            float radius;
+        };
+
+        // Sphere around both; grown by a hair so rounding never leaves an input poking out
+        Sphere merge_spheres(const Sphere& a, const Sphere& b) {
+            const float d[3] = { b.center[0] - a.center[0], b.center[1] - a.center[1], b.center[2] - a.center[2] };
+            const float distance = std::sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+            if (distance + b.radius <= a.radius) return a;
+            if (distance + a.radius <= b.radius) return b;
+
+            Sphere merged;
+            merged.radius = (distance + a.radius + b.radius) * 0.5f;
+            const float t = (merged.radius - a.radius) / distance;
+            for (int k = 0; k < 3; ++k) merged.center[k] = a.center[k] + d[k] * t;
+            merged.radius *= 1.0f + 1e-6f;
+            return merged;
+        }
+
+        struct LodCluster {
+            std::vector<uint32_t> indices; // Local to the submesh vertices
+            Sphere bounds;                 // Of the group the meshlet was built from, the meshlet itself on the source level
+            float error;
+            uint32_t meshlet;              // Into the file's meshlet table
+        };
+
+        // Greedy partition into groups of up to group_size meshlets sharing the most edges (welded positions,
+        // so UV seams still connect). Seeds go in order along the longest axis, which keeps groups compact.
+        std::vector<std::vector<uint32_t>> group_clusters(const std::vector<LodCluster>& clusters, const std::vector<uint32_t>& remap, size_t group_size) {
+            const uint32_t count = (uint32_t)clusters.size();
+
+            // Edge -> first meshlet using it, a second meshlet on the same edge makes the two neighbours
+            std::unordered_map<uint64_t, uint32_t> edge_owner;
+            std::vector<std::unordered_map<uint32_t, uint32_t>> shared_edges(count);
+            for (uint32_t c = 0; c < count; ++c) {
+                const auto& indices = clusters[c].indices;
+                for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+                    for (int e = 0; e < 3; ++e) {
+                        const uint32_t a = remap[indices[t + e]];
+                        const uint32_t b = remap[indices[t + (e + 1) % 3]];
+                        if (a == b) continue;
+                        const uint64_t key = (uint64_t(std::min(a, b)) << 32) | std::max(a, b);
+                        auto [it, inserted] = edge_owner.try_emplace(key, c);
+                        if (!inserted && it->second != c) {
+                            shared_edges[c][it->second]++;
+                            shared_edges[it->second][c]++;
+                        }
+                    }
+                }
+            }
+
+            float lo[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+            float hi[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+            for (const auto& c : clusters) {
+                for (int k = 0; k < 3; ++k) {
+                    lo[k] = std::min(lo[k], c.bounds.center[k]);
+                    hi[k] = std::max(hi[k], c.bounds.center[k]);
+                }
+            }
+            int axis = 0;
+            for (int k = 1; k < 3; ++k) {
+                if (hi[k] - lo[k] > hi[axis] - lo[axis]) axis = k;
+            }
+
+            std::vector<uint32_t> order(count);
+            std::iota(order.begin(), order.end(), 0u);
+            std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return clusters[a].bounds.center[axis] < clusters[b].bounds.center[axis]; });
+
+            std::vector<char> grouped(count, 0);
+            std::vector<std::vector<uint32_t>> groups;
+            for (uint32_t seed : order) {
+                if (grouped[seed]) continue;
+                std::vector<uint32_t> group = { seed };
+                grouped[seed] = 1;
+
+                while (group.size() < group_size) {
+                    std::unordered_map<uint32_t, uint32_t> candidates; // Edges shared with the whole group
+                    for (uint32_t member : group) {
+                        for (const auto& [neighbour, edges] : shared_edges[member]) {
+                            if (!grouped[neighbour]) candidates[neighbour] += edges;
+                        }
+                    }
+
+                    uint32_t best = UINT32_MAX;
+                    uint32_t best_edges = 0;
+                    for (const auto& [candidate, edges] : candidates) {
+                        if (edges > best_edges || (edges == best_edges && candidate < best)) {
+                            best = candidate;
+                            best_edges = edges;
+                        }
+                    }
+                    if (best == UINT32_MAX) break;
+                    group.push_back(best);
+                    grouped[best] = 1;
+                }
+                groups.push_back(std::move(group));
+            }
+            return groups;
+        }
+    }
+
+    void BudMeshWriter::add_submesh(const std::vector<asset::Vertex>& group_vertices, const std::vector<uint32_t>& group_indices, uint32_t material_id) {
+        if (group_indices.empty()) return;
+
+        // Global stats for this group relative to file
+        uint32_t group_base_vertex = (uint32_t)all_vertices.size();
+        uint32_t group_base_index = (uint32_t)all_indices.size();
+        uint32_t group_base_meshlet = (uint32_t)all_meshlets.size();
+
+        // Meshoptimizer processing
+        std::vector<uint32_t> optimized_indices(group_indices.size());
+        meshopt_optimizeVertexCache(optimized_indices.data(), group_indices.data(), group_indices.size(), group_vertices.size());
+
+        // Append to global buffers MUST BE AFTER OPTIMIZATION AND USE OPTIMIZED_INDICES
+        for (const auto& v : group_vertices) all_vertices.push_back(v);
+        for (auto idx : optimized_indices) all_indices.push_back(group_base_vertex + idx);
+
+        auto meshlet_indices = append_meshlets(group_vertices, optimized_indices, group_base_vertex);
+        const uint32_t meshlet_count = (uint32_t)meshlet_indices.size();
+
+        // Coarser levels follow the source meshlets, the flat path never sees them
+        asset::SubMeshLod lod = { meshlet_count, 1 };
+        if (cluster_lod && meshlet_count > 1) {
+            lod.level_count = build_cluster_lod(group_vertices, std::move(meshlet_indices), group_base_meshlet, group_base_vertex);
+            lod.meshlet_count = (uint32_t)all_meshlets.size() - group_base_meshlet;
+        }
+        submesh_lods.push_back(lod);
+
+        asset::SubMeshDescriptor sub_desc = {};
+        sub_desc.index_start = group_base_index;
+        sub_desc.index_count = (uint32_t)group_indices.size();
+        sub_desc.meshlet_start = group_base_meshlet;
+        sub_desc.meshlet_count = meshlet_count;
+        sub_desc.material_id = material_id;
+        
+        // Compute SubMesh AABB
+        sub_desc.aabb_min[0] = sub_desc.aabb_min[1] = sub_desc.aabb_min[2] = std::numeric_limits<float>::max();
+        sub_desc.aabb_max[0] = sub_desc.aabb_max[1] = sub_desc.aabb_max[2] = -std::numeric_limits<float>::max();
+        for (const auto& v : group_vertices) {
+            sub_desc.aabb_min[0] = std::min(sub_desc.aabb_min[0], v.position[0]);
+            sub_desc.aabb_min[1] = std::min(sub_desc.aabb_min[1], v.position[1]);
+            sub_desc.aabb_min[2] = std::min(sub_desc.aabb_min[2], v.position[2]);
+            sub_desc.aabb_max[0] = std::max(sub_desc.aabb_max[0], v.position[0]);
+            sub_desc.aabb_max[1] = std::max(sub_desc.aabb_max[1], v.position[1]);
+            sub_desc.aabb_max[2] = std::max(sub_desc.aabb_max[2], v.position[2]);
+        }
+        submeshes.push_back(sub_desc);
+    }
+
+    std::vector<std::vector<uint32_t>> BudMeshWriter::append_meshlets(const std::vector<asset::Vertex>& vertices, const std::vector<uint32_t>& indices, uint32_t base_vertex) {
+        const size_t max_vertices = MAX_MESHLET_VERTICES;
+        const size_t max_triangles = MAX_MESHLET_TRIANGLES;
+        const float cone_weight = MESHLET_CONE_WEIGHT;
+
+        size_t max_meshlets = meshopt_buildMeshletsBound(indices.size(), max_vertices, max_triangles);
+        std::vector<meshopt_Meshlet> local_meshlets(max_meshlets);
+        std::vector<unsigned int> local_meshlet_vertices(max_meshlets * max_vertices);
+        std::vector<unsigned char> local_meshlet_triangles(max_meshlets * max_triangles * 3);
+
+        size_t meshlet_count = meshopt_buildMeshlets(local_meshlets.data(), local_meshlet_vertices.data(), local_meshlet_triangles.data(),
+                                                     indices.data(), indices.size(), &vertices[0].position[0], vertices.size(), sizeof(asset::Vertex),
+                                                     max_vertices, max_triangles, cone_weight);
+
+        local_meshlets.resize(meshlet_count);
+        std::vector<std::vector<uint32_t>> meshlet_indices(meshlet_count);
+
+        for (size_t i = 0; i < meshlet_count; ++i) {
+            meshopt_Meshlet& m = local_meshlets[i];
+            meshopt_optimizeMeshlet(&local_meshlet_vertices[m.vertex_offset], &local_meshlet_triangles[m.triangle_offset], m.triangle_count, m.vertex_count);
+
+            asset::MeshletDescriptor desc = {};
+            desc.vertex_offset = (uint32_t)all_meshlet_vertices.size();
+            desc.vertex_count = m.vertex_count;
+            desc.triangle_offset = (uint32_t)all_meshlet_triangles.size();
+            desc.triangle_count = m.triangle_count;
+            all_meshlets.push_back(desc);
+
+            for (uint32_t v_idx = 0; v_idx < m.vertex_count; ++v_idx) {
+                all_meshlet_vertices.push_back(base_vertex + local_meshlet_vertices[m.vertex_offset + v_idx]);
+            }
+            auto& triangle_indices = meshlet_indices[i];
+            triangle_indices.reserve(m.triangle_count * 3);
+            for (uint32_t t_idx = 0; t_idx < m.triangle_count * 3; ++t_idx) {
+                all_meshlet_triangles.push_back(local_meshlet_triangles[m.triangle_offset + t_idx]);
+                triangle_indices.push_back(local_meshlet_vertices[m.vertex_offset + local_meshlet_triangles[m.triangle_offset + t_idx]]);
+            }
+
+            meshopt_Bounds mbounds = meshopt_computeMeshletBounds(&local_meshlet_vertices[m.vertex_offset], &local_meshlet_triangles[m.triangle_offset],
+                                                                m.triangle_count, &vertices[0].position[0], vertices.size(), sizeof(asset::Vertex));
+            asset::MeshletCullData cull = {};
+            cull.bounding_sphere[0] = mbounds.center[0];
+            cull.bounding_sphere[1] = mbounds.center[1];
+            cull.bounding_sphere[2] = mbounds.center[2];
+            cull.bounding_sphere[3] = mbounds.radius;
+            cull.cone_axis[0] = mbounds.cone_axis_s8[0];
+            cull.cone_axis[1] = mbounds.cone_axis_s8[1];
+            cull.cone_axis[2] = mbounds.cone_axis_s8[2];
+            cull.cone_cutoff = mbounds.cone_cutoff_s8;
+            all_cull_data.push_back(cull);
+
+            // Source level: exact, never replaced. build_cluster_lod overwrites what it groups.
+            asset::MeshletLodBounds lod = {};
+            std::copy_n(mbounds.center, 3, lod.center);
+            lod.radius = mbounds.radius;
+            lod.error = 0.0f;
+            std::copy_n(mbounds.center, 3, lod.parent_center);
+            lod.parent_radius = mbounds.radius;
+            lod.parent_error = FLT_MAX;
+            lod.group = asset::INVALID_INDEX;
+            lod.parent_group = asset::INVALID_INDEX;
+            all_meshlet_lods.push_back(lod);
+        }
+        return meshlet_indices;
+    }
+
+    uint32_t BudMeshWriter::build_cluster_lod(const std::vector<asset::Vertex>& vertices, std::vector<std::vector<uint32_t>> cluster_indices, uint32_t first_meshlet, uint32_t base_vertex) {
+        const float* positions = &vertices[0].position[0];
+        const std::vector<uint32_t> remap = bud::cluster_lod::weld_positions(positions, vertices.size(), sizeof(asset::Vertex));
+        // meshopt_simplify reports errors relative to the mesh extent
+        const float error_scale = meshopt_simplifyScale(positions, vertices.size(), sizeof(asset::Vertex));
+
+        std::vector<LodCluster> clusters(cluster_indices.size());
+        for (size_t i = 0; i < clusters.size(); ++i) {
+            const auto& lod = all_meshlet_lods[first_meshlet + i];
+            clusters[i].indices = std::move(cluster_indices[i]);
+            clusters[i].bounds = { { lod.center[0], lod.center[1], lod.center[2] }, lod.radius };
+            clusters[i].error = 0.0f;
+            clusters[i].meshlet = first_meshlet + (uint32_t)i;
+        }
+
+        uint32_t level_count = 1;
+        while (clusters.size() > 1 && level_count < MAX_LOD_LEVELS) {
+            const auto groups = group_clusters(clusters, remap, LOD_GROUP_SIZE);
+
+            // Meshlets of groups that did not simplify stay unparented and try again with the next level's neighbours
+            std::vector<LodCluster> next;
+            bool progress = false;
+            for (const auto& group : groups) {
+                std::vector<uint32_t> merged;
+                for (uint32_t c : group) merged.insert(merged.end(), clusters[c].indices.begin(), clusters[c].indices.end());
+
+                // Half the triangles; the group border is locked, so it still matches whatever level its neighbours draw
+                std::vector<uint32_t> simplified(merged.size());
+                float result_error = 0.0f;
+                if (group.size() > 1) {
+                    simplified.resize(meshopt_simplify(simplified.data(), merged.data(), merged.size(), positions, vertices.size(), sizeof(asset::Vertex),
+                                                       merged.size() / 6 * 3, FLT_MAX, meshopt_SimplifyLockBorder, &result_error));
+                }
+                if (group.size() < 2 || simplified.empty() || (float)simplified.size() > (float)merged.size() * LOD_MIN_REDUCTION) {
+                    for (uint32_t c : group) next.push_back(std::move(clusters[c]));
+                    continue;
+                }
+
+                Sphere bounds = clusters[group[0]].bounds;
+                float error = 0.0f;
+                for (uint32_t c : group) {
+                    bounds = merge_spheres(bounds, clusters[c].bounds);
+                    error = std::max(error, clusters[c].error);
+                }
+                // Never below the children, so the projected error grows monotonically up the hierarchy
+                error += result_error * error_scale;
+                const uint32_t group_id = next_lod_group++;
+
+                for (uint32_t c : group) {
+                    auto& lod = all_meshlet_lods[clusters[c].meshlet];
+                    std::copy_n(bounds.center, 3, lod.parent_center);
+                    lod.parent_radius = bounds.radius;
+                    lod.parent_error = error;
+                    lod.parent_group = group_id;
+                }
+
+                const uint32_t group_first = (uint32_t)all_meshlets.size();
+                auto outputs = append_meshlets(vertices, simplified, base_vertex);
+                for (size_t i = 0; i < outputs.size(); ++i) {
+                    auto& lod = all_meshlet_lods[group_first + i];
+                    std::copy_n(bounds.center, 3, lod.center);
+                    lod.radius = bounds.radius;
+                    lod.error = error;
+                    lod.group = group_id;
+                    next.push_back({ std::move(outputs[i]), bounds, error, group_first + (uint32_t)i });
+                }
+                progress = true;
+            }
+
+            if (!progress) break;
+            clusters = std::move(next);
+            level_count++;
+        }
+        return level_count;
+    }
+
+    bool BudMeshWriter::write(const std::string& output_path, const std::vector<std::string>& texture_paths) const {
+        // 2. Serialize to .budmesh
+        std::ofstream out(output_path, std::ios::binary);
+        if (!out.is_open()) return false;
+
+        static_assert(sizeof(asset::BudMeshHeader) == asset::MESH_HEADER_SIZE, "BudMeshHeader size mismatch!");
+        static_assert(offsetof(asset::BudMeshHeader, vertex_offset) == asset::MESH_HEADER_VERTEX_OFFSET, "BudMeshHeader alignment mismatch!");
+        static_assert(offsetof(asset::BudMeshHeader, submesh_count) == asset::MESH_HEADER_SUBMESH_COUNT_OFFSET, "BudMeshHeader submesh_count offset mismatch!");
+        static_assert(sizeof(asset::SubMeshDescriptor) == asset::SUBMESH_DESCRIPTOR_SIZE, "SubMeshDescriptor size mismatch!");
+        static_assert(sizeof(asset::MeshletLodBounds) == asset::MESHLET_LOD_BOUNDS_SIZE, "MeshletLodBounds size mismatch!");
+
+        asset::BudMeshHeader header = {};
+        header.magic = asset::MESH_MAGIC;
+        header.version = asset::MESH_VERSION;
+        header.total_vertices = (uint32_t)all_vertices.size();
+        header.total_indices = (uint32_t)all_indices.size();
+        header.meshlet_count = (uint32_t)all_meshlets.size();
+        header.submesh_count = (uint32_t)submeshes.size();
+
+        // Textures already processed at the start
+        header.texture_count = (uint32_t)texture_paths.size();
+
+        header.aabb_min[0] = header.aabb_min[1] = header.aabb_min[2] = std::numeric_limits<float>::max();
+        header.aabb_max[0] = header.aabb_max[1] = header.aabb_max[2] = -std::numeric_limits<float>::max();
+        for (const auto& v : all_vertices) {
+            header.aabb_min[0] = std::min(header.aabb_min[0], v.position[0]);
+            header.aabb_min[1] = std::min(header.aabb_min[1], v.position[1]);
+            header.aabb_min[2] = std::min(header.aabb_min[2], v.position[2]);
+            header.aabb_max[0] = std::max(header.aabb_max[0], v.position[0]);
+            header.aabb_max[1] = std::max(header.aabb_max[1], v.position[1]);
+            header.aabb_max[2] = std::max(header.aabb_max[2], v.position[2]);
+        }
+
+        // Split vertex streams, depth-only passes bind just the positions
+        std::vector<asset::VertexPosition> positions(all_vertices.size());
+        std::vector<asset::VertexAttributes> attributes(all_vertices.size());
+        for (size_t i = 0; i < all_vertices.size(); ++i) {
+            const auto& v = all_vertices[i];
+            std::copy(std::begin(v.position), std::end(v.position), positions[i].position);
+            std::copy(std::begin(v.normal), std::end(v.normal), attributes[i].normal);
+            std::copy(std::begin(v.uv), std::end(v.uv), attributes[i].uv);
+            std::copy(std::begin(v.tangent), std::end(v.tangent), attributes[i].tangent);
+        }
+
+        size_t current_offset = sizeof(header);
+        header.vertex_offset = current_offset;
+        current_offset += positions.size() * sizeof(asset::VertexPosition);
+        header.attribute_offset = current_offset;
+        current_offset += attributes.size() * sizeof(asset::VertexAttributes);
+        header.index_offset = current_offset;
+        current_offset += all_indices.size() * sizeof(uint32_t);
+        header.meshlet_offset = current_offset;
+        current_offset += all_meshlets.size() * sizeof(asset::MeshletDescriptor);
+        header.vertex_index_offset = current_offset;
+        current_offset += all_meshlet_vertices.size() * sizeof(uint32_t);
+        header.meshlet_index_offset = current_offset;
+        current_offset += all_meshlet_triangles.size() * sizeof(uint32_t);
+        header.cull_data_offset = current_offset;
+        current_offset += all_cull_data.size() * sizeof(asset::MeshletCullData);
+        header.submesh_offset = current_offset;
+        current_offset += submeshes.size() * sizeof(asset::SubMeshDescriptor);
+        header.lod_offset = cluster_lod ? current_offset : 0;
+        if (cluster_lod) {
+            current_offset += submesh_lods.size() * sizeof(asset::SubMeshLod);
+            current_offset += all_meshlet_lods.size() * sizeof(asset::MeshletLodBounds);
+        }
+        header.texture_offset = current_offset;
+        // Total size of all strings including null terminators
+        for (const auto& path : texture_paths) {
+            current_offset += path.length() + 1;
+        }
+
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(positions.data()), positions.size() * sizeof(asset::VertexPosition));
+        out.write(reinterpret_cast<const char*>(attributes.data()), attributes.size() * sizeof(asset::VertexAttributes));
+        out.write(reinterpret_cast<const char*>(all_indices.data()), all_indices.size() * sizeof(uint32_t));
+        out.write(reinterpret_cast<const char*>(all_meshlets.data()), all_meshlets.size() * sizeof(asset::MeshletDescriptor));
+        out.write(reinterpret_cast<const char*>(all_meshlet_vertices.data()), all_meshlet_vertices.size() * sizeof(uint32_t));
+        out.write(reinterpret_cast<const char*>(all_meshlet_triangles.data()), all_meshlet_triangles.size() * sizeof(uint32_t));
+        out.write(reinterpret_cast<const char*>(all_cull_data.data()), all_cull_data.size() * sizeof(asset::MeshletCullData));
+        out.write(reinterpret_cast<const char*>(submeshes.data()), submeshes.size() * sizeof(asset::SubMeshDescriptor));
+        if (cluster_lod) {
+            out.write(reinterpret_cast<const char*>(submesh_lods.data()), submesh_lods.size() * sizeof(asset::SubMeshLod));
+            out.write(reinterpret_cast<const char*>(all_meshlet_lods.data()), all_meshlet_lods.size() * sizeof(asset::MeshletLodBounds));
+        }
+        
+        for (const auto& path : texture_paths) {
+            out.write(path.c_str(), path.length() + 1);
+        }
+
+        std::cout << "[BudAssetTool] Successfully exported " << header.submesh_count << " submeshes, " << header.meshlet_count << " meshlets, and " << header.texture_count << " textures to " << output_path << std::endl;
+
+        if (cluster_lod) {
+            uint32_t source_meshlets = 0;
+            uint32_t max_levels = 0;
+            for (size_t s = 0; s < submeshes.size(); ++s) {
+                source_meshlets += submeshes[s].meshlet_count;
+                max_levels = std::max(max_levels, submesh_lods[s].level_count);
+            }
+            const uint32_t errors = bud::cluster_lod::count_hierarchy_errors(all_meshlet_lods.data(), (uint32_t)all_meshlet_lods.size());
+            std::cout << "[BudAssetTool] Cluster LOD: " << source_meshlets << " source meshlets, " << all_meshlets.size() - source_meshlets
+                << " simplified in " << next_lod_group << " groups, up to " << max_levels << " levels" << std::endl;
+            if (errors > 0) {
+                std::cerr << "[BudAssetTool] Cluster LOD hierarchy has " << errors << " meshlets with inconsistent bounds, cuts may crack" << std::endl;
+            }
+        }
+        return true;
+    }
+}
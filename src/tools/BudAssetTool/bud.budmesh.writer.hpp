@@ -0,0 +1,50 @@
+﻿#pragma once
+#include <string>
+#include <vector>
+#include "src/core/bud.asset.types.hpp"
+
+namespace bud::tool {
+    // Accumulates submeshes (vertex cache optimized, split into meshlets) and serializes them as .budmesh.
+    // Shared by the glTF import and the HLOD proxy builder.
+    class BudMeshWriter {
+    public:
+        static constexpr size_t MAX_MESHLET_VERTICES = 64;
+        static constexpr size_t MAX_MESHLET_TRIANGLES = 128;
+        static constexpr float MESHLET_CONE_WEIGHT = 0.5f;
+
+        // Cluster LOD hierarchy (bud.cluster_lod.hpp)
+        static constexpr size_t LOD_GROUP_SIZE = 4;          // Meshlets merged and simplified together
+        static constexpr uint32_t MAX_LOD_LEVELS = 16;
+        static constexpr float LOD_MIN_REDUCTION = 0.85f;    // A group keeping more of its triangles is left as is
+
+        // Builds the cluster LOD hierarchy of the submeshes added afterwards and writes the v5 LOD section
+        void set_cluster_lod(bool enabled) { cluster_lod = enabled; }
+
+        // Indices are local to group_vertices, material_id indexes the texture list passed to write()
+        void add_submesh(const std::vector<asset::Vertex>& group_vertices, const std::vector<uint32_t>& group_indices, uint32_t material_id);
+        bool write(const std::string& output_path, const std::vector<std::string>& texture_paths) const;
+
+        size_t submesh_count() const { return submeshes.size(); }
+        size_t triangle_count() const { return all_indices.size() / 3; }
+
+    private:
+        // Meshlets of indices (local to vertices) appended to the meshlet tables, returns the index list of each
+        std::vector<std::vector<uint32_t>> append_meshlets(const std::vector<asset::Vertex>& vertices, const std::vector<uint32_t>& indices, uint32_t base_vertex);
+        // Simplifies the meshlets [first_meshlet, end) level by level, returns the level count
+        uint32_t build_cluster_lod(const std::vector<asset::Vertex>& vertices, std::vector<std::vector<uint32_t>> cluster_indices, uint32_t first_meshlet, uint32_t base_vertex);
+
+        bool cluster_lod = false;
+        uint32_t next_lod_group = 0;
+
+        std::vector<asset::Vertex> all_vertices;
+        std::vector<uint32_t> all_indices;
+        std::vector<asset::MeshletDescriptor> all_meshlets;
+        std::vector<asset::MeshletCullData> all_cull_data;
+        std::vector<uint32_t> all_meshlet_vertices;
+        std::vector<uint32_t> all_meshlet_triangles;
+        std::vector<asset::SubMeshDescriptor> submeshes;
+        // Kept for every submesh (flat ones get a single level), written only with cluster LOD on
+        std::vector<asset::SubMeshLod> submesh_lods;           // Parallel to submeshes
+        std::vector<asset::MeshletLodBounds> all_meshlet_lods; // Parallel to all_meshlets
+    };
+}
@@ -0,0 +1,431 @@
+﻿#include "bud.hlod.builder.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <meshoptimizer.h>
+#include <nlohmann/json.hpp>
+
+// Implementation lives in bud.impostor.baker.cpp
+#include <stb_image.h>
+#include <stb_image_write.h>
+
+#include "../bud_tool_support/bud_tool_support.hpp"
+#include "bud.budmesh.writer.hpp"
+
+namespace bud::tool {
+
+    namespace {
+        constexpr int MANIFEST_VERSION = 1;
+        constexpr float PIXEL_ANGLE_1080P = 1.0472f / 1080.0f; // 60 degree vertical fov over 1080 rows
+
+        struct Bounds {
+            float min[3] = { std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
+            float max[3] = { std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest() };
+
+            void grow(const float p[3]) {
+                for (int k = 0; k < 3; ++k) {
+                    min[k] = std::min(min[k], p[k]);
+                    max[k] = std::max(max[k], p[k]);
+                }
+            }
+            void grow(const Bounds& b) {
+                grow(b.min);
+                grow(b.max);
+            }
+            float radius() const {
+                const float dx = max[0] - min[0], dy = max[1] - min[1], dz = max[2] - min[2];
+                return 0.5f * std::sqrt(dx * dx + dy * dy + dz * dz);
+            }
+        };
+
+        // Column-major like the scene JSON (glm), m[c * 4 + r]
+        struct Transform {
+            float m[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+
+            void point(const float p[3], float out[3]) const {
+                for (int r = 0; r < 3; ++r) out[r] = m[r] * p[0] + m[4 + r] * p[1] + m[8 + r] * p[2] + m[12 + r];
+            }
+            // Renormalized, so a uniform scale is fine; the proxies are lit, not shaded exactly
+            void direction(const float d[3], float out[3]) const {
+                for (int r = 0; r < 3; ++r) out[r] = m[r] * d[0] + m[4 + r] * d[1] + m[8 + r] * d[2];
+                const float len = std::sqrt(out[0] * out[0] + out[1] * out[1] + out[2] * out[2]);
+                if (len > 0.0f) for (int r = 0; r < 3; ++r) out[r] /= len;
+            }
+        };
+
+        struct SourceMesh {
+            std::vector<asset::Vertex> vertices;
+            std::vector<uint32_t> indices;
+            std::vector<asset::SubMeshDescriptor> submeshes;
+            std::vector<std::string> texture_paths;
+        };
+
+        // The engine's load_bud_mesh without the meshlet data, v2 and newer (submesh table)
+        std::optional<SourceMesh> read_budmesh(const std::filesystem::path& path) {
+            auto data = bud::tool_support::read_binary_file(path);
+            if (!data || data->size() < sizeof(asset::BudMeshHeader)) return std::nullopt;
+
+            const char* ptr = data->data();
+            const size_t size = data->size();
+            asset::BudMeshHeader header;
+            std::memcpy(&header, ptr, sizeof(header));
+            if (header.magic != asset::MESH_MAGIC || header.version < 2) return std::nullopt;
+
+            const bool split_streams = header.version >= asset::MESH_VERSION_SPLIT_STREAMS;
+            auto fits = [&](uint64_t offset, size_t bytes) { return offset <= size && bytes <= size - offset; };
+            const bool valid = (split_streams
+                    ? fits(header.vertex_offset, header.total_vertices * sizeof(asset::VertexPosition))
+                        && fits(header.attribute_offset, header.total_vertices * sizeof(asset::VertexAttributes))
+                    : fits(header.vertex_offset, header.total_vertices * sizeof(asset::Vertex)))
+                && fits(header.index_offset, header.total_indices * sizeof(uint32_t))
+                && fits(header.submesh_offset, header.submesh_count * sizeof(asset::SubMeshDescriptor));
+            if (!valid) return std::nullopt;
+
+            SourceMesh mesh;
+            mesh.vertices.resize(header.total_vertices);
+            if (split_streams) {
+                std::vector<asset::VertexPosition> positions(header.total_vertices);
+                std::vector<asset::VertexAttributes> attributes(header.total_vertices);
+                std::memcpy(positions.data(), ptr + header.vertex_offset, positions.size() * sizeof(asset::VertexPosition));
+                std::memcpy(attributes.data(), ptr + header.attribute_offset, attributes.size() * sizeof(asset::VertexAttributes));
+                for (size_t i = 0; i < mesh.vertices.size(); ++i) {
+                    auto& v = mesh.vertices[i];
+                    std::copy_n(positions[i].position, 3, v.position);
+                    std::copy_n(attributes[i].normal, 3, v.normal);
+                    std::copy_n(attributes[i].uv, 2, v.uv);
+                    std::copy_n(attributes[i].tangent, 4, v.tangent);
+                }
+            } else {
+                std::memcpy(mesh.vertices.data(), ptr + header.vertex_offset, mesh.vertices.size() * sizeof(asset::Vertex));
+            }
+
+            mesh.indices.resize(header.total_indices);
+            std::memcpy(mesh.indices.data(), ptr + header.index_offset, mesh.indices.size() * sizeof(uint32_t));
+            mesh.submeshes.resize(header.submesh_count);
+            std::memcpy(mesh.submeshes.data(), ptr + header.submesh_offset, mesh.submeshes.size() * sizeof(asset::SubMeshDescriptor));
+
+            if (header.version >= 3 && header.texture_offset < size) {
+                const char* cursor = ptr + header.texture_offset;
+                const char* end = ptr + size;
+                for (uint32_t t = 0; t < header.texture_count && cursor < end; ++t) {
+                    const char* terminator = std::find(cursor, end, '\0');
+                    mesh.texture_paths.emplace_back(cursor, terminator);
+                    cursor = terminator + 1;
+                }
+            }
+            return mesh;
+        }
+
+        struct Member {
+            uint32_t entity;
+            uint32_t submesh;
+            const SourceMesh* mesh;
+            Transform transform;
+            Bounds bounds;  // World space
+        };
+
+        Bounds transform_bounds(const Transform& transform, const float local_min[3], const float local_max[3]) {
+            Bounds world;
+            for (int c = 0; c < 8; ++c) {
+                const float corner[3] = { (c & 1) ? local_max[0] : local_min[0], (c & 2) ? local_max[1] : local_min[1], (c & 4) ? local_max[2] : local_min[2] };
+                float p[3];
+                transform.point(corner, p);
+                world.grow(p);
+            }
+            return world;
+        }
+
+        // Box filtered into tile x tile pixels, white when the source cannot be read
+        void bake_tile(const std::filesystem::path& texture, uint32_t tile, std::vector<uint8_t>& atlas, uint32_t atlas_width, uint32_t tile_x, uint32_t tile_y) {
+            int width = 0, height = 0, channels = 0;
+            stbi_uc* pixels = texture.empty() ? nullptr : stbi_load(texture.string().c_str(), &width, &height, &channels, STBI_rgb_alpha);
+            if (!pixels && !texture.empty()) {
+                std::cerr << "[BudAssetTool] HLOD: cannot read texture " << texture.generic_string() << ", baking white" << std::endl;
+            }
+
+            for (uint32_t y = 0; y < tile; ++y) {
+                for (uint32_t x = 0; x < tile; ++x) {
+                    uint8_t* dst = &atlas[((static_cast<size_t>(tile_y) * tile + y) * atlas_width + tile_x * tile + x) * 4];
+                    if (!pixels) {
+                        std::fill_n(dst, 4, uint8_t(255));
+                        continue;
+                    }
+                    const int x0 = static_cast<int>(static_cast<uint64_t>(x) * width / tile);
+                    const int x1 = std::max(x0 + 1, static_cast<int>(static_cast<uint64_t>(x + 1) * width / tile));
+                    const int y0 = static_cast<int>(static_cast<uint64_t>(y) * height / tile);
+                    const int y1 = std::max(y0 + 1, static_cast<int>(static_cast<uint64_t>(y + 1) * height / tile));
+                    uint32_t sum[4] = {};
+                    for (int sy = y0; sy < y1; ++sy) {
+                        for (int sx = x0; sx < x1; ++sx) {
+                            const stbi_uc* src = &pixels[(static_cast<size_t>(sy) * width + sx) * 4];
+                            for (int k = 0; k < 4; ++k) sum[k] += src[k];
+                        }
+                    }
+                    const uint32_t count = static_cast<uint32_t>((x1 - x0) * (y1 - y0));
+                    for (int k = 0; k < 4; ++k) dst[k] = static_cast<uint8_t>(sum[k] / count);
+                }
+            }
+            if (pixels) stbi_image_free(pixels);
+        }
+
+        struct RegionResult {
+            std::string proxy_path;
+            Bounds bounds;
+            float switch_distance = 0.0f;
+            uint32_t source_triangles = 0;
+            uint32_t proxy_triangles = 0;
+            std::vector<uint32_t> members; // Flat (entity, submesh) pairs
+        };
+
+        bool build_region(const std::string& name, const std::vector<Member>& members, const std::filesystem::path& output_dir,
+            const std::filesystem::path& root, const HLODBuildOptions& options, RegionResult& result) {
+            // 1. One atlas tile per distinct source texture
+            std::vector<std::string> textures;
+            std::vector<uint32_t> member_tiles(members.size());
+            for (size_t m = 0; m < members.size(); ++m) {
+                const auto& mesh = *members[m].mesh;
+                const uint32_t material = mesh.submeshes[members[m].submesh].material_id;
+                const std::string texture = material < mesh.texture_paths.size() ? mesh.texture_paths[material] : std::string();
+                auto it = std::find(textures.begin(), textures.end(), texture);
+                member_tiles[m] = static_cast<uint32_t>(it - textures.begin());
+                if (it == textures.end()) textures.push_back(texture);
+            }
+            const uint32_t columns = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(textures.size()))));
+            const uint32_t rows = static_cast<uint32_t>((textures.size() + columns - 1) / columns);
+            const uint32_t tile = options.atlas_tile;
+
+            // 2. Merge in world space, UVs remapped into the member's tile. A UV range inside one repeat maps
+            // exactly; tiled materials get squeezed into the tile, which is what the distance hides.
+            std::vector<asset::Vertex> vertices;
+            std::vector<uint32_t> indices;
+            std::unordered_map<uint32_t, uint32_t> remap;
+            const float inset = 1.0f / static_cast<float>(tile); // One texel, keeps bilinear taps inside the tile
+            for (size_t m = 0; m < members.size(); ++m) {
+                const auto& member = members[m];
+                const auto& mesh = *member.mesh;
+                const auto& desc = mesh.submeshes[member.submesh];
+                if (desc.index_start + static_cast<uint64_t>(desc.index_count) > mesh.indices.size()) continue;
+
+                remap.clear();
+                const uint32_t base = static_cast<uint32_t>(vertices.size());
+                float uv_min[2] = { std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
+                float uv_max[2] = { std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest() };
+                for (uint32_t i = 0; i + 2 < desc.index_count; i += 3) {
+                    const uint32_t* triangle = &mesh.indices[desc.index_start + i];
+                    if (triangle[0] >= mesh.vertices.size() || triangle[1] >= mesh.vertices.size() || triangle[2] >= mesh.vertices.size()) continue;
+                    for (int c = 0; c < 3; ++c) {
+                        auto [it, inserted] = remap.try_emplace(triangle[c], static_cast<uint32_t>(vertices.size()));
+                        if (inserted) {
+                            const auto& v = mesh.vertices[triangle[c]];
+                            asset::Vertex out{};
+                            member.transform.point(v.position, out.position);
+                            member.transform.direction(v.normal, out.normal);
+                            std::copy_n(v.uv, 2, out.uv);
+                            vertices.push_back(out);
+                            for (int k = 0; k < 2; ++k) {
+                                uv_min[k] = std::min(uv_min[k], v.uv[k]);
+                                uv_max[k] = std::max(uv_max[k], v.uv[k]);
+                            }
+                        }
+                        indices.push_back(it->second);
+                    }
+                }
+
+                const float tile_origin[2] = { static_cast<float>(member_tiles[m] % columns), static_cast<float>(member_tiles[m] / columns) };
+                float offset[2], scale[2];
+                for (int k = 0; k < 2; ++k) {
+                    const float cell = std::floor(uv_min[k]);
+                    offset[k] = uv_max[k] - cell <= 1.0f ? cell : uv_min[k];
+                    scale[k] = 1.0f / std::max(uv_max[k] - offset[k], 1.0f);
+                }
+                for (size_t v = base; v < vertices.size(); ++v) {
+                    for (int k = 0; k < 2; ++k) {
+                        const float local = std::clamp((vertices[v].uv[k] - offset[k]) * scale[k], 0.0f, 1.0f);
+                        const float grid = k == 0 ? static_cast<float>(columns) : static_cast<float>(rows);
+                        vertices[v].uv[k] = (tile_origin[k] + inset + local * (1.0f - 2.0f * inset)) / grid;
+                    }
+                }
+                result.members.push_back(member.entity);
+                result.members.push_back(member.submesh);
+                result.bounds.grow(member.bounds);
+            }
+            result.source_triangles = static_cast<uint32_t>(indices.size() / 3);
+            if (indices.empty()) return false;
+
+            // 3. Weld across the merged meshes so the simplifier can collapse over seams between them
+            std::vector<uint32_t> vertex_remap(vertices.size());
+            const size_t unique = meshopt_generateVertexRemap(vertex_remap.data(), indices.data(), indices.size(), vertices.data(), vertices.size(), sizeof(asset::Vertex));
+            std::vector<asset::Vertex> welded(unique);
+            meshopt_remapVertexBuffer(welded.data(), vertices.data(), vertices.size(), sizeof(asset::Vertex), vertex_remap.data());
+            meshopt_remapIndexBuffer(indices.data(), indices.data(), indices.size(), vertex_remap.data());
+
+            // 4. Simplify; the attribute seams of many small parts stall meshopt_simplify, the sloppy pass ignores topology
+            const size_t target = std::max<size_t>(3, static_cast<size_t>(indices.size() * options.ratio) / 3 * 3);
+            std::vector<uint32_t> simplified(indices.size());
+            float error = 0.0f;
+            size_t count = meshopt_simplify(simplified.data(), indices.data(), indices.size(), welded[0].position, welded.size(), sizeof(asset::Vertex),
+                target, options.target_error, 0, &error);
+            if (count > target * 2) {
+                count = meshopt_simplifySloppy(simplified.data(), indices.data(), indices.size(), welded[0].position, welded.size(), sizeof(asset::Vertex),
+                    target, options.target_error, &error);
+            }
+            if (count == 0) {
+                std::cerr << "[BudAssetTool] HLOD: " << name << " simplified to nothing, keeping the source detail" << std::endl;
+                simplified = indices;
+                count = indices.size();
+                error = 0.0f;
+            }
+            simplified.resize(count);
+
+            std::vector<asset::Vertex> proxy_vertices(welded.size());
+            const size_t proxy_vertex_count = meshopt_optimizeVertexFetch(proxy_vertices.data(), simplified.data(), simplified.size(), welded.data(), welded.size(), sizeof(asset::Vertex));
+            proxy_vertices.resize(proxy_vertex_count);
+            result.proxy_triangles = static_cast<uint32_t>(simplified.size() / 3);
+
+            // 5. Switch where the simplification error stays under options.pixel_error pixels
+            const float absolute_error = error * meshopt_simplifyScale(welded[0].position, welded.size(), sizeof(asset::Vertex));
+            result.switch_distance = options.switch_distance > 0.0f
+                ? options.switch_distance
+                : std::max(absolute_error / (PIXEL_ANGLE_1080P * std::max(options.pixel_error, 0.01f)), result.bounds.radius());
+
+            // 6. Atlas and proxy
+            const std::filesystem::path atlas_file = output_dir / (name + "_atlas.png");
+            const std::filesystem::path proxy_file = output_dir / (name + ".budmesh");
+            const uint32_t atlas_width = columns * tile;
+            const uint32_t atlas_height = rows * tile;
+            std::vector<uint8_t> atlas(static_cast<size_t>(atlas_width) * atlas_height * 4, 255);
+            for (uint32_t t = 0; t < textures.size(); ++t) {
+                bake_tile(textures[t].empty() ? std::filesystem::path() : root / textures[t], tile, atlas, atlas_width, t % columns, t / columns);
+            }
+            if (!stbi_write_png(atlas_file.string().c_str(), static_cast<int>(atlas_width), static_cast<int>(atlas_height), 4, atlas.data(), static_cast<int>(atlas_width * 4))) {
+                std::cerr << "[BudAssetTool] HLOD: failed to write " << atlas_file.generic_string() << std::endl;
+                return false;
+            }
+
+            BudMeshWriter writer;
+            writer.add_submesh(proxy_vertices, simplified, 0);
+            // Paths in the mesh are loaded through the engine's VFS, keep them relative to the root
+            const std::string atlas_path = root.empty() ? atlas_file.generic_string() : std::filesystem::relative(atlas_file, root).generic_string();
+            result.proxy_path = root.empty() ? proxy_file.generic_string() : std::filesystem::relative(proxy_file, root).generic_string();
+            return writer.write(proxy_file.string(), { atlas_path });
+        }
+    }
+
+    bool HLODBuilder::build(const std::string& scene_path, const std::string& output_dir, const HLODBuildOptions& options) {
+        const std::filesystem::path root = options.root;
+        auto data = bud::tool_support::read_binary_file(scene_path);
+        if (!data) {
+            std::cerr << "[BudAssetTool] HLOD: cannot read scene " << scene_path << std::endl;
+            return false;
+        }
+
+        nlohmann::json scene;
+        try {
+            scene = nlohmann::json::parse(data->begin(), data->end());
+        } catch (const std::exception& e) {
+            std::cerr << "[BudAssetTool] HLOD: failed to parse " << scene_path << ": " << e.what() << std::endl;
+            return false;
+        }
+        if (!scene.contains("entities") || !scene["entities"].is_array()) {
+            std::cerr << "[BudAssetTool] HLOD: " << scene_path << " has no entities" << std::endl;
+            return false;
+        }
+
+        // 1. Every (entity, submesh) into the XZ cell of its world bounds centre. Entity indices are the
+        // scene's, the runtime matches them against the entities it created from the same file.
+        std::map<std::string, SourceMesh> meshes;
+        std::map<std::pair<int32_t, int32_t>, std::vector<Member>> cells;
+        const auto& entities = scene["entities"];
+        for (uint32_t e = 0; e < entities.size(); ++e) {
+            const auto& entity = entities[e];
+            if (!entity.value("is_active", true) || !entity.value("is_static", true)) continue;
+
+            const std::string asset_path = entity.value("asset_path", std::string());
+            if (std::filesystem::path(asset_path).extension() != ".budmesh") {
+                // Submesh order has to match what the engine loads, which only .budmesh guarantees
+                std::cerr << "[BudAssetTool] HLOD: skipping entity " << e << " (" << asset_path << "), only .budmesh sources are merged" << std::endl;
+                continue;
+            }
+
+            auto it = meshes.find(asset_path);
+            if (it == meshes.end()) {
+                auto mesh = read_budmesh(root / asset_path);
+                if (!mesh) std::cerr << "[BudAssetTool] HLOD: cannot read " << (root / asset_path).generic_string() << std::endl;
+                it = meshes.emplace(asset_path, mesh ? std::move(*mesh) : SourceMesh{}).first;
+            }
+            if (it->second.submeshes.empty()) continue;
+
+            Transform transform;
+            if (entity.contains("transform") && entity["transform"].size() == 16) {
+                for (int k = 0; k < 16; ++k) transform.m[k] = entity["transform"][k].get<float>();
+            }
+
+            for (uint32_t s = 0; s < it->second.submeshes.size(); ++s) {
+                const auto& desc = it->second.submeshes[s];
+                Member member{ e, s, &it->second, transform, transform_bounds(transform, desc.aabb_min, desc.aabb_max) };
+                const float cx = 0.5f * (member.bounds.min[0] + member.bounds.max[0]);
+                const float cz = 0.5f * (member.bounds.min[2] + member.bounds.max[2]);
+                const auto key = std::make_pair(static_cast<int32_t>(std::floor(cx / options.cell_size)), static_cast<int32_t>(std::floor(cz / options.cell_size)));
+                cells[key].push_back(member);
+            }
+        }
+
+        std::error_code ec;
+        std::filesystem::create_directories(output_dir, ec);
+
+        // 2. One proxy per cell; a cell with a single draw would only trade detail for nothing
+        nlohmann::json manifest;
+        manifest["version"] = MANIFEST_VERSION;
+        manifest["scene"] = scene_path;
+        manifest["regions"] = nlohmann::json::array();
+        uint64_t total_source_triangles = 0, total_proxy_triangles = 0, total_source_draws = 0;
+        for (const auto& [key, members] : cells) {
+            if (members.size() < 2) continue;
+
+            const std::string name = "hlod_" + std::to_string(key.first) + "_" + std::to_string(key.second);
+            RegionResult region;
+            if (!build_region(name, members, output_dir, root, options, region)) {
+                std::cerr << "[BudAssetTool] HLOD: region " << name << " failed" << std::endl;
+                continue;
+            }
+
+            nlohmann::json r;
+            r["proxy"] = region.proxy_path;
+            r["bounds_min"] = { region.bounds.min[0], region.bounds.min[1], region.bounds.min[2] };
+            r["bounds_max"] = { region.bounds.max[0], region.bounds.max[1], region.bounds.max[2] };
+            r["switch_distance"] = region.switch_distance;
+            r["source_draws"] = members.size();
+            r["source_triangles"] = region.source_triangles;
+            r["proxy_triangles"] = region.proxy_triangles;
+            r["members"] = region.members;
+            manifest["regions"].push_back(std::move(r));
+
+            total_source_draws += members.size();
+            total_source_triangles += region.source_triangles;
+            total_proxy_triangles += region.proxy_triangles;
+            std::cout << "[BudAssetTool] HLOD " << name << ": " << members.size() << " draws, " << region.source_triangles << " -> "
+                << region.proxy_triangles << " triangles, switch at " << region.switch_distance << " m" << std::endl;
+        }
+
+        const auto manifest_path = std::filesystem::path(output_dir) / "hlod.json";
+        if (!bud::tool_support::write_text_file_atomic(manifest_path, manifest.dump(1))) {
+            std::cerr << "[BudAssetTool] HLOD: failed to write " << manifest_path.generic_string() << std::endl;
+            return false;
+        }
+
+        const size_t region_count = manifest["regions"].size();
+        std::cout << "[BudAssetTool] HLOD: " << region_count << " regions replace " << total_source_draws << " draws / " << total_source_triangles
+            << " triangles with " << region_count << " draws / " << total_proxy_triangles << " triangles when all are far" << std::endl;
+        return true;
+    }
+}
@@ -0,0 +1,25 @@
+﻿#pragma once
+#include <cstdint>
+#include <string>
+
+namespace bud::tool {
+    struct HLODBuildOptions {
+        std::string root;              // Scene asset paths are relative to this (the engine's VFS root), empty = working directory
+        float cell_size = 32.0f;       // XZ region size in metres, every submesh goes to the cell holding its bounds centre
+        float ratio = 0.1f;            // Proxy index count relative to the merged source
+        float target_error = 0.01f;    // meshopt_simplify error, relative to the region's extent
+        float pixel_error = 1.0f;      // Switch distance puts the simplification error under this many pixels at 1080p / 60 degrees
+        float switch_distance = 0.0f;  // > 0 overrides the error based distance for every region
+        uint32_t atlas_tile = 128;     // Pixels per source texture in a region's atlas
+    };
+
+    // Offline hierarchical LOD for static scene geometry. The scene's .budmesh entities are split per submesh
+    // into a grid of regions; each region becomes one merged, simplified proxy mesh textured from a baked atlas
+    // of its source textures. Writes hlod_<x>_<z>.budmesh / _atlas.png per region and hlod.json, which lists
+    // the region bounds, switch distance, source draw / triangle counts and the (entity, submesh) pairs the
+    // proxy replaces.
+    class HLODBuilder {
+    public:
+        static bool build(const std::string& scene_path, const std::string& output_dir, const HLODBuildOptions& options);
+    };
+}
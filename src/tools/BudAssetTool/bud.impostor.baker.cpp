@@ -0,0 +1,281 @@
+﻿#include "bud.impostor.baker.hpp"
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+#include <nlohmann/json.hpp>
+
+// The tool does not link the engine's bud_third_party, stb gets its own implementation here
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+
+#include "../bud_tool_support/bud_tool_support.hpp"
+
+namespace bud::tool {
+
+    namespace {
+        constexpr float TWO_PI = 6.28318530718f;
+        constexpr uint8_t ALPHA_CUTOFF = 128; // main.frag / impostor.frag discard below 0.5
+
+        struct MaterialTexture {
+            int width = 0;
+            int height = 0;
+            std::vector<uint8_t> rgba;            // Empty = flat diffuse colour
+            uint8_t color[4] = { 255, 255, 255, 255 };
+
+            // Nearest, wrapped; UVs are flipped on import so v = 0 is the first row
+            const uint8_t* sample(float u, float v) const {
+                if (rgba.empty()) return color;
+                u -= std::floor(u);
+                v -= std::floor(v);
+                const int x = std::min(static_cast<int>(u * width), width - 1);
+                const int y = std::min(static_cast<int>(v * height), height - 1);
+                return &rgba[(static_cast<size_t>(y) * width + x) * 4];
+            }
+        };
+
+        struct Triangle {
+            aiVector3D position[3];
+            float uv[3][2];
+            uint32_t material;
+        };
+
+        MaterialTexture load_material(const aiMaterial* material, const std::filesystem::path& base_dir) {
+            MaterialTexture texture;
+            aiColor4D diffuse(1.0f, 1.0f, 1.0f, 1.0f);
+            if (aiGetMaterialColor(material, AI_MATKEY_COLOR_DIFFUSE, &diffuse) == AI_SUCCESS) {
+                texture.color[0] = static_cast<uint8_t>(std::clamp(diffuse.r, 0.0f, 1.0f) * 255.0f);
+                texture.color[1] = static_cast<uint8_t>(std::clamp(diffuse.g, 0.0f, 1.0f) * 255.0f);
+                texture.color[2] = static_cast<uint8_t>(std::clamp(diffuse.b, 0.0f, 1.0f) * 255.0f);
+            }
+
+            aiString path;
+            const bool has_texture = material->GetTexture(aiTextureType_DIFFUSE, 0, &path) == AI_SUCCESS
+                || material->GetTexture(aiTextureType_BASE_COLOR, 0, &path) == AI_SUCCESS;
+            if (!has_texture || path.length == 0 || path.data[0] == '*') return texture; // Embedded textures keep the flat colour
+
+            const auto file = (base_dir / path.C_Str()).string();
+            int channels = 0;
+            stbi_uc* pixels = stbi_load(file.c_str(), &texture.width, &texture.height, &channels, STBI_rgb_alpha);
+            if (!pixels) {
+                std::cerr << "[BudAssetTool] Impostor: cannot read texture " << file << ", using the diffuse colour" << std::endl;
+                return texture;
+            }
+            texture.rgba.assign(pixels, pixels + static_cast<size_t>(texture.width) * texture.height * 4);
+            stbi_image_free(pixels);
+            return texture;
+        }
+
+        float edge(float ax, float ay, float bx, float by, float px, float py) {
+            return (bx - ax) * (py - ay) - (by - ay) * (px - ax);
+        }
+    }
+
+    bool ImpostorBaker::bake(const std::string& input_path, const std::string& output_path, const ImpostorBakeOptions& options, ImpostorCard& card) {
+        Assimp::Importer importer;
+        const aiScene* scene = importer.ReadFile(input_path, aiProcess_Triangulate | aiProcess_PreTransformVertices | aiProcess_FlipUVs);
+        if (!scene || !scene->HasMeshes()) {
+            std::cerr << "[BudAssetTool] Impostor: failed to load " << input_path << ": " << importer.GetErrorString() << std::endl;
+            return false;
+        }
+
+        const auto base_dir = std::filesystem::path(input_path).parent_path();
+        std::vector<MaterialTexture> materials;
+        materials.reserve(scene->mNumMaterials);
+        for (unsigned int m = 0; m < scene->mNumMaterials; ++m) {
+            materials.push_back(load_material(scene->mMaterials[m], base_dir));
+        }
+        if (materials.empty()) materials.emplace_back();
+
+        std::vector<Triangle> triangles;
+        float min_y = std::numeric_limits<float>::max();
+        float max_y = std::numeric_limits<float>::lowest();
+        float radius = 0.0f;
+        for (unsigned int m = 0; m < scene->mNumMeshes; ++m) {
+            const aiMesh* mesh = scene->mMeshes[m];
+            for (unsigned int v = 0; v < mesh->mNumVertices; ++v) {
+                const auto& p = mesh->mVertices[v];
+                min_y = std::min(min_y, p.y);
+                max_y = std::max(max_y, p.y);
+                radius = std::max(radius, std::sqrt(p.x * p.x + p.z * p.z));
+            }
+            for (unsigned int f = 0; f < mesh->mNumFaces; ++f) {
+                const aiFace& face = mesh->mFaces[f];
+                if (face.mNumIndices != 3) continue;
+                Triangle tri{};
+                tri.material = std::min(mesh->mMaterialIndex, static_cast<unsigned int>(materials.size() - 1));
+                for (int k = 0; k < 3; ++k) {
+                    const unsigned int index = face.mIndices[k];
+                    tri.position[k] = mesh->mVertices[index];
+                    if (mesh->HasTextureCoords(0)) {
+                        tri.uv[k][0] = mesh->mTextureCoords[0][index].x;
+                        tri.uv[k][1] = mesh->mTextureCoords[0][index].y;
+                    }
+                }
+                triangles.push_back(tri);
+            }
+        }
+
+        if (triangles.empty() || radius <= 0.0f || max_y <= min_y) {
+            std::cerr << "[BudAssetTool] Impostor: " << input_path << " has no usable triangles" << std::endl;
+            return false;
+        }
+
+        card.frames = std::max(options.frames, 1u);
+        card.width = radius * 2.0f;
+        card.height = max_y - min_y;
+        card.base = min_y;
+
+        const uint32_t frame_w = std::max(options.frame_size, 1u);
+        const uint32_t frame_h = std::max(1u, static_cast<uint32_t>(std::lround(frame_w * card.height / card.width)));
+        const uint32_t ss = std::max(options.supersample, 1u);
+        const uint32_t raster_w = frame_w * ss;
+        const uint32_t raster_h = frame_h * ss;
+        const uint32_t atlas_w = frame_w * card.frames;
+
+        std::vector<uint8_t> atlas(static_cast<size_t>(atlas_w) * frame_h * 4, 0);
+        std::vector<uint8_t> filled(static_cast<size_t>(atlas_w) * frame_h, 0); // Texel has a colour, covered or dilated
+
+        std::vector<float> depth(static_cast<size_t>(raster_w) * raster_h);
+        std::vector<uint8_t> raster(static_cast<size_t>(raster_w) * raster_h * 4);
+        std::vector<uint8_t> covered(static_cast<size_t>(raster_w) * raster_h);
+
+        for (uint32_t frame = 0; frame < card.frames; ++frame) {
+            // Same frame as impostor.vert: the camera sits towards (sin a, 0, cos a), the card's +x runs along right
+            const float azimuth = TWO_PI * static_cast<float>(frame) / static_cast<float>(card.frames);
+            const aiVector3D to_camera(std::sin(azimuth), 0.0f, std::cos(azimuth));
+            const aiVector3D right(to_camera.z, 0.0f, -to_camera.x);
+
+            std::fill(depth.begin(), depth.end(), std::numeric_limits<float>::lowest());
+            std::fill(covered.begin(), covered.end(), 0);
+
+            for (const auto& tri : triangles) {
+                float sx[3], sy[3], sz[3];
+                for (int k = 0; k < 3; ++k) {
+                    const auto& p = tri.position[k];
+                    sx[k] = ((p * right) / card.width + 0.5f) * raster_w;
+                    sy[k] = (1.0f - (p.y - card.base) / card.height) * raster_h;
+                    sz[k] = p * to_camera; // Larger is nearer
+                }
+
+                const float area = edge(sx[0], sy[0], sx[1], sy[1], sx[2], sy[2]);
+                if (std::fabs(area) < 1e-8f) continue;
+
+                const int x0 = std::max(0, static_cast<int>(std::floor(std::min({ sx[0], sx[1], sx[2] }))));
+                const int x1 = std::min(static_cast<int>(raster_w) - 1, static_cast<int>(std::ceil(std::max({ sx[0], sx[1], sx[2] }))));
+                const int y0 = std::max(0, static_cast<int>(std::floor(std::min({ sy[0], sy[1], sy[2] }))));
+                const int y1 = std::min(static_cast<int>(raster_h) - 1, static_cast<int>(std::ceil(std::max({ sy[0], sy[1], sy[2] }))));
+                const auto& texture = materials[tri.material];
+
+                // Two-sided, dividing by the signed area makes the weights positive inside for either winding
+                for (int y = y0; y <= y1; ++y) {
+                    for (int x = x0; x <= x1; ++x) {
+                        const float px = x + 0.5f;
+                        const float py = y + 0.5f;
+                        const float w0 = edge(sx[1], sy[1], sx[2], sy[2], px, py) / area;
+                        const float w1 = edge(sx[2], sy[2], sx[0], sy[0], px, py) / area;
+                        const float w2 = 1.0f - w0 - w1;
+                        if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f) continue;
+
+                        const size_t pixel = static_cast<size_t>(y) * raster_w + x;
+                        const float z = w0 * sz[0] + w1 * sz[1] + w2 * sz[2];
+                        if (z <= depth[pixel]) continue;
+
+                        // Orthographic, affine UVs are exact
+                        const float u = w0 * tri.uv[0][0] + w1 * tri.uv[1][0] + w2 * tri.uv[2][0];
+                        const float v = w0 * tri.uv[0][1] + w1 * tri.uv[1][1] + w2 * tri.uv[2][1];
+                        const uint8_t* texel = texture.sample(u, v);
+                        if (texel[3] < ALPHA_CUTOFF) continue;
+
+                        depth[pixel] = z;
+                        covered[pixel] = 1;
+                        std::copy(texel, texel + 3, &raster[pixel * 4]);
+                    }
+                }
+            }
+
+            // Box filter down: alpha is the covered fraction, colour the average of the covered samples
+            for (uint32_t y = 0; y < frame_h; ++y) {
+                for (uint32_t x = 0; x < frame_w; ++x) {
+                    uint32_t count = 0;
+                    uint32_t sum[3] = {};
+                    for (uint32_t sy = 0; sy < ss; ++sy) {
+                        for (uint32_t sx = 0; sx < ss; ++sx) {
+                            const size_t pixel = static_cast<size_t>(y * ss + sy) * raster_w + (x * ss + sx);
+                            if (!covered[pixel]) continue;
+                            count++;
+                            for (int c = 0; c < 3; ++c) sum[c] += raster[pixel * 4 + c];
+                        }
+                    }
+                    if (count == 0) continue;
+
+                    const size_t texel = static_cast<size_t>(y) * atlas_w + frame * frame_w + x;
+                    for (int c = 0; c < 3; ++c) atlas[texel * 4 + c] = static_cast<uint8_t>(sum[c] / count);
+                    atlas[texel * 4 + 3] = static_cast<uint8_t>(count * 255 / (ss * ss));
+                    filled[texel] = 1;
+                }
+            }
+        }
+
+        // Colour dilation into the transparent texels, alpha stays 0. Neighbours from another frame are ignored.
+        for (uint32_t pass = 0; pass < options.dilate; ++pass) {
+            std::vector<uint8_t> next_filled = filled;
+            for (uint32_t y = 0; y < frame_h; ++y) {
+                for (uint32_t x = 0; x < atlas_w; ++x) {
+                    const size_t texel = static_cast<size_t>(y) * atlas_w + x;
+                    if (filled[texel]) continue;
+
+                    const uint32_t frame_x0 = (x / frame_w) * frame_w;
+                    uint32_t count = 0;
+                    uint32_t sum[3] = {};
+                    for (int dy = -1; dy <= 1; ++dy) {
+                        for (int dx = -1; dx <= 1; ++dx) {
+                            const int nx = static_cast<int>(x) + dx;
+                            const int ny = static_cast<int>(y) + dy;
+                            if (nx < static_cast<int>(frame_x0) || nx >= static_cast<int>(frame_x0 + frame_w) || ny < 0 || ny >= static_cast<int>(frame_h)) continue;
+                            const size_t neighbour = static_cast<size_t>(ny) * atlas_w + nx;
+                            if (!filled[neighbour]) continue;
+                            count++;
+                            for (int c = 0; c < 3; ++c) sum[c] += atlas[neighbour * 4 + c];
+                        }
+                    }
+                    if (count == 0) continue;
+                    for (int c = 0; c < 3; ++c) atlas[texel * 4 + c] = static_cast<uint8_t>(sum[c] / count);
+                    next_filled[texel] = 1;
+                }
+            }
+            filled.swap(next_filled);
+        }
+
+        std::error_code ec;
+        const auto output = std::filesystem::path(output_path);
+        if (output.has_parent_path()) std::filesystem::create_directories(output.parent_path(), ec);
+        if (!stbi_write_png(output_path.c_str(), static_cast<int>(atlas_w), static_cast<int>(frame_h), 4, atlas.data(), static_cast<int>(atlas_w * 4))) {
+            std::cerr << "[BudAssetTool] Impostor: failed to write " << output_path << std::endl;
+            return false;
+        }
+
+        nlohmann::json sidecar;
+        sidecar["impostor_frames"] = card.frames;
+        sidecar["impostor_size"] = { card.width, card.height };
+        sidecar["impostor_base"] = card.base;
+        auto sidecar_path = output;
+        sidecar_path.replace_extension(".json");
+        if (!bud::tool_support::write_text_file_atomic(sidecar_path, sidecar.dump(1))) {
+            std::cerr << "[BudAssetTool] Impostor: failed to write " << sidecar_path.generic_string() << std::endl;
+            return false;
+        }
+
+        std::cout << "[BudAssetTool] Impostor: " << card.frames << " frames of " << frame_w << "x" << frame_h << " from "
+            << triangles.size() << " triangles, card " << card.width << " x " << card.height << " (base " << card.base << ")" << std::endl;
+        return true;
+    }
+}
@@ -0,0 +1,28 @@
+﻿#pragma once
+#include <cstdint>
+#include <string>
+
+namespace bud::tool {
+    struct ImpostorBakeOptions {
+        uint32_t frames = 8;          // Azimuth views, frame f seen from 2 pi f / frames around +Y
+        uint32_t frame_size = 256;    // Frame width in pixels, the height follows the card's aspect
+        uint32_t supersample = 2;     // Rasterized at frame_size * supersample, box filtered down
+        uint32_t dilate = 4;          // Texels the colour bleeds into transparent space, keeps mip edges from going dark
+    };
+
+    // Card layout the runtime needs, also written to <atlas>.json with the scene's FoliageLayer keys
+    struct ImpostorCard {
+        uint32_t frames = 0;
+        float width = 0.0f;   // Card width at scale 1, twice the largest distance from the +Y axis
+        float height = 0.0f;
+        float base = 0.0f;    // Lowest point above the pivot
+    };
+
+    // Orthographic albedo + coverage views of a mesh around +Y, packed left to right into one RGBA PNG.
+    // Lighting is left to impostor.frag. Any assimp-readable mesh works, diffuse textures are resolved
+    // next to the mesh file.
+    class ImpostorBaker {
+    public:
+        static bool bake(const std::string& input_path, const std::string& output_path, const ImpostorBakeOptions& options, ImpostorCard& card);
+    };
+}
@@ -0,0 +1,345 @@
+﻿#include "bud.shader.cache.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <unordered_set>
+
+#include <nlohmann/json.hpp>
+
+#include "../bud_tool_support/bud_tool_support.hpp"
+
+namespace bud::tool {
+
+    namespace {
+        constexpr int MANIFEST_VERSION = 1;
+
+        // FNV-1a, only has to tell cache generations apart
+        struct Hasher {
+            uint64_t value = 14695981039346656037ull;
+
+            void add(const void* data, size_t size) {
+                const auto* bytes = static_cast<const unsigned char*>(data);
+                for (size_t i = 0; i < size; ++i) {
+                    value ^= bytes[i];
+                    value *= 1099511628211ull;
+                }
+            }
+            void add(const std::string& text) {
+                add(text.data(), text.size());
+                add("\0", 1); // Field separator, "ab"+"c" != "a"+"bc"
+            }
+        };
+
+        std::string to_hex(uint64_t value) {
+            char buf[17];
+            std::snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(value));
+            return buf;
+        }
+
+        std::string normalized(const std::filesystem::path& p) {
+            std::error_code ec;
+            auto abs = std::filesystem::weakly_canonical(p, ec);
+            return (ec ? p : abs).generic_string();
+        }
+
+        // `#include "file"` / `#include <file>`, other lines return false
+        bool parse_include(const std::string& line, std::string& name, bool& quoted) {
+            size_t pos = line.find_first_not_of(" \t");
+            if (pos == std::string::npos || line[pos] != '#') return false;
+            pos = line.find_first_not_of(" \t", pos + 1);
+            if (pos == std::string::npos || line.compare(pos, 7, "include") != 0) return false;
+            pos = line.find_first_not_of(" \t", pos + 7);
+            if (pos == std::string::npos) return false;
+
+            char close = 0;
+            if (line[pos] == '"') close = '"';
+            else if (line[pos] == '<') close = '>';
+            else return false;
+
+            size_t end = line.find(close, pos + 1);
+            if (end == std::string::npos) return false;
+            name = line.substr(pos + 1, end - pos - 1);
+            quoted = close == '"';
+            return !name.empty();
+        }
+
+        std::string quote(const std::string& text) {
+            return "\"" + text + "\"";
+        }
+    }
+
+    ShaderCache::ShaderCache(ShaderCacheOptions options) : options(std::move(options)) {
+        if (this->options.workers == 0) {
+            if (auto env = bud::tool_support::get_env_var("BUD_SHADER_WORKERS")) {
+                try { this->options.workers = std::stoul(*env); } catch (...) {}
+            }
+        }
+        if (this->options.workers == 0) {
+            unsigned int hw = std::thread::hardware_concurrency();
+            this->options.workers = hw == 0 ? 1u : hw;
+        }
+    }
+
+    bool ShaderCache::load() {
+        entries.clear();
+        auto data = bud::tool_support::read_binary_file(manifest_path());
+        if (!data) return true; // First build
+
+        try {
+            auto manifest = nlohmann::json::parse(data->begin(), data->end());
+            if (manifest.value("version", 0) != MANIFEST_VERSION) {
+                std::cout << "[BudAssetTool] Shader cache format changed, rebuilding all shaders." << std::endl;
+                return true;
+            }
+            for (const auto& [output, e] : manifest["entries"].items()) {
+                Entry entry;
+                entry.key = e.value("key", std::string());
+                entry.deps = e.value("deps", std::vector<std::string>());
+                entry.payload = e.value("payload", std::string());
+                entries.emplace(output, std::move(entry));
+            }
+        } catch (const std::exception& e) {
+            // A corrupt manifest only costs a full rebuild
+            std::cerr << "[BudAssetTool] Ignoring unreadable shader cache " << manifest_path() << ": " << e.what() << std::endl;
+            entries.clear();
+        }
+        return true;
+    }
+
+    bool ShaderCache::save() const {
+        std::error_code ec;
+        std::filesystem::create_directories(options.cache_dir, ec);
+
+        nlohmann::json manifest;
+        manifest["version"] = MANIFEST_VERSION;
+        manifest["compiler"] = compiler_version;
+        manifest["entries"] = nlohmann::json::object();
+
+        // Sorted, so the manifest diffs cleanly between builds
+        std::vector<const std::pair<const std::string, Entry>*> sorted;
+        sorted.reserve(entries.size());
+        for (const auto& kv : entries) sorted.push_back(&kv);
+        std::sort(sorted.begin(), sorted.end(), [](auto* a, auto* b) { return a->first < b->first; });
+
+        for (const auto* kv : sorted) {
+            nlohmann::json e;
+            e["key"] = kv->second.key;
+            e["deps"] = kv->second.deps;
+            if (!kv->second.payload.empty()) e["payload"] = kv->second.payload;
+            manifest["entries"][kv->first] = std::move(e);
+        }
+
+        if (!bud::tool_support::write_text_file_atomic(manifest_path(), manifest.dump(1))) {
+            std::cerr << "[BudAssetTool] Failed to write shader cache " << manifest_path() << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    const std::string& ShaderCache::get_compiler_version() {
+        if (compiler_version.empty()) {
+            auto res = bud::tool_support::run_process_capture(quote(options.compiler) + " --version");
+            compiler_version = res.exit_code == 0 ? res.stdout_str : std::string("unknown");
+            // First line is enough ("shaderc v2023.8 ...") and keeps the manifest readable
+            compiler_version = compiler_version.substr(0, compiler_version.find_first_of("\r\n"));
+        }
+        return compiler_version;
+    }
+
+    std::string ShaderCache::compute_key(const std::filesystem::path& source, std::vector<std::string>& deps) const {
+        Hasher hasher;
+        hasher.add(compiler_version);
+        hasher.add(options.target_env);
+
+        std::vector<std::string> defines = options.defines;
+        std::sort(defines.begin(), defines.end());
+        for (const auto& d : defines) hasher.add("-D" + d);
+        for (const auto& dir : options.include_dirs) hasher.add("-I" + normalized(dir));
+
+        // Depth-first over the include graph; every file is hashed once, in a stable order
+        std::unordered_set<std::string> visited;
+        std::vector<std::filesystem::path> stack = { source };
+        deps.clear();
+        while (!stack.empty()) {
+            auto file = stack.back();
+            stack.pop_back();
+
+            const std::string file_key = normalized(file);
+            if (!visited.insert(file_key).second) continue;
+
+            auto data = bud::tool_support::read_binary_file(file);
+            hasher.add(file_key);
+            if (!data) {
+                hasher.add("<missing>"); // Appearing later changes the key
+                continue;
+            }
+            hasher.add(data->data(), data->size());
+            if (file != source) deps.push_back(file_key);
+
+            std::istringstream lines(std::string(data->begin(), data->end()));
+            std::string line;
+            std::vector<std::filesystem::path> includes;
+            while (std::getline(lines, line)) {
+                std::string name;
+                bool quoted = false;
+                if (!parse_include(line, name, quoted)) continue;
+
+                // Quoted: includer's directory first, then -I (glslc order)
+                std::filesystem::path resolved;
+                if (quoted && std::filesystem::exists(file.parent_path() / name)) {
+                    resolved = file.parent_path() / name;
+                } else {
+                    for (const auto& dir : options.include_dirs) {
+                        if (std::filesystem::exists(dir / name)) { resolved = dir / name; break; }
+                    }
+                }
+                includes.push_back(resolved.empty() ? file.parent_path() / name : resolved);
+            }
+            // Reverse, so the first include is visited first
+            stack.insert(stack.end(), includes.rbegin(), includes.rend());
+        }
+
+        return to_hex(hasher.value);
+    }
+
+    bool ShaderCache::compile(const ShaderJob& job, std::string& log) const {
+        std::error_code ec;
+        if (job.output.has_parent_path()) std::filesystem::create_directories(job.output.parent_path(), ec);
+
+        std::ostringstream cmd;
+        cmd << quote(options.compiler) << " --target-env=" << options.target_env;
+        for (const auto& d : options.defines) cmd << " -D" << d;
+        for (const auto& dir : options.include_dirs) cmd << " -I " << quote(dir.string());
+        cmd << ' ' << quote(job.source.string()) << " -o " << quote(job.output.string());
+
+        auto res = bud::tool_support::run_process_capture(cmd.str());
+        log = res.stderr_str;
+        return res.exit_code == 0;
+    }
+
+    std::vector<ShaderResult> ShaderCache::build(const std::vector<ShaderJob>& jobs, const Postprocess& postprocess, ShaderCacheStats& stats) {
+        auto start = std::chrono::steady_clock::now();
+        get_compiler_version();
+
+        stats = {};
+        stats.total = static_cast<uint32_t>(jobs.size());
+
+        std::vector<ShaderResult> results(jobs.size());
+        std::vector<Entry> updated(jobs.size());
+        std::vector<char> dirty(jobs.size(), 0);
+        std::vector<char> dropped(jobs.size(), 0);
+
+        // Workers pull jobs in order; `entries` is only read until they're joined
+        std::atomic<size_t> next{ 0 };
+        std::atomic<uint32_t> hits{ 0 }, compiled{ 0 }, failed{ 0 };
+        auto worker = [&]() {
+            for (size_t i = next.fetch_add(1); i < jobs.size(); i = next.fetch_add(1)) {
+                const auto& job = jobs[i];
+                auto& result = results[i];
+                auto& entry = updated[i];
+
+                entry.key = compute_key(job.source, entry.deps);
+
+                auto cached = entries.find(normalized(job.output));
+                if (cached != entries.end() && cached->second.key == entry.key
+                    && std::filesystem::exists(job.output)
+                    && (!postprocess || !cached->second.payload.empty())) {
+                    result.ok = true;
+                    result.cache_hit = true;
+                    result.payload = cached->second.payload;
+                    hits.fetch_add(1);
+                    continue;
+                }
+
+                std::cout << "[BudAssetTool] Compiling shader: " << job.source.generic_string() << std::endl;
+                result.ok = compile(job, result.log);
+                if (!result.ok) {
+                    std::cerr << "[BudAssetTool] Failed to compile " << job.source.generic_string() << "\n" << result.log << std::endl;
+                    // The previous .spv would otherwise load as if the edit had compiled
+                    std::error_code ec;
+                    std::filesystem::remove(job.output, ec);
+                    dropped[i] = 1;
+                    failed.fetch_add(1);
+                    continue; // No entry, retried next build
+                }
+                if (postprocess) {
+                    result.payload = postprocess(job, job.output, result.log);
+                    entry.payload = result.payload;
+                }
+                dirty[i] = 1;
+                compiled.fetch_add(1);
+            }
+        };
+
+        const unsigned int thread_count = std::max(1u, std::min<unsigned int>(options.workers, static_cast<unsigned int>(jobs.size())));
+        std::vector<std::thread> threads;
+        threads.reserve(thread_count);
+        for (unsigned int t = 0; t < thread_count; ++t) threads.emplace_back(worker);
+        for (auto& t : threads) t.join();
+
+        for (size_t i = 0; i < jobs.size(); ++i) {
+            if (dirty[i]) entries[normalized(jobs[i].output)] = std::move(updated[i]);
+            else if (dropped[i]) entries.erase(normalized(jobs[i].output));
+        }
+
+        stats.hits = hits.load();
+        stats.compiled = compiled.load();
+        stats.failed = failed.load();
+        stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return results;
+    }
+
+    std::vector<std::filesystem::path> ShaderCache::collect_sources(const std::filesystem::path& dir, const std::vector<std::string>& extensions) {
+        std::vector<std::filesystem::path> files;
+        std::error_code ec;
+        for (auto& p : std::filesystem::recursive_directory_iterator(dir, ec)) {
+            if (!p.is_regular_file()) continue;
+            std::string ext = p.path().extension().string();
+            std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+            if (std::find(extensions.begin(), extensions.end(), ext) == extensions.end()) continue;
+            files.push_back(p.path());
+        }
+        std::sort(files.begin(), files.end());
+        return files;
+    }
+
+    bool compile_shader_directory(const std::filesystem::path& dir, const ShaderCacheOptions& options) {
+        std::error_code ec;
+        if (!std::filesystem::is_directory(dir, ec)) {
+            std::cerr << "[BudAssetTool] Shader directory does not exist: " << dir.generic_string() << std::endl;
+            return false;
+        }
+
+        ShaderCache cache(options);
+        cache.load();
+
+        // SPIR-V lands next to the source, where the runtime loads it from (src/shaders/x.vert.spv)
+        std::vector<ShaderJob> jobs;
+        for (const auto& path : ShaderCache::collect_sources(dir, SHADER_SOURCE_EXTENSIONS)) {
+            std::filesystem::path output = path;
+            output += ".spv";
+            jobs.push_back({ path, output });
+        }
+
+        ShaderCacheStats stats;
+        cache.build(jobs, nullptr, stats);
+        cache.save();
+        ShaderCache::print_stats(stats);
+        return stats.failed == 0;
+    }
+
+    void ShaderCache::print_stats(const ShaderCacheStats& stats) {
+        char rate[16];
+        std::snprintf(rate, sizeof(rate), "%.1f", stats.hit_rate());
+        char seconds[16];
+        std::snprintf(seconds, sizeof(seconds), "%.2f", stats.seconds);
+        std::cout << "[BudAssetTool] Shader cache: " << stats.total << " shaders, " << stats.hits << " up to date (" << rate << "%), "
+            << stats.compiled << " compiled, " << stats.failed << " failed in " << seconds << " s" << std::endl;
+    }
+}
@@ -0,0 +1,86 @@
+﻿#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace bud::tool {
+    struct ShaderCacheOptions {
+        std::filesystem::path cache_dir;                  // Holds shader_cache.json (and validation SPIR-V)
+        std::vector<std::filesystem::path> include_dirs;  // -I, searched after the including file's directory
+        std::vector<std::string> defines;                 // NAME or NAME=VALUE, passed as -D
+        std::string compiler = "glslc";
+        std::string target_env = "vulkan1.3";
+        unsigned int workers = 0;                         // 0: BUD_SHADER_WORKERS, then hardware_concurrency
+    };
+
+    struct ShaderJob {
+        std::filesystem::path source;
+        std::filesystem::path output;
+    };
+
+    struct ShaderResult {
+        bool ok = false;
+        bool cache_hit = false;
+        std::string log;      // Compiler stderr
+        std::string payload;  // Postprocess output, cached with the entry
+    };
+
+    struct ShaderCacheStats {
+        uint32_t total = 0;
+        uint32_t hits = 0;
+        uint32_t compiled = 0;
+        uint32_t failed = 0;
+        double seconds = 0.0;
+
+        float hit_rate() const { return total > 0 ? 100.0f * static_cast<float>(hits) / static_cast<float>(total) : 0.0f; }
+    };
+
+    // Persistent shader build cache. An output is up to date when it exists and its key matches,
+    // the key hashes the source, every transitively #included file, the defines, the target
+    // environment and the compiler version. Stale shaders are recompiled in parallel.
+    class ShaderCache {
+    public:
+        // Runs on a worker after a successful compile (log = compiler warnings), the returned text is cached with the entry
+        using Postprocess = std::function<std::string(const ShaderJob& job, const std::filesystem::path& spv, const std::string& log)>;
+
+        explicit ShaderCache(ShaderCacheOptions options);
+
+        bool load();
+        bool save() const;
+
+        // With a postprocess, a hit also requires its cached payload
+        std::vector<ShaderResult> build(const std::vector<ShaderJob>& jobs, const Postprocess& postprocess, ShaderCacheStats& stats);
+
+        // Sources with one of the given extensions under dir, sorted for a stable report order
+        static std::vector<std::filesystem::path> collect_sources(const std::filesystem::path& dir, const std::vector<std::string>& extensions);
+        static void print_stats(const ShaderCacheStats& stats);
+
+    private:
+        struct Entry {
+            std::string key;
+            std::vector<std::string> deps;
+            std::string payload;
+        };
+
+        std::string compute_key(const std::filesystem::path& source, std::vector<std::string>& deps) const;
+        bool compile(const ShaderJob& job, std::string& log) const;
+        const std::string& get_compiler_version();
+        std::filesystem::path manifest_path() const { return options.cache_dir / "shader_cache.json"; }
+
+        ShaderCacheOptions options;
+        std::string compiler_version;
+        std::unordered_map<std::string, Entry> entries;  // By output path
+    };
+
+    // Every stage the engine compiles (mirrors the SHADER_FILES glob of the top-level CMakeLists)
+    inline const std::vector<std::string> SHADER_SOURCE_EXTENSIONS = {
+        ".vert", ".frag", ".comp", ".geom", ".tesc", ".tese", ".mesh", ".task", ".rgen", ".rmiss", ".rchit"
+    };
+
+    // Compiles every shader under dir to <source>.spv through the cache, false when any failed.
+    // A failed shader loses its .spv and its manifest entry, nothing stale is left to load.
+    bool compile_shader_directory(const std::filesystem::path& dir, const ShaderCacheOptions& options);
+}
@@ -0,0 +1,39 @@
+﻿#include <iostream>
+#include <string>
+#include "bud.shader.cache.hpp"
+
+// Shader-only front end of BudAssetTool --compile-shaders. It links just the shader cache, so the
+// CompileShaders build step doesn't wait for assimp, meshoptimizer and the rest of the asset tool.
+
+void print_usage() {
+    std::cout << "Usage: BudShaderCompiler <dir> [--cache <dir>] [--compiler <glslc>] [--define NAME[=VALUE]]... [--include <dir>]... [--target-env <env>] [--workers <n>]" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2 || std::string(argv[1]) == "--help" || std::string(argv[1]) == "-h") {
+        print_usage();
+        return argc < 2 ? 1 : 0;
+    }
+
+    const std::string shader_dir = argv[1];
+    bud::tool::ShaderCacheOptions options;
+    options.cache_dir = "tmp/shader_cache";
+    for (int i = 2; i + 1 < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--cache") options.cache_dir = argv[++i];
+        else if (arg == "--compiler") options.compiler = argv[++i];
+        else if (arg == "--define" || arg == "-D") options.defines.push_back(argv[++i]);
+        else if (arg == "--include" || arg == "-I") options.include_dirs.push_back(argv[++i]);
+        else if (arg == "--target-env") options.target_env = argv[++i];
+        else if (arg == "--workers" || arg == "--max-workers") {
+            try { options.workers = std::stoul(argv[++i]); } catch (...) { options.workers = 0; }
+        }
+    }
+
+    std::cout << "[BudShaderCompiler] Compiling shaders in: " << shader_dir << std::endl;
+    if (bud::tool::compile_shader_directory(shader_dir, options)) {
+        return 0;
+    }
+    std::cerr << "[BudShaderCompiler] Shader compilation failed." << std::endl;
+    return 2;
+}
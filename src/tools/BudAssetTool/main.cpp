@@ -2,14 +2,22 @@
 #include <string>
 #include <vector>
 #include "bud.asset.processor.hpp"
+#include "bud.impostor.baker.hpp"
+#include "bud.hlod.builder.hpp"
 
 void print_usage() {
-    std::cout << "Usage: BudAssetTool --input <file.gltf> --output <file.budmesh>" << std::endl;
+    std::cout << "Usage: BudAssetTool --input <file.gltf> --output <file.budmesh> [--cluster-lod]" << std::endl;
+    std::cout << "       BudAssetTool --validate-shaders <dir> [--report <file.json>] [--workers <n>] [--cache <dir>]" << std::endl;
+    std::cout << "       BudAssetTool --compile-shaders <dir> [--cache <dir>] [--compiler <glslc>] [--define NAME[=VALUE]]... [--include <dir>]... [--workers <n>]" << std::endl;
+    std::cout << "       BudAssetTool --bundle-shaders <dir> --output <file> [--report <shader_report.json>] [--root <dir>] [--compress]" << std::endl;
+    std::cout << "       BudAssetTool --bake-impostor <mesh> --output <atlas.png> [--frames <n>] [--frame-size <px>]" << std::endl;
+    std::cout << "       BudAssetTool --build-hlod <scene.json> --output <dir> [--root <dir>] [--cell-size <m>] [--ratio <r>] [--pixel-error <px>] [--switch-distance <m>] [--atlas-tile <px>]" << std::endl;
 }
 
 int main(int argc, char* argv[]) {
     std::string input_path;
     std::string output_path;
+    bool cluster_lod = false;
 
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
@@ -17,19 +25,137 @@ int main(int argc, char* argv[]) {
             input_path = argv[++i];
         } else if (arg == "--output" && i + 1 < argc) {
             output_path = argv[++i];
+        } else if (arg == "--cluster-lod") {
+            cluster_lod = true;
         } else if (arg == "--help" || arg == "-h") {
             print_usage();
             return 0;
         }
     }
+    // If --compile-shaders is provided build the shaders through the incremental shader cache
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--compile-shaders" && i + 1 < argc) {
+            std::string shader_dir = argv[++i];
+            bud::tool::ShaderCacheOptions options;
+            options.cache_dir = "tmp/shader_cache";
+            for (int j = i + 1; j + 1 < argc; ++j) {
+                std::string a = argv[j];
+                if (a == "--cache") options.cache_dir = argv[++j];
+                else if (a == "--compiler") options.compiler = argv[++j];
+                else if (a == "--define" || a == "-D") options.defines.push_back(argv[++j]);
+                else if (a == "--include" || a == "-I") options.include_dirs.push_back(argv[++j]);
+                else if (a == "--target-env") options.target_env = argv[++j];
+                else if (a == "--workers" || a == "--max-workers") {
+                    try { options.workers = std::stoul(argv[++j]); } catch (...) { options.workers = 0; }
+                }
+            }
+            std::cout << "[BudAssetTool] Compiling shaders in: " << shader_dir << std::endl;
+            if (bud::tool::AssetProcessor::compile_shaders_in_directory(shader_dir, options)) {
+                return 0;
+            }
+            std::cerr << "[BudAssetTool] Shader compilation failed." << std::endl;
+            return 2;
+        }
+    }
+
+    // If --bundle-shaders is provided pack the compiled SPIR-V into one shader bundle
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--bundle-shaders" && i + 1 < argc) {
+            std::string shader_dir = argv[++i];
+            bud::tool::ShaderBundleOptions options;
+            for (int j = i + 1; j < argc; ++j) {
+                std::string a = argv[j];
+                if (a == "--report" && j + 1 < argc) options.report_path = argv[++j];
+                else if (a == "--root" && j + 1 < argc) options.root = argv[++j];
+                else if (a == "--compress") options.compress = true;
+            }
+            if (output_path.empty()) {
+                std::cerr << "[BudAssetTool] Error: --bundle-shaders needs --output <file>." << std::endl;
+                print_usage();
+                return 1;
+            }
+            std::cout << "[BudAssetTool] Bundling shaders in: " << shader_dir << std::endl;
+            if (bud::tool::AssetProcessor::bundle_shaders(shader_dir, output_path, options)) {
+                return 0;
+            }
+            std::cerr << "[BudAssetTool] Shader bundling failed." << std::endl;
+            return 2;
+        }
+    }
+
+    // If --bake-impostor is provided render the mesh's azimuth views into a foliage impostor atlas
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--bake-impostor" && i + 1 < argc) {
+            std::string mesh_path = argv[++i];
+            bud::tool::ImpostorBakeOptions options;
+            for (int j = i + 1; j < argc; ++j) {
+                std::string a = argv[j];
+                if (a == "--frames" && j + 1 < argc) {
+                    try { options.frames = std::stoul(argv[++j]); } catch (...) {}
+                }
+                else if (a == "--frame-size" && j + 1 < argc) {
+                    try { options.frame_size = std::stoul(argv[++j]); } catch (...) {}
+                }
+            }
+            if (output_path.empty()) {
+                std::cerr << "[BudAssetTool] Error: --bake-impostor needs --output <atlas.png>." << std::endl;
+                print_usage();
+                return 1;
+            }
+            std::cout << "[BudAssetTool] Baking impostor: " << mesh_path << " -> " << output_path << std::endl;
+            bud::tool::ImpostorCard card;
+            if (bud::tool::ImpostorBaker::bake(mesh_path, output_path, options, card)) {
+                return 0;
+            }
+            std::cerr << "[BudAssetTool] Impostor baking failed." << std::endl;
+            return 2;
+        }
+    }
+
+    // If --build-hlod is provided merge the scene's static meshes into per-region proxies
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--build-hlod" && i + 1 < argc) {
+            std::string scene_path = argv[++i];
+            bud::tool::HLODBuildOptions options;
+            for (int j = i + 1; j < argc; ++j) {
+                std::string a = argv[j];
+                if (j + 1 >= argc) break;
+                try {
+                    if (a == "--root") options.root = argv[++j];
+                    else if (a == "--cell-size") options.cell_size = std::stof(argv[++j]);
+                    else if (a == "--ratio") options.ratio = std::stof(argv[++j]);
+                    else if (a == "--pixel-error") options.pixel_error = std::stof(argv[++j]);
+                    else if (a == "--switch-distance") options.switch_distance = std::stof(argv[++j]);
+                    else if (a == "--atlas-tile") options.atlas_tile = std::stoul(argv[++j]);
+                } catch (...) {}
+            }
+            if (output_path.empty() || options.cell_size <= 0.0f || options.atlas_tile == 0) {
+                std::cerr << "[BudAssetTool] Error: --build-hlod needs --output <dir>, a positive --cell-size and --atlas-tile." << std::endl;
+                print_usage();
+                return 1;
+            }
+            std::cout << "[BudAssetTool] Building HLOD: " << scene_path << " -> " << output_path << std::endl;
+            if (bud::tool::HLODBuilder::build(scene_path, output_path, options)) {
+                return 0;
+            }
+            std::cerr << "[BudAssetTool] HLOD build failed." << std::endl;
+            return 2;
+        }
+    }
+
     // If --validate-shaders is provided use AssetProcessor shader validation mode
     std::string report_path;
+    std::string cache_dir;
     unsigned int cli_workers = 0;
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
         if (arg == "--validate-shaders" && i + 1 < argc) {
             std::string shader_dir = argv[++i];
-            // optional --report <path> and --workers <n>
+            // optional --report <path>, --workers <n> and --cache <dir>
             for (int j = i+1; j < argc; ++j) {
                 std::string a = argv[j];
                 if (a == "--report" && j + 1 < argc) {
@@ -38,9 +164,12 @@ int main(int argc, char* argv[]) {
                 if ((a == "--workers" || a == "--max-workers") && j + 1 < argc) {
                     try { cli_workers = std::stoul(argv[j+1]); } catch(...) { cli_workers = 0; }
                 }
+                if (a == "--cache" && j + 1 < argc) {
+                    cache_dir = argv[j+1];
+                }
             }
             std::cout << "[BudAssetTool] Validating shaders in: " << shader_dir << std::endl;
-            if (bud::tool::AssetProcessor::validate_shaders_in_directory(shader_dir, report_path, cli_workers)) {
+            if (bud::tool::AssetProcessor::validate_shaders_in_directory(shader_dir, report_path, cli_workers, cache_dir)) {
                 std::cout << "[BudAssetTool] Shader validation succeeded." << std::endl;
                 return 0;
             } else {
@@ -58,7 +187,7 @@ int main(int argc, char* argv[]) {
 
     std::cout << "[BudAssetTool] Processing glTF: " << input_path << " -> " << output_path << std::endl;
 
-    if (bud::tool::AssetProcessor::process_gltf_to_budmesh(input_path, output_path)) {
+    if (bud::tool::AssetProcessor::process_gltf_to_budmesh(input_path, output_path, cluster_lod)) {
         std::cout << "[BudAssetTool] Processed successfully." << std::endl;
         return 0;
     } else {
@@ -0,0 +1,1385 @@
+﻿#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <initializer_list>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "src/core/bud.math.hpp"
+#include "src/core/bud.asset.types.hpp"
+#include "src/core/bud.cluster_lod.hpp"
+#include "src/threading/bud.threading.hpp"
+#include "src/graphics/bud.graphics.scene.hpp"
+#include "src/graphics/bud.graphics.sortkey.hpp"
+#include "src/graphics/bud.graphics.graph.hpp"
+#include "src/graphics/bud.graphics.instances.hpp"
+#include "src/graphics/bud.graphics.submeshes.hpp"
+#include "src/graphics/bud.graphics.views.hpp"
+#include "src/graphics/bud.graphics.foliage.hpp"
+#include "src/graphics/bud.graphics.hlod.hpp"
+#include "src/io/bud.io.hpp"
+#include "src/runtime/bud.scene.io.hpp"
+#include "src/ml/bud.ml.onnx.hpp"
+
+// bud_benchmarks: isolated microbenchmarks of the engine's CPU hot paths, no window or GPU.
+//   --list                      Print benchmark names and exit
+//   --filter <substring>        Only run benchmarks whose name contains the substring
+//   --repetitions N             Measured repetitions per benchmark (default 20)
+//   --warmup N                  Unmeasured repetitions before calibration (default 3)
+//   --min-time-ms T             Each repetition loops the body until it takes at least T ms (default 10)
+//   --threads N                 Task scheduler threads (default hardware concurrency)
+//   --instances N               Render scene size for the BVH / culling / sort benchmarks (default 100000)
+//   --seed N                    Scene generation seed (default 1234)
+//   --mesh <file.budmesh>       load_bud_mesh / cluster LOD input (default data/meshlets/sponza.budmesh)
+//   --scene <file.json>         Scene parse input (default data/scenes/sponza_scene.json)
+//   --json <file>               Write the results as JSON
+// The ml/ group runs the ONNX Runtime CPU backend on generated stand-in models.
+// Times are per item (one queue op, one task, one AABB, one instance ...), so runs with different
+// sizes stay comparable. Compare median and cv between builds, mean and max absorb OS noise.
+// Some groups also check their results; a failed check is printed and the run exits with code 3.
+
+namespace {
+
+	struct Options {
+		std::string filter;
+		uint32_t repetitions = 20;
+		uint32_t warmup = 3;
+		double min_time_ms = 10.0;
+		uint32_t threads = 0;
+		uint32_t instances = 100000;
+		uint32_t seed = 1234;
+		std::string mesh_path = "data/meshlets/sponza.budmesh";
+		std::string scene_path = "data/scenes/sponza_scene.json";
+		std::string json_path;
+		bool list_only = false;
+	};
+
+	constexpr const char* BENCHMARK_NAMES[] = {
+		"threading/wsq_push_pop",
+		"threading/wsq_push_steal",
+		"threading/spawn_wait",
+		"threading/parallel_for",
+		"threading/fiber_switch",
+		"math/aabb_frustum",
+		"math/aabb_transform",
+		"math/morton_code",
+		"scene/lbvh_build",
+		"scene/lbvh_build_parallel",
+		"scene/cull_frustum",
+		"scene/drawkey_generate",
+		"scene/drawkey_sort",
+		"scene/submesh_keys",
+		"scene/submesh_keys_nested",
+		"scene/multiview_shared/1",
+		"scene/multiview_shared/2",
+		"scene/multiview_shared/4",
+		"scene/multiview_shared/8",
+		"scene/multiview_separate/1",
+		"scene/multiview_separate/2",
+		"scene/multiview_separate/4",
+		"scene/multiview_separate/8",
+		"foliage/build",
+		"foliage/cull",
+		"foliage/cull_shadow",
+		"scene/hlod_select",
+		"render/pack_instances",
+		"io/load_bud_mesh",
+		"io/cluster_lod_cut",
+		"io/scene_json_parse",
+		"graph/compile",
+		"graph/build_compile",
+		"ml/onnx_occluder_scores",
+		"ml/onnx_async_dispatch",
+		"ml/onnx_depth_downsample"
+	};
+
+	struct Result {
+		std::string name;
+		uint64_t items_per_call = 0;
+		uint64_t calls_per_repetition = 0;
+		uint32_t repetitions = 0;
+		double min_ns = 0.0;     // All per item
+		double median_ns = 0.0;
+		double mean_ns = 0.0;
+		double stddev_ns = 0.0;
+		double max_ns = 0.0;
+		double cv_percent = 0.0;
+	};
+
+	// Results feed this so the optimizer can't drop the measured work
+	volatile uint64_t g_sink = 0;
+
+	inline void consume(uint64_t value) {
+		g_sink = g_sink + value;
+	}
+
+	class Suite {
+	public:
+		explicit Suite(const Options& options) : options(options) {}
+
+		bool wants(const std::string& name) const {
+			return options.filter.empty() || name.find(options.filter) != std::string::npos;
+		}
+
+		// Any benchmark of the group selected, so groups skip building fixtures nobody measures
+		bool wants_any(std::initializer_list<const char*> names) const {
+			return std::any_of(names.begin(), names.end(), [this](const char* n) { return wants(n); });
+		}
+
+		// setup runs untimed before every body call (fresh unsorted input, cleared graph ...)
+		void run(const std::string& name, uint64_t items_per_call, const std::function<void()>& setup, const std::function<void()>& body) {
+			if (!wants(name) || items_per_call == 0)
+				return;
+
+			auto timed_call = [&]() {
+				if (setup) setup();
+				auto start = std::chrono::steady_clock::now();
+				body();
+				auto end = std::chrono::steady_clock::now();
+				return std::chrono::duration<double, std::nano>(end - start).count();
+			};
+
+			for (uint32_t i = 0; i < options.warmup; ++i)
+				timed_call();
+
+			// Calibrate the call count so a repetition is long enough for the clock
+			double probe_ns = std::max(1.0, timed_call());
+			uint64_t calls = static_cast<uint64_t>(std::ceil(options.min_time_ms * 1.0e6 / probe_ns));
+			calls = std::clamp<uint64_t>(calls, 1, 1000000);
+
+			std::vector<double> per_item;
+			per_item.reserve(options.repetitions);
+			for (uint32_t r = 0; r < options.repetitions; ++r) {
+				double total_ns = 0.0;
+				for (uint64_t c = 0; c < calls; ++c)
+					total_ns += timed_call();
+				per_item.push_back(total_ns / static_cast<double>(calls * items_per_call));
+			}
+
+			Result result;
+			result.name = name;
+			result.items_per_call = items_per_call;
+			result.calls_per_repetition = calls;
+			result.repetitions = options.repetitions;
+			summarize(per_item, result);
+			print(result);
+			results.push_back(std::move(result));
+		}
+
+		void run(const std::string& name, uint64_t items_per_call, const std::function<void()>& body) {
+			run(name, items_per_call, nullptr, body);
+		}
+
+		const std::vector<Result>& get_results() const { return results; }
+
+		// Correctness checks next to the timings, any failed one makes the run exit non-zero
+		bool check(bool condition, const std::string& name, const std::string& message) {
+			if (!condition) {
+				std::cerr << "FAILED " << name << ": " << message << "\n";
+				failures++;
+			}
+			return condition;
+		}
+
+		uint32_t get_failure_count() const { return failures; }
+
+	private:
+		static void summarize(std::vector<double> samples, Result& out) {
+			if (samples.empty())
+				return;
+
+			std::sort(samples.begin(), samples.end());
+			const size_t n = samples.size();
+			out.min_ns = samples.front();
+			out.max_ns = samples.back();
+			out.median_ns = (n % 2) ? samples[n / 2] : 0.5 * (samples[n / 2 - 1] + samples[n / 2]);
+
+			double sum = 0.0;
+			for (double v : samples) sum += v;
+			out.mean_ns = sum / static_cast<double>(n);
+
+			double sq = 0.0;
+			for (double v : samples) sq += (v - out.mean_ns) * (v - out.mean_ns);
+			out.stddev_ns = n > 1 ? std::sqrt(sq / static_cast<double>(n - 1)) : 0.0;
+			out.cv_percent = out.mean_ns > 0.0 ? out.stddev_ns / out.mean_ns * 100.0 : 0.0;
+		}
+
+		static void print(const Result& r) {
+			std::cout << std::left << std::setw(34) << r.name << std::right << std::fixed << std::setprecision(2)
+				<< " median " << std::setw(11) << r.median_ns << " ns"
+				<< "  min " << std::setw(11) << r.min_ns << " ns"
+				<< "  mean " << std::setw(11) << r.mean_ns << " ns"
+				<< "  cv " << std::setw(6) << r.cv_percent << " %"
+				<< "  (" << r.items_per_call << " items x " << r.calls_per_repetition << " calls)\n";
+		}
+
+		const Options& options;
+		std::vector<Result> results;
+		uint32_t failures = 0;
+	};
+
+	// Threading
+
+	void bench_threading(Suite& suite, bud::threading::TaskScheduler& scheduler) {
+		constexpr uint32_t QUEUE_BATCH = 1024;  // Well under the queue capacity, push doesn't check for overflow
+
+		{
+			bud::threading::WorkStealingQueue<uint64_t> queue;
+			suite.run("threading/wsq_push_pop", QUEUE_BATCH * 2, [&]() {
+				for (uint64_t i = 0; i < QUEUE_BATCH; ++i)
+					queue.push(i);
+				uint64_t sum = 0;
+				while (auto item = queue.pop())
+					sum += *item;
+				consume(sum);
+			});
+
+			suite.run("threading/wsq_push_steal", QUEUE_BATCH * 2, [&]() {
+				for (uint64_t i = 0; i < QUEUE_BATCH; ++i)
+					queue.push(i);
+				uint64_t sum = 0;
+				while (auto item = queue.steal())
+					sum += *item;
+				consume(sum);
+			});
+		}
+
+		constexpr uint32_t TASK_BATCH = 1024;
+		suite.run("threading/spawn_wait", TASK_BATCH, [&]() {
+			bud::threading::Counter counter;
+			for (uint32_t i = 0; i < TASK_BATCH; ++i)
+				scheduler.spawn("BenchEmpty", []() {}, &counter);
+			scheduler.wait_for_counter(counter);
+		});
+
+		constexpr size_t PARALLEL_COUNT = 1 << 20;
+		std::vector<float> values(PARALLEL_COUNT, 1.0f);
+		suite.run("threading/parallel_for", PARALLEL_COUNT, [&]() {
+			bud::threading::Counter counter;
+			scheduler.ParallelFor(PARALLEL_COUNT, 4096, [&](size_t start, size_t end) {
+				for (size_t i = start; i < end; ++i)
+					values[i] = values[i] * 0.5f + 0.5f;
+			}, &counter);
+			scheduler.wait_for_counter(counter);
+		});
+
+		// Each parent waits on a child from inside a fiber: one suspend + one resume per item
+		constexpr uint32_t FIBER_BATCH = 256;
+		suite.run("threading/fiber_switch", FIBER_BATCH, [&]() {
+			bud::threading::Counter parents;
+			for (uint32_t i = 0; i < FIBER_BATCH; ++i) {
+				scheduler.spawn("BenchParent", [&scheduler]() {
+					bud::threading::Counter child;
+					scheduler.spawn("BenchChild", []() {}, &child);
+					scheduler.wait_for_counter(child);
+				}, &parents);
+			}
+			scheduler.wait_for_counter(parents);
+		});
+	}
+
+	// Math
+
+	void bench_math(Suite& suite, uint32_t seed) {
+		if (!suite.wants_any({ "math/aabb_frustum", "math/aabb_transform", "math/morton_code" }))
+			return;
+
+		constexpr uint32_t COUNT = 4096;
+		std::mt19937 rng(seed);
+		std::uniform_real_distribution<float> pos(-500.0f, 500.0f);
+		std::uniform_real_distribution<float> extent(0.5f, 20.0f);
+		std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+
+		std::vector<bud::math::AABB> boxes(COUNT);
+		std::vector<bud::math::mat4> transforms(COUNT);
+		std::vector<bud::math::vec3> points(COUNT);
+		bud::math::AABB bounds;
+		for (uint32_t i = 0; i < COUNT; ++i) {
+			bud::math::vec3 c(pos(rng), pos(rng) * 0.1f, pos(rng));
+			bud::math::vec3 e(extent(rng), extent(rng), extent(rng));
+			boxes[i] = bud::math::AABB(c - e, c + e);
+			transforms[i] = bud::math::rotate(bud::math::translate(bud::math::mat4(1.0f), c), angle(rng), bud::math::vec3(0.0f, 1.0f, 0.0f));
+			points[i] = c;
+			bounds.merge(boxes[i]);
+		}
+
+		// Camera in the middle of the field, roughly a quarter of the boxes survive
+		bud::math::Frustum frustum;
+		bud::math::mat4 view = bud::math::lookAt(bud::math::vec3(0.0f, 10.0f, 0.0f), bud::math::vec3(0.0f, 10.0f, -1.0f), bud::math::vec3(0.0f, 1.0f, 0.0f));
+		frustum.update(bud::math::perspective_vk(60.0f, 16.0f / 9.0f, 0.1f, 1000.0f) * view);
+
+		suite.run("math/aabb_frustum", COUNT, [&]() {
+			uint64_t visible = 0;
+			for (const auto& box : boxes)
+				visible += bud::math::intersect_aabb_frustum(box, frustum) ? 1 : 0;
+			consume(visible);
+		});
+
+		bud::math::AABB unit(bud::math::vec3(-1.0f), bud::math::vec3(1.0f));
+		suite.run("math/aabb_transform", COUNT, [&]() {
+			float acc = 0.0f;
+			for (const auto& m : transforms)
+				acc += unit.transform(m).max.x;
+			consume(static_cast<uint64_t>(acc));
+		});
+
+		suite.run("math/morton_code", COUNT, [&]() {
+			uint64_t acc = 0;
+			for (const auto& p : points)
+				acc ^= bud::math::compute_morton_code(p, bounds);
+			consume(acc);
+		});
+	}
+
+	// Scene: LBVH, culling, draw keys
+
+	void fill_render_scene(bud::graphics::RenderScene& scene, uint32_t count, uint32_t seed) {
+		std::mt19937 rng(seed);
+		std::uniform_real_distribution<float> pos(-1000.0f, 1000.0f);
+		std::uniform_real_distribution<float> height(0.0f, 50.0f);
+		std::uniform_real_distribution<float> size(0.5f, 8.0f);
+		std::uniform_int_distribution<uint32_t> mesh(0, 255);
+		std::uniform_int_distribution<uint32_t> material(0, 1023);
+
+		scene.reset(count);
+		for (uint32_t i = 0; i < count; ++i) {
+			bud::math::vec3 c(pos(rng), height(rng), pos(rng));
+			float s = size(rng);
+			bud::math::mat4 m = bud::math::scale(bud::math::translate(bud::math::mat4(1.0f), c), bud::math::vec3(s));
+			bud::math::AABB local(bud::math::vec3(-1.0f), bud::math::vec3(1.0f));
+			scene.add_instance(m, local.transform(m), mesh(rng), 0, material(rng), (i % 4) != 0);
+		}
+	}
+
+	void bench_scene(Suite& suite, bud::threading::TaskScheduler& scheduler, const Options& options) {
+		if (!suite.wants_any({ "scene/lbvh_build", "scene/lbvh_build_parallel", "scene/cull_frustum", "scene/drawkey_generate", "scene/drawkey_sort" }))
+			return;
+
+		bud::graphics::RenderScene scene;
+		fill_render_scene(scene, options.instances, options.seed);
+		const uint64_t count = scene.size();
+
+		suite.run("scene/lbvh_build", count, [&]() {
+			scene.build_culling_lbvh();
+			consume(scene.bvh_root);
+		});
+
+		suite.run("scene/lbvh_build_parallel", count, [&]() {
+			scene.build_culling_lbvh_parallel(&scheduler);
+			consume(scene.bvh_root);
+		});
+
+		scene.build_culling_lbvh();
+
+		const bud::math::vec3 eye(0.0f, 20.0f, 0.0f);
+		const float far_plane = 1000.0f;
+		bud::math::Frustum frustum;
+		bud::math::mat4 view = bud::math::lookAt(eye, eye + bud::math::vec3(0.3f, -0.1f, -1.0f), bud::math::vec3(0.0f, 1.0f, 0.0f));
+		frustum.update(bud::math::perspective_vk(60.0f, 16.0f / 9.0f, 0.1f, far_plane) * view);
+
+		std::vector<uint32_t> visible;
+		visible.reserve(count);
+		suite.run("scene/cull_frustum", count, [&]() {
+			visible.clear();
+			scene.cull_frustum(frustum, visible);
+			consume(visible.size());
+		});
+
+		visible.clear();
+		scene.cull_frustum(frustum, visible);
+
+		// Same key layout and depth quantization as Renderer::render, single submesh per instance
+		std::vector<bud::graphics::SortItem> items(visible.size());
+		auto generate_keys = [&]() {
+			for (size_t k = 0; k < visible.size(); ++k) {
+				uint32_t i = visible[k];
+				auto mesh_pos = bud::math::vec3(scene.world_matrices[i][3]);
+				auto depth_normalized = std::clamp(bud::math::distance2(mesh_pos, eye) / (far_plane * far_plane), 0.0f, 1.0f);
+				auto& item = items[k];
+				item.entity_index = i;
+				item.submesh_index = scene.submesh_indices[i];
+				item.key = bud::graphics::DrawKey::generate_opaque(0, 0, scene.material_indices[i], scene.mesh_indices[i], static_cast<uint32_t>(depth_normalized * 0x3FFFF));
+			}
+		};
+
+		suite.run("scene/drawkey_generate", items.size(), [&]() {
+			generate_keys();
+			consume(items.empty() ? 0 : items.back().key);
+		});
+
+		generate_keys();
+		const auto unsorted = items;
+		suite.run("scene/drawkey_sort", items.size(),
+			[&]() { items = unsorted; },
+			[&]() {
+				std::sort(items.begin(), items.end(), [](const bud::graphics::SortItem& a, const bud::graphics::SortItem& b) { return a.key < b.key; });
+				consume(items.empty() ? 0 : items.front().key);
+			});
+	}
+
+	// Submesh key generation: flat SoA table vs the nested RenderMesh::submeshes walk it replaced
+
+	void bench_submesh_keys(Suite& suite, const Options& options) {
+		if (!suite.wants_any({ "scene/submesh_keys", "scene/submesh_keys_nested" }))
+			return;
+
+		// 10 submeshes per mesh, the default 100K instances give 1M submesh rows to cull and key
+		constexpr uint32_t SUBMESHES_PER_MESH = 10;
+		bud::graphics::RenderScene scene;
+		fill_render_scene(scene, options.instances, options.seed);
+		for (uint32_t i = 0; i < scene.size(); ++i)
+			scene.submesh_indices[i] = bud::asset::INVALID_INDEX;
+
+		std::mt19937 rng(options.seed);
+		std::uniform_real_distribution<float> offset(-0.8f, 0.8f);
+		std::vector<bud::graphics::RenderMesh> meshes(256);
+		for (uint32_t m = 0; m < meshes.size(); ++m) {
+			auto& mesh = meshes[m];
+			mesh.index_count = 3 * 256 * SUBMESHES_PER_MESH;
+			mesh.aabb = bud::math::AABB(bud::math::vec3(-1.0f), bud::math::vec3(1.0f));
+			for (uint32_t s = 0; s < SUBMESHES_PER_MESH; ++s) {
+				bud::graphics::SubMesh sub{};
+				sub.index_start = s * 3 * 256;
+				sub.index_count = 3 * 256;
+				sub.material_id = (m * SUBMESHES_PER_MESH + s) % 1024;
+				bud::math::vec3 c(offset(rng), offset(rng), offset(rng));
+				sub.aabb = bud::math::AABB(c - bud::math::vec3(0.2f), c + bud::math::vec3(0.2f));
+				mesh.submeshes.push_back(sub);
+			}
+		}
+
+		bud::graphics::SubmeshTable table;
+		table.rebuild(meshes);
+
+		bud::graphics::KeyGenView view;
+		view.camera_position = bud::math::vec3(0.0f, 20.0f, 0.0f);
+		view.far_plane = 1000.0f;
+		bud::math::mat4 view_matrix = bud::math::lookAt(view.camera_position, view.camera_position + bud::math::vec3(0.3f, -0.1f, -1.0f), bud::math::vec3(0.0f, 1.0f, 0.0f));
+		view.frustum.update(bud::math::perspective_vk(60.0f, 16.0f / 9.0f, 0.1f, view.far_plane) * view_matrix);
+
+		// Every instance counts as visible, the submesh test inside the key generation does the culling
+		std::vector<uint32_t> visible(scene.size());
+		for (uint32_t i = 0; i < visible.size(); ++i) visible[i] = i;
+
+		std::vector<bud::graphics::SubmeshRange> ranges(visible.size());
+		std::vector<uint32_t> draw_offsets(visible.size() + 1);
+		uint32_t total = 0;
+		for (size_t k = 0; k < visible.size(); ++k) {
+			ranges[k] = bud::graphics::get_submesh_range(scene, table, visible[k]);
+			draw_offsets[k] = total;
+			total += ranges[k].count;
+		}
+		draw_offsets[visible.size()] = total;
+		std::vector<bud::graphics::SortItem> items(total);
+
+		suite.run("scene/submesh_keys", total, [&]() {
+			bud::graphics::generate_submesh_keys(scene, table, view, visible.data(), ranges.data(), draw_offsets.data(), 0, visible.size(), items.data());
+			consume(items.back().key);
+		});
+
+		// The loop Renderer::render ran before the flat table: RenderMesh -> submeshes -> 8-corner AABB transform
+		auto generate_nested_keys = [&]() {
+			for (size_t k = 0; k < visible.size(); ++k) {
+				uint32_t i = visible[k];
+				const auto& world_matrix = scene.world_matrices[i];
+				uint32_t mesh_id = scene.mesh_indices[i];
+				const auto& mesh = meshes[mesh_id];
+
+				auto mesh_pos = bud::math::vec3(world_matrix[3]);
+				auto depth_normalized = std::clamp(bud::math::distance2(mesh_pos, view.camera_position) / (view.far_plane * view.far_plane), 0.0f, 1.0f);
+				uint32_t depth_key = static_cast<uint32_t>(depth_normalized * 0x3FFFF);
+
+				for (uint32_t s = 0; s < (uint32_t)mesh.submeshes.size(); ++s) {
+					auto& item = items[draw_offsets[k] + s];
+					const auto& sub = mesh.submeshes[s];
+					item.entity_index = i;
+					item.submesh_index = s;
+					auto world_sub_aabb = sub.aabb.transform(world_matrix);
+					item.key = bud::math::intersect_aabb_frustum(world_sub_aabb, view.frustum)
+						? bud::graphics::DrawKey::generate_opaque(0, 0, sub.material_id, mesh_id, depth_key) : UINT64_MAX;
+				}
+			}
+		};
+
+		suite.run("scene/submesh_keys_nested", total, [&]() {
+			generate_nested_keys();
+			consume(items.back().key);
+		});
+
+		// Both paths must produce the same items. The Arvo and 8-corner transforms round differently,
+		// so a row whose visibility differs is only accepted when its world AABB touches a frustum plane.
+		std::vector<bud::graphics::SortItem> table_items(total);
+		bud::graphics::generate_submesh_keys(scene, table, view, visible.data(), ranges.data(), draw_offsets.data(), 0, visible.size(), table_items.data());
+		generate_nested_keys();
+
+		auto on_frustum_plane = [&](const bud::math::AABB& box) {
+			const bud::math::vec3 center = box.center();
+			const bud::math::vec3 extent = box.size() * 0.5f;
+			for (const auto& plane : view.frustum.planes) {
+				const bud::math::vec3 normal(plane);
+				const float distance = bud::math::dot(normal, center) + plane.w + bud::math::dot(glm::abs(normal), extent);
+				if (std::abs(distance) < 1e-3f) return true;
+			}
+			return false;
+		};
+
+		size_t mismatches = 0;
+		size_t edge_rows = 0;
+		for (size_t k = 0; k < visible.size(); ++k) {
+			const auto& mesh = meshes[scene.mesh_indices[visible[k]]];
+			for (uint32_t s = 0; s < ranges[k].count; ++s) {
+				const auto& a = table_items[draw_offsets[k] + s];
+				const auto& b = items[draw_offsets[k] + s];
+				if (a.entity_index != b.entity_index || a.submesh_index != b.submesh_index) {
+					++mismatches;
+				} else if (a.key != b.key) {
+					const bool visibility_differs = (a.key == UINT64_MAX) != (b.key == UINT64_MAX);
+					if (visibility_differs && on_frustum_plane(mesh.submeshes[s].aabb.transform(scene.world_matrices[visible[k]]))) ++edge_rows;
+					else ++mismatches;
+				}
+			}
+		}
+
+		suite.check(mismatches == 0, "scene/submesh_keys",
+			std::to_string(mismatches) + " of " + std::to_string(total) + " table keys differ from the nested walk (" + std::to_string(edge_rows) + " on a frustum plane)");
+	}
+
+	// Multi-view: one culling traversal + key generation + sort shared by N views vs the whole pipeline per view
+
+	void bench_multiview(Suite& suite, const Options& options) {
+		if (!suite.wants_any({ "scene/multiview_shared/1", "scene/multiview_shared/2", "scene/multiview_shared/4", "scene/multiview_shared/8",
+			"scene/multiview_separate/1", "scene/multiview_separate/2", "scene/multiview_separate/4", "scene/multiview_separate/8" }))
+			return;
+
+		constexpr uint32_t SUBMESHES_PER_MESH = 3;
+		bud::graphics::RenderScene scene;
+		fill_render_scene(scene, options.instances, options.seed);
+		for (uint32_t i = 0; i < scene.size(); ++i)
+			scene.submesh_indices[i] = bud::asset::INVALID_INDEX;
+		scene.build_culling_lbvh();
+
+		std::vector<bud::graphics::RenderMesh> meshes(256);
+		for (auto& mesh : meshes) {
+			mesh.index_count = 3 * 256 * SUBMESHES_PER_MESH;
+			for (uint32_t s = 0; s < SUBMESHES_PER_MESH; ++s) {
+				bud::graphics::SubMesh sub{};
+				sub.index_start = s * 3 * 256;
+				sub.index_count = 3 * 256;
+				sub.material_id = s;
+				sub.aabb = bud::math::AABB(bud::math::vec3(-1.0f), bud::math::vec3(1.0f));
+				mesh.submeshes.push_back(sub);
+			}
+		}
+		bud::graphics::SubmeshTable table;
+		table.rebuild(meshes);
+
+		// Eight cameras at one spot looking around (split screen / cube probe style overlap)
+		const bud::math::vec3 eye(0.0f, 20.0f, 0.0f);
+		const float far_plane = 1000.0f;
+		bud::math::Frustum frustums[bud::graphics::MAX_VIEWS];
+		for (uint32_t v = 0; v < bud::graphics::MAX_VIEWS; ++v) {
+			const float yaw = static_cast<float>(v) * 0.6f;
+			bud::math::mat4 view = bud::math::lookAt(eye, eye + bud::math::vec3(std::sin(yaw), -0.1f, -std::cos(yaw)), bud::math::vec3(0.0f, 1.0f, 0.0f));
+			frustums[v].update(bud::math::perspective_vk(60.0f, 16.0f / 9.0f, 0.1f, far_plane) * view);
+		}
+
+		std::vector<uint32_t> visible;
+		std::vector<bud::graphics::ViewMask> masks;
+		std::vector<bud::graphics::ViewMask> instance_masks;
+		std::vector<bud::graphics::SubmeshRange> ranges;
+		std::vector<uint32_t> draw_offsets;
+		std::vector<bud::graphics::SortItem> items;
+		bud::graphics::ViewDrawList view_draws;
+
+		// Culled instances -> sorted draw list, as Renderer::render does for the main view
+		auto build_draws = [&](const bud::graphics::KeyGenView& key_view) {
+			ranges.resize(visible.size());
+			draw_offsets.resize(visible.size() + 1);
+			uint32_t total = 0;
+			for (size_t k = 0; k < visible.size(); ++k) {
+				ranges[k] = bud::graphics::get_submesh_range(scene, table, visible[k]);
+				draw_offsets[k] = total;
+				total += ranges[k].count;
+			}
+			draw_offsets[visible.size()] = total;
+			items.resize(total);
+			bud::graphics::generate_submesh_keys(scene, table, key_view, visible.data(), ranges.data(), draw_offsets.data(), 0, visible.size(), items.data());
+			std::sort(items.begin(), items.end(), [](const bud::graphics::SortItem& a, const bud::graphics::SortItem& b) { return a.key < b.key; });
+			items.erase(std::remove_if(items.begin(), items.end(), [](const bud::graphics::SortItem& a) { return a.key == UINT64_MAX; }), items.end());
+		};
+
+		for (uint32_t view_count : { 1u, 2u, 4u, 8u }) {
+			suite.run("scene/multiview_shared/" + std::to_string(view_count), scene.size(), [&]() {
+				visible.clear();
+				masks.clear();
+				scene.cull_frustums(frustums, view_count, visible, masks);
+
+				bud::graphics::KeyGenView key_view;
+				key_view.frustum = frustums[0];
+				key_view.camera_position = eye;
+				key_view.far_plane = far_plane;
+				key_view.secondary_frustums = frustums + 1;
+				key_view.view_masks = masks.data();
+				build_draws(key_view);
+
+				instance_masks.assign(scene.size(), 0);
+				for (size_t k = 0; k < visible.size(); ++k) instance_masks[visible[k]] = masks[k];
+				uint64_t draws = items.size();
+				for (uint32_t v = 1; v < view_count; ++v) {
+					bud::graphics::filter_view_draws(scene, table, frustums[v], v, instance_masks, items, items.size(), view_draws);
+					draws += view_draws.items.size();
+				}
+				consume(draws);
+			});
+
+			suite.run("scene/multiview_separate/" + std::to_string(view_count), scene.size(), [&]() {
+				uint64_t draws = 0;
+				for (uint32_t v = 0; v < view_count; ++v) {
+					visible.clear();
+					scene.cull_frustum(frustums[v], visible);
+
+					bud::graphics::KeyGenView key_view;
+					key_view.frustum = frustums[v];
+					key_view.camera_position = eye;
+					key_view.far_plane = far_plane;
+					build_draws(key_view);
+					draws += items.size();
+				}
+				consume(draws);
+			});
+		}
+	}
+
+	// Foliage: 1M instances of 4 types over a 4 km square, camera near the ground looking across it.
+	// Measures the CPU build and cull only, the GPU side of FoliagePass is not part of this run.
+
+	void bench_foliage(Suite& suite, const Options& options) {
+		if (!suite.wants_any({ "foliage/build", "foliage/cull", "foliage/cull_shadow" }))
+			return;
+
+		constexpr uint32_t FOLIAGE_INSTANCES = 1000000;
+		constexpr uint32_t TYPE_COUNT = 4;
+		constexpr float HALF_EXTENT = 2000.0f;
+
+		std::vector<bud::graphics::FoliageType> types(TYPE_COUNT);
+		for (uint32_t t = 0; t < TYPE_COUNT; ++t) {
+			auto& type = types[t];
+			type.lod_count = 3;
+			type.lod_distances[0] = 30.0f;
+			type.lod_distances[1] = 80.0f;
+			type.lod_distances[2] = 200.0f;
+			type.lod_meshes[0] = t * 3;
+			type.lod_meshes[1] = t * 3 + 1;
+			type.lod_meshes[2] = t * 3 + 2;
+			type.impostor_texture = 1 + t;
+			type.cull_distance = 1500.0f;
+			const float height = 4.0f + 4.0f * t;
+			type.local_bounds = bud::math::AABB(bud::math::vec3(-height * 0.3f, 0.0f, -height * 0.3f), bud::math::vec3(height * 0.3f, height, height * 0.3f));
+		}
+
+		std::mt19937 rng(options.seed);
+		std::uniform_real_distribution<float> coord(-HALF_EXTENT, HALF_EXTENT);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+		struct Placement { bud::math::vec3 position; float yaw; float scale; uint32_t type; };
+		std::vector<Placement> placements(FOLIAGE_INSTANCES);
+		for (auto& p : placements) {
+			p.position = bud::math::vec3(coord(rng), 0.0f, coord(rng));
+			p.yaw = unit(rng) * 2.0f * bud::math::PI;
+			p.scale = 0.8f + 0.4f * unit(rng);
+			p.type = static_cast<uint32_t>(unit(rng) * TYPE_COUNT) % TYPE_COUNT;
+		}
+
+		auto populate = [&](bud::graphics::FoliageSystem& foliage) {
+			for (const auto& type : types) foliage.add_type(type);
+			foliage.reserve(placements.size());
+			for (const auto& p : placements) foliage.add_instance(p.type, p.position, p.yaw, p.scale);
+		};
+
+		suite.run("foliage/build", FOLIAGE_INSTANCES, [&]() {
+			bud::graphics::FoliageSystem foliage;
+			populate(foliage);
+			foliage.build();
+			consume(static_cast<uint64_t>(foliage.run_count()));
+		});
+
+		bud::graphics::FoliageSystem foliage;
+		populate(foliage);
+		foliage.build();
+
+		const bud::math::vec3 eye(0.0f, 3.0f, 0.0f);
+		const bud::math::mat4 view_matrix = bud::math::lookAt(eye, eye + bud::math::vec3(0.3f, -0.05f, -1.0f), bud::math::vec3(0.0f, 1.0f, 0.0f));
+
+		bud::graphics::FoliageCullParams params;
+		params.camera_position = eye;
+		params.max_distance = 1500.0f;
+		params.frustum.update(bud::math::perspective_vk(60.0f, 16.0f / 9.0f, 0.1f, params.max_distance) * view_matrix);
+
+		bud::graphics::FoliageDrawList draws;
+		suite.run("foliage/cull", FOLIAGE_INSTANCES, [&]() {
+			foliage.cull(params, draws);
+			consume(draws.instances.size());
+		});
+
+		// A 150 m shadow cascade around the camera, casters are mesh LODs only
+		bud::graphics::FoliageCullParams shadow_params;
+		shadow_params.camera_position = eye;
+		shadow_params.shadow_casters = true;
+		const bud::math::mat4 light_view = bud::math::lookAt(eye + bud::math::vec3(100.0f, 200.0f, 60.0f), eye, bud::math::vec3(0.0f, 1.0f, 0.0f));
+		shadow_params.frustum.update(bud::math::ortho_vk(-150.0f, 150.0f, -150.0f, 150.0f, 0.0f, 600.0f) * light_view);
+
+		bud::graphics::FoliageDrawList shadow_draws;
+		suite.run("foliage/cull_shadow", FOLIAGE_INSTANCES, [&]() {
+			foliage.cull(shadow_params, shadow_draws);
+			consume(shadow_draws.instances.size());
+		});
+
+		if (suite.wants("foliage/cull"))
+			std::cout << "  CPU culling only: " << draws.instances.size() << " main view / " << shadow_draws.instances.size()
+				<< " shadow instances of " << FOLIAGE_INSTANCES << ", no upload, draw or GPU time measured\n";
+	}
+
+	// HLOD region selection
+
+	void bench_hlod(Suite& suite, const Options& options) {
+		if (!suite.wants("scene/hlod_select"))
+			return;
+
+		// 32 x 32 regions of 32 m, each replacing 64 entities of 3 submeshes, like the output of --build-hlod
+		constexpr uint32_t GRID = 32;
+		constexpr float CELL = 32.0f;
+		constexpr uint32_t ENTITIES_PER_REGION = 64;
+		constexpr uint32_t SUBMESHES = 3;
+
+		std::mt19937 rng(options.seed);
+		std::uniform_real_distribution<float> height(4.0f, 20.0f);
+		bud::graphics::HLODSet hlod;
+		std::vector<uint32_t> pairs;
+		for (uint32_t z = 0; z < GRID; ++z) {
+			for (uint32_t x = 0; x < GRID; ++x) {
+				const uint32_t region_index = z * GRID + x;
+				bud::graphics::HLODRegion region;
+				const bud::math::vec3 origin((x - GRID * 0.5f) * CELL, 0.0f, (z - GRID * 0.5f) * CELL);
+				region.bounds = bud::math::AABB(origin, origin + bud::math::vec3(CELL, height(rng), CELL));
+				region.switch_distance = 3.0f * CELL;
+				region.source_draws = ENTITIES_PER_REGION * SUBMESHES;
+
+				pairs.clear();
+				for (uint32_t e = 0; e < ENTITIES_PER_REGION; ++e) {
+					for (uint32_t s = 0; s < SUBMESHES; ++s) {
+						pairs.push_back(region_index * ENTITIES_PER_REGION + e);
+						pairs.push_back(s);
+					}
+				}
+				hlod.add_region(region, pairs);
+			}
+		}
+		hlod.build();
+
+		const bud::math::vec3 eye(0.0f, 2.0f, 0.0f);
+		std::vector<uint8_t> active;
+		bud::graphics::HLODStats stats;
+		suite.run("scene/hlod_select", GRID * GRID, [&]() {
+			hlod.select(eye, 1.0f, active, stats);
+			consume(stats.regions_active);
+		});
+
+		// Selection from the middle of the grid and from outside it, where every region is a proxy. The regions carry
+		// no meshes, so no triangle savings are reported here; the renderer's HLOD stats give them for a built hlod.json.
+		hlod.select(eye, 1.0f, active, stats);
+		std::cout << "  near: " << stats.regions_active << "/" << stats.regions << " regions as proxy";
+		hlod.select(bud::math::vec3(0.0f, 400.0f, GRID * CELL * 2.0f), 1.0f, active, stats);
+		std::cout << "; far: " << stats.regions_active << "/" << stats.regions << " regions as proxy\n";
+	}
+
+	// Instance / draw record packing
+
+	void bench_instances(Suite& suite, const Options& options) {
+		if (!suite.wants("render/pack_instances"))
+			return;
+
+		constexpr uint32_t SUBMESHES_PER_MESH = 3;
+		bud::graphics::RenderScene scene;
+		fill_render_scene(scene, options.instances, options.seed);
+
+		std::vector<bud::graphics::RenderMesh> meshes(256);
+		for (uint32_t m = 0; m < meshes.size(); ++m) {
+			auto& mesh = meshes[m];
+			mesh.index_count = 3 * 1024 * SUBMESHES_PER_MESH;
+			mesh.aabb = bud::math::AABB(bud::math::vec3(-1.0f), bud::math::vec3(1.0f));
+			for (uint32_t s = 0; s < SUBMESHES_PER_MESH; ++s) {
+				bud::graphics::SubMesh sub{};
+				sub.index_start = s * 3 * 1024;
+				sub.index_count = 3 * 1024;
+				sub.material_id = (m * SUBMESHES_PER_MESH + s) % 1024;
+				sub.double_sided = s == 2;
+				sub.aabb = mesh.aabb;
+				mesh.submeshes.push_back(sub);
+			}
+		}
+
+		// Every instance exploded into its submeshes, every second one drawn again as a shadow caster,
+		// the same shape as the renderer's sort_list + shadow_draw_list
+		std::vector<bud::graphics::SortItem> draws;
+		std::vector<bud::graphics::SortItem> shadow_draws;
+		for (uint32_t i = 0; i < scene.size(); ++i) {
+			for (uint32_t s = 0; s < SUBMESHES_PER_MESH; ++s) {
+				draws.push_back({ 0, i, s });
+				if (i % 2 == 0) shadow_draws.push_back({ 0, i, s });
+			}
+		}
+
+		bud::graphics::InstanceDataBuilder builder;
+		std::vector<uint8_t> upload;
+		std::vector<bud::graphics::GPUDrawData> draw_records(draws.size() + shadow_draws.size());
+		const uint64_t slots = draw_records.size();
+
+		suite.run("render/pack_instances", slots, [&]() {
+			builder.begin(scene.size());
+			builder.add_draws(scene, meshes, draws.data(), draws.size());
+			builder.add_draws(scene, meshes, shadow_draws.data(), shadow_draws.size());
+			upload.resize(builder.get_size());
+			builder.write(scene, upload.data());
+			for (size_t i = 0; i < draws.size(); ++i)
+				bud::graphics::fill_draw_data(draw_records[i], scene, meshes, draws[i]);
+			for (size_t i = 0; i < shadow_draws.size(); ++i)
+				bud::graphics::fill_draw_data(draw_records[draws.size() + i], scene, meshes, shadow_draws[i]);
+			consume(upload.size() + draw_records.back().index_count);
+		});
+
+		if (upload.empty())
+			return;
+
+		// Bytes written per frame, compact records vs the former mat4 instance + 64-byte draw records
+		const uint64_t compact = upload.size() + slots * sizeof(bud::graphics::GPUDrawData);
+		const uint64_t legacy = slots * (bud::graphics::LEGACY_INSTANCE_RECORD_SIZE + bud::graphics::LEGACY_DRAW_RECORD_SIZE);
+		std::cout << "  " << scene.size() << " instances, " << slots << " draw slots, " << builder.get_instance_count() << " transforms: "
+			<< std::setprecision(2) << compact / (1024.0 * 1024.0) << " MB vs " << legacy / (1024.0 * 1024.0) << " MB legacy ("
+			<< 100.0 * (1.0 - static_cast<double>(compact) / static_cast<double>(legacy)) << " % less)\n";
+	}
+
+	// IO
+
+	// CPU reference of the meshlet_cull.comp cut over a mesh cooked with BudAssetTool --cluster-lod. Times one cut
+	// per meshlet of the hierarchy, then prints what cuts at growing distances draw and whether they stay watertight.
+	void bench_cluster_lod_cut(Suite& suite, const Options& options) {
+		bud::io::VirtualFileSystem vfs;
+		bud::io::ModelLoader loader(&vfs);
+		auto mesh = vfs.resolve_path(options.mesh_path) ? loader.load_bud_mesh(options.mesh_path) : std::nullopt;
+		if (!mesh || mesh->meshlet_lods.size() != mesh->meshlets.size()) {
+			std::cerr << "Skipping io/cluster_lod_cut, " << options.mesh_path << " has no cluster LOD hierarchy (BudAssetTool --cluster-lod)\n";
+			return;
+		}
+
+		bud::math::AABB bounds = mesh->subsets.empty() ? bud::math::AABB() : mesh->subsets[0].aabb;
+		uint32_t hierarchy_meshlets = 0;
+		for (const auto& subset : mesh->subsets) {
+			bounds.merge(subset.aabb);
+			hierarchy_meshlets += std::max(subset.lod_meshlet_count, subset.meshlet_count);
+		}
+		const bud::math::vec3 center = bounds.center();
+		const float radius = std::max(bud::math::distance(bounds.max, center), 1e-3f);
+
+		// 60 degree vertical FOV at 1080p, one pixel of error
+		bud::cluster_lod::View view;
+		view.error_scale = bud::cluster_lod::get_error_scale(1.0f / std::tan(bud::math::radians(30.0f)), 1080.0f, 1.0f);
+		view.z_near = 0.1f;
+		auto place_camera = [&](float distance) {
+			view.position[0] = center.x;
+			view.position[1] = center.y;
+			view.position[2] = center.z + distance;
+		};
+
+		// Subsets without a hierarchy always draw their source meshlets
+		std::vector<uint32_t> cut;
+		auto select = [&]() {
+			cut.clear();
+			for (const auto& subset : mesh->subsets) {
+				if (subset.lod_meshlet_count == 0) {
+					for (uint32_t m = 0; m < subset.meshlet_count; ++m) cut.push_back(subset.meshlet_start + m);
+					continue;
+				}
+				const size_t first = cut.size();
+				bud::cluster_lod::select_cut(mesh->meshlet_lods.data() + subset.meshlet_start, subset.lod_meshlet_count, view, cut);
+				for (size_t i = first; i < cut.size(); ++i) cut[i] += subset.meshlet_start;
+			}
+		};
+
+		place_camera(radius * 4.0f);
+		suite.run("io/cluster_lod_cut", std::max<uint32_t>(1, hierarchy_meshlets), [&]() {
+			select();
+			consume(cut.size());
+		});
+
+		const std::vector<uint32_t> remap = bud::cluster_lod::weld_positions(&mesh->positions[0].x, mesh->positions.size(), sizeof(mesh->positions[0]));
+		auto measure = [&](const std::vector<uint32_t>& meshlets, uint32_t& triangles) {
+			std::vector<uint32_t> indices;
+			for (uint32_t m : meshlets) {
+				const auto& desc = mesh->meshlets[m];
+				for (uint32_t t = 0; t < desc.triangle_count * 3; ++t) {
+					indices.push_back(mesh->meshlet_vertices[desc.vertex_offset + mesh->meshlet_triangles[desc.triangle_offset + t]]);
+				}
+			}
+			triangles = static_cast<uint32_t>(indices.size() / 3);
+			return bud::cluster_lod::count_open_edges(indices.data(), indices.size(), remap);
+		};
+
+		std::vector<uint32_t> source;
+		for (const auto& subset : mesh->subsets) {
+			for (uint32_t m = 0; m < subset.meshlet_count; ++m) source.push_back(subset.meshlet_start + m);
+		}
+		uint32_t source_triangles = 0;
+		const uint32_t source_open = measure(source, source_triangles);
+		const uint32_t errors = bud::cluster_lod::count_hierarchy_errors(mesh->meshlet_lods.data(), static_cast<uint32_t>(mesh->meshlet_lods.size()));
+		std::cout << "  " << source.size() << " source meshlets, " << source_triangles << " triangles, " << source_open << " open edges, "
+			<< hierarchy_meshlets << " meshlets in the hierarchy, " << errors << " with inconsistent bounds\n";
+		suite.check(errors == 0, "io/cluster_lod_cut",
+			std::to_string(errors) + " of " + std::to_string(mesh->meshlet_lods.size()) + " meshlets break the error / bounds invariants");
+
+		for (float distance : { 0.5f, 1.0f, 2.0f, 4.0f, 16.0f, 64.0f, 256.0f }) {
+			place_camera(radius * distance);
+			select();
+			uint32_t triangles = 0;
+			const uint32_t open = measure(cut, triangles);
+			std::cout << "  " << std::setprecision(1) << distance << " radii: " << cut.size() << " meshlets, " << triangles << " triangles, "
+				<< open << " open edges" << (open == source_open ? "" : ", differs from the source meshlets") << "\n";
+
+			// A cut that opens or closes boundary edges the source doesn't have is a crack between LOD groups
+			std::ostringstream message;
+			message << std::fixed << std::setprecision(1) << distance << " radii: " << open << " open edges, source meshlets have " << source_open;
+			suite.check(open == source_open, "io/cluster_lod_cut", message.str());
+		}
+	}
+
+	void bench_io(Suite& suite, const Options& options) {
+		if (suite.wants("io/load_bud_mesh")) {
+			bud::io::VirtualFileSystem vfs;
+			bud::io::ModelLoader loader(&vfs);
+			auto probe = vfs.resolve_path(options.mesh_path) ? loader.load_bud_mesh(options.mesh_path) : std::nullopt;
+			if (!probe) {
+				std::cerr << "Skipping io/load_bud_mesh, can't load " << options.mesh_path << "\n";
+			}
+			else {
+				// Per vertex, so meshes of different sizes compare
+				suite.run("io/load_bud_mesh", std::max<size_t>(1, probe->vertex_count()), [&]() {
+					auto mesh = loader.load_bud_mesh(options.mesh_path);
+					consume(mesh ? mesh->indices.size() : 0);
+				});
+			}
+		}
+
+		if (suite.wants("io/cluster_lod_cut")) {
+			bench_cluster_lod_cut(suite, options);
+		}
+
+		if (suite.wants("io/scene_json_parse")) {
+			std::ifstream in(options.scene_path, std::ios::binary);
+			if (!in.is_open()) {
+				std::cerr << "Skipping io/scene_json_parse, can't open " << options.scene_path << "\n";
+			}
+			else {
+				const std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+				// Per byte of JSON, parse + conversion into the runtime scene as the sample does it
+				suite.run("io/scene_json_parse", std::max<size_t>(1, text.size()), [&]() {
+					bud::scene::Scene scene = nlohmann::json::parse(text).get<bud::scene::Scene>();
+					consume(scene.entities.size());
+				});
+			}
+		}
+	}
+
+	// Render graph: a frame-shaped graph compiled without an RHI, so only dependency, sort and barrier work is timed
+
+	void build_frame_graph(bud::graphics::RenderGraph& graph) {
+		using bud::graphics::RGBuilder;
+		using bud::graphics::RGHandle;
+		using bud::graphics::ResourceState;
+		using bud::graphics::TextureDesc;
+		using bud::graphics::TextureFormat;
+
+		graph.reset();
+
+		TextureDesc color_desc;
+		color_desc.width = 1920;
+		color_desc.height = 1080;
+		color_desc.format = TextureFormat::R16G16B16A16_FLOAT;
+
+		TextureDesc depth_desc = color_desc;
+		depth_desc.format = TextureFormat::D32_FLOAT;
+
+		TextureDesc shadow_desc;
+		shadow_desc.width = 2048;
+		shadow_desc.height = 2048;
+		shadow_desc.format = TextureFormat::D32_FLOAT;
+
+		auto noop = [](bud::graphics::RHI*, bud::graphics::CommandHandle) {};
+
+		constexpr uint32_t CASCADES = 4;
+		RGHandle shadows[CASCADES];
+		for (uint32_t c = 0; c < CASCADES; ++c) {
+			shadows[c] = graph.add_pass("ShadowCascade", [&](RGBuilder& b) {
+				return b.write(b.create("ShadowMap", shadow_desc), ResourceState::DepthWrite);
+			}, noop);
+		}
+
+		RGHandle depth = graph.add_pass("ZPrepass", [&](RGBuilder& b) {
+			return b.write(b.create("SceneDepth", depth_desc), ResourceState::DepthWrite);
+		}, noop);
+
+		RGHandle hiz = graph.add_pass("HiZBuild", [&](RGBuilder& b) {
+			b.read(depth, ResourceState::ShaderResource);
+			return b.write(b.create("HiZ", color_desc), ResourceState::UnorderedAccess);
+		}, noop);
+
+		graph.add_pass("HiZCull", [&](RGBuilder& b) {
+			b.read(hiz, ResourceState::ShaderResource);
+			return 0;
+		}, noop);
+
+		RGHandle color = graph.add_pass("MainPass", [&](RGBuilder& b) {
+			b.read(depth, ResourceState::DepthRead);
+			for (auto& s : shadows)
+				b.read(s, ResourceState::ShaderResource);
+			return b.write(b.create("SceneColor", color_desc), ResourceState::RenderTarget);
+		}, noop);
+
+		// Post chain
+		for (int i = 0; i < 12; ++i) {
+			color = graph.add_pass("PostStep", [&](RGBuilder& b) {
+				b.read(color, ResourceState::ShaderResource);
+				b.read(depth, ResourceState::ShaderResource);
+				return b.write(b.create("PostColor", color_desc), ResourceState::RenderTarget);
+			}, noop);
+		}
+
+		RGHandle backbuffer = graph.import_texture("Backbuffer", nullptr, ResourceState::Undefined);
+		graph.add_pass("Composite", [&](RGBuilder& b) {
+			b.read(color, ResourceState::ShaderResource);
+			b.write(backbuffer, ResourceState::RenderTarget);
+			b.set_side_effect();
+			return 0;
+		}, noop);
+	}
+
+	void bench_render_graph(Suite& suite) {
+		if (!suite.wants_any({ "graph/compile", "graph/build_compile" }))
+			return;
+
+		bud::graphics::RenderGraph graph(nullptr);
+
+		build_frame_graph(graph);
+		suite.run("graph/compile", 1, [&]() {
+			graph.compile();
+		});
+
+		suite.run("graph/build_compile", 1, [&]() {
+			build_frame_graph(graph);
+			graph.compile();
+		});
+	}
+
+	// ML: ONNX Runtime CPU backend on the tensor shapes of the bundled ML passes. No model files
+	// ship with the engine, so the benchmark serializes small stand-in models itself.
+
+	// Just enough protobuf to write an onnx ModelProto
+	class ProtoWriter {
+	public:
+		void varint(uint64_t v) {
+			while (v >= 0x80) {
+				bytes.push_back(static_cast<char>((v & 0x7F) | 0x80));
+				v >>= 7;
+			}
+			bytes.push_back(static_cast<char>(v));
+		}
+
+		void int_field(uint32_t field, int64_t v) {
+			varint(static_cast<uint64_t>(field) << 3);
+			varint(static_cast<uint64_t>(v));
+		}
+
+		void bytes_field(uint32_t field, std::string_view s) {
+			varint((static_cast<uint64_t>(field) << 3) | 2);
+			varint(s.size());
+			bytes.append(s);
+		}
+
+		void message(uint32_t field, const ProtoWriter& m) { bytes_field(field, m.bytes); }
+
+		std::string bytes;
+	};
+
+	ProtoWriter onnx_value_info(const std::string& name, const std::vector<int64_t>& dims) {
+		ProtoWriter shape;
+		for (int64_t d : dims) {
+			ProtoWriter dim;
+			dim.int_field(1, d);            // Dimension.dim_value
+			shape.message(1, dim);
+		}
+		ProtoWriter tensor_type;
+		tensor_type.int_field(1, 1);        // elem_type FLOAT
+		tensor_type.message(2, shape);
+		ProtoWriter type;
+		type.message(1, tensor_type);       // TypeProto.tensor_type
+
+		ProtoWriter info;
+		info.bytes_field(1, name);
+		info.message(2, type);
+		return info;
+	}
+
+	ProtoWriter onnx_node(const std::vector<std::string>& node_inputs, const std::string& output, const std::string& op, const std::vector<ProtoWriter>& attributes = {}) {
+		ProtoWriter node;
+		for (const auto& in : node_inputs) node.bytes_field(1, in);
+		node.bytes_field(2, output);
+		node.bytes_field(3, op + "_" + output);
+		node.bytes_field(4, op);
+		for (const auto& a : attributes) node.message(5, a);
+		return node;
+	}
+
+	ProtoWriter onnx_ints_attribute(const std::string& name, const std::vector<int64_t>& values) {
+		ProtoWriter attr;
+		attr.bytes_field(1, name);
+		for (int64_t v : values) attr.int_field(8, v);
+		attr.int_field(20, 7);              // AttributeType INTS
+		return attr;
+	}
+
+	std::string onnx_model(const ProtoWriter& graph) {
+		ProtoWriter opset;
+		opset.bytes_field(1, "");
+		opset.int_field(2, 13);
+
+		ProtoWriter model;
+		model.int_field(1, 8);              // ir_version
+		model.bytes_field(2, "bud_benchmarks");
+		model.message(7, graph);
+		model.message(8, opset);
+		return model.bytes;
+	}
+
+	// Occluder selection: per candidate feature vector -> linear score -> sigmoid
+	std::string make_occluder_model(int64_t candidates, int64_t features, uint32_t seed) {
+		std::mt19937 rng(seed);
+		std::uniform_real_distribution<float> weight(-1.0f, 1.0f);
+		std::vector<float> weights(static_cast<size_t>(features));
+		for (auto& w : weights) w = weight(rng);
+
+		ProtoWriter init;
+		init.int_field(1, features);
+		init.int_field(1, 1);
+		init.int_field(2, 1);               // FLOAT
+		init.bytes_field(8, "weights");
+		init.bytes_field(9, std::string_view(reinterpret_cast<const char*>(weights.data()), weights.size() * sizeof(float)));
+
+		ProtoWriter graph;
+		graph.message(1, onnx_node({ "features", "weights" }, "logits", "MatMul"));
+		graph.message(1, onnx_node({ "logits" }, "scores", "Sigmoid"));
+		graph.bytes_field(2, "occluder_selection");
+		graph.message(5, init);
+		graph.message(11, onnx_value_info("features", { candidates, features }));
+		graph.message(12, onnx_value_info("scores", { candidates, 1 }));
+		return onnx_model(graph);
+	}
+
+	// Depth perception: full-res depth -> 2x2 average pooled
+	std::string make_depth_model(int64_t width, int64_t height) {
+		ProtoWriter graph;
+		graph.message(1, onnx_node({ "depth" }, "depth_half", "AveragePool", {
+			onnx_ints_attribute("kernel_shape", { 2, 2 }),
+			onnx_ints_attribute("strides", { 2, 2 })
+		}));
+		graph.bytes_field(2, "depth_downsample");
+		graph.message(11, onnx_value_info("depth", { 1, 1, height, width }));
+		graph.message(12, onnx_value_info("depth_half", { 1, 1, height / 2, width / 2 }));
+		return onnx_model(graph);
+	}
+
+	// Host memory posing as a mapped upload buffer, what the CPU backend binds zero-copy
+	bud::ml::GpuTensor make_host_tensor(std::vector<float>& storage, std::vector<uint32_t> shape) {
+		bud::graphics::BufferHandle buffer;
+		buffer.internal_state = storage.data();
+		buffer.size = storage.size() * sizeof(float);
+		buffer.mapped_ptr = storage.data();
+		return bud::ml::GpuTensor(std::move(shape), bud::ml::DataType::Float32, buffer);
+	}
+
+	void bench_ml(Suite& suite, bud::threading::TaskScheduler& scheduler, uint32_t seed) {
+		if (!suite.wants_any({ "ml/onnx_occluder_scores", "ml/onnx_depth_downsample", "ml/onnx_async_dispatch" }))
+			return;
+
+		// OccluderSelectionPass candidate count and DepthDownsamplePass perception target
+		constexpr uint32_t CANDIDATES = 4096;
+		constexpr uint32_t FEATURES = 8;
+		constexpr uint32_t DEPTH_WIDTH = 512;
+		constexpr uint32_t DEPTH_HEIGHT = 288;
+
+		std::mt19937 rng(seed);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+		std::vector<float> features(CANDIDATES * FEATURES);
+		for (auto& f : features) f = unit(rng);
+		std::vector<float> scores(CANDIDATES);
+
+		bud::ml::OnnxCpuBackend occluder(&scheduler);
+		const std::string occluder_model = make_occluder_model(CANDIDATES, FEATURES, seed);
+		if (occluder.load_model_from_memory(occluder_model.data(), occluder_model.size(), "occluder_selection")) {
+			occluder.bind_input("features", make_host_tensor(features, { CANDIDATES, FEATURES }));
+			occluder.bind_output("scores", make_host_tensor(scores, { CANDIDATES, 1 }));
+
+			suite.run("ml/onnx_occluder_scores", CANDIDATES, [&]() {
+				occluder.run_now();
+				consume(static_cast<uint64_t>(scores[0] * 1000.0f));
+			});
+
+			// Dispatch as the frame does it and wait for the result, includes the task hop
+			suite.run("ml/onnx_async_dispatch", CANDIDATES, [&]() {
+				occluder.record_dispatch(nullptr, nullptr);
+				occluder.wait();
+				consume(static_cast<uint64_t>(scores[0] * 1000.0f));
+			});
+		}
+		else {
+			std::cerr << "Skipping ml/onnx_occluder_scores, model failed to load\n";
+		}
+
+		std::vector<float> depth(DEPTH_WIDTH * DEPTH_HEIGHT);
+		for (auto& d : depth) d = unit(rng);
+		std::vector<float> depth_half((DEPTH_WIDTH / 2) * (DEPTH_HEIGHT / 2));
+
+		bud::ml::OnnxCpuBackend downsample(&scheduler);
+		const std::string depth_model = make_depth_model(DEPTH_WIDTH, DEPTH_HEIGHT);
+		if (downsample.load_model_from_memory(depth_model.data(), depth_model.size(), "depth_downsample")) {
+			downsample.bind_input("depth", make_host_tensor(depth, { 1, 1, DEPTH_HEIGHT, DEPTH_WIDTH }));
+			downsample.bind_output("depth_half", make_host_tensor(depth_half, { 1, 1, DEPTH_HEIGHT / 2, DEPTH_WIDTH / 2 }));
+
+			// Per input pixel
+			suite.run("ml/onnx_depth_downsample", DEPTH_WIDTH * DEPTH_HEIGHT, [&]() {
+				downsample.run_now();
+				consume(static_cast<uint64_t>(depth_half[0] * 1000.0f));
+			});
+		}
+		else {
+			std::cerr << "Skipping ml/onnx_depth_downsample, model failed to load\n";
+		}
+	}
+
+	bool write_json(const std::string& path, const Options& options, uint32_t threads, const std::vector<Result>& results) {
+		nlohmann::json root;
+		root["tool"] = "bud_benchmarks";
+		root["unit"] = "ns_per_item";
+#if defined(NDEBUG)
+		root["build"] = "release";
+#else
+		root["build"] = "debug";
+#endif
+		root["threads"] = threads;
+		root["repetitions"] = options.repetitions;
+		root["warmup"] = options.warmup;
+		root["min_time_ms"] = options.min_time_ms;
+		root["instances"] = options.instances;
+		root["seed"] = options.seed;
+
+		auto& list = root["benchmarks"] = nlohmann::json::array();
+		for (const auto& r : results) {
+			list.push_back({
+				{"name", r.name},
+				{"items_per_call", r.items_per_call},
+				{"calls_per_repetition", r.calls_per_repetition},
+				{"repetitions", r.repetitions},
+				{"min_ns", r.min_ns},
+				{"median_ns", r.median_ns},
+				{"mean_ns", r.mean_ns},
+				{"stddev_ns", r.stddev_ns},
+				{"max_ns", r.max_ns},
+				{"cv_percent", r.cv_percent}
+			});
+		}
+
+		std::error_code ec;
+		auto parent = std::filesystem::path(path).parent_path();
+		if (!parent.empty())
+			std::filesystem::create_directories(parent, ec);
+
+		std::ofstream out(path, std::ios::trunc);
+		if (!out.is_open())
+			return false;
+		out << root.dump(2) << "\n";
+		return static_cast<bool>(out);
+	}
+}
+
+int main(int argc, char** argv) {
+	Options options;
+
+	for (int i = 1; i < argc; ++i) {
+		std::string a = argv[i];
+		if (a == "--list") { options.list_only = true; }
+		else if (a == "--filter" && i + 1 < argc) { options.filter = argv[++i]; }
+		else if (a == "--repetitions" && i + 1 < argc) { options.repetitions = std::max(1u, static_cast<uint32_t>(std::stoul(argv[++i]))); }
+		else if (a == "--warmup" && i + 1 < argc) { options.warmup = static_cast<uint32_t>(std::stoul(argv[++i])); }
+		else if (a == "--min-time-ms" && i + 1 < argc) { options.min_time_ms = std::max(0.0, std::stod(argv[++i])); }
+		else if (a == "--threads" && i + 1 < argc) { options.threads = static_cast<uint32_t>(std::stoul(argv[++i])); }
+		else if (a == "--instances" && i + 1 < argc) { options.instances = std::max(1u, static_cast<uint32_t>(std::stoul(argv[++i]))); }
+		else if (a == "--seed" && i + 1 < argc) { options.seed = static_cast<uint32_t>(std::stoul(argv[++i])); }
+		else if (a == "--mesh" && i + 1 < argc) { options.mesh_path = argv[++i]; }
+		else if (a == "--scene" && i + 1 < argc) { options.scene_path = argv[++i]; }
+		else if (a == "--json" && i + 1 < argc) { options.json_path = argv[++i]; }
+		else {
+			std::cerr << "Usage: bud_benchmarks [--list] [--filter S] [--repetitions N] [--warmup N] [--min-time-ms T]\n"
+				<< "                      [--threads N] [--instances N] [--seed N] [--mesh F] [--scene F] [--json F]\n";
+			return 1;
+		}
+	}
+
+	if (options.list_only) {
+		for (const char* name : BENCHMARK_NAMES)
+			std::cout << name << "\n";
+		return 0;
+	}
+
+	const uint32_t threads = options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+	bud::threading::TaskScheduler scheduler(threads);
+	scheduler.init_main_thread_worker();
+
+	Suite suite(options);
+	std::cout << "bud_benchmarks: " << threads << " thread(s), " << options.repetitions << " repetitions, "
+		<< options.min_time_ms << " ms minimum per repetition, times per item\n";
+
+	bench_threading(suite, scheduler);
+	bench_math(suite, options.seed);
+	bench_scene(suite, scheduler, options);
+	bench_submesh_keys(suite, options);
+	bench_multiview(suite, options);
+	bench_foliage(suite, options);
+	bench_hlod(suite, options);
+	bench_instances(suite, options);
+	bench_io(suite, options);
+	bench_render_graph(suite);
+	bench_ml(suite, scheduler, options.seed);
+
+	if (!options.json_path.empty()) {
+		if (!write_json(options.json_path, options, threads, suite.get_results())) {
+			std::cerr << "Failed to write " << options.json_path << "\n";
+			return 2;
+		}
+		std::cout << "Results written to " << options.json_path << "\n";
+	}
+	if (suite.get_failure_count() > 0) {
+		std::cerr << suite.get_failure_count() << " check(s) failed\n";
+		return 3;
+	}
+	return 0;
+}
@@ -0,0 +1,271 @@
+﻿#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "src/core/bud.logger.hpp"
+
+// BudLogTool
+//   --decode <file.budlog> [--output <file.txt>]   Binary log -> text, same layout as the live text backends
+//   --bench [--iterations N] [--threads T]          Per-call latency, legacy string logger vs binary records
+
+namespace {
+
+	template<typename T>
+	bool read_pod(std::ifstream& in, T& out) {
+		return static_cast<bool>(in.read(reinterpret_cast<char*>(&out), sizeof(T)));
+	}
+
+	int decode(const std::string& input, const std::string& output) {
+		std::ifstream in(input, std::ios::binary);
+		if (!in.is_open()) { std::cerr << "Failed to open input: " << input << "\n"; return 2; }
+
+		char magic[sizeof(bud::LOG_FILE_MAGIC)] = {};
+		if (!in.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), bud::LOG_FILE_MAGIC)) {
+			std::cerr << "Not a .budlog file: " << input << "\n";
+			return 3;
+		}
+
+		std::ofstream file_out;
+		if (!output.empty()) {
+			file_out.open(output, std::ios::trunc);
+			if (!file_out.is_open()) { std::cerr << "Failed to open output: " << output << "\n"; return 4; }
+		}
+		std::ostream& out = output.empty() ? std::cout : file_out;
+
+		std::vector<std::string> formats;
+		std::vector<std::byte> payload;
+		uint64_t records = 0;
+		uint64_t dropped = 0;
+
+		bud::LogChunk kind;
+		while (read_pod(in, kind)) {
+			if (kind == bud::LogChunk::Format) {
+				uint32_t id = 0;
+				uint32_t length = 0;
+				if (!read_pod(in, id) || !read_pod(in, length)) break;
+
+				std::string fmt(length, '\0');
+				if (!in.read(fmt.data(), length)) break;
+				if (id >= formats.size()) formats.resize(id + 1);
+				formats[id] = std::move(fmt);
+			}
+			else if (kind == bud::LogChunk::Record) {
+				bud::LogRecordHeader header;
+				if (!read_pod(in, header)) break;
+
+				payload.resize(header.payload_size);
+				if (!in.read(reinterpret_cast<char*>(payload.data()), header.payload_size)) break;
+
+				std::string_view fmt = header.format_id < formats.size() ? std::string_view(formats[header.format_id]) : std::string_view("<unknown format>");
+				out << bud::make_log_prefix(header.timestamp_ns, header.thread_tag);
+				out << bud::make_log_tags(header.level, header.category);
+				out << bud::format_log_record(fmt, payload.data(), payload.size()) << '\n';
+				records++;
+			}
+			else if (kind == bud::LogChunk::Dropped) {
+				uint32_t thread_tag = 0;
+				uint64_t count = 0;
+				if (!read_pod(in, thread_tag) || !read_pod(in, count)) break;
+
+				out << "[Logger] Dropped " << count << " messages from TID=" << std::setw(6) << std::setfill('0') << thread_tag << std::setfill(' ') << " (ring buffer full)\n";
+				dropped += count;
+			}
+			else {
+				std::cerr << "Corrupt chunk at offset " << in.tellg() << ", stopping\n";
+				break;
+			}
+		}
+
+		std::cerr << "Decoded " << records << " records, " << formats.size() << " format sites, " << dropped << " dropped\n";
+		return 0;
+	}
+
+	// The previous logger: prefix built with ostringstream + put_time and the message formatted
+	// on the calling thread, then pushed into a mutex-protected vector for the IO thread.
+	class LegacyLogger {
+	public:
+		LegacyLogger() : io_thread(&LegacyLogger::io_loop, this) {}
+
+		~LegacyLogger() {
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				running = false;
+			}
+			condition.notify_all();
+			io_thread.join();
+		}
+
+		void log(const std::string& msg) {
+			using namespace std::chrono;
+			auto now = system_clock::now();
+			auto ms = duration_cast<milliseconds>(now.time_since_epoch()) % 1000;
+			std::time_t t = system_clock::to_time_t(now);
+			std::tm tm_info{};
+#ifdef _WIN32
+			localtime_s(&tm_info, &t);
+#else
+			localtime_r(&t, &tm_info);
+#endif
+			std::ostringstream ss;
+			ss << std::put_time(&tm_info, "%H:%M:%S") << "." << std::setfill('0') << std::setw(3) << ms.count();
+			size_t tid_hash = std::hash<std::thread::id>{}(std::this_thread::get_id());
+			ss << " [TID=" << std::setw(6) << (tid_hash % 1000000) << "] ";
+
+			std::string full_msg = ss.str() + msg;
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				queue.push_back(std::move(full_msg));
+			}
+			condition.notify_one();
+		}
+
+	private:
+		void io_loop() {
+			std::vector<std::string> local;
+			while (true) {
+				std::unique_lock<std::mutex> lock(mutex);
+				condition.wait(lock, [this]() { return !queue.empty() || !running; });
+				if (queue.empty() && !running) break;
+				local.swap(queue);
+				lock.unlock();
+				local.clear(); // Sink discarded, only the producer side is measured
+			}
+		}
+
+		std::mutex mutex;
+		std::condition_variable condition;
+		std::vector<std::string> queue;
+		bool running = true;
+		std::thread io_thread;
+	};
+
+	struct LatencyStats {
+		double mean_ns = 0.0;
+		double p50_ns = 0.0;
+		double p99_ns = 0.0;
+		double max_ns = 0.0;
+	};
+
+	template<typename F>
+	LatencyStats measure(uint32_t threads, uint32_t iterations, F&& log_call) {
+		std::vector<std::vector<double>> samples(threads);
+		std::vector<std::thread> workers;
+
+		for (uint32_t t = 0; t < threads; ++t) {
+			workers.emplace_back([&, t]() {
+				auto& local = samples[t];
+				local.reserve(iterations);
+				for (uint32_t i = 0; i < iterations; ++i) {
+					auto start = std::chrono::steady_clock::now();
+					log_call(t, i);
+					auto end = std::chrono::steady_clock::now();
+					local.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+				}
+			});
+		}
+		for (auto& worker : workers) worker.join();
+
+		std::vector<double> all;
+		for (auto& local : samples) all.insert(all.end(), local.begin(), local.end());
+		std::sort(all.begin(), all.end());
+
+		LatencyStats stats;
+		if (all.empty()) return stats;
+
+		double sum = 0.0;
+		for (double v : all) sum += v;
+		stats.mean_ns = sum / static_cast<double>(all.size());
+		stats.p50_ns = all[all.size() / 2];
+		stats.p99_ns = all[std::min(all.size() - 1, all.size() * 99 / 100)];
+		stats.max_ns = all.back();
+		return stats;
+	}
+
+	void print_stats(const char* name, const LatencyStats& stats) {
+		std::cout << std::left << std::setw(26) << name << std::right << std::fixed << std::setprecision(1)
+			<< " mean " << std::setw(8) << stats.mean_ns << " ns"
+			<< "  p50 " << std::setw(8) << stats.p50_ns << " ns"
+			<< "  p99 " << std::setw(8) << stats.p99_ns << " ns"
+			<< "  max " << std::setw(10) << stats.max_ns << " ns\n";
+	}
+
+	int bench(uint32_t iterations, uint32_t threads) {
+		std::cout << "Logger bench: " << threads << " thread(s) x " << iterations << " calls, outputs discarded\n";
+
+		const float frame_ms = 16.42f;
+		const char* pass_name = "ShadowPass";
+
+		LatencyStats legacy;
+		{
+			LegacyLogger logger;
+			legacy = measure(threads, iterations, [&](uint32_t t, uint32_t i) {
+				logger.log(std::format("[Bench] thread {} frame {} pass {} took {:.3f} ms", t, i, pass_name, frame_ms));
+			});
+		}
+
+		LatencyStats binary;
+		uint64_t dropped = 0;
+		{
+			bud::Logger logger({});
+			logger.set_backend_mask(0);
+			bud::set_global_logger(&logger);
+			binary = measure(threads, iterations, [&](uint32_t t, uint32_t i) {
+				// write_log skips the level filters, so release builds of the tool still measure the record path
+				bud::write_log(bud::LogLevel::Info, bud::LogCategory::Core, "[Bench] thread {} frame {} pass {} took {:.3f} ms", t, i, pass_name, frame_ms);
+			});
+			logger.flush();
+			dropped = logger.get_dropped_count();
+			bud::set_global_logger(nullptr);
+		}
+
+		print_stats("legacy (string + mutex)", legacy);
+		print_stats("binary (per-thread ring)", binary);
+		std::cout << "Dropped records (ring full): " << dropped << "\n";
+		if (binary.mean_ns > 0.0) {
+			std::cout << "Mean speedup: " << std::setprecision(2) << legacy.mean_ns / binary.mean_ns << "x\n";
+		}
+		return 0;
+	}
+}
+
+int main(int argc, char** argv) {
+	if (argc < 2) {
+		std::cerr << "Usage: BudLogTool --decode <file.budlog> [--output <file.txt>]\n"
+			<< "       BudLogTool --bench [--iterations N] [--threads T]\n";
+		return 1;
+	}
+
+	std::string mode = argv[1];
+	std::string input;
+	std::string output;
+	uint32_t iterations = 100000;
+	uint32_t threads = 1;
+
+	for (int i = 1; i < argc; ++i) {
+		std::string a = argv[i];
+		if (a == "--decode" && i + 1 < argc) { input = argv[++i]; }
+		else if (a == "--output" && i + 1 < argc) { output = argv[++i]; }
+		else if (a == "--iterations" && i + 1 < argc) { iterations = static_cast<uint32_t>(std::stoul(argv[++i])); }
+		else if (a == "--threads" && i + 1 < argc) { threads = std::max(1u, static_cast<uint32_t>(std::stoul(argv[++i]))); }
+	}
+
+	if (mode == "--decode") {
+		if (input.empty()) { std::cerr << "Missing input file\n"; return 1; }
+		return decode(input, output);
+	}
+	if (mode == "--bench") {
+		return bench(iterations, threads);
+	}
+
+	std::cerr << "Unknown mode: " << mode << "\n";
+	return 1;
+}
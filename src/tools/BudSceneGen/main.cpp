@@ -0,0 +1,652 @@
+﻿#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// BudSceneGen: writes large procedural scenes in the engine's scene JSON format (bud.scene.io.hpp)
+// for culling, extraction, sorting and streaming stress tests.
+//   --output <file.json>           Output scene (default tmp/stress_scene.json)
+//   --layout city|forest|corridors Spatial distribution (default city)
+//   --instances N                  Entity count, 1K .. 10M (default 10000)
+//   --seed N                       Same seed + options = byte-identical file (default 1)
+//   --mesh-variety N               Distinct assets drawn from the layout palette (default: whole palette)
+//   --mesh <path>                  Replace the palette, repeatable
+//   --dynamic-ratio R              Fraction of entities written with is_static = false (default 0.1)
+//   --point-lights N               Local point lights (default 64)
+//   --spot-lights N                Local spot lights (default 16)
+//   --asset-scale S                Uniform scale of the tree assets (default 1)
+// Everything runs on an integer PRNG and fixed-precision printing, so output doesn't depend on the
+// standard library's distributions or float formatting.
+
+namespace {
+
+	constexpr uint32_t MIN_INSTANCES = 1000;
+	constexpr uint32_t MAX_INSTANCES = 10000000;
+	constexpr uint32_t MAX_LOCAL_LIGHTS = 4096;  // bud::graphics::MAX_LOCAL_LIGHTS, the rest would be dropped at upload
+
+	// Meshes from the data folder. Buildings, walls and props are scaled unit cubes ([-1, 1]).
+	const char* const CUBE_MESH = "data/meshlets/Cube.budmesh";
+	const std::vector<std::string> FOREST_PALETTE = {
+		"data/chestnut/AL05a.obj",
+		"data/chestnut/AL05m.obj",
+		"data/chestnut/AL05y.obj",
+		"data/pine/scrubPine.obj",
+		"data/white_oak/white_oak.obj"
+	};
+
+	enum class Layout {
+		City,
+		Forest,
+		Corridors
+	};
+
+	struct Options {
+		std::string output = "tmp/stress_scene.json";
+		Layout layout = Layout::City;
+		uint32_t instances = 10000;
+		uint64_t seed = 1;
+		uint32_t mesh_variety = 0;
+		std::vector<std::string> meshes;
+		float dynamic_ratio = 0.1f;
+		uint32_t point_lights = 64;
+		uint32_t spot_lights = 16;
+		float asset_scale = 1.0f;
+	};
+
+	// PCG32 (O'Neill), fixed output on every platform unlike <random> distributions
+	class Rng {
+	public:
+		explicit Rng(uint64_t seed, uint64_t stream = 0x9E3779B97F4A7C15ull) : inc((stream << 1u) | 1u) {
+			next();
+			state += seed;
+			next();
+		}
+
+		uint32_t next() {
+			uint64_t old = state;
+			state = old * 6364136223846793005ull + inc;
+			uint32_t xorshifted = static_cast<uint32_t>(((old >> 18u) ^ old) >> 27u);
+			uint32_t rot = static_cast<uint32_t>(old >> 59u);
+			return (xorshifted >> rot) | (xorshifted << ((~rot + 1u) & 31u));
+		}
+
+		// [0, 1)
+		float uniform() { return static_cast<float>(next() >> 8) * (1.0f / 16777216.0f); }
+		float range(float lo, float hi) { return lo + (hi - lo) * uniform(); }
+		uint32_t below(uint32_t n) { return n ? static_cast<uint32_t>((static_cast<uint64_t>(next()) * n) >> 32) : 0; }
+
+		// Box-Muller, one value per call
+		float normal() {
+			float u1 = std::max(uniform(), 1.0e-7f);
+			float u2 = uniform();
+			return std::sqrt(-2.0f * std::log(u1)) * std::cos(6.2831853f * u2);
+		}
+
+	private:
+		uint64_t state = 0;
+		uint64_t inc;
+	};
+
+	struct Placement {
+		float position[3] = {};
+		float yaw = 0.0f;  // Radians around +Y
+		float scale[3] = { 1.0f, 1.0f, 1.0f };
+		uint32_t mesh = 0;  // Index into the palette
+	};
+
+	struct PointLightDesc {
+		float position[3] = {};
+		float color[3] = { 1.0f, 1.0f, 1.0f };
+		float intensity = 10.0f;
+		float range = 10.0f;
+	};
+
+	struct SpotLightDesc {
+		float position[3] = {};
+		float direction[3] = { 0.0f, -1.0f, 0.0f };
+		float color[3] = { 1.0f, 1.0f, 1.0f };
+		float intensity = 20.0f;
+		float range = 20.0f;
+	};
+
+	struct CameraDesc {
+		float position[3] = { 0.0f, 2.0f, 0.0f };
+		float yaw = -90.0f;
+		float pitch = 0.0f;
+		float speed = 50.0f;
+	};
+
+	// Buffered writer with fixed-precision floats, a 10M entity scene is a few GB
+	class JsonWriter {
+	public:
+		explicit JsonWriter(std::ofstream& out) : out(out) { buffer.reserve(1 << 20); }
+		~JsonWriter() { flush(); }
+
+		void raw(std::string_view s) {
+			buffer.append(s);
+			if (buffer.size() >= (1 << 20)) flush();
+		}
+
+		void number(float v) {
+			// 4 decimals, -0 folded to 0 so mirrored layouts don't differ in sign only
+			char tmp[32];
+			double d = std::round(static_cast<double>(v) * 10000.0) / 10000.0;
+			if (d == 0.0) d = 0.0;
+			auto [end, ec] = std::to_chars(tmp, tmp + sizeof(tmp), d, std::chars_format::fixed, 4);
+			raw(std::string_view(tmp, static_cast<size_t>(end - tmp)));
+		}
+
+		void number(uint32_t v) {
+			char tmp[16];
+			auto [end, ec] = std::to_chars(tmp, tmp + sizeof(tmp), v);
+			raw(std::string_view(tmp, static_cast<size_t>(end - tmp)));
+		}
+
+		void vec3(const float* v) {
+			raw("[");
+			number(v[0]); raw(", ");
+			number(v[1]); raw(", ");
+			number(v[2]); raw("]");
+		}
+
+		void string(const std::string& s) {
+			raw("\"");
+			for (char c : s) {
+				if (c == '"' || c == '\\') raw("\\");
+				buffer.push_back(c);
+			}
+			raw("\"");
+		}
+
+		void flush() {
+			out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+			buffer.clear();
+		}
+
+	private:
+		std::ofstream& out;
+		std::string buffer;
+	};
+
+	// Column-major translate * rotate_y * scale, the layout glm and the scene loader use
+	void write_transform(JsonWriter& w, const Placement& p) {
+		float c = std::cos(p.yaw);
+		float s = std::sin(p.yaw);
+		float m[16] = {
+			c * p.scale[0], 0.0f, -s * p.scale[0], 0.0f,
+			0.0f, p.scale[1], 0.0f, 0.0f,
+			s * p.scale[2], 0.0f, c * p.scale[2], 0.0f,
+			p.position[0], p.position[1], p.position[2], 1.0f
+		};
+
+		w.raw("[");
+		for (int i = 0; i < 16; ++i) {
+			if (i) w.raw(", ");
+			w.number(m[i]);
+		}
+		w.raw("]");
+	}
+
+	// Layouts. Each fills placements (exactly options.instances), lights and the start camera.
+
+	struct LayoutResult {
+		std::vector<Placement> placements;
+		std::vector<PointLightDesc> point_lights;
+		std::vector<SpotLightDesc> spot_lights;
+		CameraDesc camera;
+		float extent = 0.0f;  // Half size of the populated area, for the summary
+	};
+
+	void warm_color(Rng& rng, float* out) {
+		out[0] = 1.0f;
+		out[1] = rng.range(0.75f, 0.95f);
+		out[2] = rng.range(0.55f, 0.8f);
+	}
+
+	// Square city blocks separated by streets, one building per lot. Dynamic entities become
+	// cars on the streets so moving objects end up where a game would have them.
+	void generate_city(const Options& options, uint32_t palette_size, uint32_t dynamic_count, Rng& rng, LayoutResult& out) {
+		constexpr float LOT = 20.0f;
+		constexpr uint32_t LOTS_PER_BLOCK = 4;  // 4 x 4 lots per block
+		constexpr float STREET = 12.0f;
+		constexpr float BLOCK = LOT * LOTS_PER_BLOCK + STREET;
+
+		const uint32_t static_count = options.instances - dynamic_count;
+		const uint32_t lots_per_side = std::max(1u, static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(std::max(1u, static_count))))));
+		const uint32_t blocks_per_side = (lots_per_side + LOTS_PER_BLOCK - 1) / LOTS_PER_BLOCK;
+		const float half = blocks_per_side * BLOCK * 0.5f;
+		out.extent = half;
+
+		auto lot_origin = [&](uint32_t lx, uint32_t lz, float* pos) {
+			uint32_t bx = lx / LOTS_PER_BLOCK;
+			uint32_t bz = lz / LOTS_PER_BLOCK;
+			pos[0] = -half + bx * BLOCK + STREET * 0.5f + (lx % LOTS_PER_BLOCK) * LOT + LOT * 0.5f;
+			pos[2] = -half + bz * BLOCK + STREET * 0.5f + (lz % LOTS_PER_BLOCK) * LOT + LOT * 0.5f;
+		};
+
+		for (uint32_t i = 0; i < static_count; ++i) {
+			Placement p;
+			lot_origin(i % lots_per_side, i / lots_per_side, p.position);
+
+			// Mostly low-rise with a long tail of towers
+			float height = 4.0f + 6.0f * std::exp(rng.range(0.0f, 2.5f) * rng.uniform());
+			float fx = rng.range(5.0f, 9.0f);
+			float fz = rng.range(5.0f, 9.0f);
+			p.scale[0] = fx;
+			p.scale[1] = height * 0.5f;
+			p.scale[2] = fz;
+			p.position[1] = height * 0.5f;
+			p.yaw = 0.0f;
+			p.mesh = rng.below(palette_size);
+			out.placements.push_back(p);
+		}
+
+		for (uint32_t i = 0; i < dynamic_count; ++i) {
+			Placement p;
+			uint32_t street = rng.below(blocks_per_side + 1);
+			float along = rng.range(-half, half);
+			float lane = rng.range(-STREET * 0.3f, STREET * 0.3f);
+			float street_pos = -half + street * BLOCK;
+			bool x_aligned = rng.below(2) == 0;
+			p.position[0] = x_aligned ? along : street_pos + lane;
+			p.position[2] = x_aligned ? street_pos + lane : along;
+			p.position[1] = 0.75f;
+			p.yaw = x_aligned ? 1.5707963f : 0.0f;
+			p.scale[0] = 0.9f;
+			p.scale[1] = 0.75f;
+			p.scale[2] = 2.2f;
+			p.mesh = rng.below(palette_size);
+			out.placements.push_back(p);
+		}
+
+		// Street lamps at intersections and along the streets, spot lights pointing down
+		for (uint32_t i = 0; i < options.point_lights; ++i) {
+			PointLightDesc l;
+			uint32_t sx = rng.below(blocks_per_side + 1);
+			l.position[0] = -half + sx * BLOCK;
+			l.position[1] = 6.0f;
+			l.position[2] = rng.range(-half, half);
+			if (rng.below(2)) std::swap(l.position[0], l.position[2]);
+			warm_color(rng, l.color);
+			l.intensity = rng.range(10.0f, 30.0f);
+			l.range = rng.range(15.0f, 30.0f);
+			out.point_lights.push_back(l);
+		}
+		for (uint32_t i = 0; i < options.spot_lights; ++i) {
+			SpotLightDesc l;
+			l.position[0] = -half + rng.below(blocks_per_side + 1) * BLOCK;
+			l.position[1] = 9.0f;
+			l.position[2] = -half + rng.below(blocks_per_side + 1) * BLOCK;
+			warm_color(rng, l.color);
+			l.intensity = rng.range(30.0f, 60.0f);
+			l.range = 25.0f;
+			out.spot_lights.push_back(l);
+		}
+
+		// Street level at a corner, looking down the avenue
+		out.camera.position[0] = -half + 2.0f;
+		out.camera.position[1] = 2.0f;
+		out.camera.position[2] = -half + 2.0f;
+		out.camera.yaw = 45.0f;
+		out.camera.speed = std::clamp(half * 0.05f, 20.0f, 500.0f);
+	}
+
+	// Trees gathered around gaussian clusters, roughly one tree per 30 m^2 inside a cluster.
+	// Dynamic entities are trees too (swaying / destructible candidates), spread by write_scene.
+	void generate_forest(const Options& options, uint32_t palette_size, uint32_t /*dynamic_count*/, Rng& rng, LayoutResult& out) {
+		constexpr float TREES_PER_CLUSTER = 400.0f;
+		constexpr float AREA_PER_TREE = 30.0f;
+
+		const uint32_t cluster_count = std::max(1u, static_cast<uint32_t>(std::ceil(options.instances / TREES_PER_CLUSTER)));
+		const float cluster_sigma = std::sqrt(TREES_PER_CLUSTER * AREA_PER_TREE) * 0.35f;
+		// Clusters take about a third of the ground, the rest are clearings
+		const float half = std::sqrt(options.instances * AREA_PER_TREE * 3.0f) * 0.5f;
+		out.extent = half;
+
+		struct Cluster { float x, z; uint32_t dominant; };
+		std::vector<Cluster> clusters(cluster_count);
+		for (auto& c : clusters) {
+			c.x = rng.range(-half, half);
+			c.z = rng.range(-half, half);
+			c.dominant = rng.below(palette_size);
+		}
+
+		for (uint32_t i = 0; i < options.instances; ++i) {
+			const auto& c = clusters[i % cluster_count];
+			Placement p;
+			p.position[0] = std::clamp(c.x + rng.normal() * cluster_sigma, -half, half);
+			p.position[1] = 0.0f;
+			p.position[2] = std::clamp(c.z + rng.normal() * cluster_sigma, -half, half);
+			p.yaw = rng.range(0.0f, 6.2831853f);
+			float s = options.asset_scale * rng.range(0.75f, 1.3f);
+			p.scale[0] = p.scale[1] = p.scale[2] = s;
+			// Clusters are mostly one species with some mixing
+			p.mesh = rng.uniform() < 0.7f ? c.dominant : rng.below(palette_size);
+			out.placements.push_back(p);
+		}
+
+		for (uint32_t i = 0; i < options.point_lights; ++i) {
+			const auto& c = clusters[rng.below(cluster_count)];
+			PointLightDesc l;
+			l.position[0] = c.x + rng.normal() * cluster_sigma;
+			l.position[1] = rng.range(1.0f, 4.0f);
+			l.position[2] = c.z + rng.normal() * cluster_sigma;
+			// Fireflies / campfires
+			l.color[0] = 1.0f; l.color[1] = rng.range(0.5f, 0.9f); l.color[2] = rng.range(0.2f, 0.5f);
+			l.intensity = rng.range(5.0f, 20.0f);
+			l.range = rng.range(8.0f, 20.0f);
+			out.point_lights.push_back(l);
+		}
+		for (uint32_t i = 0; i < options.spot_lights; ++i) {
+			SpotLightDesc l;
+			l.position[0] = rng.range(-half, half);
+			l.position[1] = rng.range(2.0f, 5.0f);
+			l.position[2] = rng.range(-half, half);
+			float a = rng.range(0.0f, 6.2831853f);
+			l.direction[0] = std::cos(a) * 0.8f;
+			l.direction[1] = -0.6f;
+			l.direction[2] = std::sin(a) * 0.8f;
+			l.intensity = rng.range(20.0f, 50.0f);
+			l.range = 30.0f;
+			out.spot_lights.push_back(l);
+		}
+
+		// Inside the first cluster, eye height
+		out.camera.position[0] = clusters[0].x;
+		out.camera.position[1] = 1.8f;
+		out.camera.position[2] = clusters[0].z;
+		out.camera.speed = std::clamp(half * 0.05f, 10.0f, 300.0f);
+	}
+
+	// Orthogonal corridor grid on stacked floors. Every corridor segment is a floor, a ceiling
+	// and two walls; the remaining budget goes to props along the walls (dynamic ones included).
+	void generate_corridors(const Options& options, uint32_t palette_size, uint32_t dynamic_count, Rng& rng, LayoutResult& out) {
+		constexpr float SEGMENT = 8.0f;   // Segment length
+		constexpr float WIDTH = 4.0f;
+		constexpr float HEIGHT = 3.5f;
+		constexpr float FLOOR_HEIGHT = 5.0f;
+		constexpr uint32_t GRID = 32;     // Segments per row / column on one floor
+		constexpr uint32_t PIECES_PER_SEGMENT = 4;
+		constexpr uint32_t PROPS_PER_SEGMENT = 4;
+
+		// Segments on one floor: GRID rows + GRID columns of GRID segments each
+		const uint32_t segments_per_floor = GRID * GRID * 2;
+		const uint32_t per_segment = PIECES_PER_SEGMENT + PROPS_PER_SEGMENT;
+		const uint32_t segment_count = std::max(1u, options.instances / per_segment);
+		const float half = GRID * SEGMENT * 0.5f;
+		out.extent = half;
+
+		struct Segment { float x, y, z; bool along_x; };
+		std::vector<Segment> segments;
+		segments.reserve(segment_count);
+		for (uint32_t s = 0; s < segment_count; ++s) {
+			uint32_t f = s / segments_per_floor;
+			uint32_t k = s % segments_per_floor;
+			bool along_x = k < GRID * GRID;
+			uint32_t line = (k % (GRID * GRID)) / GRID;
+			uint32_t step = k % GRID;
+			float a = -half + (step + 0.5f) * SEGMENT;
+			float b = -half + line * SEGMENT;
+			segments.push_back({ along_x ? a : b, f * FLOOR_HEIGHT, along_x ? b : a, along_x });
+		}
+
+		auto piece = [&](const Segment& s, float ox, float oy, float oz, float sx, float sy, float sz) {
+			Placement p;
+			// Offsets are given for an x-aligned segment, swap for z-aligned ones
+			p.position[0] = s.x + (s.along_x ? ox : oz);
+			p.position[1] = s.y + oy;
+			p.position[2] = s.z + (s.along_x ? oz : ox);
+			p.scale[0] = s.along_x ? sx : sz;
+			p.scale[1] = sy;
+			p.scale[2] = s.along_x ? sz : sx;
+			p.mesh = 0;  // Structure always uses the first palette entry
+			out.placements.push_back(p);
+		};
+
+		const uint32_t static_budget = options.instances - dynamic_count;
+		for (const auto& s : segments) {
+			if (out.placements.size() + PIECES_PER_SEGMENT > static_budget) break;
+			piece(s, 0.0f, -0.1f, 0.0f, SEGMENT * 0.5f, 0.1f, WIDTH * 0.5f);              // Floor
+			piece(s, 0.0f, HEIGHT + 0.1f, 0.0f, SEGMENT * 0.5f, 0.1f, WIDTH * 0.5f);      // Ceiling
+			piece(s, 0.0f, HEIGHT * 0.5f, WIDTH * 0.5f, SEGMENT * 0.5f, HEIGHT * 0.5f, 0.1f);   // Walls
+			piece(s, 0.0f, HEIGHT * 0.5f, -WIDTH * 0.5f, SEGMENT * 0.5f, HEIGHT * 0.5f, 0.1f);
+		}
+
+		// Props fill the rest, static first then dynamic
+		uint32_t placed = static_cast<uint32_t>(out.placements.size());
+		for (uint32_t i = placed; i < options.instances; ++i) {
+			const auto& s = segments[rng.below(static_cast<uint32_t>(segments.size()))];
+			float size = rng.range(0.2f, 0.6f);
+			Placement p;
+			float ox = rng.range(-SEGMENT * 0.45f, SEGMENT * 0.45f);
+			float oz = (rng.below(2) ? 1.0f : -1.0f) * (WIDTH * 0.5f - size - 0.2f);
+			p.position[0] = s.x + (s.along_x ? ox : oz);
+			p.position[1] = s.y + size;
+			p.position[2] = s.z + (s.along_x ? oz : ox);
+			p.yaw = rng.range(0.0f, 6.2831853f);
+			p.scale[0] = p.scale[1] = p.scale[2] = size;
+			p.mesh = palette_size > 1 ? 1 + rng.below(palette_size - 1) : 0;
+			out.placements.push_back(p);
+		}
+
+		// Ceiling lights every few segments, spots over junctions
+		for (uint32_t i = 0; i < options.point_lights; ++i) {
+			const auto& s = segments[rng.below(static_cast<uint32_t>(segments.size()))];
+			PointLightDesc l;
+			l.position[0] = s.x;
+			l.position[1] = s.y + HEIGHT - 0.3f;
+			l.position[2] = s.z;
+			l.color[0] = 0.9f; l.color[1] = 0.95f; l.color[2] = 1.0f;
+			l.intensity = rng.range(8.0f, 15.0f);
+			l.range = SEGMENT * 1.5f;
+			out.point_lights.push_back(l);
+		}
+		for (uint32_t i = 0; i < options.spot_lights; ++i) {
+			const auto& s = segments[rng.below(static_cast<uint32_t>(segments.size()))];
+			SpotLightDesc l;
+			l.position[0] = s.x + (s.along_x ? SEGMENT * 0.5f : 0.0f);
+			l.position[1] = s.y + HEIGHT - 0.2f;
+			l.position[2] = s.z + (s.along_x ? 0.0f : SEGMENT * 0.5f);
+			l.intensity = rng.range(20.0f, 40.0f);
+			l.range = HEIGHT * 3.0f;
+			out.spot_lights.push_back(l);
+		}
+
+		// First corridor of the ground floor, looking along it
+		out.camera.position[0] = segments[0].x;
+		out.camera.position[1] = 1.7f;
+		out.camera.position[2] = segments[0].z;
+		out.camera.yaw = 0.0f;
+		out.camera.speed = 10.0f;
+	}
+
+	bool write_scene(const Options& options, const std::vector<std::string>& palette, const LayoutResult& layout, uint32_t dynamic_count) {
+		std::error_code ec;
+		auto parent = std::filesystem::path(options.output).parent_path();
+		if (!parent.empty())
+			std::filesystem::create_directories(parent, ec);
+
+		std::ofstream out(options.output, std::ios::binary | std::ios::trunc);
+		if (!out.is_open()) {
+			std::cerr << "Failed to open output: " << options.output << "\n";
+			return false;
+		}
+
+		// Dynamic entities are the tail of the placement list for city / corridors; forest picks
+		// an evenly spread subset so every cluster has some
+		const uint32_t count = static_cast<uint32_t>(layout.placements.size());
+		auto is_dynamic = [&](uint32_t i) {
+			if (dynamic_count == 0) return false;
+			if (options.layout == Layout::Forest)
+				return (static_cast<uint64_t>(i) * dynamic_count) % count < dynamic_count;
+			return i >= count - dynamic_count;
+		};
+
+		{
+			JsonWriter w(out);
+			w.raw("{\n    \"name\": ");
+			w.string("Stress scene (seed " + std::to_string(options.seed) + ")");
+			w.raw(",\n    \"ambient_strength\": 0.1000,\n");
+			w.raw("    \"directional_light\": { \"color\": [1.0, 0.96, 0.9], \"direction\": [0.3, 1.0, 0.2], \"intensity\": 3.0 },\n");
+
+			const auto& cam = layout.camera;
+			w.raw("    \"main_camera\": { \"position\": ");
+			w.vec3(cam.position);
+			w.raw(", \"yaw\": "); w.number(cam.yaw);
+			w.raw(", \"pitch\": "); w.number(cam.pitch);
+			w.raw(", \"zoom\": 45.0, \"speed\": "); w.number(cam.speed);
+			w.raw(", \"sensitivity\": 0.1 },\n");
+
+			w.raw("    \"point_lights\": [");
+			for (size_t i = 0; i < layout.point_lights.size(); ++i) {
+				const auto& l = layout.point_lights[i];
+				w.raw(i ? ",\n        " : "\n        ");
+				w.raw("{ \"position\": "); w.vec3(l.position);
+				w.raw(", \"color\": "); w.vec3(l.color);
+				w.raw(", \"intensity\": "); w.number(l.intensity);
+				w.raw(", \"range\": "); w.number(l.range);
+				w.raw(" }");
+			}
+			w.raw(layout.point_lights.empty() ? "],\n" : "\n    ],\n");
+
+			w.raw("    \"spot_lights\": [");
+			for (size_t i = 0; i < layout.spot_lights.size(); ++i) {
+				const auto& l = layout.spot_lights[i];
+				w.raw(i ? ",\n        " : "\n        ");
+				w.raw("{ \"position\": "); w.vec3(l.position);
+				w.raw(", \"direction\": "); w.vec3(l.direction);
+				w.raw(", \"color\": "); w.vec3(l.color);
+				w.raw(", \"intensity\": "); w.number(l.intensity);
+				w.raw(", \"range\": "); w.number(l.range);
+				w.raw(", \"inner_angle\": 20.0, \"outer_angle\": 30.0 }");
+			}
+			w.raw(layout.spot_lights.empty() ? "],\n" : "\n    ],\n");
+
+			// One entity per line keeps multi-GB files greppable and diffable
+			w.raw("    \"entities\": [");
+			for (uint32_t i = 0; i < count; ++i) {
+				const auto& p = layout.placements[i];
+				w.raw(i ? ",\n        " : "\n        ");
+				w.raw("{ \"asset_path\": "); w.string(palette[p.mesh]);
+				w.raw(", \"mesh_index\": 0, \"material_index\": 0, \"is_static\": ");
+				w.raw(is_dynamic(i) ? "false" : "true");
+				w.raw(", \"is_active\": true, \"transform\": ");
+				write_transform(w, p);
+				w.raw(" }");
+			}
+			w.raw(count ? "\n    ]\n}\n" : "]\n}\n");
+		}
+
+		out.flush();
+		if (!out) {
+			std::cerr << "Failed writing " << options.output << "\n";
+			return false;
+		}
+		return true;
+	}
+
+	bool parse_layout(const std::string& s, Layout& out) {
+		if (s == "city") { out = Layout::City; return true; }
+		if (s == "forest") { out = Layout::Forest; return true; }
+		if (s == "corridors") { out = Layout::Corridors; return true; }
+		return false;
+	}
+
+	const char* layout_name(Layout layout) {
+		switch (layout) {
+		case Layout::City: return "city";
+		case Layout::Forest: return "forest";
+		case Layout::Corridors: return "corridors";
+		}
+		return "unknown";
+	}
+
+	void print_usage() {
+		std::cerr << "Usage: BudSceneGen [--output F] [--layout city|forest|corridors] [--instances N] [--seed N]\n"
+			<< "                   [--mesh-variety N] [--mesh P ...] [--dynamic-ratio R]\n"
+			<< "                   [--point-lights N] [--spot-lights N] [--asset-scale S]\n";
+	}
+}
+
+int main(int argc, char** argv) {
+	Options options;
+
+	try {
+		for (int i = 1; i < argc; ++i) {
+			std::string a = argv[i];
+			if (a == "--output" && i + 1 < argc) { options.output = argv[++i]; }
+			else if (a == "--layout" && i + 1 < argc) {
+				if (!parse_layout(argv[++i], options.layout)) { std::cerr << "Unknown layout: " << argv[i] << "\n"; return 1; }
+			}
+			else if (a == "--instances" && i + 1 < argc) { options.instances = static_cast<uint32_t>(std::stoul(argv[++i])); }
+			else if (a == "--seed" && i + 1 < argc) { options.seed = std::stoull(argv[++i]); }
+			else if (a == "--mesh-variety" && i + 1 < argc) { options.mesh_variety = static_cast<uint32_t>(std::stoul(argv[++i])); }
+			else if (a == "--mesh" && i + 1 < argc) { options.meshes.push_back(argv[++i]); }
+			else if (a == "--dynamic-ratio" && i + 1 < argc) { options.dynamic_ratio = std::stof(argv[++i]); }
+			else if (a == "--point-lights" && i + 1 < argc) { options.point_lights = static_cast<uint32_t>(std::stoul(argv[++i])); }
+			else if (a == "--spot-lights" && i + 1 < argc) { options.spot_lights = static_cast<uint32_t>(std::stoul(argv[++i])); }
+			else if (a == "--asset-scale" && i + 1 < argc) { options.asset_scale = std::stof(argv[++i]); }
+			else if (a == "--help" || a == "-h") { print_usage(); return 0; }
+			else { print_usage(); return 1; }
+		}
+	}
+	catch (const std::exception&) {
+		std::cerr << "Invalid number in arguments\n";
+		print_usage();
+		return 1;
+	}
+
+	if (options.instances < MIN_INSTANCES || options.instances > MAX_INSTANCES) {
+		std::cerr << "--instances must be in [" << MIN_INSTANCES << ", " << MAX_INSTANCES << "]\n";
+		return 1;
+	}
+	options.dynamic_ratio = std::clamp(options.dynamic_ratio, 0.0f, 1.0f);
+
+	if (options.point_lights + options.spot_lights > MAX_LOCAL_LIGHTS) {
+		std::cerr << "Clamping local lights to " << MAX_LOCAL_LIGHTS << " (renderer limit)\n";
+		options.point_lights = std::min(options.point_lights, MAX_LOCAL_LIGHTS);
+		options.spot_lights = MAX_LOCAL_LIGHTS - options.point_lights;
+	}
+
+	// Palette: explicit meshes, else the layout default. Corridors keep the cube first for the structure.
+	std::vector<std::string> palette = options.meshes;
+	if (palette.empty()) {
+		palette = options.layout == Layout::Forest ? FOREST_PALETTE : std::vector<std::string>{ CUBE_MESH };
+	}
+	if (options.mesh_variety > 0 && options.mesh_variety < palette.size())
+		palette.resize(options.mesh_variety);
+
+	for (const auto& path : palette) {
+		std::error_code ec;
+		if (!std::filesystem::exists(path, ec))
+			std::cerr << "Warning: " << path << " not found relative to the working directory, the engine will skip it\n";
+	}
+
+	const uint32_t dynamic_count = static_cast<uint32_t>(std::llround(static_cast<double>(options.instances) * options.dynamic_ratio));
+
+	Rng rng(options.seed);
+	LayoutResult layout;
+	layout.placements.reserve(options.instances);
+	switch (options.layout) {
+	case Layout::City: generate_city(options, static_cast<uint32_t>(palette.size()), dynamic_count, rng, layout); break;
+	case Layout::Forest: generate_forest(options, static_cast<uint32_t>(palette.size()), dynamic_count, rng, layout); break;
+	case Layout::Corridors: generate_corridors(options, static_cast<uint32_t>(palette.size()), dynamic_count, rng, layout); break;
+	}
+
+	if (!write_scene(options, palette, layout, dynamic_count))
+		return 2;
+
+	std::error_code ec;
+	auto bytes = std::filesystem::file_size(options.output, ec);
+	std::cout << "Wrote " << options.output << ": " << layout_name(options.layout) << ", "
+		<< layout.placements.size() << " entities (" << dynamic_count << " dynamic), "
+		<< palette.size() << " meshes, " << layout.point_lights.size() << " point + " << layout.spot_lights.size() << " spot lights, "
+		<< "extent +-" << layout.extent << " m, " << (ec ? 0 : bytes / (1024 * 1024)) << " MB, seed " << options.seed << "\n";
+	return 0;
+}
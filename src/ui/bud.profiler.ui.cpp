@@ -0,0 +1,224 @@
+﻿#include "bud.profiler.ui.hpp"
+#include <imgui.h>
+#include <algorithm>
+#include <format>
+#include <string>
+#include <vector>
+
+#include "src/core/bud.profiler.hpp"
+
+namespace bud::ui {
+
+	namespace {
+		// Stable per-site color, the same zone keeps its color across frames
+		ImU32 zone_color(const bud::profiler::ZoneSite* site) {
+			uint32_t h = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(site) >> 4) * 2654435761u;
+			float hue = static_cast<float>(h % 360u) / 360.0f;
+			ImVec4 color;
+			ImGui::ColorConvertHSVtoRGB(hue, 0.55f, 0.85f, color.x, color.y, color.z);
+			color.w = 1.0f;
+			return ImGui::ColorConvertFloat4ToU32(color);
+		}
+
+		void draw_zone_box(ImDrawList* draw_list, ImVec2 min, ImVec2 max, ImU32 color, const char* label, bool hatched) {
+			draw_list->AddRectFilled(min, max, color);
+			if (hatched) {
+				// Fiber segment that ended in a switch, the zone resumes elsewhere
+				draw_list->AddRect(min, max, IM_COL32(255, 255, 255, 160));
+			}
+			float width = max.x - min.x;
+			if (width > 24.0f) {
+				ImVec4 clip(min.x + 2.0f, min.y, max.x - 2.0f, max.y);
+				draw_list->AddText(nullptr, 0.0f, ImVec2(min.x + 3.0f, min.y + 1.0f), IM_COL32(20, 20, 20, 255), label, nullptr, 0.0f, &clip);
+			}
+		}
+
+		void render_timeline(const bud::profiler::FrameProfile& frame, const std::vector<std::string>& thread_names) {
+			const float row_height = ImGui::GetTextLineHeight() + 4.0f;
+			const float label_width = 110.0f;
+			const double frame_ms = std::max(frame.duration_ms(), 0.001);
+
+			uint32_t thread_count = static_cast<uint32_t>(thread_names.size());
+			std::vector<uint32_t> lane_depth(thread_count, 0);
+			for (const auto& zone : frame.zones) {
+				if (zone.thread_index < thread_count)
+					lane_depth[zone.thread_index] = std::max<uint32_t>(lane_depth[zone.thread_index], zone.depth + 1u);
+			}
+
+			ImDrawList* draw_list = ImGui::GetWindowDrawList();
+			const float width = std::max(ImGui::GetContentRegionAvail().x - label_width, 50.0f);
+			const ImVec2 origin = ImGui::GetCursorScreenPos();
+			const ImVec2 mouse = ImGui::GetIO().MousePos;
+			float y = origin.y;
+
+			const bud::profiler::ZoneEvent* hovered = nullptr;
+			for (uint32_t t = 0; t < thread_count; ++t) {
+				if (lane_depth[t] == 0) continue;
+
+				draw_list->AddText(ImVec2(origin.x, y), IM_COL32(200, 200, 200, 255), thread_names[t].c_str());
+				float lane_x = origin.x + label_width;
+
+				for (const auto& zone : frame.zones) {
+					if (zone.thread_index != t) continue;
+
+					double start_ms = (static_cast<double>(zone.start_ns) - static_cast<double>(frame.start_ns)) * 1e-6;
+					double end_ms = (static_cast<double>(zone.end_ns) - static_cast<double>(frame.start_ns)) * 1e-6;
+					start_ms = std::clamp(start_ms, 0.0, frame_ms);
+					end_ms = std::clamp(end_ms, 0.0, frame_ms);
+
+					float x0 = lane_x + static_cast<float>(start_ms / frame_ms) * width;
+					float x1 = lane_x + static_cast<float>(end_ms / frame_ms) * width;
+					ImVec2 min(x0, y + zone.depth * row_height);
+					ImVec2 max(std::max(x1, x0 + 1.0f), min.y + row_height - 1.0f);
+					draw_zone_box(draw_list, min, max, zone_color(zone.site), zone.site->name, (zone.flags & bud::profiler::ZoneFlag_Suspended) != 0);
+
+					if (mouse.x >= min.x && mouse.x < max.x && mouse.y >= min.y && mouse.y < max.y)
+						hovered = &zone;
+				}
+
+				y += lane_depth[t] * row_height + 4.0f;
+			}
+
+			ImGui::Dummy(ImVec2(label_width + width, std::max(y - origin.y, row_height)));
+
+			if (hovered) {
+				ImGui::BeginTooltip();
+				ImGui::Text("%s", hovered->site->name);
+				ImGui::Text("%.3f ms", static_cast<double>(hovered->end_ns - hovered->start_ns) * 1e-6);
+				ImGui::TextDisabled("%s:%u", hovered->site->file, hovered->site->line);
+				if (hovered->flags & (bud::profiler::ZoneFlag_Suspended | bud::profiler::ZoneFlag_Resumed))
+					ImGui::TextDisabled("Fiber segment (%s%s)", (hovered->flags & bud::profiler::ZoneFlag_Resumed) ? "resumed" : "",
+						(hovered->flags & bud::profiler::ZoneFlag_Suspended) ? " suspended" : "");
+				ImGui::EndTooltip();
+			}
+		}
+
+		void render_flame_graph(const bud::profiler::FrameProfile& frame) {
+			static std::vector<bud::profiler::FlameNode> nodes;
+			bud::profiler::build_flame_graph(frame, nodes);
+			if (nodes.size() <= 1 || nodes[0].total_ms <= 0.0) {
+				ImGui::TextDisabled("No zones recorded");
+				return;
+			}
+
+			const float row_height = ImGui::GetTextLineHeight() + 4.0f;
+			const float width = std::max(ImGui::GetContentRegionAvail().x, 50.0f);
+			const double total_ms = nodes[0].total_ms;
+			const ImVec2 origin = ImGui::GetCursorScreenPos();
+			const ImVec2 mouse = ImGui::GetIO().MousePos;
+			ImDrawList* draw_list = ImGui::GetWindowDrawList();
+
+			uint32_t max_depth = 0;
+			const bud::profiler::FlameNode* hovered = nullptr;
+			for (size_t i = 1; i < nodes.size(); ++i) {
+				const auto& node = nodes[i];
+				max_depth = std::max(max_depth, node.depth);
+
+				ImVec2 min(origin.x + static_cast<float>(node.offset_ms / total_ms) * width, origin.y + (node.depth - 1) * row_height);
+				ImVec2 max(min.x + std::max(static_cast<float>(node.total_ms / total_ms) * width, 1.0f), min.y + row_height - 1.0f);
+				draw_zone_box(draw_list, min, max, zone_color(node.site), node.site->name, false);
+
+				if (mouse.x >= min.x && mouse.x < max.x && mouse.y >= min.y && mouse.y < max.y)
+					hovered = &node;
+			}
+
+			ImGui::Dummy(ImVec2(width, max_depth * row_height));
+
+			if (hovered) {
+				ImGui::BeginTooltip();
+				ImGui::Text("%s", hovered->site->name);
+				ImGui::Text("%.3f ms (%.1f%%), %u calls", hovered->total_ms, hovered->total_ms / total_ms * 100.0, hovered->calls);
+				ImGui::EndTooltip();
+			}
+		}
+
+		void render_zone_table(const bud::profiler::FrameProfile& frame) {
+			if (ImGui::BeginTable("##zones", 4, ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders | ImGuiTableFlags_ScrollY, ImVec2(0.0f, 240.0f))) {
+				ImGui::TableSetupColumn("Zone");
+				ImGui::TableSetupColumn("Total (ms)");
+				ImGui::TableSetupColumn("Max (ms)");
+				ImGui::TableSetupColumn("Calls");
+				ImGui::TableHeadersRow();
+
+				for (const auto& site : frame.sites) {
+					ImGui::TableNextRow();
+					ImGui::TableNextColumn(); ImGui::TextUnformatted(site.site->name);
+					ImGui::TableNextColumn(); ImGui::Text("%.3f", site.total_ms);
+					ImGui::TableNextColumn(); ImGui::Text("%.3f", site.max_ms);
+					ImGui::TableNextColumn(); ImGui::Text("%u", site.calls);
+				}
+				ImGui::EndTable();
+			}
+		}
+	}
+
+	void ProfilerUI::render(bool* open) {
+		static bud::profiler::FrameProfile frame;
+		static bool freeze = false;
+		static std::vector<float> frame_times;
+		static uint32_t export_count = 0;
+
+		ImGui::SetNextWindowSize(ImVec2(760.0f, 480.0f), ImGuiCond_FirstUseEver);
+		if (!ImGui::Begin("CPU Profiler (F7)", open)) {
+			ImGui::End();
+			return;
+		}
+
+		bool enabled = bud::profiler::is_enabled();
+		if (ImGui::Checkbox("Capture", &enabled)) {
+			bud::profiler::set_enabled(enabled);
+		}
+		ImGui::SameLine();
+		ImGui::Checkbox("Freeze", &freeze);
+		ImGui::SameLine();
+		if (ImGui::Button("Export Chrome Trace")) {
+			auto settings = bud::profiler::get_settings();
+			bud::profiler::export_chrome_trace(std::format("{}/bud_trace_{}.json", settings.export_dir, export_count++));
+		}
+
+		auto settings = bud::profiler::get_settings();
+		bool settings_changed = ImGui::Checkbox("Export on hitch", &settings.export_on_hitch);
+		ImGui::SameLine();
+		ImGui::SetNextItemWidth(160.0f);
+		settings_changed |= ImGui::SliderFloat("Hitch threshold", &settings.hitch_threshold_ms, 5.0f, 200.0f, "%.0f ms");
+		if (settings_changed) {
+			bud::profiler::set_settings(settings);
+		}
+
+		if (!freeze) {
+			bud::profiler::get_last_frame(frame);
+			bud::profiler::get_frame_times(frame_times);
+		}
+
+		auto overhead = bud::profiler::get_overhead();
+		ImGui::Text("Frame %llu: %.3f ms, %u zones, %llu dropped", static_cast<unsigned long long>(frame.frame_index), frame.duration_ms(),
+			static_cast<uint32_t>(frame.zones.size()), static_cast<unsigned long long>(frame.dropped_events));
+		ImGui::Text("Overhead: %.1f ns/zone enabled, %.2f ns disabled, ~%.3f ms last frame (%llu hitch traces)",
+			overhead.ns_per_zone, overhead.ns_per_zone_disabled, overhead.estimated_ms_last_frame,
+			static_cast<unsigned long long>(bud::profiler::get_hitch_exports()));
+
+		if (!frame_times.empty()) {
+			ImGui::PlotLines("##frame_times", frame_times.data(), static_cast<int>(frame_times.size()), 0, "Frame Time (ms)", 0.0f,
+				std::max(settings.hitch_threshold_ms, *std::max_element(frame_times.begin(), frame_times.end())), ImVec2(-1.0f, 50.0f));
+		}
+
+		if (ImGui::BeginTabBar("##profiler_views")) {
+			if (ImGui::BeginTabItem("Timeline")) {
+				render_timeline(frame, bud::profiler::get_thread_names());
+				ImGui::EndTabItem();
+			}
+			if (ImGui::BeginTabItem("Flame Graph")) {
+				render_flame_graph(frame);
+				ImGui::EndTabItem();
+			}
+			if (ImGui::BeginTabItem("Zones")) {
+				render_zone_table(frame);
+				ImGui::EndTabItem();
+			}
+			ImGui::EndTabBar();
+		}
+
+		ImGui::End();
+	}
+
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+namespace bud::ui {
+
+	class ProfilerUI {
+	public:
+		// CPU profiler window (F7): timeline, flame graph and zone table of the last frame
+		static void render(bool* open);
+	};
+
+}
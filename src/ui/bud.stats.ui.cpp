@@ -2,6 +2,8 @@
 #include <imgui.h>
 #include <cmath>
 
+#include "src/core/bud.frame.stats.hpp"
+
 namespace bud::ui {
 
 	void StatsUI::render(const bud::graphics::RenderStats& stats, float delta_time) {
@@ -12,6 +14,11 @@ namespace bud::ui {
 		static uint32_t display_draw_calls = 0;
 		static uint32_t display_drawn_tris = 0; // Total absolute tris processed by GPU across all passes
 		static uint32_t display_pipeline_binds = 0;
+		static uint32_t display_indirect_records = 0;
+		static uint32_t display_indirect_count_draws = 0;
+		static uint32_t display_compacted_draws = 0;
+		static uint32_t display_shadow_total_draws = 0;
+		static uint32_t display_shadow_visible_draws = 0;
 		
 		static uint32_t cpu_display_visible_tris = 0;
 		static uint32_t cpu_display_total_tris = 0;
@@ -30,11 +37,76 @@ namespace bud::ui {
 		static uint32_t gpu_display_visible_instances = 0;
 		static uint32_t gpu_display_total_meshlets = 0;
 		static uint32_t gpu_display_visible_meshlets = 0;
+
+		static uint32_t display_meshlet_cull_path = 0;
+		static uint32_t display_meshlets_tested = 0;
+		static uint32_t display_meshlets_culled_frustum = 0;
+		static uint32_t display_meshlets_culled_cone = 0;
+		static uint32_t display_meshlets_culled_occlusion = 0;
+		static uint32_t display_meshlets_culled_lod = 0;
+		static uint32_t display_cluster_lod_meshes = 0;
+		static uint32_t display_triangles_culled = 0;
+
+		static uint32_t display_main_view_path = 0;
+		static float display_gpu_timer_ms[bud::graphics::GPU_TIMER_COUNT] = {};
+
+		static uint32_t display_light_assign_path = 0;
+		static uint32_t display_local_lights = 0;
+		static uint32_t display_light_cluster_refs = 0;
+		static uint32_t display_light_clusters_active = 0;
+		static uint32_t display_light_cluster_max = 0;
+		static uint32_t display_light_cluster_overflow = 0;
+		static float display_light_assign_cpu_ms = 0.0f;
+		static uint32_t display_light_cluster_validated = 0;
+		static uint32_t display_light_cluster_mismatches = 0;
+
+		static bool display_dynamic_resolution = false;
+		static float display_render_scale = 1.0f;
+		static uint32_t display_render_width = 0;
+		static uint32_t display_render_height = 0;
+		static float display_dynres_target_ms = 0.0f;
+		static float display_dynres_frame_ms = 0.0f;
+		static bool display_dynres_gpu_timed = false;
+		static float display_dynres_adherence = 0.0f;
+		static uint32_t display_dynres_frames_over_budget = 0;
 		
 		static uint32_t display_shadow_casters = 0;
 		static uint32_t display_occluder_count = 0;
 		static uint32_t display_occluder_tris = 0;
+		static uint32_t display_occluder_candidates = 0;
+		static uint32_t display_occluder_budget = 0;
+		static uint32_t display_occluder_estimated = 0;
+		static float display_occluder_select_ms = 0.0f;
+		static uint32_t display_occlusion_tested = 0;
+		static uint32_t display_occlusion_culled = 0;
 		static uint32_t display_shadow_caster_submeshes = 0;
+		static uint64_t display_vertex_fetch_bytes[bud::graphics::VERTEX_FETCH_PASS_COUNT] = {};
+		static uint64_t display_vertex_fetch_interleaved_bytes[bud::graphics::VERTEX_FETCH_PASS_COUNT] = {};
+		static uint32_t display_depth_opaque_draws = 0;
+		static uint32_t display_depth_masked_draws = 0;
+		static uint64_t display_instance_upload_bytes = 0;
+		static uint64_t display_instance_upload_legacy_bytes = 0;
+		static uint64_t display_instance_memory_bytes = 0;
+		static uint64_t display_instance_memory_legacy_bytes = 0;
+		static uint32_t display_gpu_draw_slots = 0;
+		static uint32_t display_gpu_instances = 0;
+		static uint32_t display_sort_state_changes[bud::graphics::SORT_KEY_PASS_COUNT] = {};
+		static uint32_t display_sort_state_changes_unsorted[bud::graphics::SORT_KEY_PASS_COUNT] = {};
+		static uint32_t display_sort_key_overflows = 0;
+		static uint32_t display_view_count = 0;
+		static uint32_t display_view_draws[bud::graphics::MAX_VIEWS] = {};
+		static uint32_t display_shared_draws = 0;
+		static uint32_t display_foliage_cells_total = 0;
+		static uint32_t display_foliage_cells_visible = 0;
+		static uint32_t display_foliage_mesh_instances = 0;
+		static uint32_t display_foliage_impostor_instances = 0;
+		static uint32_t display_foliage_shadow_instances = 0;
+		static uint32_t display_foliage_draws = 0;
+		static float display_foliage_cull_ms = 0.0f;
+		static uint32_t display_hlod_regions = 0;
+		static uint32_t display_hlod_regions_active = 0;
+		static uint32_t display_hlod_draws_saved = 0;
+		static uint64_t display_hlod_triangles_saved = 0;
 
 		float current_ms = delta_time * 1000.0f;
 		float ema_alpha = (delta_time > 0.0f)
@@ -53,6 +125,11 @@ namespace bud::ui {
 			display_draw_calls = stats.draw_calls;
 			display_drawn_tris = stats.drawn_triangles;
 			display_pipeline_binds = stats.pipeline_binds;
+			display_indirect_records = stats.indirect_records_submitted;
+			display_indirect_count_draws = stats.indirect_count_draws;
+			display_compacted_draws = stats.gpu_compacted_draws;
+			display_shadow_total_draws = stats.gpu_shadow_total_draws;
+			display_shadow_visible_draws = stats.gpu_shadow_visible_draws;
 			
 			cpu_display_total_tris = stats.cpu_total_triangles;
 			cpu_display_visible_tris = stats.cpu_visible_triangles;
@@ -71,11 +148,83 @@ namespace bud::ui {
 			gpu_display_visible_instances = stats.gpu_visible_instances;
 			gpu_display_total_meshlets = stats.gpu_total_meshlets;
 			gpu_display_visible_meshlets = stats.gpu_visible_meshlets;
+
+			display_meshlet_cull_path = stats.meshlet_cull_path;
+			display_meshlets_tested = stats.gpu_meshlets_tested;
+			display_meshlets_culled_frustum = stats.gpu_meshlets_culled_frustum;
+			display_meshlets_culled_cone = stats.gpu_meshlets_culled_cone;
+			display_meshlets_culled_occlusion = stats.gpu_meshlets_culled_occlusion;
+			display_meshlets_culled_lod = stats.gpu_meshlets_culled_lod;
+			display_cluster_lod_meshes = stats.cluster_lod_meshes;
+			display_triangles_culled = stats.gpu_triangles_culled;
+
+			display_main_view_path = stats.main_view_path;
+			for (uint32_t i = 0; i < bud::graphics::GPU_TIMER_COUNT; ++i)
+				display_gpu_timer_ms[i] = stats.gpu_timer_ms[i];
+
+			display_light_assign_path = stats.light_assign_path;
+			display_local_lights = stats.local_lights;
+			display_light_cluster_refs = stats.light_cluster_refs;
+			display_light_clusters_active = stats.light_clusters_active;
+			display_light_cluster_max = stats.light_cluster_max;
+			display_light_cluster_overflow = stats.light_cluster_overflow;
+			display_light_assign_cpu_ms = stats.light_assign_cpu_ms;
+			display_light_cluster_validated = stats.light_cluster_validated;
+			display_light_cluster_mismatches = stats.light_cluster_mismatches;
+
+			display_dynamic_resolution = stats.dynamic_resolution;
+			display_render_scale = stats.render_scale;
+			display_render_width = stats.render_width;
+			display_render_height = stats.render_height;
+			display_dynres_target_ms = stats.dynres_target_ms;
+			display_dynres_frame_ms = stats.dynres_frame_ms;
+			display_dynres_gpu_timed = stats.dynres_gpu_timed;
+			display_dynres_adherence = stats.dynres_adherence;
+			display_dynres_frames_over_budget = stats.dynres_frames_over_budget;
 			
 			display_shadow_casters = stats.shadow_casters;
 			display_occluder_count = stats.occluder_count;
 			display_occluder_tris = stats.occluder_triangles;
+			display_occluder_candidates = stats.occluder_candidates;
+			display_occluder_budget = stats.occluder_budget;
+			display_occluder_estimated = stats.occluder_estimated_occluded;
+			display_occluder_select_ms = stats.occluder_select_ms;
+			display_occlusion_tested = stats.occlusion_tested;
+			display_occlusion_culled = stats.occlusion_culled;
 			display_shadow_caster_submeshes = stats.shadow_caster_submeshes;
+			for (uint32_t i = 0; i < bud::graphics::VERTEX_FETCH_PASS_COUNT; ++i) {
+				display_vertex_fetch_bytes[i] = stats.vertex_fetch_bytes[i];
+				display_vertex_fetch_interleaved_bytes[i] = stats.vertex_fetch_interleaved_bytes[i];
+			}
+			display_depth_opaque_draws = stats.depth_opaque_draws;
+			display_depth_masked_draws = stats.depth_masked_draws;
+			display_instance_upload_bytes = stats.instance_upload_bytes;
+			display_instance_upload_legacy_bytes = stats.instance_upload_legacy_bytes;
+			display_instance_memory_bytes = stats.instance_memory_bytes;
+			display_instance_memory_legacy_bytes = stats.instance_memory_legacy_bytes;
+			display_gpu_draw_slots = stats.gpu_draw_slots;
+			display_gpu_instances = stats.gpu_instances;
+			for (uint32_t i = 0; i < bud::graphics::SORT_KEY_PASS_COUNT; ++i) {
+				display_sort_state_changes[i] = stats.sort_state_changes[i];
+				display_sort_state_changes_unsorted[i] = stats.sort_state_changes_unsorted[i];
+			}
+			display_sort_key_overflows = stats.sort_key_overflows;
+			display_view_count = stats.view_count;
+			for (uint32_t i = 0; i < bud::graphics::MAX_VIEWS; ++i) {
+				display_view_draws[i] = stats.view_draws[i];
+			}
+			display_shared_draws = stats.shared_draws;
+			display_foliage_cells_total = stats.foliage_cells_total;
+			display_foliage_cells_visible = stats.foliage_cells_visible;
+			display_foliage_mesh_instances = stats.foliage_mesh_instances;
+			display_foliage_impostor_instances = stats.foliage_impostor_instances;
+			display_foliage_shadow_instances = stats.foliage_shadow_instances;
+			display_foliage_draws = stats.foliage_draws;
+			display_foliage_cull_ms = stats.foliage_cull_ms;
+			display_hlod_regions = stats.hlod_regions;
+			display_hlod_regions_active = stats.hlod_regions_active;
+			display_hlod_draws_saved = stats.hlod_draws_saved;
+			display_hlod_triangles_saved = stats.hlod_triangles_saved;
 			update_timer = 0.0f;
 		}
 
@@ -93,11 +242,59 @@ namespace bud::ui {
 		ImVec4 pipe_color = display_pipeline_binds <= 100 ? color_good : (display_pipeline_binds <= 500 ? color_warn : color_bad);
 
 		ImGui::TextColored(fps_color, "FPS: %.1f (%.2f ms)", display_fps, display_ms);
+
+		// Rolling window percentiles, not throttled: they already change slowly
+		auto frame_summary = bud::frame_stats::get_summary();
+		if (frame_summary.window_frames > 0) {
+			ImGui::Separator();
+			ImGui::TextColored(color_neutral, "Frame Timing (last %u frames)", frame_summary.window_frames);
+			if (ImGui::BeginTable("##frame_phases", 4, ImGuiTableFlags_SizingFixedFit)) {
+				ImGui::TableSetupColumn("Phase");
+				ImGui::TableSetupColumn("p50");
+				ImGui::TableSetupColumn("p95");
+				ImGui::TableSetupColumn("p99");
+				ImGui::TableHeadersRow();
+				for (uint32_t p = 0; p < bud::frame_stats::PHASE_COUNT; ++p) {
+					const auto& phase = frame_summary.phases[p];
+					ImGui::TableNextRow();
+					ImGui::TableNextColumn(); ImGui::TextUnformatted(bud::frame_stats::phase_name(static_cast<bud::frame_stats::FramePhase>(p)));
+					ImGui::TableNextColumn(); ImGui::Text("%.2f", phase.p50_ms);
+					ImGui::TableNextColumn(); ImGui::Text("%.2f", phase.p95_ms);
+					ImGui::TableNextColumn(); ImGui::Text("%.2f", phase.p99_ms);
+				}
+				ImGui::EndTable();
+			}
+
+			const auto& frame_phase = frame_summary.phases[static_cast<uint32_t>(bud::frame_stats::FramePhase::Frame)];
+			float histogram[bud::frame_stats::HISTOGRAM_BUCKET_COUNT];
+			for (uint32_t b = 0; b < bud::frame_stats::HISTOGRAM_BUCKET_COUNT; ++b)
+				histogram[b] = static_cast<float>(frame_phase.histogram[b]);
+			ImGui::PlotHistogram("##frame_histogram", histogram, static_cast<int>(bud::frame_stats::HISTOGRAM_BUCKET_COUNT), 0,
+				"Frame ms: <0.5 ... >100", 0.0f, FLT_MAX, ImVec2(0.0f, 40.0f));
+			ImGui::TextColored(frame_summary.hitches > 0 ? color_warn : color_neutral, "Hitches: %llu (last %.1f ms), captures: %llu",
+				static_cast<unsigned long long>(frame_summary.hitches), frame_summary.last_hitch_ms, static_cast<unsigned long long>(frame_summary.captures));
+		}
+
 		ImGui::Separator();
 		ImGui::TextColored(color_neutral, "Draw Stats");
 		ImGui::TextColored(dc_color, "Draw Calls: %u", display_draw_calls);
 		ImGui::TextColored(drawn_tri_color, "Rasterized Tris: %u", display_drawn_tris);
 		ImGui::TextColored(pipe_color, "Pipeline Binds: %u", display_pipeline_binds);
+		if (display_indirect_count_draws > 0) {
+			ImGui::TextColored(color_neutral, "Indirect-Count Draws: %u (compacted records: %u)", display_indirect_count_draws, display_compacted_draws);
+		} else {
+			ImGui::TextColored(color_neutral, "Indirect Records Walked: %u", display_indirect_records);
+		}
+		if (display_shadow_total_draws > 0) {
+			ImGui::TextColored(color_neutral, "Shadow Draws (GPU compacted): %u / %u", display_shadow_visible_draws, display_shadow_total_draws);
+		}
+		ImGui::TextColored(color_neutral, "Culling GPU Instance / Meshlet / Shadow: %.3f / %.3f / %.3f ms",
+			display_gpu_timer_ms[static_cast<uint32_t>(bud::graphics::GPUTimer::InstanceCulling)],
+			display_gpu_timer_ms[static_cast<uint32_t>(bud::graphics::GPUTimer::MeshletCulling)],
+			display_gpu_timer_ms[static_cast<uint32_t>(bud::graphics::GPUTimer::ShadowCulling)]);
+		ImGui::TextColored(color_neutral, "Draw GPU Main / Shadow: %.3f / %.3f ms",
+			display_gpu_timer_ms[static_cast<uint32_t>(bud::graphics::GPUTimer::MainView)],
+			display_gpu_timer_ms[static_cast<uint32_t>(bud::graphics::GPUTimer::ShadowDraw)]);
 
 		// CPU CULLING
 		ImGui::Separator();
@@ -145,14 +342,128 @@ namespace bud::ui {
 		ImGui::TextColored(color_neutral, "Meshlet Cull Ratio: %.1f%%", gpu_meshlet_cull_rate);
 
 		ImGui::Separator();
-		ImGui::TextColored(color_neutral, "ML Occlusion Training");
-		ImGui::TextColored(color_neutral, "Selected Occluders: %u", display_occluder_count);
+		const char* meshlet_path_names[] = { "Off", "Compute + Indirect", "Task/Mesh Shader" };
+		ImGui::TextColored(color_neutral, "GPU Meshlet Culling: %s", meshlet_path_names[display_meshlet_cull_path < 3 ? display_meshlet_cull_path : 0]);
+		if (display_meshlet_cull_path != 0) {
+			ImGui::TextColored(color_neutral, "Meshlets Tested: %u", display_meshlets_tested);
+			ImGui::TextColored(color_neutral, "Culled Frustum/Cone/Hi-Z: %u / %u / %u",
+				display_meshlets_culled_frustum, display_meshlets_culled_cone, display_meshlets_culled_occlusion);
+			if (display_cluster_lod_meshes > 0) {
+				ImGui::TextColored(color_neutral, "Cluster LOD Meshes: %u, Meshlets Outside Cut: %u", display_cluster_lod_meshes, display_meshlets_culled_lod);
+			}
+		}
+		ImGui::TextColored(color_neutral, "Triangles Culled: %u", display_triangles_culled);
+
+		ImGui::Separator();
+		const char* main_view_path_names[] = { "Forward", "Visibility Buffer" };
+		ImGui::TextColored(color_neutral, "Main View (F5): %s", main_view_path_names[display_main_view_path < 2 ? display_main_view_path : 0]);
+		ImGui::TextColored(color_neutral, "Main View GPU: %.3f ms", display_gpu_timer_ms[static_cast<uint32_t>(bud::graphics::GPUTimer::MainView)]);
+		if (display_main_view_path == 1) {
+			ImGui::TextColored(color_neutral, "ID Raster / Material Resolve: %.3f / %.3f ms",
+				display_gpu_timer_ms[static_cast<uint32_t>(bud::graphics::GPUTimer::VisibilityRaster)],
+				display_gpu_timer_ms[static_cast<uint32_t>(bud::graphics::GPUTimer::MaterialResolve)]);
+		}
+
+		ImGui::Separator();
+		ImGui::TextColored(color_neutral, "Dynamic Resolution (F6): %s", display_dynamic_resolution ? "On" : "Off");
+		if (display_dynamic_resolution) {
+			ImGui::TextColored(color_neutral, "Render Scale: %.2f (%u x %u)", display_render_scale, display_render_width, display_render_height);
+			ImGui::TextColored(display_dynres_frame_ms > display_dynres_target_ms ? color_warn : color_neutral,
+				"%s Frame / Target: %.2f / %.2f ms", display_dynres_gpu_timed ? "GPU" : "CPU", display_dynres_frame_ms, display_dynres_target_ms);
+			ImGui::TextColored(color_neutral, "Within Budget: %.1f%% (%u over)", display_dynres_adherence, display_dynres_frames_over_budget);
+			// History is per frame, not throttled like the counters above
+			ImGui::PlotLines("##render_scale", stats.render_scale_history, static_cast<int>(bud::graphics::RENDER_SCALE_HISTORY_SIZE),
+				static_cast<int>(stats.render_scale_history_offset), "Scale History", 0.0f, 1.0f, ImVec2(0.0f, 40.0f));
+		}
+
+		ImGui::Separator();
+		const char* light_assign_path_names[] = { "Off", "CPU", "Compute" };
+		ImGui::TextColored(color_neutral, "Clustered Lights: %u (%s)", display_local_lights, light_assign_path_names[display_light_assign_path < 3 ? display_light_assign_path : 0]);
+		if (display_light_assign_path != 0) {
+			float assign_ms = display_light_assign_path == 1
+				? display_light_assign_cpu_ms
+				: display_gpu_timer_ms[static_cast<uint32_t>(bud::graphics::GPUTimer::LightAssignment)];
+			float avg_lights = display_light_clusters_active > 0 ? static_cast<float>(display_light_cluster_refs) / display_light_clusters_active : 0.0f;
+			ImGui::TextColored(color_neutral, "Light Assignment: %.3f ms", assign_ms);
+			ImGui::TextColored(color_neutral, "Lights / Cluster: %.2f avg, %u max (%u / %u active)", avg_lights, display_light_cluster_max,
+				display_light_clusters_active, bud::graphics::LIGHT_CLUSTER_COUNT);
+			ImGui::TextColored(display_light_cluster_overflow > 0 ? color_warn : color_neutral, "Overflowing Clusters: %u", display_light_cluster_overflow);
+			if (display_light_cluster_validated) {
+				ImGui::TextColored(display_light_cluster_mismatches > 0 ? color_warn : color_neutral, "Compute vs CPU Reference: %u clusters differ", display_light_cluster_mismatches);
+			}
+		}
+
+		ImGui::Separator();
+		ImGui::TextColored(color_neutral, "Occluder Selection");
+		ImGui::TextColored(color_neutral, "Selected Occluders: %u / %u (K %u)", display_occluder_count, display_occluder_candidates, display_occluder_budget);
 		ImGui::TextColored(color_neutral, "Occluder Tris: %u", display_occluder_tris);
+		ImGui::TextColored(color_neutral, "Z-Prepass GPU: %.3f ms (select %.3f ms)",
+			display_gpu_timer_ms[static_cast<uint32_t>(bud::graphics::GPUTimer::ZPrepass)], display_occluder_select_ms);
+		float occlusion_rate = display_occlusion_tested > 0 ? 100.0f * static_cast<float>(display_occlusion_culled) / display_occlusion_tested : 0.0f;
+		ImGui::TextColored(color_neutral, "Hi-Z Culled: %u / %u (%.1f%%)", display_occlusion_culled, display_occlusion_tested, occlusion_rate);
+		ImGui::TextColored(color_neutral, "Occluded (CPU estimate): %u", display_occluder_estimated);
 
 		ImGui::Separator();
 		ImGui::TextColored(color_neutral, "Shadow Casters: %u", display_shadow_casters);
 		ImGui::TextColored(color_neutral, "Shadow Casters (Submeshes): %u", display_shadow_caster_submeshes);
 
+		ImGui::Separator();
+		ImGui::TextColored(color_neutral, "Depth Vertex Fetch (split / interleaved)");
+		static constexpr const char* fetch_pass_names[bud::graphics::VERTEX_FETCH_PASS_COUNT] = { "Z-Prepass", "Shadow Static", "Shadow" };
+		for (uint32_t i = 0; i < bud::graphics::VERTEX_FETCH_PASS_COUNT; ++i) {
+			const double split_mb = static_cast<double>(display_vertex_fetch_bytes[i]) / (1024.0 * 1024.0);
+			const double interleaved_mb = static_cast<double>(display_vertex_fetch_interleaved_bytes[i]) / (1024.0 * 1024.0);
+			const double saving = interleaved_mb > 0.0 ? 100.0 * (1.0 - split_mb / interleaved_mb) : 0.0;
+			ImGui::TextColored(color_neutral, "%s: %.2f / %.2f MB (-%.1f%%)", fetch_pass_names[i], split_mb, interleaved_mb, saving);
+		}
+		ImGui::TextColored(color_neutral, "Depth Draws: %u position-only, %u alpha-tested", display_depth_opaque_draws, display_depth_masked_draws);
+
+		ImGui::Separator();
+		ImGui::TextColored(color_neutral, "Instance Data (compact / legacy)");
+		ImGui::TextColored(color_neutral, "Draw Slots: %u, Transforms: %u", display_gpu_draw_slots, display_gpu_instances);
+		{
+			const double upload_kb = static_cast<double>(display_instance_upload_bytes) / 1024.0;
+			const double upload_legacy_kb = static_cast<double>(display_instance_upload_legacy_bytes) / 1024.0;
+			const double saving = upload_legacy_kb > 0.0 ? 100.0 * (1.0 - upload_kb / upload_legacy_kb) : 0.0;
+			ImGui::TextColored(color_neutral, "Upload: %.1f / %.1f KB per frame (-%.1f%%)", upload_kb, upload_legacy_kb, saving);
+			ImGui::TextColored(color_neutral, "Buffers: %.2f / %.2f MB",
+				static_cast<double>(display_instance_memory_bytes) / (1024.0 * 1024.0),
+				static_cast<double>(display_instance_memory_legacy_bytes) / (1024.0 * 1024.0));
+		}
+
+		ImGui::Separator();
+		ImGui::TextColored(color_neutral, "Sort Keys (state changes sorted / unsorted)");
+		static constexpr const char* sort_pass_names[bud::graphics::SORT_KEY_PASS_COUNT] = { "Opaque", "Prepass", "Shadow" };
+		for (uint32_t i = 0; i < bud::graphics::SORT_KEY_PASS_COUNT; ++i) {
+			ImGui::TextColored(color_neutral, "%s: %u / %u", sort_pass_names[i], display_sort_state_changes[i], display_sort_state_changes_unsorted[i]);
+		}
+		if (display_sort_key_overflows > 0) {
+			ImGui::TextColored(color_bad, "Clamped keys: %u", display_sort_key_overflows);
+		}
+
+		if (display_view_count > 1) {
+			ImGui::Separator();
+			ImGui::TextColored(color_neutral, "Views: %u (shared draws %u)", display_view_count, display_shared_draws);
+			for (uint32_t i = 0; i < display_view_count && i < bud::graphics::MAX_VIEWS; ++i) {
+				ImGui::TextColored(color_neutral, "%s %u: %u draws", i == 0 ? "Main" : "View", i, display_view_draws[i]);
+			}
+		}
+
+		if (display_foliage_cells_total > 0) {
+			ImGui::Separator();
+			ImGui::TextColored(color_neutral, "Foliage");
+			ImGui::TextColored(color_neutral, "Cells: %u / %u visible, cull %.3f ms", display_foliage_cells_visible, display_foliage_cells_total, display_foliage_cull_ms);
+			ImGui::TextColored(color_neutral, "Instances: %u mesh, %u impostor, %u shadow", display_foliage_mesh_instances, display_foliage_impostor_instances, display_foliage_shadow_instances);
+			ImGui::TextColored(color_neutral, "Draws: %u", display_foliage_draws);
+		}
+
+		if (display_hlod_regions > 0) {
+			ImGui::Separator();
+			ImGui::TextColored(color_neutral, "HLOD");
+			ImGui::TextColored(color_neutral, "Regions: %u / %u as proxy", display_hlod_regions_active, display_hlod_regions);
+			ImGui::TextColored(color_neutral, "Saved: %u draws, %llu triangles", display_hlod_draws_saved, static_cast<unsigned long long>(display_hlod_triangles_saved));
+		}
+
 		// Ensure a tiny bottom padding so auto-resize windows don't clip the last lines
 		// (avoids occasional off-by-one height issues on some platforms/fonts)
 		ImGui::Spacing();